@@ -7,7 +7,20 @@
  */
 
 #include <lib/account.h>
+#include <lib/amount.h>
 #include <lib/server_api.h>
+#include <lib/engine.h>
+#include <lib/shard.h>
+#include <lib/flusher.h>
+#include <lib/shm_store.h>
+#include <lib/async_ops.h>
+#include <lib/outbox.h>
+#include <lib/replication.h>
+#include <lib/tiering.h>
+#include <lib/compact_store.h>
+#include <lib/disk_index.h>
+#include <lib/threadpool.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -85,6 +98,25 @@ static bool g_hash_table_initialized = false;  /* Hash 表是否已初始化 */
 #endif
  }
 
+ /* 账户操作加锁：共享存储模式下只锁涉及账户的跨进程条带锁，否则使用全局操作锁 */
+ static void account_lock_accounts(const char *uuid_a, const char *uuid_b)
+ {
+     if (shm_store_active()) {
+         shm_store_lock(uuid_a, uuid_b);
+     } else {
+         account_op_lock();
+     }
+ }
+
+ static void account_unlock_accounts(const char *uuid_a, const char *uuid_b)
+ {
+     if (shm_store_active()) {
+         shm_store_unlock(uuid_a, uuid_b);
+     } else {
+         account_op_unlock();
+     }
+ }
+
  void set_account_sort_mode(AccountSortMode mode)
  {
      g_account_sort_mode = mode;
@@ -99,12 +131,13 @@ static bool g_hash_table_initialized = false;  /* Hash 表是否已初始化 */
 
 #define INITIAL_HASH_TABLE_SIZE 16    /* 初始桶数量 */
 #define LOAD_FACTOR_THRESHOLD 0.75    /* 扩容阈值 */
+#define PRELOAD_BATCH 4096            /* 启动时每批并行读取的 .card 文件数 */
 
 /* ==================== Hash 表内部函数声明 ==================== */
 
 static unsigned long hash_function(const char *str, size_t table_size);
-static double calculate_load_factor(void);
-static bool resize_hash_table(void);
+static double calculate_load_factor(const AccountHashTable *table);
+static bool resize_hash_table(AccountHashTable *table);
 
 /* ==================== Hash 表实现 ==================== */
 
@@ -130,23 +163,23 @@ static unsigned long hash_function(const char *str, size_t table_size)
  * @brief 计算当前负载因子
  * @return 负载因子
  */
-static double calculate_load_factor(void)
+static double calculate_load_factor(const AccountHashTable *table)
 {
-    if (g_hash_table.size == 0) {
+    if (table->size == 0) {
         return 0.0;
     }
-    return (double)g_hash_table.count / (double)g_hash_table.size;
+    return (double)table->count / (double)table->size;
 }
 
 /**
  * @brief 扩容 Hash 表
  * @return 成功返回true，失败返回false
  */
-static bool resize_hash_table(void)
+static bool resize_hash_table(AccountHashTable *table)
 {
-    size_t new_size = g_hash_table.size * 2;
+    size_t new_size = table->size * 2;
     
-    printf("[Hash] 正在扩容 Hash 表：%zu -> %zu\n", g_hash_table.size, new_size);
+    printf("[Hash] 正在扩容 Hash 表：%zu -> %zu\n", table->size, new_size);
     
     /* 分配新的桶数组 */
     AccountNode **new_buckets = (AccountNode **)calloc(new_size, sizeof(AccountNode *));
@@ -156,8 +189,8 @@ static bool resize_hash_table(void)
     }
     
     /* 重新哈希所有节点 */
-    for (size_t i = 0; i < g_hash_table.size; i++) {
-        AccountNode *current = g_hash_table.buckets[i];
+    for (size_t i = 0; i < table->size; i++) {
+        AccountNode *current = table->buckets[i];
         
         while (current != NULL) {
             AccountNode *next = current->next;
@@ -174,60 +207,44 @@ static bool resize_hash_table(void)
     }
     
     /* 释放旧桶数组 */
-    free(g_hash_table.buckets);
+    free(table->buckets);
     
     /* 更新 Hash 表 */
-    g_hash_table.buckets = new_buckets;
-    g_hash_table.size = new_size;
+    table->buckets = new_buckets;
+    table->size = new_size;
     
-    printf("[Hash] 扩容完成，当前负载因子: %.2f\n", calculate_load_factor());
+    printf("[Hash] 扩容完成，当前负载因子: %.2f\n", calculate_load_factor(table));
     
     return true;
 }
 
 /**
- * @brief 初始化账户 Hash 表
+ * @brief 初始化一张 Hash 表
  */
-bool init_account_hash_table(void)
+bool account_table_init(AccountHashTable *table)
 {
-    if (g_hash_table_initialized) {
-        return true;
-    }
-    
-    printf("[Hash] 正在初始化账户 Hash 表...\n");
-    
     /* 分配桶数组 */
-    g_hash_table.buckets = (AccountNode **)calloc(INITIAL_HASH_TABLE_SIZE, sizeof(AccountNode *));
-    if (g_hash_table.buckets == NULL) {
+    table->buckets = (AccountNode **)calloc(INITIAL_HASH_TABLE_SIZE, sizeof(AccountNode *));
+    if (table->buckets == NULL) {
         fprintf(stderr, "错误：Hash 表初始化失败（内存分配失败）\n");
         return false;
     }
     
-    g_hash_table.size = INITIAL_HASH_TABLE_SIZE;
-    g_hash_table.count = 0;
-    g_hash_table.load_factor_threshold = LOAD_FACTOR_THRESHOLD;
-    
-    g_hash_table_initialized = true;
-    
-    printf("[Hash] Hash 表初始化成功（初始大小: %zu）\n", g_hash_table.size);
+    table->size = INITIAL_HASH_TABLE_SIZE;
+    table->count = 0;
+    table->load_factor_threshold = LOAD_FACTOR_THRESHOLD;
     
     return true;
 }
 
 /**
- * @brief 清理账户 Hash 表
+ * @brief 释放一张 Hash 表的所有节点
  */
-void cleanup_account_hash_table(void)
+void account_table_cleanup(AccountHashTable *table)
 {
-    if (!g_hash_table_initialized) {
-        return;
-    }
-    
-    printf("[Hash] 正在清理 Hash 表...\n");
-    
     /* 释放所有节点 */
-    for (size_t i = 0; i < g_hash_table.size; i++) {
-        AccountNode *current = g_hash_table.buckets[i];
+    for (size_t i = 0; i < table->size; i++) {
+        AccountNode *current = table->buckets[i];
         
         while (current != NULL) {
             AccountNode *next = current->next;
@@ -237,42 +254,35 @@ void cleanup_account_hash_table(void)
     }
     
     /* 释放桶数组 */
-    free(g_hash_table.buckets);
-    
-    g_hash_table.buckets = NULL;
-    g_hash_table.size = 0;
-    g_hash_table.count = 0;
-    g_hash_table_initialized = false;
+    free(table->buckets);
     
-    printf("[Hash] Hash 表清理完成\n");
+    table->buckets = NULL;
+    table->size = 0;
+    table->count = 0;
 }
 
 /**
- * @brief 插入账户到 Hash 表
+ * @brief 插入或更新账户
  */
-bool hash_insert_account(const ACCOUNT *acc)
+bool account_table_insert(AccountHashTable *table, const ACCOUNT *acc)
 {
-    if (!g_hash_table_initialized) {
-        fprintf(stderr, "错误：Hash 表未初始化\n");
-        return false;
-    }
-    
     /* 检查是否需要扩容 */
-    if (calculate_load_factor() >= g_hash_table.load_factor_threshold) {
-        if (!resize_hash_table()) {
+    if (calculate_load_factor(table) >= table->load_factor_threshold) {
+        if (!resize_hash_table(table)) {
             return false;
         }
     }
     
     /* 计算桶索引 */
-    unsigned long index = hash_function(acc->UUID, g_hash_table.size);
+    unsigned long index = hash_function(acc->UUID, table->size);
     
     /* 检查是否已存在（避免重复插入） */
-    AccountNode *current = g_hash_table.buckets[index];
+    AccountNode *current = table->buckets[index];
     while (current != NULL) {
         if (strcmp(current->account.UUID, acc->UUID) == 0) {
             /* 账户已存在，更新数据 */
             current->account = *acc;
+            current->last_access = time(NULL);
             return true;
         }
         current = current->next;
@@ -286,28 +296,25 @@ bool hash_insert_account(const ACCOUNT *acc)
     }
     
     new_node->account = *acc;
-    new_node->next = g_hash_table.buckets[index];
-    g_hash_table.buckets[index] = new_node;
+    new_node->last_access = time(NULL);
+    new_node->next = table->buckets[index];
+    table->buckets[index] = new_node;
     
-    g_hash_table.count++;
+    table->count++;
     
     return true;
 }
 
 /**
- * @brief 从 Hash 表查找账户
+ * @brief 查找账户
  */
-ACCOUNT* hash_find_account(const char *uuid)
+ACCOUNT* account_table_find(AccountHashTable *table, const char *uuid)
 {
-    if (!g_hash_table_initialized) {
-        return NULL;
-    }
-    
     /* 计算桶索引 */
-    unsigned long index = hash_function(uuid, g_hash_table.size);
+    unsigned long index = hash_function(uuid, table->size);
     
     /* 遍历链表查找 */
-    AccountNode *current = g_hash_table.buckets[index];
+    AccountNode *current = table->buckets[index];
     while (current != NULL) {
         if (strcmp(current->account.UUID, uuid) == 0) {
             return &current->account;
@@ -319,47 +326,15 @@ ACCOUNT* hash_find_account(const char *uuid)
 }
 
 /**
- * @brief 更新 Hash 表中的账户
- */
-bool hash_update_account(const ACCOUNT *acc)
-{
-    if (!g_hash_table_initialized) {
-        fprintf(stderr, "错误：Hash 表未初始化\n");
-        return false;
-    }
-    
-    /* 计算桶索引 */
-    unsigned long index = hash_function(acc->UUID, g_hash_table.size);
-    
-    /* 查找并更新 */
-    AccountNode *current = g_hash_table.buckets[index];
-    while (current != NULL) {
-        if (strcmp(current->account.UUID, acc->UUID) == 0) {
-            current->account = *acc;
-            return true;
-        }
-        current = current->next;
-    }
-    
-    /* 账户不存在，插入新账户 */
-    return hash_insert_account(acc);
-}
-
-/**
- * @brief 从 Hash 表删除账户
+ * @brief 删除账户
  */
-bool hash_delete_account(const char *uuid)
+bool account_table_delete(AccountHashTable *table, const char *uuid)
 {
-    if (!g_hash_table_initialized) {
-        fprintf(stderr, "错误：Hash 表未初始化\n");
-        return false;
-    }
-    
     /* 计算桶索引 */
-    unsigned long index = hash_function(uuid, g_hash_table.size);
+    unsigned long index = hash_function(uuid, table->size);
     
     /* 查找并删除 */
-    AccountNode *current = g_hash_table.buckets[index];
+    AccountNode *current = table->buckets[index];
     AccountNode *prev = NULL;
     
     while (current != NULL) {
@@ -367,14 +342,14 @@ bool hash_delete_account(const char *uuid)
             /* 找到节点，删除 */
             if (prev == NULL) {
                 /* 删除头节点 */
-                g_hash_table.buckets[index] = current->next;
+                table->buckets[index] = current->next;
             } else {
                 /* 删除中间或尾节点 */
                 prev->next = current->next;
             }
             
             free(current);
-            g_hash_table.count--;
+            table->count--;
             
             return true;
         }
@@ -386,8 +361,164 @@ bool hash_delete_account(const char *uuid)
     return false;  /* 账户不存在 */
 }
 
+/* ==================== 全局 Hash 表 ==================== */
+
+/**
+ * @brief 初始化账户 Hash 表
+ */
+bool init_account_hash_table(void)
+{
+    if (g_hash_table_initialized) {
+        return true;
+    }
+    
+    printf("[Hash] 正在初始化账户 Hash 表...\n");
+    
+    if (!account_table_init(&g_hash_table)) {
+        return false;
+    }
+    
+    g_hash_table_initialized = true;
+    
+    printf("[Hash] Hash 表初始化成功（初始大小: %zu）\n", g_hash_table.size);
+    
+    return true;
+}
+
+/**
+ * @brief 清理账户 Hash 表
+ */
+void cleanup_account_hash_table(void)
+{
+    if (!g_hash_table_initialized) {
+        return;
+    }
+    
+    printf("[Hash] 正在清理 Hash 表...\n");
+    
+    account_table_cleanup(&g_hash_table);
+    g_hash_table_initialized = false;
+    
+    printf("[Hash] Hash 表清理完成\n");
+}
+
+/**
+ * @brief 插入账户到 Hash 表
+ */
+bool hash_insert_account(const ACCOUNT *acc)
+{
+    if (compact_store_active()) {
+        return compact_store_put(compact_store_global(), acc);
+    }
+    if (!g_hash_table_initialized) {
+        fprintf(stderr, "错误：Hash 表未初始化\n");
+        return false;
+    }
+    
+    return account_table_insert(&g_hash_table, acc);
+}
+
+/**
+ * @brief 从 Hash 表查找账户
+ */
+ACCOUNT* hash_find_account(const char *uuid)
+{
+    /* 紧凑表中的账户没有固定地址 */
+    if (!g_hash_table_initialized || compact_store_active()) {
+        return NULL;
+    }
+    
+    return account_table_find(&g_hash_table, uuid);
+}
+
+/**
+ * @brief 更新 Hash 表中的账户
+ */
+bool hash_update_account(const ACCOUNT *acc)
+{
+    if (compact_store_active()) {
+        return compact_store_put(compact_store_global(), acc);
+    }
+    if (!g_hash_table_initialized) {
+        fprintf(stderr, "错误：Hash 表未初始化\n");
+        return false;
+    }
+    
+    /* 账户不存在时插入新账户 */
+    return account_table_insert(&g_hash_table, acc);
+}
+
+/**
+ * @brief 从 Hash 表删除账户
+ */
+bool hash_delete_account(const char *uuid)
+{
+    if (compact_store_active()) {
+        return compact_store_remove(compact_store_global(), uuid);
+    }
+    if (!g_hash_table_initialized) {
+        fprintf(stderr, "错误：Hash 表未初始化\n");
+        return false;
+    }
+    
+    return account_table_delete(&g_hash_table, uuid);
+}
+
 /* ==================== 系统初始化 ==================== */
 
+/**
+ * @brief 启动时预载的一批 .card 文件：文件读取在线程池中并行，插入 Hash 表在调用线程中依次进行
+ */
+typedef struct {
+    char uuids[PRELOAD_BATCH][37];
+    ACCOUNT accounts[PRELOAD_BATCH];
+    bool read_ok[PRELOAD_BATCH];
+    size_t count;
+    int loaded;
+} PreloadBatch;
+
+static void preload_read_range(size_t begin, size_t end, void *arg)
+{
+    PreloadBatch *batch = arg;
+    for (size_t i = begin; i < end; i++) {
+        batch->read_ok[i] = account_read_file(batch->uuids[i], &batch->accounts[i]);
+    }
+}
+
+static void preload_flush(PreloadBatch *batch)
+{
+    ThreadPool *pool = threadpool_shared();
+    if (pool != NULL) {
+        threadpool_parallel_for(pool, 0, batch->count, 64, preload_read_range, batch);
+    } else {
+        preload_read_range(0, batch->count, batch);
+    }
+    for (size_t i = 0; i < batch->count; i++) {
+        if (batch->read_ok[i] && hash_insert_account(&batch->accounts[i])) {
+            batch->loaded++;
+        }
+    }
+    batch->count = 0;
+}
+
+/**
+ * @brief 加入一个 .card 文件名（取前36个字符为UUID），凑满一批时读取
+ */
+static void preload_add(const char *name, PreloadBatch *batch)
+{
+    char *uuid = batch->uuids[batch->count];
+    strncpy(uuid, name, 36);
+    uuid[36] = '\0';
+    
+    /* 移除.card后缀 */
+    char *dot = strrchr(uuid, '.');
+    if (dot) *dot = '\0';
+    
+    if (++batch->count == PRELOAD_BATCH) {
+        preload_flush(batch);
+    }
+}
+
 /**
  * @brief 初始化账户系统
  */
@@ -420,10 +551,20 @@ bool init_account_system(void)
     }
 
     account_op_lock_init();
+
+    /* 磁盘索引启用后账户按需从索引读取，不再预载 */
+    init_disk_index();
+    if (disk_index_active()) {
+        return true;
+    }
     
     /* 加载所有本地账户到 Hash 表 */
     printf("[Hash] 正在加载本地账户到 Hash 表...\n");
-    int loaded_count = 0;
+    PreloadBatch *batch = calloc(1, sizeof(PreloadBatch));
+    if (batch == NULL) {
+        fprintf(stderr, "错误：内存不足，无法加载本地账户\n");
+        return false;
+    }
     
 #ifdef _WIN32
     /* Windows平台 */
@@ -432,22 +573,7 @@ bool init_account_system(void)
     
     if (handle != -1) {
         do {
-            /* 提取UUID */
-            char uuid[37];
-            strncpy(uuid, fileinfo.name, 36);
-            uuid[36] = '\0';
-            
-            /* 移除.card后缀 */
-            char *dot = strrchr(uuid, '.');
-            if (dot) *dot = '\0';
-            
-            /* 加载账户并插入 Hash 表 */
-            ACCOUNT acc;
-            if (load_account(uuid, &acc)) {
-                if (hash_insert_account(&acc)) {
-                    loaded_count++;
-                }
-            }
+            preload_add(fileinfo.name, batch);
         } while (_findnext(handle, &fileinfo) == 0);
         
         _findclose(handle);
@@ -462,27 +588,18 @@ bool init_account_system(void)
             if (strstr(entry->d_name, ".card") == NULL) {
                 continue;
             }
-            
-            /* 提取UUID */
-            char uuid[37];
-            strncpy(uuid, entry->d_name, 36);
-            uuid[36] = '\0';
-            
-            /* 加载账户并插入 Hash 表 */
-            ACCOUNT acc;
-            if (load_account(uuid, &acc)) {
-                if (hash_insert_account(&acc)) {
-                    loaded_count++;
-                }
-            }
+            preload_add(entry->d_name, batch);
         }
         
         closedir(dir);
     }
 #endif
+    preload_flush(batch);
+    int loaded_count = batch->loaded;
+    free(batch);
     
     printf("[Hash] 已加载 %d 个账户到 Hash 表\n", loaded_count);
-    printf("[Hash] 当前负载因子: %.2f\n", calculate_load_factor());
+    printf("[Hash] 当前负载因子: %.2f\n", calculate_load_factor(&g_hash_table));
     
     return true;
 }
@@ -492,6 +609,7 @@ bool init_account_system(void)
  */
 void cleanup_account_system(void)
 {
+    cleanup_disk_index();
     cleanup_account_hash_table();
     account_op_lock_destroy();
 }
@@ -528,6 +646,63 @@ void generate_uuid_string(char *uuid_str)
 #endif
 }
 
+/* 小写十六进制字符的值，其他字符为 0xff；查表代替比较，随机 UUID 上没有分支预测失败 */
+static const unsigned char g_uuid_hex[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 10, 11, 12, 13, 14, 15, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/**
+ * @brief UUID字符串转16字节
+ */
+bool uuid_to_bytes(const char *uuid_str, unsigned char key[16])
+{
+    static const unsigned char offsets[16] = { 0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34 };
+    const unsigned char *s = (const unsigned char *)uuid_str;
+    if (strnlen(uuid_str, 37) != 36 || s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-') {
+        return false;
+    }
+    unsigned bad = 0;
+    for (int k = 0; k < 16; k++) {
+        unsigned hi = g_uuid_hex[s[offsets[k]]];
+        unsigned lo = g_uuid_hex[s[offsets[k] + 1]];
+        bad |= hi | lo;
+        key[k] = (unsigned char)((hi << 4) | lo);
+    }
+    return bad < 16;
+}
+
+/**
+ * @brief 16字节转UUID字符串
+ */
+void uuid_from_bytes(const unsigned char key[16], char *uuid_str)
+{
+    static const char digits[] = "0123456789abcdef";
+    char *p = uuid_str;
+    for (int i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) {
+            *p++ = '-';
+        }
+        *p++ = digits[key[i] >> 4];
+        *p++ = digits[key[i] & 0x0F];
+    }
+    *p = '\0';
+}
+
 /* ==================== 密钥管理 ==================== */
 
 /**
@@ -624,10 +799,43 @@ bool create_card_directory(void)
     return true;
 }
 
+/* ==================== 批量写入状态（线程局部） ==================== */
+
+static _Thread_local bool t_batch_active = false;      /* 当前线程是否处于批量写入 */
+static _Thread_local char (*t_batch_uuids)[37] = NULL; /* 批量期间修改过的账户 */
+static _Thread_local size_t t_batch_count = 0;
+static _Thread_local size_t t_batch_capacity = 0;
+
 /**
- * @brief 保存账户到文件
+ * @brief 记录批量期间修改过的账户
+ * @return 记录成功返回true，内存不足返回false（调用方应立即写文件）
  */
-bool save_account(const ACCOUNT *acc)
+static bool batch_record_uuid(const char *uuid)
+{
+    if (t_batch_count == t_batch_capacity) {
+        size_t new_capacity = t_batch_capacity ? t_batch_capacity * 2 : 64;
+        char (*grown)[37] = realloc(t_batch_uuids, new_capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return false;
+        }
+        t_batch_uuids = grown;
+        t_batch_capacity = new_capacity;
+    }
+
+    memcpy(t_batch_uuids[t_batch_count], uuid, 37);
+    t_batch_count++;
+    return true;
+}
+
+static int cmp_batch_uuid(const void *a, const void *b)
+{
+    return strcmp((const char *)a, (const char *)b);
+}
+
+/**
+ * @brief 将账户写入 Card/<UUID>.card（不修改 Hash 表）
+ */
+bool account_write_file(const ACCOUNT *acc)
 {
     char filename[50];// 32位UUID 
     snprintf(filename, sizeof(filename), "Card/%s.card", acc->UUID);
@@ -655,6 +863,47 @@ bool save_account(const ACCOUNT *acc)
     
     fclose(file);
     
+    /* 先写文件再更新磁盘索引 */
+    return disk_index_put(acc);
+}
+
+/**
+ * @brief 按当前存储模式保存账户
+ */
+static bool account_store_put(const ACCOUNT *acc)
+{
+    /* 分片模式下账户归所属分片管理 */
+    if (shard_engine_running()) {
+        return shard_put_account(acc);
+    }
+
+    /* 多进程共享存储：持条带锁写文件并更新共享表 */
+    if (shm_store_active()) {
+        shm_store_lock(acc->UUID, NULL);
+        bool ok = account_write_file(acc) && shm_store_put(acc);
+        shm_store_unlock(acc->UUID, NULL);
+        return ok;
+    }
+
+    /* journal 模式：追加日志后只更新内存，由后台刷盘线程写回文件 */
+    if (flusher_active()) {
+        if (!flusher_record_put(acc)) {
+            return false;
+        }
+        hash_update_account(acc);
+        return true;
+    }
+
+    /* 批量期间只记录，account_end_batch() 时统一落盘 */
+    if (t_batch_active && batch_record_uuid(acc->UUID)) {
+        hash_update_account(acc);
+        return true;
+    }
+
+    if (!account_write_file(acc)) {
+        return false;
+    }
+    
     /* 同步更新 Hash 表 */
     hash_update_account(acc);
     
@@ -662,18 +911,143 @@ bool save_account(const ACCOUNT *acc)
 }
 
 /**
- * @brief 从文件加载账户
+ * @brief 保存账户到文件
  */
-bool load_account(const char *uuid, ACCOUNT *acc)
+bool save_account(const ACCOUNT *acc)
 {
-    /* 首先尝试从 Hash 表查找 */
-    ACCOUNT *cached_acc = hash_find_account(uuid);
+    if (!account_store_put(acc)) {
+        return false;
+    }
+
+    /* 主节点把变更推送给热备节点 */
+    replication_record_put(acc);
+    return true;
+}
+
+/**
+ * @brief 开始批量写入
+ */
+void account_begin_batch(void)
+{
+    t_batch_active = true;
+    t_batch_count = 0;
+}
+
+/**
+ * @brief 结束批量写入，同一账户多次修改只写最后一次
+ */
+bool account_end_batch(void)
+{
+    bool ok = true;
+
+    t_batch_active = false;
+    if (t_batch_count == 0) {
+        return true;
+    }
+
+    qsort(t_batch_uuids, t_batch_count, sizeof(t_batch_uuids[0]), cmp_batch_uuid);
+
+    account_op_lock();
+    for (size_t i = 0; i < t_batch_count; i++) {
+        if (i > 0 && strcmp(t_batch_uuids[i], t_batch_uuids[i - 1]) == 0) {
+            continue;
+        }
+        /* 批量内已销户的账户不在 Hash 表中，跳过 */
+        ACCOUNT copy;
+        ACCOUNT *acc = hash_find_account(t_batch_uuids[i]);
+        if (acc == NULL && compact_store_active() &&
+            compact_store_get(compact_store_global(), t_batch_uuids[i], &copy)) {
+            acc = &copy;
+        }
+        if (acc != NULL && !account_write_file(acc)) {
+            ok = false;
+        }
+    }
+    account_op_unlock();
+
+    t_batch_count = 0;
+    return ok;
+}
+
+/**
+ * @brief 释放当前线程的批量写入缓冲区
+ */
+void account_batch_thread_cleanup(void)
+{
+    free(t_batch_uuids);
+    t_batch_uuids = NULL;
+    t_batch_count = 0;
+    t_batch_capacity = 0;
+    t_batch_active = false;
+}
+
+/**
+ * @brief 从文件加载账户
+ */
+bool load_account(const char *uuid, ACCOUNT *acc)
+{
+    /* 分片模式下从所属分片读取 */
+    if (shard_engine_running()) {
+        return shard_get_account(uuid, acc);
+    }
+
+    /* 共享表未命中时（其他程序新建的 .card 文件）从文件载入 */
+    if (shm_store_active()) {
+        if (shm_store_get(uuid, acc)) {
+            return true;
+        }
+        return account_read_file(uuid, acc) && shm_store_put(acc);
+    }
+
+    /* 紧凑表模式：未命中时同样回退到文件 */
+    if (compact_store_active()) {
+        if (compact_store_get(compact_store_global(), uuid, acc)) {
+            return true;
+        }
+        return account_read_file(uuid, acc) && hash_insert_account(acc);
+    }
+
+    /* 首先尝试从 Hash 表查找 */
+    ACCOUNT *cached_acc = hash_find_account(uuid);
     if (cached_acc != NULL) {
+        if (tiering_active()) {
+            /* account 是 AccountNode 的首个成员 */
+            ((AccountNode *)cached_acc)->last_access = time(NULL);
+        }
         *acc = *cached_acc;
         return true;
     }
+
+    /* 冷段命中：写回 .card 文件并插入 Hash 表，提升回热层 */
+    if (tiering_active() && tiering_cold_get(uuid, acc)) {
+        if (account_write_file(acc)) {
+            hash_insert_account(acc);
+            tiering_mark_promoted(uuid);
+        }
+        return true;
+    }
     
     /* Hash 表未命中，从文件读取 */
+    if (!account_read_file(uuid, acc)) {
+        return false;
+    }
+    
+    /* 加载成功后，插入 Hash 表以加速后续查找 */
+    hash_insert_account(acc);
+    
+    return true;
+}
+
+/**
+ * @brief 从 Card/<UUID>.card 读取账户（不访问 Hash 表）
+ */
+bool account_read_file(const char *uuid, ACCOUNT *acc)
+{
+    /* 磁盘索引中保存着与文件相同的数据，未收录时（外部放入的文件）再读文件 */
+    if (disk_index_get(uuid, acc)) {
+        return true;
+    }
+
     char filename[50];
     snprintf(filename, sizeof(filename), "Card/%s.card", uuid);
     
@@ -682,13 +1056,16 @@ bool load_account(const char *uuid, ACCOUNT *acc)
         return false;
     }
     
-    /* 读取UUID
-     * 需要注意linux底层文件读取时文件指针指针移动规则->读取多少字节移动多少字节 问题引导:下一次是否会从最后一个字节位置开始读取 
-    */
-    if (fscanf(file, "%36s\n", acc->UUID) != 1) {
+    /* 读取UUID行：定长36字符加换行。不能用 fscanf("%36s\n")，格式中的换行会跳过
+     * 任意空白，加密数据的第一个字节恰为空白字符（0x09-0x0D、0x20）时会被一并吞掉
+     */
+    char line[37];
+    if (fread(line, 1, sizeof(line), file) != sizeof(line) || line[36] != '\n') {
         fclose(file);
         return false;
     }
+    memcpy(acc->UUID, line, 36);
+    acc->UUID[36] = '\0';
     
     /* 读取加密数据 */
     unsigned char buffer[sizeof(LLUINT) * 2];
@@ -706,9 +1083,6 @@ bool load_account(const char *uuid, ACCOUNT *acc)
     memcpy(&acc->PASSWORD, buffer, sizeof(LLUINT));
     memcpy(&acc->BALANCE, buffer + sizeof(LLUINT), sizeof(LLUINT));
     
-    /* 加载成功后，插入 Hash 表以加速后续查找 */
-    hash_insert_account(acc);
-    
     return true;
 }
 
@@ -841,244 +1215,1195 @@ static bool select_account_uuid(char out_uuid[37])
 }
 
 /**
- * @brief 列出所有账户
+ * @brief 列出所有账户
+ */
+int list_all_accounts(void)
+{
+    AccountListItem *items = NULL;
+    int count = load_account_list(&items);
+
+    PRINTF_G("\n========== 账户列表 ==========\n");
+    if (count <= 0) {
+        PRINTF_G("暂无账户\n");
+        return 0;
+    }
+
+    if (g_account_sort_mode == ACCOUNT_SORT_UUID_TIME) {
+        qsort(items, (size_t)count, sizeof(AccountListItem), cmp_by_mtime_desc);
+    } else {
+        qsort(items, (size_t)count, sizeof(AccountListItem), cmp_by_balance_desc);
+    }
+
+    for (int i = 0; i < count; i++) {
+        PRINTF_G("%d. UUID: %s\n", i + 1, items[i].acc.UUID);
+        PRINTF_G("   余额: %.2f 元\n", items[i].acc.BALANCE / 100.0);
+    }
+
+    free(items);
+
+    PRINTF_G("==============================\n");
+    PRINTF_G("共 %d 个账户\n\n", count);
+    return count;
+}
+
+/**
+ * @brief 获取所有本地账户的UUID列表
+ */
+int get_all_account_uuids(char uuids[][37], int max_count)
+{
+    int count = 0;
+
+    /* journal 模式下新建的账户可能尚未写回 .card 文件 */
+    flusher_flush_now();
+    
+#ifdef _WIN32
+    /* Windows平台 */
+    struct _finddata_t fileinfo;
+    intptr_t handle = _findfirst("Card/*.card", &fileinfo);
+    
+    if (handle == -1) {
+        return 0;
+    }
+    
+    do {
+        if (count >= max_count) break;
+        
+        /* 提取UUID */
+        strncpy(uuids[count], fileinfo.name, 36);
+        uuids[count][36] = '\0';
+        
+        /* 移除.card后缀 */
+        char *dot = strrchr(uuids[count], '.');
+        if (dot) *dot = '\0';
+        
+        count++;
+    } while (_findnext(handle, &fileinfo) == 0);
+    
+    _findclose(handle);
+#else
+    /* Linux平台 */
+    DIR *dir = opendir("Card");
+    if (dir == NULL) {
+        return 0;
+    }
+    
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && count < max_count) {
+        /* 只处理.card文件 */
+        if (strstr(entry->d_name, ".card") == NULL) {
+            continue;
+        }
+        
+        /* 提取UUID */
+        strncpy(uuids[count], entry->d_name, 36);
+        uuids[count][36] = '\0';
+        count++;
+    }
+    
+    closedir(dir);
+#endif
+
+    /* 冷段中的账户没有 .card 文件 */
+    if (count < max_count) {
+        count += (int)tiering_cold_list(uuids + count, (size_t)(max_count - count));
+    }
+    
+    return count;
+}
+
+/**
+ * @brief 复制当前全部账户的内存状态
+ */
+size_t account_collect_all(ACCOUNT *out, size_t max_count, bool *truncated)
+{
+    size_t n = 0;
+    bool more = false;
+
+    if (shard_engine_running() || shm_store_active()) {
+        /* 账户不在全局 Hash 表中，按文件列表经 load_account() 路由读取 */
+        char (*uuids)[37] = malloc((max_count + 1) * sizeof(*uuids));
+        if (uuids == NULL) {
+            return 0;
+        }
+        int total = get_all_account_uuids(uuids, (int)(max_count + 1));
+        for (int i = 0; i < total && n < max_count; i++) {
+            if (load_account(uuids[i], &out[n])) {
+                n++;
+            }
+        }
+        more = (size_t)total > max_count;
+        free(uuids);
+    } else if (compact_store_active()) {
+        CompactStoreStats stats;
+        compact_store_get_stats(compact_store_global(), &stats);
+        n = compact_store_collect(compact_store_global(), out, max_count);
+        more = stats.count > n;
+    } else if (disk_index_active()) {
+        /* Hash 表只缓存访问过的账户；批量写入期间内存中的版本较新 */
+        flusher_flush_now();
+        DiskIndexStats stats;
+        disk_index_get_stats(&stats);
+        n = disk_index_collect(out, max_count);
+        more = stats.count > n;
+        account_op_lock();
+        for (size_t i = 0; i < n; i++) {
+            ACCOUNT *cached = hash_find_account(out[i].UUID);
+            if (cached != NULL) {
+                out[i] = *cached;
+            }
+        }
+        account_op_unlock();
+    } else if (g_hash_table_initialized) {
+        account_op_lock();
+        for (size_t i = 0; i < g_hash_table.size && !more; i++) {
+            for (AccountNode *node = g_hash_table.buckets[i]; node != NULL; node = node->next) {
+                if (n == max_count) {
+                    more = true;
+                    break;
+                }
+                out[n++] = node->account;
+            }
+        }
+        account_op_unlock();
+
+        /* 多取一个用于判断是否截断 */
+        if (!more && tiering_active()) {
+            ACCOUNT *cold = malloc((max_count - n + 1) * sizeof(ACCOUNT));
+            if (cold != NULL) {
+                size_t cold_n = tiering_cold_collect(cold, max_count - n + 1);
+                more = cold_n > max_count - n;
+                if (more) {
+                    cold_n = max_count - n;
+                }
+                memcpy(out + n, cold, cold_n * sizeof(ACCOUNT));
+                n += cold_n;
+                free(cold);
+            }
+        }
+    }
+
+    if (truncated != NULL) {
+        *truncated = more;
+    }
+    return n;
+}
+
+/**
+ * @brief 把空闲账户移出热层
+ */
+size_t account_evict_idle(time_t idle_before, AccountEvictFunc persist, void *user)
+{
+    if (!g_hash_table_initialized) {
+        return 0;
+    }
+
+    account_op_lock();
+
+    size_t count = 0;
+    for (size_t i = 0; i < g_hash_table.size; i++) {
+        for (AccountNode *node = g_hash_table.buckets[i]; node != NULL; node = node->next) {
+            if (node->last_access <= idle_before) {
+                count++;
+            }
+        }
+    }
+
+    size_t evicted = 0;
+    ACCOUNT *idle = (count > 0) ? malloc(count * sizeof(ACCOUNT)) : NULL;
+    if (idle != NULL) {
+        size_t n = 0;
+        for (size_t i = 0; i < g_hash_table.size; i++) {
+            for (AccountNode *node = g_hash_table.buckets[i]; node != NULL; node = node->next) {
+                if (node->last_access <= idle_before) {
+                    idle[n++] = node->account;
+                }
+            }
+        }
+
+        /* 冷段写入成功后才删除热层副本 */
+        evicted = persist(idle, n, user);
+        for (size_t i = 0; i < evicted; i++) {
+            account_remove_file(idle[i].UUID);
+            hash_delete_account(idle[i].UUID);
+        }
+        free(idle);
+    }
+
+    account_op_unlock();
+    return evicted;
+}
+
+/**
+ * @brief 统计热层账户数与常驻内存
+ */
+void account_hot_usage(size_t *count, size_t *bytes)
+{
+    *count = 0;
+    *bytes = 0;
+    if (!g_hash_table_initialized) {
+        return;
+    }
+
+    account_op_lock();
+    *count = g_hash_table.count;
+    *bytes = g_hash_table.count * sizeof(AccountNode) + g_hash_table.size * sizeof(AccountNode *);
+    account_op_unlock();
+}
+
+/* ==================== 增量同步水位 ==================== */
+
+#define SYNC_STATE_FILE "sync.state"
+
+/**
+ * @brief 增量同步水位（保存在 sync.state，删除后下次启动做全量同步）
+ */
+typedef struct {
+    char server[256];       /**< 水位所属的服务器地址，换服务器时做全量同步 */
+    time_t push_since;      /**< .card 文件修改时间不早于此的账户需要推送，0 表示全量推送 */
+    int64_t pull_since;     /**< 服务器上次返回的水位，0 表示全量拉取 */
+} SyncState;
+
+static SyncState g_sync_state;
+static bool g_sync_push_complete = false;  /**< 本次启动的推送是否全部成功 */
+static atomic_bool g_sync_quiet;           /**< 后台同步时不打印（界面已显示） */
+static atomic_size_t g_sync_push_done;
+static atomic_size_t g_sync_push_total;
+static atomic_size_t g_sync_pulled;
+
+/**
+ * @brief 推送快照与同步期间被交易修改过的账户
+ *
+ * account_sync_begin() 取好推送快照后交易即可执行：交易在本地完成，服务器一侧
+ * 留在同步队列中，拉取时跳过这些账户，服务器上的旧余额不会覆盖本地的新余额。
+ */
+static struct {
+    bool prepared;                /* 已取推送快照，尚未推送 */
+    ACCOUNT *accounts;
+    size_t count;
+    time_t started;               /* 取快照的时间，推送全部成功后作为水位 */
+    atomic_bool tracking;
+    bool lock_inited;
+    PlatformMutex lock;           /* 保护 touched，拉取时覆盖单个账户期间持有 */
+    char (*touched)[37];
+    size_t touched_count;
+    size_t touched_capacity;
+} g_sync_pending;
+
+#define SYNC_PRINTF(...) do { if (!atomic_load(&g_sync_quiet)) printf(__VA_ARGS__); } while (0)
+#define SYNC_EPRINTF(...) do { if (!atomic_load(&g_sync_quiet)) fprintf(stderr, __VA_ARGS__); } while (0)
+
+static void load_sync_state(void)
+{
+    memset(&g_sync_state, 0, sizeof(g_sync_state));
+    const ServerConfig *config = get_server_config();
+    if (config == NULL) {
+        return;
+    }
+
+    FILE *file = fopen(SYNC_STATE_FILE, "r");
+    if (file == NULL) {
+        return;
+    }
+
+    SyncState state;
+    memset(&state, 0, sizeof(state));
+    char line[320];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "server=", 7) == 0) {
+            /* 过长的地址不可能是当前服务器，保持为空，按首次同步处理 */
+            size_t len = strlen(line + 7);
+            if (len < sizeof(state.server)) {
+                memcpy(state.server, line + 7, len + 1);
+            }
+        } else if (strncmp(line, "push_since=", 11) == 0) {
+            state.push_since = (time_t)strtoll(line + 11, NULL, 10);
+        } else if (strncmp(line, "pull_since=", 11) == 0) {
+            state.pull_since = (int64_t)strtoll(line + 11, NULL, 10);
+        }
+    }
+    fclose(file);
+
+    /* 水位只对记录它的服务器有效 */
+    if (strcmp(state.server, config->server_url) == 0) {
+        g_sync_state = state;
+    }
+}
+
+static void save_sync_state(void)
+{
+    const ServerConfig *config = get_server_config();
+    if (config == NULL) {
+        return;
+    }
+    snprintf(g_sync_state.server, sizeof(g_sync_state.server), "%s", config->server_url);
+
+    /* 先写临时文件再改名，中途崩溃时保留旧水位 */
+    FILE *file = fopen(SYNC_STATE_FILE ".tmp", "w");
+    if (file == NULL) {
+        return;
+    }
+    fprintf(file, "# BAMSYSTEM 增量同步水位（自动生成，删除后下次启动做全量同步）\n");
+    fprintf(file, "server=%s\n", g_sync_state.server);
+    fprintf(file, "push_since=%lld\n", (long long)g_sync_state.push_since);
+    fprintf(file, "pull_since=%lld\n", (long long)g_sync_state.pull_since);
+    bool ok = fflush(file) == 0;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        remove(SYNC_STATE_FILE ".tmp");
+        return;
+    }
+#ifdef _WIN32
+    remove(SYNC_STATE_FILE);
+#endif
+    rename(SYNC_STATE_FILE ".tmp", SYNC_STATE_FILE);
+}
+
+/**
+ * @brief 收集 .card 文件修改时间不早于 since 的账户
+ * @return 内存不足时返回false
+ * @note 冷段账户按冷段中记录的修改时间判断，只读取不提升；
+ *       既无 .card 文件也不在冷段的账户无法判断，按已修改处理
+ */
+static bool collect_accounts_modified_since(time_t since, ACCOUNT **out, size_t *count,
+                                            size_t *scanned)
+{
+    *out = NULL;
+    *count = 0;
+    *scanned = 0;
+
+    int capacity = 1024;
+    char (*uuids)[37] = NULL;
+    int total;
+    for (;;) {
+        char (*grown)[37] = realloc(uuids, (size_t)capacity * sizeof(*uuids));
+        if (grown == NULL) {
+            free(uuids);
+            return false;
+        }
+        uuids = grown;
+        total = get_all_account_uuids(uuids, capacity);
+        if (total < capacity) {
+            break;
+        }
+        capacity *= 2;
+    }
+
+    ACCOUNT *accounts = NULL;
+    size_t n = 0;
+    size_t cap = 0;
+    for (int i = 0; i < total; i++) {
+        char filename[64];
+        snprintf(filename, sizeof(filename), "Card/%s.card", uuids[i]);
+        struct stat st;
+        bool has_file = stat(filename, &st) == 0;
+        if (has_file && st.st_mtime < since) {
+            continue;
+        }
+        ACCOUNT cold;
+        time_t cold_modified = 0;
+        bool is_cold = !has_file && tiering_cold_peek(uuids[i], &cold, &cold_modified);
+        if (is_cold && cold_modified < since) {
+            continue;
+        }
+        if (n == cap) {
+            cap = cap ? cap * 2 : 64;
+            ACCOUNT *grown = realloc(accounts, cap * sizeof(ACCOUNT));
+            if (grown == NULL) {
+                free(accounts);
+                free(uuids);
+                return false;
+            }
+            accounts = grown;
+        }
+        bool loaded;
+        if (is_cold) {
+            accounts[n] = cold;
+            loaded = true;
+        } else if (has_file && disk_index_active()) {
+            /* 磁盘索引模式下 load_account() 会把账户插入 Hash 表 */
+            loaded = account_read_file(uuids[i], &accounts[n]);
+        } else {
+            loaded = load_account(uuids[i], &accounts[n]);
+        }
+        if (loaded) {
+            n++;
+        }
+    }
+    free(uuids);
+
+    *out = accounts;
+    *count = n;
+    *scanned = (size_t)total;
+    return true;
+}
+
+static void sync_progress_print(size_t done, size_t total, void *user)
+{
+    (void)user;
+    atomic_store(&g_sync_push_done, done);
+    atomic_store(&g_sync_push_total, total);
+    SYNC_PRINTF("\r[推送] 进度 %zu/%zu", done, total);
+    fflush(stdout);
+}
+
+/**
+ * @brief 读取本次需要推送的账户（有水位时增量，否则全量）
+ */
+static bool sync_collect_push(ACCOUNT **out, size_t *count)
+{
+    load_sync_state();
+    size_t total_count = 0;
+    ACCOUNT *accounts = NULL;
+
+    if (g_sync_state.push_since > 0) {
+        /* 增量：只推送上次同步后修改过的账户 */
+        size_t scanned = 0;
+        if (!collect_accounts_modified_since(g_sync_state.push_since, &accounts, &total_count,
+                                             &scanned)) {
+            SYNC_EPRINTF("[推送] 内存不足\n");
+            return false;
+        }
+        SYNC_PRINTF("[推送] 增量同步：%zu 个本地账户中 %zu 个在上次同步后修改过\n",
+                    scanned, total_count);
+    }
+
+    /* 全量：复制全部本地账户（数量不设上限，不够时扩容重取） */
+    size_t capacity = 1024;
+    while (g_sync_state.push_since == 0) {
+        ACCOUNT *grown = realloc(accounts, capacity * sizeof(ACCOUNT));
+        if (grown == NULL) {
+            free(accounts);
+            SYNC_EPRINTF("[推送] 内存不足\n");
+            return false;
+        }
+        accounts = grown;
+        bool truncated = false;
+        total_count = account_collect_all(accounts, capacity, &truncated);
+        if (!truncated) {
+            break;
+        }
+        capacity *= 2;
+    }
+    *out = accounts;
+    *count = total_count;
+    return true;
+}
+
+bool account_sync_begin(void)
+{
+    if (get_run_mode() != MODE_SERVER) {
+        return false;
+    }
+    free(g_sync_pending.accounts);
+    g_sync_pending.accounts = NULL;
+    g_sync_pending.prepared = false;
+    g_sync_pending.started = time(NULL);
+    if (!sync_collect_push(&g_sync_pending.accounts, &g_sync_pending.count)) {
+        return false;
+    }
+    if (!g_sync_pending.lock_inited) {
+        platform_mutex_init(&g_sync_pending.lock);
+        g_sync_pending.lock_inited = true;
+    }
+    g_sync_pending.prepared = true;
+    g_sync_pending.touched_count = 0;
+    atomic_store(&g_sync_pending.tracking, true);
+    return true;
+}
+
+/**
+ * @brief 结束同步期间的账户跟踪
+ */
+static void sync_end_tracking(void)
+{
+    if (!atomic_load(&g_sync_pending.tracking)) {
+        return;
+    }
+    platform_mutex_lock(&g_sync_pending.lock);
+    atomic_store(&g_sync_pending.tracking, false);
+    free(g_sync_pending.touched);
+    g_sync_pending.touched = NULL;
+    g_sync_pending.touched_count = 0;
+    g_sync_pending.touched_capacity = 0;
+    platform_mutex_unlock(&g_sync_pending.lock);
+}
+
+/**
+ * @brief 记录同步期间交易要修改的账户
+ * @note 在交易执行前调用；正在被拉取覆盖的账户会等覆盖完成后再交易
+ */
+static void sync_touch(const char *uuid)
+{
+    if (uuid == NULL || !atomic_load(&g_sync_pending.tracking)) {
+        return;
+    }
+    platform_mutex_lock(&g_sync_pending.lock);
+    if (atomic_load(&g_sync_pending.tracking)) {
+        if (g_sync_pending.touched_count == g_sync_pending.touched_capacity) {
+            size_t capacity = g_sync_pending.touched_capacity ? g_sync_pending.touched_capacity * 2 : 16;
+            char (*grown)[37] = realloc(g_sync_pending.touched, capacity * sizeof(*grown));
+            if (grown != NULL) {
+                g_sync_pending.touched = grown;
+                g_sync_pending.touched_capacity = capacity;
+            }
+        }
+        if (g_sync_pending.touched_count < g_sync_pending.touched_capacity) {
+            snprintf(g_sync_pending.touched[g_sync_pending.touched_count++], 37, "%s", uuid);
+        }
+    }
+    platform_mutex_unlock(&g_sync_pending.lock);
+}
+
+/**
+ * @brief 账户是否在同步期间被交易修改过，调用方持有 g_sync_pending.lock
+ */
+static bool sync_touched_locked(const char *uuid)
+{
+    for (size_t i = 0; i < g_sync_pending.touched_count; i++) {
+        if (strcmp(g_sync_pending.touched[i], uuid) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 同步所有本地账户到服务器
+ */
+int sync_all_accounts_to_server(void)
+{
+    /* 检查是否处于服务器模式 */
+    if (get_run_mode() != MODE_SERVER) {
+        SYNC_PRINTF("[推送] 未连接到服务器，跳过同步\n");
+        sync_end_tracking();
+        return 0;
+    }
+    
+    g_sync_push_complete = false;
+    atomic_store(&g_sync_push_done, 0);
+    atomic_store(&g_sync_push_total, 0);
+    time_t push_started;
+    size_t total_count = 0;
+    ACCOUNT *accounts = NULL;
+
+    if (g_sync_pending.prepared) {
+        /* 使用 account_sync_begin() 取好的快照 */
+        accounts = g_sync_pending.accounts;
+        total_count = g_sync_pending.count;
+        push_started = g_sync_pending.started;
+        g_sync_pending.accounts = NULL;
+        g_sync_pending.prepared = false;
+    } else {
+        push_started = time(NULL);
+        if (!sync_collect_push(&accounts, &total_count)) {
+            return 0;
+        }
+    }
+    
+    if (total_count == 0) {
+        SYNC_PRINTF("[推送] 本地没有账户需要同步\n");
+        free(accounts);
+        g_sync_push_complete = true;
+        g_sync_state.push_since = push_started;
+        save_sync_state();
+        return 0;
+    }
+    
+    SYNC_PRINTF("[推送] 发现 %zu 个本地账户，开始推送到服务器...\n", total_count);
+    
+    /* 并发推送，每完成一个刷新进度 */
+    SyncBatchStats stats;
+    size_t success_count = api_sync_accounts(accounts, total_count, NULL,
+                                             sync_progress_print, NULL, &stats);
+    free(accounts);
+    
+    double seconds = stats.elapsed_us / 1e6;
+    SYNC_PRINTF("\n[推送] 推送完成: 成功 %zu 个, 失败 %zu 个, 请求 %zu 次 (每批 %zu 个, 重试 %zu 次), "
+                "耗时 %.2f 秒 (%.0f 个/秒, 并发 %zu)\n",
+                stats.succeeded, stats.failed, stats.requests, stats.batch_size, stats.retries,
+                seconds, seconds > 0 ? stats.total / seconds : 0.0, stats.max_in_flight);
+
+    /* 全部成功才前移水位，失败的账户下次启动重新推送 */
+    if (stats.failed == 0 && success_count == total_count) {
+        g_sync_push_complete = true;
+        g_sync_state.push_since = push_started;
+        save_sync_state();
+    }
+    return (int)success_count;
+}
+
+/**
+ * @brief 拉取全部成功后保存水位
+ * @note 本次推送也全部成功时把推送水位移到拉取之后，拉取写入的 .card 不会在下次启动被推回
+ */
+static void pull_advance_watermark(int64_t watermark)
+{
+    if (watermark <= 0) {
+        return;  /* 旧服务器不支持增量拉取 */
+    }
+    g_sync_state.pull_since = watermark;
+    if (g_sync_push_complete) {
+        g_sync_state.push_since = time(NULL);
+    }
+    save_sync_state();
+}
+
+typedef struct {
+    int success_count;
+    int fail_count;
+    int skipped_count;      /**< 同步期间被交易修改过、保留本地余额的账户数 */
+} PullProgress;
+
+/**
+ * @brief 保存一页服务器账户到本地
+ */
+static bool pull_apply_page(const ACCOUNT *accounts, size_t count, void *user)
+{
+    PullProgress *progress = user;
+    
+    bool tracking = atomic_load(&g_sync_pending.tracking);
+    for (size_t i = 0; i < count; i++) {
+        ACCOUNT acc = accounts[i];
+
+        /* 同步期间被交易修改过的账户保留本地余额，交易随同步队列发给服务器 */
+        if (tracking) {
+            platform_mutex_lock(&g_sync_pending.lock);
+            if (sync_touched_locked(acc.UUID)) {
+                platform_mutex_unlock(&g_sync_pending.lock);
+                progress->success_count++;
+                progress->skipped_count++;
+                continue;
+            }
+        }
+        
+        /* 检查本地是否已存在该账户 */
+        ACCOUNT local_acc;
+        bool exists = load_account(acc.UUID, &local_acc);
+        
+        if (exists) {
+            /* 本地已存在，比较并更新余额 */
+            if (local_acc.BALANCE != acc.BALANCE) {
+                /* 保留本地密码 */
+                acc.PASSWORD = local_acc.PASSWORD;
+                
+                if (save_account(&acc)) {
+                    progress->success_count++;
+                } else {
+                    progress->fail_count++;
+                }
+            } else {
+                progress->success_count++;
+            }
+        } else {
+            /* 本地不存在，新建账户（密码设为0） */
+            acc.PASSWORD = 0;
+            
+            if (save_account(&acc)) {
+                progress->success_count++;
+            } else {
+                progress->fail_count++;
+            }
+        }
+        if (tracking) {
+            platform_mutex_unlock(&g_sync_pending.lock);
+        }
+    }
+    
+    atomic_store(&g_sync_pulled, (size_t)progress->success_count);
+    SYNC_PRINTF("\r[拉取] 已保存 %d 个", progress->success_count);
+    fflush(stdout);
+    return true;
+}
+
+/**
+ * @brief 从服务器拉取账户并保存到本地
+ */
+static int pull_accounts(void)
+{
+    /* 检查是否处于服务器模式 */
+    if (get_run_mode() != MODE_SERVER) {
+        SYNC_PRINTF("[拉取] 未连接到服务器，跳过拉取\n");
+        return 0;
+    }
+    
+    /* 分页拉取上次拉取后修改过的账户（没有水位时拉取全部），逐页保存到本地 */
+    if (!g_sync_push_complete) {
+        load_sync_state();
+    }
+    PullProgress progress = {0, 0, 0};
+    atomic_store(&g_sync_pulled, 0);
+    int64_t watermark = 0;
+    int64_t count = api_pull_accounts(g_sync_state.pull_since, pull_apply_page, &progress,
+                                      &watermark);
+    if (progress.success_count + progress.fail_count > 0) {
+        SYNC_PRINTF("\n");
+    }
+    
+    if (count < 0) {
+        SYNC_EPRINTF("[拉取] 从服务器获取账户失败（已保存 %d 个）\n", progress.success_count);
+        return progress.success_count;
+    }
+    if (g_sync_state.pull_since > 0) {
+        SYNC_PRINTF("[拉取] 增量同步：服务器上 %lld 个账户在上次同步后修改过\n", (long long)count);
+    }
+    
+    if (count == 0) {
+        SYNC_PRINTF("[拉取] 服务器没有账户数据\n");
+        pull_advance_watermark(watermark);
+        return 0;
+    }
+    
+    SYNC_PRINTF("[拉取] 拉取完成: 成功 %d 个, 失败 %d 个\n",
+                progress.success_count, progress.fail_count);
+    if (progress.skipped_count > 0) {
+        SYNC_PRINTF("[拉取] %d 个账户在同步期间有交易，保留本地余额\n", progress.skipped_count);
+    }
+    if (progress.fail_count == 0) {
+        pull_advance_watermark(watermark);
+    }
+    return progress.success_count;
+}
+
+int pull_accounts_from_server(void)
+{
+    int pulled = pull_accounts();
+    sync_end_tracking();
+    return pulled;
+}
+
+void account_sync_set_quiet(bool quiet)
+{
+    atomic_store(&g_sync_quiet, quiet);
+}
+
+void account_sync_get_progress(SyncProgress *progress)
+{
+    progress->push_done = atomic_load(&g_sync_push_done);
+    progress->push_total = atomic_load(&g_sync_push_total);
+    progress->pulled = atomic_load(&g_sync_pulled);
+}
+
+/**
+ * @brief 按当前存储模式删除账户
+ */
+static bool account_store_remove(const char *uuid)
+{
+    /* 分片模式下由所属分片删除 */
+    if (shard_engine_running()) {
+        return shard_remove_account(uuid);
+    }
+
+    if (shm_store_active()) {
+        shm_store_lock(uuid, NULL);
+        bool ok = account_remove_file(uuid);
+        if (ok) {
+            shm_store_remove(uuid);
+        }
+        shm_store_unlock(uuid, NULL);
+        return ok;
+    }
+
+    if (flusher_active()) {
+        if (!flusher_record_delete(uuid)) {
+            return false;
+        }
+        hash_delete_account(uuid);
+        return true;
+    }
+
+    /* 冷段中的账户没有 .card 文件，从冷段删除即可 */
+    ACCOUNT cold;
+    bool cold_only = tiering_active() && hash_find_account(uuid) == NULL &&
+                     tiering_cold_get(uuid, &cold);
+    if (!cold_only && !account_remove_file(uuid)) {
+        return false;
+    }
+    
+    /* 同步从 Hash 表删除 */
+    hash_delete_account(uuid);
+    
+    return tiering_forget(uuid);
+}
+
+/**
+ * @brief 删除账户文件
+ */
+bool delete_account_file(const char *uuid)
+{
+    if (!account_store_remove(uuid)) {
+        return false;
+    }
+
+    replication_record_delete(uuid);
+    return true;
+}
+
+/**
+ * @brief 删除 Card/<UUID>.card（不访问 Hash 表）
+ */
+bool account_remove_file(const char *uuid)
+{
+    char filename[50];
+    snprintf(filename, sizeof(filename), "Card/%s.card", uuid);
+    
+    if (remove(filename) != 0) {
+        perror("错误：无法删除账户文件");
+        return false;
+    }
+    
+    return disk_index_remove(uuid);
+}
+
+/* ==================== 核心账户操作（非交互） ==================== */
+
+/**
+ * @brief 获取操作结果的中文描述
+ */
+const char* account_status_string(AccountStatus status)
+{
+    switch (status) {
+    case ACCOUNT_OK:               return "成功";
+    case ACCOUNT_ERR_NOT_FOUND:    return "账户不存在";
+    case ACCOUNT_ERR_INSUFFICIENT: return "余额不足";
+    case ACCOUNT_ERR_OVERFLOW:     return "余额溢出";
+    case ACCOUNT_ERR_HAS_BALANCE:  return "账户有余额，不能注销";
+    case ACCOUNT_ERR_SAME_ACCOUNT: return "不能转账给自己";
+    case ACCOUNT_ERR_INVALID:      return "参数无效";
+    case ACCOUNT_ERR_IO:           return "保存账户失败";
+    case ACCOUNT_ERR_BUSY:         return "操作队列已满，请稍后重试";
+    case ACCOUNT_ERR_READ_ONLY:    return "当前为热备节点，只读";
+    default:                       return "未知错误";
+    }
+}
+
+/**
+ * @brief 存款
+ */
+AccountStatus account_apply_deposit(const char *uuid, LLUINT amount, ACCOUNT *out)
+{
+    if (uuid == NULL || amount == 0) {
+        return ACCOUNT_ERR_INVALID;
+    }
+    if (replication_is_follower()) {
+        return ACCOUNT_ERR_READ_ONLY;
+    }
+
+    account_lock_accounts(uuid, NULL);
+
+    ACCOUNT acc;
+    if (!load_account(uuid, &acc)) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_NOT_FOUND;
+    }
+    if (acc.BALANCE > (LLUINT)(ULLONG_MAX - amount)) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_OVERFLOW;
+    }
+
+    acc.BALANCE += amount;
+    if (!save_account(&acc)) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_IO;
+    }
+
+    account_unlock_accounts(uuid, NULL);
+
+    if (out != NULL) {
+        *out = acc;
+    }
+    return ACCOUNT_OK;
+}
+
+/**
+ * @brief 取款
+ */
+AccountStatus account_apply_withdraw(const char *uuid, LLUINT amount, ACCOUNT *out)
+{
+    if (uuid == NULL || amount == 0) {
+        return ACCOUNT_ERR_INVALID;
+    }
+    if (replication_is_follower()) {
+        return ACCOUNT_ERR_READ_ONLY;
+    }
+
+    account_lock_accounts(uuid, NULL);
+
+    ACCOUNT acc;
+    if (!load_account(uuid, &acc)) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_NOT_FOUND;
+    }
+    if (acc.BALANCE < amount) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_INSUFFICIENT;
+    }
+
+    acc.BALANCE -= amount;
+    if (!save_account(&acc)) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_IO;
+    }
+
+    account_unlock_accounts(uuid, NULL);
+
+    if (out != NULL) {
+        *out = acc;
+    }
+    return ACCOUNT_OK;
+}
+
+/**
+ * @brief 转账
+ */
+AccountStatus account_apply_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount,
+                                     ACCOUNT *out_from, ACCOUNT *out_to)
+{
+    if (uuid_from == NULL || uuid_to == NULL || amount == 0) {
+        return ACCOUNT_ERR_INVALID;
+    }
+    if (strcmp(uuid_from, uuid_to) == 0) {
+        return ACCOUNT_ERR_SAME_ACCOUNT;
+    }
+    if (replication_is_follower()) {
+        return ACCOUNT_ERR_READ_ONLY;
+    }
+
+    account_lock_accounts(uuid_from, uuid_to);
+
+    ACCOUNT acc_from;
+    ACCOUNT acc_to;
+    if (!load_account(uuid_from, &acc_from) || !load_account(uuid_to, &acc_to)) {
+        account_unlock_accounts(uuid_from, uuid_to);
+        return ACCOUNT_ERR_NOT_FOUND;
+    }
+    if (acc_from.BALANCE < amount) {
+        account_unlock_accounts(uuid_from, uuid_to);
+        return ACCOUNT_ERR_INSUFFICIENT;
+    }
+    if (acc_to.BALANCE > (LLUINT)(ULLONG_MAX - amount)) {
+        account_unlock_accounts(uuid_from, uuid_to);
+        return ACCOUNT_ERR_OVERFLOW;
+    }
+
+    acc_from.BALANCE -= amount;
+    acc_to.BALANCE += amount;
+
+    if (!save_account(&acc_from) || !save_account(&acc_to)) {
+        account_unlock_accounts(uuid_from, uuid_to);
+        return ACCOUNT_ERR_IO;
+    }
+
+    account_unlock_accounts(uuid_from, uuid_to);
+
+    if (out_from != NULL) {
+        *out_from = acc_from;
+    }
+    if (out_to != NULL) {
+        *out_to = acc_to;
+    }
+    return ACCOUNT_OK;
+}
+
+/**
+ * @brief 销户
  */
-int list_all_accounts(void)
+AccountStatus account_apply_delete(const char *uuid)
 {
-    AccountListItem *items = NULL;
-    int count = load_account_list(&items);
-
-    PRINTF_G("\n========== 账户列表 ==========\n");
-    if (count <= 0) {
-        PRINTF_G("暂无账户\n");
-        return 0;
+    if (uuid == NULL) {
+        return ACCOUNT_ERR_INVALID;
     }
-
-    if (g_account_sort_mode == ACCOUNT_SORT_UUID_TIME) {
-        qsort(items, (size_t)count, sizeof(AccountListItem), cmp_by_mtime_desc);
-    } else {
-        qsort(items, (size_t)count, sizeof(AccountListItem), cmp_by_balance_desc);
+    if (replication_is_follower()) {
+        return ACCOUNT_ERR_READ_ONLY;
     }
 
-    for (int i = 0; i < count; i++) {
-        PRINTF_G("%d. UUID: %s\n", i + 1, items[i].acc.UUID);
-        PRINTF_G("   余额: %.2f 元\n", items[i].acc.BALANCE / 100.0);
+    account_lock_accounts(uuid, NULL);
+
+    /* 在锁内重新确认余额（防并发转账/存取后余额变化） */
+    ACCOUNT acc;
+    if (!load_account(uuid, &acc)) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_NOT_FOUND;
+    }
+    if (acc.BALANCE > 0) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_HAS_BALANCE;
     }
 
-    free(items);
+    if (!delete_account_file(uuid)) {
+        account_unlock_accounts(uuid, NULL);
+        return ACCOUNT_ERR_IO;
+    }
 
-    PRINTF_G("==============================\n");
-    PRINTF_G("共 %d 个账户\n\n", count);
-    return count;
+    account_unlock_accounts(uuid, NULL);
+    return ACCOUNT_OK;
 }
 
 /**
- * @brief 获取所有本地账户的UUID列表
+ * @brief 写入整条账户记录
  */
-int get_all_account_uuids(char uuids[][37], int max_count)
+AccountStatus account_apply_put(const ACCOUNT *acc)
 {
-    int count = 0;
-    
-#ifdef _WIN32
-    /* Windows平台 */
-    struct _finddata_t fileinfo;
-    intptr_t handle = _findfirst("Card/*.card", &fileinfo);
-    
-    if (handle == -1) {
-        return 0;
-    }
-    
-    do {
-        if (count >= max_count) break;
-        
-        /* 提取UUID */
-        strncpy(uuids[count], fileinfo.name, 36);
-        uuids[count][36] = '\0';
-        
-        /* 移除.card后缀 */
-        char *dot = strrchr(uuids[count], '.');
-        if (dot) *dot = '\0';
-        
-        count++;
-    } while (_findnext(handle, &fileinfo) == 0);
-    
-    _findclose(handle);
-#else
-    /* Linux平台 */
-    DIR *dir = opendir("Card");
-    if (dir == NULL) {
-        return 0;
-    }
-    
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL && count < max_count) {
-        /* 只处理.card文件 */
-        if (strstr(entry->d_name, ".card") == NULL) {
-            continue;
-        }
-        
-        /* 提取UUID */
-        strncpy(uuids[count], entry->d_name, 36);
-        uuids[count][36] = '\0';
-        count++;
+    if (acc == NULL) {
+        return ACCOUNT_ERR_INVALID;
     }
-    
-    closedir(dir);
-#endif
-    
-    return count;
+
+    account_lock_accounts(acc->UUID, NULL);
+    bool ok = save_account(acc);
+    account_unlock_accounts(acc->UUID, NULL);
+
+    return ok ? ACCOUNT_OK : ACCOUNT_ERR_IO;
 }
 
 /**
- * @brief 同步所有本地账户到服务器
+ * @brief 删除账户（不检查余额）
  */
-int sync_all_accounts_to_server(void)
+AccountStatus account_apply_remove(const char *uuid)
 {
-    /* 检查是否处于服务器模式 */
-    if (get_run_mode() != MODE_SERVER) {
-        printf("[推送] 未连接到服务器，跳过同步\n");
-        return 0;
-    }
-    
-    /* 获取所有本地账户UUID */
-    char uuids[100][37];  /* 最多100个账户,虽然需求要求支持50个但是实际可以非常多 */
-    int total_count = get_all_account_uuids(uuids, 100);
-    
-    if (total_count == 0) {
-        printf("[推送] 本地没有账户需要同步\n");
-        return 0;
+    if (uuid == NULL) {
+        return ACCOUNT_ERR_INVALID;
     }
-    
-    printf("[推送] 发现 %d 个本地账户，开始推送到服务器...\n", total_count);
-    
-    int success_count = 0;
-    int fail_count = 0;
-    
-    /* 逐个同步账户 */
-    for (int i = 0; i < total_count; i++) {
-        ACCOUNT acc;
-        if (!load_account(uuids[i], &acc)) {
-            fprintf(stderr, "[推送] 无法加载账户 %s\n", uuids[i]);
-            fail_count++;
-            continue;
-        }
-        
-        //printf("[推送] 正在推送账户 %s (余额: %.2f元)...\n", 
-        //       acc.UUID, acc.BALANCE / 100.0);
-        
-        /* 调用同步API */
-        if (api_sync_account(&acc)) {
-            //printf("[推送] ✓ 账户 %s 推送成功\n", acc.UUID);
-            success_count++;
-        } else {
-            //fprintf(stderr, "[推送] ✗ 账户 %s 推送失败\n", acc.UUID);
-            fail_count++;
-        }
+
+    account_lock_accounts(uuid, NULL);
+
+    ACCOUNT acc;
+    AccountStatus status = ACCOUNT_OK;
+    if (!load_account(uuid, &acc)) {
+        status = ACCOUNT_ERR_NOT_FOUND;
+    } else if (!delete_account_file(uuid)) {
+        status = ACCOUNT_ERR_IO;
     }
-    
-    printf("[推送] 推送完成: 成功 %d 个, 失败 %d 个\n", success_count, fail_count);
-    return success_count;
+
+    account_unlock_accounts(uuid, NULL);
+    return status;
 }
 
+/* ==================== 业务功能 ==================== */
+
 /**
- * @brief 从服务器拉取账户并保存到本地
+ * @brief 执行一笔交易并在本地完成后返回
+ *
+ * 异步接口已启动时经其提交，服务器同步留在后台进行，界面不必等待网络；
+ * 否则在当前线程执行，再追加到同步队列（队列未启用时直接同步到服务器）。
  */
-int pull_accounts_from_server(void)
+static AccountStatus ui_execute(EngineOpType type, const char *uuid, const char *uuid_to,
+                                LLUINT amount, ACCOUNT *out, ACCOUNT *out_to)
 {
-    /* 检查是否处于服务器模式 */
-    if (get_run_mode() != MODE_SERVER) {
-        printf("[拉取] 未连接到服务器，跳过拉取\n");
-        return 0;
-    }
-    
-    /* 从服务器获取账户 */
-    ACCOUNT server_accounts[100];  /* 最多100个账户 */
-    int count = api_fetch_all_accounts(server_accounts, 100);
-    
-    if (count < 0) {
-        fprintf(stderr, "[拉取] 从服务器获取账户失败\n");
-        return 0;
-    }
-    
-    if (count == 0) {
-        printf("[拉取] 服务器没有账户数据\n");
-        return 0;
-    }
-    
-    printf("[拉取] 开始保存服务器账户到本地...\n");
-    
-    int success_count = 0;
-    int fail_count = 0;
-    
-    /* 保存每个账户到本地 */
-    for (int i = 0; i < count; i++) {
-        ACCOUNT *acc = &server_accounts[i];
-        
-        /* 检查本地是否已存在该账户 */
-        ACCOUNT local_acc;
-        bool exists = load_account(acc->UUID, &local_acc);
-        
-        if (exists) {
-            /* 本地已存在，比较并更新余额 */
-            if (local_acc.BALANCE != acc->BALANCE) {
-                //printf("[拉取] 更新账户 %s 余额: %.2f元 -> %.2f元\n",
-                //       acc->UUID, local_acc.BALANCE / 100.0, acc->BALANCE / 100.0);
-                
-                /* 保留本地密码 */
-                acc->PASSWORD = local_acc.PASSWORD;
-                
-                if (save_account(acc)) {
-                    success_count++;
-                } else {
-                    //fprintf(stderr, "[拉取] ✗ 更新账户 %s 失败\n", acc->UUID);
-                    fail_count++;
-                }
-            } else {
-                //printf("[拉取] 账户 %s 无需更新\n", acc->UUID);
-                success_count++;
+    sync_touch(uuid);
+    sync_touch(uuid_to);
+
+    AsyncOp *op = NULL;
+    switch (type) {
+    case ENGINE_OP_DEPOSIT:
+        op = async_deposit(uuid, amount, NULL, NULL);
+        break;
+    case ENGINE_OP_WITHDRAW:
+        op = async_withdraw(uuid, amount, NULL, NULL);
+        break;
+    case ENGINE_OP_TRANSFER:
+        op = async_transfer(uuid, uuid_to, amount, NULL, NULL);
+        break;
+    case ENGINE_OP_DELETE:
+        op = async_delete(uuid, NULL, NULL);
+        break;
+    default:
+        return ACCOUNT_ERR_INVALID;
+    }
+
+    if (op != NULL) {
+        AsyncResult result;
+        async_op_wait(op, &result);
+        async_op_release(op);
+        if (result.status == ACCOUNT_OK) {
+            if (out != NULL) {
+                *out = result.account;
             }
-        } else {
-            /* 本地不存在，新建账户（密码设为0） */
-            //printf("[拉取] 新增账户 %s (余额: %.2f元)\n",
-            //       acc->UUID, acc->BALANCE / 100.0);
-            
-            acc->PASSWORD = 0;  /* 新账户默认密码为0 */
-            
-            if (save_account(acc)) {
-                success_count++;
-                //printf("[拉取] ✓ 账户 %s 保存成功（注意：密码已设为0000000）\n", acc->UUID);
-            } else {
-                //fprintf(stderr, "[拉取] ✗ 保存账户 %s 失败\n", acc->UUID);
-                fail_count++;
+            if (out_to != NULL) {
+                *out_to = result.account_to;
             }
+            if (result.sync == ASYNC_SYNC_WAITING) {
+                PRINTF_G("已提交后台同步到服务器（同步进度见“系统运行状态”）\n");
+            }
+        }
+        return result.status;
+    }
+
+    /* 本地修改（引擎模式下由写线程执行） */
+    AccountStatus status;
+    switch (type) {
+    case ENGINE_OP_DEPOSIT:
+        status = engine_deposit(uuid, amount, out);
+        break;
+    case ENGINE_OP_WITHDRAW:
+        status = engine_withdraw(uuid, amount, out);
+        break;
+    case ENGINE_OP_TRANSFER:
+        status = engine_transfer(uuid, uuid_to, amount, out, out_to);
+        break;
+    default:
+        status = engine_delete(uuid);
+        break;
+    }
+    if (status != ACCOUNT_OK || get_run_mode() != MODE_SERVER) {
+        return status;
+    }
+
+    if (outbox_active()) {
+        ApiOperation op_type;
+        switch (type) {
+        case ENGINE_OP_DEPOSIT:
+            op_type = API_OP_DEPOSIT;
+            break;
+        case ENGINE_OP_WITHDRAW:
+            op_type = API_OP_WITHDRAW;
+            break;
+        case ENGINE_OP_TRANSFER:
+            op_type = API_OP_TRANSFER;
+            break;
+        default:
+            op_type = API_OP_DELETE;
+            break;
+        }
+        if (outbox_append(op_type, uuid, type == ENGINE_OP_TRANSFER ? uuid_to : NULL, amount)) {
+            PRINTF_G("已加入同步队列，后台发送到服务器\n");
+        } else {
+            fprintf(stderr, "警告：无法写入同步队列，仅保存到本地\n");
         }
+        return status;
     }
-    
-    printf("[拉取] 拉取完成: 成功 %d 个, 失败 %d 个\n", success_count, fail_count);
-    return success_count;
-}
 
-/**
- * @brief 删除账户文件
- */
-bool delete_account_file(const char *uuid)
-{
-    char filename[50];
-    snprintf(filename, sizeof(filename), "Card/%s.card", uuid);
-    
-    if (remove(filename) != 0) {
-        perror("错误：无法删除账户文件");
-        return false;
+    /* 服务器模式下同步到服务器 */
+    bool synced;
+    switch (type) {
+    case ENGINE_OP_DEPOSIT:
+        synced = api_deposit(uuid, amount);
+        break;
+    case ENGINE_OP_WITHDRAW:
+        synced = api_withdraw(uuid, amount);
+        break;
+    case ENGINE_OP_TRANSFER:
+        synced = api_transfer(uuid, uuid_to, amount);
+        break;
+    default:
+        synced = api_delete_account(uuid);
+        break;
+    }
+    if (type == ENGINE_OP_DELETE) {
+        if (!synced) {
+            fprintf(stderr, "警告：服务器同步失败，仅删除本地账户\n");
+        } else {
+            PRINTF_G("账户已从服务器删除\n");
+        }
+    } else {
+        if (!synced) {
+            fprintf(stderr, "警告：服务器同步失败，仅保存到本地\n");
+        } else {
+            PRINTF_G("交易已同步到服务器\n");
+        }
     }
-    
-    /* 同步从 Hash 表删除 */
-    hash_delete_account(uuid);
-    
-    return true;
+    return status;
 }
 
-/* ==================== 业务功能 ==================== */
-
 /**
  * @brief 创建账户
  */
@@ -1090,19 +2415,29 @@ bool create_account(LLUINT password)
         return false;
     }
     
+    if (replication_is_follower()) {
+        fprintf(stderr, "错误：%s\n", account_status_string(ACCOUNT_ERR_READ_ONLY));
+        return false;
+    }
+
     /* 创建账户 */
     ACCOUNT new_account;
     generate_uuid_string(new_account.UUID);
     new_account.PASSWORD = password;
     new_account.BALANCE = 0;
     
-    /* 保存到本地 */
+    /* 保存到本地（sync 复制时等待热备节点确认） */
     if (!save_account(&new_account)) {
         return false;
     }
+    replication_wait_commit();
     
-    /* 服务器模式下同步到服务器 */
-    if (get_run_mode() == MODE_SERVER) {
+    /* 服务器模式下同步到服务器（经同步队列时在后续交易之前按序送达） */
+    if (get_run_mode() == MODE_SERVER && outbox_active()) {
+        if (!outbox_append(API_OP_CREATE, new_account.UUID, NULL, new_account.BALANCE)) {
+            fprintf(stderr, "警告：无法写入同步队列，账户仅保存到本地\n");
+        }
+    } else if (get_run_mode() == MODE_SERVER) {
         if (!api_create_account(&new_account)) {
             fprintf(stderr, "警告：服务器同步失败，账户仅保存到本地\n");
         } else {
@@ -1148,44 +2483,24 @@ bool deposit(void)
     }
     
     /* 输入存款金额 */
-    double amount;
+    LLUINT amount_cents = 0;
     printf("请输入存款金额（元）: ");
-    if (scanf("%lf", &amount) != 1 || amount <= 0) {
-        fprintf(stderr, "错误：金额无效\n");
-        return false;
-    }
-    
-    if (amount > (double)(ULLONG_MAX / 100ULL)) {
-        fprintf(stderr, "错误：金额过大\n");
+    AmountParseResult parsed = read_amount_cents(&amount_cents);
+    if (parsed != AMOUNT_OK) {
+        fprintf(stderr, "错误：%s\n", amount_parse_error_string(parsed));
         return false;
     }
-
-    LLUINT amount_cents = (LLUINT)(amount * 100);
-
-    account_op_lock();
-    if (acc.BALANCE > (LLUINT)(ULLONG_MAX - amount_cents)) {
-        account_op_unlock();
-        fprintf(stderr, "错误：余额溢出\n");
+    if (amount_cents == 0) {
+        fprintf(stderr, "错误：金额无效\n");
         return false;
     }
 
-    acc.BALANCE += amount_cents;
-    
-    /* 保存到本地 */
-    if (!save_account(&acc)) {
-        account_op_unlock();
+    /* 修改并保存到本地，服务器模式下同步到服务器 */
+    AccountStatus status = ui_execute(ENGINE_OP_DEPOSIT, uuid, NULL, amount_cents, &acc, NULL);
+    if (status != ACCOUNT_OK) {
+        fprintf(stderr, "错误：%s\n", account_status_string(status));
         return false;
     }
-    account_op_unlock();
-    
-    /* 服务器模式下同步到服务器 */
-    if (get_run_mode() == MODE_SERVER) {
-        if (!api_deposit(uuid, amount_cents)) {
-            fprintf(stderr, "警告：服务器同步失败，仅保存到本地\n");
-        } else {
-           PRINTF_G("交易已同步到服务器\n");
-        }
-    }
     
    PRINTF_G("\n存款成功！\n");
    PRINTF_G("当前余额: %.2f 元\n\n", acc.BALANCE / 100.0);
@@ -1227,44 +2542,30 @@ bool withdraw(void)
    PRINTF_G("当前余额: %.2f 元\n", acc.BALANCE / 100.0);
     
     /* 输入取款金额 */
-    double amount;
+    LLUINT amount_cents = 0;
    PRINTF_G("请输入取款金额（元）: ");
-    if (scanf("%lf", &amount) != 1 || amount <= 0) {
-        fprintf(stderr, "错误：金额无效\n");
+    AmountParseResult parsed = read_amount_cents(&amount_cents);
+    if (parsed != AMOUNT_OK) {
+        fprintf(stderr, "错误：%s\n", amount_parse_error_string(parsed));
         return false;
     }
-
-    if (amount > (double)(ULLONG_MAX / 100ULL)) {
-        fprintf(stderr, "错误：金额过大\n");
+    if (amount_cents == 0) {
+        fprintf(stderr, "错误：金额无效\n");
         return false;
     }
     
-    LLUINT amount_cents = (LLUINT)(amount * 100);
-    
     /* 检查余额 */
     if (acc.BALANCE < amount_cents) {
         fprintf(stderr, "错误：余额不足\n");
         return false;
     }
     
-    account_op_lock();
-    acc.BALANCE -= amount_cents;
-    
-    /* 保存到本地 */
-    if (!save_account(&acc)) {
-        account_op_unlock();
+    /* 修改并保存到本地，服务器模式下同步到服务器 */
+    AccountStatus status = ui_execute(ENGINE_OP_WITHDRAW, uuid, NULL, amount_cents, &acc, NULL);
+    if (status != ACCOUNT_OK) {
+        fprintf(stderr, "错误：%s\n", account_status_string(status));
         return false;
     }
-    account_op_unlock();
-    
-    /* 服务器模式下同步到服务器 */
-    if (get_run_mode() == MODE_SERVER) {
-        if (!api_withdraw(uuid, amount_cents)) {
-            fprintf(stderr, "警告：服务器同步失败，仅保存到本地\n");
-        } else {
-           PRINTF_G("交易已同步到服务器\n");
-        }
-    }
     
    PRINTF_G("\n取款成功！\n");
    PRINTF_G("当前余额: %.2f 元\n\n", acc.BALANCE / 100.0);
@@ -1324,19 +2625,17 @@ bool transfer(void)
    PRINTF_G("您的当前余额: %.2f 元\n", acc_from.BALANCE / 100.0);
     
     /* 输入转账金额 */
-    double amount;
+    LLUINT amount_cents = 0;
    PRINTF_G("请输入转账金额（元）: ");
-    if (scanf("%lf", &amount) != 1 || amount <= 0) {
-        fprintf(stderr, "错误：金额无效\n");
+    AmountParseResult parsed = read_amount_cents(&amount_cents);
+    if (parsed != AMOUNT_OK) {
+        fprintf(stderr, "错误：%s\n", amount_parse_error_string(parsed));
         return false;
     }
-
-    if (amount > (double)(ULLONG_MAX / 100ULL)) {
-        fprintf(stderr, "错误：金额过大\n");
+    if (amount_cents == 0) {
+        fprintf(stderr, "错误：金额无效\n");
         return false;
     }
-
-    LLUINT amount_cents = (LLUINT)(amount * 100);
     
     /* 检查余额 */
     if (acc_from.BALANCE < amount_cents) {
@@ -1344,35 +2643,13 @@ bool transfer(void)
         return false;
     }
     
-    account_op_lock();
-
-    if (acc_to.BALANCE > (LLUINT)(ULLONG_MAX - amount_cents)) {
-        account_op_unlock();
-        fprintf(stderr, "错误：转入账户余额溢出\n");
-        return false;
-    }
-
-    /* 更新余额 */
-    acc_from.BALANCE -= amount_cents;
-    acc_to.BALANCE += amount_cents;
-
-    /* 保存两个账户到本地 */
-    if (!save_account(&acc_from) || !save_account(&acc_to)) {
-        account_op_unlock();
-        fprintf(stderr, "错误：保存账户失败\n");
+    /* 更新并保存两个账户到本地，服务器模式下同步到服务器 */
+    AccountStatus status = ui_execute(ENGINE_OP_TRANSFER, uuid_from, uuid_to, amount_cents,
+                                      &acc_from, &acc_to);
+    if (status != ACCOUNT_OK) {
+        fprintf(stderr, "错误：%s\n", account_status_string(status));
         return false;
     }
-
-    account_op_unlock();
-    
-    /* 服务器模式下同步到服务器 */
-    if (get_run_mode() == MODE_SERVER) {
-        if (!api_transfer(uuid_from, uuid_to, amount_cents)) {
-            fprintf(stderr, "警告：服务器同步失败，仅保存到本地\n");
-        } else {
-           PRINTF_G("交易已同步到服务器\n");
-        }
-    }
     
    PRINTF_G("\n转账成功！\n");
    PRINTF_G("您的当前余额: %.2f 元\n\n", acc_from.BALANCE / 100.0);
@@ -1434,37 +2711,12 @@ bool delete_account(void)
         return false;
     }
     
-    account_op_lock();
-
-    /* 再次加载并确认余额（防并发转账/存取后余额变化） */
-    ACCOUNT acc_latest;
-    if (!load_account(uuid, &acc_latest)) {
-        account_op_unlock();
-        fprintf(stderr, "错误：账户不存在\n");
+    /* 再次确认余额并删除本地文件，服务器模式下同步到服务器 */
+    AccountStatus status = ui_execute(ENGINE_OP_DELETE, uuid, NULL, 0, NULL, NULL);
+    if (status != ACCOUNT_OK) {
+        fprintf(stderr, "错误：%s\n", account_status_string(status));
         return false;
     }
-    if (acc_latest.BALANCE > 0) {
-        account_op_unlock();
-        fprintf(stderr, "错误：账户有余额，不能注销\n");
-        return false;
-    }
-
-    /* 删除本地文件 */
-    if (!delete_account_file(uuid)) {
-        account_op_unlock();
-        return false;
-    }
-
-    account_op_unlock();
-    
-    /* 服务器模式下同步到服务器 */
-    if (get_run_mode() == MODE_SERVER) {
-        if (!api_delete_account(uuid)) {
-            fprintf(stderr, "警告：服务器同步失败，仅删除本地账户\n");
-        } else {
-           PRINTF_G("账户已从服务器删除\n");
-        }
-    }
     
    PRINTF_G("\n销户成功！\n\n");
     
@@ -0,0 +1,193 @@
+/**
+ * @file amount.c
+ * @brief 金额解析模块实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/amount.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+/* ==================== 内部辅助函数 ==================== */
+
+/**
+ * @brief 判断是否为ASCII空白字符（不受locale影响）
+ */
+static bool is_ascii_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/* ==================== 解析与格式化 ==================== */
+
+/**
+ * @brief 将十进制定点数字符串精确解析为整数
+ * @param scale 保留的小数位数，结果为原值乘以 10^scale；更多的小数位只允许为0
+ * @note 全程整数运算，避免 double 转换带来的误差（0.29 * 100 = 28.999...）
+ */
+static AmountParseResult parse_fixed_point(const char *buf, size_t len, int scale,
+                                           LLUINT *out_cents)
+{
+    if (buf == NULL || out_cents == NULL) {
+        return AMOUNT_ERR_EMPTY;
+    }
+
+    const char *p = buf;
+    const char *end = buf + len;
+
+    /* 去除首尾空白 */
+    while (p < end && is_ascii_space(*p)) {
+        p++;
+    }
+    while (end > p && is_ascii_space(end[-1])) {
+        end--;
+    }
+    if (p == end) {
+        return AMOUNT_ERR_EMPTY;
+    }
+
+    if (*p == '+') {
+        p++;
+    }
+
+    bool has_digit = false;
+    bool overflow = false;
+    bool precision_lost = false;
+
+    /* 整数部分（元） */
+    LLUINT whole = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        unsigned int d = (unsigned int)(*p - '0');
+        if (!overflow) {
+            if (whole > (ULLONG_MAX - d) / 10ULL) {
+                overflow = true;  /* 继续扫描，格式错误优先报告 */
+            } else {
+                whole = whole * 10ULL + d;
+            }
+        }
+        has_digit = true;
+        p++;
+    }
+
+    /* 小数部分，第 scale+1 位起只允许为0 */
+    LLUINT frac = 0;
+    int frac_digits = 0;
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            unsigned int d = (unsigned int)(*p - '0');
+            if (frac_digits < scale) {
+                frac = frac * 10ULL + d;
+            } else if (d != 0) {
+                precision_lost = true;
+            }
+            frac_digits++;
+            has_digit = true;
+            p++;
+        }
+    }
+
+    if (p != end || !has_digit) {
+        return AMOUNT_ERR_FORMAT;
+    }
+
+    /* 补足小数位："0.5" -> 50 分 */
+    LLUINT unit = 1;
+    for (int i = 0; i < scale; i++) {
+        if (i >= frac_digits) {
+            frac *= 10ULL;
+        }
+        unit *= 10ULL;
+    }
+
+    if (precision_lost) {
+        return AMOUNT_ERR_PRECISION;
+    }
+
+    if (overflow || whole > (ULLONG_MAX - frac) / unit) {
+        return AMOUNT_ERR_OVERFLOW;
+    }
+
+    *out_cents = whole * unit + frac;
+    return AMOUNT_OK;
+}
+
+/**
+ * @brief 将十进制金额字符串（元）精确解析为分
+ */
+AmountParseResult parse_amount_cents(const char *buf, size_t len, LLUINT *out_cents)
+{
+    return parse_fixed_point(buf, len, 2, out_cents);
+}
+
+/**
+ * @brief 解析以分为单位的金额字符串
+ */
+AmountParseResult parse_cents_value(const char *buf, size_t len, LLUINT *out_cents)
+{
+    return parse_fixed_point(buf, len, 0, out_cents);
+}
+
+/**
+ * @brief 将分格式化为 "元.角分" 字符串
+ */
+size_t format_amount_cents(LLUINT cents, char *buf, size_t buf_size)
+{
+    char tmp[AMOUNT_STR_MAX];
+    size_t n = 0;
+
+    /* 逆序写出：先两位小数，再小数点，再整数部分 */
+    tmp[n++] = (char)('0' + (cents % 10ULL));
+    cents /= 10ULL;
+    tmp[n++] = (char)('0' + (cents % 10ULL));
+    cents /= 10ULL;
+    tmp[n++] = '.';
+    do {
+        tmp[n++] = (char)('0' + (cents % 10ULL));
+        cents /= 10ULL;
+    } while (cents > 0);
+
+    if (buf == NULL || buf_size < n + 1) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        buf[i] = tmp[n - 1 - i];
+    }
+    buf[n] = '\0';
+
+    return n;
+}
+
+/**
+ * @brief 获取解析结果的中文描述
+ */
+const char* amount_parse_error_string(AmountParseResult result)
+{
+    switch (result) {
+    case AMOUNT_OK:            return "成功";
+    case AMOUNT_ERR_EMPTY:     return "金额为空";
+    case AMOUNT_ERR_FORMAT:    return "金额格式错误";
+    case AMOUNT_ERR_PRECISION: return "金额最多精确到分（两位小数）";
+    case AMOUNT_ERR_OVERFLOW:  return "金额过大";
+    default:                   return "未知错误";
+    }
+}
+
+/* ==================== 输入读取 ==================== */
+
+/**
+ * @brief 从标准输入读取一个金额并转换为分
+ */
+AmountParseResult read_amount_cents(LLUINT *out_cents)
+{
+    char token[AMOUNT_STR_MAX * 2];
+    if (scanf("%63s", token) != 1) {
+        return AMOUNT_ERR_EMPTY;
+    }
+
+    return parse_amount_cents(token, strlen(token), out_cents);
+}
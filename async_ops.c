@@ -0,0 +1,531 @@
+/**
+ * @file async_ops.c
+ * @brief 异步账户操作实现（本地执行线程 + 同步线程，均按提交顺序处理）
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/async_ops.h>
+#include <lib/server_api.h>
+#include <lib/outbox.h>
+#include <lib/platform.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================== 常量配置 ==================== */
+
+#define ASYNC_SUBMIT_SPIN 64          /* 引擎队列满时先自旋重试的次数，之后每次休眠1ms */
+
+/* ==================== 内部结构 ==================== */
+
+struct AsyncOp {
+    EngineOp request;             /* 操作描述（本地执行时直接提交给引擎） */
+    AsyncResult result;           /* 受 lock 保护 */
+    bool needs_sync;              /* 提交时确定是否需要远程同步 */
+    atomic_int state;             /* AsyncOpState */
+    atomic_int refs;              /* 提交方一个 + 后台一个 */
+    AsyncCallback callback;
+    void *user;
+    PlatformMutex lock;
+    PlatformCond cond;
+    AsyncOp *next;                /* 执行线程队列链接 */
+};
+
+typedef void (*AsyncRunFunc)(AsyncOp *op);
+
+/**
+ * @brief 单线程FIFO执行器
+ *
+ * 线程池是工作窃取的，不保证执行顺序；这里每个阶段只用一个线程，
+ * 保证同一调用方的操作按提交顺序执行和同步。
+ */
+typedef struct {
+    PlatformMutex lock;
+    PlatformCond cond;
+    AsyncOp *head;
+    AsyncOp *tail;
+    bool running;
+    bool stopping;
+    PlatformThread thread;
+    AsyncRunFunc run;
+} AsyncExecutor;
+
+typedef struct {
+    AsyncExecutor local;          /* 本地执行 */
+    AsyncExecutor sync;           /* 远程同步 */
+    AsyncSyncFunc sync_func;
+    bool always_sync;             /* 使用自定义同步函数时不看运行模式 */
+    atomic_bool active;
+
+    atomic_size_t submitted;
+    atomic_size_t in_flight;
+    atomic_size_t local_pending;  /* 尚未本地完成的操作数（停止时等待其归零） */
+    atomic_size_t pending_sync;
+    atomic_size_t completed;
+    atomic_size_t sync_failed;
+} AsyncOps;
+
+static AsyncOps g_async;
+
+/* ==================== 执行器 ==================== */
+
+static void executor_main(void *arg)
+{
+    AsyncExecutor *ex = (AsyncExecutor *)arg;
+
+    platform_mutex_lock(&ex->lock);
+    for (;;) {
+        while (ex->head == NULL && !ex->stopping) {
+            platform_cond_wait(&ex->cond, &ex->lock);
+        }
+        if (ex->head == NULL) {
+            break;    /* 已停止且队列为空 */
+        }
+
+        /* 一次取走整条链，执行期间不持锁 */
+        AsyncOp *op = ex->head;
+        ex->head = NULL;
+        ex->tail = NULL;
+        platform_mutex_unlock(&ex->lock);
+
+        while (op != NULL) {
+            AsyncOp *next = op->next;
+            op->next = NULL;
+            ex->run(op);
+            op = next;
+        }
+
+        platform_mutex_lock(&ex->lock);
+    }
+    platform_mutex_unlock(&ex->lock);
+}
+
+static bool executor_start(AsyncExecutor *ex, AsyncRunFunc run)
+{
+    platform_mutex_init(&ex->lock);
+    platform_cond_init(&ex->cond);
+    ex->head = NULL;
+    ex->tail = NULL;
+    ex->stopping = false;
+    ex->run = run;
+    ex->running = platform_thread_create(&ex->thread, executor_main, ex);
+    if (!ex->running) {
+        platform_cond_destroy(&ex->cond);
+        platform_mutex_destroy(&ex->lock);
+    }
+    return ex->running;
+}
+
+static bool executor_push(AsyncExecutor *ex, AsyncOp *op)
+{
+    platform_mutex_lock(&ex->lock);
+    if (!ex->running || ex->stopping) {
+        platform_mutex_unlock(&ex->lock);
+        return false;
+    }
+    op->next = NULL;
+    if (ex->tail != NULL) {
+        ex->tail->next = op;
+    } else {
+        ex->head = op;
+    }
+    ex->tail = op;
+    platform_cond_signal(&ex->cond);
+    platform_mutex_unlock(&ex->lock);
+    return true;
+}
+
+/**
+ * @brief 执行完队列中的操作后停止线程
+ */
+static void executor_stop(AsyncExecutor *ex)
+{
+    if (!ex->running) {
+        return;
+    }
+    platform_mutex_lock(&ex->lock);
+    ex->stopping = true;
+    platform_cond_broadcast(&ex->cond);
+    platform_mutex_unlock(&ex->lock);
+
+    platform_thread_join(ex->thread);
+    ex->running = false;
+    platform_cond_destroy(&ex->cond);
+    platform_mutex_destroy(&ex->lock);
+}
+
+/* ==================== 句柄 ==================== */
+
+static void async_op_unref(AsyncOp *op)
+{
+    if (atomic_fetch_sub(&op->refs, 1) == 1) {
+        platform_cond_destroy(&op->cond);
+        platform_mutex_destroy(&op->lock);
+        free(op);
+    }
+}
+
+/**
+ * @brief 进入最终状态：唤醒等待者、调用回调、释放后台引用
+ */
+static void async_finish(AsyncOp *op, AsyncSyncStatus sync)
+{
+    platform_mutex_lock(&op->lock);
+    op->result.sync = sync;
+    atomic_store_explicit(&op->state, ASYNC_OP_DONE, memory_order_release);
+    platform_cond_broadcast(&op->cond);
+    platform_mutex_unlock(&op->lock);
+
+    if (sync == ASYNC_SYNC_FAILED) {
+        atomic_fetch_add(&g_async.sync_failed, 1);
+    }
+    atomic_fetch_add(&g_async.completed, 1);
+    atomic_fetch_sub(&g_async.in_flight, 1);
+
+    /* 进入 DONE 后结果不再修改，可不持锁读取 */
+    if (op->callback != NULL) {
+        op->callback(&op->result, op->user);
+    }
+    async_op_unref(op);
+}
+
+/**
+ * @brief 本地执行完成：需要同步则交给同步线程，否则直接完成
+ */
+static void async_local_done(AsyncOp *op, const EngineResult *r)
+{
+    bool sync = r->status == ACCOUNT_OK && op->needs_sync;
+
+    platform_mutex_lock(&op->lock);
+    op->result.status = r->status;
+    op->result.account = r->account;
+    op->result.account_to = r->account_to;
+    op->result.sync = sync ? ASYNC_SYNC_WAITING : ASYNC_SYNC_NOT_REQUIRED;
+    if (sync) {
+        atomic_store_explicit(&op->state, ASYNC_OP_SYNC_PENDING, memory_order_release);
+        platform_cond_broadcast(&op->cond);
+    }
+    platform_mutex_unlock(&op->lock);
+
+    if (!sync) {
+        async_finish(op, ASYNC_SYNC_NOT_REQUIRED);
+    } else {
+        atomic_fetch_add(&g_async.pending_sync, 1);
+        if (!executor_push(&g_async.sync, op)) {
+            atomic_fetch_sub(&g_async.pending_sync, 1);
+            async_finish(op, ASYNC_SYNC_FAILED);
+        }
+    }
+    atomic_fetch_sub(&g_async.local_pending, 1);
+}
+
+/* ==================== 两个阶段 ==================== */
+
+/**
+ * @brief 引擎完成回调（在写线程中调用）
+ */
+static void async_engine_done(const EngineResult *result, void *user)
+{
+    async_local_done((AsyncOp *)user, result);
+}
+
+static void async_run_local(AsyncOp *op)
+{
+    EngineOp *req = &op->request;
+
+    /* 单写线程运行时只入队不等待，写线程可把连续的操作合并成一批落盘 */
+    if (engine_is_running()) {
+        req->callback = async_engine_done;
+        req->user = op;
+        req->future = NULL;
+
+        bool queued;
+        int attempts = 0;
+        while (!(queued = engine_submit(req))) {
+            if (!engine_is_running()) {
+                break;    /* 引擎已停止，改为直接执行 */
+            }
+            if (++attempts > ASYNC_SUBMIT_SPIN) {
+                platform_sleep_ms(1);
+            }
+        }
+        if (queued) {
+            return;
+        }
+    }
+
+    EngineResult r;
+    memset(&r, 0, sizeof(r));
+    r.type = req->type;
+    switch (req->type) {
+    case ENGINE_OP_DEPOSIT:
+        r.status = engine_deposit(req->uuid, req->amount, &r.account);
+        break;
+    case ENGINE_OP_WITHDRAW:
+        r.status = engine_withdraw(req->uuid, req->amount, &r.account);
+        break;
+    case ENGINE_OP_TRANSFER:
+        r.status = engine_transfer(req->uuid, req->uuid_to, req->amount,
+                                   &r.account, &r.account_to);
+        break;
+    case ENGINE_OP_DELETE:
+        r.status = engine_delete(req->uuid);
+        break;
+    default:
+        r.status = ACCOUNT_ERR_INVALID;
+        break;
+    }
+    async_local_done(op, &r);
+}
+
+/**
+ * @brief 默认同步函数：调用服务器接口
+ */
+static bool async_server_sync(EngineOpType type, const char *uuid, const char *uuid_to,
+                              LLUINT amount)
+{
+    switch (type) {
+    case ENGINE_OP_DEPOSIT:
+        return api_deposit(uuid, amount);
+    case ENGINE_OP_WITHDRAW:
+        return api_withdraw(uuid, amount);
+    case ENGINE_OP_TRANSFER:
+        return api_transfer(uuid, uuid_to, amount);
+    case ENGINE_OP_DELETE:
+        return api_delete_account(uuid);
+    default:
+        return false;
+    }
+}
+
+static ApiOperation async_api_operation(EngineOpType type)
+{
+    switch (type) {
+    case ENGINE_OP_DEPOSIT:
+        return API_OP_DEPOSIT;
+    case ENGINE_OP_WITHDRAW:
+        return API_OP_WITHDRAW;
+    case ENGINE_OP_TRANSFER:
+        return API_OP_TRANSFER;
+    default:
+        return API_OP_DELETE;
+    }
+}
+
+static void async_run_sync(AsyncOp *op)
+{
+    const EngineOp *req = &op->request;
+    const char *uuid_to = req->type == ENGINE_OP_TRANSFER ? req->uuid_to : NULL;
+    AsyncSyncStatus status;
+    if (!g_async.always_sync && outbox_active()) {
+        /* 写入队列文件即返回，网络往返与重试由队列发送线程完成 */
+        status = outbox_append(async_api_operation(req->type), req->uuid, uuid_to, req->amount)
+               ? ASYNC_SYNC_QUEUED : ASYNC_SYNC_FAILED;
+    } else {
+        status = g_async.sync_func(req->type, req->uuid, uuid_to, req->amount)
+               ? ASYNC_SYNC_OK : ASYNC_SYNC_FAILED;
+    }
+    atomic_fetch_sub(&g_async.pending_sync, 1);
+    async_finish(op, status);
+}
+
+/* ==================== 生命周期 ==================== */
+
+bool async_start(AsyncSyncFunc sync_func)
+{
+    if (atomic_load(&g_async.active)) {
+        return true;
+    }
+
+    g_async.sync_func = sync_func != NULL ? sync_func : async_server_sync;
+    g_async.always_sync = sync_func != NULL;
+    atomic_store(&g_async.submitted, 0);
+    atomic_store(&g_async.in_flight, 0);
+    atomic_store(&g_async.local_pending, 0);
+    atomic_store(&g_async.pending_sync, 0);
+    atomic_store(&g_async.completed, 0);
+    atomic_store(&g_async.sync_failed, 0);
+
+    if (!executor_start(&g_async.sync, async_run_sync)) {
+        fprintf(stderr, "错误：无法启动同步线程\n");
+        return false;
+    }
+    if (!executor_start(&g_async.local, async_run_local)) {
+        fprintf(stderr, "错误：无法启动本地执行线程\n");
+        executor_stop(&g_async.sync);
+        return false;
+    }
+
+    atomic_store(&g_async.active, true);
+    return true;
+}
+
+bool init_async_ops(void)
+{
+    return async_start(NULL);
+}
+
+void cleanup_async_ops(void)
+{
+    if (!atomic_load(&g_async.active)) {
+        return;
+    }
+    atomic_store(&g_async.active, false);
+
+    /* 先排空本地阶段；经引擎队列提交的操作在写线程回调后才算本地完成 */
+    executor_stop(&g_async.local);
+    while (atomic_load(&g_async.local_pending) > 0) {
+        platform_sleep_ms(1);
+    }
+    executor_stop(&g_async.sync);
+}
+
+bool async_ops_active(void)
+{
+    return atomic_load(&g_async.active);
+}
+
+void async_get_stats(AsyncStats *stats)
+{
+    stats->submitted = atomic_load(&g_async.submitted);
+    stats->in_flight = atomic_load(&g_async.in_flight);
+    stats->pending_sync = atomic_load(&g_async.pending_sync);
+    stats->completed = atomic_load(&g_async.completed);
+    stats->sync_failed = atomic_load(&g_async.sync_failed);
+}
+
+/* ==================== 提交 ==================== */
+
+static AsyncOp* async_submit(const EngineOp *request, AsyncCallback callback, void *user)
+{
+    if (!atomic_load(&g_async.active)) {
+        return NULL;
+    }
+
+    AsyncOp *op = (AsyncOp *)calloc(1, sizeof(AsyncOp));
+    if (op == NULL) {
+        return NULL;
+    }
+    op->request = *request;
+    op->needs_sync = g_async.always_sync || get_run_mode() == MODE_SERVER;
+    op->result.type = request->type;
+    op->result.status = ACCOUNT_OK;
+    op->result.sync = op->needs_sync ? ASYNC_SYNC_WAITING : ASYNC_SYNC_NOT_REQUIRED;
+    atomic_init(&op->state, ASYNC_OP_PENDING);
+    atomic_init(&op->refs, 2);
+    op->callback = callback;
+    op->user = user;
+    platform_mutex_init(&op->lock);
+    platform_cond_init(&op->cond);
+
+    atomic_fetch_add(&g_async.in_flight, 1);
+    atomic_fetch_add(&g_async.local_pending, 1);
+    if (!executor_push(&g_async.local, op)) {
+        atomic_fetch_sub(&g_async.local_pending, 1);
+        atomic_fetch_sub(&g_async.in_flight, 1);
+        platform_cond_destroy(&op->cond);
+        platform_mutex_destroy(&op->lock);
+        free(op);
+        return NULL;
+    }
+    atomic_fetch_add(&g_async.submitted, 1);
+    return op;
+}
+
+static void copy_uuid(char dst[37], const char *src)
+{
+    strncpy(dst, src, 36);
+    dst[36] = '\0';
+}
+
+AsyncOp* async_deposit(const char *uuid, LLUINT amount, AsyncCallback callback, void *user)
+{
+    if (uuid == NULL) {
+        return NULL;
+    }
+    EngineOp req;
+    memset(&req, 0, sizeof(req));
+    req.type = ENGINE_OP_DEPOSIT;
+    copy_uuid(req.uuid, uuid);
+    req.amount = amount;
+    return async_submit(&req, callback, user);
+}
+
+AsyncOp* async_withdraw(const char *uuid, LLUINT amount, AsyncCallback callback, void *user)
+{
+    if (uuid == NULL) {
+        return NULL;
+    }
+    EngineOp req;
+    memset(&req, 0, sizeof(req));
+    req.type = ENGINE_OP_WITHDRAW;
+    copy_uuid(req.uuid, uuid);
+    req.amount = amount;
+    return async_submit(&req, callback, user);
+}
+
+AsyncOp* async_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount,
+                        AsyncCallback callback, void *user)
+{
+    if (uuid_from == NULL || uuid_to == NULL) {
+        return NULL;
+    }
+    EngineOp req;
+    memset(&req, 0, sizeof(req));
+    req.type = ENGINE_OP_TRANSFER;
+    copy_uuid(req.uuid, uuid_from);
+    copy_uuid(req.uuid_to, uuid_to);
+    req.amount = amount;
+    return async_submit(&req, callback, user);
+}
+
+AsyncOp* async_delete(const char *uuid, AsyncCallback callback, void *user)
+{
+    if (uuid == NULL) {
+        return NULL;
+    }
+    EngineOp req;
+    memset(&req, 0, sizeof(req));
+    req.type = ENGINE_OP_DELETE;
+    copy_uuid(req.uuid, uuid);
+    return async_submit(&req, callback, user);
+}
+
+/* ==================== 轮询与等待 ==================== */
+
+AsyncOpState async_op_state(AsyncOp *op)
+{
+    return (AsyncOpState)atomic_load_explicit(&op->state, memory_order_acquire);
+}
+
+static void async_op_wait_for(AsyncOp *op, AsyncOpState target, AsyncResult *out)
+{
+    platform_mutex_lock(&op->lock);
+    while (atomic_load_explicit(&op->state, memory_order_acquire) < (int)target) {
+        platform_cond_wait(&op->cond, &op->lock);
+    }
+    if (out != NULL) {
+        *out = op->result;
+    }
+    platform_mutex_unlock(&op->lock);
+}
+
+void async_op_wait(AsyncOp *op, AsyncResult *out)
+{
+    async_op_wait_for(op, ASYNC_OP_SYNC_PENDING, out);
+}
+
+void async_op_wait_synced(AsyncOp *op, AsyncResult *out)
+{
+    async_op_wait_for(op, ASYNC_OP_DONE, out);
+}
+
+void async_op_release(AsyncOp *op)
+{
+    if (op != NULL) {
+        async_op_unref(op);
+    }
+}
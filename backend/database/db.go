@@ -37,6 +37,9 @@ func InitDB(dsn string) error {
 	return nil
 }
 
+// appliedOpsRetentionDays 操作幂等标识的保留天数
+const appliedOpsRetentionDays = 30
+
 // createTables 自动创建数据表
 func createTables() error {
 	createAccountsTable := `
@@ -53,6 +56,36 @@ func createTables() error {
 		return fmt.Errorf("创建accounts表失败: %v", err)
 	}
 
+	// 增量同步按 updated_at 查询（GET /api/accounts?since=），旧表补建索引
+	var indexCount int
+	err = DB.QueryRow(`SELECT COUNT(*) FROM information_schema.statistics
+		WHERE table_schema = DATABASE() AND table_name = 'accounts' AND index_name = 'idx_updated_at'`).Scan(&indexCount)
+	if err != nil {
+		return fmt.Errorf("检查索引失败: %v", err)
+	}
+	if indexCount == 0 {
+		if _, err = DB.Exec("CREATE INDEX idx_updated_at ON accounts (updated_at)"); err != nil {
+			return fmt.Errorf("创建updated_at索引失败: %v", err)
+		}
+	}
+
+	// 已执行操作的幂等标识：客户端同步队列重发的操作按 op_id 只执行一次
+	createAppliedOpsTable := `
+	CREATE TABLE IF NOT EXISTS applied_ops (
+		op_id VARCHAR(64) PRIMARY KEY,
+		created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+		INDEX idx_created_at (created_at)
+	) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
+	`
+	if _, err = DB.Exec(createAppliedOpsTable); err != nil {
+		return fmt.Errorf("创建applied_ops表失败: %v", err)
+	}
+
+	// 重发只发生在客户端离线期间，保留期之外的标识不再需要
+	if _, err = DB.Exec("DELETE FROM applied_ops WHERE created_at < NOW() - INTERVAL ? DAY", appliedOpsRetentionDays); err != nil {
+		return fmt.Errorf("清理applied_ops失败: %v", err)
+	}
+
 	log.Println("数据表检查/创建完成")
 	return nil
 }
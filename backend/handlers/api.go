@@ -1,11 +1,14 @@
 package handlers
 
 import (
+	"bufio"
 	"encoding/json"
+	"fmt"
 	"io/ioutil"
 	"log"
 	"net/http"
 	"regexp"
+	"strconv"
 	"strings"
 
 	"bamsystem-backend/config"
@@ -34,6 +37,7 @@ type CreateAccountRequest struct {
 	UUID      string `json:"uuid"`
 	Balance   uint64 `json:"balance"`
 	Timestamp int64  `json:"timestamp"`
+	OpID      string `json:"op_id,omitempty"`
 }
 
 // DepositRequest 存款请求
@@ -41,6 +45,7 @@ type DepositRequest struct {
 	UUID      string `json:"uuid"`
 	Amount    uint64 `json:"amount"`
 	Timestamp int64  `json:"timestamp"`
+	OpID      string `json:"op_id,omitempty"`
 }
 
 // WithdrawRequest 取款请求
@@ -48,6 +53,7 @@ type WithdrawRequest struct {
 	UUID      string `json:"uuid"`
 	Amount    uint64 `json:"amount"`
 	Timestamp int64  `json:"timestamp"`
+	OpID      string `json:"op_id,omitempty"`
 }
 
 // TransferRequest 转账请求
@@ -56,6 +62,7 @@ type TransferRequest struct {
 	UUIDTo    string `json:"uuid_to"`
 	Amount    uint64 `json:"amount"`
 	Timestamp int64  `json:"timestamp"`
+	OpID      string `json:"op_id,omitempty"`
 }
 
 // SyncAccountRequest 同步账户请求
@@ -65,154 +72,211 @@ type SyncAccountRequest struct {
 	Timestamp int64  `json:"timestamp"`
 }
 
+// SyncBatchRequest 批量同步请求
+type SyncBatchRequest struct {
+	Accounts []SyncAccountRequest `json:"accounts"`
+}
+
+// SyncBatchItemResult 批量同步中单个账户的结果（与请求中的顺序一致）
+type SyncBatchItemResult struct {
+	UUID    string `json:"uuid"`
+	Success bool   `json:"success"`
+	Error   string `json:"error,omitempty"`
+}
+
+// SyncBatchResponse 批量同步响应
+type SyncBatchResponse struct {
+	Success bool                  `json:"success"`
+	Synced  int                   `json:"synced"`
+	Results []SyncBatchItemResult `json:"results"`
+	Error   string                `json:"error,omitempty"`
+}
+
+// maxSyncBatchSize 单次批量同步的最大账户数
+const maxSyncBatchSize = 1000
+
+// maxAccountsPageSize 分页拉取账户时每页的最大数量
+const maxAccountsPageSize = 5000
+
+// maxOpIDLength 操作幂等标识的最大长度（与 applied_ops.op_id 一致）
+// 客户端的同步队列会重发超时的操作，带相同 op_id 的操作只执行一次
+const maxOpIDLength = 64
+
 // CheckServerHandler 检查服务器状态
 func CheckServerHandler(w http.ResponseWriter, r *http.Request) {
 	w.Header().Set("Content-Type", "application/json")
-	json.NewEncoder(w).Encode(map[string]string{"status": "Support"})
+	// request_encodings 告知客户端可以发送 gzip 压缩的请求体，content_types 为账户接口支持的编码
+	json.NewEncoder(w).Encode(map[string]string{
+		"status":            "Support",
+		"request_encodings": "gzip",
+		"content_types":     "application/json," + WireContentType,
+	})
 }
 
 // CreateAccountHandler 创建账户
 func CreateAccountHandler(w http.ResponseWriter, r *http.Request) {
 	var req CreateAccountRequest
-	if err := json.NewDecoder(r.Body).Decode(&req); err != nil {
-		sendErrorResponse(w, "请求参数错误", http.StatusBadRequest)
+	if err := decodeRequest(r, &req); err != nil {
+		sendErrorResponse(w, r, "请求参数错误", http.StatusBadRequest)
 		return
 	}
 
 	// 验证UUID格式
 	if !isValidUUID(req.UUID) {
-		sendErrorResponse(w, "UUID格式错误", http.StatusBadRequest)
+		sendErrorResponse(w, r, "UUID格式错误", http.StatusBadRequest)
 		return
 	}
 
-	// 检查账户是否已存在
-	if models.AccountExists(req.UUID) {
-		sendErrorResponse(w, "账户已存在", http.StatusConflict)
+	if len(req.OpID) > maxOpIDLength {
+		sendErrorResponse(w, r, "op_id过长", http.StatusBadRequest)
 		return
 	}
 
-	// 创建账户
-	if err := models.CreateAccount(req.UUID, req.Balance); err != nil {
+	// 创建账户：先按 op_id 判断重发（重发已执行的创建返回成功），再检查 UUID 是否已被占用
+	replayed, err := models.CreateAccount(req.OpID, req.UUID, req.Balance)
+	if err == models.ErrAccountExists {
+		sendErrorResponse(w, r, "账户已存在", http.StatusConflict)
+		return
+	}
+	if err != nil {
 		log.Printf("创建账户失败: %v", err)
-		sendErrorResponse(w, "创建账户失败", http.StatusInternalServerError)
+		sendErrorResponse(w, r, "创建账户失败", http.StatusInternalServerError)
 		return
 	}
+	if replayed {
+		log.Printf("重复的创建请求（op_id=%s），账户 %s 已创建", req.OpID, req.UUID)
+	}
 
-	sendSuccessResponse(w, "账户创建成功")
+	sendSuccessResponse(w, r, "账户创建成功")
 }
 
 // DepositHandler 存款
 func DepositHandler(w http.ResponseWriter, r *http.Request) {
 	var req DepositRequest
-	if err := json.NewDecoder(r.Body).Decode(&req); err != nil {
-		sendErrorResponse(w, "请求参数错误", http.StatusBadRequest)
+	if err := decodeRequest(r, &req); err != nil {
+		sendErrorResponse(w, r, "请求参数错误", http.StatusBadRequest)
 		return
 	}
 
 	// 验证UUID格式
 	if !isValidUUID(req.UUID) {
-		sendErrorResponse(w, "UUID格式错误", http.StatusBadRequest)
+		sendErrorResponse(w, r, "UUID格式错误", http.StatusBadRequest)
 		return
 	}
 
 	// 验证金额
 	if req.Amount == 0 {
-		sendErrorResponse(w, "存款金额必须大于0", http.StatusBadRequest)
+		sendErrorResponse(w, r, "存款金额必须大于0", http.StatusBadRequest)
+		return
+	}
+
+	if len(req.OpID) > maxOpIDLength {
+		sendErrorResponse(w, r, "op_id过长", http.StatusBadRequest)
 		return
 	}
 
 	// 执行存款
-	newBalance, err := models.Deposit(req.UUID, req.Amount)
+	newBalance, err := models.Deposit(req.OpID, req.UUID, req.Amount)
 	if err != nil {
 		log.Printf("存款失败: %v", err)
 		if strings.Contains(err.Error(), "不存在") {
-			sendErrorResponse(w, "账户不存在", http.StatusNotFound)
+			sendErrorResponse(w, r, "账户不存在", http.StatusNotFound)
 		} else {
-			sendErrorResponse(w, "存款失败", http.StatusInternalServerError)
+			sendErrorResponse(w, r, "存款失败", http.StatusInternalServerError)
 		}
 		return
 	}
 
-	sendBalanceResponse(w, newBalance, "存款成功")
+	sendBalanceResponse(w, r, newBalance, "存款成功")
 }
 
 // WithdrawHandler 取款
 func WithdrawHandler(w http.ResponseWriter, r *http.Request) {
 	var req WithdrawRequest
-	if err := json.NewDecoder(r.Body).Decode(&req); err != nil {
-		sendErrorResponse(w, "请求参数错误", http.StatusBadRequest)
+	if err := decodeRequest(r, &req); err != nil {
+		sendErrorResponse(w, r, "请求参数错误", http.StatusBadRequest)
 		return
 	}
 
 	// 验证UUID格式
 	if !isValidUUID(req.UUID) {
-		sendErrorResponse(w, "UUID格式错误", http.StatusBadRequest)
+		sendErrorResponse(w, r, "UUID格式错误", http.StatusBadRequest)
 		return
 	}
 
 	// 验证金额
 	if req.Amount == 0 {
-		sendErrorResponse(w, "取款金额必须大于0", http.StatusBadRequest)
+		sendErrorResponse(w, r, "取款金额必须大于0", http.StatusBadRequest)
+		return
+	}
+
+	if len(req.OpID) > maxOpIDLength {
+		sendErrorResponse(w, r, "op_id过长", http.StatusBadRequest)
 		return
 	}
 
 	// 执行取款
-	newBalance, err := models.Withdraw(req.UUID, req.Amount)
+	newBalance, err := models.Withdraw(req.OpID, req.UUID, req.Amount)
 	if err != nil {
 		log.Printf("取款失败: %v", err)
 		if strings.Contains(err.Error(), "余额不足") {
-			sendErrorResponse(w, "余额不足", http.StatusBadRequest)
+			sendErrorResponse(w, r, "余额不足", http.StatusBadRequest)
 		} else if strings.Contains(err.Error(), "不存在") {
-			sendErrorResponse(w, "账户不存在", http.StatusNotFound)
+			sendErrorResponse(w, r, "账户不存在", http.StatusNotFound)
 		} else {
-			sendErrorResponse(w, "取款失败", http.StatusInternalServerError)
+			sendErrorResponse(w, r, "取款失败", http.StatusInternalServerError)
 		}
 		return
 	}
 
-	sendBalanceResponse(w, newBalance, "取款成功")
+	sendBalanceResponse(w, r, newBalance, "取款成功")
 }
 
 // TransferHandler 转账
 func TransferHandler(w http.ResponseWriter, r *http.Request) {
 	var req TransferRequest
-	if err := json.NewDecoder(r.Body).Decode(&req); err != nil {
-		sendErrorResponse(w, "请求参数错误", http.StatusBadRequest)
+	if err := decodeRequest(r, &req); err != nil {
+		sendErrorResponse(w, r, "请求参数错误", http.StatusBadRequest)
 		return
 	}
 
 	// 验证UUID格式
 	if !isValidUUID(req.UUIDFrom) || !isValidUUID(req.UUIDTo) {
-		sendErrorResponse(w, "UUID格式错误", http.StatusBadRequest)
+		sendErrorResponse(w, r, "UUID格式错误", http.StatusBadRequest)
 		return
 	}
 
 	// 验证金额
 	if req.Amount == 0 {
-		sendErrorResponse(w, "转账金额必须大于0", http.StatusBadRequest)
+		sendErrorResponse(w, r, "转账金额必须大于0", http.StatusBadRequest)
 		return
 	}
 
 	// 验证不能转账给自己
 	if req.UUIDFrom == req.UUIDTo {
-		sendErrorResponse(w, "不能向自己转账", http.StatusBadRequest)
+		sendErrorResponse(w, r, "不能向自己转账", http.StatusBadRequest)
+		return
+	}
+
+	if len(req.OpID) > maxOpIDLength {
+		sendErrorResponse(w, r, "op_id过长", http.StatusBadRequest)
 		return
 	}
 
 	// 执行转账
-	if err := models.Transfer(req.UUIDFrom, req.UUIDTo, req.Amount); err != nil {
+	if err := models.Transfer(req.OpID, req.UUIDFrom, req.UUIDTo, req.Amount); err != nil {
 		log.Printf("转账失败: %v", err)
 		if strings.Contains(err.Error(), "余额不足") {
-			sendErrorResponse(w, "转出账户余额不足", http.StatusBadRequest)
+			sendErrorResponse(w, r, "转出账户余额不足", http.StatusBadRequest)
 		} else if strings.Contains(err.Error(), "不存在") {
-			sendErrorResponse(w, err.Error(), http.StatusNotFound)
+			sendErrorResponse(w, r, err.Error(), http.StatusNotFound)
 		} else {
-			sendErrorResponse(w, "转账失败", http.StatusInternalServerError)
+			sendErrorResponse(w, r, "转账失败", http.StatusInternalServerError)
 		}
 		return
 	}
 
-	sendSuccessResponse(w, "转账成功")
+	sendSuccessResponse(w, r, "转账成功")
 }
 
 // DeleteAccountHandler 删除账户
@@ -222,46 +286,115 @@ func DeleteAccountHandler(w http.ResponseWriter, r *http.Request) {
 
 	// 验证UUID格式
 	if !isValidUUID(uuid) {
-		sendErrorResponse(w, "UUID格式错误", http.StatusBadRequest)
+		sendErrorResponse(w, r, "UUID格式错误", http.StatusBadRequest)
+		return
+	}
+
+	// DELETE 不带请求体，幂等标识放在查询参数中
+	opID := r.URL.Query().Get("op_id")
+	if len(opID) > maxOpIDLength {
+		sendErrorResponse(w, r, "op_id过长", http.StatusBadRequest)
 		return
 	}
 
 	// 删除账户
-	if err := models.DeleteAccount(uuid); err != nil {
+	if err := models.DeleteAccount(opID, uuid); err != nil {
 		log.Printf("删除账户失败: %v", err)
 		if strings.Contains(err.Error(), "不存在") {
-			sendErrorResponse(w, "账户不存在", http.StatusNotFound)
+			sendErrorResponse(w, r, "账户不存在", http.StatusNotFound)
 		} else {
-			sendErrorResponse(w, "删除账户失败", http.StatusInternalServerError)
+			sendErrorResponse(w, r, "删除账户失败", http.StatusInternalServerError)
 		}
 		return
 	}
 
-	sendSuccessResponse(w, "账户已删除")
+	sendSuccessResponse(w, r, "账户已删除")
 }
 
 // SyncAccountHandler 同步账户
 func SyncAccountHandler(w http.ResponseWriter, r *http.Request) {
 	var req SyncAccountRequest
-	if err := json.NewDecoder(r.Body).Decode(&req); err != nil {
-		sendErrorResponse(w, "请求参数错误", http.StatusBadRequest)
+	if err := decodeRequest(r, &req); err != nil {
+		sendErrorResponse(w, r, "请求参数错误", http.StatusBadRequest)
 		return
 	}
 
 	// 验证UUID格式
 	if !isValidUUID(req.UUID) {
-		sendErrorResponse(w, "UUID格式错误", http.StatusBadRequest)
+		sendErrorResponse(w, r, "UUID格式错误", http.StatusBadRequest)
 		return
 	}
 
 	// 同步账户
 	if err := models.SyncAccount(req.UUID, req.Balance); err != nil {
 		log.Printf("同步账户失败: %v", err)
-		sendErrorResponse(w, "同步账户失败", http.StatusInternalServerError)
+		sendErrorResponse(w, r, "同步账户失败", http.StatusInternalServerError)
+		return
+	}
+
+	sendSuccessResponse(w, r, "账户数据已同步")
+}
+
+// SyncAccountsBatchHandler 批量同步账户
+// 格式正确的账户在一个事务中写入；格式错误的账户单独报告失败，不影响其余账户
+func SyncAccountsBatchHandler(w http.ResponseWriter, r *http.Request) {
+	var req SyncBatchRequest
+	if err := decodeSyncBatch(r, &req); err != nil {
+		if err == errSyncBatchTooLarge {
+			sendErrorResponse(w, r, "单次同步的账户数过多", http.StatusRequestEntityTooLarge)
+		} else {
+			sendErrorResponse(w, r, "请求参数错误", http.StatusBadRequest)
+		}
+		return
+	}
+
+	if len(req.Accounts) == 0 {
+		sendErrorResponse(w, r, "账户列表为空", http.StatusBadRequest)
+		return
+	}
+	if len(req.Accounts) > maxSyncBatchSize {
+		sendErrorResponse(w, r, "单次同步的账户数过多", http.StatusRequestEntityTooLarge)
+		return
+	}
+
+	results := make([]SyncBatchItemResult, len(req.Accounts))
+	items := make([]models.SyncItem, 0, len(req.Accounts))
+	for i, acc := range req.Accounts {
+		results[i].UUID = acc.UUID
+		if !isValidUUID(acc.UUID) {
+			results[i].Error = "UUID格式错误"
+			continue
+		}
+		items = append(items, models.SyncItem{UUID: acc.UUID, Balance: acc.Balance})
+	}
+
+	// 写入失败时整批回滚，全部账户报告失败
+	if err := models.SyncAccountsBatch(items); err != nil {
+		log.Printf("批量同步账户失败: %v", err)
+		sendErrorResponse(w, r, "批量同步账户失败", http.StatusInternalServerError)
+		return
+	}
+
+	synced := 0
+	for i := range results {
+		if results[i].Error == "" {
+			results[i].Success = true
+			synced++
+		}
+	}
+
+	if wantsWire(r) {
+		writeWireSyncBatch(w, results)
 		return
 	}
 
-	sendSuccessResponse(w, "账户数据已同步")
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(http.StatusOK)
+	json.NewEncoder(w).Encode(SyncBatchResponse{
+		Success: true,
+		Synced:  synced,
+		Results: results,
+	})
 }
 
 // GetPublicKeyHandler 获取服务器公钥/证书
@@ -272,7 +405,7 @@ func GetPublicKeyHandler(w http.ResponseWriter, r *http.Request) {
 	certData, err := ioutil.ReadFile(certPath)
 	if err != nil {
 		log.Printf("读取证书文件失败: %v", err)
-		sendErrorResponse(w, "无法读取证书文件", http.StatusInternalServerError)
+		sendErrorResponse(w, r, "无法读取证书文件", http.StatusInternalServerError)
 		return
 	}
 
@@ -283,23 +416,83 @@ func GetPublicKeyHandler(w http.ResponseWriter, r *http.Request) {
 	})
 }
 
-// GetAllAccountsHandler 获取所有账户列表
+// GetAllAccountsHandler 获取账户列表
+// 带 since=<水位> 参数时只返回此后修改过的账户；响应中的 watermark 供下次增量拉取使用。
+// 带 limit=N（可选 after=<uuid>）时按 uuid 键集分页，页满时返回 next_after 作为下一页的 after。
+// 账户逐行编码写出，不在内存中组装整个列表；"success" 放在最后，
+// 已开始输出后出错时以 "success":false 结束响应。
+// 请求带 Accept: application/x-bam-record 时以二进制帧写出（见 wire.go）
 func GetAllAccountsHandler(w http.ResponseWriter, r *http.Request) {
-	accounts, err := models.GetAllAccounts()
+	var q models.AccountQuery
+	params := r.URL.Query()
+	if s := params.Get("since"); s != "" {
+		v, err := strconv.ParseInt(s, 10, 64)
+		if err != nil || v < 0 {
+			sendErrorResponse(w, r, "since参数错误", http.StatusBadRequest)
+			return
+		}
+		q.Since = v
+	}
+	if s := params.Get("limit"); s != "" {
+		v, err := strconv.Atoi(s)
+		if err != nil || v <= 0 || v > maxAccountsPageSize {
+			sendErrorResponse(w, r, "limit参数错误", http.StatusBadRequest)
+			return
+		}
+		q.Limit = v
+	}
+	if s := params.Get("after"); s != "" {
+		if !isValidUUID(s) || q.Limit == 0 {
+			sendErrorResponse(w, r, "after参数错误", http.StatusBadRequest)
+			return
+		}
+		q.After = s
+	}
+
+	watermark, err := models.CurrentWatermark()
 	if err != nil {
 		log.Printf("获取账户列表失败: %v", err)
-		sendErrorResponse(w, "获取账户列表失败", http.StatusInternalServerError)
+		sendErrorResponse(w, r, "获取账户列表失败", http.StatusInternalServerError)
+		return
+	}
+
+	if wantsWire(r) {
+		writeWireAccounts(w, q, watermark)
 		return
 	}
 
-	// 返回账户列表
 	w.Header().Set("Content-Type", "application/json")
 	w.WriteHeader(http.StatusOK)
-	json.NewEncoder(w).Encode(map[string]interface{}{
-		"success":  true,
-		"count":    len(accounts),
-		"accounts": accounts,
+	out := bufio.NewWriterSize(w, 32*1024)
+	defer out.Flush()
+
+	out.WriteString(`{"accounts":[`)
+	count := 0
+	last := ""
+	err = models.ForEachAccount(q, func(acc *models.Account) error {
+		data, err := json.Marshal(acc)
+		if err != nil {
+			return err
+		}
+		if count > 0 {
+			out.WriteByte(',')
+		}
+		count++
+		last = acc.UUID
+		_, err = out.Write(data)
+		return err
 	})
+	fmt.Fprintf(out, `],"count":%d,"watermark":%d`, count, watermark)
+	if q.Limit > 0 && count == q.Limit {
+		fmt.Fprintf(out, `,"next_after":%q`, last)
+	}
+	if err != nil {
+		log.Printf("获取账户列表失败: %v", err)
+		out.WriteString(`,"success":false,"error":"获取账户列表失败"}`)
+		return
+	}
+	out.WriteString(`,"success":true}`)
+	out.WriteByte('\n')
 }
 
 // 辅助函数
@@ -313,7 +506,11 @@ func isValidUUID(uuid string) bool {
 }
 
 // sendSuccessResponse 发送成功响应
-func sendSuccessResponse(w http.ResponseWriter, message string) {
+func sendSuccessResponse(w http.ResponseWriter, r *http.Request, message string) {
+	if wantsWire(r) {
+		writeWireStatus(w, http.StatusOK, true, 0, message)
+		return
+	}
 	w.Header().Set("Content-Type", "application/json")
 	w.WriteHeader(http.StatusOK)
 	json.NewEncoder(w).Encode(StandardResponse{
@@ -323,7 +520,11 @@ func sendSuccessResponse(w http.ResponseWriter, message string) {
 }
 
 // sendErrorResponse 发送错误响应
-func sendErrorResponse(w http.ResponseWriter, message string, statusCode int) {
+func sendErrorResponse(w http.ResponseWriter, r *http.Request, message string, statusCode int) {
+	if wantsWire(r) {
+		writeWireStatus(w, statusCode, false, 0, message)
+		return
+	}
 	w.Header().Set("Content-Type", "application/json")
 	w.WriteHeader(statusCode)
 	json.NewEncoder(w).Encode(StandardResponse{
@@ -333,7 +534,11 @@ func sendErrorResponse(w http.ResponseWriter, message string, statusCode int) {
 }
 
 // sendBalanceResponse 发送带余额的响应
-func sendBalanceResponse(w http.ResponseWriter, balance uint64, message string) {
+func sendBalanceResponse(w http.ResponseWriter, r *http.Request, balance uint64, message string) {
+	if wantsWire(r) {
+		writeWireStatus(w, http.StatusOK, true, balance, message)
+		return
+	}
 	w.Header().Set("Content-Type", "application/json")
 	w.WriteHeader(http.StatusOK)
 	json.NewEncoder(w).Encode(BalanceResponse{
@@ -0,0 +1,291 @@
+package handlers
+
+import (
+	"bufio"
+	"encoding/binary"
+	"encoding/json"
+	"errors"
+	"io"
+	"log"
+	"net/http"
+	"strings"
+
+	"bamsystem-backend/models"
+)
+
+// WireContentType 二进制编码的 Content-Type
+// 定长小端记录，UUID 以16字节二进制传输，格式与客户端 lib/wire.h 一致：
+//
+//	操作请求：uuid[16] uuid_to[16] amount:u64 timestamp:i64 op_id_len:u8 op_id
+//	状态响应：success:u8 balance:u64 text_len:u16 text
+//	批量同步请求：count:u32 之后 count 条 uuid[16] balance:u64 timestamp:i64
+//	批量同步响应：success:u8 count:u32 之后 count 个 ok:u8
+//	账户列表：'A' uuid[16] balance:u64 的帧序列，以 'E' success:u8 watermark:i64 next_after[16] 结束
+//
+// 请求按 Content-Type 解析，响应按 Accept 选择编码，默认仍为 JSON
+const WireContentType = "application/x-bam-record"
+
+const (
+	wireUUIDBytes       = 16
+	wireOpFixedBytes    = 2*wireUUIDBytes + 8 + 8 + 1
+	wireSyncRecordBytes = wireUUIDBytes + 8 + 8
+	wireFrameAccount    = 'A'
+	wireFrameEnd        = 'E'
+)
+
+var (
+	errWireFormat        = errors.New("二进制请求格式错误")
+	errSyncBatchTooLarge = errors.New("单次同步的账户数过多")
+)
+
+// wireUUIDOffsets 规范格式 UUID 中每个字节的十六进制位置
+var wireUUIDOffsets = [wireUUIDBytes]int{0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34}
+
+const hexDigits = "0123456789abcdef"
+
+// wireOp 单个账户操作的二进制请求
+type wireOp struct {
+	UUID      string
+	UUIDTo    string // 仅转账，其余为空
+	Amount    uint64 // 创建与同步时为余额
+	Timestamp int64
+	OpID      string
+}
+
+// wireRequest 可由二进制操作请求填充的请求结构
+type wireRequest interface {
+	fromWire(op *wireOp)
+}
+
+func (req *CreateAccountRequest) fromWire(op *wireOp) {
+	req.UUID, req.Balance, req.Timestamp, req.OpID = op.UUID, op.Amount, op.Timestamp, op.OpID
+}
+
+func (req *DepositRequest) fromWire(op *wireOp) {
+	req.UUID, req.Amount, req.Timestamp, req.OpID = op.UUID, op.Amount, op.Timestamp, op.OpID
+}
+
+func (req *WithdrawRequest) fromWire(op *wireOp) {
+	req.UUID, req.Amount, req.Timestamp, req.OpID = op.UUID, op.Amount, op.Timestamp, op.OpID
+}
+
+func (req *TransferRequest) fromWire(op *wireOp) {
+	req.UUIDFrom, req.UUIDTo, req.Amount, req.Timestamp, req.OpID =
+		op.UUID, op.UUIDTo, op.Amount, op.Timestamp, op.OpID
+}
+
+func (req *SyncAccountRequest) fromWire(op *wireOp) {
+	req.UUID, req.Balance, req.Timestamp = op.UUID, op.Amount, op.Timestamp
+}
+
+// mediaType 去掉参数并转为小写的媒体类型
+func mediaType(v string) string {
+	if i := strings.IndexByte(v, ';'); i >= 0 {
+		v = v[:i]
+	}
+	return strings.ToLower(strings.TrimSpace(v))
+}
+
+// isWireRequest 请求体是否为二进制编码
+func isWireRequest(r *http.Request) bool {
+	return mediaType(r.Header.Get("Content-Type")) == WireContentType
+}
+
+// wantsWire 客户端是否要求二进制响应
+func wantsWire(r *http.Request) bool {
+	for _, part := range strings.Split(r.Header.Get("Accept"), ",") {
+		if mediaType(part) == WireContentType {
+			return true
+		}
+	}
+	return false
+}
+
+// decodeRequest 按 Content-Type 解析单个账户操作的请求体
+func decodeRequest(r *http.Request, req wireRequest) error {
+	if !isWireRequest(r) {
+		return json.NewDecoder(r.Body).Decode(req)
+	}
+	op, err := readWireOp(r.Body)
+	if err != nil {
+		return err
+	}
+	req.fromWire(&op)
+	return nil
+}
+
+// decodeSyncBatch 按 Content-Type 解析批量同步请求体
+func decodeSyncBatch(r *http.Request, req *SyncBatchRequest) error {
+	if !isWireRequest(r) {
+		return json.NewDecoder(r.Body).Decode(req)
+	}
+	accounts, err := readWireSyncBatch(r.Body)
+	req.Accounts = accounts
+	return err
+}
+
+// readWireOp 读取一个操作请求，长度必须与 op_id_len 一致
+func readWireOp(body io.Reader) (wireOp, error) {
+	var op wireOp
+	var buf [wireOpFixedBytes + maxOpIDLength + 1]byte
+	n, _ := io.ReadFull(body, buf[:])
+	if n < wireOpFixedBytes || n != wireOpFixedBytes+int(buf[wireOpFixedBytes-1]) {
+		return op, errWireFormat
+	}
+	op.UUID = formatUUID(buf[0:wireUUIDBytes])
+	if !allZero(buf[wireUUIDBytes : 2*wireUUIDBytes]) {
+		op.UUIDTo = formatUUID(buf[wireUUIDBytes : 2*wireUUIDBytes])
+	}
+	op.Amount = binary.LittleEndian.Uint64(buf[32:40])
+	op.Timestamp = int64(binary.LittleEndian.Uint64(buf[40:48]))
+	op.OpID = string(buf[wireOpFixedBytes:n])
+	return op, nil
+}
+
+// readWireSyncBatch 读取批量同步请求，长度必须与条数一致
+func readWireSyncBatch(body io.Reader) ([]SyncAccountRequest, error) {
+	var head [4]byte
+	if _, err := io.ReadFull(body, head[:]); err != nil {
+		return nil, errWireFormat
+	}
+	count := int(binary.LittleEndian.Uint32(head[:]))
+	if count > maxSyncBatchSize {
+		return nil, errSyncBatchTooLarge
+	}
+
+	// 多读一个字节，用来发现多余的数据
+	buf := make([]byte, count*wireSyncRecordBytes+1)
+	if n, _ := io.ReadFull(body, buf); n != count*wireSyncRecordBytes {
+		return nil, errWireFormat
+	}
+	accounts := make([]SyncAccountRequest, count)
+	for i := range accounts {
+		rec := buf[i*wireSyncRecordBytes : (i+1)*wireSyncRecordBytes]
+		accounts[i].UUID = formatUUID(rec[0:wireUUIDBytes])
+		accounts[i].Balance = binary.LittleEndian.Uint64(rec[16:24])
+		accounts[i].Timestamp = int64(binary.LittleEndian.Uint64(rec[24:32]))
+	}
+	return accounts, nil
+}
+
+// writeWireStatus 写出二进制状态响应
+func writeWireStatus(w http.ResponseWriter, statusCode int, success bool, balance uint64, text string) {
+	if len(text) > 0xffff {
+		text = text[:0xffff]
+	}
+	buf := make([]byte, 11+len(text))
+	if success {
+		buf[0] = 1
+	}
+	binary.LittleEndian.PutUint64(buf[1:9], balance)
+	binary.LittleEndian.PutUint16(buf[9:11], uint16(len(text)))
+	copy(buf[11:], text)
+
+	w.Header().Set("Content-Type", WireContentType)
+	w.WriteHeader(statusCode)
+	w.Write(buf)
+}
+
+// writeWireSyncBatch 写出二进制批量同步响应，结果与请求顺序一致
+func writeWireSyncBatch(w http.ResponseWriter, results []SyncBatchItemResult) {
+	buf := make([]byte, 5+len(results))
+	buf[0] = 1
+	binary.LittleEndian.PutUint32(buf[1:5], uint32(len(results)))
+	for i := range results {
+		if results[i].Success {
+			buf[5+i] = 1
+		}
+	}
+
+	w.Header().Set("Content-Type", WireContentType)
+	w.WriteHeader(http.StatusOK)
+	w.Write(buf)
+}
+
+// writeWireAccounts 以二进制帧逐行写出账户列表，已开始输出后出错时结束帧的 success 为0
+func writeWireAccounts(w http.ResponseWriter, q models.AccountQuery, watermark int64) {
+	w.Header().Set("Content-Type", WireContentType)
+	w.WriteHeader(http.StatusOK)
+	out := bufio.NewWriterSize(w, 32*1024)
+	defer out.Flush()
+
+	var frame [1 + wireUUIDBytes + 8]byte
+	frame[0] = wireFrameAccount
+	count := 0
+	last := ""
+	err := models.ForEachAccount(q, func(acc *models.Account) error {
+		count++
+		last = acc.UUID
+		// 入库前已校验过格式，这里只防御异常数据
+		if !putUUID(frame[1:1+wireUUIDBytes], acc.UUID) {
+			log.Printf("账户UUID无法二进制编码，已跳过: %s", acc.UUID)
+			return nil
+		}
+		binary.LittleEndian.PutUint64(frame[1+wireUUIDBytes:], acc.Balance)
+		_, err := out.Write(frame[:])
+		return err
+	})
+
+	var end [1 + 1 + 8 + wireUUIDBytes]byte
+	end[0] = wireFrameEnd
+	if err != nil {
+		log.Printf("获取账户列表失败: %v", err)
+	} else {
+		end[1] = 1
+	}
+	binary.LittleEndian.PutUint64(end[2:10], uint64(watermark))
+	if q.Limit > 0 && count == q.Limit {
+		putUUID(end[10:], last)
+	}
+	out.Write(end[:])
+}
+
+// formatUUID 16字节转小写规范格式的 UUID
+func formatUUID(b []byte) string {
+	var s [36]byte
+	for i := range s {
+		s[i] = '-'
+	}
+	for k, off := range wireUUIDOffsets {
+		s[off] = hexDigits[b[k]>>4]
+		s[off+1] = hexDigits[b[k]&0x0f]
+	}
+	return string(s[:])
+}
+
+// putUUID 规范格式的 UUID（不区分大小写）转16字节
+func putUUID(b []byte, s string) bool {
+	if len(s) != 36 || s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-' {
+		return false
+	}
+	for k, off := range wireUUIDOffsets {
+		hi, ok1 := fromHex(s[off])
+		lo, ok2 := fromHex(s[off+1])
+		if !ok1 || !ok2 {
+			return false
+		}
+		b[k] = hi<<4 | lo
+	}
+	return true
+}
+
+func fromHex(c byte) (byte, bool) {
+	switch {
+	case '0' <= c && c <= '9':
+		return c - '0', true
+	case 'a' <= c && c <= 'f':
+		return c - 'a' + 10, true
+	case 'A' <= c && c <= 'F':
+		return c - 'A' + 10, true
+	}
+	return 0, false
+}
+
+func allZero(b []byte) bool {
+	for _, v := range b {
+		if v != 0 {
+			return false
+		}
+	}
+	return true
+}
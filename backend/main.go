@@ -7,6 +7,7 @@ import (
 	"os"
 	"os/signal"
 	"syscall"
+	"time"
 
 	"bamsystem-backend/config"
 	"bamsystem-backend/database"
@@ -37,6 +38,8 @@ func main() {
 
 	// 应用认证中间件
 	router.Use(middleware.AuthMiddleware)
+	// 请求体解压与响应压缩（认证通过后才解压请求体）
+	router.Use(middleware.CompressionMiddleware)
 
 	// 注册API路由
 	router.HandleFunc("/api/check", handlers.CheckServerHandler).Methods("GET")
@@ -46,6 +49,7 @@ func main() {
 	router.HandleFunc("/api/account/withdraw", handlers.WithdrawHandler).Methods("POST")
 	router.HandleFunc("/api/account/transfer", handlers.TransferHandler).Methods("POST")
 	router.HandleFunc("/api/account/sync", handlers.SyncAccountHandler).Methods("POST")
+	router.HandleFunc("/api/accounts/sync_batch", handlers.SyncAccountsBatchHandler).Methods("POST")
 	router.HandleFunc("/api/account/{uuid}", handlers.DeleteAccountHandler).Methods("DELETE")
 	router.HandleFunc("/api/public_key", handlers.GetPublicKeyHandler).Methods("GET")
 
@@ -65,16 +69,26 @@ func main() {
 		useHTTPS = false
 	}
 
+	// HTTPS 经 ALPN 协商 HTTP/2（标准库自动启用），客户端的并发请求在一个连接上多路复用；
+	// 明文 HTTP 为 HTTP/1.1（h2c 需要 golang.org/x/net）。空闲连接保留较久，
+	// 客户端两次同步之间不必重新握手
+	server := &http.Server{
+		Addr:              serverAddr,
+		Handler:           router,
+		ReadHeaderTimeout: 10 * time.Second,
+		IdleTimeout:       5 * time.Minute,
+	}
+
 	// 启动服务器
 	go func() {
 		if useHTTPS {
-			log.Printf("服务器启动在 HTTPS://0.0.0.0%s", serverAddr)
-			if err := http.ListenAndServeTLS(serverAddr, certFile, keyFile, router); err != nil {
+			log.Printf("服务器启动在 HTTPS://0.0.0.0%s（HTTP/2、HTTP/1.1）", serverAddr)
+			if err := server.ListenAndServeTLS(certFile, keyFile); err != nil {
 				log.Fatalf("HTTPS服务器启动失败: %v", err)
 			}
 		} else {
 			log.Printf("服务器启动在 HTTP://0.0.0.0%s", serverAddr)
-			if err := http.ListenAndServe(serverAddr, router); err != nil {
+			if err := server.ListenAndServe(); err != nil {
 				log.Fatalf("HTTP服务器启动失败: %v", err)
 			}
 		}
@@ -26,10 +26,11 @@ func AuthMiddleware(next http.Handler) http.Handler {
 		}
 
 		// 验证 Content-Type（仅对POST/PUT/PATCH等需要body的请求）
+		// 账户接口也接受二进制编码（handlers.WireContentType）
 		if r.Method == "POST" || r.Method == "PUT" || r.Method == "PATCH" {
 			contentType := r.Header.Get("Content-Type")
-			if contentType != "application/json" {
-				sendError(w, "Content-Type必须为application/json", http.StatusBadRequest)
+			if contentType != "application/json" && contentType != "application/x-bam-record" {
+				sendError(w, "Content-Type必须为application/json或application/x-bam-record", http.StatusBadRequest)
 				return
 			}
 		}
@@ -0,0 +1,132 @@
+package middleware
+
+import (
+	"compress/gzip"
+	"io"
+	"net/http"
+	"strconv"
+	"strings"
+	"sync"
+)
+
+// compressMinBytes 响应体达到该大小才压缩；更小的响应压缩后省不了多少
+const compressMinBytes = 1024
+
+// maxDecompressedBody 解压后请求体的上限，防止小请求体解压成超大数据
+const maxDecompressedBody = 64 << 20
+
+// gzip.Writer 初始化时分配的压缩状态较大，复用以免每个响应重新分配
+var gzipWriterPool = sync.Pool{
+	New: func() interface{} {
+		w, _ := gzip.NewWriterLevel(io.Discard, gzip.BestSpeed)
+		return w
+	},
+}
+
+// CompressionMiddleware 请求体与响应体的 gzip 压缩
+// 请求带 Content-Encoding: gzip 时透明解压，处理函数读到的是原始 JSON；
+// 客户端 Accept-Encoding 含 gzip 且响应体达到 compressMinBytes 时压缩输出，小响应原样发送
+func CompressionMiddleware(next http.Handler) http.Handler {
+	return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		if enc := r.Header.Get("Content-Encoding"); enc != "" {
+			if !strings.EqualFold(enc, "gzip") {
+				sendError(w, "不支持的Content-Encoding", http.StatusUnsupportedMediaType)
+				return
+			}
+			zr, err := gzip.NewReader(r.Body)
+			if err != nil {
+				sendError(w, "请求体解压失败", http.StatusBadRequest)
+				return
+			}
+			defer zr.Close()
+			r.Body = http.MaxBytesReader(w, zr, maxDecompressedBody)
+			r.Header.Del("Content-Encoding")
+			r.ContentLength = -1
+		}
+
+		w.Header().Add("Vary", "Accept-Encoding")
+		if !acceptsGzip(r.Header.Get("Accept-Encoding")) {
+			next.ServeHTTP(w, r)
+			return
+		}
+		cw := &compressWriter{ResponseWriter: w}
+		defer cw.Close()
+		next.ServeHTTP(cw, r)
+	})
+}
+
+// acceptsGzip Accept-Encoding 中是否有 gzip 且未以 q=0 排除
+func acceptsGzip(header string) bool {
+	for _, part := range strings.Split(header, ",") {
+		fields := strings.Split(part, ";")
+		if !strings.EqualFold(strings.TrimSpace(fields[0]), "gzip") {
+			continue
+		}
+		for _, param := range fields[1:] {
+			kv := strings.SplitN(strings.TrimSpace(param), "=", 2)
+			if len(kv) == 2 && kv[0] == "q" {
+				if q, err := strconv.ParseFloat(kv[1], 64); err == nil && q == 0 {
+					return false
+				}
+			}
+		}
+		return true
+	}
+	return false
+}
+
+// compressWriter 先缓冲响应体，达到 compressMinBytes 后改为 gzip 流式输出；
+// 响应结束时仍不足该大小则原样发送
+type compressWriter struct {
+	http.ResponseWriter
+	status int
+	buf    []byte
+	gz     *gzip.Writer
+}
+
+func (cw *compressWriter) WriteHeader(status int) {
+	if cw.status == 0 {
+		cw.status = status
+	}
+}
+
+func (cw *compressWriter) Write(p []byte) (int, error) {
+	if cw.status == 0 {
+		cw.status = http.StatusOK
+	}
+	if cw.gz != nil {
+		return cw.gz.Write(p)
+	}
+	cw.buf = append(cw.buf, p...)
+	if len(cw.buf) >= compressMinBytes {
+		h := cw.Header()
+		h.Set("Content-Encoding", "gzip")
+		h.Del("Content-Length")
+		cw.ResponseWriter.WriteHeader(cw.status)
+		cw.gz = gzipWriterPool.Get().(*gzip.Writer)
+		cw.gz.Reset(cw.ResponseWriter)
+		buffered := cw.buf
+		cw.buf = nil
+		if _, err := cw.gz.Write(buffered); err != nil {
+			return 0, err
+		}
+	}
+	return len(p), nil
+}
+
+// Close 结束 gzip 流，或把不足 compressMinBytes 的响应原样写出
+func (cw *compressWriter) Close() {
+	if cw.gz != nil {
+		cw.gz.Close()
+		gzipWriterPool.Put(cw.gz)
+		cw.gz = nil
+		return
+	}
+	if cw.status == 0 {
+		cw.status = http.StatusOK
+	}
+	cw.ResponseWriter.WriteHeader(cw.status)
+	if len(cw.buf) > 0 {
+		cw.ResponseWriter.Write(cw.buf)
+	}
+}
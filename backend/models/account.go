@@ -2,7 +2,9 @@ package models
 
 import (
 	"database/sql"
+	"errors"
 	"fmt"
+	"strings"
 	"time"
 
 	"bamsystem-backend/database"
@@ -16,14 +18,82 @@ type Account struct {
 	UpdatedAt time.Time `json:"updated_at"`
 }
 
-// CreateAccount 创建账户
-func CreateAccount(uuid string, balance uint64) error {
-	query := "INSERT INTO accounts (uuid, balance) VALUES (?, ?)"
-	_, err := database.DB.Exec(query, uuid, balance)
+// ErrAccountExists 创建的账户已存在（且不是同一 op_id 的重发）
+var ErrAccountExists = errors.New("账户已存在")
+
+// errAccountNotFound 加锁读取的账户不存在
+var errAccountNotFound = errors.New("账户不存在")
+
+// applyOnce 在一个事务中执行 fn
+// opID 非空时先在 applied_ops 中登记：同一 opID 已登记过（客户端重发已执行的操作）时不再执行，
+// 返回 replayed=true；fn 失败时登记随事务回滚，重发会再次执行
+func applyOnce(opID string, fn func(tx *sql.Tx) error) (replayed bool, err error) {
+	tx, err := database.DB.Begin()
 	if err != nil {
-		return fmt.Errorf("创建账户失败: %v", err)
+		return false, fmt.Errorf("开始事务失败: %v", err)
 	}
-	return nil
+	defer func() {
+		if err != nil {
+			tx.Rollback()
+		}
+	}()
+
+	if opID != "" {
+		var result sql.Result
+		result, err = tx.Exec("INSERT IGNORE INTO applied_ops (op_id) VALUES (?)", opID)
+		if err != nil {
+			return false, fmt.Errorf("登记操作失败: %v", err)
+		}
+		var rows int64
+		if rows, err = result.RowsAffected(); err != nil {
+			return false, fmt.Errorf("获取影响行数失败: %v", err)
+		}
+		if rows == 0 {
+			tx.Rollback()
+			return true, nil
+		}
+	}
+
+	if err = fn(tx); err != nil {
+		return false, err
+	}
+	if err = tx.Commit(); err != nil {
+		return false, fmt.Errorf("提交事务失败: %v", err)
+	}
+	return false, nil
+}
+
+// lockBalance 在事务中读取并锁定账户余额
+func lockBalance(tx *sql.Tx, uuid string) (uint64, error) {
+	var balance uint64
+	err := tx.QueryRow("SELECT balance FROM accounts WHERE uuid = ? FOR UPDATE", uuid).Scan(&balance)
+	if err != nil {
+		if err == sql.ErrNoRows {
+			return 0, errAccountNotFound
+		}
+		return 0, fmt.Errorf("查询账户失败: %v", err)
+	}
+	return balance, nil
+}
+
+// CreateAccount 创建账户
+// 同一 opID 的重发返回 replayed=true；UUID 已被其他操作占用时返回 ErrAccountExists，
+// 此时 opID 的登记随事务回滚
+func CreateAccount(opID, uuid string, balance uint64) (replayed bool, err error) {
+	return applyOnce(opID, func(tx *sql.Tx) error {
+		result, err := tx.Exec("INSERT IGNORE INTO accounts (uuid, balance) VALUES (?, ?)", uuid, balance)
+		if err != nil {
+			return fmt.Errorf("创建账户失败: %v", err)
+		}
+		rows, err := result.RowsAffected()
+		if err != nil {
+			return fmt.Errorf("获取影响行数失败: %v", err)
+		}
+		if rows == 0 {
+			return ErrAccountExists
+		}
+		return nil
+	})
 }
 
 // GetAccount 获取账户信息
@@ -63,117 +133,126 @@ func UpdateBalance(uuid string, newBalance uint64) error {
 	return nil
 }
 
-// Deposit 存款
-func Deposit(uuid string, amount uint64) (uint64, error) {
+// currentBalance 重发的操作不再执行，返回账户当前余额
+func currentBalance(uuid string) (uint64, error) {
 	account, err := GetAccount(uuid)
 	if err != nil {
 		return 0, err
 	}
+	return account.Balance, nil
+}
 
-	newBalance := account.Balance + amount
-	if err := UpdateBalance(uuid, newBalance); err != nil {
+// Deposit 存款
+func Deposit(opID, uuid string, amount uint64) (uint64, error) {
+	var newBalance uint64
+	replayed, err := applyOnce(opID, func(tx *sql.Tx) error {
+		balance, err := lockBalance(tx, uuid)
+		if err != nil {
+			return err
+		}
+		newBalance = balance + amount
+		if _, err := tx.Exec("UPDATE accounts SET balance = ? WHERE uuid = ?", newBalance, uuid); err != nil {
+			return fmt.Errorf("更新余额失败: %v", err)
+		}
+		return nil
+	})
+	if err != nil {
 		return 0, err
 	}
-
+	if replayed {
+		return currentBalance(uuid)
+	}
 	return newBalance, nil
 }
 
 // Withdraw 取款
-func Withdraw(uuid string, amount uint64) (uint64, error) {
-	account, err := GetAccount(uuid)
+func Withdraw(opID, uuid string, amount uint64) (uint64, error) {
+	var newBalance uint64
+	replayed, err := applyOnce(opID, func(tx *sql.Tx) error {
+		balance, err := lockBalance(tx, uuid)
+		if err != nil {
+			return err
+		}
+		if balance < amount {
+			return fmt.Errorf("余额不足")
+		}
+		newBalance = balance - amount
+		if _, err := tx.Exec("UPDATE accounts SET balance = ? WHERE uuid = ?", newBalance, uuid); err != nil {
+			return fmt.Errorf("更新余额失败: %v", err)
+		}
+		return nil
+	})
 	if err != nil {
 		return 0, err
 	}
-
-	if account.Balance < amount {
-		return 0, fmt.Errorf("余额不足")
+	if replayed {
+		return currentBalance(uuid)
 	}
-
-	newBalance := account.Balance - amount
-	if err := UpdateBalance(uuid, newBalance); err != nil {
-		return 0, err
-	}
-
 	return newBalance, nil
 }
 
 // Transfer 转账（使用事务）
-func Transfer(uuidFrom, uuidTo string, amount uint64) error {
-	// 开始事务
-	tx, err := database.DB.Begin()
-	if err != nil {
-		return fmt.Errorf("开始事务失败: %v", err)
-	}
-
-	// 确保事务正确结束
-	defer func() {
-		if err != nil {
-			tx.Rollback()
+// 两个账户都加锁后再检查余额；按 UUID 顺序加锁，方向相反的并发转账不会互相死锁
+func Transfer(opID, uuidFrom, uuidTo string, amount uint64) error {
+	_, err := applyOnce(opID, func(tx *sql.Tx) error {
+		order := [2]string{uuidFrom, uuidTo}
+		if uuidTo < uuidFrom {
+			order = [2]string{uuidTo, uuidFrom}
 		}
-	}()
-
-	// 检查转出账户余额
-	var fromBalance uint64
-	err = tx.QueryRow("SELECT balance FROM accounts WHERE uuid = ?", uuidFrom).Scan(&fromBalance)
-	if err != nil {
-		if err == sql.ErrNoRows {
-			return fmt.Errorf("转出账户不存在")
+		var fromBalance uint64
+		for _, uuid := range order {
+			balance, err := lockBalance(tx, uuid)
+			if err == errAccountNotFound {
+				if uuid == uuidFrom {
+					return fmt.Errorf("转出账户不存在")
+				}
+				return fmt.Errorf("转入账户不存在")
+			}
+			if err != nil {
+				return err
+			}
+			if uuid == uuidFrom {
+				fromBalance = balance
+			}
 		}
-		return fmt.Errorf("查询转出账户失败: %v", err)
-	}
 
-	if fromBalance < amount {
-		return fmt.Errorf("转出账户余额不足")
-	}
-
-	// 检查转入账户是否存在
-	var toBalance uint64
-	err = tx.QueryRow("SELECT balance FROM accounts WHERE uuid = ?", uuidTo).Scan(&toBalance)
-	if err != nil {
-		if err == sql.ErrNoRows {
-			return fmt.Errorf("转入账户不存在")
+		if fromBalance < amount {
+			return fmt.Errorf("转出账户余额不足")
 		}
-		return fmt.Errorf("查询转入账户失败: %v", err)
-	}
 
-	// 扣除转出账户余额
-	_, err = tx.Exec("UPDATE accounts SET balance = balance - ? WHERE uuid = ?", amount, uuidFrom)
-	if err != nil {
-		return fmt.Errorf("扣除转出账户余额失败: %v", err)
-	}
-
-	// 增加转入账户余额
-	_, err = tx.Exec("UPDATE accounts SET balance = balance + ? WHERE uuid = ?", amount, uuidTo)
-	if err != nil {
-		return fmt.Errorf("增加转入账户余额失败: %v", err)
-	}
-
-	// 提交事务
-	if err = tx.Commit(); err != nil {
-		return fmt.Errorf("提交事务失败: %v", err)
-	}
+		// 扣除转出账户余额
+		if _, err := tx.Exec("UPDATE accounts SET balance = balance - ? WHERE uuid = ?", amount, uuidFrom); err != nil {
+			return fmt.Errorf("扣除转出账户余额失败: %v", err)
+		}
 
-	return nil
+		// 增加转入账户余额
+		if _, err := tx.Exec("UPDATE accounts SET balance = balance + ? WHERE uuid = ?", amount, uuidTo); err != nil {
+			return fmt.Errorf("增加转入账户余额失败: %v", err)
+		}
+		return nil
+	})
+	return err
 }
 
 // DeleteAccount 删除账户
-func DeleteAccount(uuid string) error {
-	query := "DELETE FROM accounts WHERE uuid = ?"
-	result, err := database.DB.Exec(query, uuid)
-	if err != nil {
-		return fmt.Errorf("删除账户失败: %v", err)
-	}
-
-	rows, err := result.RowsAffected()
-	if err != nil {
-		return fmt.Errorf("获取影响行数失败: %v", err)
-	}
+func DeleteAccount(opID, uuid string) error {
+	_, err := applyOnce(opID, func(tx *sql.Tx) error {
+		result, err := tx.Exec("DELETE FROM accounts WHERE uuid = ?", uuid)
+		if err != nil {
+			return fmt.Errorf("删除账户失败: %v", err)
+		}
 
-	if rows == 0 {
-		return fmt.Errorf("账户不存在")
-	}
+		rows, err := result.RowsAffected()
+		if err != nil {
+			return fmt.Errorf("获取影响行数失败: %v", err)
+		}
 
-	return nil
+		if rows == 0 {
+			return fmt.Errorf("账户不存在")
+		}
+		return nil
+	})
+	return err
 }
 
 // SyncAccount 同步账户数据（创建或更新）
@@ -190,6 +269,63 @@ func SyncAccount(uuid string, balance uint64) error {
 	return nil
 }
 
+// SyncItem 批量同步中的一个账户
+type SyncItem struct {
+	UUID    string
+	Balance uint64
+}
+
+// syncBatchRowsPerStatement 每条 INSERT 语句的行数（每行2个占位符，远低于 MySQL 65535 的上限）
+const syncBatchRowsPerStatement = 500
+
+// SyncAccountsBatch 在一个事务中批量同步账户（创建或更新）
+// 同一批中重复的UUID以最后一个为准
+func SyncAccountsBatch(items []SyncItem) (err error) {
+	if len(items) == 0 {
+		return nil
+	}
+
+	tx, err := database.DB.Begin()
+	if err != nil {
+		return fmt.Errorf("开始事务失败: %v", err)
+	}
+	defer func() {
+		if err != nil {
+			tx.Rollback()
+		}
+	}()
+
+	for start := 0; start < len(items); start += syncBatchRowsPerStatement {
+		end := start + syncBatchRowsPerStatement
+		if end > len(items) {
+			end = len(items)
+		}
+		chunk := items[start:end]
+
+		// INSERT ... VALUES (?, ?), (?, ?) ... ON DUPLICATE KEY UPDATE
+		var query strings.Builder
+		query.WriteString("INSERT INTO accounts (uuid, balance) VALUES ")
+		args := make([]interface{}, 0, len(chunk)*2)
+		for i, item := range chunk {
+			if i > 0 {
+				query.WriteString(", ")
+			}
+			query.WriteString("(?, ?)")
+			args = append(args, item.UUID, item.Balance)
+		}
+		query.WriteString(" ON DUPLICATE KEY UPDATE balance = VALUES(balance)")
+
+		if _, err = tx.Exec(query.String(), args...); err != nil {
+			return fmt.Errorf("批量同步账户失败: %v", err)
+		}
+	}
+
+	if err = tx.Commit(); err != nil {
+		return fmt.Errorf("提交事务失败: %v", err)
+	}
+	return nil
+}
+
 // AccountExists 检查账户是否存在
 func AccountExists(uuid string) bool {
 	var exists bool
@@ -198,6 +334,75 @@ func AccountExists(uuid string) bool {
 	return err == nil && exists
 }
 
+// syncOverlapSeconds 增量查询时向前多取的秒数
+// updated_at 精度为秒，且事务提交时刻晚于其写入的 updated_at，
+// 多取几秒避免漏掉水位附近提交的修改（重复返回的账户由客户端按余额覆盖）
+const syncOverlapSeconds = 5
+
+// AccountQuery 账户列表查询条件
+type AccountQuery struct {
+	Since int64  // 水位（Unix 秒），只返回此后修改过的账户；0 表示不筛选
+	After string // 键集分页：只返回 uuid 大于此值的账户；空表示从头开始
+	Limit int    // 每页数量；0 表示不分页
+}
+
+// CurrentWatermark 返回数据库当前时间，客户端下次增量查询时作为 since 传入
+func CurrentWatermark() (int64, error) {
+	var watermark int64
+	if err := database.DB.QueryRow("SELECT UNIX_TIMESTAMP()").Scan(&watermark); err != nil {
+		return 0, fmt.Errorf("查询数据库时间失败: %v", err)
+	}
+	return watermark, nil
+}
+
+// ForEachAccount 按查询条件逐行读取账户并交给 fn，不在内存中保存整个列表
+// 分页时按主键 uuid 排序（WHERE uuid > ? ORDER BY uuid LIMIT ?，翻页代价与页码无关），
+// 不分页时保持原来的 created_at 倒序
+func ForEachAccount(q AccountQuery, fn func(*Account) error) error {
+	var conds []string
+	var args []interface{}
+	if q.Since > 0 {
+		conds = append(conds, "updated_at >= FROM_UNIXTIME(?)")
+		args = append(args, q.Since-syncOverlapSeconds)
+	}
+	if q.After != "" {
+		conds = append(conds, "uuid > ?")
+		args = append(args, q.After)
+	}
+
+	query := "SELECT uuid, balance, created_at, updated_at FROM accounts"
+	if len(conds) > 0 {
+		query += " WHERE " + strings.Join(conds, " AND ")
+	}
+	if q.Limit > 0 {
+		query += " ORDER BY uuid LIMIT ?"
+		args = append(args, q.Limit)
+	} else {
+		query += " ORDER BY created_at DESC"
+	}
+
+	rows, err := database.DB.Query(query, args...)
+	if err != nil {
+		return fmt.Errorf("查询账户列表失败: %v", err)
+	}
+	defer rows.Close()
+
+	var acc Account
+	for rows.Next() {
+		if err := rows.Scan(&acc.UUID, &acc.Balance, &acc.CreatedAt, &acc.UpdatedAt); err != nil {
+			return fmt.Errorf("扫描账户数据失败: %v", err)
+		}
+		if err := fn(&acc); err != nil {
+			return err
+		}
+	}
+
+	if err = rows.Err(); err != nil {
+		return fmt.Errorf("遍历账户数据失败: %v", err)
+	}
+	return nil
+}
+
 // GetAllAccounts 获取所有账户
 func GetAllAccounts() ([]Account, error) {
 	query := "SELECT uuid, balance, created_at, updated_at FROM accounts ORDER BY created_at DESC"
@@ -0,0 +1,98 @@
+#include "include/bench.h"
+
+#include <lib/amount.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AMOUNT_BENCH_COUNT 1000000
+#define AMOUNT_BENCH_ROUNDS 5
+
+typedef struct {
+    char text[AMOUNT_STR_MAX];
+    size_t len;
+} AmountSample;
+
+static AmountSample *make_samples(void)
+{
+    AmountSample *samples = (AmountSample *)malloc(sizeof(AmountSample) * AMOUNT_BENCH_COUNT);
+    if (!samples) {
+        return NULL;
+    }
+
+    /* 固定种子的伪随机金额，覆盖 0.01 ~ 约1亿元 */
+    unsigned long long x = 88172645463325252ULL;
+    for (int i = 0; i < AMOUNT_BENCH_COUNT; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        LLUINT cents = x % 10000000000ULL;
+        samples[i].len = format_amount_cents(cents, samples[i].text, sizeof(samples[i].text));
+    }
+    return samples;
+}
+
+static void bench_amount_parse_rate(void)
+{
+    AmountSample *samples = make_samples();
+    if (!samples) {
+        printf("out of memory\n");
+        return;
+    }
+
+    /* 新解析器 */
+    double best = 1e30;
+    for (int r = 0; r < AMOUNT_BENCH_ROUNDS; r++) {
+        unsigned long long sum = 0;
+        double t0 = bench_now();
+        for (int i = 0; i < AMOUNT_BENCH_COUNT; i++) {
+            LLUINT cents = 0;
+            parse_amount_cents(samples[i].text, samples[i].len, &cents);
+            sum += cents;
+        }
+        double dt = bench_now() - t0;
+        bench_consume(sum);
+        if (dt < best) best = dt;
+    }
+    printf("parse_amount_cents : %8.1f M/s  (%6.1f ns/op)\n",
+           AMOUNT_BENCH_COUNT / best / 1e6, best * 1e9 / AMOUNT_BENCH_COUNT);
+
+    /* 旧做法：strtod + (LLUINT)(amount * 100) */
+    double best_old = 1e30;
+    int mismatches = 0;
+    for (int r = 0; r < AMOUNT_BENCH_ROUNDS; r++) {
+        unsigned long long sum = 0;
+        mismatches = 0;
+        double t0 = bench_now();
+        for (int i = 0; i < AMOUNT_BENCH_COUNT; i++) {
+            double amount = strtod(samples[i].text, NULL);
+            LLUINT cents = (LLUINT)(amount * 100);
+            sum += cents;
+        }
+        double dt = bench_now() - t0;
+        bench_consume(sum);
+        if (dt < best_old) best_old = dt;
+    }
+    for (int i = 0; i < AMOUNT_BENCH_COUNT; i++) {
+        LLUINT exact = 0;
+        parse_amount_cents(samples[i].text, samples[i].len, &exact);
+        if ((LLUINT)(strtod(samples[i].text, NULL) * 100) != exact) {
+            mismatches++;
+        }
+    }
+    printf("strtod * 100       : %8.1f M/s  (%6.1f ns/op)\n",
+           AMOUNT_BENCH_COUNT / best_old / 1e6, best_old * 1e9 / AMOUNT_BENCH_COUNT);
+    printf("speedup            : %.2fx\n", best_old / best);
+    printf("strtod mismatches  : %d / %d (%.2f%%)\n",
+           mismatches, AMOUNT_BENCH_COUNT, 100.0 * mismatches / AMOUNT_BENCH_COUNT);
+
+    free(samples);
+}
+
+void register_amount_benches(void)
+{
+    bench_register(bench_amount_parse_rate,
+                   "amount.parse_rate",
+                   "parse_amount_cents vs strtod*100 on 1M formatted amounts");
+}
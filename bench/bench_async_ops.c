@@ -0,0 +1,154 @@
+#include "include/bench.h"
+
+#include <lib/async_ops.h>
+#include <lib/engine.h>
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ASYNC_BENCH_ACCOUNTS 256
+#define ASYNC_BENCH_OPS 20000
+
+/* 模拟服务器往返：同步线程每次休眠1ms */
+static bool slow_sync(EngineOpType type, const char *uuid, const char *uuid_to, LLUINT amount)
+{
+    (void)type;
+    (void)uuid;
+    (void)uuid_to;
+    (void)amount;
+    platform_sleep_ms(1);
+    return true;
+}
+
+static void count_done(const AsyncResult *result, void *user)
+{
+    (void)result;
+    atomic_fetch_add((atomic_size_t *)user, 1);
+}
+
+static void run_blocking(const char *label, char (*uuids)[37])
+{
+    unsigned int rng = 0x9E3779B9u;
+    double t0 = bench_now();
+    for (int i = 0; i < ASYNC_BENCH_OPS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        AccountStatus st = engine_deposit(uuids[(rng >> 8) % ASYNC_BENCH_ACCOUNTS], 1, NULL);
+        bench_consume((unsigned long long)st);
+    }
+    double elapsed = bench_now() - t0;
+    printf("  %-22s %9.0f ops/s\n", label, ASYNC_BENCH_OPS / elapsed);
+}
+
+static void run_async(const char *label, char (*uuids)[37])
+{
+    atomic_size_t done;
+    atomic_init(&done, 0);
+
+    unsigned int rng = 0x9E3779B9u;
+    double t0 = bench_now();
+    for (int i = 0; i < ASYNC_BENCH_OPS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        async_op_release(async_deposit(uuids[(rng >> 8) % ASYNC_BENCH_ACCOUNTS], 1,
+                                       count_done, &done));
+    }
+    double submitted = bench_now() - t0;
+
+    AsyncStats st;
+    async_get_stats(&st);
+    size_t in_flight = st.in_flight;
+    while (atomic_load(&done) < ASYNC_BENCH_OPS) {
+        platform_sleep_ms(1);
+    }
+    double elapsed = bench_now() - t0;
+    printf("  %-22s %9.0f ops/s  (submit %.1f ms, %zu in flight after submit)\n",
+           label, ASYNC_BENCH_OPS / elapsed, submitted * 1e3, in_flight);
+}
+
+static void bench_async_pipeline(void)
+{
+    if (!init_account_system()) {
+        printf("account system init failed\n");
+        return;
+    }
+
+    char (*uuids)[37] = malloc(ASYNC_BENCH_ACCOUNTS * sizeof(*uuids));
+    if (!uuids) {
+        printf("out of memory\n");
+        return;
+    }
+    for (int i = 0; i < ASYNC_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1234567;
+        acc.BALANCE = 0;
+        save_account(&acc);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    EngineConfig config;
+    config.mode = ENGINE_MODE_SINGLE_WRITER;
+    config.queue_capacity = 1024;
+    config.max_batch = 64;
+    if (!engine_start(&config)) {
+        printf("engine start failed\n");
+        free(uuids);
+        return;
+    }
+
+    printf("single caller, %d deposits over %d accounts (single writer engine)\n",
+           ASYNC_BENCH_OPS, ASYNC_BENCH_ACCOUNTS);
+    run_blocking("blocking", uuids);
+
+    if (async_start(NULL)) {
+        run_async("async", uuids);
+        cleanup_async_ops();
+    }
+
+    EngineStats es;
+    engine_get_stats(&es);
+    printf("  engine batches=%zu  max batch=%zu\n", es.batches, es.max_batch_seen);
+    cleanup_engine();
+
+    /* 1ms 的同步往返：阻塞调用方每笔都要等，异步只在后台排队 */
+    printf("200 deposits with a simulated 1 ms server round trip\n");
+    double t0 = bench_now();
+    for (int i = 0; i < 200; i++) {
+        engine_deposit(uuids[i % ASYNC_BENCH_ACCOUNTS], 1, NULL);
+        slow_sync(ENGINE_OP_DEPOSIT, uuids[i % ASYNC_BENCH_ACCOUNTS], NULL, 1);
+    }
+    printf("  %-22s %9.1f ms\n", "blocking caller", (bench_now() - t0) * 1e3);
+
+    if (async_start(slow_sync)) {
+        t0 = bench_now();
+        for (int i = 0; i < 200; i++) {
+            AsyncOp *op = async_deposit(uuids[i % ASYNC_BENCH_ACCOUNTS], 1, NULL, NULL);
+            async_op_wait(op, NULL);
+            async_op_release(op);
+        }
+        printf("  %-22s %9.1f ms  (caller waits for local apply only)\n",
+               "async caller", (bench_now() - t0) * 1e3);
+        cleanup_async_ops();
+    }
+
+    /* 存款后余额非0，清零后再销户 */
+    for (int i = 0; i < ASYNC_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (load_account(uuids[i], &acc)) {
+            acc.BALANCE = 0;
+            save_account(&acc);
+        }
+        delete_account_file(uuids[i]);
+    }
+    free(uuids);
+    cleanup_account_system();
+}
+
+void register_async_ops_benches(void)
+{
+    bench_register(bench_async_pipeline,
+                   "async: pipelined submission",
+                   "blocking engine calls vs fire-and-forget handles; caller latency with slow sync");
+}
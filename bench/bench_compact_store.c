@@ -0,0 +1,119 @@
+#include "include/bench.h"
+
+#include <lib/compact_store.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COMPACT_BENCH_ACCOUNTS 1000000
+#define COMPACT_BENCH_LOOKUPS 1000000
+#define COMPACT_BENCH_UPDATES 200000
+
+static double table_lookup_ns(AccountHashTable *table, char (*uuids)[37])
+{
+    unsigned int rng = 0x9E3779B9u;
+    double t0 = bench_now();
+    for (int i = 0; i < COMPACT_BENCH_LOOKUPS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        ACCOUNT *acc = account_table_find(table, uuids[(rng >> 4) % COMPACT_BENCH_ACCOUNTS]);
+        bench_consume(acc ? acc->BALANCE : 0);
+    }
+    return (bench_now() - t0) * 1e9 / COMPACT_BENCH_LOOKUPS;
+}
+
+static double compact_lookup_ns(CompactStore *store, char (*uuids)[37])
+{
+    unsigned int rng = 0x9E3779B9u;
+    double t0 = bench_now();
+    for (int i = 0; i < COMPACT_BENCH_LOOKUPS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        ACCOUNT acc;
+        bool found = compact_store_get(store, uuids[(rng >> 4) % COMPACT_BENCH_ACCOUNTS], &acc);
+        bench_consume(found ? acc.BALANCE : 0);
+    }
+    return (bench_now() - t0) * 1e9 / COMPACT_BENCH_LOOKUPS;
+}
+
+static void bench_compact_store_memory(void)
+{
+    ACCOUNT *accounts = malloc(COMPACT_BENCH_ACCOUNTS * sizeof(ACCOUNT));
+    char (*uuids)[37] = malloc(COMPACT_BENCH_ACCOUNTS * sizeof(*uuids));
+    if (!accounts || !uuids) {
+        printf("out of memory\n");
+        free(accounts);
+        free(uuids);
+        return;
+    }
+
+    /* 7位密码、余额大多在几十万分以内 */
+    unsigned int rng = 12345u;
+    for (int i = 0; i < COMPACT_BENCH_ACCOUNTS; i++) {
+        generate_uuid_string(accounts[i].UUID);
+        rng = rng * 1103515245u + 12345u;
+        accounts[i].PASSWORD = 1000000 + (rng >> 8) % 9000000;
+        rng = rng * 1103515245u + 12345u;
+        accounts[i].BALANCE = (rng >> 8) % 500000;
+        memcpy(uuids[i], accounts[i].UUID, 37);
+    }
+
+    AccountHashTable table;
+    account_table_init(&table);
+    for (int i = 0; i < COMPACT_BENCH_ACCOUNTS; i++) {
+        account_table_insert(&table, &accounts[i]);
+    }
+    size_t table_bytes = table.count * sizeof(AccountNode) + table.size * sizeof(AccountNode *);
+
+    CompactStore *store = compact_store_create(32, 4096);
+    double t0 = bench_now();
+    bool built = store && compact_store_build(store, accounts, COMPACT_BENCH_ACCOUNTS);
+    double build_ms = (bench_now() - t0) * 1e3;
+    if (!built) {
+        printf("compact build failed\n");
+        account_table_cleanup(&table);
+        compact_store_destroy(store);
+        free(accounts);
+        free(uuids);
+        return;
+    }
+    free(accounts);
+
+    CompactStoreStats st;
+    compact_store_get_stats(store, &st);
+    printf("%d accounts, %d random lookups, block size 32\n",
+           COMPACT_BENCH_ACCOUNTS, COMPACT_BENCH_LOOKUPS);
+    printf("  %-14s %6.1f B/account (excl. malloc headers)  %7.1f ns/lookup\n", "hash table",
+           (double)table_bytes / COMPACT_BENCH_ACCOUNTS, table_lookup_ns(&table, uuids));
+    printf("  %-14s %6.1f B/account (blocks %.1f + index %.1f)  %7.1f ns/lookup  build %.0f ms\n",
+           "compact", (double)compact_store_memory_bytes(&st) / COMPACT_BENCH_ACCOUNTS,
+           (double)st.base_bytes / COMPACT_BENCH_ACCOUNTS,
+           (double)st.index_bytes / COMPACT_BENCH_ACCOUNTS,
+           compact_lookup_ns(store, uuids), build_ms);
+
+    /* 更新进入增量表，每 4096 条归并一次 */
+    t0 = bench_now();
+    for (int i = 0; i < COMPACT_BENCH_UPDATES; i++) {
+        rng = rng * 1103515245u + 12345u;
+        ACCOUNT acc;
+        if (compact_store_get(store, uuids[(rng >> 4) % COMPACT_BENCH_ACCOUNTS], &acc)) {
+            acc.BALANCE += 100;
+            compact_store_put(store, &acc);
+        }
+    }
+    double update_s = bench_now() - t0;
+    compact_store_get_stats(store, &st);
+    printf("  %-14s %7.2f us/update  merges=%zu  last merge %.1f ms  delta=%zu\n", "compact update",
+           update_s * 1e6 / COMPACT_BENCH_UPDATES, st.merges, st.last_merge_us / 1000.0,
+           st.delta_count);
+
+    compact_store_destroy(store);
+    account_table_cleanup(&table);
+    free(uuids);
+}
+
+void register_compact_store_benches(void)
+{
+    bench_register(bench_compact_store_memory,
+                   "compact_store: bytes/account and lookup",
+                   "1M accounts in the per-node hash table vs prefix-compressed sorted blocks");
+}
@@ -0,0 +1,129 @@
+#include "include/bench.h"
+
+#include <lib/disk_index.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DISK_INDEX_BENCH_ACCOUNTS 20000
+#define DISK_INDEX_BENCH_LOOKUPS 100000
+#define DISK_INDEX_BENCH_FILE "Card/bench.idx"
+
+static bool open_index(size_t pool_pages)
+{
+    DiskIndexConfig config;
+    load_disk_index_config("no-such-engine.conf", &config);
+    config.enabled = true;
+    config.pool_pages = pool_pages;
+    snprintf(config.index_file, sizeof(config.index_file), "%s", DISK_INDEX_BENCH_FILE);
+    return disk_index_open(&config);
+}
+
+static void lookup_run(const char *label, char (*uuids)[37])
+{
+    DiskIndexStats before;
+    disk_index_get_stats(&before);
+
+    unsigned int rng = 0x9E3779B9u;
+    double t0 = bench_now();
+    for (int i = 0; i < DISK_INDEX_BENCH_LOOKUPS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        ACCOUNT acc;
+        bool found = account_read_file(uuids[(rng >> 8) % DISK_INDEX_BENCH_ACCOUNTS], &acc);
+        bench_consume(found ? acc.BALANCE : 0);
+    }
+    double ns = (bench_now() - t0) * 1e9 / DISK_INDEX_BENCH_LOOKUPS;
+
+    DiskIndexStats after;
+    disk_index_get_stats(&after);
+    printf("  %-22s %8.1f ns/lookup  %.2f page reads/lookup\n", label, ns,
+           (double)(after.page_reads - before.page_reads) / DISK_INDEX_BENCH_LOOKUPS);
+}
+
+static void bench_disk_index_cold_start(void)
+{
+    if (!init_account_system()) {
+        printf("account system init failed\n");
+        return;
+    }
+
+    char (*uuids)[37] = malloc(DISK_INDEX_BENCH_ACCOUNTS * sizeof(*uuids));
+    if (!uuids) {
+        printf("out of memory\n");
+        cleanup_account_system();
+        return;
+    }
+    remove(DISK_INDEX_BENCH_FILE);
+    remove(DISK_INDEX_BENCH_FILE ".ovf");
+    if (!open_index(64)) {
+        printf("disk index open failed\n");
+        free(uuids);
+        cleanup_account_system();
+        return;
+    }
+    for (int i = 0; i < DISK_INDEX_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1000000 + (LLUINT)i;
+        acc.BALANCE = (LLUINT)i * 37;
+        save_account(&acc);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+    cleanup_disk_index();
+
+    /* 原启动方式：逐个读取 .card 文件 */
+    double t0 = bench_now();
+    for (int i = 0; i < DISK_INDEX_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        bench_consume(account_read_file(uuids[i], &acc) ? acc.BALANCE : 0);
+    }
+    double scan_ms = (bench_now() - t0) * 1e3;
+
+    /* 打开正常关闭的索引并读取一个账户 */
+    t0 = bench_now();
+    bool opened = open_index(64);
+    ACCOUNT first;
+    bench_consume(opened && account_read_file(uuids[0], &first) ? first.BALANCE : 0);
+    double open_ms = (bench_now() - t0) * 1e3;
+
+    DiskIndexStats st;
+    disk_index_get_stats(&st);
+    printf("%d accounts, index %.1f KB (%zu buckets, %zu overflow pages)\n",
+           DISK_INDEX_BENCH_ACCOUNTS, st.file_bytes / 1024.0, st.buckets, st.overflow_pages);
+    printf("  %-22s %8.2f ms\n", "read all .card files", scan_ms);
+    printf("  %-22s %8.2f ms  (%llu page reads)\n", "open index + 1 lookup", open_ms,
+           (unsigned long long)st.page_reads);
+    lookup_run("pool 64 pages", uuids);
+    cleanup_disk_index();
+    open_index(st.buckets + st.overflow_pages + 1);
+    lookup_run("pool holds all pages", uuids);
+
+    /* 索引文件丢失：从 .card 文件重建（线程池并行读取），与上面逐个读取对比 */
+    cleanup_disk_index();
+    remove(DISK_INDEX_BENCH_FILE);
+    remove(DISK_INDEX_BENCH_FILE ".ovf");
+    t0 = bench_now();
+    opened = open_index(64);
+    double rebuild_ms = (bench_now() - t0) * 1e3;
+    disk_index_get_stats(&st);
+    printf("  %-22s %8.2f ms  (%zu accounts)\n", "rebuild from .card", rebuild_ms,
+           opened && st.rebuilt ? st.count : 0);
+
+    for (int i = 0; i < DISK_INDEX_BENCH_ACCOUNTS; i++) {
+        delete_account_file(uuids[i]);
+    }
+    cleanup_disk_index();
+    remove(DISK_INDEX_BENCH_FILE);
+    remove(DISK_INDEX_BENCH_FILE ".ovf");
+    free(uuids);
+    cleanup_account_system();
+}
+
+void register_disk_index_benches(void)
+{
+    bench_register(bench_disk_index_cold_start,
+                   "disk_index: cold start and lookups",
+                   "reading every .card file vs opening the linear-hash index, lookups through the buffer pool");
+}
@@ -0,0 +1,138 @@
+#include "include/bench.h"
+
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ENGINE_BENCH_ACCOUNTS 256
+#define ENGINE_BENCH_TOTAL_OPS 16000
+#define ENGINE_BENCH_MAX_PRODUCERS 16
+
+typedef struct {
+    char (*uuids)[37];
+    int ops;
+    unsigned int seed;
+    bool use_engine;
+    double *latencies;            /* 每个操作的耗时（秒） */
+} ProducerCtx;
+
+static void producer_main(void *arg)
+{
+    ProducerCtx *ctx = (ProducerCtx *)arg;
+    unsigned int rng = ctx->seed;
+
+    for (int i = 0; i < ctx->ops; i++) {
+        rng = rng * 1103515245u + 12345u;
+        const char *uuid = ctx->uuids[(rng >> 8) % ENGINE_BENCH_ACCOUNTS];
+
+        double t0 = bench_now();
+        AccountStatus s = ctx->use_engine ? engine_deposit(uuid, 1, NULL)
+                                          : account_apply_deposit(uuid, 1, NULL);
+        ctx->latencies[i] = bench_now() - t0;
+        bench_consume((unsigned long long)s);
+    }
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_case(char (*uuids)[37], int producers, bool use_engine, double *latencies)
+{
+    EngineConfig config;
+    config.mode = ENGINE_MODE_SINGLE_WRITER;
+    config.queue_capacity = 1024;
+    config.max_batch = 64;
+    if (use_engine && !engine_start(&config)) {
+        printf("engine start failed\n");
+        return;
+    }
+
+    int per = ENGINE_BENCH_TOTAL_OPS / producers;
+    ProducerCtx ctx[ENGINE_BENCH_MAX_PRODUCERS];
+    PlatformThread threads[ENGINE_BENCH_MAX_PRODUCERS];
+
+    double t0 = bench_now();
+    for (int p = 0; p < producers; p++) {
+        ctx[p].uuids = uuids;
+        ctx[p].ops = per;
+        ctx[p].seed = 0x9E3779B9u * (unsigned int)(p + 1);
+        ctx[p].use_engine = use_engine;
+        ctx[p].latencies = latencies + (size_t)p * per;
+        platform_thread_create(&threads[p], producer_main, &ctx[p]);
+    }
+    for (int p = 0; p < producers; p++) {
+        platform_thread_join(threads[p]);
+    }
+    double elapsed = bench_now() - t0;
+
+    EngineStats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (use_engine) {
+        engine_get_stats(&stats);
+        cleanup_engine();
+    }
+
+    size_t total = (size_t)per * producers;
+    qsort(latencies, total, sizeof(double), cmp_double);
+    printf("  %-13s producers=%-3d %9.0f ops/s  p50=%7.1f us  p99=%8.1f us",
+           use_engine ? "single_writer" : "mutex", producers, total / elapsed,
+           latencies[total / 2] * 1e6, latencies[total * 99 / 100] * 1e6);
+    if (use_engine) {
+        printf("  avg_batch=%.1f", stats.batches ? (double)stats.applied / stats.batches : 0.0);
+    }
+    printf("\n");
+}
+
+static void bench_engine_vs_mutex(void)
+{
+    if (!init_account_system()) {
+        printf("account system init failed\n");
+        return;
+    }
+
+    char (*uuids)[37] = malloc(ENGINE_BENCH_ACCOUNTS * sizeof(*uuids));
+    double *latencies = malloc(ENGINE_BENCH_TOTAL_OPS * sizeof(double));
+    if (!uuids || !latencies) {
+        printf("out of memory\n");
+        free(uuids);
+        free(latencies);
+        return;
+    }
+
+    for (int i = 0; i < ENGINE_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1234567;
+        save_account(&acc);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    printf("accounts=%d ops/run=%d (deposit, each op persisted before returning)\n",
+           ENGINE_BENCH_ACCOUNTS, ENGINE_BENCH_TOTAL_OPS);
+    for (int producers = 1; producers <= ENGINE_BENCH_MAX_PRODUCERS; producers *= 2) {
+        run_case(uuids, producers, false, latencies);
+        run_case(uuids, producers, true, latencies);
+    }
+
+    /* 清理测试账户 */
+    for (int i = 0; i < ENGINE_BENCH_ACCOUNTS; i++) {
+        delete_account_file(uuids[i]);
+    }
+    free(uuids);
+    free(latencies);
+    cleanup_account_system();
+}
+
+void register_engine_benches(void)
+{
+    bench_register(bench_engine_vs_mutex,
+                   "engine: single_writer vs mutex",
+                   "deposit throughput/latency with 1-16 producers");
+}
@@ -0,0 +1,110 @@
+#include "include/bench.h"
+
+#include <lib/flusher.h>
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLUSHER_BENCH_ACCOUNTS 256
+#define FLUSHER_BENCH_OPS 20000
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void run_deposits(const char *label, char (*uuids)[37])
+{
+    double *latencies = malloc(FLUSHER_BENCH_OPS * sizeof(double));
+    if (!latencies) {
+        printf("out of memory\n");
+        return;
+    }
+
+    unsigned int rng = 0x9E3779B9u;
+    double t0 = bench_now();
+    for (int i = 0; i < FLUSHER_BENCH_OPS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        double s = bench_now();
+        AccountStatus st = engine_deposit(uuids[(rng >> 8) % FLUSHER_BENCH_ACCOUNTS], 1, NULL);
+        latencies[i] = bench_now() - s;
+        bench_consume((unsigned long long)st);
+    }
+    double elapsed = bench_now() - t0;
+
+    qsort(latencies, FLUSHER_BENCH_OPS, sizeof(double), cmp_double);
+    printf("  %-8s %9.0f ops/s  p50=%7.1f us  p99=%8.1f us\n",
+           label, FLUSHER_BENCH_OPS / elapsed,
+           latencies[FLUSHER_BENCH_OPS / 2] * 1e6,
+           latencies[FLUSHER_BENCH_OPS * 99 / 100] * 1e6);
+    free(latencies);
+}
+
+static void bench_flusher_durability(void)
+{
+    if (!init_account_system()) {
+        printf("account system init failed\n");
+        return;
+    }
+
+    char (*uuids)[37] = malloc(FLUSHER_BENCH_ACCOUNTS * sizeof(*uuids));
+    if (!uuids) {
+        printf("out of memory\n");
+        return;
+    }
+    for (int i = 0; i < FLUSHER_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1234567;
+        acc.BALANCE = 0;
+        save_account(&acc);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    printf("single caller, %d deposits over %d accounts (mutex engine)\n",
+           FLUSHER_BENCH_OPS, FLUSHER_BENCH_ACCOUNTS);
+    run_deposits("sync", uuids);
+
+    FlusherConfig config;
+    config.durability = FLUSHER_DURABILITY_JOURNAL;
+    config.flush_interval_ms = 100;
+    config.dirty_threshold = 128;
+    config.journal_fsync = false;
+    if (flusher_start(&config)) {
+        run_deposits("journal", uuids);
+
+        FlusherStats st;
+        flusher_get_stats(&st);
+        printf("  flushes=%zu  accounts_flushed=%zu  backlog=%zu  flush avg=%.2f ms max=%.2f ms\n",
+               st.flushes, st.accounts_flushed, st.dirty_backlog,
+               st.flushes ? st.total_flush_us / 1000.0 / (double)st.flushes : 0.0,
+               st.max_flush_us / 1000.0);
+        cleanup_flusher();
+    } else {
+        printf("  journal: flusher start failed\n");
+    }
+
+    /* 存款后余额非0，清零后再销户 */
+    for (int i = 0; i < FLUSHER_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (load_account(uuids[i], &acc)) {
+            acc.BALANCE = 0;
+            save_account(&acc);
+        }
+        delete_account_file(uuids[i]);
+    }
+    free(uuids);
+    cleanup_account_system();
+}
+
+void register_flusher_benches(void)
+{
+    bench_register(bench_flusher_durability,
+                   "flusher: foreground latency by durability",
+                   "deposit latency with sync write-through vs journal + background flush");
+}
@@ -0,0 +1,109 @@
+#include "include/bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+static BenchEntry *g_benches = NULL;
+static size_t g_bench_count = 0;
+static size_t g_bench_cap = 0;
+
+static volatile unsigned long long g_sink = 0;
+
+void bench_register(BenchFunc func, const char *name, const char *detail)
+{
+    if (!func || !name) {
+        fprintf(stderr, "bench_register: invalid arguments\n");
+        exit(1);
+    }
+
+    if (g_bench_count == g_bench_cap) {
+        size_t new_cap = (g_bench_cap == 0) ? 8 : g_bench_cap * 2;
+        BenchEntry *new_buf = (BenchEntry *)realloc(g_benches, new_cap * sizeof(BenchEntry));
+        if (!new_buf) {
+            fprintf(stderr, "bench_register: out of memory\n");
+            exit(1);
+        }
+        g_benches = new_buf;
+        g_bench_cap = new_cap;
+    }
+
+    g_benches[g_bench_count].func = func;
+    g_benches[g_bench_count].name = name;
+    g_benches[g_bench_count].detail = detail ? detail : "";
+    g_bench_count++;
+}
+
+double bench_now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+void bench_consume(unsigned long long value)
+{
+    g_sink += value;
+}
+
+/**
+ * 用法: ./bench_runner [名称前缀]
+ * 不带参数时运行全部基准
+ */
+int main(int argc, char **argv)
+{
+    const char *filter = (argc > 1) ? argv[1] : NULL;
+
+    register_amount_benches();
+    register_threadpool_benches();
+    register_engine_benches();
+    register_shard_benches();
+    register_flusher_benches();
+    register_shm_store_benches();
+    register_snapshot_benches();
+    register_async_ops_benches();
+    register_replication_benches();
+    register_tiering_benches();
+    register_compact_store_benches();
+    register_disk_index_benches();
+    register_outbox_benches();
+    register_wire_benches();
+#ifdef ENABLE_NETWORK
+    register_server_api_benches();
+#endif
+
+    int ran = 0;
+    for (size_t i = 0; i < g_bench_count; i++) {
+        const BenchEntry *b = &g_benches[i];
+        if (filter && strncmp(b->name, filter, strlen(filter)) != 0) {
+            continue;
+        }
+
+        printf("\n====================\n");
+        printf("BENCH: %s\n", b->name);
+        if (b->detail[0] != '\0') {
+            printf("DETAIL: %s\n", b->detail);
+        }
+        printf("====================\n");
+        fflush(stdout);
+
+        b->func();
+        ran++;
+    }
+
+    printf("\nSUMMARY: ran=%d\n", ran);
+    free(g_benches);
+    return 0;
+}
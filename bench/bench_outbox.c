@@ -0,0 +1,193 @@
+#include "include/bench.h"
+
+#include <lib/outbox.h>
+#include <lib/platform.h>
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OUTBOX_BENCH_FILE "bench_outbox.log"
+#define OUTBOX_BENCH_OPS 2000
+
+static atomic_bool g_server_down;
+
+/* 模拟服务器往返：每次休眠1ms；服务器不可用时立即失败 */
+static ApiSendResult slow_send(const OutboxEntry *entry, const char *op_id)
+{
+    (void)entry;
+    (void)op_id;
+    if (atomic_load(&g_server_down)) {
+        return API_SEND_RETRY;
+    }
+    platform_sleep_ms(1);
+    return API_SEND_OK;
+}
+
+static void remove_bench_files(void)
+{
+    remove(OUTBOX_BENCH_FILE);
+    remove(OUTBOX_BENCH_FILE ".ack");
+}
+
+static void bench_config(OutboxConfig *config, bool fsync)
+{
+    load_outbox_config("/nonexistent/engine.conf", config);
+    snprintf(config->file, sizeof(config->file), "%s", OUTBOX_BENCH_FILE);
+    config->fsync = fsync;
+    config->retry_base_ms = 10;
+    config->retry_max_ms = 50;
+    config->drain_timeout_ms = 60000;
+}
+
+static void run_appends(const char *label, bool fsync, const char *uuid)
+{
+    remove_bench_files();
+    OutboxConfig config;
+    bench_config(&config, fsync);
+    atomic_store(&g_server_down, false);
+    if (!outbox_start(&config, slow_send)) {
+        printf("  %-22s outbox start failed\n", label);
+        return;
+    }
+
+    double t0 = bench_now();
+    for (int i = 0; i < OUTBOX_BENCH_OPS; i++) {
+        outbox_append(API_OP_DEPOSIT, uuid, NULL, 1);
+    }
+    double submitted = bench_now() - t0;
+    outbox_wait_drained(config.drain_timeout_ms);
+    double drained = bench_now() - t0;
+
+    printf("  %-22s append %6.1f us/op  (%d ops in %.1f ms, drained after %.0f ms)\n",
+           label, submitted * 1e6 / OUTBOX_BENCH_OPS, OUTBOX_BENCH_OPS, submitted * 1e3,
+           drained * 1e3);
+    cleanup_outbox();
+    remove_bench_files();
+}
+
+static void bench_outbox_latency(void)
+{
+    char uuid[37];
+    generate_uuid_string(uuid);
+
+    /* 阻塞调用方每笔都等一次往返，队列只等本地追加 */
+    printf("deposits with a simulated 1 ms server round trip\n");
+    double t0 = bench_now();
+    for (int i = 0; i < 200; i++) {
+        OutboxEntry e;
+        memset(&e, 0, sizeof(e));
+        bench_consume((unsigned long long)slow_send(&e, "x"));
+    }
+    printf("  %-22s wait   %6.1f us/op  (200 ops)\n", "blocking caller",
+           (bench_now() - t0) * 1e6 / 200);
+
+    run_appends("outbox, fsync=false", false, uuid);
+    run_appends("outbox, fsync=true", true, uuid);
+
+    /* 服务器中断 300ms：交易照常追加，恢复后按序补发 */
+    remove_bench_files();
+    OutboxConfig config;
+    bench_config(&config, false);
+    atomic_store(&g_server_down, true);
+    if (!outbox_start(&config, slow_send)) {
+        return;
+    }
+    t0 = bench_now();
+    for (int i = 0; i < 300; i++) {
+        outbox_append(API_OP_DEPOSIT, uuid, NULL, 1);
+        platform_sleep_ms(1);
+    }
+    OutboxStats st;
+    outbox_get_stats(&st);
+    size_t backlog = st.pending;
+    atomic_store(&g_server_down, false);
+    double recovered = bench_now();
+    outbox_wait_drained(config.drain_timeout_ms);
+    double drained = bench_now() - recovered;
+    outbox_get_stats(&st);
+    printf("  %-22s backlog %zu ops after %.0f ms outage, %llu retries, drained in %.0f ms\n",
+           "server outage", backlog, (recovered - t0) * 1e3, (unsigned long long)st.retries,
+           drained * 1e3);
+    cleanup_outbox();
+    remove_bench_files();
+}
+
+/* 突发负载：每轮在8个账户上快速追加100笔（约5%转账），两轮间隔20ms */
+#define COALESCE_BENCH_ACCOUNTS 8
+#define COALESCE_BENCH_BURSTS 20
+#define COALESCE_BENCH_BURST_OPS 100
+
+static void run_bursts(unsigned int coalesce_max, char uuids[][37], OutboxStats *st, double *seconds)
+{
+    remove_bench_files();
+    OutboxConfig config;
+    bench_config(&config, false);
+    config.coalesce_max = coalesce_max;
+    atomic_store(&g_server_down, false);
+    memset(st, 0, sizeof(*st));
+    *seconds = 0;
+    if (!outbox_start(&config, slow_send)) {
+        return;
+    }
+
+    unsigned int rng = 12345;
+    double t0 = bench_now();
+    for (int burst = 0; burst < COALESCE_BENCH_BURSTS; burst++) {
+        for (int i = 0; i < COALESCE_BENCH_BURST_OPS; i++) {
+            rng = rng * 1103515245u + 12345u;
+            unsigned int r = rng >> 8;
+            const char *uuid = uuids[r % COALESCE_BENCH_ACCOUNTS];
+            if (r % 100 < 5) {
+                outbox_append(API_OP_TRANSFER, uuid, uuids[(r + 1) % COALESCE_BENCH_ACCOUNTS], 1);
+            } else if (r % 100 < 35) {
+                outbox_append(API_OP_WITHDRAW, uuid, NULL, 1 + r % 50);
+            } else {
+                outbox_append(API_OP_DEPOSIT, uuid, NULL, 1 + r % 100);
+            }
+        }
+        platform_sleep_ms(20);
+    }
+    outbox_wait_drained(config.drain_timeout_ms);
+    *seconds = bench_now() - t0;
+    outbox_get_stats(st);
+    cleanup_outbox();
+    remove_bench_files();
+}
+
+static void bench_outbox_coalesce(void)
+{
+    char uuids[COALESCE_BENCH_ACCOUNTS][37];
+    for (int i = 0; i < COALESCE_BENCH_ACCOUNTS; i++) {
+        generate_uuid_string(uuids[i]);
+    }
+
+    printf("%d bursts x %d ops on %d accounts, simulated 1 ms server round trip\n",
+           COALESCE_BENCH_BURSTS, COALESCE_BENCH_BURST_OPS, COALESCE_BENCH_ACCOUNTS);
+    OutboxStats base;
+    double base_s;
+    run_bursts(1, uuids, &base, &base_s);
+    printf("  %-22s %5llu requests  drained after %.0f ms\n", "coalesce_max=1",
+           (unsigned long long)base.requests, base_s * 1e3);
+
+    OutboxStats st;
+    double s;
+    run_bursts(64, uuids, &st, &s);
+    uint64_t records = st.sent + st.rejected;
+    printf("  %-22s %5llu requests  drained after %.0f ms  ratio %.1f records/request  -%.0f%% requests\n",
+           "coalesce_max=64", (unsigned long long)st.requests, s * 1e3,
+           st.requests ? (double)records / (double)st.requests : 0.0,
+           base.requests ? 100.0 * (1.0 - (double)st.requests / (double)base.requests) : 0.0);
+}
+
+void register_outbox_benches(void)
+{
+    bench_register(bench_outbox_latency,
+                   "outbox: durable sync queue",
+                   "caller cost of a blocking round trip vs a queue append; backlog across an outage");
+
+    bench_register(bench_outbox_coalesce,
+                   "outbox: coalescing under bursts",
+                   "requests sent for a bursty deposit/withdraw workload with and without per-account merging");
+}
@@ -0,0 +1,176 @@
+#include "include/bench.h"
+
+#include <lib/replication.h>
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define REPL_BENCH_ACCOUNTS 64
+#define REPL_BENCH_OPS 2000
+
+/* 备节点进程：在独立目录跟随主节点，直到父进程关闭管道 */
+static int follower_process(const char *dir, const char *address, int stop_fd)
+{
+    cleanup_account_system();
+    if (mkdir(dir, 0700) != 0 || chdir(dir) != 0 || !init_account_system()) {
+        return 1;
+    }
+    ReplicationConfig config;
+    memset(&config, 0, sizeof(config));
+    config.role = REPLICATION_ROLE_FOLLOWER;
+    snprintf(config.address, sizeof(config.address), "%s", address);
+    if (!replication_start(&config)) {
+        return 2;
+    }
+
+    char c;
+    while (read(stop_fd, &c, 1) > 0) {
+    }
+    cleanup_replication();
+
+    ACCOUNT accounts[REPL_BENCH_ACCOUNTS];
+    size_t n = account_collect_all(accounts, REPL_BENCH_ACCOUNTS, NULL);
+    for (size_t i = 0; i < n; i++) {
+        account_apply_remove(accounts[i].UUID);
+    }
+    cleanup_account_system();
+    unlink("system.key");
+    rmdir("Card");
+    if (chdir("..") != 0) {
+        return 3;
+    }
+    rmdir(dir);
+    return 0;
+}
+
+static void run_mode(const char *label, const char *address, int role_ack, char (*uuids)[37])
+{
+    if (role_ack >= 0) {
+        ReplicationConfig config;
+        memset(&config, 0, sizeof(config));
+        config.role = REPLICATION_ROLE_PRIMARY;
+        snprintf(config.address, sizeof(config.address), "%s", address);
+        config.ack = (ReplicationAck)role_ack;
+        config.sync_timeout_ms = 2000;
+        config.backlog = 65536;
+        if (!replication_start(&config)) {
+            printf("  %-8s primary start failed\n", label);
+            return;
+        }
+        /* 等待备节点连上并完成全量同步 */
+        for (int waited = 0; waited < 5000; waited += 10) {
+            ReplicationStats st;
+            replication_get_stats(&st);
+            if (st.connected && st.acked_seq == st.last_seq) {
+                break;
+            }
+            platform_sleep_ms(10);
+        }
+    }
+
+    unsigned int rng = 0x9E3779B9u;
+    double t0 = bench_now();
+    for (int i = 0; i < REPL_BENCH_OPS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        AccountStatus st = engine_deposit(uuids[(rng >> 8) % REPL_BENCH_ACCOUNTS], 1, NULL);
+        bench_consume((unsigned long long)st);
+    }
+    double elapsed = bench_now() - t0;
+
+    if (role_ack >= 0) {
+        ReplicationStats st;
+        replication_get_stats(&st);
+        printf("  %-8s %8.1f us/op  lag after run=%llu ops  sync waits=%zu timeouts=%zu\n",
+               label, elapsed * 1e6 / REPL_BENCH_OPS, (unsigned long long)st.lag_ops,
+               st.sync_waits, st.sync_timeouts);
+        cleanup_replication();
+    } else {
+        printf("  %-8s %8.1f us/op\n", label, elapsed * 1e6 / REPL_BENCH_OPS);
+    }
+}
+
+static void bench_replication_commit_latency(void)
+{
+    if (!init_account_system()) {
+        printf("account system init failed\n");
+        return;
+    }
+
+    char dir[64];
+    char address[80];
+    snprintf(dir, sizeof(dir), "repl-bench-%ld", (long)getpid());
+    snprintf(address, sizeof(address), "unix:/tmp/bamsystem-repl-bench-%ld.sock", (long)getpid());
+
+    /* 先 fork 备节点，避免子进程继承复制线程与锁 */
+    int pipefd[2];
+    if (pipe(pipefd) != 0) {
+        printf("pipe failed\n");
+        return;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(pipefd[1]);
+        _exit(follower_process(dir, address, pipefd[0]));
+    }
+    close(pipefd[0]);
+
+    char (*uuids)[37] = malloc(REPL_BENCH_ACCOUNTS * sizeof(*uuids));
+    if (!uuids) {
+        printf("out of memory\n");
+        close(pipefd[1]);
+        waitpid(pid, NULL, 0);
+        return;
+    }
+    for (int i = 0; i < REPL_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1234567;
+        acc.BALANCE = 0;
+        save_account(&acc);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    printf("%d deposits over %d accounts, follower in a separate process over a Unix socket\n",
+           REPL_BENCH_OPS, REPL_BENCH_ACCOUNTS);
+    run_mode("none", address, -1, uuids);
+    run_mode("async", address, REPLICATION_ACK_ASYNC, uuids);
+    run_mode("sync", address, REPLICATION_ACK_SYNC, uuids);
+
+    close(pipefd[1]);
+    waitpid(pid, NULL, 0);
+
+    /* 存款后余额非0，清零后再销户 */
+    for (int i = 0; i < REPL_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (load_account(uuids[i], &acc)) {
+            acc.BALANCE = 0;
+            save_account(&acc);
+        }
+        delete_account_file(uuids[i]);
+    }
+    free(uuids);
+    cleanup_account_system();
+}
+
+void register_replication_benches(void)
+{
+    bench_register(bench_replication_commit_latency,
+                   "replication: commit latency",
+                   "per-op latency without replication vs async vs sync follower acknowledgement");
+}
+
+#else
+
+void register_replication_benches(void)
+{
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "include/bench.h"
+#include "../test/include/mock_server.h"
+
+#include <lib/account.h>
+#include <lib/server_api.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define API_BENCH_CONFIG "server.conf"
+#define API_BENCH_ACCOUNTS 2000
+#define API_BENCH_LATENCY_MS 2      /* 模拟服务器每个响应的处理时间 */
+#define API_BENCH_HANG_OPS 20
+
+/**
+ * @brief 按 extra 覆盖的配置重新初始化本模块并连上模拟服务器
+ */
+static bool api_connect(const char *extra)
+{
+    set_run_mode(MODE_LOCAL);
+    cleanup_server_api();
+    return mock_server_write_config(API_BENCH_CONFIG, extra) && init_server_api() &&
+           check_server_availability() == MODE_SERVER;
+}
+
+static void bench_server_api_push(void)
+{
+    static const struct {
+        const char *label;
+        const char *extra;
+    } cases[] = {
+        { "serial, 1 per request   ", "[sync]\nmax_in_flight=1\nbatch_size=1\ncompress=false\n" },
+        { "8 in flight, 1 per req  ", "[sync]\nmax_in_flight=8\nbatch_size=1\ncompress=false\n" },
+        { "8 in flight, 100 per req", "[sync]\nmax_in_flight=8\nbatch_size=100\ncompress=false\n" },
+        { "  + gzip bodies         ", "[sync]\nmax_in_flight=8\nbatch_size=100\ncompress=true\n" },
+    };
+
+    ACCOUNT *accounts = calloc(API_BENCH_ACCOUNTS, sizeof(ACCOUNT));
+    bool *ok = calloc(API_BENCH_ACCOUNTS, sizeof(bool));
+    if (accounts == NULL || ok == NULL || !mock_server_start(API_BENCH_LATENCY_MS)) {
+        printf("  mock server unavailable\n");
+        free(accounts);
+        free(ok);
+        return;
+    }
+    for (unsigned i = 0; i < API_BENCH_ACCOUNTS; i++) {
+        snprintf(accounts[i].UUID, sizeof(accounts[i].UUID), "00000000-0000-4000-8000-%012u", i);
+        accounts[i].BALANCE = (LLUINT)i * 100 + 7;
+    }
+
+    printf("push %d accounts, %d ms per response\n", API_BENCH_ACCOUNTS, API_BENCH_LATENCY_MS);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        if (!api_connect(cases[c].extra)) {
+            printf("  %s  connect failed\n", cases[c].label);
+            continue;
+        }
+        ServerApiStats before;
+        ServerApiStats after;
+        SyncBatchStats st;
+        server_api_get_stats(&before);
+        size_t synced = api_sync_accounts(accounts, API_BENCH_ACCOUNTS, ok, NULL, NULL, &st);
+        server_api_get_stats(&after);
+        printf("  %s  %8.1f ms  %5zu requests  %8llu bytes sent%s\n", cases[c].label,
+               st.elapsed_us / 1000.0, st.requests,
+               (unsigned long long)(after.bytes_sent - before.bytes_sent),
+               synced == API_BENCH_ACCOUNTS ? "" : "  INCOMPLETE");
+    }
+
+    set_run_mode(MODE_LOCAL);
+    cleanup_server_api();
+    mock_server_stop();
+    remove(API_BENCH_CONFIG);
+    free(accounts);
+    free(ok);
+}
+
+static void bench_server_api_hang(void)
+{
+    static const struct {
+        const char *label;
+        const char *extra;
+    } cases[] = {
+        { "fixed 2 s timeout, no breaker", "[server]\nadaptive_timeout=false\n[breaker]\nenabled=false\n" },
+        { "adaptive timeout + breaker   ", NULL },
+    };
+
+    if (!mock_server_start(API_BENCH_LATENCY_MS)) {
+        printf("  mock server unavailable\n");
+        return;
+    }
+    const char *uuid = "00000000-0000-4000-8000-000000000001";
+    printf("%d operations against a server that stopped responding\n", API_BENCH_HANG_OPS);
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        mock_server_set_mode(MOCK_OK);
+        if (!api_connect(cases[c].extra)) {
+            printf("  %s  connect failed\n", cases[c].label);
+            continue;
+        }
+        for (int i = 0; i < 25; i++) {
+            api_send_operation(API_OP_DEPOSIT, "warm", uuid, NULL, 100);
+        }
+
+        mock_server_set_mode(MOCK_HANG);
+        double t0 = bench_now();
+        int retry = 0;
+        for (int i = 0; i < API_BENCH_HANG_OPS; i++) {
+            retry += api_send_operation(API_OP_DEPOSIT, "hang", uuid, NULL, 100) == API_SEND_RETRY;
+        }
+        double elapsed = bench_now() - t0;
+        ServerApiStats stats;
+        server_api_get_stats(&stats);
+        printf("  %s  %8.1f ms  (%d retry, %llu rejected without a request)\n", cases[c].label,
+               elapsed * 1000.0, retry, (unsigned long long)stats.breaker.rejected);
+    }
+
+    set_run_mode(MODE_LOCAL);
+    cleanup_server_api();
+    mock_server_stop();
+    remove(API_BENCH_CONFIG);
+}
+
+void register_server_api_benches(void)
+{
+    bench_register(bench_server_api_push,
+                   "server_api: push against the mock server",
+                   "serial vs concurrent vs batched requests, and bytes sent with gzip bodies");
+
+    bench_register(bench_server_api_hang,
+                   "server_api: calls against a hung server",
+                   "time for a burst of operations with a fixed timeout vs adaptive timeout and breaker");
+}
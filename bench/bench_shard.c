@@ -0,0 +1,133 @@
+#include "include/bench.h"
+
+#include <lib/shard.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHARD_BENCH_ACCOUNTS 1024
+#define SHARD_BENCH_TOTAL_OPS 32000
+#define SHARD_BENCH_PRODUCERS 16
+#define SHARD_BENCH_TRANSFER_PCT 20   /* 其中转账占比（随机账户，多数跨分片） */
+
+typedef struct {
+    char (*uuids)[37];
+    int ops;
+    unsigned int seed;
+} ShardProducer;
+
+static void shard_producer_main(void *arg)
+{
+    ShardProducer *p = (ShardProducer *)arg;
+    unsigned int rng = p->seed;
+
+    for (int i = 0; i < p->ops; i++) {
+        rng = rng * 1103515245u + 12345u;
+        const char *a = p->uuids[(rng >> 8) % SHARD_BENCH_ACCOUNTS];
+        AccountStatus s;
+        if ((rng >> 4) % 100 < SHARD_BENCH_TRANSFER_PCT) {
+            rng = rng * 1103515245u + 12345u;
+            const char *b = p->uuids[(rng >> 8) % SHARD_BENCH_ACCOUNTS];
+            s = engine_transfer(a, b, 1, NULL, NULL);
+        } else {
+            s = engine_deposit(a, 1, NULL);
+        }
+        bench_consume((unsigned long long)s);
+    }
+}
+
+static double run_shards(char (*uuids)[37], size_t shards)
+{
+    EngineConfig config;
+    config.mode = ENGINE_MODE_SHARDED;
+    config.queue_capacity = 1024;
+    config.max_batch = 64;
+    config.shards = shards;
+    config.pin_threads = true;
+    if (!engine_start(&config)) {
+        return -1.0;
+    }
+
+    int per = SHARD_BENCH_TOTAL_OPS / SHARD_BENCH_PRODUCERS;
+    ShardProducer prod[SHARD_BENCH_PRODUCERS];
+    PlatformThread threads[SHARD_BENCH_PRODUCERS];
+
+    double t0 = bench_now();
+    for (int i = 0; i < SHARD_BENCH_PRODUCERS; i++) {
+        prod[i].uuids = uuids;
+        prod[i].ops = per;
+        prod[i].seed = 0x85EBCA6Bu * (unsigned int)(i + 1);
+        platform_thread_create(&threads[i], shard_producer_main, &prod[i]);
+    }
+    for (int i = 0; i < SHARD_BENCH_PRODUCERS; i++) {
+        platform_thread_join(threads[i]);
+    }
+    double elapsed = bench_now() - t0;
+
+    size_t committed = 0;
+    shard_get_transfer_stats(&committed, NULL);
+    size_t min_applied = (size_t)-1;
+    size_t max_applied = 0;
+    for (size_t i = 0; i < shards; i++) {
+        ShardStats st;
+        shard_get_stats(i, &st);
+        if (st.applied < min_applied) min_applied = st.applied;
+        if (st.applied > max_applied) max_applied = st.applied;
+    }
+    cleanup_engine();
+
+    double ops = (double)per * SHARD_BENCH_PRODUCERS;
+    printf("  shards=%-3zu %9.0f ops/s  cross_shard_commits=%zu  shard_ops min/max=%zu/%zu\n",
+           shards, ops / elapsed, committed, min_applied, max_applied);
+    return elapsed;
+}
+
+static void bench_shard_scaling(void)
+{
+    if (!init_account_system()) {
+        printf("account system init failed\n");
+        return;
+    }
+
+    char (*uuids)[37] = malloc(SHARD_BENCH_ACCOUNTS * sizeof(*uuids));
+    if (!uuids) {
+        printf("out of memory\n");
+        return;
+    }
+    for (int i = 0; i < SHARD_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1234567;
+        acc.BALANCE = 1000000;
+        save_account(&acc);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    int cpus = platform_cpu_count();
+    printf("cpu cores: %d  producers=%d  accounts=%d  ops/run=%d (%d%% transfers)\n",
+           cpus, SHARD_BENCH_PRODUCERS, SHARD_BENCH_ACCOUNTS, SHARD_BENCH_TOTAL_OPS,
+           SHARD_BENCH_TRANSFER_PCT);
+
+    size_t max_shards = (size_t)(cpus > 1 ? cpus : 2);
+    if (max_shards > 64) {
+        max_shards = 64;
+    }
+    for (size_t shards = 1; shards <= max_shards; shards *= 2) {
+        run_shards(uuids, shards);
+    }
+
+    for (int i = 0; i < SHARD_BENCH_ACCOUNTS; i++) {
+        delete_account_file(uuids[i]);
+    }
+    free(uuids);
+    cleanup_account_system();
+}
+
+void register_shard_benches(void)
+{
+    bench_register(bench_shard_scaling,
+                   "shard: throughput scaling",
+                   "16 producers, deposits + cross-shard transfers, 1..ncpu shards");
+}
@@ -0,0 +1,136 @@
+#include "include/bench.h"
+
+#include <lib/shm_store.h>
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SHM_BENCH_ACCOUNTS 1024
+#define SHM_BENCH_TOTAL_OPS 16000
+#define SHM_BENCH_TRANSFER_PCT 20
+
+static void shm_worker(char (*uuids)[37], int ops, unsigned int seed)
+{
+    unsigned int rng = seed;
+    for (int i = 0; i < ops; i++) {
+        rng = rng * 1103515245u + 12345u;
+        const char *a = uuids[(rng >> 8) % SHM_BENCH_ACCOUNTS];
+        AccountStatus s;
+        if ((rng >> 4) % 100 < SHM_BENCH_TRANSFER_PCT) {
+            rng = rng * 1103515245u + 12345u;
+            s = engine_transfer(a, uuids[(rng >> 8) % SHM_BENCH_ACCOUNTS], 1, NULL, NULL);
+        } else {
+            s = engine_deposit(a, 1, NULL);
+        }
+        bench_consume((unsigned long long)s);
+    }
+}
+
+static void run_processes(char (*uuids)[37], int procs)
+{
+    int per = SHM_BENCH_TOTAL_OPS / procs;
+    pid_t pids[16];
+
+    double t0 = bench_now();
+    for (int p = 0; p < procs; p++) {
+        pids[p] = fork();
+        if (pids[p] == 0) {
+            shm_worker(uuids, per, 0x85EBCA6Bu * (unsigned int)(p + 1));
+            _exit(0);
+        }
+    }
+    int failed = 0;
+    for (int p = 0; p < procs; p++) {
+        int status = 0;
+        if (pids[p] < 0 || waitpid(pids[p], &status, 0) != pids[p] || !WIFEXITED(status)) {
+            failed++;
+        }
+    }
+    double elapsed = bench_now() - t0;
+
+    printf("  processes=%-2d %9.0f ops/s  (%d ops each%s)\n",
+           procs, (double)per * procs / elapsed, per, failed ? ", some workers failed" : "");
+}
+
+static void bench_shm_store_processes(void)
+{
+    if (!init_account_system()) {
+        printf("account system init failed\n");
+        return;
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "/bamsystem-bench-%ld", (long)getpid());
+    ShmStoreConfig config;
+    config.enabled = true;
+    config.capacity = SHM_BENCH_ACCOUNTS * 4;
+    if (!shm_store_attach(&config, name)) {
+        printf("shm attach failed\n");
+        cleanup_account_system();
+        return;
+    }
+
+    /* fork 后子进程继承同一份UUID列表 */
+    char (*uuids)[37] = malloc(SHM_BENCH_ACCOUNTS * sizeof(*uuids));
+    if (!uuids) {
+        printf("out of memory\n");
+        shm_store_detach();
+        return;
+    }
+    for (int i = 0; i < SHM_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1234567;
+        acc.BALANCE = 1000000;
+        save_account(&acc);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    printf("accounts=%d  ops/run=%d (%d%% transfers), stripe locks=%d, write-through to .card\n",
+           SHM_BENCH_ACCOUNTS, SHM_BENCH_TOTAL_OPS, SHM_BENCH_TRANSFER_PCT, SHM_STORE_STRIPES);
+    run_processes(uuids, 1);
+    run_processes(uuids, 4);
+
+    LLUINT total = 0;
+    for (int i = 0; i < SHM_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (shm_store_get(uuids[i], &acc)) {
+            total += acc.BALANCE;
+        }
+    }
+    printf("  total balance after runs: %llu\n", (unsigned long long)total);
+
+    for (int i = 0; i < SHM_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (load_account(uuids[i], &acc)) {
+            acc.BALANCE = 0;
+            save_account(&acc);
+        }
+        delete_account_file(uuids[i]);
+    }
+    free(uuids);
+    shm_store_detach();
+    cleanup_account_system();
+}
+
+void register_shm_store_benches(void)
+{
+    bench_register(bench_shm_store_processes,
+                   "shm_store: multi-process throughput",
+                   "1 vs 4 forked processes sharing one account table via robust stripe locks");
+}
+
+#else
+
+void register_shm_store_benches(void)
+{
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "include/bench.h"
+
+#include <lib/threadpool.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SCALING_ITEMS 4000000
+#define SCALING_WORK 64
+
+typedef struct {
+    unsigned long long *out;
+} ScalingCtx;
+
+/* 纯计算负载：每个元素做若干轮整数混合 */
+static void scaling_kernel(size_t begin, size_t end, void *arg)
+{
+    ScalingCtx *ctx = (ScalingCtx *)arg;
+    for (size_t i = begin; i < end; i++) {
+        unsigned long long x = i + 1;
+        for (int k = 0; k < SCALING_WORK; k++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+        }
+        ctx->out[i] = x;
+    }
+}
+
+static double run_once(int threads, ScalingCtx *ctx)
+{
+    ThreadPool *pool = threadpool_create(threads);
+    if (!pool) {
+        return -1.0;
+    }
+
+    /* 预热，让所有线程进入工作循环 */
+    threadpool_parallel_for(pool, 0, SCALING_ITEMS / 16, 0, scaling_kernel, ctx);
+
+    double best = 1e30;
+    for (int r = 0; r < 3; r++) {
+        double t0 = bench_now();
+        threadpool_parallel_for(pool, 0, SCALING_ITEMS, 0, scaling_kernel, ctx);
+        double dt = bench_now() - t0;
+        if (dt < best) best = dt;
+    }
+
+    ThreadPoolStats stats;
+    threadpool_get_stats(pool, &stats);
+    printf("  threads=%-3d time=%8.2f ms  tasks=%zu stolen=%zu\n",
+           threads, best * 1e3, stats.executed, stats.stolen);
+
+    threadpool_destroy(pool);
+    return best;
+}
+
+static void bench_threadpool_scaling(void)
+{
+    ScalingCtx ctx;
+    ctx.out = (unsigned long long *)malloc(SCALING_ITEMS * sizeof(unsigned long long));
+    if (!ctx.out) {
+        printf("out of memory\n");
+        return;
+    }
+
+    int cpus = platform_cpu_count();
+    printf("cpu cores: %d\n", cpus);
+
+    /* 串行基线（不经过线程池；经函数指针调用，避免编译器为直接调用单独特化） */
+    RangeFunc volatile kernel = scaling_kernel;
+    double t0 = bench_now();
+    kernel(0, SCALING_ITEMS, &ctx);
+    double serial = bench_now() - t0;
+    printf("  serial     time=%8.2f ms\n", serial * 1e3);
+
+    int counts[16];
+    int n = 0;
+    for (int p = 1; p < cpus && n < 15; p *= 2) {
+        counts[n++] = p;
+    }
+    counts[n++] = cpus;
+
+    double t1 = 0.0;
+    printf("\n%-8s %10s %9s %11s\n", "threads", "time(ms)", "speedup", "efficiency");
+    double results[16];
+    for (int i = 0; i < n; i++) {
+        results[i] = run_once(counts[i], &ctx);
+        if (i == 0) t1 = results[i];
+    }
+    for (int i = 0; i < n; i++) {
+        double speedup = t1 / results[i];
+        printf("%-8d %10.2f %8.2fx %10.1f%%\n",
+               counts[i], results[i] * 1e3, speedup, 100.0 * speedup / counts[i]);
+    }
+
+    bench_consume(ctx.out[SCALING_ITEMS - 1]);
+    free(ctx.out);
+}
+
+void register_threadpool_benches(void)
+{
+    bench_register(bench_threadpool_scaling,
+                   "threadpool.scaling",
+                   "parallel_for efficiency from 1 to N cores on a CPU-bound kernel");
+}
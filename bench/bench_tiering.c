@@ -0,0 +1,106 @@
+#include "include/bench.h"
+
+#include <lib/tiering.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TIER_BENCH_ACCOUNTS 20000
+#define TIER_BENCH_LOOKUPS 200000
+#define TIER_BENCH_PROMOTIONS 500
+
+static double lookup_ns(char (*uuids)[37], bool cold)
+{
+    unsigned int rng = 0x9E3779B9u;
+    double t0 = bench_now();
+    for (int i = 0; i < TIER_BENCH_LOOKUPS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        const char *uuid = uuids[(rng >> 8) % TIER_BENCH_ACCOUNTS];
+        ACCOUNT acc;
+        bool found = cold ? tiering_cold_get(uuid, &acc) : load_account(uuid, &acc);
+        bench_consume(found ? acc.BALANCE : 0);
+    }
+    return (bench_now() - t0) * 1e9 / TIER_BENCH_LOOKUPS;
+}
+
+static void bench_tiering_tiers(void)
+{
+    if (!init_account_system()) {
+        printf("account system init failed\n");
+        return;
+    }
+
+    char (*uuids)[37] = malloc(TIER_BENCH_ACCOUNTS * sizeof(*uuids));
+    if (!uuids) {
+        printf("out of memory\n");
+        return;
+    }
+    for (int i = 0; i < TIER_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1000000 + (LLUINT)i;
+        acc.BALANCE = (LLUINT)i * 37;
+        save_account(&acc);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    TieringConfig config;
+    load_tiering_config("no-such-engine.conf", &config);
+    config.enabled = true;
+    config.scan_interval_seconds = 0;
+    if (!tiering_start(&config)) {
+        printf("tiering start failed\n");
+        free(uuids);
+        return;
+    }
+
+    printf("%d accounts, %d random lookups per tier\n", TIER_BENCH_ACCOUNTS, TIER_BENCH_LOOKUPS);
+    TieringStats st;
+    tiering_get_stats(&st);
+    double hot_ns = lookup_ns(uuids, false);
+    printf("  %-6s %8.1f ns/lookup  resident %8.1f KB (%5.1f B/account)\n", "hot",
+           hot_ns, st.hot_bytes / 1024.0, (double)st.hot_bytes / TIER_BENCH_ACCOUNTS);
+
+    double t0 = bench_now();
+    size_t demoted = tiering_demote_idle(0);
+    double demote_ms = (bench_now() - t0) * 1e3;
+
+    tiering_get_stats(&st);
+    double cold_ns = lookup_ns(uuids, true);
+    printf("  %-6s %8.1f ns/lookup  resident %8.1f KB (%5.1f B/account), segment file %.1f KB\n",
+           "cold", cold_ns, st.cold_bytes / 1024.0, (double)st.cold_bytes / TIER_BENCH_ACCOUNTS,
+           st.segment_file_bytes / 1024.0);
+    printf("  demoted %zu accounts in %.1f ms (hot left: %zu)\n", demoted, demote_ms, st.hot_count);
+
+    /* 提升包含重写 .card 文件 */
+    t0 = bench_now();
+    for (int i = 0; i < TIER_BENCH_PROMOTIONS; i++) {
+        ACCOUNT acc;
+        bench_consume(load_account(uuids[i], &acc) ? acc.BALANCE : 0);
+    }
+    printf("  promote via load_account(): %.1f us/account\n",
+           (bench_now() - t0) * 1e6 / TIER_BENCH_PROMOTIONS);
+
+    /* 提升其余账户后清理 */
+    for (int i = 0; i < TIER_BENCH_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (load_account(uuids[i], &acc)) {
+            acc.BALANCE = 0;
+            save_account(&acc);
+        }
+        delete_account_file(uuids[i]);
+    }
+    cleanup_tiering();
+    remove(config.segment_file);
+    free(uuids);
+    cleanup_account_system();
+}
+
+void register_tiering_benches(void)
+{
+    bench_register(bench_tiering_tiers,
+                   "tiering: hot vs cold tier",
+                   "resident memory and lookup latency of the hash table vs the packed cold segment");
+}
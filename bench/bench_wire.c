@@ -0,0 +1,169 @@
+#include "include/bench.h"
+
+#include <lib/wire.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WIRE_BENCH_ACCOUNTS 1000    /* 一个批量同步请求 / 一页账户列表 */
+#define WIRE_BENCH_ROUNDS 2000
+#define WIRE_BENCH_JSON_ROW 160     /* 一个 JSON 账户的最大长度 */
+
+/* 与客户端 JsonWriter 的批量同步请求体相同 */
+static size_t json_sync_batch(char *out, const ACCOUNT *accounts, size_t n, long long now)
+{
+    size_t len = (size_t)sprintf(out, "{\"accounts\":[");
+    for (size_t i = 0; i < n; i++) {
+        len += (size_t)sprintf(out + len, "%s{\"uuid\":\"%s\",\"balance\":%llu,\"timestamp\":%lld}",
+                               i ? "," : "", accounts[i].UUID, (unsigned long long)accounts[i].BALANCE, now);
+    }
+    len += (size_t)sprintf(out + len, "]}");
+    return len;
+}
+
+/* 与服务器 GET /api/accounts 的 JSON 响应相同 */
+static size_t json_accounts_page(char *out, const ACCOUNT *accounts, size_t n)
+{
+    size_t len = (size_t)sprintf(out, "{\"accounts\":[");
+    for (size_t i = 0; i < n; i++) {
+        len += (size_t)sprintf(out + len,
+                               "%s{\"uuid\":\"%s\",\"balance\":%llu,\"created_at\":\"2026-01-01T00:00:00Z\","
+                               "\"updated_at\":\"2026-10-17T08:00:00Z\"}",
+                               i ? "," : "", accounts[i].UUID, (unsigned long long)accounts[i].BALANCE);
+    }
+    len += (size_t)sprintf(out + len, "],\"count\":%zu,\"watermark\":1792224000,\"next_after\":\"%s\",\"success\":true}\n",
+                           n, accounts[n - 1].UUID);
+    return len;
+}
+
+static size_t wire_accounts_page(uint8_t *out, const ACCOUNT *accounts, size_t n)
+{
+    uint8_t *p = out;
+    for (size_t i = 0; i < n; i++) {
+        *p++ = WIRE_FRAME_ACCOUNT;
+        uuid_to_bytes(accounts[i].UUID, p);
+        for (int b = 0; b < 8; b++) {
+            p[WIRE_UUID_BYTES + b] = (uint8_t)(accounts[i].BALANCE >> (8 * b));
+        }
+        p += WIRE_UUID_BYTES + 8;
+    }
+    memset(p, 0, WIRE_END_FRAME_BYTES);
+    p[0] = WIRE_FRAME_END;
+    p[1] = 1;
+    uuid_to_bytes(accounts[n - 1].UUID, p + 10);
+    return (size_t)(p - out) + WIRE_END_FRAME_BYTES;
+}
+
+/* 不建树、只按键名扫描的 JSON 解码，作为 JSON 解析开销的下限 */
+static size_t json_scan_page(const char *json, ACCOUNT *accounts, size_t max)
+{
+    size_t n = 0;
+    const char *p = json;
+    while (n < max && (p = strstr(p, "\"uuid\":\"")) != NULL) {
+        p += 8;
+        memcpy(accounts[n].UUID, p, 36);
+        accounts[n].UUID[36] = '\0';
+        p = strstr(p, "\"balance\":");
+        if (p == NULL) {
+            break;
+        }
+        accounts[n].BALANCE = strtoull(p + 10, (char **)&p, 10);
+        n++;
+    }
+    return n;
+}
+
+static void bench_wire_codec(void)
+{
+    ACCOUNT *accounts = calloc(WIRE_BENCH_ACCOUNTS, sizeof(ACCOUNT));
+    ACCOUNT *decoded = calloc(WIRE_BENCH_ACCOUNTS, sizeof(ACCOUNT));
+    char *json = malloc(WIRE_BENCH_ACCOUNTS * WIRE_BENCH_JSON_ROW);
+    uint8_t *wire = malloc(wire_sync_batch_size(WIRE_BENCH_ACCOUNTS) + WIRE_END_FRAME_BYTES);
+    if (!accounts || !decoded || !json || !wire) {
+        printf("out of memory\n");
+        free(accounts);
+        free(decoded);
+        free(json);
+        free(wire);
+        return;
+    }
+    unsigned int rng = 12345u;
+    for (int i = 0; i < WIRE_BENCH_ACCOUNTS; i++) {
+        generate_uuid_string(accounts[i].UUID);
+        rng = rng * 1103515245u + 12345u;
+        accounts[i].BALANCE = (rng >> 8) % 50000000;
+    }
+
+    /* 单个操作请求 */
+    char op_id[48];
+    char op_json[256];
+    snprintf(op_id, sizeof(op_id), "%s-17", accounts[1].UUID);
+    int op_json_len = snprintf(op_json, sizeof(op_json),
+                               "{\"uuid\":\"%s\",\"amount\":%llu,\"op_id\":\"%s\",\"timestamp\":%d}",
+                               accounts[0].UUID, 12345ull, op_id, 1792224000);
+    size_t op_wire_len = wire_encode_op(wire, accounts[0].UUID, NULL, 12345, 1792224000, op_id);
+    printf("payload bytes               json    binary\n");
+    printf("  deposit request        %8d  %8zu\n", op_json_len, op_wire_len);
+    printf("  status response        %8d  %8d\n", (int)strlen("{\"success\":true,\"balance\":1234500,\"message\":\"存款成功\"}\n"),
+           WIRE_STATUS_FIXED_BYTES + (int)strlen("存款成功"));
+
+    size_t batch_json = json_sync_batch(json, accounts, WIRE_BENCH_ACCOUNTS, 1792224000);
+    size_t batch_wire = wire_encode_sync_batch(wire, accounts, WIRE_BENCH_ACCOUNTS, 1792224000);
+    printf("  sync batch x%d       %8zu  %8zu\n", WIRE_BENCH_ACCOUNTS, batch_json, batch_wire);
+    size_t page_json = json_accounts_page(json, accounts, WIRE_BENCH_ACCOUNTS);
+    size_t page_wire = wire_accounts_page(wire, accounts, WIRE_BENCH_ACCOUNTS);
+    printf("  accounts page x%d    %8zu  %8zu\n", WIRE_BENCH_ACCOUNTS, page_json, page_wire);
+
+    /* 批量同步请求编码 */
+    double t0 = bench_now();
+    for (int r = 0; r < WIRE_BENCH_ROUNDS; r++) {
+        bench_consume(json_sync_batch(json, accounts, WIRE_BENCH_ACCOUNTS, 1792224000 + r));
+    }
+    double json_enc = (bench_now() - t0) * 1e9 / WIRE_BENCH_ROUNDS / WIRE_BENCH_ACCOUNTS;
+    t0 = bench_now();
+    for (int r = 0; r < WIRE_BENCH_ROUNDS; r++) {
+        bench_consume(wire_encode_sync_batch(wire, accounts, WIRE_BENCH_ACCOUNTS, 1792224000 + r));
+    }
+    double wire_enc = (bench_now() - t0) * 1e9 / WIRE_BENCH_ROUNDS / WIRE_BENCH_ACCOUNTS;
+
+    /* 账户列表解码 */
+    json_accounts_page(json, accounts, WIRE_BENCH_ACCOUNTS);
+    t0 = bench_now();
+    for (int r = 0; r < WIRE_BENCH_ROUNDS; r++) {
+        bench_consume(json_scan_page(json, decoded, WIRE_BENCH_ACCOUNTS));
+    }
+    double json_dec = (bench_now() - t0) * 1e9 / WIRE_BENCH_ROUNDS / WIRE_BENCH_ACCOUNTS;
+    wire_accounts_page(wire, accounts, WIRE_BENCH_ACCOUNTS);
+    t0 = bench_now();
+    for (int r = 0; r < WIRE_BENCH_ROUNDS; r++) {
+        WireReader reader;
+        WirePageEnd end;
+        size_t n = 0;
+        wire_reader_init(&reader, wire, page_wire);
+        while (wire_read_frame(&reader, &decoded[n], &end) == WIRE_READ_ACCOUNT) {
+            n++;
+        }
+        bench_consume(n);
+    }
+    double wire_dec = (bench_now() - t0) * 1e9 / WIRE_BENCH_ROUNDS / WIRE_BENCH_ACCOUNTS;
+    bool same = memcmp(decoded[WIRE_BENCH_ACCOUNTS - 1].UUID, accounts[WIRE_BENCH_ACCOUNTS - 1].UUID, 37) == 0 &&
+                decoded[WIRE_BENCH_ACCOUNTS - 1].BALANCE == accounts[WIRE_BENCH_ACCOUNTS - 1].BALANCE;
+
+    printf("client CPU per account      json    binary\n");
+    printf("  encode sync record     %6.1f ns %6.1f ns\n", json_enc, wire_enc);
+    printf("  decode page record     %6.1f ns %6.1f ns  (json: key scan without a tree, a lower bound)%s\n",
+           json_dec, wire_dec, same ? "" : "  MISMATCH");
+
+    free(accounts);
+    free(decoded);
+    free(json);
+    free(wire);
+}
+
+void register_wire_benches(void)
+{
+    bench_register(bench_wire_codec,
+                   "wire: binary vs json encoding",
+                   "payload bytes per request shape and client CPU to encode a sync batch / decode an accounts page");
+}
@@ -0,0 +1,50 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*BenchFunc)(void);
+
+typedef struct BenchEntry {
+    BenchFunc func;
+    const char *name;
+    const char *detail;
+} BenchEntry;
+
+void bench_register(BenchFunc func, const char *name, const char *detail);
+
+/* 单调时钟（秒） */
+double bench_now(void);
+
+/* 防止编译器把被测结果优化掉 */
+void bench_consume(unsigned long long value);
+
+/* 各模块基准注册 */
+void register_amount_benches(void);
+void register_threadpool_benches(void);
+void register_engine_benches(void);
+void register_shard_benches(void);
+void register_flusher_benches(void);
+void register_shm_store_benches(void);
+void register_snapshot_benches(void);
+void register_async_ops_benches(void);
+void register_replication_benches(void);
+void register_tiering_benches(void);
+void register_compact_store_benches(void);
+void register_disk_index_benches(void);
+void register_outbox_benches(void);
+void register_wire_benches(void);
+#ifdef ENABLE_NETWORK
+void register_server_api_benches(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
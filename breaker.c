@@ -0,0 +1,262 @@
+/**
+ * @file breaker.c
+ * @brief 服务器请求熔断与自适应超时实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/breaker.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================== 内部辅助函数 ==================== */
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/**
+ * @brief 样本的 p99，样本不足 BREAKER_MIN_SAMPLES 时返回0
+ */
+static uint64_t samples_p99(const uint32_t *samples, size_t count)
+{
+    if (count < BREAKER_MIN_SAMPLES) {
+        return 0;
+    }
+    uint32_t sorted[BREAKER_LATENCY_SAMPLES];
+    memcpy(sorted, samples, count * sizeof(uint32_t));
+    qsort(sorted, count, sizeof(uint32_t), compare_u32);
+    size_t rank = (count * 99 + 99) / 100;
+    return sorted[rank - 1];
+}
+
+static void add_sample(uint32_t *samples, size_t *pos, size_t *count, uint64_t us)
+{
+    samples[*pos] = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+    *pos = (*pos + 1) % BREAKER_LATENCY_SAMPLES;
+    if (*count < BREAKER_LATENCY_SAMPLES) {
+        (*count)++;
+    }
+}
+
+/**
+ * @brief 按 p99 计算超时，限制在 [min_ms, cap_ms] 内；p99 为0（样本不足）时返回上限
+ */
+static uint64_t adaptive_timeout(uint64_t p99_us, uint64_t min_ms, uint64_t cap_ms)
+{
+    if (p99_us == 0) {
+        return cap_ms;
+    }
+    uint64_t ms = (p99_us * BREAKER_TIMEOUT_FACTOR + 999) / 1000;
+    if (ms < min_ms) {
+        ms = min_ms;
+    }
+    if (cap_ms > 0 && ms > cap_ms) {
+        ms = cap_ms;
+    }
+    return ms;
+}
+
+static void window_reset(CircuitBreaker *cb)
+{
+    cb->outcome_pos = 0;
+    cb->outcome_count = 0;
+    cb->failures = 0;
+}
+
+static void window_push(CircuitBreaker *cb, bool failed)
+{
+    if (cb->outcome_count == cb->config.window) {
+        cb->failures -= cb->outcomes[cb->outcome_pos];
+    } else {
+        cb->outcome_count++;
+    }
+    cb->outcomes[cb->outcome_pos] = failed ? 1 : 0;
+    cb->failures += failed ? 1 : 0;
+    cb->outcome_pos = (cb->outcome_pos + 1) % cb->config.window;
+}
+
+static void trip(CircuitBreaker *cb, uint64_t now_ns, uint64_t open_ms)
+{
+    cb->state = BREAKER_OPEN;
+    cb->open_ms = open_ms;
+    cb->open_until_ns = now_ns + open_ms * 1000000ull;
+    cb->probe_in_flight = false;
+    cb->opened++;
+}
+
+/* ==================== 生命周期 ==================== */
+
+void breaker_init(CircuitBreaker *cb, const BreakerConfig *config)
+{
+    memset(cb, 0, sizeof(*cb));
+    cb->config = *config;
+    if (cb->config.window == 0) {
+        cb->config.window = 1;
+    } else if (cb->config.window > BREAKER_MAX_WINDOW) {
+        cb->config.window = BREAKER_MAX_WINDOW;
+    }
+    if (cb->config.min_requests > cb->config.window) {
+        cb->config.min_requests = cb->config.window;
+    }
+    cb->state = BREAKER_CLOSED;
+    cb->open_ms = cb->config.open_ms;
+    platform_mutex_init(&cb->lock);
+}
+
+void breaker_destroy(CircuitBreaker *cb)
+{
+    platform_mutex_destroy(&cb->lock);
+}
+
+/* ==================== 熔断 ==================== */
+
+bool breaker_allow(CircuitBreaker *cb, uint64_t now_ns, bool *probe)
+{
+    *probe = false;
+    if (!cb->config.enabled) {
+        return true;
+    }
+    platform_mutex_lock(&cb->lock);
+    bool allow = true;
+    if (cb->state == BREAKER_OPEN && now_ns >= cb->open_until_ns) {
+        cb->state = BREAKER_HALF_OPEN;
+        cb->probe_in_flight = false;
+    }
+    if (cb->state == BREAKER_OPEN) {
+        allow = false;
+    } else if (cb->state == BREAKER_HALF_OPEN) {
+        allow = !cb->probe_in_flight;
+        cb->probe_in_flight = true;
+        *probe = allow;
+    }
+    if (!allow) {
+        cb->rejected++;
+    }
+    platform_mutex_unlock(&cb->lock);
+    return allow;
+}
+
+void breaker_record(CircuitBreaker *cb, bool probe, bool ok, uint64_t now_ns)
+{
+    platform_mutex_lock(&cb->lock);
+    switch (cb->state) {
+    case BREAKER_CLOSED:
+        window_push(cb, !ok);
+        if (cb->config.enabled && cb->outcome_count >= cb->config.min_requests &&
+            cb->failures * 100 >= cb->config.failure_percent * cb->outcome_count) {
+            trip(cb, now_ns, cb->config.open_ms);
+        }
+        break;
+    case BREAKER_HALF_OPEN:
+        /* 探测的结果：成功则闭合并重新计数，失败则断开更久；
+         * 断开前放行、此时才结束的请求不代表服务器已恢复，忽略 */
+        if (!probe) {
+            break;
+        }
+        if (ok) {
+            cb->state = BREAKER_CLOSED;
+            cb->probe_in_flight = false;
+            cb->open_ms = cb->config.open_ms;
+            window_reset(cb);
+        } else {
+            uint64_t open_ms = cb->open_ms * 2;
+            trip(cb, now_ns, open_ms < BREAKER_MAX_OPEN_MS ? open_ms : BREAKER_MAX_OPEN_MS);
+        }
+        break;
+    default:
+        /* 断开前放行、断开后才结束的请求，不影响状态 */
+        break;
+    }
+    platform_mutex_unlock(&cb->lock);
+}
+
+void breaker_cancel(CircuitBreaker *cb, bool probe)
+{
+    if (!probe) {
+        return;
+    }
+    platform_mutex_lock(&cb->lock);
+    if (cb->state == BREAKER_HALF_OPEN) {
+        cb->probe_in_flight = false;
+    }
+    platform_mutex_unlock(&cb->lock);
+}
+
+/* ==================== 自适应超时 ==================== */
+
+void breaker_observe(CircuitBreaker *cb, uint64_t total_us, uint64_t connect_us)
+{
+    if (total_us == 0 && connect_us == 0) {
+        return;
+    }
+    platform_mutex_lock(&cb->lock);
+    if (total_us > 0) {
+        add_sample(cb->latency_us, &cb->latency_pos, &cb->latency_count, total_us);
+        cb->latency_p99_us = samples_p99(cb->latency_us, cb->latency_count);
+    }
+    if (connect_us > 0) {
+        add_sample(cb->connect_us, &cb->connect_pos, &cb->connect_count, connect_us);
+        cb->connect_p99_us = samples_p99(cb->connect_us, cb->connect_count);
+    }
+    platform_mutex_unlock(&cb->lock);
+}
+
+/**
+ * @brief 计算当前超时（须持有 lock）；探测请求与关闭自适应时使用上限
+ */
+static void current_timeouts(CircuitBreaker *cb, uint64_t *timeout_ms, uint64_t *connect_timeout_ms)
+{
+    const BreakerConfig *c = &cb->config;
+    if (!c->adaptive || cb->state != BREAKER_CLOSED) {
+        *timeout_ms = c->timeout_ms;
+        *connect_timeout_ms = c->connect_timeout_ms;
+        return;
+    }
+    *timeout_ms = adaptive_timeout(cb->latency_p99_us, c->min_timeout_ms, c->timeout_ms);
+    *connect_timeout_ms = adaptive_timeout(cb->connect_p99_us, c->min_timeout_ms,
+                                           c->connect_timeout_ms);
+}
+
+void breaker_timeouts(CircuitBreaker *cb, uint64_t *timeout_ms, uint64_t *connect_timeout_ms)
+{
+    platform_mutex_lock(&cb->lock);
+    current_timeouts(cb, timeout_ms, connect_timeout_ms);
+    platform_mutex_unlock(&cb->lock);
+}
+
+/* ==================== 统计 ==================== */
+
+void breaker_get_stats(CircuitBreaker *cb, uint64_t now_ns, BreakerStats *stats)
+{
+    platform_mutex_lock(&cb->lock);
+    stats->state = cb->state;
+    stats->window_requests = cb->outcome_count;
+    stats->window_failures = cb->failures;
+    stats->rejected = cb->rejected;
+    stats->opened = cb->opened;
+    stats->retry_in_ms = cb->state == BREAKER_OPEN && cb->open_until_ns > now_ns
+                         ? (cb->open_until_ns - now_ns + 999999) / 1000000 : 0;
+    current_timeouts(cb, &stats->timeout_ms, &stats->connect_timeout_ms);
+    stats->latency_p99_us = cb->latency_p99_us;
+    stats->connect_p99_us = cb->connect_p99_us;
+    platform_mutex_unlock(&cb->lock);
+}
+
+const char* breaker_state_string(BreakerState state)
+{
+    switch (state) {
+    case BREAKER_CLOSED:
+        return "闭合";
+    case BREAKER_OPEN:
+        return "断开";
+    case BREAKER_HALF_OPEN:
+        return "半开";
+    default:
+        return "未知";
+    }
+}
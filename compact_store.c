@@ -0,0 +1,878 @@
+/**
+ * @file compact_store.c
+ * @brief 紧凑内存账户表实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/compact_store.h>
+#include <lib/account.h>
+#include <lib/engine.h>
+#include <lib/platform.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================== 常量配置 ==================== */
+
+#define COMPACT_KEY_BYTES 16
+#define COMPACT_DEFAULT_BLOCK_SIZE 32
+#define COMPACT_MAX_BLOCK_SIZE 4096
+#define COMPACT_DEFAULT_MERGE_THRESHOLD 4096
+#define COMPACT_ENTRY_MAX (1 + COMPACT_KEY_BYTES + 10 + 10)  /* 前缀长度 + 后缀 + 两个 varint */
+
+/* ==================== 内部结构 ==================== */
+
+/**
+ * @brief 紧凑表
+ *
+ * 块编码：varint(条数) varint(余额基准) 之后逐条：
+ *   uint8 共享前缀长度 p，16-p 字节后缀，varint(密码)，varint(余额 - 基准)
+ * 第一条的 p 固定为0。
+ */
+struct CompactStore {
+    PlatformMutex lock;
+    size_t block_size;
+    size_t merge_threshold;
+
+    uint8_t *data;                /* 基础块 */
+    size_t data_bytes;
+    uint8_t (*index_keys)[COMPACT_KEY_BYTES];  /* 每块首个 UUID */
+    size_t *index_offsets;        /* 每块在 data 中的偏移 */
+    size_t blocks;
+    size_t base_count;
+
+    AccountHashTable delta;       /* 写入 */
+    AccountHashTable deleted;     /* 基础块中已删除的账户（只用 UUID） */
+    size_t sticky;                /* delta 中无法归并的非规范 UUID 数 */
+    size_t count;
+
+    size_t merges;
+    uint64_t last_merge_us;
+};
+
+/**
+ * @brief 解码中的一条记录
+ */
+typedef struct {
+    uint8_t key[COMPACT_KEY_BYTES];
+    LLUINT password;
+    LLUINT balance;
+} CompactEntry;
+
+/* ==================== 编码 ==================== */
+
+static size_t varint_put(uint8_t *out, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static const uint8_t* varint_get(const uint8_t *p, uint64_t *v)
+{
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b = *p++;
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            break;
+        }
+    }
+    *v = result;
+    return p;
+}
+
+/**
+ * @brief 块解码游标
+ */
+typedef struct {
+    const uint8_t *p;
+    size_t remaining;
+    LLUINT base;
+    CompactEntry entry;
+} BlockCursor;
+
+static void cursor_open(BlockCursor *cur, const uint8_t *block)
+{
+    uint64_t count;
+    uint64_t base;
+    const uint8_t *p = varint_get(block, &count);
+    p = varint_get(p, &base);
+    cur->p = p;
+    cur->remaining = (size_t)count;
+    cur->base = (LLUINT)base;
+    memset(cur->entry.key, 0, COMPACT_KEY_BYTES);
+}
+
+/**
+ * @brief 解码下一条，块内已无记录返回false
+ */
+static bool cursor_next(BlockCursor *cur)
+{
+    if (cur->remaining == 0) {
+        return false;
+    }
+    cur->remaining--;
+
+    const uint8_t *p = cur->p;
+    size_t shared = *p++;
+    memcpy(cur->entry.key + shared, p, COMPACT_KEY_BYTES - shared);
+    p += COMPACT_KEY_BYTES - shared;
+
+    uint64_t password;
+    uint64_t delta;
+    p = varint_get(p, &password);
+    p = varint_get(p, &delta);
+    cur->entry.password = (LLUINT)password;
+    cur->entry.balance = cur->base + (LLUINT)delta;
+    cur->p = p;
+    return true;
+}
+
+/**
+ * @brief 构建基础块
+ */
+typedef struct {
+    size_t block_size;
+    uint8_t *data;
+    size_t data_bytes;
+    size_t data_capacity;
+    uint8_t (*index_keys)[COMPACT_KEY_BYTES];
+    size_t *index_offsets;
+    size_t blocks;
+    size_t index_capacity;
+    size_t count;
+    CompactEntry *pending;        /* 当前块 */
+    size_t pending_count;
+    bool failed;
+} BlockBuilder;
+
+static bool builder_init(BlockBuilder *b, size_t block_size)
+{
+    memset(b, 0, sizeof(*b));
+    b->block_size = block_size;
+    b->pending = malloc(block_size * sizeof(CompactEntry));
+    return b->pending != NULL;
+}
+
+static bool builder_reserve(BlockBuilder *b, size_t bytes)
+{
+    if (b->data_bytes + bytes <= b->data_capacity) {
+        return true;
+    }
+    size_t capacity = b->data_capacity ? b->data_capacity : 4096;
+    while (capacity < b->data_bytes + bytes) {
+        capacity *= 2;
+    }
+    uint8_t *grown = realloc(b->data, capacity);
+    if (grown == NULL) {
+        return false;
+    }
+    b->data = grown;
+    b->data_capacity = capacity;
+    return true;
+}
+
+static void builder_flush_block(BlockBuilder *b)
+{
+    if (b->failed) {
+        b->pending_count = 0;
+    }
+    if (b->pending_count == 0) {
+        return;
+    }
+
+    if (b->blocks == b->index_capacity) {
+        size_t capacity = b->index_capacity ? b->index_capacity * 2 : 64;
+        uint8_t (*keys)[COMPACT_KEY_BYTES] = realloc(b->index_keys, capacity * sizeof(*keys));
+        if (keys != NULL) {
+            b->index_keys = keys;
+        }
+        size_t *offsets = realloc(b->index_offsets, capacity * sizeof(size_t));
+        if (offsets != NULL) {
+            b->index_offsets = offsets;
+        }
+        if (keys == NULL || offsets == NULL) {
+            b->failed = true;
+            b->pending_count = 0;
+            return;
+        }
+        b->index_capacity = capacity;
+    }
+    if (!builder_reserve(b, 20 + b->pending_count * COMPACT_ENTRY_MAX)) {
+        b->failed = true;
+        b->pending_count = 0;
+        return;
+    }
+
+    /* 余额以块内最小值为基准 */
+    LLUINT base = b->pending[0].balance;
+    for (size_t i = 1; i < b->pending_count; i++) {
+        if (b->pending[i].balance < base) {
+            base = b->pending[i].balance;
+        }
+    }
+
+    memcpy(b->index_keys[b->blocks], b->pending[0].key, COMPACT_KEY_BYTES);
+    b->index_offsets[b->blocks] = b->data_bytes;
+    b->blocks++;
+
+    uint8_t *p = b->data + b->data_bytes;
+    p += varint_put(p, b->pending_count);
+    p += varint_put(p, base);
+    for (size_t i = 0; i < b->pending_count; i++) {
+        size_t shared = 0;
+        if (i > 0) {
+            while (shared < COMPACT_KEY_BYTES - 1 &&
+                   b->pending[i].key[shared] == b->pending[i - 1].key[shared]) {
+                shared++;
+            }
+        }
+        *p++ = (uint8_t)shared;
+        memcpy(p, b->pending[i].key + shared, COMPACT_KEY_BYTES - shared);
+        p += COMPACT_KEY_BYTES - shared;
+        p += varint_put(p, b->pending[i].password);
+        p += varint_put(p, b->pending[i].balance - base);
+    }
+    b->data_bytes = (size_t)(p - b->data);
+    b->count += b->pending_count;
+    b->pending_count = 0;
+}
+
+static void builder_add(BlockBuilder *b, const CompactEntry *e)
+{
+    b->pending[b->pending_count++] = *e;
+    if (b->pending_count == b->block_size) {
+        builder_flush_block(b);
+    }
+}
+
+static void builder_free(BlockBuilder *b)
+{
+    free(b->data);
+    free(b->index_keys);
+    free(b->index_offsets);
+    free(b->pending);
+    memset(b, 0, sizeof(*b));
+}
+
+/**
+ * @brief 用构建结果替换基础块（须持锁）
+ */
+static bool store_install(CompactStore *store, BlockBuilder *b)
+{
+    builder_flush_block(b);
+    if (b->failed) {
+        builder_free(b);
+        return false;
+    }
+
+    uint8_t *shrunk = realloc(b->data, b->data_bytes ? b->data_bytes : 1);
+    if (shrunk != NULL) {
+        b->data = shrunk;
+    }
+    if (b->blocks > 0 && b->blocks < b->index_capacity) {
+        uint8_t (*keys)[COMPACT_KEY_BYTES] = realloc(b->index_keys, b->blocks * sizeof(*keys));
+        if (keys != NULL) {
+            b->index_keys = keys;
+        }
+        size_t *offsets = realloc(b->index_offsets, b->blocks * sizeof(size_t));
+        if (offsets != NULL) {
+            b->index_offsets = offsets;
+        }
+    }
+
+    free(store->data);
+    free(store->index_keys);
+    free(store->index_offsets);
+    store->data = b->data;
+    store->data_bytes = b->data_bytes;
+    store->index_keys = b->index_keys;
+    store->index_offsets = b->index_offsets;
+    store->blocks = b->blocks;
+    store->base_count = b->count;
+
+    free(b->pending);
+    memset(b, 0, sizeof(*b));
+    return true;
+}
+
+/* ==================== 查找 ==================== */
+
+/**
+ * @brief 在基础块中查找（须持锁）
+ */
+static bool base_find(const CompactStore *store, const uint8_t key[COMPACT_KEY_BYTES], CompactEntry *out)
+{
+    if (store->blocks == 0) {
+        return false;
+    }
+
+    /* 找最后一个首键 <= key 的块 */
+    size_t lo = 0;
+    size_t hi = store->blocks;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (memcmp(store->index_keys[mid], key, COMPACT_KEY_BYTES) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return false;
+    }
+
+    /* 只重建键，值的 varint 直接跳过，命中时再解码 */
+    BlockCursor cur;
+    cursor_open(&cur, store->data + store->index_offsets[lo - 1]);
+    const uint8_t *p = cur.p;
+    for (size_t i = 0; i < cur.remaining; i++) {
+        size_t shared = *p++;
+        memcpy(cur.entry.key + shared, p, COMPACT_KEY_BYTES - shared);
+        p += COMPACT_KEY_BYTES - shared;
+
+        int c = memcmp(cur.entry.key, key, COMPACT_KEY_BYTES);
+        if (c == 0) {
+            uint64_t password;
+            uint64_t delta;
+            p = varint_get(p, &password);
+            varint_get(p, &delta);
+            memcpy(out->key, key, COMPACT_KEY_BYTES);
+            out->password = (LLUINT)password;
+            out->balance = cur.base + (LLUINT)delta;
+            return true;
+        }
+        if (c > 0) {
+            break;
+        }
+        while (*p++ & 0x80) {
+        }
+        while (*p++ & 0x80) {
+        }
+    }
+    return false;
+}
+
+static void entry_to_account(const CompactEntry *e, ACCOUNT *acc)
+{
+    uuid_from_bytes(e->key, acc->UUID);
+    acc->PASSWORD = e->password;
+    acc->BALANCE = e->balance;
+}
+
+/**
+ * @brief 查找账户（须持锁）
+ */
+static bool store_get_locked(CompactStore *store, const char *uuid, ACCOUNT *out)
+{
+    ACCOUNT *acc = (store->delta.count > 0) ? account_table_find(&store->delta, uuid) : NULL;
+    if (acc != NULL) {
+        *out = *acc;
+        return true;
+    }
+    if (store->deleted.count > 0 && account_table_find(&store->deleted, uuid) != NULL) {
+        return false;
+    }
+
+    uint8_t key[COMPACT_KEY_BYTES];
+    CompactEntry e;
+    if (!uuid_to_bytes(uuid, key) || !base_find(store, key, &e)) {
+        return false;
+    }
+    entry_to_account(&e, out);
+    return true;
+}
+
+/* ==================== 归并 ==================== */
+
+static int cmp_account_uuid(const void *a, const void *b)
+{
+    return strcmp(((const ACCOUNT *)a)->UUID, ((const ACCOUNT *)b)->UUID);
+}
+
+/**
+ * @brief 清空一张表但保留桶数组，避免每次归并后重新扩容
+ */
+static void table_clear(AccountHashTable *table)
+{
+    for (size_t i = 0; i < table->size; i++) {
+        AccountNode *node = table->buckets[i];
+        while (node != NULL) {
+            AccountNode *next = node->next;
+            free(node);
+            node = next;
+        }
+        table->buckets[i] = NULL;
+    }
+    table->count = 0;
+}
+
+static int cmp_entry_key(const void *a, const void *b)
+{
+    return memcmp(((const CompactEntry *)a)->key, ((const CompactEntry *)b)->key, COMPACT_KEY_BYTES);
+}
+
+/**
+ * @brief 增量表归并进基础块（须持锁）
+ */
+static bool store_merge_locked(CompactStore *store)
+{
+    size_t pending = store->delta.count - store->sticky + store->deleted.count;
+    if (pending == 0) {
+        return true;
+    }
+
+    uint64_t t0 = platform_monotonic_ns();
+
+    /* 取出可归并的写入并排序 */
+    size_t n = store->delta.count - store->sticky;
+    CompactEntry *puts = malloc((n ? n : 1) * sizeof(CompactEntry));
+    if (puts == NULL) {
+        return false;
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < store->delta.size; i++) {
+        for (AccountNode *node = store->delta.buckets[i]; node != NULL; node = node->next) {
+            if (k < n && uuid_to_bytes(node->account.UUID, puts[k].key)) {
+                puts[k].password = node->account.PASSWORD;
+                puts[k].balance = node->account.BALANCE;
+                k++;
+            }
+        }
+    }
+    qsort(puts, k, sizeof(CompactEntry), cmp_entry_key);
+
+    BlockBuilder b;
+    if (!builder_init(&b, store->block_size)) {
+        free(puts);
+        return false;
+    }
+
+    size_t j = 0;
+    for (size_t blk = 0; blk < store->blocks; blk++) {
+        BlockCursor cur;
+        cursor_open(&cur, store->data + store->index_offsets[blk]);
+        while (cursor_next(&cur)) {
+            while (j < k && memcmp(puts[j].key, cur.entry.key, COMPACT_KEY_BYTES) < 0) {
+                builder_add(&b, &puts[j++]);
+            }
+            if (j < k && memcmp(puts[j].key, cur.entry.key, COMPACT_KEY_BYTES) == 0) {
+                builder_add(&b, &puts[j++]);
+                continue;
+            }
+            if (store->deleted.count > 0) {
+                char uuid[37];
+                uuid_from_bytes(cur.entry.key, uuid);
+                if (account_table_find(&store->deleted, uuid) != NULL) {
+                    continue;
+                }
+            }
+            builder_add(&b, &cur.entry);
+        }
+    }
+    while (j < k) {
+        builder_add(&b, &puts[j++]);
+    }
+
+    bool ok = store_install(store, &b);
+    if (ok) {
+        /* 非规范 UUID 留在增量表中 */
+        if (store->sticky == 0) {
+            table_clear(&store->delta);
+        } else {
+            for (size_t i = 0; i < k; i++) {
+                char uuid[37];
+                uuid_from_bytes(puts[i].key, uuid);
+                account_table_delete(&store->delta, uuid);
+            }
+        }
+        table_clear(&store->deleted);
+        store->merges++;
+        store->last_merge_us = (platform_monotonic_ns() - t0) / 1000;
+    }
+    free(puts);
+    return ok;
+}
+
+static void store_maybe_merge(CompactStore *store)
+{
+    if (store->delta.count - store->sticky + store->deleted.count >= store->merge_threshold) {
+        store_merge_locked(store);
+    }
+}
+
+/* ==================== 紧凑表接口 ==================== */
+
+CompactStore* compact_store_create(size_t block_size, size_t merge_threshold)
+{
+    CompactStore *store = calloc(1, sizeof(CompactStore));
+    if (store == NULL) {
+        return NULL;
+    }
+    if (!account_table_init(&store->delta)) {
+        free(store);
+        return NULL;
+    }
+    if (!account_table_init(&store->deleted)) {
+        account_table_cleanup(&store->delta);
+        free(store);
+        return NULL;
+    }
+
+    if (block_size == 0 || block_size > COMPACT_MAX_BLOCK_SIZE) {
+        block_size = COMPACT_DEFAULT_BLOCK_SIZE;
+    }
+    store->block_size = block_size;
+    store->merge_threshold = merge_threshold ? merge_threshold : COMPACT_DEFAULT_MERGE_THRESHOLD;
+    platform_mutex_init(&store->lock);
+    return store;
+}
+
+void compact_store_destroy(CompactStore *store)
+{
+    if (store == NULL) {
+        return;
+    }
+    platform_mutex_destroy(&store->lock);
+    account_table_cleanup(&store->deleted);
+    account_table_cleanup(&store->delta);
+    free(store->data);
+    free(store->index_keys);
+    free(store->index_offsets);
+    free(store);
+}
+
+bool compact_store_build(CompactStore *store, ACCOUNT *accounts, size_t count)
+{
+    qsort(accounts, count, sizeof(ACCOUNT), cmp_account_uuid);
+
+    BlockBuilder b;
+    if (!builder_init(&b, store->block_size)) {
+        return false;
+    }
+
+    platform_mutex_lock(&store->lock);
+    table_clear(&store->delta);
+    table_clear(&store->deleted);
+    bool ok = true;
+    store->sticky = 0;
+    store->count = 0;
+
+    for (size_t i = 0; ok && i < count; i++) {
+        if (i > 0 && strcmp(accounts[i].UUID, accounts[i - 1].UUID) == 0) {
+            continue;
+        }
+        CompactEntry e;
+        if (uuid_to_bytes(accounts[i].UUID, e.key)) {
+            e.password = accounts[i].PASSWORD;
+            e.balance = accounts[i].BALANCE;
+            builder_add(&b, &e);
+        } else {
+            ok = account_table_insert(&store->delta, &accounts[i]);
+            store->sticky++;
+        }
+        store->count++;
+    }
+    ok = ok && store_install(store, &b);
+    if (!ok) {
+        builder_free(&b);
+    }
+    platform_mutex_unlock(&store->lock);
+    return ok;
+}
+
+bool compact_store_get(CompactStore *store, const char *uuid, ACCOUNT *out)
+{
+    platform_mutex_lock(&store->lock);
+    bool found = store_get_locked(store, uuid, out);
+    platform_mutex_unlock(&store->lock);
+    return found;
+}
+
+bool compact_store_put(CompactStore *store, const ACCOUNT *acc)
+{
+    uint8_t key[COMPACT_KEY_BYTES];
+    bool mergeable = uuid_to_bytes(acc->UUID, key);
+
+    platform_mutex_lock(&store->lock);
+    ACCOUNT existing;
+    bool in_delta = account_table_find(&store->delta, acc->UUID) != NULL;
+    bool exists = in_delta || store_get_locked(store, acc->UUID, &existing);
+
+    bool ok = account_table_insert(&store->delta, acc);
+    if (ok) {
+        account_table_delete(&store->deleted, acc->UUID);
+        if (!in_delta && !mergeable) {
+            store->sticky++;
+        }
+        if (!exists) {
+            store->count++;
+        }
+        store_maybe_merge(store);
+    }
+    platform_mutex_unlock(&store->lock);
+    return ok;
+}
+
+bool compact_store_remove(CompactStore *store, const char *uuid)
+{
+    uint8_t key[COMPACT_KEY_BYTES];
+    bool mergeable = uuid_to_bytes(uuid, key);
+
+    platform_mutex_lock(&store->lock);
+    bool found = false;
+    if (account_table_delete(&store->delta, uuid)) {
+        found = true;
+        if (!mergeable) {
+            store->sticky--;
+        }
+    }
+
+    /* 基础块中的账户记删除标记，归并时剔除 */
+    CompactEntry e;
+    if (mergeable && account_table_find(&store->deleted, uuid) == NULL && base_find(store, key, &e)) {
+        ACCOUNT tomb;
+        memset(&tomb, 0, sizeof(tomb));
+        memcpy(tomb.UUID, uuid, 36);
+        account_table_insert(&store->deleted, &tomb);
+        found = true;
+    }
+
+    if (found) {
+        store->count--;
+        store_maybe_merge(store);
+    }
+    platform_mutex_unlock(&store->lock);
+    return found;
+}
+
+bool compact_store_merge(CompactStore *store)
+{
+    platform_mutex_lock(&store->lock);
+    bool ok = store_merge_locked(store);
+    platform_mutex_unlock(&store->lock);
+    return ok;
+}
+
+size_t compact_store_collect(CompactStore *store, ACCOUNT *out, size_t max_count)
+{
+    platform_mutex_lock(&store->lock);
+
+    /* 先归并，基础块即为完整的有序结果 */
+    store_merge_locked(store);
+
+    size_t n = 0;
+    for (size_t blk = 0; blk < store->blocks && n < max_count; blk++) {
+        BlockCursor cur;
+        cursor_open(&cur, store->data + store->index_offsets[blk]);
+        while (n < max_count && cursor_next(&cur)) {
+            entry_to_account(&cur.entry, &out[n++]);
+        }
+    }
+    for (size_t i = 0; i < store->delta.size && n < max_count; i++) {
+        for (AccountNode *node = store->delta.buckets[i]; node != NULL && n < max_count; node = node->next) {
+            out[n++] = node->account;
+        }
+    }
+
+    platform_mutex_unlock(&store->lock);
+    return n;
+}
+
+void compact_store_get_stats(CompactStore *store, CompactStoreStats *stats)
+{
+    platform_mutex_lock(&store->lock);
+    stats->count = store->count;
+    stats->base_count = store->base_count;
+    stats->blocks = store->blocks;
+    stats->base_bytes = store->data_bytes;
+    stats->index_bytes = store->blocks * (COMPACT_KEY_BYTES + sizeof(size_t));
+    stats->delta_count = store->delta.count;
+    stats->deleted_count = store->deleted.count;
+    stats->delta_bytes = (store->delta.count + store->deleted.count) * sizeof(AccountNode) +
+                         (store->delta.size + store->deleted.size) * sizeof(AccountNode *);
+    stats->merges = store->merges;
+    stats->last_merge_us = store->last_merge_us;
+    platform_mutex_unlock(&store->lock);
+}
+
+size_t compact_store_memory_bytes(const CompactStoreStats *stats)
+{
+    return stats->base_bytes + stats->index_bytes + stats->delta_bytes;
+}
+
+/* ==================== 全局账户表 ==================== */
+
+static CompactStore *g_compact = NULL;
+static atomic_bool g_compact_active = false;
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取紧凑表配置
+ */
+bool load_compact_config(const char *path, CompactStoreConfig *config)
+{
+    config->enabled = false;
+    config->block_size = COMPACT_DEFAULT_BLOCK_SIZE;
+    config->merge_threshold = COMPACT_DEFAULT_MERGE_THRESHOLD;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(current_section, sizeof(current_section), "%s", p + 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "compact") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "enabled") == 0) {
+            config->enabled = (strcmp(v, "true") == 0);
+        } else if (strcmp(k, "block_size") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0 && n <= COMPACT_MAX_BLOCK_SIZE) {
+                config->block_size = (size_t)n;
+            }
+        } else if (strcmp(k, "merge_threshold") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->merge_threshold = (size_t)n;
+            }
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool compact_store_enable(const CompactStoreConfig *config)
+{
+    if (atomic_load(&g_compact_active)) {
+        return false;
+    }
+
+    CompactStore *store = compact_store_create(config->block_size, config->merge_threshold);
+    if (store == NULL) {
+        return false;
+    }
+
+    /* 迁入当前 Hash 表中的全部账户 */
+    size_t capacity = 1024;
+    ACCOUNT *accounts = NULL;
+    size_t n = 0;
+    for (;;) {
+        ACCOUNT *grown = realloc(accounts, capacity * sizeof(ACCOUNT));
+        if (grown == NULL) {
+            free(accounts);
+            compact_store_destroy(store);
+            return false;
+        }
+        accounts = grown;
+        bool truncated = false;
+        n = account_collect_all(accounts, capacity, &truncated);
+        if (!truncated) {
+            break;
+        }
+        capacity *= 2;
+    }
+
+    bool ok = compact_store_build(store, accounts, n);
+    free(accounts);
+    if (!ok) {
+        compact_store_destroy(store);
+        return false;
+    }
+
+    g_compact = store;
+    atomic_store(&g_compact_active, true);
+
+    /* 释放 Hash 表节点，此后 hash_* 接口改用紧凑表 */
+    cleanup_account_hash_table();
+    init_account_hash_table();
+    return true;
+}
+
+bool init_compact_store(void)
+{
+    CompactStoreConfig config;
+    load_compact_config(ENGINE_CONFIG_FILE, &config);
+    if (!config.enabled) {
+        return true;
+    }
+
+    if (!compact_store_enable(&config)) {
+        fprintf(stderr, "警告：紧凑账户表启用失败，继续使用 Hash 表\n");
+        return false;
+    }
+
+    CompactStoreStats stats;
+    compact_store_get_stats(g_compact, &stats);
+    printf("✓ 紧凑账户表: %zu 个账户，%zu 块，%.1f 字节/账户\n", stats.count, stats.blocks,
+           stats.count ? (double)compact_store_memory_bytes(&stats) / (double)stats.count : 0.0);
+    return true;
+}
+
+void cleanup_compact_store(void)
+{
+    if (!atomic_load(&g_compact_active)) {
+        return;
+    }
+    atomic_store(&g_compact_active, false);
+    compact_store_destroy(g_compact);
+    g_compact = NULL;
+}
+
+bool compact_store_active(void)
+{
+    return atomic_load_explicit(&g_compact_active, memory_order_acquire);
+}
+
+CompactStore* compact_store_global(void)
+{
+    return g_compact;
+}
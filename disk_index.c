@@ -0,0 +1,1042 @@
+/**
+ * @file disk_index.c
+ * @brief 持久化磁盘账户索引实现（线性哈希页文件 + 缓冲池）
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/disk_index.h>
+#include <lib/account.h>
+#include <lib/engine.h>
+#include <lib/shm_store.h>
+#include <lib/platform.h>
+#include <lib/threadpool.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+ #include <io.h>
+#else
+ #include <dirent.h>
+ #include <limits.h>
+ #include <unistd.h>
+#endif
+
+#ifndef PATH_MAX
+ #define PATH_MAX 260
+#endif
+
+/* ==================== 常量配置 ==================== */
+
+#define DISK_INDEX_DEFAULT_FILE "Card/accounts.idx"
+#define DISK_INDEX_DEFAULT_POOL_PAGES 64
+#define DISK_INDEX_MIN_POOL_PAGES 4
+#define DISK_INDEX_MAX_POOL_PAGES 65536
+#define DISK_INDEX_INITIAL_BUCKETS 16
+#define DISK_INDEX_FILL_PERCENT 75    /* 平均装填超过该百分比时分裂一个桶 */
+#define DISK_INDEX_REBUILD_BATCH 4096  /* 重建时每批并行读取的 .card 文件数 */
+
+#define PAGE_ENTRIES ((DISK_INDEX_PAGE_SIZE - 2 * sizeof(uint32_t)) / sizeof(DiskIndexEntry))
+
+enum { FILE_INDEX = 0, FILE_OVERFLOW = 1 };
+
+/* ==================== 内部结构 ==================== */
+
+/**
+ * @brief 桶页与溢出页
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t next;                /* 下一溢出页编号，0 表示无 */
+    DiskIndexEntry entries[PAGE_ENTRIES];
+} IndexPage;
+
+/**
+ * @brief 缓冲池页框
+ */
+typedef struct {
+    int file;
+    uint32_t page;
+    bool valid;
+    bool dirty;
+    bool ref;                     /* clock 访问位 */
+    int hash_next;                /* 同一哈希槽的下一页框，-1 结束 */
+} PoolFrame;
+
+/**
+ * @brief 磁盘索引
+ *
+ * 所有操作持 lock 执行。pool_fetch() 返回的页只在下一次 pool_fetch() 前有效
+ * （可能被淘汰），因此遍历桶链时只在两次取页之间访问页内容。
+ */
+typedef struct {
+    PlatformMutex lock;
+    atomic_bool active;
+    DiskIndexConfig config;
+    char overflow_file[DISK_INDEX_PATH_MAX + 8];
+    FILE *files[2];
+    DiskIndexHeader header;
+
+    PoolFrame *frames;
+    uint8_t *pages;
+    int *heads;
+    size_t frame_count;
+    size_t head_count;            /* 2的幂 */
+    size_t hand;
+
+    uint64_t lookups;
+    uint64_t page_reads;
+    uint64_t page_writes;
+    uint64_t pool_hits;
+    uint64_t splits;
+    bool rebuilt;
+    uint64_t open_us;
+} DiskIndex;
+
+static DiskIndex g_idx;
+
+/* ==================== 页读写 ==================== */
+
+static bool page_seek(FILE *file, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+static uint64_t page_offset(int file, uint32_t page)
+{
+    /* 溢出页编号从1开始 */
+    return (uint64_t)(file == FILE_INDEX ? page : page - 1) * DISK_INDEX_PAGE_SIZE;
+}
+
+/**
+ * @brief 读取一页，超出文件末尾的部分补0
+ */
+static bool page_read(int file, uint32_t page, uint8_t *buf)
+{
+    FILE *f = g_idx.files[file];
+    if (!page_seek(f, page_offset(file, page))) {
+        return false;
+    }
+    size_t n = fread(buf, 1, DISK_INDEX_PAGE_SIZE, f);
+    if (n < DISK_INDEX_PAGE_SIZE) {
+        if (ferror(f)) {
+            clearerr(f);
+            return false;
+        }
+        clearerr(f);
+        memset(buf + n, 0, DISK_INDEX_PAGE_SIZE - n);
+    }
+    g_idx.page_reads++;
+    return true;
+}
+
+static bool page_write(int file, uint32_t page, const uint8_t *buf)
+{
+    FILE *f = g_idx.files[file];
+    if (!page_seek(f, page_offset(file, page)) ||
+        fwrite(buf, 1, DISK_INDEX_PAGE_SIZE, f) != DISK_INDEX_PAGE_SIZE) {
+        return false;
+    }
+    g_idx.page_writes++;
+    return true;
+}
+
+static bool file_sync(FILE *f)
+{
+    if (fflush(f) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+static bool header_write(void)
+{
+    uint8_t buf[DISK_INDEX_PAGE_SIZE];
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, &g_idx.header, sizeof(g_idx.header));
+    return page_write(FILE_INDEX, 0, buf) && file_sync(g_idx.files[FILE_INDEX]);
+}
+
+/* ==================== 缓冲池 ==================== */
+
+static IndexPage* frame_page(int frame)
+{
+    return (IndexPage *)(g_idx.pages + (size_t)frame * DISK_INDEX_PAGE_SIZE);
+}
+
+static size_t pool_slot(int file, uint32_t page)
+{
+    return ((size_t)page * 2654435761u + (size_t)file) & (g_idx.head_count - 1);
+}
+
+static void pool_unlink(int frame)
+{
+    PoolFrame *fr = &g_idx.frames[frame];
+    int *link = &g_idx.heads[pool_slot(fr->file, fr->page)];
+    while (*link != frame) {
+        link = &g_idx.frames[*link].hash_next;
+    }
+    *link = fr->hash_next;
+}
+
+/**
+ * @brief clock 淘汰一个页框，脏页先写回
+ * @return 写回失败返回-1
+ */
+static int pool_evict(void)
+{
+    for (;;) {
+        int frame = (int)g_idx.hand;
+        g_idx.hand = (g_idx.hand + 1) % g_idx.frame_count;
+        PoolFrame *fr = &g_idx.frames[frame];
+        if (!fr->valid) {
+            return frame;
+        }
+        if (fr->ref) {
+            fr->ref = false;
+            continue;
+        }
+        if (fr->dirty && !page_write(fr->file, fr->page, (uint8_t *)frame_page(frame))) {
+            return -1;
+        }
+        pool_unlink(frame);
+        fr->valid = false;
+        return frame;
+    }
+}
+
+/**
+ * @brief 取页（fresh 为true时不读文件，直接返回清零的新页）
+ * @return 页框下标，失败返回-1
+ */
+static int pool_fetch(int file, uint32_t page, bool fresh)
+{
+    size_t slot = pool_slot(file, page);
+    for (int i = g_idx.heads[slot]; i >= 0; i = g_idx.frames[i].hash_next) {
+        if (g_idx.frames[i].file == file && g_idx.frames[i].page == page) {
+            g_idx.frames[i].ref = true;
+            g_idx.pool_hits++;
+            if (fresh) {
+                memset(frame_page(i), 0, DISK_INDEX_PAGE_SIZE);
+                g_idx.frames[i].dirty = true;
+            }
+            return i;
+        }
+    }
+
+    int frame = pool_evict();
+    if (frame < 0) {
+        return -1;
+    }
+    uint8_t *buf = (uint8_t *)frame_page(frame);
+    if (fresh) {
+        memset(buf, 0, DISK_INDEX_PAGE_SIZE);
+    } else if (!page_read(file, page, buf)) {
+        return -1;
+    }
+
+    PoolFrame *fr = &g_idx.frames[frame];
+    fr->file = file;
+    fr->page = page;
+    fr->valid = true;
+    fr->dirty = fresh;
+    fr->ref = true;
+    fr->hash_next = g_idx.heads[slot];
+    g_idx.heads[slot] = frame;
+    return frame;
+}
+
+static bool pool_flush(void)
+{
+    bool ok = true;
+    for (size_t i = 0; i < g_idx.frame_count; i++) {
+        PoolFrame *fr = &g_idx.frames[i];
+        if (fr->valid && fr->dirty) {
+            if (page_write(fr->file, fr->page, (uint8_t *)frame_page((int)i))) {
+                fr->dirty = false;
+            } else {
+                ok = false;
+            }
+        }
+    }
+    return ok && file_sync(g_idx.files[FILE_OVERFLOW]) && file_sync(g_idx.files[FILE_INDEX]);
+}
+
+static bool pool_create(size_t pages)
+{
+    g_idx.frame_count = pages;
+    g_idx.head_count = 1;
+    while (g_idx.head_count < pages * 2) {
+        g_idx.head_count <<= 1;
+    }
+    g_idx.frames = calloc(pages, sizeof(PoolFrame));
+    g_idx.pages = malloc(pages * DISK_INDEX_PAGE_SIZE);
+    g_idx.heads = malloc(g_idx.head_count * sizeof(int));
+    if (!g_idx.frames || !g_idx.pages || !g_idx.heads) {
+        return false;
+    }
+    for (size_t i = 0; i < g_idx.head_count; i++) {
+        g_idx.heads[i] = -1;
+    }
+    g_idx.hand = 0;
+    return true;
+}
+
+static void pool_destroy(void)
+{
+    free(g_idx.frames);
+    free(g_idx.pages);
+    free(g_idx.heads);
+    g_idx.frames = NULL;
+    g_idx.pages = NULL;
+    g_idx.heads = NULL;
+}
+
+/* ==================== 线性哈希 ==================== */
+
+static uint64_t key_hash(const uint8_t key[16])
+{
+    uint64_t h = 1469598103934665603ull;   /* FNV-1a */
+    for (int i = 0; i < 16; i++) {
+        h ^= key[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static uint32_t bucket_count(void)
+{
+    return (g_idx.header.initial_buckets << g_idx.header.level) + g_idx.header.split;
+}
+
+static uint32_t bucket_of(const uint8_t key[16])
+{
+    uint64_t h = key_hash(key);
+    uint64_t round = (uint64_t)g_idx.header.initial_buckets << g_idx.header.level;
+    uint32_t b = (uint32_t)(h & (round - 1));
+    if (b < g_idx.header.split) {
+        b = (uint32_t)(h & (round * 2 - 1));
+    }
+    return b;
+}
+
+static int fetch_bucket(uint32_t bucket)
+{
+    return pool_fetch(FILE_INDEX, 1 + bucket, false);
+}
+
+/**
+ * @brief 分配溢出页（优先复用空闲页）
+ * @return 溢出页编号，失败返回0
+ */
+static uint32_t overflow_alloc(void)
+{
+    uint32_t id = g_idx.header.free_overflow;
+    if (id != 0) {
+        int frame = pool_fetch(FILE_OVERFLOW, id, false);
+        if (frame < 0) {
+            return 0;
+        }
+        g_idx.header.free_overflow = frame_page(frame)->next;
+    } else {
+        id = ++g_idx.header.overflow_pages;
+    }
+    return pool_fetch(FILE_OVERFLOW, id, true) < 0 ? 0 : id;
+}
+
+static bool overflow_free(uint32_t id)
+{
+    int frame = pool_fetch(FILE_OVERFLOW, id, true);
+    if (frame < 0) {
+        return false;
+    }
+    frame_page(frame)->next = g_idx.header.free_overflow;
+    g_idx.header.free_overflow = id;
+    return true;
+}
+
+/**
+ * @brief 在桶链中查找
+ * @return 找到返回true，out_file、out_page、out_slot 不为NULL时写入条目位置
+ */
+static bool chain_find(uint32_t bucket, const uint8_t key[16], DiskIndexEntry *found,
+                       int *out_file, uint32_t *out_page, uint32_t *out_slot, bool *io_ok)
+{
+    int file = FILE_INDEX;
+    uint32_t page = 1 + bucket;
+    *io_ok = true;
+    for (;;) {
+        int frame = pool_fetch(file, page, false);
+        if (frame < 0) {
+            *io_ok = false;
+            return false;
+        }
+        IndexPage *p = frame_page(frame);
+        for (uint32_t i = 0; i < p->count && i < PAGE_ENTRIES; i++) {
+            if (memcmp(p->entries[i].key, key, 16) == 0) {
+                if (found) {
+                    *found = p->entries[i];
+                }
+                if (out_file) {
+                    *out_file = file;
+                    *out_page = page;
+                    *out_slot = i;
+                }
+                return true;
+            }
+        }
+        if (p->next == 0) {
+            return false;
+        }
+        file = FILE_OVERFLOW;
+        page = p->next;
+    }
+}
+
+/**
+ * @brief 把条目追加到桶链中第一个有空位的页，链满时接一个溢出页
+ */
+static bool chain_append(uint32_t bucket, const DiskIndexEntry *entry)
+{
+    int file = FILE_INDEX;
+    uint32_t page = 1 + bucket;
+    for (;;) {
+        int frame = pool_fetch(file, page, false);
+        if (frame < 0) {
+            return false;
+        }
+        IndexPage *p = frame_page(frame);
+        if (p->count < PAGE_ENTRIES) {
+            p->entries[p->count++] = *entry;
+            g_idx.frames[frame].dirty = true;
+            return true;
+        }
+        if (p->next == 0) {
+            break;
+        }
+        file = FILE_OVERFLOW;
+        page = p->next;
+    }
+
+    uint32_t id = overflow_alloc();
+    if (id == 0) {
+        return false;
+    }
+    int frame = pool_fetch(FILE_OVERFLOW, id, false);
+    if (frame < 0) {
+        return false;
+    }
+    frame_page(frame)->count = 1;
+    frame_page(frame)->entries[0] = *entry;
+    g_idx.frames[frame].dirty = true;
+
+    /* 链尾页可能已被淘汰，重新取 */
+    frame = pool_fetch(file, page, false);
+    if (frame < 0) {
+        return false;
+    }
+    frame_page(frame)->next = id;
+    g_idx.frames[frame].dirty = true;
+    return true;
+}
+
+/**
+ * @brief 分裂第 split 号桶：条目按新的哈希位分到原桶与新桶
+ */
+static bool split_bucket(void)
+{
+    uint32_t round = g_idx.header.initial_buckets << g_idx.header.level;
+    uint32_t old_bucket = g_idx.header.split;
+    uint32_t new_bucket = old_bucket + round;
+
+    DiskIndexEntry *entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    uint32_t overflow = 0;
+
+    /* 取出原桶链的全部条目，归还溢出页 */
+    int frame = fetch_bucket(old_bucket);
+    bool ok = frame >= 0;
+    if (ok) {
+        IndexPage *p = frame_page(frame);
+        overflow = p->next;
+        capacity = PAGE_ENTRIES * 2;
+        entries = malloc(capacity * sizeof(DiskIndexEntry));
+        ok = entries != NULL;
+        if (ok) {
+            memcpy(entries, p->entries, p->count * sizeof(DiskIndexEntry));
+            count = p->count;
+            p->count = 0;
+            p->next = 0;
+            g_idx.frames[frame].dirty = true;
+        }
+    }
+    while (ok && overflow != 0) {
+        frame = pool_fetch(FILE_OVERFLOW, overflow, false);
+        if (frame < 0) {
+            ok = false;
+            break;
+        }
+        IndexPage *p = frame_page(frame);
+        if (count + p->count > capacity) {
+            capacity *= 2;
+            DiskIndexEntry *grown = realloc(entries, capacity * sizeof(DiskIndexEntry));
+            if (grown == NULL) {
+                ok = false;
+                break;
+            }
+            entries = grown;
+        }
+        memcpy(entries + count, p->entries, p->count * sizeof(DiskIndexEntry));
+        count += p->count;
+        uint32_t next = p->next;
+        ok = overflow_free(overflow);
+        overflow = next;
+    }
+
+    if (ok) {
+        ok = pool_fetch(FILE_INDEX, 1 + new_bucket, true) >= 0;
+    }
+    if (ok) {
+        if (++g_idx.header.split == round) {
+            g_idx.header.level++;
+            g_idx.header.split = 0;
+        }
+        for (size_t i = 0; i < count && ok; i++) {
+            ok = chain_append(bucket_of(entries[i].key), &entries[i]);
+        }
+        g_idx.splits++;
+    }
+    free(entries);
+    return ok;
+}
+
+static bool index_put_locked(const uint8_t key[16], const uint8_t value[16])
+{
+    int file;
+    uint32_t page;
+    uint32_t slot;
+    bool io_ok;
+    uint32_t bucket = bucket_of(key);
+    if (chain_find(bucket, key, NULL, &file, &page, &slot, &io_ok)) {
+        int frame = pool_fetch(file, page, false);
+        if (frame < 0) {
+            return false;
+        }
+        memcpy(frame_page(frame)->entries[slot].value, value, 16);
+        g_idx.frames[frame].dirty = true;
+        return true;
+    }
+    if (!io_ok) {
+        return false;
+    }
+
+    DiskIndexEntry entry;
+    memcpy(entry.key, key, 16);
+    memcpy(entry.value, value, 16);
+    if (!chain_append(bucket, &entry)) {
+        return false;
+    }
+    g_idx.header.count++;
+
+    while (g_idx.header.count * 100 >
+           (uint64_t)bucket_count() * PAGE_ENTRIES * DISK_INDEX_FILL_PERCENT) {
+        if (!split_bucket()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool index_remove_locked(const uint8_t key[16])
+{
+    int file;
+    uint32_t page;
+    uint32_t slot;
+    bool io_ok;
+    if (!chain_find(bucket_of(key), key, NULL, &file, &page, &slot, &io_ok)) {
+        return io_ok;
+    }
+    int frame = pool_fetch(file, page, false);
+    if (frame < 0) {
+        return false;
+    }
+    IndexPage *p = frame_page(frame);
+    p->entries[slot] = p->entries[--p->count];
+    g_idx.frames[frame].dirty = true;
+    g_idx.header.count--;
+    return true;
+}
+
+static void entry_encode(const ACCOUNT *acc, uint8_t value[16])
+{
+    memcpy(value, &acc->PASSWORD, sizeof(LLUINT));
+    memcpy(value + sizeof(LLUINT), &acc->BALANCE, sizeof(LLUINT));
+    xor_encrypt_decrypt(value, 16);
+}
+
+static void entry_decode(const DiskIndexEntry *entry, ACCOUNT *acc)
+{
+    uint8_t value[16];
+    memcpy(value, entry->value, 16);
+    xor_encrypt_decrypt(value, 16);
+    uuid_from_bytes(entry->key, acc->UUID);
+    memcpy(&acc->PASSWORD, value, sizeof(LLUINT));
+    memcpy(&acc->BALANCE, value + sizeof(LLUINT), sizeof(LLUINT));
+}
+
+/* ==================== 打开与重建 ==================== */
+
+/**
+ * @brief 重建时的一批 .card 文件：文件读取在线程池中并行，写索引在调用线程中依次进行
+ */
+typedef struct {
+    char uuids[DISK_INDEX_REBUILD_BATCH][37];
+    uint8_t keys[DISK_INDEX_REBUILD_BATCH][16];
+    uint8_t values[DISK_INDEX_REBUILD_BATCH][16];
+    bool read_ok[DISK_INDEX_REBUILD_BATCH];
+    size_t count;
+    size_t added;
+} RebuildBatch;
+
+static void rebuild_read_range(size_t begin, size_t end, void *arg)
+{
+    RebuildBatch *batch = arg;
+    for (size_t i = begin; i < end; i++) {
+        ACCOUNT acc;
+        batch->read_ok[i] = account_read_file(batch->uuids[i], &acc);
+        if (batch->read_ok[i]) {
+            entry_encode(&acc, batch->values[i]);
+        }
+    }
+}
+
+static void rebuild_flush(RebuildBatch *batch)
+{
+    ThreadPool *pool = threadpool_shared();
+    if (pool != NULL) {
+        threadpool_parallel_for(pool, 0, batch->count, 64, rebuild_read_range, batch);
+    } else {
+        rebuild_read_range(0, batch->count, batch);
+    }
+    for (size_t i = 0; i < batch->count; i++) {
+        if (batch->read_ok[i] && index_put_locked(batch->keys[i], batch->values[i])) {
+            batch->added++;
+        }
+    }
+    batch->count = 0;
+}
+
+static void rebuild_add_card(const char *name, RebuildBatch *batch)
+{
+    /* 只收录 <UUID>.card，过长或不合格式的文件名跳过 */
+    char uuid[PATH_MAX];
+    int len = snprintf(uuid, sizeof(uuid), "%s", name);
+    if (len < 0 || (size_t)len >= sizeof(uuid)) {
+        return;
+    }
+    char *dot = strstr(uuid, ".card");
+    if (dot == NULL || dot - uuid != 36) {
+        return;
+    }
+    *dot = '\0';
+
+    /* 非规范格式的 UUID 不进索引，读取时回退到 .card 文件 */
+    if (!uuid_to_bytes(uuid, batch->keys[batch->count])) {
+        return;
+    }
+    memcpy(batch->uuids[batch->count], uuid, 37);
+    if (++batch->count == DISK_INDEX_REBUILD_BATCH) {
+        rebuild_flush(batch);
+    }
+}
+
+/**
+ * @brief 扫描 Card 目录重建索引
+ */
+static size_t rebuild_from_cards(void)
+{
+    RebuildBatch *batch = calloc(1, sizeof(RebuildBatch));
+    if (batch == NULL) {
+        return 0;
+    }
+
+#ifdef _WIN32
+    struct _finddata_t fileinfo;
+    intptr_t handle = _findfirst("Card/*.card", &fileinfo);
+    if (handle != -1) {
+        do {
+            rebuild_add_card(fileinfo.name, batch);
+        } while (_findnext(handle, &fileinfo) == 0);
+        _findclose(handle);
+    }
+#else
+    DIR *dir = opendir("Card");
+    if (dir != NULL) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strstr(entry->d_name, ".card") != NULL) {
+                rebuild_add_card(entry->d_name, batch);
+            }
+        }
+        closedir(dir);
+    }
+#endif
+
+    rebuild_flush(batch);
+    size_t added = batch->added;
+    free(batch);
+    return added;
+}
+
+static void close_files(void)
+{
+    for (int i = 0; i < 2; i++) {
+        if (g_idx.files[i]) {
+            fclose(g_idx.files[i]);
+            g_idx.files[i] = NULL;
+        }
+    }
+}
+
+/**
+ * @brief 打开已有的索引，仅接受上次正常关闭的文件
+ */
+static bool open_existing(void)
+{
+    g_idx.files[FILE_INDEX] = fopen(g_idx.config.index_file, "r+b");
+    g_idx.files[FILE_OVERFLOW] = fopen(g_idx.overflow_file, "r+b");
+    if (!g_idx.files[FILE_INDEX] || !g_idx.files[FILE_OVERFLOW]) {
+        close_files();
+        return false;
+    }
+
+    DiskIndexHeader *h = &g_idx.header;
+    bool ok = fread(h, sizeof(*h), 1, g_idx.files[FILE_INDEX]) == 1 &&
+              h->magic == DISK_INDEX_MAGIC && h->version == DISK_INDEX_VERSION &&
+              h->page_size == DISK_INDEX_PAGE_SIZE && h->clean == 1 &&
+              h->initial_buckets != 0 && (h->initial_buckets & (h->initial_buckets - 1)) == 0 &&
+              h->split < (h->initial_buckets << h->level);
+    if (!ok) {
+        close_files();
+    }
+    return ok;
+}
+
+static bool create_empty(void)
+{
+    g_idx.files[FILE_INDEX] = fopen(g_idx.config.index_file, "w+b");
+    g_idx.files[FILE_OVERFLOW] = fopen(g_idx.overflow_file, "w+b");
+    if (!g_idx.files[FILE_INDEX] || !g_idx.files[FILE_OVERFLOW]) {
+        close_files();
+        return false;
+    }
+
+    memset(&g_idx.header, 0, sizeof(g_idx.header));
+    g_idx.header.magic = DISK_INDEX_MAGIC;
+    g_idx.header.version = DISK_INDEX_VERSION;
+    g_idx.header.page_size = DISK_INDEX_PAGE_SIZE;
+    g_idx.header.initial_buckets = DISK_INDEX_INITIAL_BUCKETS;
+    return true;
+}
+
+bool disk_index_open(const DiskIndexConfig *config)
+{
+    if (atomic_load(&g_idx.active)) {
+        return false;
+    }
+
+    uint64_t t0 = platform_monotonic_ns();
+    g_idx.config = *config;
+    if (g_idx.config.pool_pages < DISK_INDEX_MIN_POOL_PAGES) {
+        g_idx.config.pool_pages = DISK_INDEX_MIN_POOL_PAGES;
+    }
+    snprintf(g_idx.overflow_file, sizeof(g_idx.overflow_file), "%s.ovf", config->index_file);
+    g_idx.lookups = 0;
+    g_idx.page_reads = 0;
+    g_idx.page_writes = 0;
+    g_idx.pool_hits = 0;
+    g_idx.splits = 0;
+
+    if (!pool_create(g_idx.config.pool_pages)) {
+        pool_destroy();
+        return false;
+    }
+
+    g_idx.rebuilt = !open_existing();
+    if (g_idx.rebuilt && !create_empty()) {
+        pool_destroy();
+        return false;
+    }
+
+    /* 先把 clean 置0落盘，此后崩溃则下次启动重建 */
+    g_idx.header.clean = 0;
+    bool ok = header_write();
+    if (ok && g_idx.rebuilt) {
+        rebuild_from_cards();
+        ok = pool_flush() && header_write();
+    }
+    if (!ok) {
+        close_files();
+        pool_destroy();
+        return false;
+    }
+
+    platform_mutex_init(&g_idx.lock);
+    g_idx.open_us = (platform_monotonic_ns() - t0) / 1000;
+    atomic_store(&g_idx.active, true);
+    return true;
+}
+
+void cleanup_disk_index(void)
+{
+    if (!atomic_load(&g_idx.active)) {
+        return;
+    }
+
+    platform_mutex_lock(&g_idx.lock);
+    atomic_store(&g_idx.active, false);
+    if (pool_flush()) {
+        g_idx.header.clean = 1;
+        header_write();
+    } else {
+        fprintf(stderr, "警告：磁盘索引写回失败，下次启动时重建\n");
+    }
+    close_files();
+    pool_destroy();
+    platform_mutex_unlock(&g_idx.lock);
+    platform_mutex_destroy(&g_idx.lock);
+}
+
+bool disk_index_active(void)
+{
+    return atomic_load_explicit(&g_idx.active, memory_order_acquire);
+}
+
+void disk_index_get_stats(DiskIndexStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!disk_index_active()) {
+        return;
+    }
+
+    platform_mutex_lock(&g_idx.lock);
+    stats->count = (size_t)g_idx.header.count;
+    stats->buckets = bucket_count();
+    stats->overflow_pages = g_idx.header.overflow_pages;
+    stats->file_bytes = ((uint64_t)1 + stats->buckets + stats->overflow_pages) * DISK_INDEX_PAGE_SIZE;
+    stats->pool_pages = g_idx.frame_count;
+    stats->lookups = g_idx.lookups;
+    stats->page_reads = g_idx.page_reads;
+    stats->page_writes = g_idx.page_writes;
+    stats->pool_hits = g_idx.pool_hits;
+    stats->splits = g_idx.splits;
+    stats->rebuilt = g_idx.rebuilt;
+    stats->open_us = g_idx.open_us;
+    platform_mutex_unlock(&g_idx.lock);
+}
+
+/* ==================== 账户模块调用 ==================== */
+
+bool disk_index_get(const char *uuid, ACCOUNT *acc)
+{
+    uint8_t key[16];
+    if (!disk_index_active() || !uuid_to_bytes(uuid, key)) {
+        return false;
+    }
+
+    DiskIndexEntry entry;
+    bool io_ok;
+    platform_mutex_lock(&g_idx.lock);
+    g_idx.lookups++;
+    bool found = chain_find(bucket_of(key), key, &entry, NULL, NULL, NULL, &io_ok);
+    platform_mutex_unlock(&g_idx.lock);
+
+    if (found) {
+        entry_decode(&entry, acc);
+    }
+    return found;
+}
+
+bool disk_index_put(const ACCOUNT *acc)
+{
+    uint8_t key[16];
+    if (!disk_index_active() || !uuid_to_bytes(acc->UUID, key)) {
+        return true;
+    }
+
+    uint8_t value[16];
+    entry_encode(acc, value);
+    platform_mutex_lock(&g_idx.lock);
+    bool ok = index_put_locked(key, value);
+    platform_mutex_unlock(&g_idx.lock);
+    return ok;
+}
+
+bool disk_index_remove(const char *uuid)
+{
+    uint8_t key[16];
+    if (!disk_index_active() || !uuid_to_bytes(uuid, key)) {
+        return true;
+    }
+
+    platform_mutex_lock(&g_idx.lock);
+    bool ok = index_remove_locked(key);
+    platform_mutex_unlock(&g_idx.lock);
+    return ok;
+}
+
+size_t disk_index_collect(ACCOUNT *out, size_t max_count)
+{
+    if (!disk_index_active()) {
+        return 0;
+    }
+
+    size_t n = 0;
+    platform_mutex_lock(&g_idx.lock);
+    uint32_t buckets = bucket_count();
+    for (uint32_t b = 0; b < buckets && n < max_count; b++) {
+        int file = FILE_INDEX;
+        uint32_t page = 1 + b;
+        while (n < max_count) {
+            int frame = pool_fetch(file, page, false);
+            if (frame < 0) {
+                break;
+            }
+            IndexPage *p = frame_page(frame);
+            for (uint32_t i = 0; i < p->count && n < max_count; i++) {
+                entry_decode(&p->entries[i], &out[n++]);
+            }
+            if (p->next == 0) {
+                break;
+            }
+            file = FILE_OVERFLOW;
+            page = p->next;
+        }
+    }
+    platform_mutex_unlock(&g_idx.lock);
+    return n;
+}
+
+/* ==================== 配置 ==================== */
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取磁盘索引配置
+ */
+bool load_disk_index_config(const char *path, DiskIndexConfig *config)
+{
+    config->enabled = false;
+    config->pool_pages = DISK_INDEX_DEFAULT_POOL_PAGES;
+    snprintf(config->index_file, sizeof(config->index_file), "%s", DISK_INDEX_DEFAULT_FILE);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(current_section, sizeof(current_section), "%s", p + 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "disk_index") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "enabled") == 0) {
+            config->enabled = (strcmp(v, "true") == 0);
+        } else if (strcmp(k, "pool_pages") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n >= DISK_INDEX_MIN_POOL_PAGES && n <= DISK_INDEX_MAX_POOL_PAGES) {
+                config->pool_pages = (size_t)n;
+            }
+        } else if (strcmp(k, "index_file") == 0 && *v != '\0') {
+            snprintf(config->index_file, sizeof(config->index_file), "%s", v);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool init_disk_index(void)
+{
+    DiskIndexConfig config;
+    load_disk_index_config(ENGINE_CONFIG_FILE, &config);
+
+    bool enabled = config.enabled;
+    if (enabled) {
+        /* 多个进程不能共用一个索引文件的缓冲池 */
+        ShmStoreConfig shm_config;
+        load_shm_config(ENGINE_CONFIG_FILE, &shm_config);
+        if (shm_config.enabled) {
+            fprintf(stderr, "警告：多进程共享存储模式不支持磁盘索引，已忽略 [disk_index] enabled=true\n");
+            enabled = false;
+        }
+    }
+
+    if (!enabled) {
+        /* 本次运行的修改不会写入索引，删除旧索引以免下次启用时读到过期数据 */
+        char overflow_file[DISK_INDEX_PATH_MAX + 8];
+        snprintf(overflow_file, sizeof(overflow_file), "%s.ovf", config.index_file);
+        remove(config.index_file);
+        remove(overflow_file);
+        return true;
+    }
+
+    if (!disk_index_open(&config)) {
+        fprintf(stderr, "警告：磁盘索引打开失败，启动时载入全部账户\n");
+        return false;
+    }
+
+    DiskIndexStats stats;
+    disk_index_get_stats(&stats);
+    printf("✓ 磁盘索引: %s（%zu 个账户，%s %.1f ms）\n", config.index_file, stats.count,
+           stats.rebuilt ? "重建" : "打开", stats.open_us / 1000.0);
+    return true;
+}
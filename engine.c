@@ -0,0 +1,549 @@
+/**
+ * @file engine.c
+ * @brief 账户操作引擎实现（单写线程 + 有界无锁MPSC环形队列）
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/engine.h>
+#include <lib/mpsc_ring.h>
+#include <lib/shard.h>
+#include <lib/replication.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================== 常量配置 ==================== */
+
+#define ENGINE_DEFAULT_QUEUE_CAPACITY 1024
+#define ENGINE_DEFAULT_MAX_BATCH 64
+#define ENGINE_DEFAULT_SHARDS 4
+#define ENGINE_MAX_SHARDS 256
+#define ENGINE_IDLE_WAIT_MS 100       /* 写线程空闲时的最长休眠（防丢失唤醒的兜底） */
+#define ENGINE_SUBMIT_SPIN 64         /* 队列满时先自旋重试的次数，之后每次休眠1ms */
+#define ENGINE_FUTURE_SPIN 256        /* 等待 future 时加锁前的自旋次数 */
+
+/* ==================== 内部结构 ==================== */
+
+typedef struct {
+    MpscRing ring;                /* 生产者 -> 写线程 */
+    EngineOp *batch_ops;          /* 写线程的批次缓冲 */
+    EngineResult *batch_results;
+
+    EngineConfig config;
+    atomic_bool running;          /* 写线程已启动 */
+    atomic_bool accepting;        /* 是否接受新提交 */
+    atomic_bool stopping;         /* 通知写线程排空后退出 */
+    atomic_int submitters;        /* 正在 engine_submit 内的线程数 */
+    PlatformThread writer;
+
+    atomic_size_t submitted;
+    atomic_size_t rejected;
+    atomic_size_t applied;
+    atomic_size_t batches;
+    atomic_size_t max_batch_seen;
+} Engine;
+
+static Engine g_engine;
+
+/* ==================== 配置 ==================== */
+
+static void engine_default_config(EngineConfig *config)
+{
+    config->mode = ENGINE_MODE_MUTEX;
+    config->queue_capacity = ENGINE_DEFAULT_QUEUE_CAPACITY;
+    config->max_batch = ENGINE_DEFAULT_MAX_BATCH;
+    config->shards = ENGINE_DEFAULT_SHARDS;
+    config->pin_threads = true;
+}
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取引擎配置
+ */
+bool load_engine_config(const char *path, EngineConfig *config)
+{
+    engine_default_config(config);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                strncpy(current_section, p + 1, sizeof(current_section) - 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "engine") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "mode") == 0) {
+            if (strcmp(v, "single_writer") == 0) {
+                config->mode = ENGINE_MODE_SINGLE_WRITER;
+            } else if (strcmp(v, "sharded") == 0) {
+                config->mode = ENGINE_MODE_SHARDED;
+            } else if (strcmp(v, "mutex") == 0) {
+                config->mode = ENGINE_MODE_MUTEX;
+            } else {
+                fprintf(stderr, "警告：engine.conf 中 mode=%s 无效，使用 mutex\n", v);
+            }
+        } else if (strcmp(k, "queue_capacity") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->queue_capacity = (size_t)n;
+            }
+        } else if (strcmp(k, "max_batch") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->max_batch = (size_t)n;
+            }
+        } else if (strcmp(k, "shards") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0 && n <= ENGINE_MAX_SHARDS) {
+                config->shards = (size_t)n;
+            }
+        } else if (strcmp(k, "pin_threads") == 0) {
+            config->pin_threads = (strcmp(v, "true") == 0);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+/* ==================== 写线程 ==================== */
+
+static EngineResult apply_op(const EngineOp *op)
+{
+    EngineResult r;
+    memset(&r, 0, sizeof(r));
+    r.type = op->type;
+
+    switch (op->type) {
+    case ENGINE_OP_DEPOSIT:
+        r.status = account_apply_deposit(op->uuid, op->amount, &r.account);
+        break;
+    case ENGINE_OP_WITHDRAW:
+        r.status = account_apply_withdraw(op->uuid, op->amount, &r.account);
+        break;
+    case ENGINE_OP_TRANSFER:
+        r.status = account_apply_transfer(op->uuid, op->uuid_to, op->amount,
+                                          &r.account, &r.account_to);
+        break;
+    case ENGINE_OP_DELETE:
+        r.status = account_apply_delete(op->uuid);
+        break;
+    default:
+        r.status = ACCOUNT_ERR_INVALID;
+        break;
+    }
+    return r;
+}
+
+static void complete_op(const EngineOp *op, const EngineResult *result)
+{
+    if (op->callback != NULL) {
+        op->callback(result, op->user);
+    }
+
+    EngineFuture *f = op->future;
+    if (f != NULL) {
+        platform_mutex_lock(&f->lock);
+        f->result = *result;
+        atomic_store_explicit(&f->done, 1, memory_order_release);
+        platform_cond_broadcast(&f->cond);
+        platform_mutex_unlock(&f->lock);
+    }
+}
+
+/**
+ * @brief 写线程主循环：取一批 -> 逐个执行 -> 统一落盘 -> 通知完成
+ */
+static void engine_writer_main(void *arg)
+{
+    (void)arg;
+    size_t max_batch = g_engine.config.max_batch;
+    EngineOp *ops = g_engine.batch_ops;
+    EngineResult *results = g_engine.batch_results;
+
+    for (;;) {
+        size_t n = 0;
+        while (n < max_batch && mpsc_ring_pop(&g_engine.ring, &ops[n])) {
+            n++;
+        }
+
+        if (n == 0) {
+            if (atomic_load(&g_engine.stopping)) {
+                break;  /* 已排空 */
+            }
+            mpsc_ring_wait(&g_engine.ring, ENGINE_IDLE_WAIT_MS, &g_engine.stopping);
+            continue;
+        }
+
+        account_begin_batch();
+        for (size_t i = 0; i < n; i++) {
+            results[i] = apply_op(&ops[i]);
+        }
+        bool persisted = account_end_batch();
+
+        /* sync 复制：整批等待一次热备确认后再通知完成 */
+        replication_wait_commit();
+
+        /* 先更新统计再通知完成，等待方返回后读到的统计已包含本批 */
+        atomic_fetch_add(&g_engine.applied, n);
+        atomic_fetch_add(&g_engine.batches, 1);
+        size_t seen = atomic_load(&g_engine.max_batch_seen);
+        while (n > seen && !atomic_compare_exchange_weak(&g_engine.max_batch_seen, &seen, n)) {
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            if (!persisted && results[i].status == ACCOUNT_OK) {
+                results[i].status = ACCOUNT_ERR_IO;
+            }
+            complete_op(&ops[i], &results[i]);
+        }
+    }
+    account_batch_thread_cleanup();
+}
+
+/* ==================== 生命周期 ==================== */
+
+static void engine_free_buffers(void)
+{
+    mpsc_ring_destroy(&g_engine.ring);
+    free(g_engine.batch_ops);
+    free(g_engine.batch_results);
+    g_engine.batch_ops = NULL;
+    g_engine.batch_results = NULL;
+}
+
+bool engine_start(const EngineConfig *config)
+{
+    if (config->mode == ENGINE_MODE_SHARDED) {
+        return shard_engine_start(config);
+    }
+    if (config->mode != ENGINE_MODE_SINGLE_WRITER) {
+        return true;
+    }
+    if (atomic_load(&g_engine.running)) {
+        return true;
+    }
+
+    g_engine.config = *config;
+    if (g_engine.config.max_batch == 0) {
+        g_engine.config.max_batch = 1;
+    }
+    g_engine.batch_ops = (EngineOp *)malloc(g_engine.config.max_batch * sizeof(EngineOp));
+    g_engine.batch_results = (EngineResult *)malloc(g_engine.config.max_batch * sizeof(EngineResult));
+    if (g_engine.batch_ops == NULL || g_engine.batch_results == NULL ||
+        !mpsc_ring_init(&g_engine.ring, config->queue_capacity, sizeof(EngineOp))) {
+        fprintf(stderr, "错误：引擎队列内存分配失败\n");
+        engine_free_buffers();
+        return false;
+    }
+
+    atomic_store(&g_engine.stopping, false);
+    atomic_store(&g_engine.submitters, 0);
+    atomic_store(&g_engine.submitted, 0);
+    atomic_store(&g_engine.rejected, 0);
+    atomic_store(&g_engine.applied, 0);
+    atomic_store(&g_engine.batches, 0);
+    atomic_store(&g_engine.max_batch_seen, 0);
+
+    if (!platform_thread_create(&g_engine.writer, engine_writer_main, NULL)) {
+        fprintf(stderr, "错误：无法创建引擎写线程\n");
+        engine_free_buffers();
+        return false;
+    }
+
+    atomic_store(&g_engine.running, true);
+    atomic_store(&g_engine.accepting, true);
+    return true;
+}
+
+bool init_engine(void)
+{
+    EngineConfig config;
+    load_engine_config(ENGINE_CONFIG_FILE, &config);
+
+    if (config.mode == ENGINE_MODE_SINGLE_WRITER) {
+        if (!engine_start(&config)) {
+            fprintf(stderr, "警告：单写线程引擎启动失败，使用加锁模式\n");
+            return false;
+        }
+        printf("✓ 账户引擎: 单写线程模式（队列容量 %zu，批量 %zu）\n",
+               mpsc_ring_capacity(&g_engine.ring), g_engine.config.max_batch);
+    } else if (config.mode == ENGINE_MODE_SHARDED) {
+        if (!engine_start(&config)) {
+            fprintf(stderr, "警告：分片引擎启动失败，使用加锁模式\n");
+            return false;
+        }
+        printf("✓ 账户引擎: 分片模式（%zu 个分片%s）\n",
+               shard_engine_count(), config.pin_threads ? "，已绑定CPU核心" : "");
+    }
+    return true;
+}
+
+void cleanup_engine(void)
+{
+    shard_engine_stop();
+
+    if (!atomic_load(&g_engine.running)) {
+        return;
+    }
+
+    /* 停止接受新提交，并等待正在入队的生产者离开 */
+    atomic_store(&g_engine.accepting, false);
+    while (atomic_load(&g_engine.submitters) > 0) {
+        platform_sleep_ms(0);
+    }
+
+    atomic_store(&g_engine.stopping, true);
+    mpsc_ring_wake(&g_engine.ring);
+
+    platform_thread_join(g_engine.writer);
+    atomic_store(&g_engine.running, false);
+
+    engine_free_buffers();
+}
+
+bool engine_is_running(void)
+{
+    return atomic_load(&g_engine.accepting);
+}
+
+void engine_get_stats(EngineStats *stats)
+{
+    stats->submitted = atomic_load(&g_engine.submitted);
+    stats->rejected = atomic_load(&g_engine.rejected);
+    stats->applied = atomic_load(&g_engine.applied);
+    stats->batches = atomic_load(&g_engine.batches);
+    stats->max_batch_seen = atomic_load(&g_engine.max_batch_seen);
+}
+
+/* ==================== 提交与等待 ==================== */
+
+bool engine_submit(const EngineOp *op)
+{
+    atomic_fetch_add(&g_engine.submitters, 1);
+    if (!atomic_load(&g_engine.accepting)) {
+        atomic_fetch_sub(&g_engine.submitters, 1);
+        return false;
+    }
+
+    bool pushed = mpsc_ring_push(&g_engine.ring, op);
+    atomic_fetch_sub(&g_engine.submitters, 1);
+
+    if (!pushed) {
+        atomic_fetch_add_explicit(&g_engine.rejected, 1, memory_order_relaxed);
+        return false;
+    }
+    atomic_fetch_add_explicit(&g_engine.submitted, 1, memory_order_relaxed);
+
+    mpsc_ring_notify(&g_engine.ring);
+    return true;
+}
+
+void engine_future_init(EngineFuture *future)
+{
+    atomic_init(&future->done, 0);
+    memset(&future->result, 0, sizeof(future->result));
+    platform_mutex_init(&future->lock);
+    platform_cond_init(&future->cond);
+}
+
+void engine_future_destroy(EngineFuture *future)
+{
+    platform_cond_destroy(&future->cond);
+    platform_mutex_destroy(&future->lock);
+}
+
+bool engine_future_ready(EngineFuture *future)
+{
+    return atomic_load_explicit(&future->done, memory_order_acquire) != 0;
+}
+
+const EngineResult* engine_future_wait(EngineFuture *future)
+{
+    for (int i = 0; i < ENGINE_FUTURE_SPIN && !engine_future_ready(future); i++) {
+    }
+
+    /* 即使已完成也要经过一次加锁，确保写线程已离开临界区后才允许销毁 future */
+    platform_mutex_lock(&future->lock);
+    while (!engine_future_ready(future)) {
+        platform_cond_wait(&future->cond, &future->lock);
+    }
+    platform_mutex_unlock(&future->lock);
+
+    return &future->result;
+}
+
+/* ==================== 同步便捷接口 ==================== */
+
+/**
+ * @brief 提交并等待；引擎未运行（或已停止）时返回false，由调用方走加锁路径
+ */
+static bool engine_execute(EngineOp *op, EngineResult *result)
+{
+    EngineFuture future;
+    engine_future_init(&future);
+    op->future = &future;
+    op->callback = NULL;
+
+    int attempts = 0;
+    while (!engine_submit(op)) {
+        if (!engine_is_running()) {
+            engine_future_destroy(&future);
+            return false;
+        }
+        if (++attempts > ENGINE_SUBMIT_SPIN) {
+            platform_sleep_ms(1);
+        }
+    }
+
+    *result = *engine_future_wait(&future);
+    engine_future_destroy(&future);
+    return true;
+}
+
+static void copy_uuid(char dst[37], const char *src)
+{
+    strncpy(dst, src, 36);
+    dst[36] = '\0';
+}
+
+/**
+ * @brief 加锁路径执行完毕（已解锁）后，sync 复制时等待热备确认
+ */
+static AccountStatus engine_committed(AccountStatus status)
+{
+    replication_wait_commit();
+    return status;
+}
+
+AccountStatus engine_deposit(const char *uuid, LLUINT amount, ACCOUNT *out)
+{
+    if (shard_engine_running()) {
+        return shard_deposit(uuid, amount, out);
+    }
+    if (engine_is_running() && uuid != NULL) {
+        EngineOp op;
+        EngineResult r;
+        memset(&op, 0, sizeof(op));
+        op.type = ENGINE_OP_DEPOSIT;
+        copy_uuid(op.uuid, uuid);
+        op.amount = amount;
+        if (engine_execute(&op, &r)) {
+            if (r.status == ACCOUNT_OK && out != NULL) {
+                *out = r.account;
+            }
+            return r.status;
+        }
+    }
+    return engine_committed(account_apply_deposit(uuid, amount, out));
+}
+
+AccountStatus engine_withdraw(const char *uuid, LLUINT amount, ACCOUNT *out)
+{
+    if (shard_engine_running()) {
+        return shard_withdraw(uuid, amount, out);
+    }
+    if (engine_is_running() && uuid != NULL) {
+        EngineOp op;
+        EngineResult r;
+        memset(&op, 0, sizeof(op));
+        op.type = ENGINE_OP_WITHDRAW;
+        copy_uuid(op.uuid, uuid);
+        op.amount = amount;
+        if (engine_execute(&op, &r)) {
+            if (r.status == ACCOUNT_OK && out != NULL) {
+                *out = r.account;
+            }
+            return r.status;
+        }
+    }
+    return engine_committed(account_apply_withdraw(uuid, amount, out));
+}
+
+AccountStatus engine_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount,
+                              ACCOUNT *out_from, ACCOUNT *out_to)
+{
+    if (shard_engine_running()) {
+        return shard_transfer(uuid_from, uuid_to, amount, out_from, out_to);
+    }
+    if (engine_is_running() && uuid_from != NULL && uuid_to != NULL) {
+        EngineOp op;
+        EngineResult r;
+        memset(&op, 0, sizeof(op));
+        op.type = ENGINE_OP_TRANSFER;
+        copy_uuid(op.uuid, uuid_from);
+        copy_uuid(op.uuid_to, uuid_to);
+        op.amount = amount;
+        if (engine_execute(&op, &r)) {
+            if (r.status == ACCOUNT_OK) {
+                if (out_from != NULL) {
+                    *out_from = r.account;
+                }
+                if (out_to != NULL) {
+                    *out_to = r.account_to;
+                }
+            }
+            return r.status;
+        }
+    }
+    return engine_committed(account_apply_transfer(uuid_from, uuid_to, amount, out_from, out_to));
+}
+
+AccountStatus engine_delete(const char *uuid)
+{
+    if (shard_engine_running()) {
+        return shard_delete(uuid);
+    }
+    if (engine_is_running() && uuid != NULL) {
+        EngineOp op;
+        EngineResult r;
+        memset(&op, 0, sizeof(op));
+        op.type = ENGINE_OP_DELETE;
+        copy_uuid(op.uuid, uuid);
+        if (engine_execute(&op, &r)) {
+            return r.status;
+        }
+    }
+    return engine_committed(account_apply_delete(uuid));
+}
@@ -0,0 +1,733 @@
+/**
+ * @file flusher.c
+ * @brief 后台刷盘与日志（journal）实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/flusher.h>
+#include <lib/engine.h>
+#include <lib/shm_store.h>
+#include <lib/platform.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+ #include <io.h>
+#else
+ #include <unistd.h>
+#endif
+
+/* ==================== 常量配置 ==================== */
+
+#define FLUSHER_DEFAULT_INTERVAL_MS 1000
+#define FLUSHER_DEFAULT_THRESHOLD 256
+#define FLUSHER_JOURNAL_MAGIC 0x4C4E524Au   /* "JRNL" */
+
+/* ==================== 日志记录格式 ==================== */
+
+typedef enum {
+    JOURNAL_PUT = 1,
+    JOURNAL_DELETE = 2
+} JournalType;
+
+/**
+ * @brief 定长日志记录（64字节），PASSWORD/BALANCE 与 .card 文件一样加密存放
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t checksum;            /* 计算时本字段置0 */
+    unsigned char data[sizeof(LLUINT) * 2];
+    char uuid[37];
+    uint8_t type;
+    uint8_t reserved[2];
+} JournalRecord;
+
+_Static_assert(sizeof(JournalRecord) == 64, "JournalRecord must be 64 bytes");
+
+/* ==================== 内部结构 ==================== */
+
+typedef struct {
+    FlusherConfig config;
+    atomic_bool active;           /* journal 模式运行中（save_account 据此路由） */
+    bool thread_started;
+    bool stopping;
+
+    PlatformMutex lock;           /* 保护脏集合、日志文件与统计 */
+    PlatformCond wake;            /* 唤醒刷盘线程 */
+    PlatformMutex io_lock;        /* 写回 .card 与销户删除文件互斥，防止写回旧数据复活已删账户 */
+    PlatformMutex cycle_lock;     /* 同一时刻只进行一轮刷盘 */
+    PlatformThread thread;
+
+    AccountHashTable dirty;       /* 待写回的账户（最新值） */
+    AccountHashTable inflight;    /* 本轮正在写回的账户 */
+    FILE *journal;
+    bool old_journal_exists;      /* journal.old 尚未被检查点清除 */
+    size_t pending_records;       /* journal.log 中尚未被检查点覆盖的记录数 */
+
+    size_t journal_records;
+    size_t flushes;
+    size_t accounts_flushed;
+    size_t flush_errors;
+    uint64_t last_flush_us;
+    uint64_t max_flush_us;
+    uint64_t total_flush_us;
+} Flusher;
+
+static Flusher g_flusher;
+
+/* ==================== 配置 ==================== */
+
+static void flusher_default_config(FlusherConfig *config)
+{
+    config->durability = FLUSHER_DURABILITY_SYNC;
+    config->flush_interval_ms = FLUSHER_DEFAULT_INTERVAL_MS;
+    config->dirty_threshold = FLUSHER_DEFAULT_THRESHOLD;
+    config->journal_fsync = false;
+}
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取刷盘配置
+ */
+bool load_flusher_config(const char *path, FlusherConfig *config)
+{
+    flusher_default_config(config);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(current_section, sizeof(current_section), "%s", p + 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "flusher") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "durability") == 0) {
+            if (strcmp(v, "journal") == 0) {
+                config->durability = FLUSHER_DURABILITY_JOURNAL;
+            } else if (strcmp(v, "sync") == 0) {
+                config->durability = FLUSHER_DURABILITY_SYNC;
+            } else {
+                fprintf(stderr, "警告：engine.conf 中 durability=%s 无效，使用 sync\n", v);
+            }
+        } else if (strcmp(k, "flush_interval_ms") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->flush_interval_ms = (unsigned int)n;
+            }
+        } else if (strcmp(k, "dirty_threshold") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->dirty_threshold = (size_t)n;
+            }
+        } else if (strcmp(k, "journal_fsync") == 0) {
+            config->journal_fsync = (strcmp(v, "true") == 0);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+/* ==================== 日志读写 ==================== */
+
+static uint32_t record_checksum(const JournalRecord *rec)
+{
+    JournalRecord tmp = *rec;
+    tmp.checksum = 0;
+
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    const unsigned char *p = (const unsigned char *)&tmp;
+    for (size_t i = 0; i < sizeof(tmp); i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void record_encode(JournalRecord *rec, JournalType type, const ACCOUNT *acc, const char *uuid)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->magic = FLUSHER_JOURNAL_MAGIC;
+    rec->type = (uint8_t)type;
+    snprintf(rec->uuid, sizeof(rec->uuid), "%s", uuid);
+    if (acc != NULL) {
+        memcpy(rec->data, &acc->PASSWORD, sizeof(LLUINT));
+        memcpy(rec->data + sizeof(LLUINT), &acc->BALANCE, sizeof(LLUINT));
+        xor_encrypt_decrypt(rec->data, sizeof(rec->data));
+    }
+    rec->checksum = record_checksum(rec);
+}
+
+static bool record_valid(const JournalRecord *rec)
+{
+    return rec->magic == FLUSHER_JOURNAL_MAGIC
+        && (rec->type == JOURNAL_PUT || rec->type == JOURNAL_DELETE)
+        && memchr(rec->uuid, '\0', sizeof(rec->uuid)) != NULL
+        && rec->checksum == record_checksum(rec);
+}
+
+static void record_decode(const JournalRecord *rec, ACCOUNT *acc)
+{
+    unsigned char buffer[sizeof(rec->data)];
+    memcpy(buffer, rec->data, sizeof(buffer));
+    xor_encrypt_decrypt(buffer, sizeof(buffer));
+
+    memset(acc, 0, sizeof(*acc));
+    memcpy(acc->UUID, rec->uuid, sizeof(acc->UUID));
+    memcpy(&acc->PASSWORD, buffer, sizeof(LLUINT));
+    memcpy(&acc->BALANCE, buffer + sizeof(LLUINT), sizeof(LLUINT));
+}
+
+/**
+ * @brief 追加一条日志（调用方持有 g_flusher.lock）
+ */
+static bool journal_append(const JournalRecord *rec)
+{
+    if (g_flusher.journal == NULL) {
+        return false;
+    }
+    if (fwrite(rec, sizeof(*rec), 1, g_flusher.journal) != 1 || fflush(g_flusher.journal) != 0) {
+        return false;
+    }
+    if (g_flusher.config.journal_fsync) {
+#ifdef _WIN32
+        _commit(_fileno(g_flusher.journal));
+#else
+        fsync(fileno(g_flusher.journal));
+#endif
+    }
+    g_flusher.journal_records++;
+    g_flusher.pending_records++;
+    return true;
+}
+
+/**
+ * @brief 将 src 的内容追加到 dst 末尾
+ */
+static bool append_file(const char *src, const char *dst)
+{
+    FILE *in = fopen(src, "rb");
+    if (in == NULL) {
+        return errno == ENOENT;
+    }
+    FILE *out = fopen(dst, "ab");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+
+    char buffer[4096];
+    size_t n;
+    bool ok = true;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        if (fwrite(buffer, 1, n, out) != n) {
+            ok = false;
+            break;
+        }
+    }
+    fclose(in);
+    if (fclose(out) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+/**
+ * @brief 开始一轮检查点：journal.log 归入 journal.old，重新打开空的 journal.log
+ * @note 调用方持有 g_flusher.lock
+ */
+static void journal_rotate(void)
+{
+    if (g_flusher.journal != NULL) {
+        fclose(g_flusher.journal);
+        g_flusher.journal = NULL;
+    }
+
+    if (!g_flusher.old_journal_exists) {
+        g_flusher.old_journal_exists = (rename(FLUSHER_JOURNAL_FILE, FLUSHER_JOURNAL_OLD_FILE) == 0);
+    } else {
+        /* 上一轮有账户写回失败，旧日志仍需保留，新记录追加在其后 */
+        append_file(FLUSHER_JOURNAL_FILE, FLUSHER_JOURNAL_OLD_FILE);
+    }
+
+    g_flusher.journal = fopen(FLUSHER_JOURNAL_FILE, "wb");
+    if (g_flusher.journal == NULL) {
+        perror("错误：无法创建日志文件");
+    }
+    g_flusher.pending_records = 0;
+}
+
+/**
+ * @brief 删除 .card 文件，文件尚未写回过时视为成功
+ */
+static bool remove_card_file(const char *uuid)
+{
+    char filename[50];
+    snprintf(filename, sizeof(filename), "Card/%s.card", uuid);
+    if (remove(filename) != 0 && errno != ENOENT) {
+        perror("错误：无法删除账户文件");
+        return false;
+    }
+    return true;
+}
+
+static size_t replay_file(const char *path, bool *ok)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+
+    size_t count = 0;
+    JournalRecord rec;
+    while (fread(&rec, sizeof(rec), 1, file) == 1) {
+        if (!record_valid(&rec)) {
+            fprintf(stderr, "警告：%s 第 %zu 条记录不完整，其后记录已忽略\n", path, count + 1);
+            break;
+        }
+
+        if (rec.type == JOURNAL_PUT) {
+            ACCOUNT acc;
+            record_decode(&rec, &acc);
+            if (!account_write_file(&acc)) {
+                *ok = false;
+                break;
+            }
+            hash_update_account(&acc);
+        } else {
+            if (!remove_card_file(rec.uuid)) {
+                *ok = false;
+                break;
+            }
+            hash_delete_account(rec.uuid);
+        }
+        count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+/**
+ * @brief 回放日志
+ */
+size_t flusher_replay_journal(void)
+{
+    bool ok = true;
+
+    /* journal.old 中的记录早于 journal.log */
+    size_t count = replay_file(FLUSHER_JOURNAL_OLD_FILE, &ok);
+    if (ok) {
+        count += replay_file(FLUSHER_JOURNAL_FILE, &ok);
+    }
+
+    if (ok) {
+        remove(FLUSHER_JOURNAL_OLD_FILE);
+        remove(FLUSHER_JOURNAL_FILE);
+    } else {
+        fprintf(stderr, "错误：日志回放失败，已保留日志文件\n");
+    }
+    return count;
+}
+
+/* ==================== 刷盘 ==================== */
+
+static int cmp_uuid(const void *a, const void *b)
+{
+    return strcmp((const char *)a, (const char *)b);
+}
+
+static void clear_table(AccountHashTable *table)
+{
+    for (size_t i = 0; i < table->size; i++) {
+        AccountNode *node = table->buckets[i];
+        while (node != NULL) {
+            AccountNode *next = node->next;
+            free(node);
+            node = next;
+        }
+        table->buckets[i] = NULL;
+    }
+    table->count = 0;
+}
+
+/**
+ * @brief 执行一轮刷盘：取出脏集合，按UUID排序写回，全部成功后删除旧日志
+ */
+static bool flush_cycle(void)
+{
+    bool ok = true;
+
+    platform_mutex_lock(&g_flusher.cycle_lock);
+
+    platform_mutex_lock(&g_flusher.lock);
+    if (g_flusher.dirty.count == 0 && g_flusher.pending_records == 0 && !g_flusher.old_journal_exists) {
+        platform_mutex_unlock(&g_flusher.lock);
+        platform_mutex_unlock(&g_flusher.cycle_lock);
+        return true;
+    }
+
+    uint64_t start = platform_monotonic_ns();
+
+    /* 脏集合整体移入 inflight，前台随即写入新的空集合 */
+    AccountHashTable swap = g_flusher.inflight;
+    g_flusher.inflight = g_flusher.dirty;
+    g_flusher.dirty = swap;
+    journal_rotate();
+
+    size_t n = g_flusher.inflight.count;
+    char (*uuids)[37] = NULL;
+    if (n > 0) {
+        uuids = malloc(n * sizeof(*uuids));
+        if (uuids == NULL) {
+            /* 内存不足：放回脏集合，下一轮重试（日志仍在 journal.old 中） */
+            swap = g_flusher.dirty;
+            g_flusher.dirty = g_flusher.inflight;
+            g_flusher.inflight = swap;
+            g_flusher.flush_errors++;
+            platform_mutex_unlock(&g_flusher.lock);
+            platform_mutex_unlock(&g_flusher.cycle_lock);
+            return false;
+        }
+        size_t k = 0;
+        for (size_t i = 0; i < g_flusher.inflight.size; i++) {
+            for (AccountNode *node = g_flusher.inflight.buckets[i]; node != NULL; node = node->next) {
+                memcpy(uuids[k++], node->account.UUID, 37);
+            }
+        }
+    }
+    platform_mutex_unlock(&g_flusher.lock);
+
+    /* 按UUID排序写回，目录内的文件访问顺序稳定 */
+    if (n > 1) {
+        qsort(uuids, n, sizeof(uuids[0]), cmp_uuid);
+    }
+
+    size_t written = 0;
+    size_t failed = 0;
+    for (size_t i = 0; i < n; i++) {
+        platform_mutex_lock(&g_flusher.io_lock);
+
+        /* 本轮期间已销户的账户会被移出 inflight */
+        ACCOUNT acc;
+        platform_mutex_lock(&g_flusher.lock);
+        ACCOUNT *cur = account_table_find(&g_flusher.inflight, uuids[i]);
+        bool found = (cur != NULL);
+        if (found) {
+            acc = *cur;
+        }
+        platform_mutex_unlock(&g_flusher.lock);
+
+        if (found) {
+            if (account_write_file(&acc)) {
+                written++;
+            } else {
+                /* 放回脏集合（若期间又被修改则保留更新的值） */
+                platform_mutex_lock(&g_flusher.lock);
+                if (account_table_find(&g_flusher.dirty, acc.UUID) == NULL) {
+                    account_table_insert(&g_flusher.dirty, &acc);
+                }
+                platform_mutex_unlock(&g_flusher.lock);
+                failed++;
+            }
+        }
+
+        platform_mutex_unlock(&g_flusher.io_lock);
+    }
+    free(uuids);
+
+    uint64_t elapsed_us = (platform_monotonic_ns() - start) / 1000;
+
+    platform_mutex_lock(&g_flusher.lock);
+    clear_table(&g_flusher.inflight);
+    if (failed == 0) {
+        /* 检查点完成：journal.old 中的记录均已反映到 .card 文件 */
+        if (remove(FLUSHER_JOURNAL_OLD_FILE) == 0 || errno == ENOENT) {
+            g_flusher.old_journal_exists = false;
+        }
+    } else {
+        ok = false;
+    }
+    g_flusher.flushes++;
+    g_flusher.accounts_flushed += written;
+    g_flusher.flush_errors += failed;
+    g_flusher.last_flush_us = elapsed_us;
+    g_flusher.total_flush_us += elapsed_us;
+    if (elapsed_us > g_flusher.max_flush_us) {
+        g_flusher.max_flush_us = elapsed_us;
+    }
+    platform_mutex_unlock(&g_flusher.lock);
+
+    platform_mutex_unlock(&g_flusher.cycle_lock);
+    return ok;
+}
+
+static void flusher_thread(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        platform_mutex_lock(&g_flusher.lock);
+        if (!g_flusher.stopping && g_flusher.dirty.count < g_flusher.config.dirty_threshold) {
+            platform_cond_timedwait(&g_flusher.wake, &g_flusher.lock, g_flusher.config.flush_interval_ms);
+        }
+        bool stop = g_flusher.stopping;
+        platform_mutex_unlock(&g_flusher.lock);
+
+        flush_cycle();
+        if (stop) {
+            break;
+        }
+    }
+}
+
+/* ==================== 生命周期 ==================== */
+
+bool flusher_start(const FlusherConfig *config)
+{
+    if (config->durability != FLUSHER_DURABILITY_JOURNAL) {
+        return true;
+    }
+    if (atomic_load(&g_flusher.active)) {
+        return false;
+    }
+
+    g_flusher.config = *config;
+    g_flusher.stopping = false;
+    g_flusher.old_journal_exists = false;
+    g_flusher.pending_records = 0;
+    g_flusher.journal_records = 0;
+    g_flusher.flushes = 0;
+    g_flusher.accounts_flushed = 0;
+    g_flusher.flush_errors = 0;
+    g_flusher.last_flush_us = 0;
+    g_flusher.max_flush_us = 0;
+    g_flusher.total_flush_us = 0;
+
+    if (!account_table_init(&g_flusher.dirty)) {
+        return false;
+    }
+    if (!account_table_init(&g_flusher.inflight)) {
+        account_table_cleanup(&g_flusher.dirty);
+        return false;
+    }
+
+    /* 启动前应已回放旧日志，这里从空日志开始 */
+    g_flusher.journal = fopen(FLUSHER_JOURNAL_FILE, "wb");
+    if (g_flusher.journal == NULL) {
+        perror("错误：无法创建日志文件");
+        account_table_cleanup(&g_flusher.inflight);
+        account_table_cleanup(&g_flusher.dirty);
+        return false;
+    }
+
+    platform_mutex_init(&g_flusher.lock);
+    platform_mutex_init(&g_flusher.io_lock);
+    platform_mutex_init(&g_flusher.cycle_lock);
+    platform_cond_init(&g_flusher.wake);
+
+    if (!platform_thread_create(&g_flusher.thread, flusher_thread, NULL)) {
+        fclose(g_flusher.journal);
+        g_flusher.journal = NULL;
+        remove(FLUSHER_JOURNAL_FILE);
+        platform_cond_destroy(&g_flusher.wake);
+        platform_mutex_destroy(&g_flusher.cycle_lock);
+        platform_mutex_destroy(&g_flusher.io_lock);
+        platform_mutex_destroy(&g_flusher.lock);
+        account_table_cleanup(&g_flusher.inflight);
+        account_table_cleanup(&g_flusher.dirty);
+        return false;
+    }
+    g_flusher.thread_started = true;
+    atomic_store(&g_flusher.active, true);
+    return true;
+}
+
+bool init_flusher(void)
+{
+    size_t replayed = flusher_replay_journal();
+    if (replayed > 0) {
+        printf("✓ 日志回放: %zu 条记录\n", replayed);
+    }
+
+    FlusherConfig config;
+    load_flusher_config(ENGINE_CONFIG_FILE, &config);
+    if (config.durability != FLUSHER_DURABILITY_JOURNAL) {
+        return true;
+    }
+
+    /* 共享存储模式下各进程持锁写直达，保证文件与共享表一致 */
+    if (shm_store_active()) {
+        fprintf(stderr, "警告：共享存储模式不使用 journal 持久化，已忽略 durability=journal\n");
+        return true;
+    }
+
+    /* 分片模式下各分片自行批量落盘 */
+    EngineConfig engine_config;
+    load_engine_config(ENGINE_CONFIG_FILE, &engine_config);
+    if (engine_config.mode == ENGINE_MODE_SHARDED) {
+        fprintf(stderr, "警告：分片模式不使用 journal 持久化，已忽略 durability=journal\n");
+        return true;
+    }
+
+    if (!flusher_start(&config)) {
+        fprintf(stderr, "警告：后台刷盘线程启动失败，使用同步写入\n");
+        return false;
+    }
+    printf("✓ 持久化: journal 模式（每 %u ms 或 %zu 个脏账户刷盘）\n",
+           config.flush_interval_ms, config.dirty_threshold);
+    return true;
+}
+
+void cleanup_flusher(void)
+{
+    if (!g_flusher.thread_started) {
+        return;
+    }
+
+    platform_mutex_lock(&g_flusher.lock);
+    g_flusher.stopping = true;
+    platform_cond_signal(&g_flusher.wake);
+    platform_mutex_unlock(&g_flusher.lock);
+    platform_thread_join(g_flusher.thread);
+    g_flusher.thread_started = false;
+
+    /* 此后 save_account 直接写文件；再刷一轮覆盖停止期间的记录 */
+    atomic_store(&g_flusher.active, false);
+    bool ok = flush_cycle();
+
+    if (g_flusher.journal != NULL) {
+        fclose(g_flusher.journal);
+        g_flusher.journal = NULL;
+    }
+    if (ok) {
+        remove(FLUSHER_JOURNAL_FILE);
+    } else {
+        fprintf(stderr, "警告：部分账户未能写回，日志已保留，下次启动时回放\n");
+    }
+
+    platform_cond_destroy(&g_flusher.wake);
+    platform_mutex_destroy(&g_flusher.cycle_lock);
+    platform_mutex_destroy(&g_flusher.io_lock);
+    platform_mutex_destroy(&g_flusher.lock);
+    account_table_cleanup(&g_flusher.inflight);
+    account_table_cleanup(&g_flusher.dirty);
+}
+
+bool flusher_active(void)
+{
+    return atomic_load(&g_flusher.active);
+}
+
+/* ==================== 前台接口 ==================== */
+
+bool flusher_record_put(const ACCOUNT *acc)
+{
+    JournalRecord rec;
+    record_encode(&rec, JOURNAL_PUT, acc, acc->UUID);
+
+    platform_mutex_lock(&g_flusher.lock);
+    if (!journal_append(&rec)) {
+        platform_mutex_unlock(&g_flusher.lock);
+        return false;
+    }
+    bool ok = account_table_insert(&g_flusher.dirty, acc);
+    if (g_flusher.dirty.count >= g_flusher.config.dirty_threshold) {
+        platform_cond_signal(&g_flusher.wake);
+    }
+    platform_mutex_unlock(&g_flusher.lock);
+    return ok;
+}
+
+bool flusher_record_delete(const char *uuid)
+{
+    JournalRecord rec;
+    record_encode(&rec, JOURNAL_DELETE, NULL, uuid);
+
+    platform_mutex_lock(&g_flusher.lock);
+    if (!journal_append(&rec)) {
+        platform_mutex_unlock(&g_flusher.lock);
+        return false;
+    }
+    account_table_delete(&g_flusher.dirty, uuid);
+    account_table_delete(&g_flusher.inflight, uuid);
+    platform_mutex_unlock(&g_flusher.lock);
+
+    /* 等待可能正在写回该账户的刷盘线程写完再删除 */
+    platform_mutex_lock(&g_flusher.io_lock);
+    bool ok = remove_card_file(uuid);
+    platform_mutex_unlock(&g_flusher.io_lock);
+    return ok;
+}
+
+bool flusher_flush_now(void)
+{
+    if (!atomic_load(&g_flusher.active)) {
+        return true;
+    }
+    return flush_cycle();
+}
+
+void flusher_get_stats(FlusherStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!atomic_load(&g_flusher.active)) {
+        return;
+    }
+
+    platform_mutex_lock(&g_flusher.lock);
+    stats->dirty_backlog = g_flusher.dirty.count + g_flusher.inflight.count;
+    stats->journal_records = g_flusher.journal_records;
+    stats->flushes = g_flusher.flushes;
+    stats->accounts_flushed = g_flusher.accounts_flushed;
+    stats->flush_errors = g_flusher.flush_errors;
+    stats->last_flush_us = g_flusher.last_flush_us;
+    stats->max_flush_us = g_flusher.max_flush_us;
+    stats->total_flush_us = g_flusher.total_flush_us;
+    platform_mutex_unlock(&g_flusher.lock);
+}
@@ -11,6 +11,7 @@
 
 /* ==================== 标准库头文件 ==================== */
 #include <stdbool.h>
+#include <time.h>
 #include <lib/ui.h>
 /* 跨平台UUID库 */
 #ifdef _WIN32
@@ -45,6 +46,7 @@ typedef struct account
 typedef struct AccountNode
 {
     ACCOUNT account;              /** 账户数据 */
+    time_t last_access;           /** 最近一次插入或命中的时间（冷热分层用） */
     struct AccountNode *next;     /** 链表下一个节点 */
 } AccountNode;
 
@@ -64,6 +66,22 @@ typedef enum {
     ACCOUNT_SORT_UUID_TIME = 1
 } AccountSortMode;
 
+/**
+ * @brief 账户操作结果
+ */
+typedef enum {
+    ACCOUNT_OK = 0,               /** 成功 */
+    ACCOUNT_ERR_NOT_FOUND,        /** 账户不存在 */
+    ACCOUNT_ERR_INSUFFICIENT,     /** 余额不足 */
+    ACCOUNT_ERR_OVERFLOW,         /** 余额溢出 */
+    ACCOUNT_ERR_HAS_BALANCE,      /** 账户有余额，不能注销 */
+    ACCOUNT_ERR_SAME_ACCOUNT,     /** 不能转账给自己 */
+    ACCOUNT_ERR_INVALID,          /** 参数无效 */
+    ACCOUNT_ERR_IO,               /** 读写账户文件失败 */
+    ACCOUNT_ERR_BUSY,             /** 操作队列已满 */
+    ACCOUNT_ERR_READ_ONLY         /** 热备复制的备节点只读 */
+} AccountStatus;
+
 /* ==================== 系统初始化 ==================== */
 
 /**
@@ -119,6 +137,28 @@ bool hash_update_account(const ACCOUNT *acc);
  */
 bool hash_delete_account(const char *uuid);
 
+/**
+ * @brief 初始化一张独立的 Hash 表（分片等模块各自持有）
+ * @note 以下 account_table_* 不加锁，由调用方保证同一张表只被一个线程访问
+ */
+bool account_table_init(AccountHashTable *table);
+void account_table_cleanup(AccountHashTable *table);
+
+/**
+ * @brief 插入账户，已存在时更新
+ */
+bool account_table_insert(AccountHashTable *table, const ACCOUNT *acc);
+
+/**
+ * @brief 查找账户，未找到返回NULL
+ */
+ACCOUNT* account_table_find(AccountHashTable *table, const char *uuid);
+
+/**
+ * @brief 删除账户，不存在返回false
+ */
+bool account_table_delete(AccountHashTable *table, const char *uuid);
+
 /* ==================== UUID生成 ==================== */
 
 /**
@@ -127,6 +167,19 @@ bool hash_delete_account(const char *uuid);
  */
 void generate_uuid_string(char *uuid_str);
 
+/**
+ * @brief 把小写规范格式（8-4-4-4-12）的UUID转为16字节二进制形式
+ * @return 其他格式返回false
+ * @note 小写十六进制与短横线位置固定，字符串顺序与字节顺序一致
+ */
+bool uuid_to_bytes(const char *uuid_str, unsigned char key[16]);
+
+/**
+ * @brief 把16字节二进制形式转回小写规范格式的UUID字符串
+ * @param uuid_str 输出缓冲区，至少37字节
+ */
+void uuid_from_bytes(const unsigned char key[16], char *uuid_str);
+
 /* ==================== 密钥管理 ==================== */
 
 /**
@@ -198,6 +251,90 @@ AccountSortMode get_account_sort_mode(void);
  */
 bool delete_account_file(const char *uuid);
 
+/**
+ * @brief 账户文件读写（只访问 Card/<UUID>.card，不经过 Hash 表）
+ * @note 磁盘索引启用时同步更新索引，读取优先查索引（见 disk_index.h）
+ */
+bool account_write_file(const ACCOUNT *acc);
+bool account_read_file(const char *uuid, ACCOUNT *acc);
+bool account_remove_file(const char *uuid);
+
+/**
+ * @brief 开始批量写入（仅对当前线程生效）
+ * @note 批量期间 save_account() 只更新 Hash 表并记录账户，
+ *       account_end_batch() 时每个账户只写一次文件
+ */
+void account_begin_batch(void);
+
+/**
+ * @brief 结束批量写入，把批量期间修改过的账户写入文件
+ * @return 全部写入成功返回true
+ */
+bool account_end_batch(void);
+
+/**
+ * @brief 释放当前线程的批量写入缓冲区（执行过批量写入的线程退出前调用）
+ */
+void account_batch_thread_cleanup(void);
+
+/* ==================== 核心账户操作（非交互） ==================== */
+
+/**
+ * @brief 存款（加锁执行：读取 -> 校验 -> 修改 -> 保存）
+ * @param uuid 账户UUID
+ * @param amount 金额（单位：分），必须大于0
+ * @param out 可选，输出操作后的账户
+ * @return 操作结果
+ */
+AccountStatus account_apply_deposit(const char *uuid, LLUINT amount, ACCOUNT *out);
+
+/**
+ * @brief 取款
+ * @param uuid 账户UUID
+ * @param amount 金额（单位：分），必须大于0
+ * @param out 可选，输出操作后的账户
+ * @return 操作结果
+ */
+AccountStatus account_apply_withdraw(const char *uuid, LLUINT amount, ACCOUNT *out);
+
+/**
+ * @brief 转账
+ * @param uuid_from 转出账户UUID
+ * @param uuid_to 转入账户UUID
+ * @param amount 金额（单位：分），必须大于0
+ * @param out_from 可选，输出操作后的转出账户
+ * @param out_to 可选，输出操作后的转入账户
+ * @return 操作结果
+ */
+AccountStatus account_apply_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount,
+                                     ACCOUNT *out_from, ACCOUNT *out_to);
+
+/**
+ * @brief 销户（余额必须为0）
+ * @param uuid 账户UUID
+ * @return 操作结果
+ */
+AccountStatus account_apply_delete(const char *uuid);
+
+/**
+ * @brief 写入整条账户记录（热备复制的备节点应用主节点的变更）
+ * @param acc 账户，不存在时创建
+ * @return 操作结果
+ */
+AccountStatus account_apply_put(const ACCOUNT *acc);
+
+/**
+ * @brief 删除账户，不检查余额（热备复制的备节点应用主节点的变更）
+ * @param uuid 账户UUID
+ * @return 操作结果，账户不存在返回 ACCOUNT_ERR_NOT_FOUND
+ */
+AccountStatus account_apply_remove(const char *uuid);
+
+/**
+ * @brief 获取操作结果的中文描述
+ */
+const char* account_status_string(AccountStatus status);
+
 /* ==================== 业务功能 ==================== */
 
 /**
@@ -234,10 +371,20 @@ bool delete_account(void);
 /**
  * @brief 同步所有本地账户到服务器
  * @return 成功同步的账户数量
- * @note 仅在服务器模式下有效
+ * @note 仅在服务器模式下有效；sync.state 中有同一服务器的水位时
+ *       只推送 .card 文件在上次同步后修改过的账户。之前调用过
+ *       account_sync_begin() 时推送其快照
  */
 int sync_all_accounts_to_server(void);
 
+/**
+ * @brief 取好推送快照并开始记录交易修改的账户
+ * @return 服务器模式下取到快照返回true
+ * @note 返回后交易可以与推送、拉取同时进行（服务器一侧须经同步队列在拉取后送达），
+ *       pull_accounts_from_server() 跳过这些账户并结束记录
+ */
+bool account_sync_begin(void);
+
 /**
  * @brief 获取所有本地账户的UUID列表
  * @param uuids 输出UUID数组
@@ -246,13 +393,65 @@ int sync_all_accounts_to_server(void);
  */
 int get_all_account_uuids(char uuids[][37], int max_count);
 
+/**
+ * @brief 复制当前全部账户的内存状态
+ * @param out 输出数组
+ * @param max_count 最大数量
+ * @param truncated 账户数超过 max_count 时置true，可为NULL
+ * @return 复制的账户数量
+ * @note 默认模式下直接在锁内复制 Hash 表；分片或共享存储模式下按文件列表逐个读取
+ */
+size_t account_collect_all(ACCOUNT *out, size_t max_count, bool *truncated);
+
+/* ==================== 冷热分层 ==================== */
+
+/**
+ * @brief 冷段写入回调
+ * @param accounts 待移出热层的账户，回调把成功写入冷段的账户原地压缩到数组前部
+ * @return 写入冷段的账户数，失败返回0
+ */
+typedef size_t (*AccountEvictFunc)(ACCOUNT *accounts, size_t count, void *user);
+
+/**
+ * @brief 把最近访问时间不晚于 idle_before 的账户移出热层
+ * @note 持账户锁收集账户并调用 persist，写入冷段的账户随后删除 .card 文件与 Hash 表节点
+ * @return 移出的账户数
+ */
+size_t account_evict_idle(time_t idle_before, AccountEvictFunc persist, void *user);
+
+/**
+ * @brief 统计热层（全局 Hash 表）的账户数与常驻内存字节数
+ */
+void account_hot_usage(size_t *count, size_t *bytes);
+
 /**
  * @brief 从服务器拉取账户并保存到本地
  * @return 成功拉取并保存的账户数量
- * @note 仅在服务器模式下有效，会覆盖本地同UUID账户
+ * @note 仅在服务器模式下有效，会覆盖本地同UUID账户（account_sync_begin() 之后
+ *       有交易的账户除外）；有水位时只拉取服务器上此后修改过的账户，
+ *       全部成功后把新水位写入 sync.state
  */
 int pull_accounts_from_server(void);
 
+/**
+ * @brief 推送与拉取的进度
+ */
+typedef struct {
+    size_t push_done;       /**< 已有结果的推送账户数 */
+    size_t push_total;      /**< 本次推送的账户数 */
+    size_t pulled;          /**< 已保存的拉取账户数 */
+} SyncProgress;
+
+/**
+ * @brief 推送与拉取是否打印进度与结果（后台同步时界面已显示，设为不打印）
+ */
+void account_sync_set_quiet(bool quiet);
+
+/**
+ * @brief 获取推送与拉取的进度，可在任意线程调用
+ */
+void account_sync_get_progress(SyncProgress *progress);
+
 /**
  * @brief 生成测试账户
  * @note  测试系统性能
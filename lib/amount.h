@@ -0,0 +1,78 @@
+/**
+ * @file amount.h
+ * @brief 金额解析模块头文件（十进制字符串 <-> 分）
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef AMOUNT_H
+#define AMOUNT_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <lib/account.h>
+
+/* ==================== 宏定义 ==================== */
+
+/** @brief 金额字符串最大长度（ULLONG_MAX 分 = 184467440737095516.15，21字符+'\0'） */
+#define AMOUNT_STR_MAX 32
+
+/* ==================== 枚举定义 ==================== */
+
+/**
+ * @brief 金额解析结果
+ */
+typedef enum {
+    AMOUNT_OK = 0,            /**< 解析成功 */
+    AMOUNT_ERR_EMPTY,         /**< 输入为空（或只有空白） */
+    AMOUNT_ERR_FORMAT,        /**< 含有非法字符（负号、指数、多个小数点等） */
+    AMOUNT_ERR_PRECISION,     /**< 小数部分超过两位且不为0（不做舍入） */
+    AMOUNT_ERR_OVERFLOW       /**< 超出 ULLONG_MAX 分 */
+} AmountParseResult;
+
+/* ==================== 函数声明 ==================== */
+
+/**
+ * @brief 将十进制金额字符串（单位：元）精确解析为分
+ * @param buf 输入字节区间起始地址（不要求'\0'结尾）
+ * @param len 字节数
+ * @param out_cents 输出金额（单位：分），失败时不修改
+ * @return 解析结果
+ * @note 不依赖locale和stdio；允许首尾空白、可选'+'号、最多两位有效小数，
+ *       例如 "0.29" -> 29，"12." -> 1200，".5" -> 50，"1.500" -> 150
+ */
+AmountParseResult parse_amount_cents(const char *buf, size_t len, LLUINT *out_cents);
+
+/**
+ * @brief 解析以分为单位的金额字符串（服务器响应中的余额等），规则与 parse_amount_cents() 相同
+ * @note 小数部分只允许为0，例如 "1234" -> 1234，"12.00" -> 12，"12.5" 返回 AMOUNT_ERR_PRECISION
+ */
+AmountParseResult parse_cents_value(const char *buf, size_t len, LLUINT *out_cents);
+
+/**
+ * @brief 将分格式化为 "元.角分" 字符串
+ * @param cents 金额（单位：分）
+ * @param buf 输出缓冲区，建议 AMOUNT_STR_MAX 字节
+ * @param buf_size 缓冲区大小
+ * @return 写入的字符数（不含'\0'），缓冲区不足返回0
+ */
+size_t format_amount_cents(LLUINT cents, char *buf, size_t buf_size);
+
+/**
+ * @brief 获取解析结果的中文描述
+ * @param result 解析结果
+ * @return 描述字符串（静态存储）
+ */
+const char* amount_parse_error_string(AmountParseResult result);
+
+/**
+ * @brief 从标准输入读取一个金额（单位：元）并转换为分
+ * @param out_cents 输出金额（单位：分）
+ * @return 解析结果，读取失败返回 AMOUNT_ERR_EMPTY
+ * @note 与其他菜单输入一致按空白分隔读取，行尾的'\n'留在stdin中
+ */
+AmountParseResult read_amount_cents(LLUINT *out_cents);
+
+#endif /* AMOUNT_H */
@@ -0,0 +1,148 @@
+/**
+ * @file async_ops.h
+ * @brief 异步账户操作接口头文件
+ *
+ * 每个操作提交后立即返回一个完成句柄（AsyncOp），调用方可轮询状态、阻塞等待
+ * 或注册回调。操作分两个阶段在后台执行：
+ *   1. 本地执行：单写线程运行时直接提交到引擎队列（不等待，可流水线批量落盘），
+ *      否则由本地执行线程调用 engine_deposit() 等接口
+ *   2. 远程同步：服务器模式下本地成功后，由同步线程追加到持久化同步队列（outbox.h），
+ *      由队列的发送线程重试到成功；队列未启用时直接调用 api_deposit() 等接口
+ *
+ * 两个执行线程都按提交顺序处理，因此同一调用方提交的操作按提交顺序在本地生效、
+ * 按相同顺序同步到服务器。UI 可在本地完成后立即显示结果，同步在后台进行。
+ *
+ * 句柄由提交方持有一个引用，用完须调用 async_op_release()。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef ASYNC_OPS_H
+#define ASYNC_OPS_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <lib/account.h>
+#include <lib/engine.h>
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 操作所处阶段
+ */
+typedef enum {
+    ASYNC_OP_PENDING = 0,         /**< 等待本地执行 */
+    ASYNC_OP_SYNC_PENDING,        /**< 本地已完成，等待同步到服务器 */
+    ASYNC_OP_DONE                 /**< 全部完成 */
+} AsyncOpState;
+
+/**
+ * @brief 远程同步结果
+ */
+typedef enum {
+    ASYNC_SYNC_NOT_REQUIRED = 0,  /**< 非服务器模式或本地执行失败，无需同步 */
+    ASYNC_SYNC_WAITING,           /**< 尚未同步 */
+    ASYNC_SYNC_OK,                /**< 同步成功 */
+    ASYNC_SYNC_FAILED,            /**< 同步失败（本地结果保留） */
+    ASYNC_SYNC_QUEUED             /**< 已写入持久化同步队列，由队列发送线程送达 */
+} AsyncSyncStatus;
+
+/**
+ * @brief 操作结果
+ */
+typedef struct {
+    EngineOpType type;
+    AccountStatus status;         /**< 本地执行结果 */
+    ACCOUNT account;              /**< 操作后的账户（转账时为转出账户） */
+    ACCOUNT account_to;           /**< 转账时的转入账户 */
+    AsyncSyncStatus sync;         /**< 远程同步结果 */
+} AsyncResult;
+
+/** @brief 完整句柄（不透明） */
+typedef struct AsyncOp AsyncOp;
+
+/** @brief 完成回调（在后台线程中、操作全部完成后调用一次，不应阻塞） */
+typedef void (*AsyncCallback)(const AsyncResult *result, void *user);
+
+/**
+ * @brief 远程同步函数，返回true表示同步成功
+ */
+typedef bool (*AsyncSyncFunc)(EngineOpType type, const char *uuid, const char *uuid_to,
+                              LLUINT amount);
+
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    size_t submitted;             /**< 已提交的操作数 */
+    size_t in_flight;             /**< 尚未全部完成的操作数 */
+    size_t pending_sync;          /**< 本地已完成、等待同步的操作数 */
+    size_t completed;             /**< 已全部完成的操作数 */
+    size_t sync_failed;           /**< 同步失败的操作数 */
+} AsyncStats;
+
+/* ==================== 生命周期 ==================== */
+
+/**
+ * @brief 启动本地执行线程与同步线程（同步使用服务器接口，仅服务器模式下同步）
+ * @note 须在 init_engine() 之后调用
+ */
+bool init_async_ops(void);
+
+/**
+ * @brief 以指定同步函数启动
+ * @param sync_func 为NULL时使用同步队列（未启用时直接调用服务器接口）；
+ *        非NULL时每个本地成功的操作都会同步
+ */
+bool async_start(AsyncSyncFunc sync_func);
+
+/**
+ * @brief 执行完所有已提交的操作（含同步）后停止后台线程
+ * @note 须在 cleanup_engine() 之前调用
+ */
+void cleanup_async_ops(void);
+
+bool async_ops_active(void);
+
+void async_get_stats(AsyncStats *stats);
+
+/* ==================== 提交 ==================== */
+
+/**
+ * @brief 提交存款
+ * @param callback 可为NULL
+ * @return 句柄；未启动或内存不足返回NULL
+ */
+AsyncOp* async_deposit(const char *uuid, LLUINT amount, AsyncCallback callback, void *user);
+
+AsyncOp* async_withdraw(const char *uuid, LLUINT amount, AsyncCallback callback, void *user);
+
+AsyncOp* async_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount,
+                        AsyncCallback callback, void *user);
+
+AsyncOp* async_delete(const char *uuid, AsyncCallback callback, void *user);
+
+/* ==================== 轮询与等待 ==================== */
+
+AsyncOpState async_op_state(AsyncOp *op);
+
+/**
+ * @brief 等待本地执行完成
+ * @param out 输出当前结果（sync 可能仍为 ASYNC_SYNC_WAITING），可为NULL
+ */
+void async_op_wait(AsyncOp *op, AsyncResult *out);
+
+/**
+ * @brief 等待全部完成（含远程同步）
+ */
+void async_op_wait_synced(AsyncOp *op, AsyncResult *out);
+
+/**
+ * @brief 释放提交方持有的引用（操作仍会在后台执行完）
+ */
+void async_op_release(AsyncOp *op);
+
+#endif /* ASYNC_OPS_H */
@@ -0,0 +1,156 @@
+/**
+ * @file breaker.h
+ * @brief 服务器请求熔断与自适应超时头文件
+ *
+ * 服务器中途宕机或卡死时，每个请求都要等满配置的超时才失败，界面反复停顿。
+ * 熔断器按最近一组请求的错误率在三种状态间切换：
+ *   - 闭合：正常放行，记录每次请求的结果
+ *   - 断开：错误率达到阈值后进入，请求直接失败（不等超时），open_ms 后转为半开
+ *   - 半开：只放行一个探测请求，成功则闭合，失败则重新断开且等待时间加倍；
+ *     只有探测请求（breaker_allow() 给出 probe 标记）的结果决定半开之后的状态，
+ *     闭合时放行、半开时才结束的请求不算作探测结果
+ * 超时不再固定：记录最近成功请求的总耗时与建立连接的耗时，各取 p99 乘以
+ * BREAKER_TIMEOUT_FACTOR 作为总超时与连接超时，限制在 [min_timeout_ms, 配置上限] 内；
+ * 样本不足或非闭合状态时使用配置上限。
+ *
+ * 时间由调用方传入（platform_monotonic_ns()），便于测试。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef BREAKER_H
+#define BREAKER_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lib/platform.h>
+
+/* ==================== 宏定义 ==================== */
+
+#define BREAKER_MAX_WINDOW 256         /**< 计算错误率的最大窗口 */
+#define BREAKER_LATENCY_SAMPLES 128    /**< 保留的延迟样本数 */
+#define BREAKER_MIN_SAMPLES 20         /**< 样本达到该数量才按延迟调整超时 */
+#define BREAKER_TIMEOUT_FACTOR 4       /**< 超时 = p99 * 该倍数 */
+#define BREAKER_MAX_OPEN_MS 60000      /**< 探测连续失败时断开时间加倍的上限 */
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 熔断状态
+ */
+typedef enum {
+    BREAKER_CLOSED,       /**< 闭合，正常放行 */
+    BREAKER_OPEN,         /**< 断开，请求直接失败 */
+    BREAKER_HALF_OPEN     /**< 半开，放行一个探测请求 */
+} BreakerState;
+
+/**
+ * @brief 熔断与超时配置
+ */
+typedef struct {
+    bool enabled;                  /**< 为false时总是放行，只调整超时 */
+    bool adaptive;                 /**< 为false时超时固定为上限 */
+    size_t window;                 /**< 按最近多少次请求计算错误率 */
+    size_t min_requests;           /**< 窗口内请求数达到该值才可能断开 */
+    unsigned failure_percent;      /**< 错误率达到该百分比时断开 */
+    uint64_t open_ms;              /**< 断开后多久转为半开 */
+    uint64_t timeout_ms;           /**< 总超时上限，0 表示不限 */
+    uint64_t connect_timeout_ms;   /**< 连接超时上限，0 表示不限 */
+    uint64_t min_timeout_ms;       /**< 自适应超时的下限 */
+} BreakerConfig;
+
+/**
+ * @brief 熔断统计
+ */
+typedef struct {
+    BreakerState state;
+    size_t window_requests;        /**< 窗口内的请求数 */
+    size_t window_failures;        /**< 窗口内的失败数 */
+    uint64_t rejected;             /**< 断开期间直接失败的请求数 */
+    uint64_t opened;               /**< 断开次数 */
+    uint64_t retry_in_ms;          /**< 断开时距转为半开的剩余时间 */
+    uint64_t timeout_ms;           /**< 当前总超时 */
+    uint64_t connect_timeout_ms;   /**< 当前连接超时 */
+    uint64_t latency_p99_us;       /**< 成功请求总耗时的 p99，样本不足时为0 */
+    uint64_t connect_p99_us;       /**< 建立连接耗时的 p99，样本不足时为0 */
+} BreakerStats;
+
+/**
+ * @brief 熔断器（各字段受 lock 保护）
+ */
+typedef struct {
+    PlatformMutex lock;
+    BreakerConfig config;
+    BreakerState state;
+    uint8_t outcomes[BREAKER_MAX_WINDOW];     /**< 环形窗口，1 表示失败 */
+    size_t outcome_pos;
+    size_t outcome_count;
+    size_t failures;
+    uint64_t open_until_ns;
+    uint64_t open_ms;                         /**< 本次断开的时长，探测失败时加倍 */
+    bool probe_in_flight;
+    uint32_t latency_us[BREAKER_LATENCY_SAMPLES];
+    size_t latency_pos;
+    size_t latency_count;
+    uint32_t connect_us[BREAKER_LATENCY_SAMPLES];
+    size_t connect_pos;
+    size_t connect_count;
+    uint64_t latency_p99_us;
+    uint64_t connect_p99_us;
+    uint64_t rejected;
+    uint64_t opened;
+} CircuitBreaker;
+
+/* ==================== 函数声明 ==================== */
+
+/**
+ * @brief 初始化熔断器（闭合状态）
+ * @note window 超过 BREAKER_MAX_WINDOW 时截断，min_requests 大于 window 时改为 window
+ */
+void breaker_init(CircuitBreaker *cb, const BreakerConfig *config);
+
+void breaker_destroy(CircuitBreaker *cb);
+
+/**
+ * @brief 请求前调用，是否放行
+ * @param probe 输出：本次放行的是否为半开状态的探测请求，结束时原样传给
+ *        breaker_record() 或 breaker_cancel()
+ * @return 断开时，或半开且探测请求已在进行时返回false（计入 rejected）
+ * @note 放行后须以 breaker_record() 或 breaker_cancel() 结束
+ */
+bool breaker_allow(CircuitBreaker *cb, uint64_t now_ns, bool *probe);
+
+/**
+ * @brief 记录一次放行请求的结果
+ * @param probe breaker_allow() 给出的探测标记；半开状态下只接受探测请求的结果
+ * @param ok 服务器是否正常响应（业务上的拒绝也算正常）；连接失败、超时、429/5xx 为false
+ */
+void breaker_record(CircuitBreaker *cb, bool probe, bool ok, uint64_t now_ns);
+
+/**
+ * @brief 放行后请求未发出（本地错误），不计入结果
+ * @param probe breaker_allow() 给出的探测标记，为true时允许放行下一个探测请求
+ */
+void breaker_cancel(CircuitBreaker *cb, bool probe);
+
+/**
+ * @brief 记录延迟样本
+ * @param total_us 成功请求的总耗时，0 表示不记录
+ * @param connect_us 建立连接（含 TLS 握手）的耗时，复用连接时为0，不记录
+ */
+void breaker_observe(CircuitBreaker *cb, uint64_t total_us, uint64_t connect_us);
+
+/**
+ * @brief 获取当前应使用的总超时与连接超时（毫秒，0 表示不限）
+ */
+void breaker_timeouts(CircuitBreaker *cb, uint64_t *timeout_ms, uint64_t *connect_timeout_ms);
+
+void breaker_get_stats(CircuitBreaker *cb, uint64_t now_ns, BreakerStats *stats);
+
+const char* breaker_state_string(BreakerState state);
+
+#endif /* BREAKER_H */
@@ -0,0 +1,137 @@
+/**
+ * @file compact_store.h
+ * @brief 紧凑内存账户表头文件
+ *
+ * 账户数量很大（千万级）时，每个账户一个 AccountNode 的 Hash 表占用过多内存。
+ * 紧凑表把账户按16字节二进制 UUID 排序后分块编码：
+ *   - 块内第一个 UUID 完整保存，之后每个 UUID 只保存与前一个不同的后缀（前缀压缩）
+ *   - 密码按 varint 编码；余额以块内最小值为基准，保存 varint(余额 - 基准)
+ *   - 稀疏索引为每块保存首个 UUID 与块偏移，查找时二分索引后只解码一个块
+ *
+ * 修改先写入一个小的可变增量表（Hash 表 + 删除标记），增量达到 merge_threshold
+ * 后与基础块归并重建。非规范格式的 UUID 始终留在增量表中。
+ *
+ * 所有接口内部加锁，可多线程调用。
+ *
+ * 启用后（engine.conf 的 [compact] enabled=true）由 init_compact_store() 把全局
+ * Hash 表中的账户迁入全局紧凑表，此后 hash_insert_account() 等接口改用紧凑表，
+ * hash_find_account() 返回NULL（请使用 load_account()）。冷热分层不支持该模式。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef COMPACT_STORE_H
+#define COMPACT_STORE_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lib/account.h>
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 紧凑表配置（engine.conf 的 [compact] 节）
+ */
+typedef struct {
+    bool enabled;
+    size_t block_size;            /**< 每块账户数 */
+    size_t merge_threshold;       /**< 增量表达到该条数后归并 */
+} CompactStoreConfig;
+
+/**
+ * @brief 紧凑表统计
+ */
+typedef struct {
+    size_t count;                 /**< 账户数 */
+    size_t base_count;            /**< 基础块中的账户数（含已删除未归并的） */
+    size_t blocks;                /**< 基础块数 */
+    size_t base_bytes;            /**< 基础块字节数 */
+    size_t index_bytes;           /**< 稀疏索引字节数 */
+    size_t delta_count;           /**< 增量表中的写入数 */
+    size_t deleted_count;         /**< 增量表中的删除标记数 */
+    size_t delta_bytes;           /**< 增量表占用字节数 */
+    size_t merges;                /**< 归并次数 */
+    uint64_t last_merge_us;       /**< 最近一次归并耗时（微秒） */
+} CompactStoreStats;
+
+/** @brief 紧凑表（不透明） */
+typedef struct CompactStore CompactStore;
+
+/* ==================== 紧凑表 ==================== */
+
+/**
+ * @brief 创建空的紧凑表
+ * @return 内存不足返回NULL
+ */
+CompactStore* compact_store_create(size_t block_size, size_t merge_threshold);
+
+void compact_store_destroy(CompactStore *store);
+
+/**
+ * @brief 用一批账户重建基础块（清空原有内容）
+ * @param accounts 会被原地排序
+ */
+bool compact_store_build(CompactStore *store, ACCOUNT *accounts, size_t count);
+
+bool compact_store_get(CompactStore *store, const char *uuid, ACCOUNT *out);
+
+/**
+ * @brief 插入或更新账户
+ */
+bool compact_store_put(CompactStore *store, const ACCOUNT *acc);
+
+/**
+ * @brief 删除账户，不存在返回false
+ */
+bool compact_store_remove(CompactStore *store, const char *uuid);
+
+/**
+ * @brief 立即把增量表归并进基础块
+ */
+bool compact_store_merge(CompactStore *store);
+
+/**
+ * @brief 按 UUID 顺序复制账户（增量表中非规范格式的 UUID 排在最后）
+ * @return 复制的数量，账户数超过 max_count 时只复制前 max_count 个
+ */
+size_t compact_store_collect(CompactStore *store, ACCOUNT *out, size_t max_count);
+
+void compact_store_get_stats(CompactStore *store, CompactStoreStats *stats);
+
+/**
+ * @brief 紧凑表常驻内存字节数（基础块、索引与增量表）
+ */
+size_t compact_store_memory_bytes(const CompactStoreStats *stats);
+
+/* ==================== 全局账户表 ==================== */
+
+bool load_compact_config(const char *path, CompactStoreConfig *config);
+
+/**
+ * @brief 按 engine.conf 把全局 Hash 表迁入紧凑表（默认不启用）
+ * @note 须在 init_account_system() 之后、其他存储模块之前调用
+ */
+bool init_compact_store(void);
+
+/**
+ * @brief 以指定配置迁入
+ */
+bool compact_store_enable(const CompactStoreConfig *config);
+
+/**
+ * @brief 释放全局紧凑表，此后 hash_* 接口恢复使用 Hash 表（账户从 .card 文件按需载入）
+ */
+void cleanup_compact_store(void);
+
+bool compact_store_active(void);
+
+/**
+ * @brief 全局紧凑表，未启用时返回NULL
+ */
+CompactStore* compact_store_global(void);
+
+#endif /* COMPACT_STORE_H */
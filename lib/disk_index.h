@@ -0,0 +1,152 @@
+/**
+ * @file disk_index.h
+ * @brief 持久化磁盘账户索引头文件
+ *
+ * 默认启动时把 Card 目录下全部 .card 文件读入 Hash 表，账户很多时启动很慢。
+ * 启用磁盘索引（engine.conf 的 [disk_index] enabled=true）后，账户数据同时保存在
+ * 一个线性哈希（linear hashing）页文件中，启动时不再读取任何 .card 文件，
+ * load_account() 未命中 Hash 表时读取一个桶页（通常 1 次页读取，溢出时 2 次）。
+ *
+ * 文件布局（小端，页大小 DISK_INDEX_PAGE_SIZE）：
+ *   索引文件（默认 Card/accounts.idx）：第 0 页为 DiskIndexHeader，第 1+b 页为桶 b 的主页
+ *   溢出文件（索引文件名 + ".ovf"）：第 k-1 页为编号 k 的溢出页
+ *   每页：uint32 条数、uint32 下一溢出页编号（0 表示无），之后为 DiskIndexEntry 数组
+ * 条目保存16字节二进制 UUID 与 .card 文件中同样加密的密码、余额，
+ * 索引本身就是记录位置，读取账户无需再打开 .card 文件。
+ *
+ * 桶数按 initial_buckets << level 再加 split 计算；平均装填超过阈值时分裂第 split 号桶。
+ * 页经固定大小的缓冲池（clock 淘汰）读写，脏页在淘汰与关闭时写回。
+ *
+ * 崩溃一致性：.card 文件始终是权威数据，account_write_file()/account_remove_file()
+ * 先改文件再改索引。打开索引时把文件头 clean 置0并落盘，正常关闭时写回全部脏页、
+ * fsync 后再置1。启动时 clean 为0（上次未正常关闭）、文件缺失或损坏则从 .card 文件重建。
+ * 未启用时删除旧索引文件，避免下次启用时使用过期的索引。
+ *
+ * 同一索引文件只能由一个进程打开（多进程共享存储模式下不启用）。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef DISK_INDEX_H
+#define DISK_INDEX_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lib/account.h>
+
+/* ==================== 宏定义 ==================== */
+
+#define DISK_INDEX_MAGIC 0x58444942u      /**< "BIDX" */
+#define DISK_INDEX_VERSION 1
+#define DISK_INDEX_PAGE_SIZE 4096
+#define DISK_INDEX_PATH_MAX 128
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 索引文件头（第 0 页）
+ */
+typedef struct {
+    uint32_t magic;               /**< DISK_INDEX_MAGIC */
+    uint32_t version;             /**< DISK_INDEX_VERSION */
+    uint32_t page_size;           /**< DISK_INDEX_PAGE_SIZE */
+    uint32_t clean;               /**< 正常关闭为1，打开期间为0 */
+    uint64_t count;               /**< 条目数 */
+    uint32_t initial_buckets;     /**< 初始桶数（2的幂） */
+    uint32_t level;               /**< 已完成的整轮分裂次数 */
+    uint32_t split;               /**< 本轮下一个待分裂的桶 */
+    uint32_t overflow_pages;      /**< 溢出文件已分配的页数 */
+    uint32_t free_overflow;       /**< 空闲溢出页链表头（0 表示无） */
+    uint32_t reserved;
+} DiskIndexHeader;
+
+/**
+ * @brief 索引条目
+ */
+typedef struct {
+    uint8_t key[16];              /**< UUID 的16字节二进制形式 */
+    uint8_t value[16];            /**< 加密的 PASSWORD、BALANCE（与 .card 文件相同） */
+} DiskIndexEntry;
+
+/**
+ * @brief 磁盘索引配置（engine.conf 的 [disk_index] 节）
+ */
+typedef struct {
+    bool enabled;
+    size_t pool_pages;            /**< 缓冲池页数 */
+    char index_file[DISK_INDEX_PATH_MAX];
+} DiskIndexConfig;
+
+/**
+ * @brief 磁盘索引统计
+ */
+typedef struct {
+    size_t count;                 /**< 条目数 */
+    size_t buckets;               /**< 桶数 */
+    size_t overflow_pages;        /**< 溢出页数（含空闲的） */
+    uint64_t file_bytes;          /**< 索引与溢出文件总大小 */
+    size_t pool_pages;            /**< 缓冲池页数 */
+    uint64_t lookups;             /**< 查找次数 */
+    uint64_t page_reads;          /**< 从文件读取的页数 */
+    uint64_t page_writes;         /**< 写回文件的页数 */
+    uint64_t pool_hits;           /**< 缓冲池命中次数 */
+    uint64_t splits;              /**< 桶分裂次数 */
+    bool rebuilt;                 /**< 本次打开时是否从 .card 文件重建 */
+    uint64_t open_us;             /**< 打开（含重建）耗时（微秒） */
+} DiskIndexStats;
+
+/* ==================== 配置与生命周期 ==================== */
+
+bool load_disk_index_config(const char *path, DiskIndexConfig *config);
+
+/**
+ * @brief 按 engine.conf 打开磁盘索引（默认不启用，未启用时删除旧索引文件）
+ * @note 由 init_account_system() 在载入系统密钥后调用，启用后不再预载全部账户
+ */
+bool init_disk_index(void);
+
+/**
+ * @brief 以指定配置打开，索引不可用时从 Card 目录重建
+ */
+bool disk_index_open(const DiskIndexConfig *config);
+
+/**
+ * @brief 写回全部脏页并标记为正常关闭
+ */
+void cleanup_disk_index(void);
+
+bool disk_index_active(void);
+
+void disk_index_get_stats(DiskIndexStats *stats);
+
+/* ==================== 账户模块调用 ==================== */
+
+/**
+ * @brief 按 UUID 查找账户
+ * @note 由 account_read_file() 在打开 .card 文件前调用
+ */
+bool disk_index_get(const char *uuid, ACCOUNT *acc);
+
+/**
+ * @brief 插入或更新账户，未启用时直接返回true
+ * @note 由 account_write_file() 在写入 .card 文件后调用
+ */
+bool disk_index_put(const ACCOUNT *acc);
+
+/**
+ * @brief 删除账户，未启用或不存在时返回true
+ * @note 由 account_remove_file() 在删除 .card 文件后调用
+ */
+bool disk_index_remove(const char *uuid);
+
+/**
+ * @brief 按桶顺序复制索引中的账户
+ * @return 复制的数量，最多 max_count 个
+ */
+size_t disk_index_collect(ACCOUNT *out, size_t max_count);
+
+#endif /* DISK_INDEX_H */
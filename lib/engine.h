@@ -0,0 +1,192 @@
+/**
+ * @file engine.h
+ * @brief 账户操作引擎头文件
+ *
+ * 三种运行方式（engine.conf 的 [engine] mode）：
+ *   - mutex：调用线程直接加 g_account_op_lock 执行（默认，与原行为一致）
+ *   - single_writer：一个专用写线程独占所有账户修改，生产者通过有界无锁
+ *     多生产者单消费者（MPSC）环形队列提交操作描述符，以回调或 future 取得结果；
+ *     写线程每次取出一批操作，批量内同一账户只落盘一次
+ *   - sharded：按UUID哈希分成N个分片，每个分片一个写线程（见 shard.h）
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <lib/account.h>
+#include <lib/platform.h>
+
+/* ==================== 宏定义 ==================== */
+
+/** @brief 引擎配置文件路径 */
+#define ENGINE_CONFIG_FILE "engine.conf"
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 引擎运行方式
+ */
+typedef enum {
+    ENGINE_MODE_MUTEX = 0,        /**< 调用线程加锁直接执行 */
+    ENGINE_MODE_SINGLE_WRITER,    /**< 单写线程 + MPSC 队列 */
+    ENGINE_MODE_SHARDED           /**< 按UUID哈希分片，每分片一个写线程 */
+} EngineMode;
+
+/**
+ * @brief 引擎配置
+ */
+typedef struct {
+    EngineMode mode;              /**< 运行方式 */
+    size_t queue_capacity;        /**< 队列容量（向上取整为2的幂） */
+    size_t max_batch;             /**< 写线程每批最多处理的操作数 */
+    size_t shards;                /**< 分片数（sharded 模式） */
+    bool pin_threads;             /**< 分片写线程是否绑定CPU核心 */
+} EngineConfig;
+
+/**
+ * @brief 操作类型
+ */
+typedef enum {
+    ENGINE_OP_DEPOSIT = 0,
+    ENGINE_OP_WITHDRAW,
+    ENGINE_OP_TRANSFER,
+    ENGINE_OP_DELETE
+} EngineOpType;
+
+/**
+ * @brief 操作结果
+ */
+typedef struct {
+    EngineOpType type;
+    AccountStatus status;
+    ACCOUNT account;              /**< 操作后的账户（转账时为转出账户） */
+    ACCOUNT account_to;           /**< 转账时的转入账户 */
+} EngineResult;
+
+/** @brief 完成回调（在写线程中、本批落盘之后调用，不应阻塞） */
+typedef void (*EngineCallback)(const EngineResult *result, void *user);
+
+/**
+ * @brief 操作的 future，由提交方分配
+ */
+typedef struct {
+    atomic_int done;
+    EngineResult result;
+    PlatformMutex lock;
+    PlatformCond cond;
+} EngineFuture;
+
+/**
+ * @brief 操作描述符
+ */
+typedef struct {
+    EngineOpType type;
+    char uuid[37];                /**< 账户（转账时为转出账户） */
+    char uuid_to[37];             /**< 转账时的转入账户 */
+    LLUINT amount;                /**< 金额（单位：分） */
+    EngineCallback callback;      /**< 可为NULL */
+    void *user;                   /**< 回调参数 */
+    EngineFuture *future;         /**< 可为NULL */
+} EngineOp;
+
+/**
+ * @brief 引擎运行统计
+ */
+typedef struct {
+    size_t submitted;             /**< 成功入队的操作数 */
+    size_t rejected;              /**< 队列已满被拒绝的次数 */
+    size_t applied;               /**< 写线程已执行的操作数 */
+    size_t batches;               /**< 写线程处理的批次数 */
+    size_t max_batch_seen;        /**< 出现过的最大批次 */
+} EngineStats;
+
+/* ==================== 配置与生命周期 ==================== */
+
+/**
+ * @brief 读取引擎配置，文件不存在或字段缺失时使用默认值
+ * @param path 配置文件路径
+ * @param config 输出配置
+ * @return 文件存在并读取返回true，使用默认值返回false
+ */
+bool load_engine_config(const char *path, EngineConfig *config);
+
+/**
+ * @brief 按 engine.conf 初始化引擎（single_writer/sharded 时启动写线程）
+ * @return 成功返回true
+ */
+bool init_engine(void);
+
+/**
+ * @brief 以指定配置启动引擎
+ * @return 成功返回true；mutex 模式直接返回true
+ */
+bool engine_start(const EngineConfig *config);
+
+/**
+ * @brief 停止写线程（先执行完队列中已提交的操作），包括分片写线程
+ */
+void cleanup_engine(void);
+
+/**
+ * @brief 单写线程是否在运行
+ */
+bool engine_is_running(void);
+
+/**
+ * @brief 获取运行统计
+ */
+void engine_get_stats(EngineStats *stats);
+
+/* ==================== 提交与等待 ==================== */
+
+/**
+ * @brief 非阻塞提交操作
+ * @return 入队成功返回true；队列已满或引擎未运行返回false
+ */
+bool engine_submit(const EngineOp *op);
+
+void engine_future_init(EngineFuture *future);
+void engine_future_destroy(EngineFuture *future);
+
+/**
+ * @brief 查询 future 是否已完成
+ */
+bool engine_future_ready(EngineFuture *future);
+
+/**
+ * @brief 等待 future 完成并返回结果
+ */
+const EngineResult* engine_future_wait(EngineFuture *future);
+
+/* ==================== 同步便捷接口 ==================== */
+
+/**
+ * @brief 存款：分片或单写线程运行时提交并等待，否则直接调用 account_apply_deposit()
+ */
+AccountStatus engine_deposit(const char *uuid, LLUINT amount, ACCOUNT *out);
+
+/**
+ * @brief 取款
+ */
+AccountStatus engine_withdraw(const char *uuid, LLUINT amount, ACCOUNT *out);
+
+/**
+ * @brief 转账
+ */
+AccountStatus engine_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount,
+                              ACCOUNT *out_from, ACCOUNT *out_to);
+
+/**
+ * @brief 销户
+ */
+AccountStatus engine_delete(const char *uuid);
+
+#endif /* ENGINE_H */
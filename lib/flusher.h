@@ -0,0 +1,130 @@
+/**
+ * @file flusher.h
+ * @brief 后台刷盘与日志（journal）模块头文件
+ *
+ * 两种持久化方式（engine.conf 的 [flusher] durability）：
+ *   - sync：save_account() 在调用线程上直接写 .card 文件（默认，与原行为一致）
+ *   - journal：前台只更新内存并向 Card/journal.log 追加一条记录即返回，
+ *     账户记入脏集合；后台刷盘线程按间隔或脏账户数阈值，
+ *     将脏账户按UUID排序后批量写回 .card 文件，写完后截断日志（检查点）
+ *
+ * 启动时先回放上次未完成检查点的日志，再开始接受操作。
+ * 分片模式下各分片自行落盘，不经过本模块。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef FLUSHER_H
+#define FLUSHER_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lib/account.h>
+
+/* ==================== 宏定义 ==================== */
+
+/** @brief 当前日志文件 */
+#define FLUSHER_JOURNAL_FILE "Card/journal.log"
+
+/** @brief 正在检查点中的旧日志（检查点完成后删除） */
+#define FLUSHER_JOURNAL_OLD_FILE "Card/journal.old"
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 持久化方式
+ */
+typedef enum {
+    FLUSHER_DURABILITY_SYNC = 0,      /**< 同步写 .card 文件 */
+    FLUSHER_DURABILITY_JOURNAL        /**< 内存更新 + 日志追加，后台批量写回 */
+} FlusherDurability;
+
+/**
+ * @brief 刷盘配置
+ */
+typedef struct {
+    FlusherDurability durability;     /**< 持久化方式 */
+    unsigned int flush_interval_ms;   /**< 刷盘间隔（毫秒） */
+    size_t dirty_threshold;           /**< 脏账户数达到该值时立即刷盘 */
+    bool journal_fsync;               /**< 每条日志追加后是否 fsync（否则只写入操作系统缓冲） */
+} FlusherConfig;
+
+/**
+ * @brief 刷盘运行统计
+ */
+typedef struct {
+    size_t dirty_backlog;             /**< 当前待写回的脏账户数（含正在写回的） */
+    size_t journal_records;           /**< 已追加的日志记录数 */
+    size_t flushes;                   /**< 完成的刷盘批次数 */
+    size_t accounts_flushed;          /**< 已写回的账户数 */
+    size_t flush_errors;              /**< 写回失败的账户数（会在下一批重试） */
+    uint64_t last_flush_us;           /**< 最近一批刷盘耗时（微秒） */
+    uint64_t max_flush_us;            /**< 最长一批刷盘耗时（微秒） */
+    uint64_t total_flush_us;          /**< 刷盘总耗时（微秒） */
+} FlusherStats;
+
+/* ==================== 配置与生命周期 ==================== */
+
+/**
+ * @brief 读取 [flusher] 配置，文件不存在或字段缺失时使用默认值
+ * @return 文件存在并读取返回true，使用默认值返回false
+ */
+bool load_flusher_config(const char *path, FlusherConfig *config);
+
+/**
+ * @brief 回放日志并按 engine.conf 启动刷盘线程
+ * @note 须在 init_account_system() 之后、init_engine() 之前调用
+ */
+bool init_flusher(void);
+
+/**
+ * @brief 以指定配置启动（journal 模式时启动刷盘线程，sync 模式直接返回true）
+ */
+bool flusher_start(const FlusherConfig *config);
+
+/**
+ * @brief 写回全部脏账户并停止刷盘线程
+ */
+void cleanup_flusher(void);
+
+/**
+ * @brief journal 模式是否在运行
+ */
+bool flusher_active(void);
+
+/**
+ * @brief 回放 Card/journal.old 与 Card/journal.log，写回 .card 文件后删除日志
+ * @return 回放的记录数
+ * @note 遇到不完整或校验失败的记录即停止（崩溃时最后一条可能只写了一半）
+ */
+size_t flusher_replay_journal(void);
+
+/* ==================== 前台接口（由 save_account/delete_account_file 调用） ==================== */
+
+/**
+ * @brief 追加账户更新日志并记入脏集合
+ * @return 日志写入失败返回false
+ */
+bool flusher_record_put(const ACCOUNT *acc);
+
+/**
+ * @brief 追加销户日志，移出脏集合并删除 .card 文件
+ */
+bool flusher_record_delete(const char *uuid);
+
+/**
+ * @brief 立即写回全部脏账户（同步完成后返回）
+ * @return 全部写回成功返回true
+ */
+bool flusher_flush_now(void);
+
+/**
+ * @brief 获取运行统计
+ */
+void flusher_get_stats(FlusherStats *stats);
+
+#endif /* FLUSHER_H */
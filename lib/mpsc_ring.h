@@ -0,0 +1,102 @@
+/**
+ * @file mpsc_ring.h
+ * @brief 有界无锁多生产者单消费者（MPSC）环形队列头文件
+ *
+ * 生产者通过 CAS 抢占写位置，每个槽位带序号（Vyukov 有界队列），
+ * 消费者单线程按序取出；队列满时入队立即失败，由调用方决定重试策略。
+ * 另附消费者休眠/唤醒辅助，避免空闲时忙等。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <lib/platform.h>
+
+/* ==================== 宏定义 ==================== */
+
+#define MPSC_RING_CACHE_LINE 64
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief MPSC 环形队列
+ */
+typedef struct {
+    /* 生产者共享，单独占用缓存行 */
+    atomic_size_t enqueue_pos;
+    char pad0[MPSC_RING_CACHE_LINE - sizeof(atomic_size_t)];
+
+    /* 仅消费者访问 */
+    size_t dequeue_pos;
+    char pad1[MPSC_RING_CACHE_LINE - sizeof(size_t)];
+
+    unsigned char *slots;         /**< 槽位数组：序号 + 元素 */
+    size_t slot_size;             /**< 单个槽位字节数 */
+    size_t elem_size;             /**< 元素字节数 */
+    size_t mask;                  /**< 容量-1（容量为2的幂） */
+
+    atomic_bool consumer_sleeping;
+    PlatformMutex wake_lock;
+    PlatformCond wake;
+} MpscRing;
+
+/* ==================== 函数声明 ==================== */
+
+/**
+ * @brief 初始化队列
+ * @param capacity 容量（向上取整为2的幂，最小为2）
+ * @param elem_size 元素字节数
+ * @return 成功返回true，内存不足返回false
+ */
+bool mpsc_ring_init(MpscRing *ring, size_t capacity, size_t elem_size);
+
+void mpsc_ring_destroy(MpscRing *ring);
+
+/**
+ * @brief 获取实际容量
+ */
+size_t mpsc_ring_capacity(const MpscRing *ring);
+
+/**
+ * @brief 入队（多生产者安全，不阻塞）
+ * @return 队列已满返回false
+ * @note 入队成功后应调用 mpsc_ring_notify() 唤醒休眠的消费者
+ */
+bool mpsc_ring_push(MpscRing *ring, const void *elem);
+
+/**
+ * @brief 出队（仅消费者线程调用）
+ * @return 队列为空返回false
+ */
+bool mpsc_ring_pop(MpscRing *ring, void *out);
+
+/**
+ * @brief 队列是否为空（仅消费者线程调用）
+ */
+bool mpsc_ring_empty(MpscRing *ring);
+
+/**
+ * @brief 消费者正在休眠时唤醒它（生产者入队后调用）
+ */
+void mpsc_ring_notify(MpscRing *ring);
+
+/**
+ * @brief 无条件唤醒消费者（用于通知退出）
+ */
+void mpsc_ring_wake(MpscRing *ring);
+
+/**
+ * @brief 消费者在队列为空时休眠，直到有新元素、被唤醒或超时
+ * @param stop 可选，非NULL且为true时不再休眠
+ */
+void mpsc_ring_wait(MpscRing *ring, unsigned int timeout_ms, atomic_bool *stop);
+
+#endif /* MPSC_RING_H */
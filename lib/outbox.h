@@ -0,0 +1,144 @@
+/**
+ * @file outbox.h
+ * @brief 持久化同步队列（outbox）头文件
+ *
+ * 服务器模式下，本地交易成功后不再在界面线程上同步调用 api_deposit() 等接口，
+ * 而是把操作追加到队列文件（默认 Card/outbox.log）后立即返回；
+ * 后台发送线程按追加顺序逐条发送，失败时按指数退避重试，直到服务器执行或明确拒绝。
+ *
+ * 每条操作带唯一的 op_id（队列标识 + 序号），服务器按 op_id 去重，
+ * 超时等无法确定是否已执行的情况可以放心重发。
+ *
+ * 文件：
+ *   队列文件：定长 OutboxRecord 追加写入，带校验和，末尾不完整的记录在启动时丢弃
+ *   状态文件（队列文件名 + ".ack"）：队列标识与已确认的最大序号，先写临时文件再改名
+ * 启动时跳过已确认的记录继续发送；队列清空且文件超过一定大小时截断。
+ *
+ * 合并：发送线程每次取最多 coalesce_max 条积压记录作为一批，同一账户的存取款
+ * 合并为一次净额存款或取款（净额为0则不发送）。转账、创建与销户不合并，
+ * 并作为所涉账户的分界，合并不会跨过它们，因此转账前后各账户的余额与逐条发送一致；
+ * 不同账户之间的存取款互不影响，可以调整先后。批次范围在发送前写入状态文件，
+ * 重启后按同一范围重新合并，op_id 不变。服务器拒绝合并后的操作时，其中的记录一并跳过
+ * （本地已逐笔校验过余额，只有服务器与本地不一致时才会发生）。
+ *
+ * 队列中的操作只在服务器模式下发送；离线期间保留，下次以服务器模式启动时继续。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lib/account.h>
+#include <lib/server_api.h>
+
+/* ==================== 宏定义 ==================== */
+
+#define OUTBOX_PATH_MAX 128
+#define OUTBOX_OP_ID_MAX 64           /**< 与服务器 applied_ops.op_id 的长度一致 */
+#define OUTBOX_COALESCE_LIMIT 256     /**< coalesce_max 的上限 */
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 同步队列配置（engine.conf 的 [outbox] 节）
+ */
+typedef struct {
+    bool enabled;
+    char file[OUTBOX_PATH_MAX];       /**< 队列文件 */
+    bool fsync;                       /**< 每条追加后是否 fsync */
+    unsigned int retry_base_ms;       /**< 第一次重试前的等待 */
+    unsigned int retry_max_ms;        /**< 退避等待的上限 */
+    unsigned int drain_timeout_ms;    /**< 启动与退出时等待队列发完的最长时间 */
+    unsigned int coalesce_max;        /**< 一批最多合并的记录数，1为逐条发送 */
+} OutboxConfig;
+
+/**
+ * @brief 队列中的一条操作
+ */
+typedef struct {
+    uint64_t seq;                     /**< 序号，从1开始递增，不重复使用 */
+    ApiOperation type;
+    char uuid[37];                    /**< 账户（转账时为转出账户） */
+    char uuid_to[37];                 /**< 转账时的转入账户，其余为空串 */
+    LLUINT amount;                    /**< 金额；创建账户时为初始余额 */
+} OutboxEntry;
+
+/**
+ * @brief 发送函数
+ * @param entry 要发送的操作；合并后的存取款 seq 为其中第一条记录的序号
+ * @param op_id 操作的唯一标识，重发同一条时不变
+ */
+typedef ApiSendResult (*OutboxSendFunc)(const OutboxEntry *entry, const char *op_id);
+
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    size_t pending;                   /**< 尚未确认的操作数 */
+    size_t resumed;                   /**< 启动时从队列文件恢复的操作数 */
+    uint64_t appended;                /**< 本次运行追加的操作数 */
+    uint64_t sent;                    /**< 服务器已执行的记录数 */
+    uint64_t rejected;                /**< 服务器拒绝而跳过的记录数 */
+    uint64_t requests;                /**< 服务器已执行或拒绝的请求数 */
+    uint64_t coalesced;               /**< 合并后不再单独发送的记录数 */
+    uint64_t retries;                 /**< 重试次数 */
+    uint64_t compactions;             /**< 队列文件截断次数 */
+    uint64_t file_bytes;              /**< 队列文件大小 */
+    bool backing_off;                 /**< 发送失败，正在退避等待 */
+} OutboxStats;
+
+/* ==================== 配置与生命周期 ==================== */
+
+bool load_outbox_config(const char *path, OutboxConfig *config);
+
+/**
+ * @brief 按 engine.conf 打开队列并启动发送线程，等待上次遗留的操作发完
+ * @return 队列已启动返回true（遗留操作可能未发完，见 outbox_get_stats()）
+ * @note 仅在服务器模式下调用，须在 init_server_api() 之后、启动推送之前调用
+ */
+bool init_outbox(void);
+
+/**
+ * @brief 以指定配置与发送函数启动
+ * @param send 为NULL时使用 api_send_operation()
+ */
+bool outbox_start(const OutboxConfig *config, OutboxSendFunc send);
+
+/**
+ * @brief 等待最多 drain_timeout_ms 让队列发完后停止发送线程，未发完的操作留在文件中
+ */
+void cleanup_outbox(void);
+
+bool outbox_active(void);
+
+void outbox_get_stats(OutboxStats *stats);
+
+/* ==================== 追加与等待 ==================== */
+
+/**
+ * @brief 追加一条操作，写入队列文件后返回
+ * @param uuid_to 转账时的转入账户，其余为NULL
+ * @return 未启动或写入失败返回false
+ */
+bool outbox_append(ApiOperation type, const char *uuid, const char *uuid_to, LLUINT amount);
+
+/**
+ * @brief 暂停或恢复发送，暂停期间追加的操作留在队列中
+ * @note 启动同步推送余额与拉取期间暂停：先送达的交易会被随后推送的余额覆盖
+ */
+void outbox_set_paused(bool paused);
+
+/**
+ * @brief 等待队列发完
+ * @return 超时前队列已空返回true
+ */
+bool outbox_wait_drained(unsigned int timeout_ms);
+
+#endif /* OUTBOX_H */
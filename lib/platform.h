@@ -8,10 +8,98 @@
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+    /* Windows平台必须先包含winsock2.h再包含windows.h */
+    #include <winsock2.h>
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+/* ==================== 线程与同步原语类型 ==================== */
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION PlatformMutex;      /**< 互斥锁 */
+typedef CONDITION_VARIABLE PlatformCond;     /**< 条件变量 */
+typedef HANDLE PlatformThread;               /**< 线程句柄 */
+#else
+typedef pthread_mutex_t PlatformMutex;       /**< 互斥锁 */
+typedef pthread_cond_t PlatformCond;         /**< 条件变量 */
+typedef pthread_t PlatformThread;            /**< 线程句柄 */
+#endif
+
+/** @brief 线程入口函数 */
+typedef void (*PlatformThreadFunc)(void *arg);
+
 /**
  * @brief 初始化平台环境（Windows设置UTF-8，Linux无操作）
  * @return 成功返回0，失败返回-1
  */
 int init_platform(void);
 
+/* ==================== 互斥锁与条件变量 ==================== */
+
+void platform_mutex_init(PlatformMutex *mutex);
+void platform_mutex_destroy(PlatformMutex *mutex);
+void platform_mutex_lock(PlatformMutex *mutex);
+void platform_mutex_unlock(PlatformMutex *mutex);
+
+void platform_cond_init(PlatformCond *cond);
+void platform_cond_destroy(PlatformCond *cond);
+void platform_cond_wait(PlatformCond *cond, PlatformMutex *mutex);
+
+/**
+ * @brief 带超时的条件等待
+ * @param timeout_ms 超时时间（毫秒）
+ * @return 被唤醒返回true，超时返回false（调用者仍需重新检查条件）
+ */
+bool platform_cond_timedwait(PlatformCond *cond, PlatformMutex *mutex, unsigned int timeout_ms);
+
+void platform_cond_signal(PlatformCond *cond);
+void platform_cond_broadcast(PlatformCond *cond);
+
+/* ==================== 线程 ==================== */
+
+/**
+ * @brief 创建线程
+ * @param thread 输出线程句柄
+ * @param func 线程入口函数
+ * @param arg 传给入口函数的参数
+ * @return 成功返回true，失败返回false
+ */
+bool platform_thread_create(PlatformThread *thread, PlatformThreadFunc func, void *arg);
+
+/**
+ * @brief 等待线程结束并释放句柄
+ */
+void platform_thread_join(PlatformThread thread);
+
+/**
+ * @brief 获取在线CPU核心数
+ * @return 核心数（至少为1）
+ */
+int platform_cpu_count(void);
+
+/**
+ * @brief 将线程绑定到指定CPU核心
+ * @param cpu 核心编号（从0开始）
+ * @return 成功返回true；平台不支持或编号无效返回false
+ */
+bool platform_thread_pin(PlatformThread thread, int cpu);
+
+/* ==================== 时间 ==================== */
+
+/**
+ * @brief 单调时钟（纳秒），仅用于计算时间间隔
+ */
+uint64_t platform_monotonic_ns(void);
+
+/**
+ * @brief 休眠指定毫秒数
+ */
+void platform_sleep_ms(unsigned int ms);
+
 #endif /* PLATFORM_H */
@@ -0,0 +1,143 @@
+/**
+ * @file replication.h
+ * @brief 热备复制头文件
+ *
+ * 主节点把每次落盘的账户变更（整条账户记录的写入或删除，带递增序号）
+ * 通过本机 Unix 套接字或 TCP 连接推送给一个备节点进程，备节点写入自己的
+ * Card/ 目录后回复确认。
+ *
+ * 确认方式（engine.conf 的 [replication] ack）：
+ *   - async：操作在本地落盘后立即返回，复制在后台进行
+ *   - sync：操作返回前等待备节点确认（单写线程模式下每批等待一次）；
+ *     备节点未连接或超过 sync_timeout_ms 时不再等待，并计入统计
+ *
+ * 备节点只读：账户操作返回 ACCOUNT_ERR_READ_ONLY。replication_promote()
+ * 停止跟随并开始接受写入，配置了 promote_address 时以主节点身份在该地址监听。
+ *
+ * 备节点连接时报告已应用的序号；主节点保留最近 backlog 条记录，能接上则
+ * 增量续传，否则（落后太多、主节点重启或首次连接）发送全量快照。
+ *
+ * 分片模式不支持复制。仅支持 POSIX 平台。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lib/account.h>
+
+/* ==================== 宏定义 ==================== */
+
+/** @brief 地址最大长度（unix:<路径> 或 tcp:<主机>:<端口>） */
+#define REPLICATION_ADDRESS_MAX 108
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 节点角色
+ */
+typedef enum {
+    REPLICATION_ROLE_NONE = 0,    /**< 不复制 */
+    REPLICATION_ROLE_PRIMARY,     /**< 主节点 */
+    REPLICATION_ROLE_FOLLOWER     /**< 备节点（只读） */
+} ReplicationRole;
+
+/**
+ * @brief 确认方式
+ */
+typedef enum {
+    REPLICATION_ACK_ASYNC = 0,    /**< 不等待备节点 */
+    REPLICATION_ACK_SYNC          /**< 等待备节点确认 */
+} ReplicationAck;
+
+/**
+ * @brief 复制配置（engine.conf 的 [replication] 节）
+ */
+typedef struct {
+    ReplicationRole role;
+    char address[REPLICATION_ADDRESS_MAX];          /**< 主节点监听 / 备节点连接的地址 */
+    char promote_address[REPLICATION_ADDRESS_MAX];  /**< 备节点提升后监听的地址，空表示不监听 */
+    ReplicationAck ack;
+    unsigned int sync_timeout_ms; /**< sync 模式下等待确认的最长时间 */
+    size_t backlog;               /**< 主节点保留的最近记录数 */
+} ReplicationConfig;
+
+/**
+ * @brief 复制统计
+ */
+typedef struct {
+    ReplicationRole role;
+    bool connected;               /**< 是否与对端连接 */
+    uint64_t last_seq;            /**< 主节点：最新序号；备节点：已应用序号 */
+    uint64_t acked_seq;           /**< 主节点：备节点已确认的序号 */
+    uint64_t lag_ops;             /**< 尚未确认（备节点：尚未应用）的记录数 */
+    uint64_t lag_us;              /**< 最早未确认记录距今的时间（微秒） */
+    size_t records;               /**< 主节点：已发送记录数；备节点：已应用记录数 */
+    size_t resyncs;               /**< 全量同步次数 */
+    size_t sync_waits;            /**< sync 模式下的等待次数 */
+    size_t sync_timeouts;         /**< 等待超时或备节点未连接而放弃等待的次数 */
+} ReplicationStats;
+
+/* ==================== 配置与生命周期 ==================== */
+
+/**
+ * @brief 读取 [replication] 配置，文件不存在或字段缺失时使用默认值（不复制）
+ */
+bool load_replication_config(const char *path, ReplicationConfig *config);
+
+/**
+ * @brief 按 engine.conf 启动复制
+ * @note 须在 init_engine() 之后调用
+ */
+bool init_replication(void);
+
+/**
+ * @brief 以指定配置启动（主节点开始监听，备节点开始连接）
+ */
+bool replication_start(const ReplicationConfig *config);
+
+/**
+ * @brief 断开连接并停止复制线程
+ */
+void cleanup_replication(void);
+
+ReplicationRole replication_role(void);
+
+bool replication_is_follower(void);
+
+const char* replication_role_string(ReplicationRole role);
+
+/**
+ * @brief 将备节点提升为主节点
+ * @return 当前不是备节点或提升后监听失败返回false
+ */
+bool replication_promote(void);
+
+void replication_get_stats(ReplicationStats *stats);
+
+/* ==================== 主节点记录 ==================== */
+
+/**
+ * @brief 记录一次账户写入（由 save_account 调用，不阻塞）
+ */
+void replication_record_put(const ACCOUNT *acc);
+
+/**
+ * @brief 记录一次账户删除（由 delete_account_file 调用，不阻塞）
+ */
+void replication_record_delete(const char *uuid);
+
+/**
+ * @brief sync 模式下等待当前线程已记录的变更被备节点确认，其他情况立即返回
+ * @note 在账户锁外调用；单写线程在通知一批操作完成前调用一次
+ */
+void replication_wait_commit(void);
+
+#endif /* REPLICATION_H */
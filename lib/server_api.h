@@ -11,7 +11,9 @@
 
 /* ==================== 标准库头文件 ==================== */
 #include <stdbool.h>
+#include <stdint.h>
 #include <lib/account.h>
+#include <lib/breaker.h>
 
 /* ==================== 枚举定义 ==================== */
 
@@ -32,13 +34,84 @@ typedef enum {
 typedef struct {
     char server_url[256];      /**< 服务器URL地址 */
     int port;                  /**< 服务器端口 */
-    int timeout;               /**< 请求超时时间（秒） */
+    int timeout;               /**< 请求超时时间（秒），自适应超时的上限 */
+    int connect_timeout;       /**< 连接超时时间（秒，含 TLS 握手），自适应连接超时的上限 */
+    bool adaptive_timeout;     /**< 是否按观测到的延迟 p99 缩短超时（见 lib/breaker.h） */
+    bool http2;                /**< 是否协商 HTTP/2，各线程的并发请求在一个连接上多路复用 */
     bool use_https;            /**< 是否使用HTTPS */
     bool verify_cert;          /**< 是否验证服务器证书 */
     char cert_path[256];       /**< CA证书文件路径 */
     char client_id[65];        /**< 客户端唯一标识（SHA256哈希，64字符+\0） */
+    int sync_max_in_flight;    /**< 批量推送时同时进行的请求数 */
+    int sync_max_retries;      /**< 批量推送时单个请求的最多重试次数 */
+    int sync_batch_size;       /**< 批量推送时每个请求的账户数（1 表示逐个推送） */
+    int sync_pull_page_size;   /**< 分页拉取时每页的账户数 */
+    bool compress;             /**< 是否协商压缩请求体与响应体 */
+    int compress_min_bytes;    /**< 请求体达到该字节数才压缩 */
+    bool binary_wire;          /**< 账户接口是否协商二进制编码（见 lib/wire.h） */
+    bool breaker;              /**< 是否启用熔断 */
+    int breaker_window;        /**< 按最近多少次请求计算错误率 */
+    int breaker_min_requests;  /**< 窗口内请求数达到该值才可能熔断 */
+    int breaker_failure_percent;  /**< 错误率达到该百分比时熔断 */
+    int breaker_open_seconds;  /**< 熔断后多久放行一个探测请求 */
 } ServerConfig;
 
+/**
+ * @brief 请求统计
+ */
+typedef struct {
+    uint64_t requests;         /**< 请求次数 */
+    uint64_t failures;         /**< 失败次数 */
+    uint64_t new_connections;  /**< 新建的连接数（其余请求复用 keep-alive 连接） */
+    uint64_t http2_requests;   /**< 经 HTTP/2 完成的请求数 */
+    uint64_t total_us;         /**< 请求累计耗时（微秒） */
+    uint64_t bytes_sent;       /**< 实际发送的请求体字节数（压缩后） */
+    uint64_t bytes_received;   /**< 实际收到的响应体字节数（解压前） */
+    uint64_t body_bytes_received;  /**< 解压后的响应体字节数 */
+    uint64_t allocations;      /**< 本模块、cJSON 与 zlib 的堆分配次数 */
+    uint64_t curl_allocations; /**< libcurl 的堆分配次数 */
+    BreakerStats breaker;      /**< 熔断状态与当前超时 */
+} ServerApiStats;
+
+/**
+ * @brief 批量推送结果
+ */
+typedef struct {
+    size_t total;              /**< 账户数 */
+    size_t succeeded;          /**< 成功数 */
+    size_t failed;             /**< 重试后仍失败的数量 */
+    size_t retries;            /**< 重试次数 */
+    size_t requests;           /**< 发出的请求数（含重试） */
+    size_t batch_size;         /**< 每个请求的账户数 */
+    size_t max_in_flight;      /**< 并发请求数 */
+    uint64_t elapsed_us;       /**< 总耗时（微秒） */
+} SyncBatchStats;
+
+/**
+ * @brief 批量推送进度回调（每完成一个账户调用一次，在调用线程中执行）
+ */
+typedef void (*SyncProgressFunc)(size_t done, size_t total, void *user);
+
+/**
+ * @brief 单个账户操作（持久化同步队列按此重放）
+ */
+typedef enum {
+    API_OP_CREATE = 1,         /**< 创建账户，amount 为初始余额 */
+    API_OP_DEPOSIT,
+    API_OP_WITHDRAW,
+    API_OP_TRANSFER,
+    API_OP_DELETE
+} ApiOperation;
+
+/**
+ * @brief 单个账户操作的发送结果
+ */
+typedef enum {
+    API_SEND_OK = 0,           /**< 服务器已执行（或此前已执行过同一 op_id） */
+    API_SEND_REJECTED,         /**< 服务器拒绝（余额不足、账户不存在等），重发也不会成功 */
+    API_SEND_RETRY             /**< 未连接、连接失败、超时、429/5xx 等，稍后重发 */
+} ApiSendResult;
+
 /* ==================== 初始化与清理 ==================== */
 
 /**
@@ -78,9 +151,18 @@ const ServerConfig* get_server_config(void);
  */
 RunMode check_server_availability(void);
 
+/**
+ * @brief 检测服务器可用性，不切换运行模式
+ * @return 服务器可用返回MODE_SERVER，否则MODE_LOCAL
+ * @note 不打印检测过程与请求错误，供界面已显示后在后台检测；调用方确认可以切换时
+ *       再调用 set_run_mode()
+ */
+RunMode detect_server_availability(void);
+
 /**
  * @brief 获取当前运行模式
  * @return 当前运行模式
+ * @note 可在任意线程调用
  */
 RunMode get_run_mode(void);
 
@@ -98,11 +180,18 @@ void set_run_mode(RunMode mode);
  * @param method HTTP方法（GET/POST/DELETE等）
  * @param json_data 请求体JSON数据（可为NULL）
  * @return 返回响应JSON字符串，需调用者释放；失败返回NULL
- * @note 自动添加认证头和时间戳
+ * @note 自动添加认证头和时间戳；请求结束后句柄与 keep-alive 连接留给后续请求复用，
+ *       各句柄共享 DNS、连接与 TLS 会话缓存，可多线程调用
+ * @note 熔断期间直接返回NULL，不等待超时
  * @warning 调用者需要使用free()释放返回的字符串
  */
 char* server_request(const char *endpoint, const char *method, const char *json_data);
 
+/**
+ * @brief 获取请求统计（未启用网络时全为0）
+ */
+void server_api_get_stats(ServerApiStats *stats);
+
 /* ==================== 安全机制 ==================== */
 
 /**
@@ -179,6 +268,24 @@ bool api_delete_account(const char *uuid);
  */
 bool api_sync_account(const ACCOUNT *acc);
 
+/**
+ * @brief 并发推送一批账户（curl multi 接口）
+ *
+ * 按 server.conf [sync] batch_size 分组，每组一个 /api/accounts/sync_batch 请求，
+ * 服务器在一个事务中写入并返回逐个结果；batch_size=1 时逐个调用 /api/account/sync
+ * （用于不支持批量端点的旧服务器）。
+ * @param accounts 账户数组
+ * @param count 账户数量
+ * @param ok 可为NULL；输出每个账户是否推送成功
+ * @param progress 可为NULL
+ * @param stats 可为NULL
+ * @return 成功推送的数量
+ * @note 同时进行 max_in_flight 个请求；连接失败、超时、HTTP 429 与 5xx
+ *       视为暂时性错误，整组按指数退避最多重试 max_retries 次
+ */
+size_t api_sync_accounts(const ACCOUNT *accounts, size_t count, bool *ok,
+                         SyncProgressFunc progress, void *user, SyncBatchStats *stats);
+
 /**
  * @brief 从服务器拉取所有账户
  * @param accounts 账户数组指针
@@ -188,5 +295,34 @@ bool api_sync_account(const ACCOUNT *acc);
  */
 int api_fetch_all_accounts(ACCOUNT *accounts, int max_count);
 
+/**
+ * @brief 分页拉取回调，每页调用一次
+ * @param accounts 本页账户，只在回调期间有效
+ * @return 返回false时停止拉取
+ */
+typedef bool (*AccountPageFunc)(const ACCOUNT *accounts, size_t count, void *user);
+
+/**
+ * @brief 分页拉取服务器账户（GET /api/accounts?limit=N&after=<uuid>&since=）
+ * @param since 上次拉取返回的水位，0 表示拉取全部
+ * @param page 每页回调
+ * @param watermark 输出本次的水位（第一页返回的），下次作为 since 传入；服务器未返回时为0
+ * @return 拉取的账户总数，失败返回-1（失败前的页已交给回调）
+ * @note 每页 server.conf [sync] pull_page_size 个，内存占用与服务器账户总数无关；
+ *       服务器按 updated_at 筛选并向前多取几秒，同一账户可能重复返回，按余额覆盖即可
+ */
+int64_t api_pull_accounts(int64_t since, AccountPageFunc page, void *user, int64_t *watermark);
+
+/**
+ * @brief 发送一个账户操作，带幂等标识
+ * @param op_id 操作的唯一标识（最长64字符），服务器按它去重，重发同一操作不会重复执行
+ * @param uuid 账户UUID（转账时为转出账户）
+ * @param uuid_to 转账时的转入账户，其余为NULL
+ * @note 不打印错误；销户时账户不存在视为成功（目标状态已达成）；
+ *       创建时账户已存在（409，不是同一 op_id 的重发）视为拒绝
+ */
+ApiSendResult api_send_operation(ApiOperation op, const char *op_id, const char *uuid,
+                                 const char *uuid_to, LLUINT amount);
+
 #endif /* SERVER_API_H */
 
@@ -0,0 +1,102 @@
+/**
+ * @file shard.h
+ * @brief 按UUID哈希分区的分片账户引擎头文件
+ *
+ * 账户按 UUID 哈希分到 N 个分片，每个分片拥有自己的 Hash 表、
+ * 所属账户的 .card 文件和一个（可绑定CPU核心的）写线程，分片之间不共享锁。
+ * 单账户操作只路由到一个分片；跨分片转账采用两阶段协议：
+ * 源分片预留（扣减并挂起）-> 目标分片入账 -> 源分片提交（或回滚）。
+ *
+ * 每个分片写 .card 之前先把本批结果追加到自己的日志 Card/shard-<N>.log；
+ * 落盘失败的批次在内存中撤销，结果返回 ACCOUNT_ERR_IO。启动时回放上次留下的日志，
+ * 目标分片已入账而源分片未提交的转账补记扣款，其余中断的转账视为未发生。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <lib/account.h>
+#include <lib/engine.h>
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 分片运行统计
+ */
+typedef struct {
+    size_t applied;               /**< 已执行的操作数 */
+    size_t batches;               /**< 处理的批次数 */
+    size_t accounts;              /**< 表中缓存的账户数 */
+} ShardStats;
+
+/* ==================== 生命周期 ==================== */
+
+/**
+ * @brief 启动分片引擎
+ * @param config 使用 shards、queue_capacity（每分片）、max_batch、pin_threads
+ * @return 成功返回true
+ * @note 启动与停止时会清空全局 Hash 表缓存，运行期间账户只由分片持有；
+ *       启动前先回放上次运行留下的分片日志，回放失败时不启动
+ */
+bool shard_engine_start(const EngineConfig *config);
+
+/**
+ * @brief 停止分片引擎（先执行完已提交的操作）
+ * @note 所有修改都已写回时删除分片日志，否则保留到下次启动回放
+ */
+void shard_engine_stop(void);
+
+bool shard_engine_running(void);
+
+/**
+ * @brief 获取分片数（未运行时为0）
+ */
+size_t shard_engine_count(void);
+
+/**
+ * @brief 计算 UUID 所属分片
+ */
+size_t shard_index_of(const char *uuid);
+
+/**
+ * @brief 获取指定分片的统计
+ */
+void shard_get_stats(size_t shard, ShardStats *stats);
+
+/**
+ * @brief 跨分片转账统计
+ * @param committed 输出已提交的跨分片转账数，可为NULL
+ * @param aborted 输出已回滚的跨分片转账数，可为NULL
+ */
+void shard_get_transfer_stats(size_t *committed, size_t *aborted);
+
+/* ==================== 账户操作（同步） ==================== */
+
+AccountStatus shard_deposit(const char *uuid, LLUINT amount, ACCOUNT *out);
+AccountStatus shard_withdraw(const char *uuid, LLUINT amount, ACCOUNT *out);
+
+/**
+ * @brief 转账：同分片时一步完成，跨分片时走两阶段协议
+ */
+AccountStatus shard_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount,
+                             ACCOUNT *out_from, ACCOUNT *out_to);
+
+/**
+ * @brief 销户（余额为0且没有挂起的转出预留）
+ */
+AccountStatus shard_delete(const char *uuid);
+
+/* ==================== 通用存取（供 load_account/save_account 路由） ==================== */
+
+bool shard_get_account(const char *uuid, ACCOUNT *out);
+bool shard_put_account(const ACCOUNT *acc);
+bool shard_remove_account(const char *uuid);
+
+#endif /* SHARD_H */
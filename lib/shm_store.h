@@ -0,0 +1,108 @@
+/**
+ * @file shm_store.h
+ * @brief 多进程共享内存账户存储头文件
+ *
+ * 多个 bamsystem 进程在同一工作目录运行时，通过 shm_open + mmap 共享一份
+ * 账户索引（开放寻址表），并用进程间共享的健壮互斥锁（PTHREAD_PROCESS_SHARED、
+ * PTHREAD_MUTEX_ROBUST）组成锁表：每个账户按UUID哈希映射到一个锁条带，
+ * 账户操作只锁涉及的条带（转账按编号顺序锁两个），不同账户的操作可跨进程并行。
+ *
+ * 启用后 load_account/save_account/delete_account_file 改为访问共享表，
+ * .card 文件在持有条带锁时同步写入，因此文件始终与共享表一致。
+ * 持锁进程异常退出时，下一个加锁者接管该锁并从 .card 文件重建该条带的账户。
+ *
+ * 仅支持 POSIX 平台；Windows 下 shm_store_attach() 返回false。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef SHM_STORE_H
+#define SHM_STORE_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <lib/account.h>
+
+/* ==================== 宏定义 ==================== */
+
+/** @brief 锁条带数 */
+#define SHM_STORE_STRIPES 256
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 共享存储配置（engine.conf 的 [shm] 节）
+ */
+typedef struct {
+    bool enabled;                 /**< 是否启用共享内存存储 */
+    size_t capacity;              /**< 账户槽位数（创建共享段时确定，之后不可扩容） */
+} ShmStoreConfig;
+
+/**
+ * @brief 共享存储统计
+ */
+typedef struct {
+    size_t capacity;              /**< 槽位数 */
+    size_t count;                 /**< 账户数 */
+    size_t attached;              /**< 当前挂接的进程数 */
+    size_t recoveries;            /**< 接管异常退出进程所持锁的次数 */
+} ShmStoreStats;
+
+/* ==================== 配置与生命周期 ==================== */
+
+/**
+ * @brief 读取 [shm] 配置，文件不存在或字段缺失时使用默认值（不启用）
+ */
+bool load_shm_config(const char *path, ShmStoreConfig *config);
+
+/**
+ * @brief 按 engine.conf 挂接共享存储（段名由当前工作目录派生）
+ * @note 须在 init_account_system() 之后、init_flusher()/init_engine() 之前调用
+ */
+bool init_shm_store(void);
+
+/**
+ * @brief 挂接（不存在时创建并从 .card 文件载入）指定名称的共享段
+ * @param name 共享段名称（以'/'开头），NULL 表示由当前工作目录派生
+ * @return 成功返回true
+ */
+bool shm_store_attach(const ShmStoreConfig *config, const char *name);
+
+/**
+ * @brief 解除挂接；最后一个进程解除时删除共享段
+ */
+void shm_store_detach(void);
+
+/**
+ * @brief 当前进程是否已挂接
+ */
+bool shm_store_active(void);
+
+void shm_store_get_stats(ShmStoreStats *stats);
+
+/* ==================== 锁表 ==================== */
+
+/**
+ * @brief 锁住一个或两个账户所在的条带（按条带编号顺序加锁，可重入）
+ * @param uuid_b 可为NULL
+ */
+void shm_store_lock(const char *uuid_a, const char *uuid_b);
+
+void shm_store_unlock(const char *uuid_a, const char *uuid_b);
+
+/* ==================== 账户存取（内部自行加条带锁） ==================== */
+
+bool shm_store_get(const char *uuid, ACCOUNT *out);
+
+/**
+ * @brief 插入或更新账户
+ * @return 表已满返回false
+ */
+bool shm_store_put(const ACCOUNT *acc);
+
+bool shm_store_remove(const char *uuid);
+
+#endif /* SHM_STORE_H */
@@ -0,0 +1,157 @@
+/**
+ * @file snapshot.h
+ * @brief 只读共享内存账户快照导出头文件
+ *
+ * 引擎定期把账户表发布到一个只读共享内存段，供报表等外部工具直接映射、
+ * 零拷贝扫描余额，无需经过交互程序或解析加密的 .card 文件。
+ *
+ * 段布局（小端，版本 1）：
+ *   偏移 0          SnapshotHeader，占满第一页（SNAPSHOT_PAGE_SIZE 字节）
+ *   偏移 4096       SnapshotRecord[capacity]，前 count 条有效，按 UUID 升序排列
+ *
+ * 一致性采用 seqlock：发布方写入前将 seq 加1（变为奇数），写完再加1（变回偶数）。
+ * 读取方：
+ *   1. 读 seq，若为奇数则稍后重试
+ *   2. 扫描记录（原地读取，不拷贝）
+ *   3. 再读 seq，与第1步不同则丢弃结果重试
+ * generation 每次发布（内容有变化）加1，可用于判断是否需要重新扫描。
+ *
+ * 发布是增量的：发布方保留上次发布的副本，只写入内容有变化的页。
+ * 快照不包含密码。仅支持 POSIX 平台。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* ==================== 宏定义 ==================== */
+
+#define SNAPSHOT_MAGIC 0x504E5342u        /**< "BSNP" */
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_PAGE_SIZE 4096
+
+/* ==================== 段布局 ==================== */
+
+/**
+ * @brief 段头（位于偏移0）
+ */
+typedef struct {
+    uint32_t magic;               /**< SNAPSHOT_MAGIC */
+    uint32_t version;             /**< SNAPSHOT_VERSION */
+    uint32_t header_size;         /**< 记录区起始偏移（SNAPSHOT_PAGE_SIZE） */
+    uint32_t record_size;         /**< sizeof(SnapshotRecord) */
+    uint64_t capacity;            /**< 记录区可容纳的记录数 */
+    _Atomic uint64_t seq;         /**< seqlock 序号，奇数表示正在写入 */
+    uint64_t generation;          /**< 发布次数 */
+    uint64_t count;               /**< 有效记录数 */
+    uint64_t published_unix_ms;   /**< 最近一次发布时间（Unix 毫秒） */
+    uint32_t truncated;           /**< 账户数超过 capacity 时为1 */
+    uint32_t reserved;
+} SnapshotHeader;
+
+/**
+ * @brief 账户记录（48字节）
+ */
+typedef struct {
+    char uuid[40];                /**< UUID，'\0' 结尾 */
+    uint64_t balance;             /**< 余额（单位：分） */
+} SnapshotRecord;
+
+/* ==================== 发布方 ==================== */
+
+/**
+ * @brief 快照配置（engine.conf 的 [snapshot] 节）
+ */
+typedef struct {
+    bool enabled;                 /**< 是否发布快照 */
+    unsigned int interval_ms;     /**< 发布间隔（毫秒） */
+    size_t capacity;              /**< 最多发布的账户数 */
+} SnapshotConfig;
+
+/**
+ * @brief 发布统计
+ */
+typedef struct {
+    uint64_t generation;          /**< 当前 generation */
+    size_t publishes;             /**< 内容有变化的发布次数 */
+    size_t unchanged;             /**< 内容无变化而跳过写入的次数 */
+    size_t pages_written;         /**< 累计写入的页数 */
+    size_t last_pages;            /**< 最近一次写入的页数 */
+    size_t last_count;            /**< 最近一次发布的账户数 */
+    uint64_t last_publish_us;     /**< 最近一次发布耗时（微秒，含收集、排序、比较与写入） */
+    uint64_t max_publish_us;
+    uint64_t total_publish_us;
+} SnapshotStats;
+
+bool load_snapshot_config(const char *path, SnapshotConfig *config);
+
+/**
+ * @brief 按 engine.conf 启动快照发布线程
+ * @note 须在 init_engine() 之后调用（分片模式下经分片读取账户）
+ */
+bool init_snapshot(void);
+
+/**
+ * @brief 创建快照段并启动发布线程
+ * @param name 段名称（以'/'开头），NULL 表示由当前工作目录派生
+ */
+bool snapshot_start(const SnapshotConfig *config, const char *name);
+
+/**
+ * @brief 停止发布线程并删除快照段
+ */
+void cleanup_snapshot(void);
+
+bool snapshot_active(void);
+
+/**
+ * @brief 立即发布一次
+ * @return 发布成功返回true（内容无变化也返回true）
+ */
+bool snapshot_publish_now(void);
+
+void snapshot_get_stats(SnapshotStats *stats);
+
+/**
+ * @brief 获取当前快照段名称
+ */
+const char* snapshot_segment_name(void);
+
+/* ==================== 读取方 ==================== */
+
+/**
+ * @brief 只读映射的快照段
+ */
+typedef struct {
+    const SnapshotHeader *header;
+    const SnapshotRecord *records;
+    size_t map_size;
+} SnapshotView;
+
+/**
+ * @brief 以只读方式映射快照段
+ */
+bool snapshot_view_open(SnapshotView *view, const char *name);
+
+void snapshot_view_close(SnapshotView *view);
+
+/**
+ * @brief 开始一次读取，返回本次读取的 seq（发布方正在写入时等待）
+ */
+uint64_t snapshot_read_begin(const SnapshotView *view);
+
+/**
+ * @brief 读取结束后调用，返回true表示期间发生了发布，需要重试
+ */
+bool snapshot_read_retry(const SnapshotView *view, uint64_t seq);
+
+#endif /* SNAPSHOT_H */
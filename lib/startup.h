@@ -0,0 +1,125 @@
+/**
+ * @file startup.h
+ * @brief 后台服务器检测与启动同步头文件
+ *
+ * 检测服务器最长要等一个请求超时，全量推送与拉取在账户多时要几分钟，
+ * 原先都在显示菜单之前完成。现在界面以本地模式立即显示，由后台线程：
+ *   1. 检测服务器（不切换运行模式）；期间界面的交易只在本地执行，
+ *      之后的推送会带上它们的余额
+ *   2. 服务器可用时，等进行中的界面交易结束后切换为服务器模式，
+ *      启动同步队列并暂停发送，取好推送快照后放行界面交易：交易在本地执行，
+ *      服务器一侧留在队列中（推送的是余额，与同时送达的交易交错会重复累加
+ *      或丢失），拉取跳过有交易的账户，不覆盖本地刚做的修改
+ *   3. 推送与拉取结束后恢复队列发送；同步队列不可用时界面交易等到同步结束。
+ *      服务器不可用时保持本地模式
+ * 界面按 startup_get_status() 显示当前阶段与进度。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lib/account.h>
+#include <lib/server_api.h>
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 启动阶段
+ */
+typedef enum {
+    STARTUP_IDLE,         /**< 未启动后台检测 */
+    STARTUP_DETECTING,    /**< 正在检测服务器，界面的交易只在本地执行 */
+    STARTUP_SYNCING,      /**< 已切换为服务器模式，正在推送与拉取，放行前界面的交易等待 */
+    STARTUP_ONLINE,       /**< 同步结束，服务器模式 */
+    STARTUP_OFFLINE       /**< 服务器不可用，本地模式 */
+} StartupPhase;
+
+/**
+ * @brief 启动状态
+ */
+typedef struct {
+    StartupPhase phase;
+    bool ops_blocked;          /**< 界面交易须等待（同步中且同步函数尚未放行） */
+    int pushed;                /**< 推送成功的账户数 */
+    int pulled;                /**< 拉取保存的账户数 */
+    size_t outbox_pending;     /**< 同步队列仍有积压而跳过推送与拉取时为积压条数，否则为0 */
+    uint64_t detect_ms;        /**< 检测耗时 */
+    uint64_t sync_ms;          /**< 推送与拉取耗时 */
+    uint64_t menu_ms;          /**< 从开始检测到界面首次显示菜单 */
+    SyncProgress progress;     /**< 推送与拉取的进度 */
+} StartupStatus;
+
+/**
+ * @brief 检测函数，返回 MODE_SERVER 时进入同步（不应切换运行模式）
+ */
+typedef RunMode (*StartupDetectFunc)(void);
+
+/**
+ * @brief 同步函数，在运行模式已切换、界面交易暂停时调用
+ * @param status 写入 pushed、pulled 与 outbox_pending
+ * @note 可在同步结束前调用 startup_release_ops() 放行界面交易
+ */
+typedef void (*StartupSyncFunc)(StartupStatus *status);
+
+/* ==================== 生命周期 ==================== */
+
+/**
+ * @brief 启动后台检测与同步（检测服务器、启动同步队列、推送并拉取账户）
+ * @note 须在 init_server_api() 与 init_async_ops() 之后调用
+ */
+bool init_startup(void);
+
+/**
+ * @brief 以指定的检测与同步函数启动
+ * @param sync 为NULL时只检测并切换运行模式
+ */
+bool startup_begin(StartupDetectFunc detect, StartupSyncFunc sync);
+
+/**
+ * @brief 等待后台检测与同步结束
+ * @note 须在 cleanup_async_ops() 与 cleanup_outbox() 之前调用
+ */
+void cleanup_startup(void);
+
+/**
+ * @brief 后台检测或同步是否仍在进行
+ */
+bool startup_in_progress(void);
+
+void startup_get_status(StartupStatus *status);
+
+/**
+ * @brief 界面首次显示菜单时调用，记录 menu_ms（之后的调用忽略）
+ */
+void startup_mark_menu_shown(void);
+
+/* ==================== 界面交易 ==================== */
+
+/**
+ * @brief 界面交易开始前调用，启动同步期间等待其结束
+ * @note 与 startup_op_end() 成对调用；检测结束后等进行中的交易结束才切换运行模式
+ */
+void startup_op_begin(void);
+
+/**
+ * @brief 与 startup_op_begin() 相同，但最多等待 timeout_ms
+ * @return 可以开始交易返回true（须调用 startup_op_end()），超时返回false
+ */
+bool startup_op_try_begin(unsigned int timeout_ms);
+
+void startup_op_end(void);
+
+/**
+ * @brief 同步结束前放行界面交易，由同步函数调用
+ */
+void startup_release_ops(void);
+
+#endif /* STARTUP_H */
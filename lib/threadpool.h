@@ -0,0 +1,118 @@
+/**
+ * @file threadpool.h
+ * @brief 工作窃取线程池模块头文件
+ *
+ * 每个工作线程拥有一个双端队列：自己从底部压入/弹出（LIFO，缓存友好），
+ * 空闲线程从其他队列顶部窃取（FIFO，先偷大块任务）。
+ * 批量加载、排序、报表、同步、生成等功能统一使用此执行器。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <lib/platform.h>
+
+/* ==================== 类型定义 ==================== */
+
+/** @brief 任务函数 */
+typedef void (*TaskFunc)(void *arg);
+
+/** @brief 区间任务函数，处理 [begin, end) */
+typedef void (*RangeFunc)(size_t begin, size_t end, void *arg);
+
+/** @brief 线程池（不透明类型） */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief 任务组：跟踪一批任务，可等待全部完成
+ * @note 等待时调用线程会参与执行任务，因此可在工作线程内嵌套使用
+ */
+typedef struct {
+    atomic_size_t pending;        /** 未完成任务数 */
+    PlatformMutex lock;           /** 保护完成通知 */
+    PlatformCond done;            /** 全部完成时广播 */
+} TaskGroup;
+
+/**
+ * @brief 线程池运行统计
+ */
+typedef struct {
+    size_t executed;              /** 已执行任务数 */
+    size_t stolen;                /** 通过窃取获得的任务数 */
+} ThreadPoolStats;
+
+/* ==================== 线程池 ==================== */
+
+/**
+ * @brief 创建线程池
+ * @param num_threads 工作线程数，<=0 时使用CPU核心数
+ * @return 成功返回线程池指针，失败返回NULL
+ */
+ThreadPool* threadpool_create(int num_threads);
+
+/**
+ * @brief 销毁线程池
+ * @note 会先执行完已提交的所有任务
+ */
+void threadpool_destroy(ThreadPool *pool);
+
+/**
+ * @brief 获取工作线程数
+ */
+int threadpool_size(const ThreadPool *pool);
+
+/**
+ * @brief 提交一个独立任务
+ * @return 成功返回true，内存不足返回false
+ */
+bool threadpool_submit(ThreadPool *pool, TaskFunc func, void *arg);
+
+/**
+ * @brief 获取运行统计
+ */
+void threadpool_get_stats(ThreadPool *pool, ThreadPoolStats *stats);
+
+/**
+ * @brief 并行处理区间 [begin, end)
+ * @param grain 每个子任务的最小元素数，0 表示自动选择
+ * @note 阻塞直到所有子区间完成；调用线程也参与计算
+ */
+void threadpool_parallel_for(ThreadPool *pool, size_t begin, size_t end, size_t grain,
+                             RangeFunc func, void *arg);
+
+/**
+ * @brief 获取进程共享线程池（首次调用时按CPU核心数创建）
+ * @return 线程池指针，创建失败返回NULL
+ */
+ThreadPool* threadpool_shared(void);
+
+/**
+ * @brief 销毁进程共享线程池
+ */
+void threadpool_shared_cleanup(void);
+
+/* ==================== 任务组 ==================== */
+
+void task_group_init(TaskGroup *group);
+void task_group_destroy(TaskGroup *group);
+
+/**
+ * @brief 在任务组中提交任务
+ * @return 成功返回true，内存不足返回false
+ */
+bool task_group_run(TaskGroup *group, ThreadPool *pool, TaskFunc func, void *arg);
+
+/**
+ * @brief 等待任务组内所有任务完成（期间协助执行任务）
+ */
+void task_group_wait(TaskGroup *group, ThreadPool *pool);
+
+#endif /* THREADPOOL_H */
@@ -0,0 +1,158 @@
+/**
+ * @file tiering.h
+ * @brief 账户冷热分层存储头文件
+ *
+ * 热层：全局账户 Hash 表 + 每个账户一个 .card 文件（现有存储）。
+ * 冷层：一个按 UUID 排序、紧凑编码的冷段文件（默认 Card/cold.seg）。
+ *
+ * 后台线程每隔 scan_interval_seconds 扫描一次 Hash 表，把超过
+ * cold_after_seconds 未访问的账户写入冷段，再删除其 .card 文件与 Hash 表节点。
+ * load_account() 在 Hash 表未命中时查冷段，命中即提升回热层
+ * （重新写 .card 并插入 Hash 表），调用方无感知。
+ *
+ * 冷段文件布局（小端，版本 2）：
+ *   ColdSegmentHeader
+ *   uint8_t  keys[count][16]      UUID 的16字节二进制形式，升序
+ *   uint32_t offsets[count + 1]   每条记录在值区的起始偏移
+ *   int64_t  modified[count]      账户最后修改时间（移入时 .card 文件的修改时间）
+ *   uint8_t  values[value_bytes]  varint(PASSWORD) varint(BALANCE)，逐条用系统密钥加密
+ * 版本 1 没有 modified 区，读入时以冷段文件的修改时间代替。
+ * 冷段在首次需要时整体读入内存，内存中保持同样的紧凑形式。
+ *
+ * 已提升的账户在内存中标记，下次扫描时从冷段中剔除；.card 文件始终比冷段新，
+ * 因此提升后、重写冷段前进程退出也不会读到旧数据。删除冷段中的账户会立即重写冷段。
+ *
+ * 仅在默认存储模式下生效（分片、共享存储、journal 持久化、紧凑账户表与磁盘索引下不启用）。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef TIERING_H
+#define TIERING_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <lib/account.h>
+
+/* ==================== 宏定义 ==================== */
+
+#define COLD_SEGMENT_MAGIC 0x444C4342u    /**< "BCLD" */
+#define COLD_SEGMENT_VERSION 2
+#define TIERING_PATH_MAX 128
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 冷段文件头
+ */
+typedef struct {
+    uint32_t magic;               /**< COLD_SEGMENT_MAGIC */
+    uint32_t version;             /**< COLD_SEGMENT_VERSION */
+    uint64_t count;               /**< 记录数 */
+    uint64_t value_bytes;         /**< 值区字节数 */
+} ColdSegmentHeader;
+
+/**
+ * @brief 分层配置（engine.conf 的 [tiering] 节）
+ */
+typedef struct {
+    bool enabled;
+    unsigned int cold_after_seconds;    /**< 超过该时间未访问的账户移入冷段 */
+    unsigned int scan_interval_seconds; /**< 后台扫描间隔 */
+    char segment_file[TIERING_PATH_MAX];
+} TieringConfig;
+
+/**
+ * @brief 分层统计
+ */
+typedef struct {
+    size_t hot_count;             /**< 热层账户数 */
+    size_t hot_bytes;             /**< 热层常驻内存（Hash 表节点与桶数组） */
+    size_t cold_count;            /**< 冷层账户数（不含已提升的） */
+    size_t cold_bytes;            /**< 冷段常驻内存（未载入时为0） */
+    size_t segment_file_bytes;    /**< 冷段文件大小 */
+    bool cold_loaded;             /**< 冷段是否已载入内存 */
+    size_t demotions;             /**< 累计移入冷段的账户数 */
+    size_t promotions;            /**< 累计从冷段提升的账户数 */
+    size_t scans;                 /**< 扫描次数 */
+    uint64_t last_scan_us;        /**< 最近一次扫描耗时（微秒，含写冷段） */
+    uint64_t cold_lookups;        /**< 冷段查找次数（含未命中） */
+    uint64_t cold_lookup_ns;      /**< 冷段查找累计耗时（纳秒，不含提升时写 .card） */
+} TieringStats;
+
+/* ==================== 配置与生命周期 ==================== */
+
+bool load_tiering_config(const char *path, TieringConfig *config);
+
+/**
+ * @brief 按 engine.conf 启动分层（默认不启用）
+ * @note 须在 init_engine() 之后调用
+ */
+bool init_tiering(void);
+
+/**
+ * @brief 以指定配置启动
+ * @param config scan_interval_seconds 为0时不启动后台扫描线程，仅手动调用 tiering_demote_idle()
+ */
+bool tiering_start(const TieringConfig *config);
+
+/**
+ * @brief 停止扫描线程并释放冷段内存（冷段文件保留）
+ */
+void cleanup_tiering(void);
+
+bool tiering_active(void);
+
+/**
+ * @brief 立即扫描一次
+ * @param idle_seconds 最近访问距今不少于该秒数的账户移入冷段（0 表示全部）
+ * @return 本次移入冷段的账户数
+ */
+size_t tiering_demote_idle(unsigned int idle_seconds);
+
+void tiering_get_stats(TieringStats *stats);
+
+/* ==================== 账户模块调用 ==================== */
+
+/**
+ * @brief 从冷段查找账户（不含已提升的）
+ * @note 由 load_account() 在 Hash 表未命中时调用
+ */
+bool tiering_cold_get(const char *uuid, ACCOUNT *acc);
+
+/**
+ * @brief 读取冷段中的账户及其最后修改时间，不提升、不计入查找统计
+ * @note 供增量推送判断冷段账户是否在上次同步后修改过
+ */
+bool tiering_cold_peek(const char *uuid, ACCOUNT *acc, time_t *modified);
+
+/**
+ * @brief 标记账户已提升回热层（.card 文件已写入），下次扫描时从冷段剔除
+ */
+void tiering_mark_promoted(const char *uuid);
+
+/**
+ * @brief 把账户从冷段中删除，账户在冷段文件中时立即重写冷段文件
+ * @return 重写失败返回false
+ * @note 由 delete_account_file() 调用
+ */
+bool tiering_forget(const char *uuid);
+
+/**
+ * @brief 列出冷段中的账户（不含已提升的）
+ * @return 写入的数量
+ */
+size_t tiering_cold_list(char uuids[][37], size_t max_count);
+
+/**
+ * @brief 复制冷段中的账户（不含已提升的）
+ * @return 写入的数量
+ */
+size_t tiering_cold_collect(ACCOUNT *out, size_t max_count);
+
+#endif /* TIERING_H */
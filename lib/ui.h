@@ -73,6 +73,13 @@ void clear_screen(void);
  */
 void output_business(void);
 
+/**
+ * @brief 显示系统运行状态
+ * 
+ * 输出账户引擎与后台刷盘的运行统计（脏账户积压、刷盘耗时等）。
+ */
+void show_system_status(void);
+
 
 /**
  * @brief UI按键枚举类型
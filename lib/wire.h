@@ -0,0 +1,135 @@
+/**
+ * @file wire.h
+ * @brief 客户端与服务器同步的二进制编码头文件
+ *
+ * 大量同步时双方的 JSON 编码与解析占用了大部分 CPU。二进制编码改为定长小端记录，
+ * UUID 以16字节二进制形式传输，由 Content-Type 协商：
+ *   - 服务器在 /api/check 的 content_types 中声明支持 WIRE_CONTENT_TYPE
+ *   - 客户端配置 [sync] wire_format=binary 时，请求体以该类型发送，
+ *     并带 "Accept: application/x-bam-record" 请求二进制响应
+ *   - 服务器按请求的 Content-Type 解析请求体，按 Accept 决定响应编码；
+ *     认证失败等中间件错误仍返回 JSON，客户端按响应的 Content-Type 解析
+ * 默认仍为 JSON。
+ *
+ * 记录格式（整数均为小端）：
+ *   单个账户操作请求（create / deposit / withdraw / transfer / sync）：
+ *     uuid[16] uuid_to[16] amount:u64 timestamp:i64 op_id_len:u8 op_id[op_id_len]
+ *     uuid_to 仅转账使用，其余为全0；create 与 sync 的 amount 为余额
+ *   状态响应（上述操作与 DELETE）：
+ *     success:u8 balance:u64 text_len:u16 text[text_len]（text 为 UTF-8 的提示或错误）
+ *   批量同步请求：count:u32 之后 count 条 uuid[16] balance:u64 timestamp:i64
+ *   批量同步响应：success:u8 count:u32 之后 count 个 ok:u8，与请求顺序一致
+ *   账户列表响应（GET /api/accounts）为帧序列，服务器逐行写出：
+ *     'A' uuid[16] balance:u64                          一个账户
+ *     'E' success:u8 watermark:i64 next_after[16]       结束帧，next_after 全0表示没有下一页
+ *
+ * 本模块只做编解码，不分配内存，也不依赖网络库。
+ *
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+/* ==================== 标准库头文件 ==================== */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <lib/account.h>
+
+/* ==================== 宏定义 ==================== */
+
+#define WIRE_CONTENT_TYPE "application/x-bam-record"
+#define WIRE_UUID_BYTES 16
+#define WIRE_OP_ID_MAX 64                 /**< 与服务器 applied_ops.op_id 的长度一致 */
+#define WIRE_OP_FIXED_BYTES (2 * WIRE_UUID_BYTES + 8 + 8 + 1)
+#define WIRE_OP_MAX_BYTES (WIRE_OP_FIXED_BYTES + WIRE_OP_ID_MAX)
+#define WIRE_STATUS_FIXED_BYTES (1 + 8 + 2)
+#define WIRE_SYNC_RECORD_BYTES (WIRE_UUID_BYTES + 8 + 8)
+#define WIRE_ACCOUNT_FRAME_BYTES (1 + WIRE_UUID_BYTES + 8)
+#define WIRE_END_FRAME_BYTES (1 + 1 + 8 + WIRE_UUID_BYTES)
+#define WIRE_FRAME_ACCOUNT 'A'
+#define WIRE_FRAME_END 'E'
+
+/* ==================== 类型定义 ==================== */
+
+/**
+ * @brief 账户列表响应的读取位置
+ */
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+} WireReader;
+
+/**
+ * @brief 账户列表响应中的一帧
+ */
+typedef enum {
+    WIRE_READ_ACCOUNT,    /**< 读到一个账户 */
+    WIRE_READ_END,        /**< 读到结束帧 */
+    WIRE_READ_ERROR       /**< 未知帧或数据不完整 */
+} WireReadResult;
+
+/**
+ * @brief 结束帧的内容
+ */
+typedef struct {
+    bool success;
+    int64_t watermark;
+    char next_after[37];  /**< 没有下一页时为空串 */
+} WirePageEnd;
+
+/* ==================== 编码 ==================== */
+
+/**
+ * @brief 编码单个账户操作请求
+ * @param out 至少 WIRE_OP_MAX_BYTES 字节
+ * @param uuid_to 仅转账，其余为NULL
+ * @param op_id 可为NULL
+ * @return 编码长度；UUID 不是小写规范格式或 op_id 过长时返回0（调用方改用 JSON）
+ */
+size_t wire_encode_op(uint8_t *out, const char *uuid, const char *uuid_to, LLUINT amount,
+                      int64_t timestamp, const char *op_id);
+
+/**
+ * @brief 批量同步请求体的长度
+ */
+size_t wire_sync_batch_size(size_t n);
+
+/**
+ * @brief 编码批量同步请求
+ * @param out 至少 wire_sync_batch_size(n) 字节
+ * @return 编码长度；有账户的 UUID 无法转换时返回0
+ */
+size_t wire_encode_sync_batch(uint8_t *out, const ACCOUNT *accounts, size_t n, int64_t timestamp);
+
+/* ==================== 解码 ==================== */
+
+/**
+ * @brief 解析状态响应
+ * @param balance 可为NULL
+ * @return 格式正确且 success 为真
+ */
+bool wire_decode_status(const uint8_t *data, size_t len, LLUINT *balance);
+
+/**
+ * @brief 解析批量同步响应，按请求顺序写出每个账户是否成功
+ * @return 成功的数量；格式不符或数量与 n 不一致时全部视为失败
+ */
+size_t wire_decode_sync_batch(const uint8_t *data, size_t len, size_t n, bool *item_ok);
+
+/**
+ * @brief 开始读取账户列表响应
+ */
+void wire_reader_init(WireReader *r, const uint8_t *data, size_t len);
+
+/**
+ * @brief 读取下一帧
+ * @param acc 读到账户时写入 UUID 与余额（密码为0）
+ * @param end 读到结束帧时写入
+ */
+WireReadResult wire_read_frame(WireReader *r, ACCOUNT *acc, WirePageEnd *end);
+
+#endif
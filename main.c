@@ -10,6 +10,16 @@
 #include <lib/account.h>
 #include <lib/platform.h>
 #include <lib/server_api.h>
+#include <lib/engine.h>
+#include <lib/flusher.h>
+#include <lib/shm_store.h>
+#include <lib/snapshot.h>
+#include <lib/async_ops.h>
+#include <lib/outbox.h>
+#include <lib/replication.h>
+#include <lib/tiering.h>
+#include <lib/compact_store.h>
+#include <lib/startup.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -30,42 +40,79 @@ int main(void)
         return 1;
     }
     
-    /* 初始化服务器API */
+    /* 按 engine.conf 把账户表换成紧凑表示（默认不启用） */
+    init_compact_store();
+
+    /* 按 engine.conf 挂接多进程共享账户存储（默认不启用） */
+    init_shm_store();
+
+    /* 回放日志并按 engine.conf 启动后台刷盘（默认同步写入） */
+    init_flusher();
+
+    /* 初始化账户引擎（engine.conf，默认加锁模式） */
+    init_engine();
+
+    /* 按 engine.conf 启动冷热分层（默认不启用，未启用时恢复冷段中的账户） */
+    init_tiering();
+
+    /* 按 engine.conf 启动热备复制（默认不启用） */
+    init_replication();
+
+    /* 按 engine.conf 启动只读账户快照导出（默认不启用） */
+    init_snapshot();
+
+    /* 启动异步操作执行线程（界面交易的服务器同步在后台进行） */
+    init_async_ops();
+    
+    /* 初始化服务器API（只读取配置，不访问网络） */
     printf("正在初始化服务器连接...\n");
     if (init_server_api()) {
-        /* 检测服务器可用性 */
-        printf("正在检测服务器状态...\n");
-        RunMode mode = check_server_availability();
-        
-        if (mode == MODE_SERVER) {
-            printf("✓ 运行模式: 联网版本（服务器已连接）\n");
-            printf("\n========== 开始双向同步 ==========\n");
-            
-            /* 证书请求 */
-            /* fetch_server_certificate(); 功能暂时搁置 */
-            
-            /* 第一步：推送本地账户到服务器 */
-            int pushed = sync_all_accounts_to_server();
-            
-            /* 第二步：从服务器拉取账户到本地 */
-            int pulled = pull_accounts_from_server();
-            
-            printf("========== 同步完成 ==========\n");
-            printf("推送: %d 个账户 | 拉取: %d 个账户\n\n", pushed, pulled);
-        } else {
-            printf("✓ 运行模式: 本地版本（服务器不可用或已禁用）\n");
-        }
+        /* 后台检测服务器、启动同步队列并双向同步，界面以本地模式立即显示，
+         * 服务器可用时切换为联网版本（状态见菜单上方） */
+        /* 证书请求 */
+        /* fetch_server_certificate(); 功能暂时搁置 */
+        init_startup();
     } else {
         printf("✓ 运行模式: 本地版本（服务器API初始化失败）\n");
         set_run_mode(MODE_LOCAL);
     }
     
-    printf("\n按回车键继续...");
-    getchar();
-    
     /* 进入UI主循环 */
     ui_loop();
+
+    /* 等待后台检测与同步结束（之后才能停止同步队列） */
+    if (startup_in_progress()) {
+        printf("正在等待服务器检测与同步结束...\n");
+    }
+    cleanup_startup();
+
+    /* 执行完已提交的异步操作（含写入同步队列）后停止 */
+    cleanup_async_ops();
+
+    /* 停止同步队列发送线程（未发完的交易留在队列文件中，下次启动继续） */
+    cleanup_outbox();
+    
+    /* 停止快照发布并删除快照段 */
+    cleanup_snapshot();
+
+    /* 停止引擎写线程（先执行完已提交的操作） */
+    cleanup_engine();
+
+    /* 断开热备复制 */
+    cleanup_replication();
+
+    /* 停止冷层扫描（冷段文件保留） */
+    cleanup_tiering();
+
+    /* 写回全部脏账户并停止刷盘线程 */
+    cleanup_flusher();
+
+    /* 解除共享存储挂接（最后一个进程删除共享段） */
+    shm_store_detach();
     
+    /* 释放紧凑账户表 */
+    cleanup_compact_store();
+
     /* 清理账户系统资源 */
     cleanup_account_system();
     
@@ -0,0 +1,144 @@
+/**
+ * @file mpsc_ring.c
+ * @brief 有界无锁MPSC环形队列实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/mpsc_ring.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* 元素数据相对槽位起始的偏移（保证元素按最大对齐） */
+#define SLOT_DATA_OFFSET ((sizeof(atomic_size_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+static atomic_size_t* slot_seq(MpscRing *ring, size_t pos)
+{
+    return (atomic_size_t *)(ring->slots + (pos & ring->mask) * ring->slot_size);
+}
+
+static void* slot_data(MpscRing *ring, size_t pos)
+{
+    return ring->slots + (pos & ring->mask) * ring->slot_size + SLOT_DATA_OFFSET;
+}
+
+bool mpsc_ring_init(MpscRing *ring, size_t capacity, size_t elem_size)
+{
+    size_t cap = 2;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    size_t align = _Alignof(max_align_t);
+    ring->elem_size = elem_size;
+    ring->slot_size = (SLOT_DATA_OFFSET + elem_size + align - 1) & ~(align - 1);
+    ring->slots = (unsigned char *)malloc(cap * ring->slot_size);
+    if (ring->slots == NULL) {
+        return false;
+    }
+    ring->mask = cap - 1;
+
+    /* seq == pos 表示可写，seq == pos + 1 表示可读 */
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(slot_seq(ring, i), i);
+    }
+    atomic_init(&ring->enqueue_pos, 0);
+    ring->dequeue_pos = 0;
+
+    atomic_init(&ring->consumer_sleeping, false);
+    platform_mutex_init(&ring->wake_lock);
+    platform_cond_init(&ring->wake);
+    return true;
+}
+
+void mpsc_ring_destroy(MpscRing *ring)
+{
+    if (ring->slots == NULL) {
+        return;
+    }
+    platform_cond_destroy(&ring->wake);
+    platform_mutex_destroy(&ring->wake_lock);
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+size_t mpsc_ring_capacity(const MpscRing *ring)
+{
+    return ring->mask + 1;
+}
+
+bool mpsc_ring_push(MpscRing *ring, const void *elem)
+{
+    size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+
+    for (;;) {
+        size_t seq = atomic_load_explicit(slot_seq(ring, pos), memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            /* 槽位空闲，抢占该位置 */
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  /* 消费者尚未取走一整圈之前的数据：队列已满 */
+        } else {
+            pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    memcpy(slot_data(ring, pos), elem, ring->elem_size);
+    atomic_store_explicit(slot_seq(ring, pos), pos + 1, memory_order_release);
+    return true;
+}
+
+bool mpsc_ring_pop(MpscRing *ring, void *out)
+{
+    size_t pos = ring->dequeue_pos;
+
+    if (atomic_load_explicit(slot_seq(ring, pos), memory_order_acquire) != pos + 1) {
+        return false;
+    }
+
+    memcpy(out, slot_data(ring, pos), ring->elem_size);
+    atomic_store_explicit(slot_seq(ring, pos), pos + ring->mask + 1, memory_order_release);
+    ring->dequeue_pos = pos + 1;
+    return true;
+}
+
+bool mpsc_ring_empty(MpscRing *ring)
+{
+    size_t pos = ring->dequeue_pos;
+    return atomic_load(slot_seq(ring, pos)) != pos + 1;
+}
+
+void mpsc_ring_notify(MpscRing *ring)
+{
+    /* 与 mpsc_ring_wait 中的 sleeping/empty 检查构成 Dekker 配对 */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&ring->consumer_sleeping)) {
+        mpsc_ring_wake(ring);
+    }
+}
+
+void mpsc_ring_wake(MpscRing *ring)
+{
+    platform_mutex_lock(&ring->wake_lock);
+    platform_cond_signal(&ring->wake);
+    platform_mutex_unlock(&ring->wake_lock);
+}
+
+void mpsc_ring_wait(MpscRing *ring, unsigned int timeout_ms, atomic_bool *stop)
+{
+    platform_mutex_lock(&ring->wake_lock);
+    atomic_store(&ring->consumer_sleeping, true);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (mpsc_ring_empty(ring) && (stop == NULL || !atomic_load(stop))) {
+        platform_cond_timedwait(&ring->wake, &ring->wake_lock, timeout_ms);
+    }
+    atomic_store(&ring->consumer_sleeping, false);
+    platform_mutex_unlock(&ring->wake_lock);
+}
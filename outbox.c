@@ -0,0 +1,939 @@
+/**
+ * @file outbox.c
+ * @brief 持久化同步队列实现（追加写队列文件 + 单发送线程按序重试）
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/outbox.h>
+#include <lib/engine.h>
+#include <lib/platform.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+ #include <io.h>
+#else
+ #include <unistd.h>
+#endif
+
+/* ==================== 常量配置 ==================== */
+
+#define OUTBOX_DEFAULT_FILE "Card/outbox.log"
+#define OUTBOX_DEFAULT_RETRY_BASE_MS 500
+#define OUTBOX_DEFAULT_RETRY_MAX_MS 30000
+#define OUTBOX_DEFAULT_DRAIN_TIMEOUT_MS 3000
+#define OUTBOX_DEFAULT_COALESCE_MAX 64
+#define OUTBOX_COMPACT_BYTES (64 * 1024)     /* 队列清空且文件超过该大小时截断 */
+#define OUTBOX_MAGIC 0x584F424Fu             /* "OBOX" */
+
+/* ==================== 队列记录格式 ==================== */
+
+/**
+ * @brief 定长队列记录（104字节）
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t checksum;            /* 计算时本字段置0 */
+    uint64_t seq;
+    uint64_t amount;
+    char uuid[37];
+    char uuid_to[37];
+    uint8_t type;                 /* ApiOperation */
+    uint8_t reserved[5];
+} OutboxRecord;
+
+_Static_assert(sizeof(OutboxRecord) == 104, "OutboxRecord must be 104 bytes");
+
+/* ==================== 内部结构 ==================== */
+
+/**
+ * @brief 批次合并后要发送的一个操作
+ */
+typedef struct {
+    OutboxEntry entry;
+    uint64_t credit;              /* 合并的存款合计 */
+    uint64_t debit;               /* 合并的取款合计 */
+    size_t sources;               /* 对应的记录数 */
+    bool open;                    /* 同一账户之后的存取款还能并入 */
+} OutboxBatchOp;
+
+typedef struct {
+    OutboxConfig config;
+    OutboxSendFunc send;
+    atomic_bool active;
+    bool stopping;
+    bool paused;                  /* 暂停发送（启动同步推送与拉取期间） */
+
+    PlatformMutex lock;           /* 保护以下全部字段与追加句柄 */
+    PlatformCond wake;            /* 追加或停止时唤醒发送线程 */
+    PlatformCond drained;         /* 队列清空时唤醒等待者 */
+    PlatformThread thread;
+
+    FILE *file;                   /* 追加句柄 */
+    FILE *reader;                 /* 发送线程的读取句柄 */
+    char ack_path[OUTBOX_PATH_MAX + 8];
+    char queue_id[37];            /* op_id 前缀，随状态文件保存 */
+    uint64_t acked_seq;           /* 已确认的最大序号 */
+    uint64_t next_seq;            /* 下一条追加的序号 */
+    uint64_t read_offset;         /* 第一条未确认记录在文件中的位置 */
+    uint64_t file_bytes;
+    uint64_t inflight_seq;        /* 已写入状态文件的批次最后一条序号，0为无（仅发送线程） */
+
+    OutboxEntry batch[OUTBOX_COALESCE_LIMIT];     /* 仅发送线程使用 */
+    OutboxBatchOp ops[OUTBOX_COALESCE_LIMIT];
+
+    size_t resumed;
+    uint64_t appended;
+    uint64_t sent;
+    uint64_t rejected;
+    uint64_t retries;
+    uint64_t requests;
+    uint64_t coalesced;
+    uint64_t compactions;
+    bool backing_off;
+} Outbox;
+
+static Outbox g_outbox;
+
+/* ==================== 配置 ==================== */
+
+static void outbox_default_config(OutboxConfig *config)
+{
+    config->enabled = true;
+    snprintf(config->file, sizeof(config->file), "%s", OUTBOX_DEFAULT_FILE);
+    config->fsync = true;
+    config->retry_base_ms = OUTBOX_DEFAULT_RETRY_BASE_MS;
+    config->retry_max_ms = OUTBOX_DEFAULT_RETRY_MAX_MS;
+    config->drain_timeout_ms = OUTBOX_DEFAULT_DRAIN_TIMEOUT_MS;
+    config->coalesce_max = OUTBOX_DEFAULT_COALESCE_MAX;
+}
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取同步队列配置
+ */
+bool load_outbox_config(const char *path, OutboxConfig *config)
+{
+    outbox_default_config(config);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(current_section, sizeof(current_section), "%s", p + 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "outbox") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "enabled") == 0) {
+            config->enabled = (strcmp(v, "true") == 0);
+        } else if (strcmp(k, "file") == 0 && *v != '\0') {
+            snprintf(config->file, sizeof(config->file), "%s", v);
+        } else if (strcmp(k, "fsync") == 0) {
+            config->fsync = (strcmp(v, "true") == 0);
+        } else if (strcmp(k, "retry_base_ms") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->retry_base_ms = (unsigned int)n;
+            }
+        } else if (strcmp(k, "retry_max_ms") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->retry_max_ms = (unsigned int)n;
+            }
+        } else if (strcmp(k, "drain_timeout_ms") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n >= 0) {
+                config->drain_timeout_ms = (unsigned int)n;
+            }
+        } else if (strcmp(k, "coalesce_max") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->coalesce_max = n > OUTBOX_COALESCE_LIMIT ? OUTBOX_COALESCE_LIMIT
+                                                                 : (unsigned int)n;
+            }
+        }
+    }
+
+    fclose(file);
+    if (config->retry_max_ms < config->retry_base_ms) {
+        config->retry_max_ms = config->retry_base_ms;
+    }
+    return true;
+}
+
+/* ==================== 记录编解码 ==================== */
+
+static uint32_t record_checksum(const OutboxRecord *rec)
+{
+    OutboxRecord tmp = *rec;
+    tmp.checksum = 0;
+
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    const unsigned char *p = (const unsigned char *)&tmp;
+    for (size_t i = 0; i < sizeof(tmp); i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void record_encode(OutboxRecord *rec, uint64_t seq, ApiOperation type, const char *uuid,
+                          const char *uuid_to, LLUINT amount)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->magic = OUTBOX_MAGIC;
+    rec->seq = seq;
+    rec->amount = (uint64_t)amount;
+    snprintf(rec->uuid, sizeof(rec->uuid), "%s", uuid);
+    snprintf(rec->uuid_to, sizeof(rec->uuid_to), "%s", uuid_to != NULL ? uuid_to : "");
+    rec->type = (uint8_t)type;
+    rec->checksum = record_checksum(rec);
+}
+
+static bool record_valid(const OutboxRecord *rec)
+{
+    return rec->magic == OUTBOX_MAGIC
+        && rec->type >= API_OP_CREATE && rec->type <= API_OP_DELETE
+        && memchr(rec->uuid, '\0', sizeof(rec->uuid)) != NULL
+        && memchr(rec->uuid_to, '\0', sizeof(rec->uuid_to)) != NULL
+        && rec->checksum == record_checksum(rec);
+}
+
+static void record_decode(const OutboxRecord *rec, OutboxEntry *entry)
+{
+    entry->seq = rec->seq;
+    entry->type = (ApiOperation)rec->type;
+    memcpy(entry->uuid, rec->uuid, sizeof(entry->uuid));
+    memcpy(entry->uuid_to, rec->uuid_to, sizeof(entry->uuid_to));
+    entry->amount = (LLUINT)rec->amount;
+}
+
+static bool sync_file(FILE *file)
+{
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+/* ==================== 状态文件 ==================== */
+
+static bool load_state(void)
+{
+    FILE *file = fopen(g_outbox.ack_path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[128];
+    char queue_id[37] = "";
+    uint64_t acked = 0;
+    uint64_t inflight = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "queue_id=", 9) == 0) {
+            /* 长度不是36的队列ID保持为空，下面按损坏处理 */
+            if (strlen(line + 9) == 36) {
+                memcpy(queue_id, line + 9, sizeof(queue_id));
+            }
+        } else if (strncmp(line, "acked=", 6) == 0) {
+            acked = (uint64_t)strtoull(line + 6, NULL, 10);
+        } else if (strncmp(line, "inflight=", 9) == 0) {
+            inflight = (uint64_t)strtoull(line + 9, NULL, 10);
+        }
+    }
+    fclose(file);
+
+    if (strlen(queue_id) != 36) {
+        return false;
+    }
+    memcpy(g_outbox.queue_id, queue_id, sizeof(queue_id));
+    g_outbox.acked_seq = acked;
+    g_outbox.inflight_seq = inflight > acked ? inflight : 0;
+    return true;
+}
+
+/**
+ * @brief 保存已确认序号与正在发送的批次（先写临时文件再改名）
+ * @param inflight 正在发送的批次最后一条序号，0为无
+ * @param durable 是否 fsync；截断队列文件前必须落盘，否则崩溃后序号会被重复使用
+ */
+static bool save_state(uint64_t acked, uint64_t inflight, bool durable)
+{
+    char tmp_path[sizeof(g_outbox.ack_path) + 4];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", g_outbox.ack_path);
+
+    FILE *file = fopen(tmp_path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "# BAMSYSTEM 同步队列状态（自动生成，请勿修改）\n");
+    fprintf(file, "queue_id=%s\n", g_outbox.queue_id);
+    fprintf(file, "acked=%llu\n", (unsigned long long)acked);
+    if (inflight > acked) {
+        fprintf(file, "inflight=%llu\n", (unsigned long long)inflight);
+    }
+    bool ok = durable ? sync_file(file) : fflush(file) == 0;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        remove(tmp_path);
+        return false;
+    }
+#ifdef _WIN32
+    remove(g_outbox.ack_path);
+#endif
+    return rename(tmp_path, g_outbox.ack_path) == 0;
+}
+
+/* ==================== 打开与截断 ==================== */
+
+/**
+ * @brief 把未确认的记录复制到新文件：去掉已确认的前缀和末尾不完整的记录
+ * @param max_seq 输出文件中出现过的最大序号
+ */
+static bool rewrite_pending(uint64_t *max_seq)
+{
+    *max_seq = 0;
+    FILE *in = fopen(g_outbox.config.file, "rb");
+    if (in == NULL) {
+        return errno == ENOENT;
+    }
+
+    char tmp_path[OUTBOX_PATH_MAX + 8];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", g_outbox.config.file);
+    FILE *out = fopen(tmp_path, "wb");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+
+    bool ok = true;
+    size_t index = 0;
+    OutboxRecord rec;
+    while (fread(&rec, sizeof(rec), 1, in) == 1) {
+        index++;
+        if (!record_valid(&rec) || rec.seq <= *max_seq) {
+            fprintf(stderr, "警告：%s 第 %zu 条记录不完整，其后记录已忽略\n",
+                    g_outbox.config.file, index);
+            break;
+        }
+        *max_seq = rec.seq;
+        if (rec.seq <= g_outbox.acked_seq) {
+            continue;
+        }
+        if (fwrite(&rec, sizeof(rec), 1, out) != 1) {
+            ok = false;
+            break;
+        }
+        g_outbox.resumed++;
+    }
+    fclose(in);
+
+    ok = (g_outbox.config.fsync ? sync_file(out) : fflush(out) == 0) && ok;
+    ok = (fclose(out) == 0) && ok;
+    if (!ok) {
+        remove(tmp_path);
+        return false;
+    }
+#ifdef _WIN32
+    remove(g_outbox.config.file);
+#endif
+    return rename(tmp_path, g_outbox.config.file) == 0;
+}
+
+static bool open_handles(const char *append_mode)
+{
+    g_outbox.file = fopen(g_outbox.config.file, append_mode);
+    if (g_outbox.file == NULL) {
+        return false;
+    }
+    g_outbox.reader = fopen(g_outbox.config.file, "rb");
+    if (g_outbox.reader == NULL) {
+        fclose(g_outbox.file);
+        g_outbox.file = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void close_handles(void)
+{
+    if (g_outbox.file != NULL) {
+        fclose(g_outbox.file);
+        g_outbox.file = NULL;
+    }
+    if (g_outbox.reader != NULL) {
+        fclose(g_outbox.reader);
+        g_outbox.reader = NULL;
+    }
+}
+
+static bool outbox_open(void)
+{
+    snprintf(g_outbox.ack_path, sizeof(g_outbox.ack_path), "%s.ack", g_outbox.config.file);
+    g_outbox.acked_seq = 0;
+    g_outbox.inflight_seq = 0;
+    g_outbox.resumed = 0;
+
+    bool have_state = load_state();
+    if (!have_state) {
+        generate_uuid_string(g_outbox.queue_id);
+    }
+
+    uint64_t max_seq;
+    if (!rewrite_pending(&max_seq)) {
+        fprintf(stderr, "错误：无法整理同步队列文件 %s\n", g_outbox.config.file);
+        return false;
+    }
+    if (!have_state && max_seq > 0) {
+        /* 状态文件丢失：队列标识已变，剩余记录以新标识重发（服务器无法识别此前是否执行过） */
+        fprintf(stderr, "警告：同步队列状态文件丢失，%zu 条操作将以新的标识重发\n",
+                g_outbox.resumed);
+    }
+
+    g_outbox.next_seq = (max_seq > g_outbox.acked_seq ? max_seq : g_outbox.acked_seq) + 1;
+    if (g_outbox.inflight_seq > max_seq) {
+        /* 批次末尾的记录未落盘就崩溃了：按剩下的记录重新分批 */
+        g_outbox.inflight_seq = 0;
+    }
+    g_outbox.read_offset = 0;
+    g_outbox.file_bytes = (uint64_t)g_outbox.resumed * sizeof(OutboxRecord);
+
+    /* 队列标识必须在第一条操作发出前落盘 */
+    if (!save_state(g_outbox.acked_seq, g_outbox.inflight_seq, true)) {
+        fprintf(stderr, "错误：无法写入同步队列状态文件 %s\n", g_outbox.ack_path);
+        return false;
+    }
+    return open_handles("ab");
+}
+
+/**
+ * @brief 队列已空时截断文件（调用方持有 g_outbox.lock）
+ */
+static void outbox_compact(void)
+{
+    if (!save_state(g_outbox.acked_seq, 0, true)) {
+        return;    /* 序号未落盘时不能丢弃记录 */
+    }
+    close_handles();
+    if (!open_handles("wb")) {
+        perror("错误：无法重新创建同步队列文件");
+        return;
+    }
+    g_outbox.read_offset = 0;
+    g_outbox.file_bytes = 0;
+    g_outbox.compactions++;
+}
+
+/* ==================== 发送线程 ==================== */
+
+static bool read_entries(uint64_t offset, OutboxEntry *entries, size_t count)
+{
+    if (g_outbox.reader == NULL || fseek(g_outbox.reader, (long)offset, SEEK_SET) != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        OutboxRecord rec;
+        if (fread(&rec, sizeof(rec), 1, g_outbox.reader) != 1 || !record_valid(&rec)) {
+            return false;
+        }
+        record_decode(&rec, &entries[i]);
+    }
+    return true;
+}
+
+/**
+ * @brief 关闭账户上可并入存取款的操作（转账、创建、销户是该账户的分界）
+ */
+static void close_account(OutboxBatchOp *ops, size_t count, const char *uuid)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (ops[i].open && strcmp(ops[i].entry.uuid, uuid) == 0) {
+            ops[i].open = false;
+        }
+    }
+}
+
+/**
+ * @brief 合并一批记录
+ * @param netted 输出净额为0、无需发送的记录数
+ * @return 要发送的操作数
+ */
+static size_t coalesce_batch(const OutboxEntry *entries, size_t count, OutboxBatchOp *ops,
+                             size_t *netted)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        const OutboxEntry *e = &entries[i];
+        if (e->type != API_OP_DEPOSIT && e->type != API_OP_WITHDRAW) {
+            close_account(ops, n, e->uuid);
+            if (e->type == API_OP_TRANSFER) {
+                close_account(ops, n, e->uuid_to);
+            }
+            ops[n].entry = *e;
+            ops[n].sources = 1;
+            ops[n].open = false;
+            n++;
+            continue;
+        }
+
+        uint64_t amount = (uint64_t)e->amount;
+        OutboxBatchOp *op = NULL;
+        for (size_t j = 0; j < n; j++) {
+            if (ops[j].open && strcmp(ops[j].entry.uuid, e->uuid) == 0) {
+                op = &ops[j];
+                break;
+            }
+        }
+        uint64_t total = op == NULL ? 0 : (e->type == API_OP_DEPOSIT ? op->credit : op->debit);
+        if (op != NULL && total > UINT64_MAX - amount) {
+            op->open = false;    /* 合计溢出，之后另起一个 */
+            op = NULL;
+        }
+        if (op == NULL) {
+            op = &ops[n++];
+            op->entry = *e;
+            op->credit = 0;
+            op->debit = 0;
+            op->sources = 0;
+            op->open = true;
+        }
+        if (e->type == API_OP_DEPOSIT) {
+            op->credit += amount;
+        } else {
+            op->debit += amount;
+        }
+        op->sources++;
+    }
+
+    /* 存取款换成净额，净额为0的去掉 */
+    size_t out = 0;
+    *netted = 0;
+    for (size_t i = 0; i < n; i++) {
+        OutboxBatchOp *op = &ops[i];
+        if (op->entry.type == API_OP_DEPOSIT || op->entry.type == API_OP_WITHDRAW) {
+            if (op->credit == op->debit) {
+                *netted += op->sources;
+                continue;
+            }
+            op->entry.type = op->credit > op->debit ? API_OP_DEPOSIT : API_OP_WITHDRAW;
+            op->entry.amount = (LLUINT)(op->credit > op->debit ? op->credit - op->debit
+                                                               : op->debit - op->credit);
+        }
+        if (out != i) {
+            ops[out] = *op;
+        }
+        out++;
+    }
+    return out;
+}
+
+static const char* operation_name(ApiOperation type)
+{
+    switch (type) {
+    case API_OP_CREATE:
+        return "创建账户";
+    case API_OP_DEPOSIT:
+        return "存款";
+    case API_OP_WITHDRAW:
+        return "取款";
+    case API_OP_TRANSFER:
+        return "转账";
+    case API_OP_DELETE:
+        return "销户";
+    default:
+        return "未知操作";
+    }
+}
+
+/**
+ * @brief 退避等待，停止时提前返回（调用方持有 g_outbox.lock）
+ */
+static void backoff_wait(unsigned int ms)
+{
+    uint64_t deadline = platform_monotonic_ns() + (uint64_t)ms * 1000000ull;
+    g_outbox.backing_off = true;
+    while (!g_outbox.stopping) {
+        uint64_t now = platform_monotonic_ns();
+        if (now >= deadline) {
+            break;
+        }
+        platform_cond_timedwait(&g_outbox.wake, &g_outbox.lock,
+                                (unsigned int)((deadline - now + 999999) / 1000000));
+    }
+    g_outbox.backing_off = false;
+}
+
+/**
+ * @brief 发送批次中从 *done 开始的操作，服务器执行或拒绝后推进 *done
+ * @return 遇到可重试的失败返回 API_SEND_RETRY
+ */
+static ApiSendResult send_batch(uint64_t last, size_t batch_count, size_t op_count, size_t *done)
+{
+    char op_id[OUTBOX_OP_ID_MAX + 1];
+
+    while (*done < op_count) {
+        const OutboxBatchOp *op = &g_outbox.ops[*done];
+        if (batch_count == 1) {
+            snprintf(op_id, sizeof(op_id), "%s-%llu", g_outbox.queue_id,
+                     (unsigned long long)op->entry.seq);
+        } else {
+            /* 批次由最后一条序号确定，成员不变，op_id 在重试与重启后保持一致 */
+            snprintf(op_id, sizeof(op_id), "%s-%llu.%zu", g_outbox.queue_id,
+                     (unsigned long long)last, *done);
+        }
+
+        ApiSendResult result = g_outbox.send(&op->entry, op_id);
+        if (result == API_SEND_RETRY) {
+            return result;
+        }
+        if (result == API_SEND_REJECTED) {
+            if (op->sources > 1) {
+                fprintf(stderr, "警告：服务器拒绝了同步队列中的%s（%s，由 %zu 笔合并），已跳过\n",
+                        operation_name(op->entry.type), op->entry.uuid, op->sources);
+            } else {
+                fprintf(stderr, "警告：服务器拒绝了同步队列中的%s（%s），已跳过\n",
+                        operation_name(op->entry.type), op->entry.uuid);
+            }
+        }
+
+        platform_mutex_lock(&g_outbox.lock);
+        g_outbox.requests++;
+        if (result == API_SEND_OK) {
+            g_outbox.sent += op->sources;
+        } else {
+            g_outbox.rejected += op->sources;
+        }
+        platform_mutex_unlock(&g_outbox.lock);
+        (*done)++;
+    }
+    return API_SEND_OK;
+}
+
+static void outbox_main(void *arg)
+{
+    (void)arg;
+    unsigned int backoff = 0;
+    uint64_t batch_last = 0;      /* 已合并好的批次，重试时从 batch_done 继续 */
+    size_t batch_ops = 0;
+    size_t batch_netted = 0;
+    size_t batch_done = 0;
+
+    platform_mutex_lock(&g_outbox.lock);
+    for (;;) {
+        while ((g_outbox.acked_seq + 1 == g_outbox.next_seq || g_outbox.paused) &&
+               !g_outbox.stopping) {
+            platform_cond_wait(&g_outbox.wake, &g_outbox.lock);
+        }
+        if (g_outbox.stopping) {
+            break;    /* 未发送的操作留在文件中，下次启动继续 */
+        }
+        uint64_t first = g_outbox.acked_seq + 1;
+        uint64_t last = g_outbox.next_seq - 1;
+        if (g_outbox.inflight_seq > g_outbox.acked_seq) {
+            last = g_outbox.inflight_seq;    /* 已记录的批次，范围不能变 */
+        } else if (last - first >= g_outbox.config.coalesce_max) {
+            last = first + g_outbox.config.coalesce_max - 1;
+        }
+        uint64_t offset = g_outbox.read_offset;
+        platform_mutex_unlock(&g_outbox.lock);
+
+        /* 发送期间不持锁，追加不受网络往返影响 */
+        size_t count = (size_t)(last - first + 1);
+        ApiSendResult result = API_SEND_RETRY;
+        if (batch_last != last) {
+            batch_last = 0;
+            if (!read_entries(offset, g_outbox.batch, count)) {
+                fprintf(stderr, "错误：无法读取同步队列文件 %s\n", g_outbox.config.file);
+            } else if (g_outbox.inflight_seq != last &&
+                       !save_state(first - 1, last, g_outbox.config.fsync)) {
+                /* 批次范围未记录就发送，重启后可能分批不同、op_id 改变，服务器无法去重 */
+                fprintf(stderr, "错误：无法写入同步队列状态文件 %s\n", g_outbox.ack_path);
+            } else {
+                g_outbox.inflight_seq = last;
+                batch_ops = coalesce_batch(g_outbox.batch, count, g_outbox.ops, &batch_netted);
+                batch_done = 0;
+                batch_last = last;
+            }
+        }
+        if (batch_last == last) {
+            result = send_batch(last, count, batch_ops, &batch_done);
+        }
+
+        if (result == API_SEND_RETRY) {
+            backoff = backoff == 0 ? g_outbox.config.retry_base_ms
+                    : (backoff > g_outbox.config.retry_max_ms / 2 ? g_outbox.config.retry_max_ms
+                                                                  : backoff * 2);
+            platform_mutex_lock(&g_outbox.lock);
+            g_outbox.retries++;
+            backoff_wait(backoff);
+            continue;
+        }
+        backoff = 0;
+        batch_last = 0;
+
+        platform_mutex_lock(&g_outbox.lock);
+        /* 只有发送线程写状态文件；还有积压时确认随下一批的范围一起写入。
+         * 丢失的确认只会导致同一批重发，服务器按 op_id 去重 */
+        if (last + 1 == g_outbox.next_seq) {
+            save_state(last, 0, false);
+        }
+        g_outbox.acked_seq = last;
+        g_outbox.inflight_seq = 0;
+        g_outbox.read_offset += (uint64_t)count * sizeof(OutboxRecord);
+        g_outbox.sent += batch_netted;
+        g_outbox.coalesced += count - batch_ops;
+        if (g_outbox.acked_seq + 1 == g_outbox.next_seq) {
+            if (g_outbox.file_bytes >= OUTBOX_COMPACT_BYTES) {
+                outbox_compact();
+            }
+            platform_cond_broadcast(&g_outbox.drained);
+        }
+    }
+    platform_mutex_unlock(&g_outbox.lock);
+}
+
+/* ==================== 生命周期 ==================== */
+
+static ApiSendResult outbox_server_send(const OutboxEntry *entry, const char *op_id)
+{
+    return api_send_operation(entry->type, op_id, entry->uuid,
+                              entry->type == API_OP_TRANSFER ? entry->uuid_to : NULL,
+                              entry->amount);
+}
+
+bool outbox_start(const OutboxConfig *config, OutboxSendFunc send)
+{
+    if (atomic_load(&g_outbox.active)) {
+        return true;
+    }
+
+    g_outbox.config = *config;
+    g_outbox.send = send != NULL ? send : outbox_server_send;
+    g_outbox.stopping = false;
+    g_outbox.paused = false;
+    g_outbox.appended = 0;
+    g_outbox.sent = 0;
+    g_outbox.rejected = 0;
+    g_outbox.retries = 0;
+    g_outbox.requests = 0;
+    g_outbox.coalesced = 0;
+    g_outbox.compactions = 0;
+    g_outbox.backing_off = false;
+
+    if (!outbox_open()) {
+        close_handles();
+        return false;
+    }
+
+    platform_mutex_init(&g_outbox.lock);
+    platform_cond_init(&g_outbox.wake);
+    platform_cond_init(&g_outbox.drained);
+    if (!platform_thread_create(&g_outbox.thread, outbox_main, NULL)) {
+        fprintf(stderr, "错误：无法启动同步队列发送线程\n");
+        platform_cond_destroy(&g_outbox.drained);
+        platform_cond_destroy(&g_outbox.wake);
+        platform_mutex_destroy(&g_outbox.lock);
+        close_handles();
+        return false;
+    }
+
+    atomic_store(&g_outbox.active, true);
+    return true;
+}
+
+bool init_outbox(void)
+{
+    OutboxConfig config;
+    load_outbox_config(ENGINE_CONFIG_FILE, &config);
+    if (!config.enabled) {
+        return false;
+    }
+
+    if (!outbox_start(&config, NULL)) {
+        fprintf(stderr, "警告：同步队列启动失败，交易将直接同步到服务器\n");
+        return false;
+    }
+
+    /* 先发完上次遗留的操作，再做启动推送，避免服务器上的余额被重复累加 */
+    if (g_outbox.resumed > 0) {
+        printf("[同步队列] 恢复 %zu 条未发送的操作，正在发送...\n", g_outbox.resumed);
+        OutboxStats stats;
+        outbox_wait_drained(config.drain_timeout_ms);
+        outbox_get_stats(&stats);
+        printf("[同步队列] 已发送 %llu 条，拒绝 %llu 条，剩余 %zu 条\n",
+               (unsigned long long)stats.sent, (unsigned long long)stats.rejected, stats.pending);
+    }
+    return true;
+}
+
+void cleanup_outbox(void)
+{
+    if (!atomic_load(&g_outbox.active)) {
+        return;
+    }
+
+    /* 服务器可达时尽量发完；正在退避（服务器不可用）时不再等待 */
+    platform_mutex_lock(&g_outbox.lock);
+    g_outbox.paused = false;
+    platform_cond_broadcast(&g_outbox.wake);
+    bool backing_off = g_outbox.backing_off;
+    platform_mutex_unlock(&g_outbox.lock);
+    if (!backing_off) {
+        outbox_wait_drained(g_outbox.config.drain_timeout_ms);
+    }
+
+    atomic_store(&g_outbox.active, false);
+    platform_mutex_lock(&g_outbox.lock);
+    g_outbox.stopping = true;
+    platform_cond_broadcast(&g_outbox.wake);
+    platform_mutex_unlock(&g_outbox.lock);
+
+    platform_thread_join(g_outbox.thread);
+    close_handles();
+    platform_cond_destroy(&g_outbox.drained);
+    platform_cond_destroy(&g_outbox.wake);
+    platform_mutex_destroy(&g_outbox.lock);
+}
+
+bool outbox_active(void)
+{
+    return atomic_load(&g_outbox.active);
+}
+
+void outbox_get_stats(OutboxStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!atomic_load(&g_outbox.active)) {
+        return;
+    }
+    platform_mutex_lock(&g_outbox.lock);
+    stats->pending = (size_t)(g_outbox.next_seq - 1 - g_outbox.acked_seq);
+    stats->resumed = g_outbox.resumed;
+    stats->appended = g_outbox.appended;
+    stats->sent = g_outbox.sent;
+    stats->rejected = g_outbox.rejected;
+    stats->retries = g_outbox.retries;
+    stats->requests = g_outbox.requests;
+    stats->coalesced = g_outbox.coalesced;
+    stats->compactions = g_outbox.compactions;
+    stats->file_bytes = g_outbox.file_bytes;
+    stats->backing_off = g_outbox.backing_off;
+    platform_mutex_unlock(&g_outbox.lock);
+}
+
+/* ==================== 追加与等待 ==================== */
+
+bool outbox_append(ApiOperation type, const char *uuid, const char *uuid_to, LLUINT amount)
+{
+    if (!atomic_load(&g_outbox.active) || uuid == NULL) {
+        return false;
+    }
+
+    platform_mutex_lock(&g_outbox.lock);
+    if (g_outbox.file == NULL || g_outbox.stopping) {
+        platform_mutex_unlock(&g_outbox.lock);
+        return false;
+    }
+
+    OutboxRecord rec;
+    record_encode(&rec, g_outbox.next_seq, type, uuid, uuid_to, amount);
+    bool ok = fwrite(&rec, sizeof(rec), 1, g_outbox.file) == 1;
+    ok = ok && (g_outbox.config.fsync ? sync_file(g_outbox.file) : fflush(g_outbox.file) == 0);
+    if (!ok) {
+        /* 文件末尾可能留下半条记录，之后的追加会错位；停止追加，下次启动时丢弃半条记录 */
+        perror("错误：写入同步队列失败");
+        fclose(g_outbox.file);
+        g_outbox.file = NULL;
+        platform_mutex_unlock(&g_outbox.lock);
+        return false;
+    }
+
+    g_outbox.next_seq++;
+    g_outbox.appended++;
+    g_outbox.file_bytes += sizeof(rec);
+    platform_cond_signal(&g_outbox.wake);
+    platform_mutex_unlock(&g_outbox.lock);
+    return true;
+}
+
+void outbox_set_paused(bool paused)
+{
+    if (!atomic_load(&g_outbox.active)) {
+        return;
+    }
+    platform_mutex_lock(&g_outbox.lock);
+    g_outbox.paused = paused;
+    platform_cond_broadcast(&g_outbox.wake);
+    platform_mutex_unlock(&g_outbox.lock);
+}
+
+bool outbox_wait_drained(unsigned int timeout_ms)
+{
+    if (!atomic_load(&g_outbox.active)) {
+        return false;
+    }
+
+    uint64_t deadline = platform_monotonic_ns() + (uint64_t)timeout_ms * 1000000ull;
+    platform_mutex_lock(&g_outbox.lock);
+    while (g_outbox.acked_seq + 1 != g_outbox.next_seq) {
+        uint64_t now = platform_monotonic_ns();
+        if (now >= deadline) {
+            break;
+        }
+        platform_cond_timedwait(&g_outbox.drained, &g_outbox.lock,
+                                (unsigned int)((deadline - now + 999999) / 1000000));
+    }
+    bool drained = g_outbox.acked_seq + 1 == g_outbox.next_seq;
+    platform_mutex_unlock(&g_outbox.lock);
+    return drained;
+}
@@ -0,0 +1,1141 @@
+/**
+ * @file replication.c
+ * @brief 热备复制实现（主节点推送账户变更，备节点应用并确认）
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/replication.h>
+#include <lib/engine.h>
+#include <lib/shard.h>
+#include <lib/platform.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+ #include <errno.h>
+ #include <netdb.h>
+ #include <netinet/in.h>
+ #include <netinet/tcp.h>
+ #include <poll.h>
+ #include <sys/socket.h>
+ #include <sys/un.h>
+ #include <unistd.h>
+#endif
+
+/* ==================== 常量配置 ==================== */
+
+#define REPLICATION_DEFAULT_TIMEOUT_MS 1000
+#define REPLICATION_DEFAULT_BACKLOG 65536
+#define REPLICATION_MAX_BACKLOG (16u * 1024 * 1024)
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取复制配置
+ */
+bool load_replication_config(const char *path, ReplicationConfig *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->role = REPLICATION_ROLE_NONE;
+    config->ack = REPLICATION_ACK_ASYNC;
+    config->sync_timeout_ms = REPLICATION_DEFAULT_TIMEOUT_MS;
+    config->backlog = REPLICATION_DEFAULT_BACKLOG;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(current_section, sizeof(current_section), "%s", p + 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "replication") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "role") == 0) {
+            if (strcmp(v, "primary") == 0) {
+                config->role = REPLICATION_ROLE_PRIMARY;
+            } else if (strcmp(v, "follower") == 0) {
+                config->role = REPLICATION_ROLE_FOLLOWER;
+            } else if (strcmp(v, "none") == 0) {
+                config->role = REPLICATION_ROLE_NONE;
+            } else {
+                fprintf(stderr, "警告：engine.conf 中 role=%s 无效，不启用复制\n", v);
+            }
+        } else if (strcmp(k, "address") == 0) {
+            snprintf(config->address, sizeof(config->address), "%s", v);
+        } else if (strcmp(k, "promote_address") == 0) {
+            snprintf(config->promote_address, sizeof(config->promote_address), "%s", v);
+        } else if (strcmp(k, "ack") == 0) {
+            if (strcmp(v, "sync") == 0) {
+                config->ack = REPLICATION_ACK_SYNC;
+            } else if (strcmp(v, "async") == 0) {
+                config->ack = REPLICATION_ACK_ASYNC;
+            } else {
+                fprintf(stderr, "警告：engine.conf 中 ack=%s 无效，使用 async\n", v);
+            }
+        } else if (strcmp(k, "sync_timeout_ms") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->sync_timeout_ms = (unsigned int)n;
+            }
+        } else if (strcmp(k, "backlog") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0 && (unsigned long)n <= REPLICATION_MAX_BACKLOG) {
+                config->backlog = (size_t)n;
+            }
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+const char* replication_role_string(ReplicationRole role)
+{
+    switch (role) {
+    case REPLICATION_ROLE_PRIMARY:  return "主节点";
+    case REPLICATION_ROLE_FOLLOWER: return "备节点";
+    default:                        return "未启用";
+    }
+}
+
+#ifdef _WIN32
+
+/* ==================== Windows：不支持 ==================== */
+
+bool init_replication(void)
+{
+    ReplicationConfig config;
+    load_replication_config(ENGINE_CONFIG_FILE, &config);
+    if (config.role != REPLICATION_ROLE_NONE) {
+        fprintf(stderr, "警告：当前平台不支持热备复制，已忽略 [replication] role\n");
+    }
+    return true;
+}
+
+bool replication_start(const ReplicationConfig *config)
+{
+    (void)config;
+    return false;
+}
+
+void cleanup_replication(void) {}
+ReplicationRole replication_role(void) { return REPLICATION_ROLE_NONE; }
+bool replication_is_follower(void) { return false; }
+bool replication_promote(void) { return false; }
+
+void replication_get_stats(ReplicationStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+void replication_record_put(const ACCOUNT *acc)
+{
+    (void)acc;
+}
+
+void replication_record_delete(const char *uuid)
+{
+    (void)uuid;
+}
+
+void replication_wait_commit(void) {}
+
+#else
+
+/* ==================== 协议 ==================== */
+
+#define REPLICATION_MAGIC 0x50455242u     /* "BREP" */
+#define REPLICATION_MAX_BATCH 256         /* 每帧最多记录数 */
+#define REPLICATION_POLL_MS 200           /* 阻塞读写的轮询间隔（检查停止标志） */
+#define REPLICATION_RETRY_MS 500          /* 备节点重连间隔 */
+
+typedef enum {
+    REPL_MSG_HELLO = 1,           /* 备 -> 主：seq=已应用序号，epoch=数据所属主节点 */
+    REPL_MSG_RECORDS,             /* 主 -> 备：count 条连续记录，seq=最后一条的序号 */
+    REPL_MSG_SNAPSHOT_BEGIN,      /* 主 -> 备：全量同步开始，备节点清空本地账户 */
+    REPL_MSG_SNAPSHOT_DATA,       /* 主 -> 备：count 条快照记录 */
+    REPL_MSG_SNAPSHOT_END,        /* 主 -> 备：全量同步结束，seq=快照基准序号 */
+    REPL_MSG_ACK                  /* 备 -> 主：seq=已应用序号 */
+} ReplMsgType;
+
+typedef enum {
+    REPL_RECORD_PUT = 1,
+    REPL_RECORD_DELETE = 2
+} ReplRecordType;
+
+/**
+ * @brief 帧头
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t type;
+    uint16_t count;
+    uint64_t seq;
+    uint64_t epoch;               /* 主节点本次启动的标识 */
+    uint64_t head_seq;            /* 主节点当前最新序号 */
+    uint64_t commit_ns;           /* 最后一条记录的提交时刻（单调时钟，同机进程间可比） */
+} ReplFrameHeader;
+
+/**
+ * @brief 变更记录
+ *
+ * 各节点的 system.key 不同，.card 文件的加密不能跨节点使用，因此明文传输；
+ * 复制只用于本机套接字或可信的本地网络。
+ */
+typedef struct {
+    char uuid[37];
+    uint8_t type;
+    uint8_t reserved[2];
+    LLUINT password;
+    LLUINT balance;
+} ReplRecord;
+
+_Static_assert(sizeof(ReplFrameHeader) == 40, "ReplFrameHeader must be 40 bytes");
+_Static_assert(sizeof(ReplRecord) == 56, "ReplRecord must be 56 bytes");
+
+typedef struct {
+    ReplRecord rec;
+    uint64_t seq;
+    uint64_t commit_ns;
+} ReplBacklogEntry;
+
+/* ==================== 内部结构 ==================== */
+
+typedef struct {
+    ReplicationConfig config;
+    atomic_int role;              /* ReplicationRole，记录钩子据此判断 */
+    atomic_bool stopping;
+    bool thread_started;
+    PlatformThread thread;
+    bool lock_inited;
+
+    PlatformMutex lock;           /* 保护以下全部字段 */
+    PlatformCond data_cond;       /* 新记录 / 连接断开 / 停止（唤醒发送方） */
+    PlatformCond ack_cond;        /* 新确认 / 连接断开（唤醒 sync 等待方） */
+
+    /* 主节点 */
+    uint64_t epoch;
+    ReplBacklogEntry *backlog;    /* 按 seq % capacity 存放最近的记录 */
+    size_t backlog_capacity;
+    uint64_t last_seq;
+    uint64_t acked_seq;
+    int listen_fd;
+    bool conn_broken;             /* 确认线程发现连接断开 */
+
+    /* 备节点 */
+    uint64_t primary_epoch;       /* 本地数据来自哪个主节点，0 表示未知 */
+    uint64_t applied_seq;
+    uint64_t head_seq;
+    uint64_t last_lag_us;
+
+    bool connected;
+    size_t records;
+    size_t resyncs;
+    size_t sync_waits;
+    size_t sync_timeouts;
+} Replication;
+
+static Replication g_repl = { .listen_fd = -1 };
+
+/* 当前线程最近一次记录的序号（sync 模式下等待其被确认） */
+static _Thread_local uint64_t t_last_seq = 0;
+
+/* ==================== 记录编码 ==================== */
+
+static void record_encode(ReplRecord *rec, ReplRecordType type, const ACCOUNT *acc, const char *uuid)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->type = (uint8_t)type;
+    snprintf(rec->uuid, sizeof(rec->uuid), "%s", acc != NULL ? acc->UUID : uuid);
+    if (acc != NULL) {
+        rec->password = acc->PASSWORD;
+        rec->balance = acc->BALANCE;
+    }
+}
+
+static void record_decode(const ReplRecord *rec, ACCOUNT *acc)
+{
+    memset(acc, 0, sizeof(*acc));
+    memcpy(acc->UUID, rec->uuid, sizeof(rec->uuid));
+    acc->UUID[36] = '\0';
+    acc->PASSWORD = rec->password;
+    acc->BALANCE = rec->balance;
+}
+
+/* ==================== 套接字 ==================== */
+
+/**
+ * @brief 解析 unix:<路径> 或 tcp:<主机>:<端口>
+ */
+static bool repl_resolve(const char *address, struct sockaddr_storage *ss, socklen_t *len)
+{
+    memset(ss, 0, sizeof(*ss));
+
+    if (strncmp(address, "unix:", 5) == 0) {
+        struct sockaddr_un *un = (struct sockaddr_un *)ss;
+        const char *path = address + 5;
+        if (*path == '\0' || strlen(path) >= sizeof(un->sun_path)) {
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        memcpy(un->sun_path, path, strlen(path) + 1);
+        *len = (socklen_t)sizeof(*un);
+        return true;
+    }
+
+    if (strncmp(address, "tcp:", 4) == 0) {
+        char host[REPLICATION_ADDRESS_MAX];
+        snprintf(host, sizeof(host), "%s", address + 4);
+        char *colon = strrchr(host, ':');
+        if (colon == NULL) {
+            return false;
+        }
+        *colon = '\0';
+
+        struct addrinfo hints;
+        struct addrinfo *res = NULL;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host, colon + 1, &hints, &res) != 0 || res == NULL) {
+            return false;
+        }
+        memcpy(ss, res->ai_addr, res->ai_addrlen);
+        *len = (socklen_t)res->ai_addrlen;
+        freeaddrinfo(res);
+        return true;
+    }
+
+    return false;
+}
+
+static void repl_tune_socket(int fd, const struct sockaddr_storage *ss)
+{
+    if (ss->ss_family != AF_UNIX) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+}
+
+static int repl_listen(const char *address)
+{
+    struct sockaddr_storage ss;
+    socklen_t len;
+    if (!repl_resolve(address, &ss, &len)) {
+        fprintf(stderr, "错误：复制地址无效：%s\n", address);
+        return -1;
+    }
+
+    int fd = socket(ss.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ss.ss_family == AF_UNIX) {
+        unlink(((struct sockaddr_un *)&ss)->sun_path);
+    } else {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    if (bind(fd, (struct sockaddr *)&ss, len) != 0 || listen(fd, 4) != 0) {
+        fprintf(stderr, "错误：无法在 %s 监听：%s\n", address, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int repl_connect(const char *address)
+{
+    struct sockaddr_storage ss;
+    socklen_t len;
+    if (!repl_resolve(address, &ss, &len)) {
+        return -1;
+    }
+
+    int fd = socket(ss.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&ss, len) != 0) {
+        close(fd);
+        return -1;
+    }
+    repl_tune_socket(fd, &ss);
+    return fd;
+}
+
+static bool repl_send_all(int fd, const void *buf, size_t len)
+{
+    const char *p = (const char *)buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * @brief 读满 len 字节；停止标志置位、对端关闭或出错时返回false
+ */
+static bool repl_recv_all(int fd, void *buf, size_t len)
+{
+    char *p = (char *)buf;
+    while (len > 0) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int r = poll(&pfd, 1, REPLICATION_POLL_MS);
+        if (atomic_load(&g_repl.stopping)) {
+            return false;
+        }
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            if (r < 0) {
+                return false;
+            }
+            continue;
+        }
+        ssize_t n = recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool repl_send_frame(int fd, ReplFrameHeader *hdr, const ReplRecord *recs)
+{
+    char frame[sizeof(ReplFrameHeader) + REPLICATION_MAX_BATCH * sizeof(ReplRecord)];
+    size_t len = sizeof(*hdr) + (size_t)hdr->count * sizeof(ReplRecord);
+    hdr->magic = REPLICATION_MAGIC;
+    memcpy(frame, hdr, sizeof(*hdr));
+    if (hdr->count > 0) {
+        memcpy(frame + sizeof(*hdr), recs, (size_t)hdr->count * sizeof(ReplRecord));
+    }
+    return repl_send_all(fd, frame, len);
+}
+
+static bool repl_recv_frame(int fd, ReplFrameHeader *hdr, ReplRecord *recs)
+{
+    if (!repl_recv_all(fd, hdr, sizeof(*hdr)) || hdr->magic != REPLICATION_MAGIC ||
+        hdr->count > REPLICATION_MAX_BATCH) {
+        return false;
+    }
+    return hdr->count == 0 || repl_recv_all(fd, recs, (size_t)hdr->count * sizeof(ReplRecord));
+}
+
+/* ==================== 主节点 ==================== */
+
+/**
+ * @brief 确认线程：读取备节点的 ACK
+ */
+static void primary_ack_main(void *arg)
+{
+    int fd = *(int *)arg;
+    ReplFrameHeader hdr;
+    ReplRecord unused[1];
+
+    while (repl_recv_frame(fd, &hdr, unused) && hdr.type == REPL_MSG_ACK && hdr.count == 0) {
+        platform_mutex_lock(&g_repl.lock);
+        if (hdr.seq > g_repl.acked_seq) {
+            g_repl.acked_seq = hdr.seq;
+        }
+        platform_cond_broadcast(&g_repl.ack_cond);
+        platform_mutex_unlock(&g_repl.lock);
+    }
+
+    platform_mutex_lock(&g_repl.lock);
+    g_repl.conn_broken = true;
+    platform_cond_broadcast(&g_repl.data_cond);
+    platform_mutex_unlock(&g_repl.lock);
+}
+
+/**
+ * @brief 全量同步：发送基准序号之前的全部账户
+ * @return 成功返回基准序号之后的下一个序号，失败返回0
+ */
+static uint64_t primary_send_snapshot(int fd, ReplRecord *recs)
+{
+    platform_mutex_lock(&g_repl.lock);
+    uint64_t base = g_repl.last_seq;
+    platform_mutex_unlock(&g_repl.lock);
+
+    /* 基准之后的变更随后增量发送；记录是整条账户值，重复应用结果相同 */
+    size_t capacity = 4096;
+    ACCOUNT *accounts = NULL;
+    size_t count = 0;
+    for (;;) {
+        ACCOUNT *grown = (ACCOUNT *)realloc(accounts, capacity * sizeof(ACCOUNT));
+        if (grown == NULL) {
+            free(accounts);
+            return 0;
+        }
+        accounts = grown;
+        bool truncated = false;
+        count = account_collect_all(accounts, capacity, &truncated);
+        if (!truncated) {
+            break;
+        }
+        capacity *= 2;
+    }
+
+    ReplFrameHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = REPL_MSG_SNAPSHOT_BEGIN;
+    hdr.seq = base;
+    hdr.epoch = g_repl.epoch;
+    bool ok = repl_send_frame(fd, &hdr, NULL);
+
+    for (size_t i = 0; ok && i < count; ) {
+        size_t n = 0;
+        while (n < REPLICATION_MAX_BATCH && i < count) {
+            record_encode(&recs[n++], REPL_RECORD_PUT, &accounts[i++], NULL);
+        }
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.type = REPL_MSG_SNAPSHOT_DATA;
+        hdr.count = (uint16_t)n;
+        hdr.epoch = g_repl.epoch;
+        ok = repl_send_frame(fd, &hdr, recs);
+    }
+    free(accounts);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = REPL_MSG_SNAPSHOT_END;
+    hdr.seq = base;
+    hdr.epoch = g_repl.epoch;
+    hdr.head_seq = base;
+    ok = ok && repl_send_frame(fd, &hdr, NULL);
+    if (!ok) {
+        return 0;
+    }
+
+    platform_mutex_lock(&g_repl.lock);
+    g_repl.resyncs++;
+    platform_mutex_unlock(&g_repl.lock);
+    return base + 1;
+}
+
+/**
+ * @brief 为一个已连接的备节点服务，直到连接断开或停止
+ */
+static void primary_serve(int fd)
+{
+    static ReplRecord recs[REPLICATION_MAX_BATCH];   /* 仅主节点线程使用 */
+    ReplFrameHeader hello;
+    if (!repl_recv_frame(fd, &hello, recs) || hello.type != REPL_MSG_HELLO) {
+        return;
+    }
+
+    platform_mutex_lock(&g_repl.lock);
+    bool resume = hello.epoch == g_repl.epoch && hello.seq <= g_repl.last_seq &&
+                  g_repl.last_seq - hello.seq < g_repl.backlog_capacity;
+    g_repl.acked_seq = resume ? hello.seq : 0;
+    g_repl.conn_broken = false;
+    g_repl.connected = true;
+    platform_mutex_unlock(&g_repl.lock);
+
+    PlatformThread ack_thread;
+    int ack_fd = fd;
+    if (!platform_thread_create(&ack_thread, primary_ack_main, &ack_fd)) {
+        platform_mutex_lock(&g_repl.lock);
+        g_repl.connected = false;
+        platform_mutex_unlock(&g_repl.lock);
+        return;
+    }
+
+    uint64_t next = resume ? hello.seq + 1 : primary_send_snapshot(fd, recs);
+
+    while (next != 0) {
+        platform_mutex_lock(&g_repl.lock);
+        while (!atomic_load(&g_repl.stopping) && !g_repl.conn_broken && g_repl.last_seq < next) {
+            platform_cond_timedwait(&g_repl.data_cond, &g_repl.lock, REPLICATION_POLL_MS);
+        }
+        if (atomic_load(&g_repl.stopping) || g_repl.conn_broken) {
+            platform_mutex_unlock(&g_repl.lock);
+            break;
+        }
+
+        /* 备节点落后超过 backlog，所需记录已被覆盖，改为全量同步 */
+        if (g_repl.last_seq - next >= g_repl.backlog_capacity) {
+            platform_mutex_unlock(&g_repl.lock);
+            next = primary_send_snapshot(fd, recs);
+            continue;
+        }
+
+        uint64_t avail = g_repl.last_seq - next + 1;
+        size_t n = avail < REPLICATION_MAX_BATCH ? (size_t)avail : REPLICATION_MAX_BATCH;
+        ReplFrameHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        for (size_t i = 0; i < n; i++) {
+            const ReplBacklogEntry *e = &g_repl.backlog[(next + i) % g_repl.backlog_capacity];
+            recs[i] = e->rec;
+            hdr.commit_ns = e->commit_ns;
+        }
+        hdr.type = REPL_MSG_RECORDS;
+        hdr.count = (uint16_t)n;
+        hdr.seq = next + n - 1;
+        hdr.epoch = g_repl.epoch;
+        hdr.head_seq = g_repl.last_seq;
+        platform_mutex_unlock(&g_repl.lock);
+
+        if (!repl_send_frame(fd, &hdr, recs)) {
+            break;
+        }
+        next += n;
+
+        platform_mutex_lock(&g_repl.lock);
+        g_repl.records += n;
+        platform_mutex_unlock(&g_repl.lock);
+    }
+
+    shutdown(fd, SHUT_RDWR);
+    platform_thread_join(ack_thread);
+
+    platform_mutex_lock(&g_repl.lock);
+    g_repl.connected = false;
+    platform_cond_broadcast(&g_repl.ack_cond);
+    platform_mutex_unlock(&g_repl.lock);
+}
+
+/**
+ * @brief 主节点线程：一次服务一个备节点
+ */
+static void primary_main(void *arg)
+{
+    (void)arg;
+    while (!atomic_load(&g_repl.stopping)) {
+        struct pollfd pfd = { g_repl.listen_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, REPLICATION_POLL_MS) <= 0) {
+            continue;
+        }
+        int fd = accept(g_repl.listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        primary_serve(fd);
+        close(fd);
+    }
+}
+
+static uint64_t repl_new_epoch(void)
+{
+    uint64_t epoch = platform_monotonic_ns() ^ ((uint64_t)time(NULL) << 20) ^
+                     ((uint64_t)getpid() << 40);
+    return epoch != 0 ? epoch : 1;
+}
+
+static bool primary_start(const char *address, size_t backlog)
+{
+    ReplBacklogEntry *entries = (ReplBacklogEntry *)calloc(backlog, sizeof(ReplBacklogEntry));
+    if (entries == NULL) {
+        fprintf(stderr, "错误：复制 backlog 内存分配失败\n");
+        return false;
+    }
+    int fd = repl_listen(address);
+    if (fd < 0) {
+        free(entries);
+        return false;
+    }
+
+    platform_mutex_lock(&g_repl.lock);
+    g_repl.backlog = entries;
+    g_repl.backlog_capacity = backlog;
+    g_repl.epoch = repl_new_epoch();
+    g_repl.last_seq = 0;
+    g_repl.acked_seq = 0;
+    g_repl.connected = false;
+    platform_mutex_unlock(&g_repl.lock);
+    g_repl.listen_fd = fd;
+    snprintf(g_repl.config.address, sizeof(g_repl.config.address), "%s", address);
+
+    atomic_store(&g_repl.stopping, false);
+    if (!platform_thread_create(&g_repl.thread, primary_main, NULL)) {
+        close(fd);
+        g_repl.listen_fd = -1;
+        platform_mutex_lock(&g_repl.lock);
+        g_repl.backlog = NULL;
+        platform_mutex_unlock(&g_repl.lock);
+        free(entries);
+        return false;
+    }
+    g_repl.thread_started = true;
+    atomic_store(&g_repl.role, REPLICATION_ROLE_PRIMARY);
+    return true;
+}
+
+/* ==================== 备节点 ==================== */
+
+/**
+ * @brief 全量同步开始：删除本地全部账户
+ */
+static void follower_wipe(void)
+{
+    size_t capacity = 4096;
+    ACCOUNT *accounts = NULL;
+    size_t count = 0;
+    for (;;) {
+        ACCOUNT *grown = (ACCOUNT *)realloc(accounts, capacity * sizeof(ACCOUNT));
+        if (grown == NULL) {
+            break;
+        }
+        accounts = grown;
+        bool truncated = false;
+        count = account_collect_all(accounts, capacity, &truncated);
+        if (!truncated) {
+            break;
+        }
+        capacity *= 2;
+    }
+    for (size_t i = 0; i < count; i++) {
+        account_apply_remove(accounts[i].UUID);
+    }
+    free(accounts);
+}
+
+static void follower_apply(const ReplRecord *rec)
+{
+    if (rec->type == REPL_RECORD_PUT) {
+        ACCOUNT acc;
+        record_decode(rec, &acc);
+        account_apply_put(&acc);
+    } else if (rec->type == REPL_RECORD_DELETE) {
+        char uuid[37];
+        memcpy(uuid, rec->uuid, sizeof(uuid));
+        uuid[36] = '\0';
+        account_apply_remove(uuid);
+    }
+}
+
+static bool follower_send_ack(int fd, uint64_t seq)
+{
+    ReplFrameHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = REPL_MSG_ACK;
+    hdr.seq = seq;
+    return repl_send_frame(fd, &hdr, NULL);
+}
+
+/**
+ * @brief 跟随一个主节点连接，直到连接断开或停止
+ */
+static void follower_session(int fd)
+{
+    static ReplRecord recs[REPLICATION_MAX_BATCH];   /* 仅备节点线程使用 */
+
+    ReplFrameHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.type = REPL_MSG_HELLO;
+    platform_mutex_lock(&g_repl.lock);
+    hdr.seq = g_repl.applied_seq;
+    hdr.epoch = g_repl.primary_epoch;
+    platform_mutex_unlock(&g_repl.lock);
+    if (!repl_send_frame(fd, &hdr, NULL)) {
+        return;
+    }
+
+    while (repl_recv_frame(fd, &hdr, recs)) {
+        switch (hdr.type) {
+        case REPL_MSG_SNAPSHOT_BEGIN:
+            /* 清空期间本地数据不完整，清除来源标识，中途断开时重连会重新全量同步 */
+            platform_mutex_lock(&g_repl.lock);
+            g_repl.primary_epoch = 0;
+            g_repl.applied_seq = 0;
+            platform_mutex_unlock(&g_repl.lock);
+            follower_wipe();
+            break;
+
+        case REPL_MSG_SNAPSHOT_DATA:
+            for (uint16_t i = 0; i < hdr.count; i++) {
+                follower_apply(&recs[i]);
+            }
+            break;
+
+        case REPL_MSG_SNAPSHOT_END:
+            platform_mutex_lock(&g_repl.lock);
+            g_repl.primary_epoch = hdr.epoch;
+            g_repl.applied_seq = hdr.seq;
+            g_repl.head_seq = hdr.head_seq;
+            g_repl.resyncs++;
+            platform_mutex_unlock(&g_repl.lock);
+            if (!follower_send_ack(fd, hdr.seq)) {
+                return;
+            }
+            break;
+
+        case REPL_MSG_RECORDS: {
+            platform_mutex_lock(&g_repl.lock);
+            uint64_t applied = g_repl.applied_seq;
+            bool same_primary = hdr.epoch == g_repl.primary_epoch;
+            platform_mutex_unlock(&g_repl.lock);
+            if (!same_primary || hdr.count == 0) {
+                return;   /* 协议错误，断开后重新握手 */
+            }
+
+            uint64_t first = hdr.seq - hdr.count + 1;
+            for (uint16_t i = 0; i < hdr.count; i++) {
+                if (first + i > applied) {
+                    follower_apply(&recs[i]);
+                }
+            }
+
+            uint64_t now = platform_monotonic_ns();
+            platform_mutex_lock(&g_repl.lock);
+            if (hdr.seq > g_repl.applied_seq) {
+                g_repl.applied_seq = hdr.seq;
+            }
+            g_repl.head_seq = hdr.head_seq;
+            g_repl.records += hdr.count;
+            g_repl.last_lag_us = now > hdr.commit_ns ? (now - hdr.commit_ns) / 1000 : 0;
+            platform_mutex_unlock(&g_repl.lock);
+
+            if (!follower_send_ack(fd, hdr.seq)) {
+                return;
+            }
+            break;
+        }
+
+        default:
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 备节点线程：连接主节点并跟随，断开后重连
+ */
+static void follower_main(void *arg)
+{
+    (void)arg;
+    while (!atomic_load(&g_repl.stopping)) {
+        int fd = repl_connect(g_repl.config.address);
+        if (fd < 0) {
+            for (unsigned int waited = 0; waited < REPLICATION_RETRY_MS &&
+                 !atomic_load(&g_repl.stopping); waited += 50) {
+                platform_sleep_ms(50);
+            }
+            continue;
+        }
+
+        platform_mutex_lock(&g_repl.lock);
+        g_repl.connected = true;
+        platform_mutex_unlock(&g_repl.lock);
+
+        follower_session(fd);
+        close(fd);
+
+        platform_mutex_lock(&g_repl.lock);
+        g_repl.connected = false;
+        platform_mutex_unlock(&g_repl.lock);
+    }
+}
+
+/* ==================== 生命周期 ==================== */
+
+static void repl_stop_thread(void)
+{
+    if (!g_repl.thread_started) {
+        return;
+    }
+    atomic_store(&g_repl.stopping, true);
+    platform_mutex_lock(&g_repl.lock);
+    platform_cond_broadcast(&g_repl.data_cond);
+    platform_mutex_unlock(&g_repl.lock);
+
+    platform_thread_join(g_repl.thread);
+    g_repl.thread_started = false;
+    atomic_store(&g_repl.stopping, false);
+}
+
+/**
+ * @brief 停止主节点：关闭监听并释放 backlog
+ */
+static void primary_stop(void)
+{
+    atomic_store(&g_repl.role, REPLICATION_ROLE_NONE);
+    repl_stop_thread();
+
+    if (g_repl.listen_fd >= 0) {
+        close(g_repl.listen_fd);
+        g_repl.listen_fd = -1;
+        if (strncmp(g_repl.config.address, "unix:", 5) == 0) {
+            unlink(g_repl.config.address + 5);
+        }
+    }
+
+    platform_mutex_lock(&g_repl.lock);
+    free(g_repl.backlog);
+    g_repl.backlog = NULL;
+    g_repl.backlog_capacity = 0;
+    g_repl.connected = false;
+    platform_cond_broadcast(&g_repl.ack_cond);
+    platform_mutex_unlock(&g_repl.lock);
+}
+
+bool replication_start(const ReplicationConfig *config)
+{
+    if (!g_repl.lock_inited) {
+        platform_mutex_init(&g_repl.lock);
+        platform_cond_init(&g_repl.data_cond);
+        platform_cond_init(&g_repl.ack_cond);
+        g_repl.lock_inited = true;
+    }
+    if (atomic_load(&g_repl.role) != REPLICATION_ROLE_NONE || g_repl.thread_started) {
+        return false;
+    }
+    if (config->role == REPLICATION_ROLE_NONE) {
+        return true;
+    }
+    if (config->address[0] == '\0') {
+        fprintf(stderr, "错误：[replication] 未配置 address\n");
+        return false;
+    }
+
+    g_repl.config = *config;
+    if (g_repl.config.backlog == 0) {
+        g_repl.config.backlog = REPLICATION_DEFAULT_BACKLOG;
+    }
+
+    platform_mutex_lock(&g_repl.lock);
+    g_repl.records = 0;
+    g_repl.resyncs = 0;
+    g_repl.sync_waits = 0;
+    g_repl.sync_timeouts = 0;
+    g_repl.primary_epoch = 0;
+    g_repl.applied_seq = 0;
+    g_repl.head_seq = 0;
+    g_repl.last_lag_us = 0;
+    platform_mutex_unlock(&g_repl.lock);
+
+    if (config->role == REPLICATION_ROLE_PRIMARY) {
+        return primary_start(config->address, g_repl.config.backlog);
+    }
+
+    /* 先进入只读，再开始跟随 */
+    atomic_store(&g_repl.role, REPLICATION_ROLE_FOLLOWER);
+    atomic_store(&g_repl.stopping, false);
+    if (!platform_thread_create(&g_repl.thread, follower_main, NULL)) {
+        atomic_store(&g_repl.role, REPLICATION_ROLE_NONE);
+        return false;
+    }
+    g_repl.thread_started = true;
+    return true;
+}
+
+bool init_replication(void)
+{
+    ReplicationConfig config;
+    load_replication_config(ENGINE_CONFIG_FILE, &config);
+    if (config.role == REPLICATION_ROLE_NONE) {
+        return true;
+    }
+
+    if (shard_engine_running()) {
+        fprintf(stderr, "警告：分片模式不支持热备复制，已忽略 [replication] role\n");
+        return false;
+    }
+    if (!replication_start(&config)) {
+        fprintf(stderr, "警告：热备复制启动失败\n");
+        return false;
+    }
+    return true;
+}
+
+void cleanup_replication(void)
+{
+    int role = atomic_load(&g_repl.role);
+    if (role == REPLICATION_ROLE_PRIMARY) {
+        primary_stop();
+    } else if (role == REPLICATION_ROLE_FOLLOWER) {
+        repl_stop_thread();
+        atomic_store(&g_repl.role, REPLICATION_ROLE_NONE);
+    }
+}
+
+ReplicationRole replication_role(void)
+{
+    return (ReplicationRole)atomic_load(&g_repl.role);
+}
+
+bool replication_is_follower(void)
+{
+    return atomic_load_explicit(&g_repl.role, memory_order_acquire) == REPLICATION_ROLE_FOLLOWER;
+}
+
+bool replication_promote(void)
+{
+    if (!replication_is_follower()) {
+        return false;
+    }
+
+    /* 停止跟随后才接受写入，保证不会与仍在应用的复制记录交错 */
+    repl_stop_thread();
+    platform_mutex_lock(&g_repl.lock);
+    g_repl.connected = false;
+    platform_mutex_unlock(&g_repl.lock);
+    atomic_store(&g_repl.role, REPLICATION_ROLE_NONE);
+
+    if (g_repl.config.promote_address[0] == '\0') {
+        return true;
+    }
+    return primary_start(g_repl.config.promote_address, g_repl.config.backlog);
+}
+
+void replication_get_stats(ReplicationStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->role = replication_role();
+    if (!g_repl.lock_inited) {
+        return;
+    }
+
+    platform_mutex_lock(&g_repl.lock);
+    stats->connected = g_repl.connected;
+    stats->records = g_repl.records;
+    stats->resyncs = g_repl.resyncs;
+    stats->sync_waits = g_repl.sync_waits;
+    stats->sync_timeouts = g_repl.sync_timeouts;
+
+    if (stats->role == REPLICATION_ROLE_PRIMARY) {
+        stats->last_seq = g_repl.last_seq;
+        stats->acked_seq = g_repl.acked_seq;
+        stats->lag_ops = g_repl.last_seq - g_repl.acked_seq;
+        /* 最早未确认记录仍在 backlog 中时，以其提交时刻计算落后时间 */
+        uint64_t oldest = g_repl.acked_seq + 1;
+        if (stats->lag_ops > 0 && g_repl.last_seq - oldest < g_repl.backlog_capacity) {
+            uint64_t commit_ns = g_repl.backlog[oldest % g_repl.backlog_capacity].commit_ns;
+            uint64_t now = platform_monotonic_ns();
+            stats->lag_us = now > commit_ns ? (now - commit_ns) / 1000 : 0;
+        }
+    } else if (stats->role == REPLICATION_ROLE_FOLLOWER) {
+        stats->last_seq = g_repl.applied_seq;
+        stats->lag_ops = g_repl.head_seq > g_repl.applied_seq ? g_repl.head_seq - g_repl.applied_seq : 0;
+        stats->lag_us = g_repl.last_lag_us;
+    }
+    platform_mutex_unlock(&g_repl.lock);
+}
+
+/* ==================== 主节点记录 ==================== */
+
+static void repl_append(ReplRecordType type, const ACCOUNT *acc, const char *uuid)
+{
+    if (atomic_load_explicit(&g_repl.role, memory_order_acquire) != REPLICATION_ROLE_PRIMARY) {
+        return;
+    }
+
+    ReplRecord rec;
+    record_encode(&rec, type, acc, uuid);
+    uint64_t now = platform_monotonic_ns();
+
+    platform_mutex_lock(&g_repl.lock);
+    if (g_repl.backlog == NULL) {
+        platform_mutex_unlock(&g_repl.lock);
+        return;
+    }
+    uint64_t seq = ++g_repl.last_seq;
+    ReplBacklogEntry *e = &g_repl.backlog[seq % g_repl.backlog_capacity];
+    e->rec = rec;
+    e->seq = seq;
+    e->commit_ns = now;
+    platform_cond_signal(&g_repl.data_cond);
+    platform_mutex_unlock(&g_repl.lock);
+
+    t_last_seq = seq;
+}
+
+void replication_record_put(const ACCOUNT *acc)
+{
+    repl_append(REPL_RECORD_PUT, acc, NULL);
+}
+
+void replication_record_delete(const char *uuid)
+{
+    repl_append(REPL_RECORD_DELETE, NULL, uuid);
+}
+
+void replication_wait_commit(void)
+{
+    uint64_t target = t_last_seq;
+    if (target == 0 || g_repl.config.ack != REPLICATION_ACK_SYNC ||
+        atomic_load_explicit(&g_repl.role, memory_order_acquire) != REPLICATION_ROLE_PRIMARY) {
+        return;
+    }
+
+    platform_mutex_lock(&g_repl.lock);
+    if (g_repl.acked_seq >= target || g_repl.backlog == NULL) {
+        platform_mutex_unlock(&g_repl.lock);
+        return;
+    }
+
+    g_repl.sync_waits++;
+    uint64_t deadline = platform_monotonic_ns() + (uint64_t)g_repl.config.sync_timeout_ms * 1000000ull;
+    while (g_repl.acked_seq < target && g_repl.connected) {
+        uint64_t now = platform_monotonic_ns();
+        if (now >= deadline) {
+            break;
+        }
+        unsigned int remaining_ms = (unsigned int)((deadline - now + 999999) / 1000000);
+        platform_cond_timedwait(&g_repl.ack_cond, &g_repl.lock, remaining_ms);
+    }
+    if (g_repl.acked_seq < target) {
+        g_repl.sync_timeouts++;
+    }
+    platform_mutex_unlock(&g_repl.lock);
+}
+
+#endif /* _WIN32 */
@@ -7,6 +7,8 @@
  */
 
 #include <lib/server_api.h>
+#include <lib/platform.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -23,6 +25,9 @@
 #ifndef DISABLE_NETWORK
 #include <curl/curl.h>
 #include <cjson/cJSON.h>
+#include <zlib.h>
+#include <lib/wire.h>
+#include <lib/amount.h>
 #endif
 
 #ifndef _WIN32
@@ -30,10 +35,34 @@
     #include <openssl/hmac.h>
 #endif
 
+/* ==================== 常量配置 ==================== */
+
+#define SYNC_DEFAULT_MAX_IN_FLIGHT 16
+#define SYNC_MAX_IN_FLIGHT_LIMIT 256
+#define SYNC_DEFAULT_MAX_RETRIES 2
+#define SYNC_MAX_RETRIES_LIMIT 10
+#define SYNC_DEFAULT_BATCH_SIZE 100
+#define SYNC_MAX_BATCH_SIZE 1000       /**< 与服务器 /api/accounts/sync_batch 的上限一致 */
+#define SYNC_DEFAULT_PULL_PAGE_SIZE 1000
+#define SYNC_MAX_PULL_PAGE_SIZE 5000   /**< 与服务器 /api/accounts 的 limit 上限一致 */
+#define SYNC_RETRY_BASE_MS 200         /**< 第 n 次重试前等待 200ms * 2^(n-1) */
+#define HTTP_DEFAULT_COMPRESS_MIN_BYTES 1024   /**< 请求体达到该大小才压缩 */
+#define HTTP_BODY_INITIAL_CAP 256      /**< 请求体缓冲区的初始容量，之后按倍数增长 */
+#define HTTP_RESPONSE_INITIAL_CAP 1024 /**< 响应缓冲区的初始容量，之后按倍数增长 */
+#define HTTP_MAX_CACHED_CONNECTIONS 256 /**< 共享连接池保留的空闲连接数（libcurl 默认5，多线程请求时连接反复新建） */
+#define HTTP_DEFAULT_CONNECT_TIMEOUT 3 /**< 连接超时上限（秒） */
+#define HTTP_MIN_TIMEOUT_MS 500        /**< 自适应超时的下限，避免服务器偶尔变慢就判为失败 */
+#define BREAKER_DEFAULT_WINDOW 10
+#define BREAKER_DEFAULT_MIN_REQUESTS 5
+#define BREAKER_DEFAULT_FAILURE_PERCENT 50
+#define BREAKER_DEFAULT_OPEN_SECONDS 5
+#define JSON_EXACT_INT_MAX 9007199254740992.0  /**< 2^53，cJSON 以 double 保存数值，超过后不再精确 */
+#define HTTP_CIRCUIT_OPEN CURLE_ABORTED_BY_CALLBACK  /**< 熔断期间未发出的请求（本模块不设进度回调，不会与真实结果混淆） */
+
 /* ==================== 全局变量 ==================== */
 
 static ServerConfig g_config;          /**< 服务器配置 */
-static RunMode g_run_mode = MODE_UNKNOWN;  /**< 当前运行模式 */
+static atomic_int g_run_mode = MODE_UNKNOWN;  /**< 当前运行模式（RunMode，后台检测线程写入） */
 static bool g_api_initialized = false;  /**< API是否已初始化 */
 
 /* ==================== 内部辅助结构 ==================== */
@@ -44,6 +73,7 @@ static bool g_api_initialized = false;  /**< API是否已初始化 */
 typedef struct {
     char *data;      /**< 数据指针 */
     size_t size;     /**< 数据大小 */
+    size_t cap;      /**< 已分配的容量，按倍数增长 */
 } ResponseBuffer;
 
 /* ==================== 内部辅助函数声明 ==================== */
@@ -65,6 +95,112 @@ static void bytes_to_hex(const unsigned char *bytes, size_t len, char *hex);
 #ifndef DISABLE_NETWORK
 static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp);
 static bool parse_config_line(const char *line, const char *section);
+static CURLSH* create_share(void);
+static void mux_start(void);
+static void mux_stop(void);
+static char* server_request_status(const char *endpoint, const char *method, const char *json_data,
+                                   bool adaptive, CURLcode *res_out, long *http_code_out);
+static void report_request_error(CURLcode res);
+static void init_breaker(void);
+
+/**
+ * @brief 可复用的HTTP连接句柄
+ *
+ * 请求结束后句柄放回空闲链表而不是 curl_easy_cleanup()，保持 keep-alive 连接；
+ * 固定的请求头只在创建时构建一次，每次请求只把时间戳头临时接在链表末尾。
+ * 请求体、响应与压缩缓冲区都随句柄保留，稳定后单个账户操作的请求不再分配内存。
+ */
+typedef struct HttpHandle {
+    CURL *curl;
+    struct curl_slist *headers;       /**< X-Client-Key 与空的 Expect */
+    struct curl_slist *headers_tail;
+    struct curl_slist type_node;      /**< Content-Type，每次请求接在固定头之前 */
+    struct curl_slist accept_node;    /**< 请求二进制响应时接在 Content-Type 之后 */
+    struct curl_slist encoding_node;  /**< 请求体压缩时接在时间戳头之后 */
+    char *body;                       /**< JsonWriter 或二进制编码写入的请求体 */
+    size_t body_cap;
+    ResponseBuffer response;
+    unsigned char *gz_body;           /**< 压缩后的请求体 */
+    size_t gz_cap;
+    z_stream zs;                      /**< 压缩状态，用 deflateReset() 复用 */
+    bool zs_ready;
+    PlatformCond mux_cond;            /**< 经多路复用线程发送时，等待完成 */
+    bool mux_done;                    /**< 以下两项由 g_mux_lock 保护 */
+    CURLcode mux_result;
+    struct HttpHandle *next;          /**< 空闲链表，或多路复用线程的待发送队列 */
+} HttpHandle;
+
+static HttpHandle *g_idle_handles = NULL;  /**< 空闲句柄（g_conn_lock 保护） */
+static CURLSH *g_share = NULL;             /**< 各句柄共享的 DNS、连接与 TLS 会话缓存 */
+static PlatformMutex g_conn_lock;
+static ServerApiStats g_stats;             /**< 请求统计（g_conn_lock 保护） */
+static PlatformMutex g_share_locks[CURL_LOCK_DATA_LAST];
+static bool g_request_gzip = false;        /**< 服务器在 /api/check 中声明可接收 gzip 请求体 */
+static bool g_server_wire = false;         /**< 服务器在 /api/check 中声明支持二进制编码 */
+static atomic_ullong g_allocations;        /**< 本模块、cJSON 与 zlib 的内存分配次数 */
+static atomic_ullong g_curl_allocations;   /**< libcurl 的内存分配次数 */
+static CURLM *g_mux = NULL;                /**< 启用 HTTP/2 时各线程的请求共用的 multi 句柄 */
+static PlatformThread g_mux_thread;        /**< 驱动 g_mux 的线程 */
+static PlatformMutex g_mux_lock;
+static HttpHandle *g_mux_head = NULL;      /**< 待加入 g_mux 的句柄（g_mux_lock 保护） */
+static HttpHandle *g_mux_tail = NULL;
+static bool g_mux_stop = false;
+static CircuitBreaker g_breaker;           /**< 各请求共用的熔断器与自适应超时 */
+
+/* ==================== 分配计数 ==================== */
+
+static void* counted_malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocations, 1, memory_order_relaxed);
+    return malloc(size);
+}
+
+static void* counted_realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocations, 1, memory_order_relaxed);
+    return realloc(ptr, size);
+}
+
+static voidpf zlib_alloc(voidpf opaque, uInt items, uInt size)
+{
+    (void)opaque;
+    atomic_fetch_add_explicit(&g_allocations, 1, memory_order_relaxed);
+    return calloc(items, size);
+}
+
+static void zlib_free(voidpf opaque, voidpf address)
+{
+    (void)opaque;
+    free(address);
+}
+
+static void* curl_counted_malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&g_curl_allocations, 1, memory_order_relaxed);
+    return malloc(size);
+}
+
+static void* curl_counted_realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&g_curl_allocations, 1, memory_order_relaxed);
+    return realloc(ptr, size);
+}
+
+static void* curl_counted_calloc(size_t items, size_t size)
+{
+    atomic_fetch_add_explicit(&g_curl_allocations, 1, memory_order_relaxed);
+    return calloc(items, size);
+}
+
+static char* curl_counted_strdup(const char *str)
+{
+    size_t len = strlen(str) + 1;
+    char *copy = curl_counted_malloc(len);
+    if (copy != NULL) {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
 #endif
 
 /* ==================== 初始化与清理 ==================== */
@@ -79,20 +215,36 @@ bool init_server_api(void)
     }
     
 #ifndef DISABLE_NETWORK
-    /* 初始化libcurl */
-    CURLcode res = curl_global_init(CURL_GLOBAL_ALL);
+    /* 初始化libcurl；libcurl 与 cJSON 的内存分配经过计数，见 server_api_get_stats() */
+    CURLcode res = curl_global_init_mem(CURL_GLOBAL_ALL, curl_counted_malloc, free,
+                                        curl_counted_realloc, curl_counted_strdup,
+                                        curl_counted_calloc);
     if (res != CURLE_OK) {
         fprintf(stderr, "错误：libcurl初始化失败: %s\n", curl_easy_strerror(res));
         return false;
     }
+    cJSON_Hooks hooks = { counted_malloc, free };
+    cJSON_InitHooks(&hooks);
+
+    /* 连接复用：共享缓存与空闲句柄 */
+    platform_mutex_init(&g_conn_lock);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        platform_mutex_init(&g_share_locks[i]);
+    }
+    g_share = create_share();
     
     /* 加载配置文件 */
-    if (!load_server_config()) {
+    bool loaded = load_server_config();
+    init_breaker();
+    if (!loaded) {
         fprintf(stderr, "警告：无法加载服务器配置，将使用本地模式\n");
         g_run_mode = MODE_LOCAL;
         g_api_initialized = true;
         return true;
     }
+    if (g_config.http2) {
+        mux_start();
+    }
 #else
     /* 网络功能已禁用，仅使用本地模式 */
     fprintf(stderr, "提示：程序编译时未启用网络功能，仅支持本地模式\n");
@@ -110,6 +262,31 @@ void cleanup_server_api(void)
 {
     if (g_api_initialized) {
 #ifndef DISABLE_NETWORK
+        /* 先停止多路复用线程，再释放句柄（关闭连接），最后释放共享缓存 */
+        mux_stop();
+        while (g_idle_handles != NULL) {
+            HttpHandle *h = g_idle_handles;
+            g_idle_handles = h->next;
+            curl_easy_cleanup(h->curl);
+            platform_cond_destroy(&h->mux_cond);
+            curl_slist_free_all(h->headers);
+            if (h->zs_ready) {
+                deflateEnd(&h->zs);
+            }
+            free(h->body);
+            free(h->response.data);
+            free(h->gz_body);
+            free(h);
+        }
+        if (g_share != NULL) {
+            curl_share_cleanup(g_share);
+            g_share = NULL;
+        }
+        for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+            platform_mutex_destroy(&g_share_locks[i]);
+        }
+        platform_mutex_destroy(&g_conn_lock);
+        breaker_destroy(&g_breaker);
         curl_global_cleanup();
 #endif
         g_api_initialized = false;
@@ -176,6 +353,12 @@ static bool parse_config_line(const char *line, const char *section)
                 g_config.port = atoi(v);
             } else if (strcmp(k, "timeout") == 0) {
                 g_config.timeout = atoi(v);
+            } else if (strcmp(k, "connect_timeout") == 0) {
+                g_config.connect_timeout = atoi(v);
+            } else if (strcmp(k, "adaptive_timeout") == 0) {
+                g_config.adaptive_timeout = (strcmp(v, "true") == 0);
+            } else if (strcmp(k, "http2") == 0) {
+                g_config.http2 = (strcmp(v, "true") == 0);
             }
         } else if (strcmp(section, "security") == 0) {
             if (strcmp(k, "use_https") == 0) {
@@ -189,6 +372,61 @@ static bool parse_config_line(const char *line, const char *section)
             if (strcmp(k, "client_id") == 0) {
                 strncpy(g_config.client_id, v, sizeof(g_config.client_id) - 1);
             }
+        } else if (strcmp(section, "sync") == 0) {
+            if (strcmp(k, "max_in_flight") == 0) {
+                int n = atoi(v);
+                if (n > 0 && n <= SYNC_MAX_IN_FLIGHT_LIMIT) {
+                    g_config.sync_max_in_flight = n;
+                }
+            } else if (strcmp(k, "max_retries") == 0) {
+                int n = atoi(v);
+                if (n >= 0 && n <= SYNC_MAX_RETRIES_LIMIT) {
+                    g_config.sync_max_retries = n;
+                }
+            } else if (strcmp(k, "batch_size") == 0) {
+                int n = atoi(v);
+                if (n > 0 && n <= SYNC_MAX_BATCH_SIZE) {
+                    g_config.sync_batch_size = n;
+                }
+            } else if (strcmp(k, "pull_page_size") == 0) {
+                int n = atoi(v);
+                if (n > 0 && n <= SYNC_MAX_PULL_PAGE_SIZE) {
+                    g_config.sync_pull_page_size = n;
+                }
+            } else if (strcmp(k, "compress") == 0) {
+                g_config.compress = (strcmp(v, "true") == 0);
+            } else if (strcmp(k, "compress_min_bytes") == 0) {
+                int n = atoi(v);
+                if (n >= 0) {
+                    g_config.compress_min_bytes = n;
+                }
+            } else if (strcmp(k, "wire_format") == 0) {
+                g_config.binary_wire = (strcmp(v, "binary") == 0);
+            }
+        } else if (strcmp(section, "breaker") == 0) {
+            if (strcmp(k, "enabled") == 0) {
+                g_config.breaker = (strcmp(v, "true") == 0);
+            } else if (strcmp(k, "window") == 0) {
+                int n = atoi(v);
+                if (n > 0 && n <= BREAKER_MAX_WINDOW) {
+                    g_config.breaker_window = n;
+                }
+            } else if (strcmp(k, "min_requests") == 0) {
+                int n = atoi(v);
+                if (n > 0) {
+                    g_config.breaker_min_requests = n;
+                }
+            } else if (strcmp(k, "failure_percent") == 0) {
+                int n = atoi(v);
+                if (n > 0 && n <= 100) {
+                    g_config.breaker_failure_percent = n;
+                }
+            } else if (strcmp(k, "open_seconds") == 0) {
+                int n = atoi(v);
+                if (n > 0) {
+                    g_config.breaker_open_seconds = n;
+                }
+            }
         }
     }
     
@@ -212,8 +450,22 @@ bool load_server_config(void)
     memset(&g_config, 0, sizeof(ServerConfig));
     g_config.port = 13155;
     g_config.timeout = 5;
+    g_config.connect_timeout = HTTP_DEFAULT_CONNECT_TIMEOUT;
+    g_config.adaptive_timeout = true;
+    g_config.http2 = false;
     g_config.use_https = false;
     g_config.verify_cert = false;
+    g_config.sync_max_in_flight = SYNC_DEFAULT_MAX_IN_FLIGHT;
+    g_config.sync_max_retries = SYNC_DEFAULT_MAX_RETRIES;
+    g_config.sync_batch_size = SYNC_DEFAULT_BATCH_SIZE;
+    g_config.sync_pull_page_size = SYNC_DEFAULT_PULL_PAGE_SIZE;
+    g_config.compress = true;
+    g_config.compress_min_bytes = HTTP_DEFAULT_COMPRESS_MIN_BYTES;
+    g_config.breaker = true;
+    g_config.breaker_window = BREAKER_DEFAULT_WINDOW;
+    g_config.breaker_min_requests = BREAKER_DEFAULT_MIN_REQUESTS;
+    g_config.breaker_failure_percent = BREAKER_DEFAULT_FAILURE_PERCENT;
+    g_config.breaker_open_seconds = BREAKER_DEFAULT_OPEN_SECONDS;
     
     char line[512];
     char current_section[64] = "";
@@ -235,14 +487,31 @@ bool load_server_config(void)
     
     fclose(file);
     
+    /* min_requests 大于 window 时窗口内的请求数永远达不到，熔断器不会断开 */
+    if (g_config.breaker_min_requests > g_config.breaker_window) {
+        fprintf(stderr, "警告：[breaker] min_requests = %d 大于 window = %d，已改为 %d\n",
+                g_config.breaker_min_requests, g_config.breaker_window, g_config.breaker_window);
+        g_config.breaker_min_requests = g_config.breaker_window;
+    }
+    
     /* 打印配置信息 */
     printf("[DEBUG] 配置加载完成:\n");
     printf("[DEBUG]   server_url = '%s'\n", g_config.server_url);
     printf("[DEBUG]   port = %d\n", g_config.port);
-    printf("[DEBUG]   timeout = %d\n", g_config.timeout);
+    printf("[DEBUG]   timeout = %d, connect_timeout = %d, adaptive_timeout = %s\n", g_config.timeout,
+           g_config.connect_timeout, g_config.adaptive_timeout ? "true" : "false");
+    printf("[DEBUG]   http2 = %s\n", g_config.http2 ? "true" : "false");
     printf("[DEBUG]   use_https = %s\n", g_config.use_https ? "true" : "false");
     printf("[DEBUG]   verify_cert = %s\n", g_config.verify_cert ? "true" : "false");
     printf("[DEBUG]   cert_path = '%s'\n", g_config.cert_path);
+    printf("[DEBUG]   sync max_in_flight = %d, max_retries = %d, batch_size = %d, pull_page_size = %d\n",
+           g_config.sync_max_in_flight, g_config.sync_max_retries, g_config.sync_batch_size,
+           g_config.sync_pull_page_size);
+    printf("[DEBUG]   wire_format = %s\n", g_config.binary_wire ? "binary" : "json");
+    printf("[DEBUG]   breaker = %s, window = %d, min_requests = %d, failure_percent = %d, open_seconds = %d\n",
+           g_config.breaker ? "true" : "false", g_config.breaker_window,
+           g_config.breaker_min_requests, g_config.breaker_failure_percent,
+           g_config.breaker_open_seconds);
     
     /* 如果client_id为空，生成新的 */
     if (g_config.client_id[0] == '\0') {
@@ -266,6 +535,25 @@ const ServerConfig* get_server_config(void)
     return &g_config;
 }
 
+/**
+ * @brief 按配置初始化熔断器（配置文件加载失败时保持配置全为0，不熔断也不限超时）
+ */
+static void init_breaker(void)
+{
+    BreakerConfig bc;
+    memset(&bc, 0, sizeof(bc));
+    bc.enabled = g_config.breaker;
+    bc.adaptive = g_config.adaptive_timeout;
+    bc.window = (size_t)g_config.breaker_window;
+    bc.min_requests = (size_t)g_config.breaker_min_requests;
+    bc.failure_percent = (unsigned)g_config.breaker_failure_percent;
+    bc.open_ms = (uint64_t)g_config.breaker_open_seconds * 1000;
+    bc.timeout_ms = g_config.timeout > 0 ? (uint64_t)g_config.timeout * 1000 : 0;
+    bc.connect_timeout_ms = g_config.connect_timeout > 0 ? (uint64_t)g_config.connect_timeout * 1000 : 0;
+    bc.min_timeout_ms = HTTP_MIN_TIMEOUT_MS;
+    breaker_init(&g_breaker, &bc);
+}
+
 #else  /* DISABLE_NETWORK */
 
 /* 网络功能禁用时的存根 */
@@ -283,29 +571,33 @@ const ServerConfig* get_server_config(void)
 
 /* ==================== 运行模式管理 ==================== */
 
+#ifndef DISABLE_NETWORK
 /**
- * @brief 检测服务器可用性
+ * @brief 请求 /api/check，记录服务器声明支持的编码，不切换运行模式
+ * @param verbose 是否打印检测过程与请求错误
  */
-RunMode check_server_availability(void)
+static RunMode probe_server(bool verbose)
 {
-#ifdef DISABLE_NETWORK
-    /* 网络功能已禁用 */
-    printf("[DEBUG] 网络功能已禁用，使用本地模式\n");
-    g_run_mode = MODE_LOCAL;
-    return MODE_LOCAL;
-#else
     if (!g_api_initialized) {
-        printf("[DEBUG] API未初始化，使用本地模式\n");
+        if (verbose) {
+            printf("[DEBUG] API未初始化，使用本地模式\n");
+        }
         return MODE_LOCAL;
     }
     
-    printf("[DEBUG] 正在检测服务器可用性...\n");
+    if (verbose) {
+        printf("[DEBUG] 正在检测服务器可用性...\n");
+    }
     
     /* 发送检测请求 */
-    char *response = server_request("/api/check", "GET", NULL);
+    CURLcode res;
+    long http_code;
+    char *response = server_request_status("/api/check", "GET", NULL, true, &res, &http_code);
     if (response == NULL) {
-        printf("[DEBUG] 服务器请求失败，切换到本地模式\n");
-        g_run_mode = MODE_LOCAL;
+        if (verbose) {
+            report_request_error(res);
+            printf("[DEBUG] 服务器请求失败，切换到本地模式\n");
+        }
         return MODE_LOCAL;
     }
     
@@ -314,26 +606,67 @@ RunMode check_server_availability(void)
     free(response);
     
     if (json == NULL) {
-        printf("[DEBUG] JSON解析失败，切换到本地模式\n");
-        g_run_mode = MODE_LOCAL;
+        if (verbose) {
+            printf("[DEBUG] JSON解析失败，切换到本地模式\n");
+        }
         return MODE_LOCAL;
     }
     
     cJSON *status = cJSON_GetObjectItem(json, "status");
     if (status != NULL && cJSON_IsString(status)) {
-        printf("[DEBUG] 服务器返回状态: %s\n", status->valuestring);
+        if (verbose) {
+            printf("[DEBUG] 服务器返回状态: %s\n", status->valuestring);
+        }
         if (strcmp(status->valuestring, "Support") == 0) {
-            printf("[DEBUG] 服务器支持，切换到服务器模式\n");
-            g_run_mode = MODE_SERVER;
+            if (verbose) {
+                printf("[DEBUG] 服务器支持，切换到服务器模式\n");
+            }
+            /* 旧服务器不认识压缩的请求体，只在声明支持时压缩 */
+            cJSON *encodings = cJSON_GetObjectItem(json, "request_encodings");
+            g_request_gzip = encodings != NULL && cJSON_IsString(encodings) &&
+                             strstr(encodings->valuestring, "gzip") != NULL;
+            cJSON *types = cJSON_GetObjectItem(json, "content_types");
+            g_server_wire = types != NULL && cJSON_IsString(types) &&
+                            strstr(types->valuestring, WIRE_CONTENT_TYPE) != NULL;
             cJSON_Delete(json);
             return MODE_SERVER;
         }
     }
     
     cJSON_Delete(json);
-    printf("[DEBUG] 服务器不支持或状态异常，切换到本地模式\n");
+    if (verbose) {
+        printf("[DEBUG] 服务器不支持或状态异常，切换到本地模式\n");
+    }
+    return MODE_LOCAL;
+}
+#endif
+
+/**
+ * @brief 检测服务器可用性
+ */
+RunMode check_server_availability(void)
+{
+#ifdef DISABLE_NETWORK
+    /* 网络功能已禁用 */
+    printf("[DEBUG] 网络功能已禁用，使用本地模式\n");
     g_run_mode = MODE_LOCAL;
     return MODE_LOCAL;
+#else
+    RunMode mode = probe_server(true);
+    g_run_mode = mode;
+    return mode;
+#endif
+}
+
+/**
+ * @brief 检测服务器可用性，不切换运行模式也不打印
+ */
+RunMode detect_server_availability(void)
+{
+#ifdef DISABLE_NETWORK
+    return MODE_LOCAL;
+#else
+    return probe_server(false);
 #endif
 }
 
@@ -342,7 +675,7 @@ RunMode check_server_availability(void)
  */
 RunMode get_run_mode(void)
 {
-    return g_run_mode;
+    return (RunMode)g_run_mode;
 }
 
 /**
@@ -370,13 +703,22 @@ static size_t write_callback(void *contents, size_t size, size_t nmemb, void *us
     size_t realsize = size * nmemb;
     ResponseBuffer *buffer = (ResponseBuffer *)userp;
     
-    char *ptr = realloc(buffer->data, buffer->size + realsize + 1);
-    if (ptr == NULL) {
-        fprintf(stderr, "错误：内存分配失败\n");
-        return 0;
+    /* 按倍数增长，句柄复用时保留，不必每块数据都 realloc */
+    size_t need = buffer->size + realsize + 1;
+    if (need > buffer->cap) {
+        size_t cap = buffer->cap < HTTP_RESPONSE_INITIAL_CAP ? HTTP_RESPONSE_INITIAL_CAP : buffer->cap;
+        while (cap < need) {
+            cap *= 2;
+        }
+        char *ptr = counted_realloc(buffer->data, cap);
+        if (ptr == NULL) {
+            fprintf(stderr, "错误：内存分配失败\n");
+            return 0;
+        }
+        buffer->data = ptr;
+        buffer->cap = cap;
     }
     
-    buffer->data = ptr;
     memcpy(&(buffer->data[buffer->size]), contents, realsize);
     buffer->size += realsize;
     buffer->data[buffer->size] = '\0';
@@ -384,52 +726,327 @@ static size_t write_callback(void *contents, size_t size, size_t nmemb, void *us
     return realsize;
 }
 
-/* ==================== 通用HTTP请求 ==================== */
+/* ==================== 连接复用 ==================== */
+
+static void share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+    (void)handle;
+    (void)access;
+    (void)userptr;
+    platform_mutex_lock(&g_share_locks[data]);
+}
+
+static void share_unlock(CURL *handle, curl_lock_data data, void *userptr)
+{
+    (void)handle;
+    (void)userptr;
+    platform_mutex_unlock(&g_share_locks[data]);
+}
 
 /**
- * @brief 发送HTTP/HTTPS请求
+ * @brief 创建共享缓存（DNS、连接池、TLS 会话），失败返回NULL（各句柄各自缓存）
  */
-char* server_request(const char *endpoint, const char *method, const char *json_data)
+static CURLSH* create_share(void)
 {
-    if (!g_api_initialized) {
-        fprintf(stderr, "[DEBUG] API未初始化\n");
+    CURLSH *share = curl_share_init();
+    if (share == NULL) {
         return NULL;
     }
-    
-    CURL *curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "错误：无法初始化CURL\n");
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, share_lock);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    return share;
+}
+
+/**
+ * @brief 取一个空闲句柄，没有时新建
+ */
+static HttpHandle* handle_acquire(void)
+{
+    platform_mutex_lock(&g_conn_lock);
+    HttpHandle *h = g_idle_handles;
+    if (h != NULL) {
+        g_idle_handles = h->next;
+    }
+    platform_mutex_unlock(&g_conn_lock);
+    if (h != NULL) {
+        return h;
+    }
+
+    h = counted_malloc(sizeof(HttpHandle));
+    if (h == NULL) {
+        return NULL;
+    }
+    memset(h, 0, sizeof(HttpHandle));
+    h->curl = curl_easy_init();
+    if (h->curl == NULL) {
+        free(h);
+        return NULL;
+    }
+    platform_cond_init(&h->mux_cond);
+
+    /* 固定请求头：认证头；去掉 libcurl 对超过1KB的请求体默认添加的
+     * "Expect: 100-continue"，批量请求不必先等一次 100 响应 */
+    char auth_header[128];
+    snprintf(auth_header, sizeof(auth_header), "X-Client-Key: %s", g_config.client_id);
+    h->headers = curl_slist_append(NULL, auth_header);
+    h->headers_tail = h->headers ? curl_slist_append(h->headers, "Expect:") : NULL;
+    if (h->headers_tail == NULL) {
+        curl_slist_free_all(h->headers);
+        curl_easy_cleanup(h->curl);
+        platform_cond_destroy(&h->mux_cond);
+        free(h);
         return NULL;
     }
+    while (h->headers_tail->next != NULL) {
+        h->headers_tail = h->headers_tail->next;
+    }
+    return h;
+}
+
+static void handle_release(HttpHandle *h)
+{
+    platform_mutex_lock(&g_conn_lock);
+    h->next = g_idle_handles;
+    g_idle_handles = h;
+    platform_mutex_unlock(&g_conn_lock);
+}
+
+/* ==================== HTTP/2 多路复用 ==================== */
+
+/*
+ * 每次 curl_easy_perform() 使用句柄自己的 multi，libcurl 不会把不同 multi 的请求
+ * 放进同一个 HTTP/2 连接，多个线程同时请求时仍各开一个连接。启用 HTTP/2 后各线程
+ * 把句柄交给一个线程，由它在同一个 multi 上执行，并发请求成为一个连接上的多个流。
+ */
+
+static void mux_finish(HttpHandle *h, CURLcode result)
+{
+    platform_mutex_lock(&g_mux_lock);
+    h->mux_result = result;
+    h->mux_done = true;
+    platform_cond_signal(&h->mux_cond);
+    platform_mutex_unlock(&g_mux_lock);
+}
+
+static void mux_loop(void *arg)
+{
+    (void)arg;
+    int running = 0;
+    for (;;) {
+        platform_mutex_lock(&g_mux_lock);
+        HttpHandle *h = g_mux_head;
+        g_mux_head = NULL;
+        g_mux_tail = NULL;
+        bool stop = g_mux_stop;
+        platform_mutex_unlock(&g_mux_lock);
+        if (stop && h == NULL && running == 0) {
+            break;
+        }
+        
+        while (h != NULL) {
+            HttpHandle *next = h->next;
+            curl_easy_setopt(h->curl, CURLOPT_PRIVATE, (void *)h);
+            if (curl_multi_add_handle(g_mux, h->curl) != CURLM_OK) {
+                mux_finish(h, CURLE_FAILED_INIT);
+            }
+            h = next;
+        }
+        curl_multi_perform(g_mux, &running);
+        
+        CURLMsg *msg;
+        int left;
+        while ((msg = curl_multi_info_read(g_mux, &left)) != NULL) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+            CURL *easy = msg->easy_handle;
+            CURLcode result = msg->data.result;
+            HttpHandle *done = NULL;
+            curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char **)&done);
+            curl_multi_remove_handle(g_mux, easy);
+            mux_finish(done, result);
+        }
+        
+        /* 新请求加入或停止时由 curl_multi_wakeup() 唤醒 */
+        curl_multi_poll(g_mux, NULL, 0, 1000, NULL);
+    }
+}
+
+/**
+ * @brief 启动多路复用线程，失败时各线程仍各自 curl_easy_perform()
+ */
+static void mux_start(void)
+{
+    g_mux = curl_multi_init();
+    if (g_mux == NULL) {
+        return;
+    }
+    curl_multi_setopt(g_mux, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+    platform_mutex_init(&g_mux_lock);
+    g_mux_stop = false;
+    if (!platform_thread_create(&g_mux_thread, mux_loop, NULL)) {
+        platform_mutex_destroy(&g_mux_lock);
+        curl_multi_cleanup(g_mux);
+        g_mux = NULL;
+    }
+}
+
+/**
+ * @brief 等进行中的请求结束后停止多路复用线程
+ */
+static void mux_stop(void)
+{
+    if (g_mux == NULL) {
+        return;
+    }
+    platform_mutex_lock(&g_mux_lock);
+    g_mux_stop = true;
+    platform_mutex_unlock(&g_mux_lock);
+    curl_multi_wakeup(g_mux);
+    platform_thread_join(g_mux_thread);
+    platform_mutex_destroy(&g_mux_lock);
+    curl_multi_cleanup(g_mux);
+    g_mux = NULL;
+}
+
+/**
+ * @brief 交给多路复用线程执行并等待完成
+ */
+static CURLcode mux_perform(HttpHandle *h)
+{
+    platform_mutex_lock(&g_mux_lock);
+    h->mux_done = false;
+    h->next = NULL;
+    if (g_mux_tail != NULL) {
+        g_mux_tail->next = h;
+    } else {
+        g_mux_head = h;
+    }
+    g_mux_tail = h;
+    platform_mutex_unlock(&g_mux_lock);
+    curl_multi_wakeup(g_mux);
     
-    /* 构建完整URL */
-    char url[512];
-    snprintf(url, sizeof(url), "%s%s", g_config.server_url, endpoint);
+    platform_mutex_lock(&g_mux_lock);
+    while (!h->mux_done) {
+        platform_cond_wait(&h->mux_cond, &g_mux_lock);
+    }
+    CURLcode result = h->mux_result;
+    platform_mutex_unlock(&g_mux_lock);
+    return result;
+}
+
+/**
+ * @brief 把请求体压缩为 gzip 格式，放入句柄的 gz_body
+ * @return 压缩后的长度；失败或压缩后不比原文小时返回0
+ */
+static size_t gzip_body(HttpHandle *h, const void *data, size_t len)
+{
+    z_stream *zs = &h->zs;
+    if (!h->zs_ready) {
+        memset(zs, 0, sizeof(*zs));
+        zs->zalloc = zlib_alloc;
+        zs->zfree = zlib_free;
+        /* windowBits 加16 输出 gzip 头尾；批量请求体重复度高，最快级别已足够 */
+        if (deflateInit2(zs, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return 0;
+        }
+        h->zs_ready = true;
+    } else if (deflateReset(zs) != Z_OK) {
+        return 0;
+    }
     
-    //printf("[DEBUG] HTTP请求信息:\n");
-    //printf("[DEBUG]   方法: %s\n", method);
-    //printf("[DEBUG]   端点: %s\n", endpoint);
-    //printf("[DEBUG]   完整URL: %s\n", url);
-    if (json_data) {
-        //printf("[DEBUG]   请求体: %s\n", json_data);
+    size_t bound = (size_t)deflateBound(zs, (uLong)len);
+    if (bound > h->gz_cap) {
+        unsigned char *buf = counted_realloc(h->gz_body, bound);
+        if (buf == NULL) {
+            return 0;
+        }
+        h->gz_body = buf;
+        h->gz_cap = bound;
     }
     
-    /* 初始化响应缓冲区 */
-    ResponseBuffer response;
-    response.data = malloc(1);
-    response.size = 0;
+    zs->next_in = (Bytef *)data;
+    zs->avail_in = (uInt)len;
+    zs->next_out = h->gz_body;
+    zs->avail_out = (uInt)h->gz_cap;
+    int rc = deflate(zs, Z_FINISH);
+    size_t out = (size_t)zs->total_out;
+    return (rc == Z_STREAM_END && out < len) ? out : 0;
+}
+
+/**
+ * @brief 为一次请求设置句柄选项
+ * @param body、time_header、time_node 须保持到请求结束（libcurl 不复制请求体与请求头）
+ * @param binary 请求体为二进制编码，并请求二进制响应
+ * @param adaptive 总超时按熔断器观测的延迟调整；批量推送、分页拉取等耗时随数据量变化的
+ *        请求为false，使用配置的 timeout（连接超时总是自适应）
+ * @note 请求结束后调用方须执行 h->headers_tail->next = NULL 摘下时间戳头
+ * @note 启用压缩时请求带 Accept-Encoding，libcurl 自动解压响应；服务器支持且请求体
+ *       达到 compress_min_bytes 时请求体以 gzip 发送
+ */
+static void handle_prepare(HttpHandle *h, const char *endpoint, const char *method,
+                           const void *body, size_t len, bool binary, bool adaptive,
+                           ResponseBuffer *response, char time_header[64],
+                           struct curl_slist *time_node)
+{
+    CURL *curl = h->curl;
+    
+    /* 构建完整URL（libcurl 会复制） */
+    char url[512];
+    snprintf(url, sizeof(url), "%s%s", g_config.server_url, endpoint);
+    
+    /* 清除上一次请求的选项（保留连接、DNS 与会话缓存） */
+    curl_easy_reset(curl);
     
     /* 设置基本选项 */
     curl_easy_setopt(curl, CURLOPT_URL, url);
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&response);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, g_config.timeout);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)response);
+    uint64_t timeout_ms;
+    uint64_t connect_timeout_ms;
+    breaker_timeouts(&g_breaker, &timeout_ms, &connect_timeout_ms);
+    if (!adaptive) {
+        timeout_ms = g_config.timeout > 0 ? (uint64_t)g_config.timeout * 1000 : 0;
+    }
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, (long)connect_timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    if (g_share != NULL) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, g_share);
+    }
+    curl_easy_setopt(curl, CURLOPT_MAXCONNECTS, (long)HTTP_MAX_CACHED_CONNECTIONS);
+    if (g_config.http2) {
+        /* HTTPS 经 ALPN 协商 HTTP/2，明文 HTTP 仍为 HTTP/1.1；同时发起的请求等待
+         * 已有连接确认能否多路复用，而不是各自新建连接 */
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    } else {
+        /* libcurl 对 HTTPS 默认也协商 HTTP/2，但各线程的请求不能共用连接，明确使用 HTTP/1.1 */
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_1_1);
+    }
+    if (g_config.compress) {
+        /* 空串表示 libcurl 支持的全部编码（gzip、deflate，视编译选项还有 br、zstd） */
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    }
     
     /* 设置HTTP方法 */
+    size_t gz_len = 0;
     if (strcmp(method, "POST") == 0) {
+        if (g_config.compress && g_request_gzip && len > 0 &&
+            len >= (size_t)g_config.compress_min_bytes) {
+            gz_len = gzip_body(h, body, len);
+        }
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        if (json_data) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data);
+        if (gz_len > 0) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)gz_len);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, h->gz_body);
+        } else {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)len);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body ? body : "");
         }
     } else if (strcmp(method, "DELETE") == 0) {
         curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
@@ -437,21 +1054,25 @@ char* server_request(const char *endpoint, const char *method, const char *json_
         curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
     }
     
-    /* 设置HTTP头 */
-    struct curl_slist *headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    
-    /* 添加认证头 */
-    char auth_header[128];
-    snprintf(auth_header, sizeof(auth_header), "X-Client-Key: %s", g_config.client_id);
-    headers = curl_slist_append(headers, auth_header);
-    
-    /* 添加时间戳 */
-    char time_header[64];
-    snprintf(time_header, sizeof(time_header), "X-Request-Time: %ld", (long)time(NULL));
-    headers = curl_slist_append(headers, time_header);
-    
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    /* 设置HTTP头：固定头之前接上 Content-Type（与 Accept），之后临时接上本次的时间戳 */
+    h->type_node.data = binary ? (char *)"Content-Type: " WIRE_CONTENT_TYPE
+                               : (char *)"Content-Type: application/json";
+    h->type_node.next = h->headers;
+    if (binary) {
+        h->accept_node.data = (char *)"Accept: " WIRE_CONTENT_TYPE;
+        h->accept_node.next = h->headers;
+        h->type_node.next = &h->accept_node;
+    }
+    snprintf(time_header, 64, "X-Request-Time: %ld", (long)time(NULL));
+    time_node->data = time_header;
+    time_node->next = NULL;
+    h->headers_tail->next = time_node;
+    if (gz_len > 0) {
+        h->encoding_node.data = (char *)"Content-Encoding: gzip";
+        h->encoding_node.next = NULL;
+        time_node->next = &h->encoding_node;
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, &h->type_node);
     
     /* HTTPS配置 */
     if (g_config.use_https) {
@@ -462,62 +1083,603 @@ char* server_request(const char *endpoint, const char *method, const char *json_
             curl_easy_setopt(curl, CURLOPT_CAINFO, g_config.cert_path);
         }
     }
-    
-    /* 执行请求 */
-    //printf("[DEBUG] 正在发送HTTP请求...\n");
-    CURLcode res = curl_easy_perform(curl);
-    
-    /* 获取HTTP状态码 */
-    long http_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-    
-    /* 清理 */
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    
-    if (res != CURLE_OK) {
-        fprintf(stderr, "[DEBUG] CURL错误码: %d\n", res);
-        fprintf(stderr, "错误：HTTP请求失败: %s\n", curl_easy_strerror(res));
-        free(response.data);
-        return NULL;
+}
+
+/**
+ * @brief 记录一次请求的统计（须在句柄放回空闲链表前调用）
+ * @param body_bytes 解压后的响应体字节数
+ */
+static void record_request(CURL *curl, bool ok, uint64_t elapsed_us, size_t body_bytes)
+{
+    long new_connections = 0;
+    long http_version = 0;
+    curl_off_t sent = 0;
+    curl_off_t received = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connections);
+    curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &http_version);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &sent);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+    
+    platform_mutex_lock(&g_conn_lock);
+    g_stats.requests++;
+    g_stats.new_connections += (uint64_t)new_connections;
+    if (http_version == CURL_HTTP_VERSION_2_0) {
+        g_stats.http2_requests++;
     }
-    
-    //printf("[DEBUG] HTTP响应状态码: %ld\n", http_code);
-    if (response.data && response.size > 0) {
-        //printf("[DEBUG] 响应内容: %s\n", response.data);
+    g_stats.total_us += elapsed_us;
+    g_stats.bytes_sent += (uint64_t)sent;
+    g_stats.bytes_received += (uint64_t)received;
+    g_stats.body_bytes_received += (uint64_t)body_bytes;
+    if (!ok) {
+        g_stats.failures++;
     }
-    
-    return response.data;
+    platform_mutex_unlock(&g_conn_lock);
 }
 
-#endif  /* DISABLE_NETWORK - 结束网络功能块 */
-
-/* ==================== 安全机制 ==================== */
-/* 这些函数在所有模式下都需要（用于 generate_client_id） */
+/**
+ * @brief 是否为服务器一侧的失败（连接失败、超时、429/5xx），计入熔断的错误率
+ */
+static bool server_failure(CURLcode res, long http_code)
+{
+    if (res == CURLE_OUT_OF_MEMORY) {
+        return false;
+    }
+    return res != CURLE_OK || http_code == 429 || http_code >= 500;
+}
 
 /**
- * @brief 字节数组转十六进制字符串
- * @param bytes 字节数组
- * @param len 字节数组长度
- * @param hex 输出十六进制字符串
+ * @brief 把一次已发出请求的结果与延迟交给熔断器
+ * @param adaptive 请求使用自适应超时，成功时其耗时作为延迟样本
+ * @param probe 请求是否为 breaker_allow() 放行的半开探测请求
+ *
+ * 超时的请求不作为样本：服务器卡死时超时会随之放大，熔断前每个请求等得更久。
+ * 服务器只是变慢时，熔断后的探测请求使用配置上限，成功的耗时计入样本，几轮后超时随之上升。
  */
-static void bytes_to_hex(const unsigned char *bytes, size_t len, char *hex)
+static void record_outcome(CURL *curl, CURLcode res, long http_code, uint64_t elapsed_us,
+                           bool adaptive, bool probe)
 {
-    for (size_t i = 0; i < len; i++) {
-        sprintf(hex + i * 2, "%02x", bytes[i]);
+    bool failed = server_failure(res, http_code);
+    breaker_record(&g_breaker, probe, !failed, platform_monotonic_ns());
+    
+    uint64_t total_us = adaptive && !failed ? elapsed_us : 0;
+    long new_connections = 0;
+    curl_off_t connect_us = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &new_connections);
+    if (res == CURLE_OK && new_connections > 0) {
+        /* HTTPS 取 TLS 握手完成的时间，与 CURLOPT_CONNECTTIMEOUT 的范围一致 */
+        curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &connect_us);
+        if (connect_us == 0) {
+            curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect_us);
+        }
     }
-    hex[len * 2] = '\0';
+    breaker_observe(&g_breaker, total_us, (uint64_t)connect_us);
 }
 
+/* ==================== 请求体编码 ==================== */
+
 /**
- * @brief SHA256哈希计算
- * @param data 输入数据
- * @param len 数据长度
- * @param output 输出哈希字符串（65字节）
+ * @brief 把请求体直接写入句柄的 body 缓冲区（不构建 cJSON 树）
+ *
+ * 缓冲区按倍数增长并随句柄保留，稳定后编码请求体不再分配内存；
+ * 分配失败时 ok 置false，之后的写入忽略。
  */
-static void sha256_hash(const unsigned char *data, size_t len, char *output)
+typedef struct {
+    HttpHandle *h;
+    size_t len;
+    bool first;                    /**< 当前对象或数组中还没有成员 */
+    bool ok;
+} JsonWriter;
+
+/**
+ * @brief 保证句柄的请求体缓冲区至少有 need 字节，按倍数增长
+ */
+static bool body_reserve(HttpHandle *h, size_t need)
 {
-#ifdef _WIN32
+    if (need <= h->body_cap) {
+        return true;
+    }
+    size_t cap = h->body_cap < HTTP_BODY_INITIAL_CAP ? HTTP_BODY_INITIAL_CAP : h->body_cap;
+    while (cap < need) {
+        cap *= 2;
+    }
+    char *buf = counted_realloc(h->body, cap);
+    if (buf == NULL) {
+        return false;
+    }
+    h->body = buf;
+    h->body_cap = cap;
+    return true;
+}
+
+static void jw_append(JsonWriter *w, const char *str, size_t n)
+{
+    if (!w->ok) {
+        return;
+    }
+    HttpHandle *h = w->h;
+    if (!body_reserve(h, w->len + n + 1)) {
+        w->ok = false;
+        return;
+    }
+    memcpy(h->body + w->len, str, n);
+    w->len += n;
+    h->body[w->len] = '\0';
+}
+
+static void jw_begin(JsonWriter *w, HttpHandle *h)
+{
+    w->h = h;
+    w->len = 0;
+    w->first = true;
+    w->ok = true;
+}
+
+/**
+ * @brief 写出成员前的逗号与键名（数组元素 key 为NULL）
+ */
+static void jw_key(JsonWriter *w, const char *key)
+{
+    if (!w->first) {
+        jw_append(w, ",", 1);
+    }
+    w->first = false;
+    if (key != NULL) {
+        jw_append(w, "\"", 1);
+        jw_append(w, key, strlen(key));
+        jw_append(w, "\":", 2);
+    }
+}
+
+/**
+ * @brief 开始一个对象（'{'）或数组（'['）
+ */
+static void jw_open(JsonWriter *w, const char *key, char bracket)
+{
+    jw_key(w, key);
+    jw_append(w, &bracket, 1);
+    w->first = true;
+}
+
+static void jw_close(JsonWriter *w, char bracket)
+{
+    jw_append(w, &bracket, 1);
+    w->first = false;
+}
+
+static void jw_string(JsonWriter *w, const char *key, const char *value)
+{
+    jw_key(w, key);
+    jw_append(w, "\"", 1);
+    const char *run = value;
+    for (const char *p = value; ; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c != '\0' && c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+        jw_append(w, run, (size_t)(p - run));
+        if (c == '\0') {
+            break;
+        }
+        char esc[8];
+        int n = (c == '"' || c == '\\') ? snprintf(esc, sizeof(esc), "\\%c", c)
+                                        : snprintf(esc, sizeof(esc), "\\u%04x", c);
+        jw_append(w, esc, (size_t)n);
+        run = p + 1;
+    }
+    jw_append(w, "\"", 1);
+}
+
+static void jw_uint(JsonWriter *w, const char *key, unsigned long long value)
+{
+    char num[24];
+    int n = snprintf(num, sizeof(num), "%llu", value);
+    jw_key(w, key);
+    jw_append(w, num, (size_t)n);
+}
+
+static void jw_int(JsonWriter *w, const char *key, long long value)
+{
+    char num[24];
+    int n = snprintf(num, sizeof(num), "%lld", value);
+    jw_key(w, key);
+    jw_append(w, num, (size_t)n);
+}
+
+/**
+ * @return 请求体（位于句柄的 body 缓冲区），分配失败返回NULL
+ */
+static const char* jw_finish(JsonWriter *w)
+{
+    return w->ok ? w->h->body : NULL;
+}
+
+/**
+ * @brief 单个账户操作的请求体字段
+ */
+typedef struct {
+    const char *uuid_key;          /**< "uuid"，转账时为 "uuid_from" */
+    const char *uuid;
+    const char *uuid_to;           /**< 仅转账，其余为NULL */
+    const char *amount_key;        /**< "amount"，创建与同步时为 "balance" */
+    LLUINT amount;
+    const char *op_id;             /**< 可为NULL */
+} OpFields;
+
+static const char* write_op_body(HttpHandle *h, const OpFields *f)
+{
+    JsonWriter w;
+    jw_begin(&w, h);
+    jw_open(&w, NULL, '{');
+    jw_string(&w, f->uuid_key, f->uuid);
+    if (f->uuid_to != NULL) {
+        jw_string(&w, "uuid_to", f->uuid_to);
+    }
+    jw_uint(&w, f->amount_key, (unsigned long long)f->amount);
+    if (f->op_id != NULL) {
+        jw_string(&w, "op_id", f->op_id);
+    }
+    jw_int(&w, "timestamp", (long long)time(NULL));
+    jw_close(&w, '}');
+    return jw_finish(&w);
+}
+
+/**
+ * @brief 句柄上一次请求的请求体
+ */
+typedef struct {
+    const void *data;
+    size_t len;
+    bool binary;                   /**< 二进制编码，并请求二进制响应 */
+} RequestBody;
+
+/**
+ * @brief 是否使用二进制编码：客户端配置为 binary 且服务器声明支持
+ */
+static bool wire_enabled(void)
+{
+    return g_config.binary_wire && g_server_wire;
+}
+
+/**
+ * @brief 编码单个账户操作的请求体；二进制编码不适用时（UUID 非规范格式）改用 JSON
+ */
+static bool encode_op_body(HttpHandle *h, const OpFields *f, RequestBody *body)
+{
+    if (wire_enabled() && body_reserve(h, WIRE_OP_MAX_BYTES)) {
+        body->len = wire_encode_op((uint8_t *)h->body, f->uuid, f->uuid_to, f->amount,
+                                   (int64_t)time(NULL), f->op_id);
+        if (body->len > 0) {
+            body->data = h->body;
+            body->binary = true;
+            return true;
+        }
+    }
+    const char *json = write_op_body(h, f);
+    body->data = json;
+    body->len = json != NULL ? strlen(json) : 0;
+    body->binary = false;
+    return json != NULL;
+}
+
+/**
+ * @brief 批量同步请求体 {"accounts":[{"uuid":..,"balance":..,"timestamp":..},...]}
+ */
+static const char* write_sync_batch_body(HttpHandle *h, const ACCOUNT *accounts, size_t n)
+{
+    long long now = (long long)time(NULL);
+    JsonWriter w;
+    jw_begin(&w, h);
+    jw_open(&w, NULL, '{');
+    jw_open(&w, "accounts", '[');
+    for (size_t i = 0; i < n; i++) {
+        jw_open(&w, NULL, '{');
+        jw_string(&w, "uuid", accounts[i].UUID);
+        jw_uint(&w, "balance", (unsigned long long)accounts[i].BALANCE);
+        jw_int(&w, "timestamp", now);
+        jw_close(&w, '}');
+    }
+    jw_close(&w, ']');
+    jw_close(&w, '}');
+    return jw_finish(&w);
+}
+
+static bool encode_sync_batch_body(HttpHandle *h, const ACCOUNT *accounts, size_t n,
+                                   RequestBody *body)
+{
+    if (wire_enabled() && body_reserve(h, wire_sync_batch_size(n))) {
+        body->len = wire_encode_sync_batch((uint8_t *)h->body, accounts, n, (int64_t)time(NULL));
+        if (body->len > 0) {
+            body->data = h->body;
+            body->binary = true;
+            return true;
+        }
+    }
+    const char *json = write_sync_batch_body(h, accounts, n);
+    body->data = json;
+    body->len = json != NULL ? strlen(json) : 0;
+    body->binary = false;
+    return json != NULL;
+}
+
+/**
+ * @brief 响应顶层的 success 是否为 true（只扫描文本，不构建 cJSON 树）
+ */
+static bool response_success(const char *response)
+{
+    int depth = 0;
+    const char *p = response;
+    while (*p != '\0') {
+        if (*p == '"') {
+            const char *key = ++p;
+            while (*p != '\0' && *p != '"') {
+                p += (*p == '\\' && p[1] != '\0') ? 2 : 1;
+            }
+            if (*p == '\0') {
+                return false;
+            }
+            size_t len = (size_t)(p - key);
+            p++;
+            if (depth == 1 && len == 7 && memcmp(key, "success", 7) == 0) {
+                while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+                    p++;
+                }
+                if (*p == ':') {
+                    p++;
+                    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+                        p++;
+                    }
+                    return strncmp(p, "true", 4) == 0;
+                }
+            }
+            continue;
+        }
+        if (*p == '{' || *p == '[') {
+            depth++;
+        } else if (*p == '}' || *p == ']') {
+            depth--;
+        }
+        p++;
+    }
+    return false;
+}
+
+/* ==================== 通用HTTP请求 ==================== */
+
+/**
+ * @brief 清空响应缓冲区，保留已分配的容量
+ */
+static bool response_reset(ResponseBuffer *response)
+{
+    if (response->data == NULL) {
+        response->data = counted_malloc(HTTP_RESPONSE_INITIAL_CAP);
+        if (response->data == NULL) {
+            return false;
+        }
+        response->cap = HTTP_RESPONSE_INITIAL_CAP;
+    }
+    response->size = 0;
+    response->data[0] = '\0';
+    return true;
+}
+
+/**
+ * @brief 用已取得的句柄执行一次请求，响应写入 h->response
+ * @param adaptive 见 handle_prepare()
+ * @return 熔断期间不发出请求，返回 HTTP_CIRCUIT_OPEN
+ */
+static CURLcode handle_perform(HttpHandle *h, const char *endpoint, const char *method,
+                               const RequestBody *body, bool adaptive, long *http_code)
+{
+    *http_code = 0;
+    if (!response_reset(&h->response)) {
+        return CURLE_OUT_OF_MEMORY;
+    }
+    bool probe;
+    if (!breaker_allow(&g_breaker, platform_monotonic_ns(), &probe)) {
+        return HTTP_CIRCUIT_OPEN;
+    }
+    
+    //printf("[DEBUG] HTTP请求信息:\n");
+    //printf("[DEBUG]   方法: %s\n", method);
+    //printf("[DEBUG]   端点: %s\n", endpoint);
+    
+    char time_header[64];
+    struct curl_slist time_node;
+    handle_prepare(h, endpoint, method, body->data, body->len, body->binary, adaptive,
+                   &h->response, time_header, &time_node);
+    
+    /* 执行请求（启用 HTTP/2 时经多路复用线程，与其他线程的请求共用连接） */
+    uint64_t t0 = platform_monotonic_ns();
+    CURLcode res = g_mux != NULL ? mux_perform(h) : curl_easy_perform(h->curl);
+    uint64_t elapsed_us = (platform_monotonic_ns() - t0) / 1000;
+    h->headers_tail->next = NULL;
+    
+    /* 获取HTTP状态码 */
+    curl_easy_getinfo(h->curl, CURLINFO_RESPONSE_CODE, http_code);
+    record_request(h->curl, res == CURLE_OK, elapsed_us, h->response.size);
+    record_outcome(h->curl, res, *http_code, elapsed_us, adaptive, probe);
+    
+    //printf("[DEBUG] HTTP响应状态码: %ld\n", *http_code);
+    return res;
+}
+
+/**
+ * @brief 响应是否为二进制编码（中间件的错误响应等仍为 JSON）
+ */
+static bool response_is_wire(HttpHandle *h)
+{
+    char *type = NULL;
+    curl_easy_getinfo(h->curl, CURLINFO_CONTENT_TYPE, &type);
+    return type != NULL && strncmp(type, WIRE_CONTENT_TYPE, sizeof(WIRE_CONTENT_TYPE) - 1) == 0;
+}
+
+/**
+ * @brief 句柄中的响应是否表示成功，按响应的 Content-Type 解析
+ */
+static bool handle_response_success(HttpHandle *h)
+{
+    if (response_is_wire(h)) {
+        return wire_decode_status((const uint8_t *)h->response.data, h->response.size, NULL);
+    }
+    return response_success(h->response.data);
+}
+
+/**
+ * @brief 发送请求并返回 CURL 结果与HTTP状态码，不打印错误
+ * @param adaptive 见 handle_prepare()
+ * @return 响应内容（调用方 free()），请求失败返回NULL
+ */
+static char* server_request_status(const char *endpoint, const char *method, const char *json_data,
+                                   bool adaptive, CURLcode *res_out, long *http_code_out)
+{
+    *res_out = CURLE_FAILED_INIT;
+    *http_code_out = 0;
+    if (!g_api_initialized) {
+        return NULL;
+    }
+    
+    HttpHandle *h = handle_acquire();
+    if (h == NULL) {
+        return NULL;
+    }
+    
+    RequestBody body = { json_data, json_data != NULL ? strlen(json_data) : 0, false };
+    *res_out = handle_perform(h, endpoint, method, &body, adaptive, http_code_out);
+    char *response = NULL;
+    if (*res_out == CURLE_OK) {
+        /* 响应缓冲区整个交给调用方，句柄下次请求时重新分配 */
+        response = h->response.data;
+        memset(&h->response, 0, sizeof(h->response));
+    }
+    
+    /* 句柄放回空闲链表，连接保持 */
+    handle_release(h);
+    return response;
+}
+
+static void report_request_error(CURLcode res)
+{
+    if (res == CURLE_FAILED_INIT) {
+        fprintf(stderr, "错误：无法初始化CURL\n");
+    } else if (res == HTTP_CIRCUIT_OPEN) {
+        fprintf(stderr, "错误：服务器暂时不可用（熔断中），请求未发送\n");
+    } else {
+        fprintf(stderr, "[DEBUG] CURL错误码: %d\n", res);
+        fprintf(stderr, "错误：HTTP请求失败: %s\n", curl_easy_strerror(res));
+    }
+}
+
+/**
+ * @brief 发送HTTP/HTTPS请求
+ */
+char* server_request(const char *endpoint, const char *method, const char *json_data)
+{
+    if (!g_api_initialized) {
+        fprintf(stderr, "[DEBUG] API未初始化\n");
+        return NULL;
+    }
+    
+    CURLcode res;
+    long http_code;
+    char *response = server_request_status(endpoint, method, json_data, false, &res, &http_code);
+    if (response == NULL) {
+        report_request_error(res);
+    }
+    return response;
+}
+
+/**
+ * @brief 发送单个账户操作
+ *
+ * 请求体写入句柄的缓冲区，响应留在句柄中只扫描 success，
+ * 稳定后本模块与 cJSON 都不再分配内存。
+ * @param fields 为NULL时不带请求体
+ * @return HTTP 2xx 且响应 success 为 true
+ */
+static bool op_request(const char *endpoint, const char *method, const OpFields *fields,
+                       CURLcode *res_out, long *http_code_out)
+{
+    *res_out = CURLE_FAILED_INIT;
+    *http_code_out = 0;
+    if (!g_api_initialized) {
+        return false;
+    }
+    
+    HttpHandle *h = handle_acquire();
+    if (h == NULL) {
+        return false;
+    }
+    
+    RequestBody body = { NULL, 0, wire_enabled() };
+    if (fields != NULL && !encode_op_body(h, fields, &body)) {
+        handle_release(h);
+        *res_out = CURLE_OUT_OF_MEMORY;
+        return false;
+    }
+    *res_out = handle_perform(h, endpoint, method, &body, true, http_code_out);
+    bool success = *res_out == CURLE_OK && *http_code_out < 300 && handle_response_success(h);
+    handle_release(h);
+    return success;
+}
+
+/**
+ * @brief 发送单个账户操作，请求失败时打印错误
+ */
+static bool op_request_report(const char *endpoint, const char *method, const OpFields *fields)
+{
+    CURLcode res;
+    long http_code;
+    bool success = op_request(endpoint, method, fields, &res, &http_code);
+    if (res != CURLE_OK) {
+        report_request_error(res);
+    }
+    return success;
+}
+/**
+ * @brief 获取请求统计
+ */
+void server_api_get_stats(ServerApiStats *stats)
+{
+    if (!g_api_initialized) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    platform_mutex_lock(&g_conn_lock);
+    *stats = g_stats;
+    platform_mutex_unlock(&g_conn_lock);
+    stats->allocations = atomic_load(&g_allocations);
+    stats->curl_allocations = atomic_load(&g_curl_allocations);
+    breaker_get_stats(&g_breaker, platform_monotonic_ns(), &stats->breaker);
+}
+
+#endif  /* DISABLE_NETWORK - 结束网络功能块 */
+
+/* ==================== 安全机制 ==================== */
+/* 这些函数在所有模式下都需要（用于 generate_client_id） */
+
+/**
+ * @brief 字节数组转十六进制字符串
+ * @param bytes 字节数组
+ * @param len 字节数组长度
+ * @param hex 输出十六进制字符串
+ */
+static void bytes_to_hex(const unsigned char *bytes, size_t len, char *hex)
+{
+    for (size_t i = 0; i < len; i++) {
+        sprintf(hex + i * 2, "%02x", bytes[i]);
+    }
+    hex[len * 2] = '\0';
+}
+
+/**
+ * @brief SHA256哈希计算
+ * @param data 输入数据
+ * @param len 数据长度
+ * @param output 输出哈希字符串（65字节）
+ */
+static void sha256_hash(const unsigned char *data, size_t len, char *output)
+{
+#ifdef _WIN32
     /* Windows使用CryptoAPI */
     HCRYPTPROV hProv = 0;
     HCRYPTHASH hHash = 0;
@@ -669,36 +1831,8 @@ bool api_create_account(const ACCOUNT *acc)
         return false;
     }
     
-    /* 构建JSON */
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "uuid", acc->UUID);
-    cJSON_AddNumberToObject(json, "balance", (double)acc->BALANCE);
-    cJSON_AddNumberToObject(json, "timestamp", (double)time(NULL));
-    
-    char *json_str = cJSON_Print(json);
-    cJSON_Delete(json);
-    
-    /* 发送请求 */
-    char *response = server_request("/api/account/create", "POST", json_str);
-    free(json_str);
-    
-    if (response == NULL) {
-        return false;
-    }
-    
-    /* 解析响应 */
-    cJSON *resp_json = cJSON_Parse(response);
-    free(response);
-    
-    if (resp_json == NULL) {
-        return false;
-    }
-    
-    cJSON *success = cJSON_GetObjectItem(resp_json, "success");
-    bool result = (success != NULL && cJSON_IsTrue(success));
-    
-    cJSON_Delete(resp_json);
-    return result;
+    OpFields f = { "uuid", acc->UUID, NULL, "balance", acc->BALANCE, NULL };
+    return op_request_report("/api/account/create", "POST", &f);
 }
 
 /**
@@ -710,77 +1844,21 @@ bool api_deposit(const char *uuid, LLUINT amount)
         return false;
     }
     
-    /* 构建JSON */
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "uuid", uuid);
-    cJSON_AddNumberToObject(json, "amount", (double)amount);
-    cJSON_AddNumberToObject(json, "timestamp", (double)time(NULL));
-    
-    char *json_str = cJSON_Print(json);
-    cJSON_Delete(json);
-    
-    /* 发送请求 */
-    char *response = server_request("/api/account/deposit", "POST", json_str);
-    free(json_str);
-    
-    if (response == NULL) {
-        return false;
-    }
-    
-    /* 解析响应 */
-    cJSON *resp_json = cJSON_Parse(response);
-    free(response);
-    
-    if (resp_json == NULL) {
-        return false;
-    }
-    
-    cJSON *success = cJSON_GetObjectItem(resp_json, "success");
-    bool result = (success != NULL && cJSON_IsTrue(success));
-    
-    cJSON_Delete(resp_json);
-    return result;
+    OpFields f = { "uuid", uuid, NULL, "amount", amount, NULL };
+    return op_request_report("/api/account/deposit", "POST", &f);
 }
 
-/**
- * @brief 取款API
- */
-bool api_withdraw(const char *uuid, LLUINT amount)
-{
-    if (g_run_mode != MODE_SERVER) {
-        return false;
-    }
-    
-    /* 构建JSON */
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "uuid", uuid);
-    cJSON_AddNumberToObject(json, "amount", (double)amount);
-    cJSON_AddNumberToObject(json, "timestamp", (double)time(NULL));
-    
-    char *json_str = cJSON_Print(json);
-    cJSON_Delete(json);
-    
-    /* 发送请求 */
-    char *response = server_request("/api/account/withdraw", "POST", json_str);
-    free(json_str);
-    
-    if (response == NULL) {
-        return false;
-    }
-    
-    /* 解析响应 */
-    cJSON *resp_json = cJSON_Parse(response);
-    free(response);
-    
-    if (resp_json == NULL) {
+/**
+ * @brief 取款API
+ */
+bool api_withdraw(const char *uuid, LLUINT amount)
+{
+    if (g_run_mode != MODE_SERVER) {
         return false;
     }
     
-    cJSON *success = cJSON_GetObjectItem(resp_json, "success");
-    bool result = (success != NULL && cJSON_IsTrue(success));
-    
-    cJSON_Delete(resp_json);
-    return result;
+    OpFields f = { "uuid", uuid, NULL, "amount", amount, NULL };
+    return op_request_report("/api/account/withdraw", "POST", &f);
 }
 
 /**
@@ -792,37 +1870,8 @@ bool api_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount)
         return false;
     }
     
-    /* 构建JSON */
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "uuid_from", uuid_from);
-    cJSON_AddStringToObject(json, "uuid_to", uuid_to);
-    cJSON_AddNumberToObject(json, "amount", (double)amount);
-    cJSON_AddNumberToObject(json, "timestamp", (double)time(NULL));
-    
-    char *json_str = cJSON_Print(json);
-    cJSON_Delete(json);
-    
-    /* 发送请求 */
-    char *response = server_request("/api/account/transfer", "POST", json_str);
-    free(json_str);
-    
-    if (response == NULL) {
-        return false;
-    }
-    
-    /* 解析响应 */
-    cJSON *resp_json = cJSON_Parse(response);
-    free(response);
-    
-    if (resp_json == NULL) {
-        return false;
-    }
-    
-    cJSON *success = cJSON_GetObjectItem(resp_json, "success");
-    bool result = (success != NULL && cJSON_IsTrue(success));
-    
-    cJSON_Delete(resp_json);
-    return result;
+    OpFields f = { "uuid_from", uuid_from, uuid_to, "amount", amount, NULL };
+    return op_request_report("/api/account/transfer", "POST", &f);
 }
 
 /**
@@ -837,68 +1886,346 @@ bool api_delete_account(const char *uuid)
     /* 构建URL */
     char endpoint[128];
     snprintf(endpoint, sizeof(endpoint), "/api/account/%s", uuid);
-    
-    /* 发送请求 */
-    char *response = server_request(endpoint, "DELETE", NULL);
-    
-    if (response == NULL) {
+    return op_request_report(endpoint, "DELETE", NULL);
+}
+
+/**
+ * @brief 同步账户数据API
+ */
+bool api_sync_account(const ACCOUNT *acc)
+{
+    if (g_run_mode != MODE_SERVER) {
         return false;
     }
     
-    /* 解析响应 */
+    OpFields f = { "uuid", acc->UUID, NULL, "balance", acc->BALANCE, NULL };
+    return op_request_report("/api/account/sync", "POST", &f);
+}
+
+/**
+ * @brief 解析批量同步响应，按请求顺序写出每个账户是否成功
+ * @return 成功的数量；响应格式不符时全部视为失败
+ */
+static size_t parse_sync_batch_response(const char *response, size_t n, bool *item_ok)
+{
     cJSON *resp_json = cJSON_Parse(response);
-    free(response);
-    
     if (resp_json == NULL) {
-        return false;
+        return 0;
     }
     
+    size_t synced = 0;
     cJSON *success = cJSON_GetObjectItem(resp_json, "success");
-    bool result = (success != NULL && cJSON_IsTrue(success));
+    cJSON *results = cJSON_GetObjectItem(resp_json, "results");
+    if (success != NULL && cJSON_IsTrue(success) && results != NULL && cJSON_IsArray(results) &&
+        (size_t)cJSON_GetArraySize(results) == n) {
+        size_t i = 0;
+        cJSON *item;
+        cJSON_ArrayForEach(item, results) {
+            cJSON *item_success = cJSON_GetObjectItem(item, "success");
+            if (item_success != NULL && cJSON_IsTrue(item_success)) {
+                item_ok[i] = true;
+                synced++;
+            }
+            i++;
+        }
+    }
     
     cJSON_Delete(resp_json);
-    return result;
+    return synced;
 }
 
 /**
- * @brief 同步账户数据API
+ * @brief 批量推送中一个进行中的请求（一组连续的账户）
  */
-bool api_sync_account(const ACCOUNT *acc)
+typedef struct {
+    HttpHandle *h;
+    size_t chunk;                  /**< 组号 */
+    size_t first;                  /**< 组内第一个账户的下标 */
+    size_t n;                      /**< 组内账户数 */
+    bool probe;                    /**< 是否为熔断器半开时的探测请求 */
+    char time_header[64];
+    struct curl_slist time_node;
+} SyncTransfer;
+
+/**
+ * @brief 是否为值得重试的暂时性错误（连接、超时、服务器过载）
+ */
+static bool sync_transient_failure(CURLcode res, long http_code)
 {
-    if (g_run_mode != MODE_SERVER) {
+    switch (res) {
+    case CURLE_OK:
+        return http_code == 429 || http_code >= 500;
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+        return true;
+    default:
         return false;
     }
+}
+
+/**
+ * @brief 发起一组账户的推送：一个账户时用 /api/account/sync，多个时用批量端点
+ */
+static SyncTransfer* sync_transfer_start(CURLM *multi, const ACCOUNT *accounts,
+                                         size_t chunk, size_t first, size_t n)
+{
+    SyncTransfer *t = calloc(1, sizeof(SyncTransfer));
+    if (t == NULL) {
+        return NULL;
+    }
+    t->chunk = chunk;
+    t->first = first;
+    t->n = n;
+    t->h = handle_acquire();
+    if (t->h == NULL) {
+        free(t);
+        return NULL;
+    }
     
-    /* 构建JSON */
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "uuid", acc->UUID);
-    cJSON_AddNumberToObject(json, "balance", (double)acc->BALANCE);
-    cJSON_AddNumberToObject(json, "timestamp", (double)time(NULL));
-    
-    char *json_str = cJSON_Print(json);
-    cJSON_Delete(json);
+    /* 请求体与响应都放在句柄自己的缓冲区中，请求结束前句柄不归还 */
+    bool batch = g_config.sync_batch_size > 1;
+    RequestBody body;
+    bool encoded;
+    if (batch) {
+        encoded = encode_sync_batch_body(t->h, &accounts[first], n, &body);
+    } else {
+        OpFields f = { "uuid", accounts[first].UUID, NULL, "balance", accounts[first].BALANCE, NULL };
+        encoded = encode_op_body(t->h, &f, &body);
+    }
+    if (!encoded || !response_reset(&t->h->response)) {
+        handle_release(t->h);
+        free(t);
+        return NULL;
+    }
     
-    /* 发送请求 */
-    char *response = server_request("/api/account/sync", "POST", json_str);
-    free(json_str);
+    handle_prepare(t->h, batch ? "/api/accounts/sync_batch" : "/api/account/sync", "POST",
+                   body.data, body.len, body.binary, false, &t->h->response, t->time_header,
+                   &t->time_node);
+    curl_easy_setopt(t->h->curl, CURLOPT_PRIVATE, (void *)t);
     
-    if (response == NULL) {
-        return false;
+    /* 熔断期间这一组直接算作失败，不等超时 */
+    bool allowed = breaker_allow(&g_breaker, platform_monotonic_ns(), &t->probe);
+    if (!allowed || curl_multi_add_handle(multi, t->h->curl) != CURLM_OK) {
+        if (allowed) {
+            breaker_cancel(&g_breaker, t->probe);
+        }
+        t->h->headers_tail->next = NULL;
+        handle_release(t->h);
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+/**
+ * @brief 并发推送一批账户
+ *
+ * 账户按 [sync] batch_size 分组，每组一个请求；所有请求在调用线程中由一个
+ * curl multi 句柄驱动，最多同时进行 max_in_flight 个，完成一个立即补上一个；
+ * 句柄与连接来自 server_request() 的同一个复用池。
+ * 暂时性失败的组放入重试列表，等待 SYNC_RETRY_BASE_MS * 2^(n-1) 后整组重新发送
+ * （批量端点在一个事务中写入，失败时整组未生效，重发是安全的）。
+ */
+size_t api_sync_accounts(const ACCOUNT *accounts, size_t count, bool *ok,
+                         SyncProgressFunc progress, void *user, SyncBatchStats *stats)
+{
+    SyncBatchStats st;
+    memset(&st, 0, sizeof(st));
+    st.total = count;
+    st.max_in_flight = (size_t)g_config.sync_max_in_flight;
+    st.batch_size = (size_t)g_config.sync_batch_size;
+    if (ok != NULL) {
+        memset(ok, 0, count * sizeof(bool));
+    }
+    if (stats != NULL) {
+        *stats = st;
+    }
+    if (g_run_mode != MODE_SERVER || count == 0) {
+        return 0;
     }
     
-    /* 解析响应 */
-    cJSON *resp_json = cJSON_Parse(response);
-    free(response);
-    
-    if (resp_json == NULL) {
-        return false;
+    size_t chunks = (count + st.batch_size - 1) / st.batch_size;
+    CURLM *multi = curl_multi_init();
+    unsigned char *attempts = calloc(chunks, 1);
+    uint64_t *ready_at = calloc(chunks, sizeof(uint64_t));
+    size_t *retry = malloc(chunks * sizeof(size_t));
+    bool *item_ok = calloc(count, sizeof(bool));
+    if (multi == NULL || attempts == NULL || ready_at == NULL || retry == NULL || item_ok == NULL) {
+        if (multi != NULL) {
+            curl_multi_cleanup(multi);
+        }
+        free(attempts);
+        free(ready_at);
+        free(retry);
+        free(item_ok);
+        return 0;
+    }
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)st.max_in_flight);
+    
+    uint64_t t0 = platform_monotonic_ns();
+    size_t next_fresh = 0;     /* 下一个未发送过的组 */
+    size_t retry_n = 0;        /* 等待重试的组数 */
+    size_t in_flight = 0;
+    size_t done = 0;           /* 已有结果的账户数 */
+    
+    while (done < count) {
+        /* 补足并发：先发到期的重试，再发新组 */
+        uint64_t now = platform_monotonic_ns();
+        uint64_t next_ready = 0;
+        while (in_flight < st.max_in_flight) {
+            size_t c = chunks;
+            for (size_t r = 0; r < retry_n; r++) {
+                if (ready_at[retry[r]] <= now) {
+                    c = retry[r];
+                    retry[r] = retry[--retry_n];
+                    break;
+                }
+                if (next_ready == 0 || ready_at[retry[r]] < next_ready) {
+                    next_ready = ready_at[retry[r]];
+                }
+            }
+            if (c == chunks) {
+                if (next_fresh == chunks) {
+                    break;
+                }
+                c = next_fresh++;
+            }
+            
+            size_t first = c * st.batch_size;
+            size_t n = count - first < st.batch_size ? count - first : st.batch_size;
+            attempts[c]++;
+            if (sync_transfer_start(multi, accounts, c, first, n) == NULL) {
+                st.failed += n;
+                done += n;
+                if (progress != NULL) {
+                    progress(done, count, user);
+                }
+                continue;
+            }
+            in_flight++;
+            st.requests++;
+        }
+        if (done == count) {
+            break;
+        }
+        
+        int running = 0;
+        curl_multi_perform(multi, &running);
+        
+        /* 处理已完成的请求 */
+        bool completed = false;
+        CURLMsg *msg;
+        int queued;
+        while ((msg = curl_multi_info_read(multi, &queued)) != NULL) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+            CURL *curl = msg->easy_handle;
+            CURLcode res = msg->data.result;
+            SyncTransfer *t = NULL;
+            long http_code = 0;
+            curl_off_t total_us = 0;
+            curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&t);
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+            curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total_us);
+            curl_multi_remove_handle(multi, curl);
+            t->h->headers_tail->next = NULL;
+            record_request(curl, res == CURLE_OK, (uint64_t)total_us, t->h->response.size);
+            record_outcome(curl, res, http_code, (uint64_t)total_us, false, t->probe);
+            in_flight--;
+            completed = true;
+            
+            size_t c = t->chunk;
+            size_t first = t->first;
+            size_t n = t->n;
+            size_t synced = 0;
+            if (res == CURLE_OK && http_code < 300) {
+                if (st.batch_size > 1 && response_is_wire(t->h)) {
+                    synced = wire_decode_sync_batch((const uint8_t *)t->h->response.data,
+                                                    t->h->response.size, n, &item_ok[first]);
+                } else if (st.batch_size > 1) {
+                    synced = parse_sync_batch_response(t->h->response.data, n, &item_ok[first]);
+                } else if (handle_response_success(t->h)) {
+                    item_ok[first] = true;
+                    synced = 1;
+                }
+            }
+            handle_release(t->h);
+            free(t);
+            
+            if (synced == 0 && sync_transient_failure(res, http_code) &&
+                attempts[c] <= (unsigned)g_config.sync_max_retries) {
+                ready_at[c] = platform_monotonic_ns() +
+                    ((uint64_t)SYNC_RETRY_BASE_MS * 1000000ull << (attempts[c] - 1));
+                retry[retry_n++] = c;
+                st.retries++;
+                continue;
+            }
+            
+            st.succeeded += synced;
+            st.failed += n - synced;
+            done += n;
+            if (progress != NULL) {
+                progress(done, count, user);
+            }
+        }
+        
+        /* 有请求完成时立即补发；否则等待网络事件，只剩退避中的重试时睡到最早的到期时间 */
+        if (done < count && !completed) {
+            int timeout_ms = 100;
+            if (in_flight == 0 && next_ready != 0) {
+                now = platform_monotonic_ns();
+                uint64_t wait_ms = next_ready > now ? (next_ready - now) / 1000000 + 1 : 0;
+                timeout_ms = wait_ms < 100 ? (int)wait_ms : 100;
+            }
+            if (timeout_ms > 0) {
+                curl_multi_poll(multi, NULL, 0, timeout_ms, NULL);
+            }
+        }
     }
     
-    cJSON *success = cJSON_GetObjectItem(resp_json, "success");
-    bool result = (success != NULL && cJSON_IsTrue(success));
+    st.elapsed_us = (platform_monotonic_ns() - t0) / 1000;
+    curl_multi_cleanup(multi);
+    if (ok != NULL) {
+        memcpy(ok, item_ok, count * sizeof(bool));
+    }
+    free(attempts);
+    free(ready_at);
+    free(retry);
+    free(item_ok);
     
-    cJSON_Delete(resp_json);
-    return result;
+    if (stats != NULL) {
+        *stats = st;
+    }
+    return st.succeeded;
+}
+
+/**
+ * @brief 读取响应中以分为单位的余额，与其他金额输入一样经 parse_cents_value() 检查
+ * @note 负数、小数与超过 2^53 的数值（double 已不精确）被拒绝；字符串形式不受 2^53 限制
+ */
+static AmountParseResult json_balance_cents(const cJSON *item, LLUINT *cents)
+{
+    if (item != NULL && cJSON_IsString(item)) {
+        return parse_cents_value(item->valuestring, strlen(item->valuestring), cents);
+    }
+    if (item == NULL || !cJSON_IsNumber(item)) {
+        return AMOUNT_ERR_EMPTY;
+    }
+    if (item->valuedouble > JSON_EXACT_INT_MAX) {
+        return AMOUNT_ERR_OVERFLOW;
+    }
+    char text[AMOUNT_STR_MAX];
+    int n = snprintf(text, sizeof(text), "%.17g", item->valuedouble);
+    if (n < 0 || (size_t)n >= sizeof(text)) {
+        return AMOUNT_ERR_FORMAT;
+    }
+    return parse_cents_value(text, (size_t)n, cents);
 }
 
 /**
@@ -950,14 +2277,18 @@ int api_fetch_all_accounts(ACCOUNT *accounts, int max_count)
         if (item == NULL) continue;
         
         cJSON *uuid = cJSON_GetObjectItem(item, "uuid");
-        cJSON *balance = cJSON_GetObjectItem(item, "balance");
+        LLUINT balance = 0;
+        AmountParseResult parsed = json_balance_cents(cJSON_GetObjectItem(item, "balance"), &balance);
+        if (uuid != NULL && cJSON_IsString(uuid) && parsed != AMOUNT_OK) {
+            fprintf(stderr, "[拉取] 账户 %.36s 余额无效（%s），已跳过\n", uuid->valuestring,
+                    amount_parse_error_string(parsed));
+        }
         
-        if (uuid != NULL && cJSON_IsString(uuid) && 
-            balance != NULL && cJSON_IsNumber(balance)) {
+        if (uuid != NULL && cJSON_IsString(uuid) && parsed == AMOUNT_OK) {
             
             strncpy(accounts[count].UUID, uuid->valuestring, sizeof(accounts[count].UUID) - 1);
             accounts[count].UUID[36] = '\0';
-            accounts[count].BALANCE = (LLUINT)balance->valuedouble;
+            accounts[count].BALANCE = balance;
             accounts[count].PASSWORD = 0;  /* 服务器不存储密码 */
             
             count++;
@@ -970,6 +2301,253 @@ int api_fetch_all_accounts(ACCOUNT *accounts, int max_count)
     return count;
 }
 
+/**
+ * @brief 解析一页账户列表，每满 max_count 个交给回调一次
+ * @param next_after 输出下一页的起点，没有下一页时为空串
+ * @param stopped 回调要求停止时置true
+ * @return 本页账户数，响应表示失败时返回-1
+ * @note 不支持分页的旧服务器一次返回全部账户，同样按 max_count 分批交给回调
+ */
+static int parse_accounts_page(const char *response, ACCOUNT *accounts, int max_count,
+                               AccountPageFunc page, void *user, bool *stopped,
+                               char next_after[37], int64_t *watermark)
+{
+    next_after[0] = '\0';
+    cJSON *resp_json = cJSON_Parse(response);
+    if (resp_json == NULL) {
+        fprintf(stderr, "[拉取] JSON解析失败\n");
+        return -1;
+    }
+    
+    cJSON *success = cJSON_GetObjectItem(resp_json, "success");
+    if (success == NULL || !cJSON_IsTrue(success)) {
+        fprintf(stderr, "[拉取] 服务器返回失败\n");
+        cJSON_Delete(resp_json);
+        return -1;
+    }
+    
+    /* 没有账户时旧服务器返回 "accounts": null */
+    int count = 0;
+    int buffered = 0;
+    cJSON *accounts_array = cJSON_GetObjectItem(resp_json, "accounts");
+    cJSON *item;
+    cJSON_ArrayForEach(item, accounts_array) {
+        if (buffered == max_count) {
+            if (!page(accounts, (size_t)buffered, user)) {
+                *stopped = true;
+                break;
+            }
+            buffered = 0;
+        }
+        cJSON *uuid = cJSON_GetObjectItem(item, "uuid");
+        LLUINT balance = 0;
+        AmountParseResult parsed = json_balance_cents(cJSON_GetObjectItem(item, "balance"), &balance);
+        if (uuid != NULL && cJSON_IsString(uuid) && parsed != AMOUNT_OK) {
+            fprintf(stderr, "[拉取] 账户 %.36s 余额无效（%s），已跳过\n", uuid->valuestring,
+                    amount_parse_error_string(parsed));
+        }
+        
+        if (uuid != NULL && cJSON_IsString(uuid) && parsed == AMOUNT_OK) {
+            ACCOUNT *acc = &accounts[buffered++];
+            memset(acc, 0, sizeof(ACCOUNT));
+            strncpy(acc->UUID, uuid->valuestring, sizeof(acc->UUID) - 1);
+            acc->BALANCE = balance;
+            acc->PASSWORD = 0;  /* 服务器不存储密码 */
+            count++;
+        }
+    }
+    if (!*stopped && buffered > 0 && !page(accounts, (size_t)buffered, user)) {
+        *stopped = true;
+    }
+    
+    cJSON *mark = cJSON_GetObjectItem(resp_json, "watermark");
+    if (mark != NULL && cJSON_IsNumber(mark)) {
+        *watermark = (int64_t)mark->valuedouble;
+    }
+    cJSON *next = cJSON_GetObjectItem(resp_json, "next_after");
+    if (next != NULL && cJSON_IsString(next) && strlen(next->valuestring) == 36) {
+        memcpy(next_after, next->valuestring, 37);
+    }
+    
+    cJSON_Delete(resp_json);
+    return count;
+}
+
+/**
+ * @brief 解析一页二进制编码的账户列表，参数与返回值同 parse_accounts_page()
+ */
+static int parse_accounts_frames(const ResponseBuffer *response, ACCOUNT *accounts, int max_count,
+                                 AccountPageFunc page, void *user, bool *stopped,
+                                 char next_after[37], int64_t *watermark)
+{
+    next_after[0] = '\0';
+    WireReader r;
+    wire_reader_init(&r, (const uint8_t *)response->data, response->size);
+    
+    int count = 0;
+    int buffered = 0;
+    WirePageEnd end;
+    WireReadResult rr;
+    while ((rr = wire_read_frame(&r, &accounts[buffered], &end)) == WIRE_READ_ACCOUNT) {
+        count++;
+        if (++buffered == max_count) {
+            if (!page(accounts, (size_t)buffered, user)) {
+                *stopped = true;
+                return count;
+            }
+            buffered = 0;
+        }
+    }
+    if (rr != WIRE_READ_END || !end.success) {
+        fprintf(stderr, "[拉取] 服务器返回失败\n");
+        return -1;
+    }
+    if (buffered > 0 && !page(accounts, (size_t)buffered, user)) {
+        *stopped = true;
+    }
+    
+    *watermark = end.watermark;
+    memcpy(next_after, end.next_after, 37);
+    return count;
+}
+
+/**
+ * @brief 按 uuid 键集分页拉取服务器账户
+ *
+ * 每次请求一页（GET /api/accounts?limit=N&after=<上一页最后的uuid>），解析后交给
+ * 回调再请求下一页；响应缓冲、JSON 树与账户数组都只有一页大小，与服务器账户总数无关。
+ * 不支持分页的旧服务器一次返回全部账户且没有 next_after，只请求一次。
+ * 使用二进制编码时逐帧解码，不构建 JSON 树。
+ */
+int64_t api_pull_accounts(int64_t since, AccountPageFunc page, void *user, int64_t *watermark)
+{
+    *watermark = 0;
+    if (g_run_mode != MODE_SERVER) {
+        return -1;
+    }
+    
+    int page_size = g_config.sync_pull_page_size;
+    ACCOUNT *accounts = malloc((size_t)page_size * sizeof(ACCOUNT));
+    if (accounts == NULL) {
+        return -1;
+    }
+    
+    int64_t total = 0;
+    char after[37] = "";
+    bool first = true;
+    for (;;) {
+        char endpoint[160];
+        int len = snprintf(endpoint, sizeof(endpoint), "/api/accounts?limit=%d", page_size);
+        if (after[0] != '\0') {
+            len += snprintf(endpoint + len, sizeof(endpoint) - (size_t)len, "&after=%s", after);
+        }
+        if (since > 0) {
+            snprintf(endpoint + len, sizeof(endpoint) - (size_t)len, "&since=%lld", (long long)since);
+        }
+        
+        HttpHandle *h = handle_acquire();
+        RequestBody body = { NULL, 0, wire_enabled() };
+        long http_code;
+        CURLcode res = h != NULL ? handle_perform(h, endpoint, "GET", &body, false, &http_code)
+                                 : CURLE_FAILED_INIT;
+        if (res != CURLE_OK) {
+            if (h != NULL) {
+                handle_release(h);
+            }
+            report_request_error(res);
+            fprintf(stderr, "[拉取] 服务器请求失败\n");
+            total = -1;
+            break;
+        }
+        
+        /* 水位取第一页的：之后翻页期间的修改留给下次拉取 */
+        int64_t page_mark = 0;
+        bool stopped = false;
+        int count;
+        if (response_is_wire(h)) {
+            count = parse_accounts_frames(&h->response, accounts, page_size, page, user, &stopped,
+                                          after, &page_mark);
+        } else {
+            count = parse_accounts_page(h->response.data, accounts, page_size, page, user, &stopped,
+                                        after, &page_mark);
+        }
+        handle_release(h);
+        if (count < 0) {
+            total = -1;
+            break;
+        }
+        if (first) {
+            *watermark = page_mark;
+            first = false;
+        }
+        
+        total += count;
+        if (stopped || after[0] == '\0') {
+            break;
+        }
+    }
+    
+    free(accounts);
+    return total;
+}
+
+/**
+ * @brief 发送一个带幂等标识的账户操作
+ */
+ApiSendResult api_send_operation(ApiOperation op, const char *op_id, const char *uuid,
+                                 const char *uuid_to, LLUINT amount)
+{
+    if (g_run_mode != MODE_SERVER) {
+        return API_SEND_RETRY;
+    }
+
+    const char *endpoint = NULL;
+    const char *method = "POST";
+    char path[192];
+    OpFields f = { "uuid", uuid, NULL, "amount", amount, op_id };
+    const OpFields *fields = &f;
+    switch (op) {
+    case API_OP_CREATE:
+        endpoint = "/api/account/create";
+        f.amount_key = "balance";
+        break;
+    case API_OP_DEPOSIT:
+    case API_OP_WITHDRAW:
+        endpoint = op == API_OP_DEPOSIT ? "/api/account/deposit" : "/api/account/withdraw";
+        break;
+    case API_OP_TRANSFER:
+        endpoint = "/api/account/transfer";
+        f.uuid_key = "uuid_from";
+        f.uuid_to = uuid_to;
+        break;
+    case API_OP_DELETE:
+        /* DELETE 不带请求体，op_id 放在查询参数中 */
+        snprintf(path, sizeof(path), "/api/account/%s?op_id=%s", uuid, op_id);
+        endpoint = path;
+        method = "DELETE";
+        fields = NULL;
+        break;
+    default:
+        return API_SEND_REJECTED;
+    }
+
+    CURLcode res;
+    long http_code;
+    if (op_request(endpoint, method, fields, &res, &http_code)) {
+        return API_SEND_OK;
+    }
+    /* 重发已执行的创建由服务器按 op_id 识别并返回成功，409 表示 UUID 已被其他账户占用，按拒绝处理 */
+    if (res == CURLE_OK && op == API_OP_DELETE && http_code == 404) {
+        return API_SEND_OK;    /* 目标状态已达成 */
+    }
+    /* 连接类错误与认证失败（多为时钟或证书问题）都与操作本身无关，稍后重发 */
+    if (res != CURLE_OK || http_code == 401 || http_code == 403 ||
+        sync_transient_failure(res, http_code)) {
+        return API_SEND_RETRY;
+    }
+    return API_SEND_REJECTED;
+}
+
 #else  /* DISABLE_NETWORK 定义时的存根实现 */
 
 /* ==================== 网络功能禁用时的存根实现 ==================== */
@@ -982,6 +2560,11 @@ char* server_request(const char *endpoint, const char *method, const char *json_
     return NULL;
 }
 
+void server_api_get_stats(ServerApiStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
 bool fetch_server_certificate(void)
 {
     fprintf(stderr, "错误：网络功能已禁用\n");
@@ -1035,6 +2618,22 @@ bool api_sync_account(const ACCOUNT *acc)
     return false;
 }
 
+size_t api_sync_accounts(const ACCOUNT *accounts, size_t count, bool *ok,
+                         SyncProgressFunc progress, void *user, SyncBatchStats *stats)
+{
+    (void)accounts;
+    (void)progress;
+    (void)user;
+    if (ok != NULL) {
+        memset(ok, 0, count * sizeof(bool));
+    }
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(*stats));
+        stats->total = count;
+    }
+    return 0;
+}
+
 int api_fetch_all_accounts(ACCOUNT *accounts, int max_count)
 {
     (void)accounts;
@@ -1042,4 +2641,24 @@ int api_fetch_all_accounts(ACCOUNT *accounts, int max_count)
     return -1;
 }
 
+int64_t api_pull_accounts(int64_t since, AccountPageFunc page, void *user, int64_t *watermark)
+{
+    (void)since;
+    (void)page;
+    (void)user;
+    *watermark = 0;
+    return -1;
+}
+
+ApiSendResult api_send_operation(ApiOperation op, const char *op_id, const char *uuid,
+                                 const char *uuid_to, LLUINT amount)
+{
+    (void)op;
+    (void)op_id;
+    (void)uuid;
+    (void)uuid_to;
+    (void)amount;
+    return API_SEND_RETRY;
+}
+
 #endif  /* DISABLE_NETWORK */
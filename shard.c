@@ -0,0 +1,1555 @@
+/**
+ * @file shard.c
+ * @brief 分片账户引擎实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/shard.h>
+#include <lib/mpsc_ring.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+/* ==================== 常量配置 ==================== */
+
+#define SHARD_IDLE_WAIT_MS 100        /* 分片线程空闲时的最长休眠 */
+#define SHARD_SUBMIT_SPIN 64          /* 队列满时先自旋重试的次数，之后每次休眠1ms */
+#define SHARD_FINISH_RETRIES 3        /* 跨分片转账提交/回滚落盘失败时的重试次数 */
+#define SHARD_LOG_MAGIC 0x44524853u   /* "SHRD" */
+#define SHARD_LOG_ROTATE_RECORDS 4096 /* 日志超过该记录数时截断 */
+#define SHARD_LOG_MAX_FILES 256       /* 与 engine.c 的 ENGINE_MAX_SHARDS 一致，恢复时逐个检查 */
+#define SHARD_RECOVER_LOG "Card/shard-recover.log"  /* 恢复时补记的扣款，最后回放 */
+
+/* ==================== 内部结构 ==================== */
+
+typedef enum {
+    SHARD_OP_DEPOSIT = 0,         /* 存款，也用作跨分片转账的入账阶段（txn 非0） */
+    SHARD_OP_WITHDRAW,
+    SHARD_OP_TRANSFER,            /* 同分片转账 */
+    SHARD_OP_DELETE,
+    SHARD_OP_GET,
+    SHARD_OP_PUT,
+    SHARD_OP_REMOVE,
+    SHARD_OP_RESERVE,             /* 跨分片转账：源分片扣减并挂起 */
+    SHARD_OP_COMMIT,              /* 跨分片转账：源分片确认 */
+    SHARD_OP_ABORT,               /* 跨分片转账：源分片退回 */
+    SHARD_OP_FORGET               /* 跨分片转账已提交：目标分片不再保留入账记录 */
+} ShardOpType;
+
+typedef struct {
+    ShardOpType type;
+    char uuid[37];
+    char uuid_to[37];
+    LLUINT amount;
+    uint64_t txn;                 /* 跨分片转账事务号 */
+    ACCOUNT account;              /* SHARD_OP_PUT 的数据 */
+    EngineFuture *future;         /* 为NULL时不通知完成 */
+} ShardOp;
+
+/** @brief 源分片上尚未提交的转出预留 */
+typedef struct {
+    char uuid[37];
+    LLUINT amount;
+    uint64_t txn;
+} ShardHold;
+
+/** @brief 撤销一个操作所需的信息（本批落盘失败时使用） */
+typedef struct {
+    ShardHold hold;               /* COMMIT/ABORT 取出的预留 */
+    ACCOUNT before;               /* PUT 覆盖前的账户 */
+    bool existed;                 /* PUT 之前账户是否在表中 */
+} ShardUndo;
+
+/* ==================== 日志记录格式 ==================== */
+
+/*
+ * 每个分片有自己的日志 Card/shard-<N>.log，写 .card 之前先把本批的结果追加进去：
+ * 账户写后映像（与 .card 内容相同）和跨分片转账的事务记录，以 BATCH 记录结尾。
+ * 恢复时只回放完整的批次，再按事务记录补完或放弃中断的跨分片转账：
+ * 源分片有 BEGIN 未 END、目标分片有 CREDIT 未 UNCREDIT 时补记源账户的扣款，
+ * 其余情况下源账户文件中从未扣款（预留只改内存），目标账户入账也未落盘。
+ */
+typedef enum {
+    SHARD_LOG_PUT = 1,            /* 账户写后映像 */
+    SHARD_LOG_DELETE,             /* 销户 */
+    SHARD_LOG_BEGIN,              /* 源分片：预留，data 为金额与事务号 */
+    SHARD_LOG_END,                /* 源分片：提交或回滚 */
+    SHARD_LOG_CREDIT,             /* 目标分片：已入账 */
+    SHARD_LOG_UNCREDIT,           /* 目标分片：入账已撤销 */
+    SHARD_LOG_BATCH               /* 批次结束，data 为本批记录数 */
+} ShardLogType;
+
+/**
+ * @brief 定长日志记录（64字节），与 flusher 的日志记录同样加密与校验
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t checksum;            /* 计算时本字段置0 */
+    unsigned char data[sizeof(LLUINT) * 2];
+    char uuid[37];
+    uint8_t type;
+    uint8_t reserved[2];
+} ShardLogRecord;
+
+_Static_assert(sizeof(ShardLogRecord) == 64, "ShardLogRecord must be 64 bytes");
+
+typedef struct {
+    size_t index;
+    AccountHashTable table;       /* 仅本分片线程访问 */
+    MpscRing ring;
+    PlatformThread worker;
+
+    ShardOp *batch;
+    EngineResult *results;
+    bool *persisted_ok;           /* 本批每个操作是否需要落盘成功 */
+    ShardUndo *undo;
+
+    char (*dirty)[37];            /* 本批修改过的账户（每个操作至多两个，按 max_batch 预分配） */
+    size_t dirty_count;
+
+    FILE *log;                    /* 为NULL时所有需要落盘的操作失败 */
+    ShardLogRecord *log_buf;      /* 本批待追加的记录，末尾留一条给 BATCH */
+    size_t log_count;
+    size_t log_capacity;
+    size_t log_records;           /* 自上次截断以来的记录数 */
+
+    ShardHold *holds;
+    size_t hold_count;
+    size_t hold_capacity;
+
+    uint64_t *credited;           /* 已入账、源分片尚未确认提交的事务 */
+    size_t credited_count;
+    size_t credited_capacity;
+
+    char (*stale)[37];            /* 回滚后未能重写的账户文件，重写成功前不截断日志 */
+    size_t stale_count;
+    size_t stale_capacity;
+
+    atomic_size_t applied;
+    atomic_size_t batches;
+    atomic_size_t accounts;
+} Shard;
+
+typedef struct {
+    Shard *shards;
+    size_t count;
+    size_t max_batch;
+    atomic_bool running;
+    atomic_bool stopping;
+    atomic_int submitters;
+    atomic_ullong next_txn;
+    atomic_size_t committed;
+    atomic_size_t aborted;
+} ShardEngine;
+
+static ShardEngine g_shards;
+
+/* ==================== 路由 ==================== */
+
+/**
+ * @brief 分片哈希（FNV-1a）
+ * @note 不能与 Hash 表桶索引共用 DJB2：否则同一分片内的账户只会落在
+ *       桶数的 1/N 上，链表长度放大 N 倍
+ */
+size_t shard_index_of(const char *uuid)
+{
+    uint32_t h = 2166136261u;
+    while (*uuid) {
+        h ^= (unsigned char)*uuid++;
+        h *= 16777619u;
+    }
+    return g_shards.count ? (size_t)(h % g_shards.count) : 0;
+}
+
+/* ==================== 日志读写 ==================== */
+
+static void shard_log_path(size_t index, char *path, size_t size)
+{
+    snprintf(path, size, "Card/shard-%zu.log", index);
+}
+
+static uint32_t log_checksum(const ShardLogRecord *rec)
+{
+    ShardLogRecord tmp = *rec;
+    tmp.checksum = 0;
+
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    const unsigned char *p = (const unsigned char *)&tmp;
+    for (size_t i = 0; i < sizeof(tmp); i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void log_encode(ShardLogRecord *rec, ShardLogType type, const char *uuid, LLUINT a, LLUINT b)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->magic = SHARD_LOG_MAGIC;
+    rec->type = (uint8_t)type;
+    if (uuid != NULL) {
+        snprintf(rec->uuid, sizeof(rec->uuid), "%s", uuid);
+    }
+    memcpy(rec->data, &a, sizeof(LLUINT));
+    memcpy(rec->data + sizeof(LLUINT), &b, sizeof(LLUINT));
+    xor_encrypt_decrypt(rec->data, sizeof(rec->data));
+    rec->checksum = log_checksum(rec);
+}
+
+static bool log_valid(const ShardLogRecord *rec)
+{
+    return rec->magic == SHARD_LOG_MAGIC
+        && rec->type >= SHARD_LOG_PUT && rec->type <= SHARD_LOG_BATCH
+        && memchr(rec->uuid, '\0', sizeof(rec->uuid)) != NULL
+        && rec->checksum == log_checksum(rec);
+}
+
+static void log_decode(const ShardLogRecord *rec, LLUINT *a, LLUINT *b)
+{
+    unsigned char buffer[sizeof(rec->data)];
+    memcpy(buffer, rec->data, sizeof(buffer));
+    xor_encrypt_decrypt(buffer, sizeof(buffer));
+    memcpy(a, buffer, sizeof(LLUINT));
+    memcpy(b, buffer + sizeof(LLUINT), sizeof(LLUINT));
+}
+
+/**
+ * @brief 以一次写入追加 count 条记录和结尾的 BATCH 记录
+ * @param recs 至少有 count+1 个元素，第 count 个由本函数填写
+ */
+static bool log_write_batch(FILE *file, ShardLogRecord *recs, size_t count)
+{
+    log_encode(&recs[count], SHARD_LOG_BATCH, NULL, (LLUINT)count, 0);
+    return fwrite(recs, sizeof(*recs), count + 1, file) == count + 1 && fflush(file) == 0;
+}
+
+/**
+ * @brief 追加一批记录到分片日志；失败后日志停用，之后需要落盘的操作全部失败
+ * @note 失败时文件末尾可能留下不完整的批次，恢复时会被丢弃
+ */
+static bool shard_log_append(Shard *shard, ShardLogRecord *recs, size_t count)
+{
+    if (shard->log == NULL) {
+        return false;
+    }
+    if (!log_write_batch(shard->log, recs, count)) {
+        fprintf(stderr, "错误：分片 %zu 日志写入失败，该分片停止接受修改\n", shard->index);
+        fclose(shard->log);
+        shard->log = NULL;
+        return false;
+    }
+    shard->log_records += count + 1;
+    return true;
+}
+
+/**
+ * @brief 在本批记录中加入一条事务记录
+ */
+static void shard_log_txn(Shard *shard, ShardLogType type, const char *uuid, LLUINT amount, uint64_t txn)
+{
+    log_encode(&shard->log_buf[shard->log_count++], type, uuid, amount, (LLUINT)txn);
+}
+
+/* ==================== 分片内部（仅分片线程调用） ==================== */
+
+/**
+ * @brief 在分片表中查找账户，未命中时从文件读入
+ */
+static ACCOUNT* shard_lookup(Shard *shard, const char *uuid)
+{
+    ACCOUNT *acc = account_table_find(&shard->table, uuid);
+    if (acc != NULL) {
+        return acc;
+    }
+
+    ACCOUNT loaded;
+    if (!account_read_file(uuid, &loaded) || !account_table_insert(&shard->table, &loaded)) {
+        return NULL;
+    }
+    return account_table_find(&shard->table, uuid);
+}
+
+/**
+ * @brief 账户上尚未提交的转出预留总额
+ */
+static LLUINT shard_held_amount(const Shard *shard, const char *uuid)
+{
+    LLUINT held = 0;
+    for (size_t i = 0; i < shard->hold_count; i++) {
+        if (strcmp(shard->holds[i].uuid, uuid) == 0) {
+            held += shard->holds[i].amount;
+        }
+    }
+    return held;
+}
+
+/**
+ * @brief 已提交的账户内容：挂起的预留按未扣减计入，日志与账户文件都只写这个值
+ */
+static ACCOUNT shard_committed(const Shard *shard, const ACCOUNT *acc)
+{
+    ACCOUNT committed = *acc;
+    committed.BALANCE += shard_held_amount(shard, acc->UUID);
+    return committed;
+}
+
+/**
+ * @brief 删除账户文件，文件不存在时视为成功
+ */
+static bool shard_remove_card(const char *uuid)
+{
+    char filename[50];
+    snprintf(filename, sizeof(filename), "Card/%s.card", uuid);
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        return true;
+    }
+    fclose(file);
+    return account_remove_file(uuid);
+}
+
+/**
+ * @brief 按表中内容写出或删除账户文件（不在表中表示已销户）
+ */
+static bool shard_sync_card(Shard *shard, const char *uuid)
+{
+    ACCOUNT *acc = account_table_find(&shard->table, uuid);
+    if (acc == NULL) {
+        return shard_remove_card(uuid);
+    }
+    ACCOUNT committed = shard_committed(shard, acc);
+    return account_write_file(&committed);
+}
+
+static void shard_mark_dirty(Shard *shard, const char *uuid)
+{
+    memcpy(shard->dirty[shard->dirty_count++], uuid, 37);
+}
+
+static int cmp_dirty_uuid(const void *a, const void *b)
+{
+    return strcmp((const char *)a, (const char *)b);
+}
+
+/**
+ * @brief 本批修改过的账户排序去重
+ */
+static void shard_dedup_dirty(Shard *shard)
+{
+    qsort(shard->dirty, shard->dirty_count, sizeof(shard->dirty[0]), cmp_dirty_uuid);
+    size_t kept = 0;
+    for (size_t i = 0; i < shard->dirty_count; i++) {
+        if (kept == 0 || strcmp(shard->dirty[i], shard->dirty[kept - 1]) != 0) {
+            memmove(shard->dirty[kept++], shard->dirty[i], 37);
+        }
+    }
+    shard->dirty_count = kept;
+}
+
+/**
+ * @brief 在本批记录中加入修改过的账户的写后映像
+ * @param deleted 不在表中的账户是否记为销户（本批内销户的账户已单独记录过）
+ */
+static void shard_log_images(Shard *shard, bool deleted)
+{
+    for (size_t i = 0; i < shard->dirty_count; i++) {
+        ACCOUNT *acc = account_table_find(&shard->table, shard->dirty[i]);
+        if (acc != NULL) {
+            ACCOUNT committed = shard_committed(shard, acc);
+            ShardLogRecord *rec = &shard->log_buf[shard->log_count++];
+            log_encode(rec, SHARD_LOG_PUT, committed.UUID, committed.PASSWORD, committed.BALANCE);
+        } else if (deleted) {
+            log_encode(&shard->log_buf[shard->log_count++], SHARD_LOG_DELETE, shard->dirty[i], 0, 0);
+        }
+    }
+}
+
+/**
+ * @brief 本批落盘：先追加日志，再写账户文件
+ * @param logged 输出日志是否已追加（此时部分账户文件可能已写入）
+ */
+static bool shard_flush_batch(Shard *shard, bool *logged)
+{
+    *logged = false;
+    shard_dedup_dirty(shard);
+    shard_log_images(shard, false);
+    if (shard->log_count == 0) {
+        return true;
+    }
+    if (!shard_log_append(shard, shard->log_buf, shard->log_count)) {
+        return false;
+    }
+    *logged = true;
+
+    bool ok = true;
+    for (size_t i = 0; i < shard->dirty_count; i++) {
+        ACCOUNT *acc = account_table_find(&shard->table, shard->dirty[i]);
+        if (acc != NULL) {
+            ACCOUNT committed = shard_committed(shard, acc);
+            if (!account_write_file(&committed)) {
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+static bool shard_add_hold(Shard *shard, const char *uuid, LLUINT amount, uint64_t txn)
+{
+    if (shard->hold_count == shard->hold_capacity) {
+        size_t new_capacity = shard->hold_capacity ? shard->hold_capacity * 2 : 16;
+        ShardHold *grown = realloc(shard->holds, new_capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return false;
+        }
+        shard->holds = grown;
+        shard->hold_capacity = new_capacity;
+    }
+    ShardHold *h = &shard->holds[shard->hold_count++];
+    memcpy(h->uuid, uuid, 37);
+    h->amount = amount;
+    h->txn = txn;
+    return true;
+}
+
+/**
+ * @brief 取出并删除事务对应的预留
+ */
+static bool shard_take_hold(Shard *shard, uint64_t txn, ShardHold *out)
+{
+    for (size_t i = 0; i < shard->hold_count; i++) {
+        if (shard->holds[i].txn == txn) {
+            *out = shard->holds[i];
+            shard->holds[i] = shard->holds[--shard->hold_count];
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool shard_add_credited(Shard *shard, uint64_t txn)
+{
+    if (shard->credited_count == shard->credited_capacity) {
+        size_t new_capacity = shard->credited_capacity ? shard->credited_capacity * 2 : 16;
+        uint64_t *grown = realloc(shard->credited, new_capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return false;
+        }
+        shard->credited = grown;
+        shard->credited_capacity = new_capacity;
+    }
+    shard->credited[shard->credited_count++] = txn;
+    return true;
+}
+
+static void shard_drop_credited(Shard *shard, uint64_t txn)
+{
+    for (size_t i = 0; i < shard->credited_count; i++) {
+        if (shard->credited[i] == txn) {
+            shard->credited[i] = shard->credited[--shard->credited_count];
+            return;
+        }
+    }
+}
+
+static void shard_add_stale(Shard *shard, const char *uuid)
+{
+    if (shard->stale_count == shard->stale_capacity) {
+        size_t new_capacity = shard->stale_capacity ? shard->stale_capacity * 2 : 16;
+        char (*grown)[37] = realloc(shard->stale, new_capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return;  /* 日志中已有正确内容，重启回放时修复 */
+        }
+        shard->stale = grown;
+        shard->stale_capacity = new_capacity;
+    }
+    memcpy(shard->stale[shard->stale_count++], uuid, 37);
+}
+
+/**
+ * @brief 重写回滚后未能写回的账户文件
+ * @return 全部写回返回true
+ */
+static bool shard_retry_stale(Shard *shard)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < shard->stale_count; i++) {
+        if (!shard_sync_card(shard, shard->stale[i])) {
+            memmove(shard->stale[kept++], shard->stale[i], 37);
+        }
+    }
+    shard->stale_count = kept;
+    return kept == 0;
+}
+
+/**
+ * @brief 执行单个操作；返回值表示结果是否依赖本批落盘
+ */
+static bool shard_apply(Shard *shard, const ShardOp *op, EngineResult *r, ShardUndo *u)
+{
+    memset(r, 0, sizeof(*r));
+    r->status = ACCOUNT_OK;
+
+    switch (op->type) {
+    case SHARD_OP_DEPOSIT: {
+        r->type = ENGINE_OP_DEPOSIT;
+        ACCOUNT *acc = shard_lookup(shard, op->uuid);
+        if (acc == NULL) {
+            r->status = ACCOUNT_ERR_NOT_FOUND;
+        } else if (acc->BALANCE > (LLUINT)(ULLONG_MAX - op->amount)) {
+            r->status = ACCOUNT_ERR_OVERFLOW;
+        } else if (op->txn != 0 && !shard_add_credited(shard, op->txn)) {
+            r->status = ACCOUNT_ERR_IO;
+        } else {
+            acc->BALANCE += op->amount;
+            r->account = *acc;
+            shard_mark_dirty(shard, op->uuid);
+            if (op->txn != 0) {
+                shard_log_txn(shard, SHARD_LOG_CREDIT, op->uuid, op->amount, op->txn);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    case SHARD_OP_WITHDRAW:
+    case SHARD_OP_RESERVE: {
+        r->type = ENGINE_OP_WITHDRAW;
+        ACCOUNT *acc = shard_lookup(shard, op->uuid);
+        if (acc == NULL) {
+            r->status = ACCOUNT_ERR_NOT_FOUND;
+        } else if (acc->BALANCE < op->amount) {
+            r->status = ACCOUNT_ERR_INSUFFICIENT;
+        } else if (op->type == SHARD_OP_RESERVE &&
+                   !shard_add_hold(shard, op->uuid, op->amount, op->txn)) {
+            r->status = ACCOUNT_ERR_IO;
+        } else {
+            acc->BALANCE -= op->amount;
+            r->account = *acc;
+            if (op->type == SHARD_OP_WITHDRAW) {
+                shard_mark_dirty(shard, op->uuid);
+            } else {
+                /* 预留不改账户文件，只记入日志，供恢复时判断转账是否中断 */
+                shard_log_txn(shard, SHARD_LOG_BEGIN, op->uuid, op->amount, op->txn);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    case SHARD_OP_TRANSFER: {
+        r->type = ENGINE_OP_TRANSFER;
+        ACCOUNT *from = shard_lookup(shard, op->uuid);
+        ACCOUNT *to = shard_lookup(shard, op->uuid_to);
+        if (from == NULL || to == NULL) {
+            r->status = ACCOUNT_ERR_NOT_FOUND;
+            return false;
+        }
+        /* 两次 lookup 可能触发扩容，重新取指针 */
+        from = account_table_find(&shard->table, op->uuid);
+        if (from->BALANCE < op->amount) {
+            r->status = ACCOUNT_ERR_INSUFFICIENT;
+        } else if (to->BALANCE > (LLUINT)(ULLONG_MAX - op->amount)) {
+            r->status = ACCOUNT_ERR_OVERFLOW;
+        } else {
+            from->BALANCE -= op->amount;
+            to->BALANCE += op->amount;
+            r->account = *from;
+            r->account_to = *to;
+            shard_mark_dirty(shard, op->uuid);
+            shard_mark_dirty(shard, op->uuid_to);
+            return true;
+        }
+        return false;
+    }
+
+    case SHARD_OP_COMMIT:
+    case SHARD_OP_ABORT: {
+        r->type = ENGINE_OP_TRANSFER;
+        size_t h = 0;
+        while (h < shard->hold_count && shard->holds[h].txn != op->txn) {
+            h++;
+        }
+        if (h == shard->hold_count) {
+            r->status = ACCOUNT_ERR_INVALID;
+            return false;
+        }
+        ACCOUNT *acc = shard_lookup(shard, shard->holds[h].uuid);
+        if (acc == NULL) {
+            r->status = ACCOUNT_ERR_NOT_FOUND;  /* 有预留时不允许销户，不应出现 */
+            return false;
+        }
+        shard_take_hold(shard, op->txn, &u->hold);
+        if (op->type == SHARD_OP_ABORT) {
+            acc->BALANCE += u->hold.amount;
+        }
+        r->account = *acc;
+        shard_mark_dirty(shard, u->hold.uuid);
+        shard_log_txn(shard, SHARD_LOG_END, u->hold.uuid, u->hold.amount, op->txn);
+        return true;
+    }
+
+    case SHARD_OP_FORGET:
+        shard_drop_credited(shard, op->txn);
+        return false;
+
+    case SHARD_OP_DELETE: {
+        r->type = ENGINE_OP_DELETE;
+        ACCOUNT *acc = shard_lookup(shard, op->uuid);
+        ShardLogRecord recs[2];
+        if (acc == NULL) {
+            r->status = ACCOUNT_ERR_NOT_FOUND;
+            return false;
+        }
+        if (acc->BALANCE > 0 || shard_held_amount(shard, op->uuid) > 0) {
+            r->status = ACCOUNT_ERR_HAS_BALANCE;
+            return false;
+        }
+        log_encode(&recs[0], SHARD_LOG_DELETE, op->uuid, 0, 0);
+        if (!shard_log_append(shard, recs, 1)) {
+            r->status = ACCOUNT_ERR_IO;
+        } else if (!account_remove_file(op->uuid)) {
+            /* 日志中的销户要撤销，否则重启回放会删掉仍存在的账户 */
+            log_encode(&recs[0], SHARD_LOG_PUT, acc->UUID, acc->PASSWORD, acc->BALANCE);
+            shard_log_append(shard, recs, 1);
+            r->status = ACCOUNT_ERR_IO;
+        } else {
+            account_table_delete(&shard->table, op->uuid);
+        }
+        return false;
+    }
+
+    case SHARD_OP_GET: {
+        ACCOUNT *acc = shard_lookup(shard, op->uuid);
+        if (acc == NULL) {
+            r->status = ACCOUNT_ERR_NOT_FOUND;
+        } else {
+            r->account = *acc;
+        }
+        return false;
+    }
+
+    case SHARD_OP_PUT: {
+        ACCOUNT *old = account_table_find(&shard->table, op->account.UUID);
+        u->existed = (old != NULL);
+        if (old != NULL) {
+            u->before = *old;
+        }
+        if (!account_table_insert(&shard->table, &op->account)) {
+            r->status = ACCOUNT_ERR_IO;
+            return false;
+        }
+        r->account = op->account;
+        shard_mark_dirty(shard, op->account.UUID);
+        return true;
+    }
+
+    case SHARD_OP_REMOVE: {
+        ShardLogRecord recs[2];
+        log_encode(&recs[0], SHARD_LOG_DELETE, op->uuid, 0, 0);
+        if (!shard_log_append(shard, recs, 1) || !account_remove_file(op->uuid)) {
+            r->status = ACCOUNT_ERR_IO;
+        }
+        account_table_delete(&shard->table, op->uuid);
+        return false;
+    }
+
+    default:
+        r->status = ACCOUNT_ERR_INVALID;
+        return false;
+    }
+}
+
+/**
+ * @brief 撤销一个已在内存中生效的操作，需要时在本批记录中加入抵消的事务记录
+ * @note 账户已不在表中（本批内被销户或移除）时不恢复
+ */
+static void shard_undo(Shard *shard, const ShardOp *op, const ShardUndo *u)
+{
+    ACCOUNT *acc;
+
+    switch (op->type) {
+    case SHARD_OP_DEPOSIT:
+        if ((acc = account_table_find(&shard->table, op->uuid)) != NULL) {
+            acc->BALANCE -= op->amount;
+        }
+        if (op->txn != 0) {
+            shard_drop_credited(shard, op->txn);
+            shard_log_txn(shard, SHARD_LOG_UNCREDIT, op->uuid, op->amount, op->txn);
+        }
+        break;
+
+    case SHARD_OP_WITHDRAW:
+        if ((acc = account_table_find(&shard->table, op->uuid)) != NULL) {
+            acc->BALANCE += op->amount;
+        }
+        break;
+
+    case SHARD_OP_RESERVE: {
+        ShardHold hold;
+        if (shard_take_hold(shard, op->txn, &hold) &&
+            (acc = account_table_find(&shard->table, hold.uuid)) != NULL) {
+            acc->BALANCE += hold.amount;
+        }
+        shard_log_txn(shard, SHARD_LOG_END, op->uuid, op->amount, op->txn);
+        break;
+    }
+
+    case SHARD_OP_TRANSFER:
+        if ((acc = account_table_find(&shard->table, op->uuid)) != NULL) {
+            acc->BALANCE += op->amount;
+        }
+        if ((acc = account_table_find(&shard->table, op->uuid_to)) != NULL) {
+            acc->BALANCE -= op->amount;
+        }
+        break;
+
+    case SHARD_OP_COMMIT:
+    case SHARD_OP_ABORT:
+        /* 恢复预留，由发起方重试提交或回滚 */
+        if (op->type == SHARD_OP_ABORT &&
+            (acc = account_table_find(&shard->table, u->hold.uuid)) != NULL) {
+            acc->BALANCE -= u->hold.amount;
+        }
+        if (!shard_add_hold(shard, u->hold.uuid, u->hold.amount, u->hold.txn)) {
+            fprintf(stderr, "错误：分片 %zu 无法恢复转账 %llu 的预留\n",
+                    shard->index, (unsigned long long)u->hold.txn);
+        }
+        shard_log_txn(shard, SHARD_LOG_BEGIN, u->hold.uuid, u->hold.amount, u->hold.txn);
+        break;
+
+    case SHARD_OP_PUT:
+        if (account_table_find(&shard->table, op->account.UUID) == NULL) {
+            break;
+        }
+        if (u->existed) {
+            account_table_insert(&shard->table, &u->before);
+        } else {
+            account_table_delete(&shard->table, op->account.UUID);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief 本批落盘失败：按相反顺序撤销内存中的修改，并把文件恢复到本批之前
+ * @param logged 本批日志是否已追加；已追加时记录抵消的内容，再重写改过的账户文件
+ */
+static void shard_rollback_batch(Shard *shard, size_t n, bool logged)
+{
+    shard->log_count = 0;
+    for (size_t i = n; i-- > 0;) {
+        if (shard->persisted_ok[i] && shard->results[i].status == ACCOUNT_OK) {
+            shard_undo(shard, &shard->batch[i], &shard->undo[i]);
+        }
+    }
+    if (!logged) {
+        return;  /* 日志没有写入则账户文件也没有写过 */
+    }
+
+    shard_log_images(shard, true);
+    if (!shard_log_append(shard, shard->log_buf, shard->log_count)) {
+        fprintf(stderr, "错误：分片 %zu 回滚记录写入失败，重启回放可能恢复已撤销的修改\n",
+                shard->index);
+    }
+    for (size_t i = 0; i < shard->dirty_count; i++) {
+        if (!shard_sync_card(shard, shard->dirty[i])) {
+            shard_add_stale(shard, shard->dirty[i]);
+        }
+    }
+}
+
+/**
+ * @brief 日志超过阈值时截断：账户文件都已写回，只需保留未完成的跨分片转账记录
+ * @note 新日志先写到临时文件再替换，中途失败时旧日志仍然有效
+ */
+static void shard_log_rotate(Shard *shard)
+{
+    if (shard->log == NULL || shard->log_records < SHARD_LOG_ROTATE_RECORDS ||
+        !shard_retry_stale(shard)) {
+        return;
+    }
+
+    char path[64];
+    char tmp[72];
+    shard_log_path(shard->index, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *file = fopen(tmp, "wb");
+    if (file == NULL) {
+        return;
+    }
+
+    /* 未完成的事务分批写入，每批 log_capacity-1 条 */
+    bool ok = true;
+    size_t total = shard->hold_count + shard->credited_count;
+    size_t written = 0;
+    while (ok && written < total) {
+        size_t count = 0;
+        while (count + 1 < shard->log_capacity && written < total) {
+            if (written < shard->hold_count) {
+                const ShardHold *h = &shard->holds[written];
+                log_encode(&shard->log_buf[count++], SHARD_LOG_BEGIN, h->uuid, h->amount, (LLUINT)h->txn);
+            } else {
+                uint64_t txn = shard->credited[written - shard->hold_count];
+                log_encode(&shard->log_buf[count++], SHARD_LOG_CREDIT, NULL, 0, (LLUINT)txn);
+            }
+            written++;
+        }
+        ok = log_write_batch(file, shard->log_buf, count);
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        remove(tmp);
+        return;
+    }
+
+    fclose(shard->log);
+#ifdef _WIN32
+    remove(path);
+#endif
+    if (rename(tmp, path) == 0) {
+        shard->log_records = written;
+    } else {
+        remove(tmp);
+    }
+    shard->log = fopen(path, "ab");
+    if (shard->log == NULL) {
+        perror("错误：无法重新打开分片日志");
+    }
+}
+
+/**
+ * @brief 分片线程主循环：取一批 -> 执行 -> 落盘（失败则撤销） -> 通知完成
+ */
+static void shard_worker_main(void *arg)
+{
+    Shard *shard = (Shard *)arg;
+
+    for (;;) {
+        size_t n = 0;
+        while (n < g_shards.max_batch && mpsc_ring_pop(&shard->ring, &shard->batch[n])) {
+            n++;
+        }
+
+        if (n == 0) {
+            if (atomic_load(&g_shards.stopping)) {
+                break;  /* 已排空 */
+            }
+            mpsc_ring_wait(&shard->ring, SHARD_IDLE_WAIT_MS, &g_shards.stopping);
+            continue;
+        }
+
+        shard->log_count = 0;
+        for (size_t i = 0; i < n; i++) {
+            shard->persisted_ok[i] = shard_apply(shard, &shard->batch[i], &shard->results[i],
+                                                 &shard->undo[i]);
+        }
+        bool logged;
+        bool flushed = shard_flush_batch(shard, &logged);
+        if (flushed) {
+            shard_log_rotate(shard);
+        } else {
+            shard_rollback_batch(shard, n, logged);
+        }
+        shard->dirty_count = 0;
+
+        /* 先更新统计再通知完成 */
+        atomic_fetch_add(&shard->applied, n);
+        atomic_fetch_add(&shard->batches, 1);
+        atomic_store(&shard->accounts, shard->table.count);
+
+        for (size_t i = 0; i < n; i++) {
+            if (!flushed && shard->persisted_ok[i] && shard->results[i].status == ACCOUNT_OK) {
+                shard->results[i].status = ACCOUNT_ERR_IO;
+            }
+            EngineFuture *f = shard->batch[i].future;
+            if (f == NULL) {
+                continue;
+            }
+            platform_mutex_lock(&f->lock);
+            f->result = shard->results[i];
+            atomic_store_explicit(&f->done, 1, memory_order_release);
+            platform_cond_broadcast(&f->cond);
+            platform_mutex_unlock(&f->lock);
+        }
+    }
+}
+
+/* ==================== 恢复 ==================== */
+
+/** @brief 恢复时收集的跨分片转账状态 */
+typedef struct {
+    uint64_t txn;
+    char uuid[37];                /* 源账户 */
+    LLUINT amount;
+    bool open;                    /* 源分片最后一条是 BEGIN */
+    bool credited;                /* 目标分片最后一条是 CREDIT */
+} ShardTxn;
+
+typedef struct {
+    ShardTxn *items;
+    size_t count;
+    size_t capacity;
+} ShardTxnList;
+
+static ShardTxn* txn_find_or_add(ShardTxnList *list, uint64_t txn)
+{
+    for (size_t i = 0; i < list->count; i++) {
+        if (list->items[i].txn == txn) {
+            return &list->items[i];
+        }
+    }
+    if (list->count == list->capacity) {
+        size_t new_capacity = list->capacity ? list->capacity * 2 : 16;
+        ShardTxn *grown = realloc(list->items, new_capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return NULL;
+        }
+        list->items = grown;
+        list->capacity = new_capacity;
+    }
+    ShardTxn *t = &list->items[list->count++];
+    memset(t, 0, sizeof(*t));
+    t->txn = txn;
+    return t;
+}
+
+/**
+ * @brief 应用一个完整批次：写后映像直接写入账户文件，事务记录收集起来最后处理
+ */
+static bool replay_batch(const ShardLogRecord *recs, size_t count, ShardTxnList *txns)
+{
+    for (size_t i = 0; i < count; i++) {
+        const ShardLogRecord *rec = &recs[i];
+        LLUINT a;
+        LLUINT b;
+        log_decode(rec, &a, &b);
+
+        if (rec->type == SHARD_LOG_PUT) {
+            ACCOUNT acc;
+            memset(&acc, 0, sizeof(acc));
+            memcpy(acc.UUID, rec->uuid, sizeof(acc.UUID));
+            acc.PASSWORD = a;
+            acc.BALANCE = b;
+            if (!account_write_file(&acc)) {
+                return false;
+            }
+            continue;
+        }
+        if (rec->type == SHARD_LOG_DELETE) {
+            if (!shard_remove_card(rec->uuid)) {
+                return false;
+            }
+            continue;
+        }
+
+        ShardTxn *t = txn_find_or_add(txns, (uint64_t)b);
+        if (t == NULL) {
+            return false;
+        }
+        switch (rec->type) {
+        case SHARD_LOG_BEGIN:
+            memcpy(t->uuid, rec->uuid, sizeof(t->uuid));
+            t->amount = a;
+            t->open = true;
+            break;
+        case SHARD_LOG_END:
+            t->open = false;
+            break;
+        case SHARD_LOG_CREDIT:
+            t->credited = true;
+            break;
+        case SHARD_LOG_UNCREDIT:
+            t->credited = false;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 回放一个分片日志；末尾不完整的批次（写入中途崩溃）被丢弃
+ */
+static bool replay_log_file(const char *path, ShardTxnList *txns)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return true;
+    }
+
+    ShardLogRecord *group = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    bool ok = true;
+    ShardLogRecord rec;
+    while (ok && fread(&rec, sizeof(rec), 1, file) == 1) {
+        if (!log_valid(&rec)) {
+            fprintf(stderr, "警告：%s 中有不完整的记录，其后记录已忽略\n", path);
+            break;
+        }
+        if (rec.type == SHARD_LOG_BATCH) {
+            LLUINT expected;
+            LLUINT unused;
+            log_decode(&rec, &expected, &unused);
+            if (expected != count) {
+                fprintf(stderr, "警告：%s 中有不完整的批次，其后记录已忽略\n", path);
+                break;
+            }
+            ok = replay_batch(group, count, txns);
+            count = 0;
+            continue;
+        }
+        if (count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 64;
+            ShardLogRecord *grown = realloc(group, new_capacity * sizeof(*grown));
+            if (grown == NULL) {
+                ok = false;
+                break;
+            }
+            group = grown;
+            capacity = new_capacity;
+        }
+        group[count++] = rec;
+    }
+
+    free(group);
+    fclose(file);
+    return ok;
+}
+
+/**
+ * @brief 启动前回放上次运行留下的分片日志，并补完已入账但源分片未提交的转账
+ * @return 成功（或没有日志）返回true，此时日志已删除；失败时保留日志
+ */
+static bool shard_recover(void)
+{
+    ShardTxnList txns;
+    memset(&txns, 0, sizeof(txns));
+    bool found = false;
+    bool ok = true;
+    char path[64];
+
+    for (size_t i = 0; i <= SHARD_LOG_MAX_FILES && ok; i++) {
+        if (i < SHARD_LOG_MAX_FILES) {
+            shard_log_path(i, path, sizeof(path));
+        } else {
+            snprintf(path, sizeof(path), "%s", SHARD_RECOVER_LOG);
+        }
+        FILE *probe = fopen(path, "rb");
+        if (probe == NULL) {
+            continue;
+        }
+        fclose(probe);
+        found = true;
+        ok = replay_log_file(path, &txns);
+    }
+
+    /*
+     * 目标账户已入账：源账户文件中仍是预留前的余额，补记扣款。
+     * 先把扣款后的映像和 END 记入恢复日志再写文件，恢复中途崩溃时不会重复扣款
+     */
+    size_t completed = 0;
+    FILE *recover = NULL;
+    for (size_t i = 0; i < txns.count && ok; i++) {
+        const ShardTxn *t = &txns.items[i];
+        if (!t->open || !t->credited) {
+            continue;
+        }
+        ACCOUNT acc;
+        if (!account_read_file(t->uuid, &acc) || acc.BALANCE < t->amount) {
+            fprintf(stderr, "错误：无法补完转账 %llu（源账户 %s）\n",
+                    (unsigned long long)t->txn, t->uuid);
+            ok = false;
+            break;
+        }
+        acc.BALANCE -= t->amount;
+
+        ShardLogRecord recs[3];
+        log_encode(&recs[0], SHARD_LOG_PUT, acc.UUID, acc.PASSWORD, acc.BALANCE);
+        log_encode(&recs[1], SHARD_LOG_END, acc.UUID, t->amount, (LLUINT)t->txn);
+        if (recover == NULL) {
+            recover = fopen(SHARD_RECOVER_LOG, "ab");
+        }
+        ok = recover != NULL && log_write_batch(recover, recs, 2) && account_write_file(&acc);
+        completed++;
+    }
+    if (recover != NULL) {
+        fclose(recover);
+    }
+    free(txns.items);
+
+    if (!found) {
+        return true;
+    }
+    if (!ok) {
+        fprintf(stderr, "错误：分片日志回放失败，已保留日志文件\n");
+        return false;
+    }
+    if (completed > 0) {
+        printf("已补完 %zu 笔中断的跨分片转账\n", completed);
+    }
+    for (size_t i = 0; i < SHARD_LOG_MAX_FILES; i++) {
+        shard_log_path(i, path, sizeof(path));
+        remove(path);
+    }
+    remove(SHARD_RECOVER_LOG);
+    return true;
+}
+
+/* ==================== 提交 ==================== */
+
+/**
+ * @brief 进入一次对外调用；引擎未运行返回false
+ * @note 停止时会等待所有已进入的调用（包括两阶段转账的全部阶段）结束
+ */
+static bool shard_enter(void)
+{
+    atomic_fetch_add(&g_shards.submitters, 1);
+    if (!atomic_load(&g_shards.running)) {
+        atomic_fetch_sub(&g_shards.submitters, 1);
+        return false;
+    }
+    return true;
+}
+
+static void shard_leave(void)
+{
+    atomic_fetch_sub(&g_shards.submitters, 1);
+}
+
+/**
+ * @brief 提交到分片并等待结果（调用方线程，须在 shard_enter/shard_leave 之间）
+ */
+static void shard_call(size_t index, ShardOp *op, EngineResult *result)
+{
+    Shard *shard = &g_shards.shards[index];
+    EngineFuture future;
+    engine_future_init(&future);
+    op->future = &future;
+
+    int attempts = 0;
+    while (!mpsc_ring_push(&shard->ring, op)) {
+        if (++attempts > SHARD_SUBMIT_SPIN) {
+            platform_sleep_ms(1);
+        }
+    }
+    mpsc_ring_notify(&shard->ring);
+
+    *result = *engine_future_wait(&future);
+    engine_future_destroy(&future);
+}
+
+/**
+ * @brief 提交到分片，不等待结果（调用方线程，须在 shard_enter/shard_leave 之间）
+ */
+static void shard_post(size_t index, ShardOp *op)
+{
+    Shard *shard = &g_shards.shards[index];
+    op->future = NULL;
+
+    int attempts = 0;
+    while (!mpsc_ring_push(&shard->ring, op)) {
+        if (++attempts > SHARD_SUBMIT_SPIN) {
+            platform_sleep_ms(1);
+        }
+    }
+    mpsc_ring_notify(&shard->ring);
+}
+
+static void shard_op_init(ShardOp *op, ShardOpType type, const char *uuid)
+{
+    memset(op, 0, sizeof(*op));
+    op->type = type;
+    if (uuid != NULL) {
+        snprintf(op->uuid, sizeof(op->uuid), "%s", uuid);
+    }
+}
+
+/* ==================== 生命周期 ==================== */
+
+/**
+ * @brief 关闭分片日志；账户文件都已写回且没有未完成的转账时删除日志，否则留给下次启动回放
+ */
+static void shard_log_close(Shard *shard)
+{
+    if (shard->log == NULL) {
+        return;
+    }
+    fclose(shard->log);
+    shard->log = NULL;
+
+    char path[64];
+    shard_log_path(shard->index, path, sizeof(path));
+    if (shard_retry_stale(shard) && shard->hold_count == 0 && shard->credited_count == 0) {
+        remove(path);
+    } else {
+        fprintf(stderr, "警告：分片 %zu 有未写回的修改，已保留 %s，下次启动时回放\n",
+                shard->index, path);
+    }
+}
+
+static void shard_free(Shard *shard)
+{
+    shard_log_close(shard);
+    mpsc_ring_destroy(&shard->ring);
+    account_table_cleanup(&shard->table);
+    free(shard->batch);
+    free(shard->results);
+    free(shard->persisted_ok);
+    free(shard->undo);
+    free(shard->dirty);
+    free(shard->log_buf);
+    free(shard->holds);
+    free(shard->credited);
+    free(shard->stale);
+}
+
+/**
+ * @brief 清空全局 Hash 表缓存，之后由 load_account() 按需从文件重新读入
+ */
+static void reset_global_cache(void)
+{
+    cleanup_account_hash_table();
+    init_account_hash_table();
+}
+
+bool shard_engine_start(const EngineConfig *config)
+{
+    if (atomic_load(&g_shards.running)) {
+        return true;
+    }
+
+    /* 上次运行未正常停止（或有未写回的修改）时先回放日志 */
+    if (!shard_recover()) {
+        return false;
+    }
+
+    size_t count = config->shards ? config->shards : 1;
+    g_shards.max_batch = config->max_batch ? config->max_batch : 1;
+    g_shards.shards = (Shard *)calloc(count, sizeof(Shard));
+    if (g_shards.shards == NULL) {
+        return false;
+    }
+
+    size_t started = 0;
+    bool ok = true;
+    atomic_store(&g_shards.stopping, false);
+    int cpus = platform_cpu_count();
+
+    for (size_t i = 0; i < count && ok; i++) {
+        Shard *shard = &g_shards.shards[i];
+        shard->index = i;
+        shard->batch = (ShardOp *)malloc(g_shards.max_batch * sizeof(ShardOp));
+        shard->results = (EngineResult *)malloc(g_shards.max_batch * sizeof(EngineResult));
+        shard->persisted_ok = (bool *)malloc(g_shards.max_batch * sizeof(bool));
+        shard->undo = (ShardUndo *)malloc(g_shards.max_batch * sizeof(ShardUndo));
+        shard->dirty = malloc(g_shards.max_batch * 2 * sizeof(*shard->dirty));
+        /* 每个操作至多两个账户映像和一条事务记录，另加结尾的 BATCH */
+        shard->log_capacity = g_shards.max_batch * 3 + 1;
+        shard->log_buf = (ShardLogRecord *)malloc(shard->log_capacity * sizeof(ShardLogRecord));
+        char path[64];
+        shard_log_path(i, path, sizeof(path));
+        shard->log = fopen(path, "wb");
+        if (shard->log == NULL) {
+            perror("错误：无法创建分片日志");
+        }
+        if (shard->batch == NULL || shard->results == NULL || shard->persisted_ok == NULL ||
+            shard->undo == NULL || shard->dirty == NULL || shard->log_buf == NULL ||
+            shard->log == NULL || !account_table_init(&shard->table) ||
+            !mpsc_ring_init(&shard->ring, config->queue_capacity, sizeof(ShardOp))) {
+            ok = false;
+            break;
+        }
+        if (!platform_thread_create(&shard->worker, shard_worker_main, shard)) {
+            ok = false;
+            break;
+        }
+        started++;
+        if (config->pin_threads) {
+            platform_thread_pin(shard->worker, (int)(i % (size_t)cpus));
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "错误：分片引擎初始化失败\n");
+        atomic_store(&g_shards.stopping, true);
+        for (size_t i = 0; i < started; i++) {
+            mpsc_ring_wake(&g_shards.shards[i].ring);
+            platform_thread_join(g_shards.shards[i].worker);
+        }
+        for (size_t i = 0; i < count; i++) {
+            shard_free(&g_shards.shards[i]);
+        }
+        free(g_shards.shards);
+        g_shards.shards = NULL;
+        return false;
+    }
+
+    g_shards.count = count;
+    atomic_store(&g_shards.committed, 0);
+    atomic_store(&g_shards.aborted, 0);
+
+    /* 运行期间账户由分片持有，全局缓存中的旧数据不再可信 */
+    reset_global_cache();
+    atomic_store(&g_shards.running, true);
+    return true;
+}
+
+void shard_engine_stop(void)
+{
+    if (!atomic_load(&g_shards.running)) {
+        return;
+    }
+
+    /* 停止接受新调用，并等待进行中的调用完成（分片线程仍在运行） */
+    atomic_store(&g_shards.running, false);
+    while (atomic_load(&g_shards.submitters) > 0) {
+        platform_sleep_ms(0);
+    }
+
+    atomic_store(&g_shards.stopping, true);
+    for (size_t i = 0; i < g_shards.count; i++) {
+        mpsc_ring_wake(&g_shards.shards[i].ring);
+    }
+    for (size_t i = 0; i < g_shards.count; i++) {
+        platform_thread_join(g_shards.shards[i].worker);
+        shard_free(&g_shards.shards[i]);
+    }
+
+    free(g_shards.shards);
+    g_shards.shards = NULL;
+    g_shards.count = 0;
+
+    reset_global_cache();
+}
+
+bool shard_engine_running(void)
+{
+    return atomic_load(&g_shards.running);
+}
+
+size_t shard_engine_count(void)
+{
+    return g_shards.count;
+}
+
+void shard_get_stats(size_t shard, ShardStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (shard >= g_shards.count) {
+        return;
+    }
+    stats->applied = atomic_load(&g_shards.shards[shard].applied);
+    stats->batches = atomic_load(&g_shards.shards[shard].batches);
+    stats->accounts = atomic_load(&g_shards.shards[shard].accounts);
+}
+
+void shard_get_transfer_stats(size_t *committed, size_t *aborted)
+{
+    if (committed != NULL) {
+        *committed = atomic_load(&g_shards.committed);
+    }
+    if (aborted != NULL) {
+        *aborted = atomic_load(&g_shards.aborted);
+    }
+}
+
+/* ==================== 账户操作 ==================== */
+
+static AccountStatus shard_single(ShardOpType type, const char *uuid, LLUINT amount, ACCOUNT *out)
+{
+    if (uuid == NULL || ((type == SHARD_OP_DEPOSIT || type == SHARD_OP_WITHDRAW) && amount == 0)) {
+        return ACCOUNT_ERR_INVALID;
+    }
+
+    if (!shard_enter()) {
+        return ACCOUNT_ERR_BUSY;
+    }
+
+    ShardOp op;
+    EngineResult r;
+    shard_op_init(&op, type, uuid);
+    op.amount = amount;
+    shard_call(shard_index_of(uuid), &op, &r);
+    shard_leave();
+
+    if (r.status == ACCOUNT_OK && out != NULL) {
+        *out = r.account;
+    }
+    return r.status;
+}
+
+AccountStatus shard_deposit(const char *uuid, LLUINT amount, ACCOUNT *out)
+{
+    return shard_single(SHARD_OP_DEPOSIT, uuid, amount, out);
+}
+
+AccountStatus shard_withdraw(const char *uuid, LLUINT amount, ACCOUNT *out)
+{
+    return shard_single(SHARD_OP_WITHDRAW, uuid, amount, out);
+}
+
+AccountStatus shard_delete(const char *uuid)
+{
+    return shard_single(SHARD_OP_DELETE, uuid, 0, NULL);
+}
+
+AccountStatus shard_transfer(const char *uuid_from, const char *uuid_to, LLUINT amount,
+                             ACCOUNT *out_from, ACCOUNT *out_to)
+{
+    if (uuid_from == NULL || uuid_to == NULL || amount == 0) {
+        return ACCOUNT_ERR_INVALID;
+    }
+    if (strcmp(uuid_from, uuid_to) == 0) {
+        return ACCOUNT_ERR_SAME_ACCOUNT;
+    }
+
+    if (!shard_enter()) {
+        return ACCOUNT_ERR_BUSY;
+    }
+
+    size_t src = shard_index_of(uuid_from);
+    size_t dst = shard_index_of(uuid_to);
+    ShardOp op;
+    EngineResult r;
+
+    /* 同一分片：一次完成 */
+    if (src == dst) {
+        shard_op_init(&op, SHARD_OP_TRANSFER, uuid_from);
+        snprintf(op.uuid_to, sizeof(op.uuid_to), "%s", uuid_to);
+        op.amount = amount;
+        shard_call(src, &op, &r);
+        shard_leave();
+        if (r.status == ACCOUNT_OK) {
+            if (out_from != NULL) {
+                *out_from = r.account;
+            }
+            if (out_to != NULL) {
+                *out_to = r.account_to;
+            }
+        }
+        return r.status;
+    }
+
+    /* 第一阶段：源分片预留 */
+    uint64_t txn = atomic_fetch_add(&g_shards.next_txn, 1) + 1;
+    shard_op_init(&op, SHARD_OP_RESERVE, uuid_from);
+    op.amount = amount;
+    op.txn = txn;
+    shard_call(src, &op, &r);
+    if (r.status != ACCOUNT_OK) {
+        shard_leave();
+        return r.status;
+    }
+
+    /* 第二阶段：目标分片入账（带事务号，日志中记下 CREDIT） */
+    EngineResult credit;
+    shard_op_init(&op, SHARD_OP_DEPOSIT, uuid_to);
+    op.amount = amount;
+    op.txn = txn;
+    shard_call(dst, &op, &credit);
+
+    /*
+     * 第三阶段：源分片提交或回滚。预留期间不允许销户，只会因落盘失败而失败，
+     * 此时源分片已撤销本批并恢复预留，重试即可
+     */
+    bool commit = (credit.status == ACCOUNT_OK);
+    EngineResult finish;
+    for (int attempt = 0; attempt < SHARD_FINISH_RETRIES; attempt++) {
+        shard_op_init(&op, commit ? SHARD_OP_COMMIT : SHARD_OP_ABORT, uuid_from);
+        op.txn = txn;
+        shard_call(src, &op, &finish);
+        if (finish.status != ACCOUNT_ERR_IO) {
+            break;
+        }
+        platform_sleep_ms(1);
+    }
+
+    if (!commit) {
+        shard_leave();
+        atomic_fetch_add(&g_shards.aborted, 1);
+        return credit.status;
+    }
+
+    atomic_fetch_add(&g_shards.committed, 1);
+    if (finish.status == ACCOUNT_OK) {
+        /* 源分片已记下 END，目标分片不必再保留 CREDIT */
+        shard_op_init(&op, SHARD_OP_FORGET, uuid_to);
+        op.txn = txn;
+        shard_post(dst, &op);
+    } else {
+        /* 入账已落盘，转账不能再撤销：预留留在源分片，下次启动时按日志补记扣款 */
+        fprintf(stderr, "错误：转账 %llu 源账户提交落盘失败，将在下次启动时补完\n",
+                (unsigned long long)txn);
+        finish.account = r.account;
+    }
+    shard_leave();
+
+    if (out_from != NULL) {
+        *out_from = finish.account;
+    }
+    if (out_to != NULL) {
+        *out_to = credit.account;
+    }
+    return ACCOUNT_OK;
+}
+
+/* ==================== 通用存取 ==================== */
+
+bool shard_get_account(const char *uuid, ACCOUNT *out)
+{
+    if (!shard_enter()) {
+        return false;
+    }
+
+    ShardOp op;
+    EngineResult r;
+    shard_op_init(&op, SHARD_OP_GET, uuid);
+    shard_call(shard_index_of(uuid), &op, &r);
+    shard_leave();
+
+    if (r.status != ACCOUNT_OK) {
+        return false;
+    }
+    *out = r.account;
+    return true;
+}
+
+bool shard_put_account(const ACCOUNT *acc)
+{
+    if (!shard_enter()) {
+        return false;
+    }
+
+    ShardOp op;
+    EngineResult r;
+    shard_op_init(&op, SHARD_OP_PUT, acc->UUID);
+    op.account = *acc;
+    shard_call(shard_index_of(acc->UUID), &op, &r);
+    shard_leave();
+    return r.status == ACCOUNT_OK;
+}
+
+bool shard_remove_account(const char *uuid)
+{
+    if (!shard_enter()) {
+        return false;
+    }
+
+    ShardOp op;
+    EngineResult r;
+    shard_op_init(&op, SHARD_OP_REMOVE, uuid);
+    shard_call(shard_index_of(uuid), &op, &r);
+    shard_leave();
+    return r.status == ACCOUNT_OK;
+}
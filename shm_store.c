@@ -0,0 +1,668 @@
+/**
+ * @file shm_store.c
+ * @brief 多进程共享内存账户存储实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/shm_store.h>
+#include <lib/engine.h>
+#include <lib/platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+ #include <errno.h>
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <stdatomic.h>
+ #include <stdint.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+/* ==================== 常量配置 ==================== */
+
+#define SHM_STORE_DEFAULT_CAPACITY 65536
+#define SHM_STORE_MAX_CAPACITY (16u * 1024 * 1024)
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取共享存储配置
+ */
+bool load_shm_config(const char *path, ShmStoreConfig *config)
+{
+    config->enabled = false;
+    config->capacity = SHM_STORE_DEFAULT_CAPACITY;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(current_section, sizeof(current_section), "%s", p + 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "shm") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "enabled") == 0) {
+            config->enabled = (strcmp(v, "true") == 0);
+        } else if (strcmp(k, "capacity") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0 && (unsigned long)n <= SHM_STORE_MAX_CAPACITY) {
+                config->capacity = (size_t)n;
+            }
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+#ifdef _WIN32
+
+/* ==================== Windows：不支持 ==================== */
+
+bool init_shm_store(void)
+{
+    ShmStoreConfig config;
+    load_shm_config(ENGINE_CONFIG_FILE, &config);
+    if (config.enabled) {
+        fprintf(stderr, "警告：当前平台不支持共享内存账户存储，已忽略 [shm] enabled=true\n");
+    }
+    return true;
+}
+
+bool shm_store_attach(const ShmStoreConfig *config, const char *name)
+{
+    (void)config;
+    (void)name;
+    return false;
+}
+
+void shm_store_detach(void) {}
+bool shm_store_active(void) { return false; }
+
+void shm_store_get_stats(ShmStoreStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+void shm_store_lock(const char *uuid_a, const char *uuid_b)
+{
+    (void)uuid_a;
+    (void)uuid_b;
+}
+
+void shm_store_unlock(const char *uuid_a, const char *uuid_b)
+{
+    (void)uuid_a;
+    (void)uuid_b;
+}
+
+bool shm_store_get(const char *uuid, ACCOUNT *out)
+{
+    (void)uuid;
+    (void)out;
+    return false;
+}
+
+bool shm_store_put(const ACCOUNT *acc)
+{
+    (void)acc;
+    return false;
+}
+
+bool shm_store_remove(const char *uuid)
+{
+    (void)uuid;
+    return false;
+}
+
+#else
+
+/* ==================== 共享段布局 ==================== */
+
+#define SHM_STORE_MAGIC 0x4D485342u      /* "BSHM" */
+#define SHM_STORE_VERSION 1
+#define SHM_STORE_ATTACH_WAIT_MS 5000
+
+enum {
+    SLOT_EMPTY = 0,
+    SLOT_USED = 1,
+    SLOT_TOMBSTONE = 2
+};
+
+/**
+ * @brief 账户槽位（64字节）
+ * @note state 以 release 发布；uuid 在 USED 期间不变，余额与密码只在持有条带锁时读写
+ */
+typedef struct {
+    atomic_uint state;
+    char uuid[37];
+    LLUINT password;
+    LLUINT balance;
+} ShmSlot;
+
+/**
+ * @brief 段头，槽位数组紧随其后（按64字节对齐）
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    atomic_uint ready;            /* 创建者载入完成后置1 */
+    uint32_t unlinked;            /* 已被最后一个进程删除（受 table_lock 保护） */
+    int32_t attached;             /* 挂接进程数（受 table_lock 保护） */
+    atomic_size_t count;
+    atomic_size_t recoveries;
+    pthread_mutex_t table_lock;   /* 槽位分配与回收 */
+    pthread_mutex_t stripes[SHM_STORE_STRIPES];
+} ShmHeader;
+
+#define SHM_SLOTS_OFFSET ((sizeof(ShmHeader) + 63) & ~(size_t)63)
+
+static struct {
+    ShmHeader *hdr;
+    ShmSlot *slots;
+    size_t map_size;
+    char name[64];
+    bool active;
+} g_shm;
+
+/* ==================== 哈希与探测 ==================== */
+
+static uint32_t uuid_hash(const char *uuid)
+{
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)uuid; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static size_t stripe_of(const char *uuid)
+{
+    return (uuid_hash(uuid) >> 8) % SHM_STORE_STRIPES;
+}
+
+/**
+ * @brief 查找账户所在槽位
+ * @return 槽位下标，不存在返回-1
+ */
+static long find_slot(const char *uuid)
+{
+    size_t cap = (size_t)g_shm.hdr->capacity;
+    size_t idx = uuid_hash(uuid) % cap;
+
+    for (size_t n = 0; n < cap; n++) {
+        ShmSlot *slot = &g_shm.slots[idx];
+        unsigned int state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == SLOT_EMPTY) {
+            return -1;
+        }
+        if (state == SLOT_USED && strcmp(slot->uuid, uuid) == 0) {
+            return (long)idx;
+        }
+        idx = (idx + 1) % cap;
+    }
+    return -1;
+}
+
+/**
+ * @brief 分配槽位并写入账户（调用方持有 table_lock）
+ */
+static bool insert_slot(const ACCOUNT *acc)
+{
+    size_t cap = (size_t)g_shm.hdr->capacity;
+    size_t idx = uuid_hash(acc->UUID) % cap;
+
+    for (size_t n = 0; n < cap; n++) {
+        ShmSlot *slot = &g_shm.slots[idx];
+        unsigned int state = atomic_load_explicit(&slot->state, memory_order_relaxed);
+        if (state != SLOT_USED) {
+            memcpy(slot->uuid, acc->UUID, sizeof(slot->uuid));
+            slot->password = acc->PASSWORD;
+            slot->balance = acc->BALANCE;
+            atomic_store_explicit(&slot->state, SLOT_USED, memory_order_release);
+            atomic_fetch_add(&g_shm.hdr->count, 1);
+            return true;
+        }
+        idx = (idx + 1) % cap;
+    }
+    return false;
+}
+
+/* ==================== 健壮锁 ==================== */
+
+static void lock_table(void);
+
+/**
+ * @brief 持锁进程异常退出后，从 .card 文件重建该条带的账户
+ */
+static void resync_stripe(size_t stripe)
+{
+    size_t cap = (size_t)g_shm.hdr->capacity;
+    for (size_t i = 0; i < cap; i++) {
+        ShmSlot *slot = &g_shm.slots[i];
+        if (atomic_load(&slot->state) != SLOT_USED || stripe_of(slot->uuid) != stripe) {
+            continue;
+        }
+        ACCOUNT acc;
+        if (account_read_file(slot->uuid, &acc)) {
+            slot->password = acc.PASSWORD;
+            slot->balance = acc.BALANCE;
+        } else {
+            lock_table();
+            atomic_store(&slot->state, SLOT_TOMBSTONE);
+            atomic_fetch_sub(&g_shm.hdr->count, 1);
+            pthread_mutex_unlock(&g_shm.hdr->table_lock);
+        }
+    }
+}
+
+/**
+ * @brief 重新统计账户数（table_lock 被异常进程持有时计数可能已失准）
+ */
+static void recount_slots(void)
+{
+    size_t cap = (size_t)g_shm.hdr->capacity;
+    size_t count = 0;
+    for (size_t i = 0; i < cap; i++) {
+        if (atomic_load(&g_shm.slots[i].state) == SLOT_USED) {
+            count++;
+        }
+    }
+    atomic_store(&g_shm.hdr->count, count);
+}
+
+static void lock_table(void)
+{
+    int rc = pthread_mutex_lock(&g_shm.hdr->table_lock);
+    if (rc == EOWNERDEAD) {
+        pthread_mutex_consistent(&g_shm.hdr->table_lock);
+        atomic_fetch_add(&g_shm.hdr->recoveries, 1);
+        recount_slots();
+    }
+}
+
+static void lock_stripe(size_t stripe)
+{
+    int rc = pthread_mutex_lock(&g_shm.hdr->stripes[stripe]);
+    if (rc == EOWNERDEAD) {
+        pthread_mutex_consistent(&g_shm.hdr->stripes[stripe]);
+        atomic_fetch_add(&g_shm.hdr->recoveries, 1);
+        resync_stripe(stripe);
+    }
+}
+
+static bool init_shared_mutex(pthread_mutex_t *mutex)
+{
+    pthread_mutexattr_t attr;
+    if (pthread_mutexattr_init(&attr) != 0) {
+        return false;
+    }
+    bool ok = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) == 0
+           && pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST) == 0
+           && pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE) == 0
+           && pthread_mutex_init(mutex, &attr) == 0;
+    pthread_mutexattr_destroy(&attr);
+    return ok;
+}
+
+void shm_store_lock(const char *uuid_a, const char *uuid_b)
+{
+    size_t a = stripe_of(uuid_a);
+    if (uuid_b == NULL) {
+        lock_stripe(a);
+        return;
+    }
+    size_t b = stripe_of(uuid_b);
+    if (a == b) {
+        lock_stripe(a);
+    } else {
+        lock_stripe(a < b ? a : b);
+        lock_stripe(a < b ? b : a);
+    }
+}
+
+void shm_store_unlock(const char *uuid_a, const char *uuid_b)
+{
+    size_t a = stripe_of(uuid_a);
+    pthread_mutex_unlock(&g_shm.hdr->stripes[a]);
+    if (uuid_b != NULL) {
+        size_t b = stripe_of(uuid_b);
+        if (b != a) {
+            pthread_mutex_unlock(&g_shm.hdr->stripes[b]);
+        }
+    }
+}
+
+/* ==================== 挂接 ==================== */
+
+/**
+ * @brief 由当前工作目录派生共享段名称
+ */
+static void default_segment_name(char *name, size_t size)
+{
+    char cwd[1024];
+    if (getcwd(cwd, sizeof(cwd)) == NULL) {
+        snprintf(cwd, sizeof(cwd), ".");
+    }
+    snprintf(name, size, "/bamsystem-%08x", (unsigned int)uuid_hash(cwd));
+}
+
+/**
+ * @brief 创建者：初始化段头与锁，并从 .card 文件载入全部账户
+ */
+static bool initialize_segment(size_t capacity)
+{
+    ShmHeader *hdr = g_shm.hdr;
+    hdr->magic = SHM_STORE_MAGIC;
+    hdr->version = SHM_STORE_VERSION;
+    hdr->capacity = capacity;
+    hdr->unlinked = 0;
+    hdr->attached = 1;
+    atomic_init(&hdr->count, 0);
+    atomic_init(&hdr->recoveries, 0);
+
+    if (!init_shared_mutex(&hdr->table_lock)) {
+        return false;
+    }
+    for (size_t i = 0; i < SHM_STORE_STRIPES; i++) {
+        if (!init_shared_mutex(&hdr->stripes[i])) {
+            return false;
+        }
+    }
+
+    /* ftruncate 已将槽位清零（SLOT_EMPTY） */
+    char (*uuids)[37] = malloc(capacity * sizeof(*uuids));
+    if (uuids == NULL) {
+        return false;
+    }
+    int n = get_all_account_uuids(uuids, (int)capacity);
+    for (int i = 0; i < n; i++) {
+        ACCOUNT acc;
+        if (account_read_file(uuids[i], &acc) && !insert_slot(&acc)) {
+            fprintf(stderr, "警告：共享存储容量 %zu 不足，部分账户未载入\n", capacity);
+            break;
+        }
+    }
+    free(uuids);
+
+    atomic_store(&hdr->ready, 1);
+    return true;
+}
+
+/**
+ * @brief 挂接者：等待创建者完成初始化
+ */
+static bool wait_segment_ready(int fd)
+{
+    struct stat st;
+    for (int waited = 0; ; waited += 10) {
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= SHM_SLOTS_OFFSET) {
+            break;
+        }
+        if (waited >= SHM_STORE_ATTACH_WAIT_MS) {
+            return false;
+        }
+        platform_sleep_ms(10);
+    }
+
+    g_shm.map_size = (size_t)st.st_size;
+    void *base = mmap(NULL, g_shm.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    g_shm.hdr = (ShmHeader *)base;
+    g_shm.slots = (ShmSlot *)((char *)base + SHM_SLOTS_OFFSET);
+
+    for (int waited = 0; !atomic_load(&g_shm.hdr->ready); waited += 10) {
+        if (waited >= SHM_STORE_ATTACH_WAIT_MS) {
+            munmap(base, g_shm.map_size);
+            return false;
+        }
+        platform_sleep_ms(10);
+    }
+
+    if (g_shm.hdr->magic != SHM_STORE_MAGIC || g_shm.hdr->version != SHM_STORE_VERSION ||
+        SHM_SLOTS_OFFSET + g_shm.hdr->capacity * sizeof(ShmSlot) > g_shm.map_size) {
+        fprintf(stderr, "错误：共享段 %s 格式不兼容\n", g_shm.name);
+        munmap(base, g_shm.map_size);
+        return false;
+    }
+    return true;
+}
+
+bool shm_store_attach(const ShmStoreConfig *config, const char *name)
+{
+    if (g_shm.active) {
+        return false;
+    }
+    if (name != NULL) {
+        snprintf(g_shm.name, sizeof(g_shm.name), "%s", name);
+    } else {
+        default_segment_name(g_shm.name, sizeof(g_shm.name));
+    }
+
+    for (int attempt = 0; attempt < 3; attempt++) {
+        int fd = shm_open(g_shm.name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            /* 本进程创建 */
+            g_shm.map_size = SHM_SLOTS_OFFSET + config->capacity * sizeof(ShmSlot);
+            if (ftruncate(fd, (off_t)g_shm.map_size) != 0) {
+                close(fd);
+                shm_unlink(g_shm.name);
+                return false;
+            }
+            void *base = mmap(NULL, g_shm.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (base == MAP_FAILED) {
+                shm_unlink(g_shm.name);
+                return false;
+            }
+            g_shm.hdr = (ShmHeader *)base;
+            g_shm.slots = (ShmSlot *)((char *)base + SHM_SLOTS_OFFSET);
+            if (!initialize_segment(config->capacity)) {
+                munmap(base, g_shm.map_size);
+                shm_unlink(g_shm.name);
+                return false;
+            }
+            g_shm.active = true;
+            return true;
+        }
+        if (errno != EEXIST) {
+            perror("错误：无法创建共享内存段");
+            return false;
+        }
+
+        /* 挂接已有的段 */
+        fd = shm_open(g_shm.name, O_RDWR, 0600);
+        if (fd < 0) {
+            continue;  /* 恰好被最后一个进程删除，重新创建 */
+        }
+        bool ready = wait_segment_ready(fd);
+        close(fd);
+        if (!ready) {
+            fprintf(stderr, "错误：共享段 %s 未能就绪\n", g_shm.name);
+            return false;
+        }
+
+        lock_table();
+        if (g_shm.hdr->unlinked) {
+            pthread_mutex_unlock(&g_shm.hdr->table_lock);
+            munmap(g_shm.hdr, g_shm.map_size);
+            continue;
+        }
+        g_shm.hdr->attached++;
+        pthread_mutex_unlock(&g_shm.hdr->table_lock);
+        g_shm.active = true;
+        return true;
+    }
+    return false;
+}
+
+void shm_store_detach(void)
+{
+    if (!g_shm.active) {
+        return;
+    }
+    g_shm.active = false;
+
+    lock_table();
+    if (--g_shm.hdr->attached <= 0) {
+        g_shm.hdr->unlinked = 1;
+        shm_unlink(g_shm.name);
+    }
+    pthread_mutex_unlock(&g_shm.hdr->table_lock);
+
+    munmap(g_shm.hdr, g_shm.map_size);
+    g_shm.hdr = NULL;
+    g_shm.slots = NULL;
+}
+
+bool init_shm_store(void)
+{
+    ShmStoreConfig config;
+    load_shm_config(ENGINE_CONFIG_FILE, &config);
+    if (!config.enabled) {
+        return true;
+    }
+
+    /* 分片模式下账户由进程内的分片独占 */
+    EngineConfig engine_config;
+    load_engine_config(ENGINE_CONFIG_FILE, &engine_config);
+    if (engine_config.mode == ENGINE_MODE_SHARDED) {
+        fprintf(stderr, "警告：分片模式不支持多进程共享存储，已忽略 [shm] enabled=true\n");
+        return true;
+    }
+
+    if (!shm_store_attach(&config, NULL)) {
+        fprintf(stderr, "警告：共享内存账户存储挂接失败，使用进程内存储\n");
+        return false;
+    }
+
+    ShmStoreStats stats;
+    shm_store_get_stats(&stats);
+    printf("✓ 共享存储: %s（%zu 个账户，%zu 个进程）\n", g_shm.name, stats.count, stats.attached);
+    return true;
+}
+
+bool shm_store_active(void)
+{
+    return g_shm.active;
+}
+
+void shm_store_get_stats(ShmStoreStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!g_shm.active) {
+        return;
+    }
+    stats->capacity = (size_t)g_shm.hdr->capacity;
+    stats->count = atomic_load(&g_shm.hdr->count);
+    stats->recoveries = atomic_load(&g_shm.hdr->recoveries);
+    lock_table();
+    stats->attached = (size_t)g_shm.hdr->attached;
+    pthread_mutex_unlock(&g_shm.hdr->table_lock);
+}
+
+/* ==================== 账户存取 ==================== */
+
+bool shm_store_get(const char *uuid, ACCOUNT *out)
+{
+    bool found = false;
+    shm_store_lock(uuid, NULL);
+    long idx = find_slot(uuid);
+    if (idx >= 0) {
+        ShmSlot *slot = &g_shm.slots[idx];
+        memset(out, 0, sizeof(*out));
+        memcpy(out->UUID, slot->uuid, sizeof(out->UUID));
+        out->PASSWORD = slot->password;
+        out->BALANCE = slot->balance;
+        found = true;
+    }
+    shm_store_unlock(uuid, NULL);
+    return found;
+}
+
+bool shm_store_put(const ACCOUNT *acc)
+{
+    bool ok = true;
+    shm_store_lock(acc->UUID, NULL);
+    long idx = find_slot(acc->UUID);
+    if (idx >= 0) {
+        g_shm.slots[idx].password = acc->PASSWORD;
+        g_shm.slots[idx].balance = acc->BALANCE;
+    } else {
+        lock_table();
+        ok = insert_slot(acc);
+        pthread_mutex_unlock(&g_shm.hdr->table_lock);
+        if (!ok) {
+            fprintf(stderr, "错误：共享存储已满（容量 %zu）\n", (size_t)g_shm.hdr->capacity);
+        }
+    }
+    shm_store_unlock(acc->UUID, NULL);
+    return ok;
+}
+
+bool shm_store_remove(const char *uuid)
+{
+    bool found = false;
+    shm_store_lock(uuid, NULL);
+    long idx = find_slot(uuid);
+    if (idx >= 0) {
+        lock_table();
+        atomic_store(&g_shm.slots[idx].state, SLOT_TOMBSTONE);
+        atomic_fetch_sub(&g_shm.hdr->count, 1);
+        pthread_mutex_unlock(&g_shm.hdr->table_lock);
+        found = true;
+    }
+    shm_store_unlock(uuid, NULL);
+    return found;
+}
+
+#endif /* _WIN32 */
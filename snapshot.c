@@ -0,0 +1,557 @@
+/**
+ * @file snapshot.c
+ * @brief 只读共享内存账户快照导出实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/snapshot.h>
+#include <lib/account.h>
+#include <lib/engine.h>
+#include <lib/platform.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+/* ==================== 常量配置 ==================== */
+
+#define SNAPSHOT_DEFAULT_INTERVAL_MS 1000
+#define SNAPSHOT_DEFAULT_CAPACITY 65536
+#define SNAPSHOT_MAX_CAPACITY (16u * 1024 * 1024)
+
+_Static_assert(sizeof(SnapshotHeader) <= SNAPSHOT_PAGE_SIZE, "SnapshotHeader must fit in one page");
+_Static_assert(sizeof(SnapshotRecord) == 48, "SnapshotRecord must be 48 bytes");
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取快照配置
+ */
+bool load_snapshot_config(const char *path, SnapshotConfig *config)
+{
+    config->enabled = false;
+    config->interval_ms = SNAPSHOT_DEFAULT_INTERVAL_MS;
+    config->capacity = SNAPSHOT_DEFAULT_CAPACITY;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(current_section, sizeof(current_section), "%s", p + 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "snapshot") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "enabled") == 0) {
+            config->enabled = (strcmp(v, "true") == 0);
+        } else if (strcmp(k, "interval_ms") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0) {
+                config->interval_ms = (unsigned int)n;
+            }
+        } else if (strcmp(k, "capacity") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n > 0 && (unsigned long)n <= SNAPSHOT_MAX_CAPACITY) {
+                config->capacity = (size_t)n;
+            }
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+#ifdef _WIN32
+
+/* ==================== Windows：不支持 ==================== */
+
+bool init_snapshot(void)
+{
+    SnapshotConfig config;
+    load_snapshot_config(ENGINE_CONFIG_FILE, &config);
+    if (config.enabled) {
+        fprintf(stderr, "警告：当前平台不支持共享内存快照导出，已忽略 [snapshot] enabled=true\n");
+    }
+    return true;
+}
+
+bool snapshot_start(const SnapshotConfig *config, const char *name)
+{
+    (void)config;
+    (void)name;
+    return false;
+}
+
+void cleanup_snapshot(void) {}
+bool snapshot_active(void) { return false; }
+bool snapshot_publish_now(void) { return false; }
+
+void snapshot_get_stats(SnapshotStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+const char* snapshot_segment_name(void)
+{
+    return "";
+}
+
+bool snapshot_view_open(SnapshotView *view, const char *name)
+{
+    (void)name;
+    memset(view, 0, sizeof(*view));
+    return false;
+}
+
+void snapshot_view_close(SnapshotView *view)
+{
+    (void)view;
+}
+
+uint64_t snapshot_read_begin(const SnapshotView *view)
+{
+    (void)view;
+    return 0;
+}
+
+bool snapshot_read_retry(const SnapshotView *view, uint64_t seq)
+{
+    (void)view;
+    (void)seq;
+    return false;
+}
+
+#else
+
+/* ==================== 发布方状态 ==================== */
+
+static struct {
+    SnapshotConfig config;
+    bool active;
+    bool stopping;
+    PlatformMutex lock;           /* 保护 stopping 与统计 */
+    PlatformCond wake;
+    PlatformMutex publish_lock;   /* 同一时刻只进行一次发布 */
+    PlatformThread thread;
+
+    SnapshotHeader *hdr;
+    SnapshotRecord *records;      /* 共享段中的记录区 */
+    size_t map_size;
+    char name[64];
+
+    ACCOUNT *collect;             /* 收集缓冲 */
+    SnapshotRecord *scratch;      /* 本次待发布的记录 */
+    SnapshotRecord *shadow;       /* 上次发布的副本（与共享段内容一致） */
+    size_t shadow_count;
+
+    SnapshotStats stats;
+} g_snap;
+
+static int cmp_record(const void *a, const void *b)
+{
+    return strcmp(((const SnapshotRecord *)a)->uuid, ((const SnapshotRecord *)b)->uuid);
+}
+
+static uint64_t unix_time_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief 由当前工作目录派生快照段名称
+ */
+static void default_segment_name(char *name, size_t size)
+{
+    char cwd[1024];
+    if (getcwd(cwd, sizeof(cwd)) == NULL) {
+        snprintf(cwd, sizeof(cwd), ".");
+    }
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)cwd; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    snprintf(name, size, "/bamsystem-snapshot-%08x", (unsigned int)h);
+}
+
+/**
+ * @brief 发布一次快照：收集、排序，与上次发布的副本逐页比较，只写有变化的页
+ */
+static bool publish(void)
+{
+    platform_mutex_lock(&g_snap.publish_lock);
+    uint64_t start = platform_monotonic_ns();
+
+    bool truncated = false;
+    size_t n = account_collect_all(g_snap.collect, g_snap.config.capacity, &truncated);
+
+    for (size_t i = 0; i < n; i++) {
+        SnapshotRecord *rec = &g_snap.scratch[i];
+        memset(rec, 0, sizeof(*rec));
+        memcpy(rec->uuid, g_snap.collect[i].UUID, sizeof(g_snap.collect[i].UUID));
+        rec->balance = g_snap.collect[i].BALANCE;
+    }
+    qsort(g_snap.scratch, n, sizeof(SnapshotRecord), cmp_record);
+
+    /* 账户减少时，旧记录所在位置清零 */
+    size_t span = n > g_snap.shadow_count ? n : g_snap.shadow_count;
+    if (span > n) {
+        memset(&g_snap.scratch[n], 0, (span - n) * sizeof(SnapshotRecord));
+    }
+
+    size_t bytes = span * sizeof(SnapshotRecord);
+    size_t pages = (bytes + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE;
+    const unsigned char *src = (const unsigned char *)g_snap.scratch;
+    unsigned char *shadow = (unsigned char *)g_snap.shadow;
+    unsigned char *dst = (unsigned char *)g_snap.records;
+
+    size_t changed = 0;
+    bool header_changed = (n != g_snap.hdr->count) || (truncated != (g_snap.hdr->truncated != 0));
+    uint64_t seq = atomic_load_explicit(&g_snap.hdr->seq, memory_order_relaxed);
+
+    for (size_t p = 0; p < pages; p++) {
+        size_t off = p * SNAPSHOT_PAGE_SIZE;
+        size_t len = bytes - off < SNAPSHOT_PAGE_SIZE ? bytes - off : SNAPSHOT_PAGE_SIZE;
+        if (memcmp(src + off, shadow + off, len) == 0) {
+            continue;
+        }
+        if (changed == 0) {
+            /* 第一处变化：进入写状态（seq 变为奇数） */
+            atomic_store_explicit(&g_snap.hdr->seq, seq + 1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_release);
+        }
+        memcpy(dst + off, src + off, len);
+        memcpy(shadow + off, src + off, len);
+        changed++;
+    }
+
+    bool published = (changed > 0 || header_changed);
+    if (published) {
+        if (changed == 0) {
+            atomic_store_explicit(&g_snap.hdr->seq, seq + 1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_release);
+        }
+        g_snap.hdr->count = n;
+        g_snap.hdr->truncated = truncated ? 1 : 0;
+        g_snap.hdr->generation++;
+        g_snap.hdr->published_unix_ms = unix_time_ms();
+        atomic_store_explicit(&g_snap.hdr->seq, seq + 2, memory_order_release);
+    }
+    g_snap.shadow_count = n;
+
+    uint64_t elapsed_us = (platform_monotonic_ns() - start) / 1000;
+
+    platform_mutex_lock(&g_snap.lock);
+    if (published) {
+        g_snap.stats.publishes++;
+    } else {
+        g_snap.stats.unchanged++;
+    }
+    g_snap.stats.generation = g_snap.hdr->generation;
+    g_snap.stats.pages_written += changed;
+    g_snap.stats.last_pages = changed;
+    g_snap.stats.last_count = n;
+    g_snap.stats.last_publish_us = elapsed_us;
+    g_snap.stats.total_publish_us += elapsed_us;
+    if (elapsed_us > g_snap.stats.max_publish_us) {
+        g_snap.stats.max_publish_us = elapsed_us;
+    }
+    platform_mutex_unlock(&g_snap.lock);
+
+    platform_mutex_unlock(&g_snap.publish_lock);
+    return true;
+}
+
+static void snapshot_thread(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        platform_mutex_lock(&g_snap.lock);
+        if (!g_snap.stopping) {
+            platform_cond_timedwait(&g_snap.wake, &g_snap.lock, g_snap.config.interval_ms);
+        }
+        bool stop = g_snap.stopping;
+        platform_mutex_unlock(&g_snap.lock);
+
+        if (stop) {
+            break;
+        }
+        publish();
+    }
+}
+
+/* ==================== 生命周期 ==================== */
+
+static void release_buffers(void)
+{
+    free(g_snap.collect);
+    free(g_snap.scratch);
+    free(g_snap.shadow);
+    g_snap.collect = NULL;
+    g_snap.scratch = NULL;
+    g_snap.shadow = NULL;
+}
+
+bool snapshot_start(const SnapshotConfig *config, const char *name)
+{
+    if (g_snap.active) {
+        return false;
+    }
+    g_snap.config = *config;
+    if (name != NULL) {
+        snprintf(g_snap.name, sizeof(g_snap.name), "%s", name);
+    } else {
+        default_segment_name(g_snap.name, sizeof(g_snap.name));
+    }
+
+    size_t cap = config->capacity;
+    g_snap.collect = malloc(cap * sizeof(ACCOUNT));
+    g_snap.scratch = malloc(cap * sizeof(SnapshotRecord));
+    g_snap.shadow = calloc(cap, sizeof(SnapshotRecord));
+    if (g_snap.collect == NULL || g_snap.scratch == NULL || g_snap.shadow == NULL) {
+        release_buffers();
+        return false;
+    }
+    g_snap.shadow_count = 0;
+
+    /* 上次异常退出遗留的段直接替换；仍映射着旧段的读取方不受影响 */
+    shm_unlink(g_snap.name);
+    int fd = shm_open(g_snap.name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        perror("错误：无法创建快照共享内存段");
+        release_buffers();
+        return false;
+    }
+    /* 外部只读工具需要能打开，不受 umask 影响 */
+    fchmod(fd, 0644);
+
+    g_snap.map_size = SNAPSHOT_PAGE_SIZE + cap * sizeof(SnapshotRecord);
+    if (ftruncate(fd, (off_t)g_snap.map_size) != 0) {
+        close(fd);
+        shm_unlink(g_snap.name);
+        release_buffers();
+        return false;
+    }
+    void *base = mmap(NULL, g_snap.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(g_snap.name);
+        release_buffers();
+        return false;
+    }
+
+    g_snap.hdr = (SnapshotHeader *)base;
+    g_snap.records = (SnapshotRecord *)((char *)base + SNAPSHOT_PAGE_SIZE);
+    g_snap.hdr->magic = SNAPSHOT_MAGIC;
+    g_snap.hdr->version = SNAPSHOT_VERSION;
+    g_snap.hdr->header_size = SNAPSHOT_PAGE_SIZE;
+    g_snap.hdr->record_size = sizeof(SnapshotRecord);
+    g_snap.hdr->capacity = cap;
+    atomic_store(&g_snap.hdr->seq, 0);
+
+    memset(&g_snap.stats, 0, sizeof(g_snap.stats));
+    g_snap.stopping = false;
+    platform_mutex_init(&g_snap.lock);
+    platform_mutex_init(&g_snap.publish_lock);
+    platform_cond_init(&g_snap.wake);
+
+    /* 先同步发布一次，读取方挂接后即可看到完整数据 */
+    publish();
+
+    if (!platform_thread_create(&g_snap.thread, snapshot_thread, NULL)) {
+        platform_cond_destroy(&g_snap.wake);
+        platform_mutex_destroy(&g_snap.publish_lock);
+        platform_mutex_destroy(&g_snap.lock);
+        munmap(base, g_snap.map_size);
+        shm_unlink(g_snap.name);
+        release_buffers();
+        return false;
+    }
+    g_snap.active = true;
+    return true;
+}
+
+bool init_snapshot(void)
+{
+    SnapshotConfig config;
+    load_snapshot_config(ENGINE_CONFIG_FILE, &config);
+    if (!config.enabled) {
+        return true;
+    }
+    if (!snapshot_start(&config, NULL)) {
+        fprintf(stderr, "警告：账户快照导出启动失败\n");
+        return false;
+    }
+    printf("✓ 快照导出: %s（每 %u ms，%zu 个账户）\n",
+           g_snap.name, config.interval_ms, g_snap.shadow_count);
+    return true;
+}
+
+void cleanup_snapshot(void)
+{
+    if (!g_snap.active) {
+        return;
+    }
+
+    platform_mutex_lock(&g_snap.lock);
+    g_snap.stopping = true;
+    platform_cond_signal(&g_snap.wake);
+    platform_mutex_unlock(&g_snap.lock);
+    platform_thread_join(g_snap.thread);
+    g_snap.active = false;
+
+    munmap(g_snap.hdr, g_snap.map_size);
+    shm_unlink(g_snap.name);
+    g_snap.hdr = NULL;
+    g_snap.records = NULL;
+
+    platform_cond_destroy(&g_snap.wake);
+    platform_mutex_destroy(&g_snap.publish_lock);
+    platform_mutex_destroy(&g_snap.lock);
+    release_buffers();
+}
+
+bool snapshot_active(void)
+{
+    return g_snap.active;
+}
+
+bool snapshot_publish_now(void)
+{
+    if (!g_snap.active) {
+        return false;
+    }
+    return publish();
+}
+
+void snapshot_get_stats(SnapshotStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!g_snap.active) {
+        return;
+    }
+    platform_mutex_lock(&g_snap.lock);
+    *stats = g_snap.stats;
+    platform_mutex_unlock(&g_snap.lock);
+}
+
+const char* snapshot_segment_name(void)
+{
+    return g_snap.name;
+}
+
+/* ==================== 读取方 ==================== */
+
+bool snapshot_view_open(SnapshotView *view, const char *name)
+{
+    memset(view, 0, sizeof(*view));
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SNAPSHOT_PAGE_SIZE) {
+        close(fd);
+        return false;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    const SnapshotHeader *hdr = (const SnapshotHeader *)base;
+    if (hdr->magic != SNAPSHOT_MAGIC || hdr->version != SNAPSHOT_VERSION ||
+        hdr->record_size != sizeof(SnapshotRecord) ||
+        hdr->header_size + hdr->capacity * hdr->record_size > (uint64_t)st.st_size) {
+        munmap(base, (size_t)st.st_size);
+        return false;
+    }
+
+    view->header = hdr;
+    view->records = (const SnapshotRecord *)((const char *)base + hdr->header_size);
+    view->map_size = (size_t)st.st_size;
+    return true;
+}
+
+void snapshot_view_close(SnapshotView *view)
+{
+    if (view->header != NULL) {
+        munmap((void *)view->header, view->map_size);
+    }
+    memset(view, 0, sizeof(*view));
+}
+
+uint64_t snapshot_read_begin(const SnapshotView *view)
+{
+    _Atomic uint64_t *seq = (_Atomic uint64_t *)&view->header->seq;
+    for (int spins = 0; ; spins++) {
+        uint64_t s = atomic_load_explicit(seq, memory_order_acquire);
+        if ((s & 1) == 0) {
+            return s;
+        }
+        if (spins >= 64) {
+            platform_sleep_ms(1);
+        }
+    }
+}
+
+bool snapshot_read_retry(const SnapshotView *view, uint64_t seq)
+{
+    atomic_thread_fence(memory_order_acquire);
+    _Atomic uint64_t *cur = (_Atomic uint64_t *)&view->header->seq;
+    return atomic_load_explicit(cur, memory_order_relaxed) != seq;
+}
+
+#endif /* _WIN32 */
@@ -0,0 +1,265 @@
+/**
+ * @file startup.c
+ * @brief 后台服务器检测与启动同步实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/startup.h>
+#include <lib/outbox.h>
+#include <lib/platform.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ==================== 内部状态 ==================== */
+
+typedef struct {
+    PlatformMutex lock;
+    PlatformCond cond;            /* 阶段变化或界面交易结束时广播 */
+    StartupStatus status;         /* progress 之外的字段受 lock 保护 */
+    size_t active_ops;            /* 进行中的界面交易数 */
+    bool ops_released;            /* 同步函数已放行界面交易 */
+    bool running;                 /* 后台线程已创建，尚未 join */
+    bool menu_shown;
+    uint64_t started_ns;
+    StartupDetectFunc detect;
+    StartupSyncFunc sync;
+    PlatformThread thread;
+} Startup;
+
+static Startup g_startup;
+static bool g_startup_lock_ready = false;
+
+static uint64_t elapsed_ms(uint64_t since_ns)
+{
+    return (platform_monotonic_ns() - since_ns) / 1000000;
+}
+
+/**
+ * @brief 界面交易是否须等待，调用方持有 lock
+ */
+static bool ops_blocked(void)
+{
+    return g_startup.status.phase == STARTUP_SYNCING && !g_startup.ops_released;
+}
+
+/* ==================== 默认检测与同步 ==================== */
+
+/**
+ * @brief 启动同步队列，先发送上次未发完的交易，再推送并拉取账户
+ *
+ * 同步队列可用时暂停发送并取好推送快照后即放行界面交易：交易在本地执行，
+ * 服务器一侧留在队列中，推送与拉取结束后再发送，拉取跳过这些账户。
+ */
+static void startup_server_sync(StartupStatus *status)
+{
+    init_outbox();
+    OutboxStats os;
+    outbox_get_stats(&os);
+    if (os.pending > 0) {
+        /* 推送的是账户余额，队列中的交易之后再送达会被重复累加 */
+        status->outbox_pending = os.pending;
+        return;
+    }
+
+    account_sync_set_quiet(true);
+    bool queued = outbox_active();
+    if (queued) {
+        outbox_set_paused(true);
+        if (account_sync_begin()) {
+            startup_release_ops();
+        }
+    }
+    status->pushed = sync_all_accounts_to_server();
+    status->pulled = pull_accounts_from_server();
+    if (queued) {
+        outbox_set_paused(false);
+    }
+    account_sync_set_quiet(false);
+}
+
+/* ==================== 后台线程 ==================== */
+
+static void startup_thread(void *arg)
+{
+    (void)arg;
+    uint64_t t0 = platform_monotonic_ns();
+    RunMode mode = g_startup.detect();
+
+    platform_mutex_lock(&g_startup.lock);
+    g_startup.status.detect_ms = elapsed_ms(t0);
+    if (mode != MODE_SERVER) {
+        set_run_mode(MODE_LOCAL);
+        g_startup.status.phase = STARTUP_OFFLINE;
+        platform_cond_broadcast(&g_startup.cond);
+        platform_mutex_unlock(&g_startup.lock);
+        return;
+    }
+
+    /* 等进行中的界面交易结束（它们按本地模式执行，余额由随后的推送带上） */
+    g_startup.status.phase = STARTUP_SYNCING;
+    g_startup.ops_released = false;
+    while (g_startup.active_ops > 0) {
+        platform_cond_wait(&g_startup.cond, &g_startup.lock);
+    }
+    set_run_mode(MODE_SERVER);
+    platform_mutex_unlock(&g_startup.lock);
+
+    StartupStatus result;
+    memset(&result, 0, sizeof(result));
+    t0 = platform_monotonic_ns();
+    if (g_startup.sync != NULL) {
+        g_startup.sync(&result);
+    }
+
+    platform_mutex_lock(&g_startup.lock);
+    g_startup.status.pushed = result.pushed;
+    g_startup.status.pulled = result.pulled;
+    g_startup.status.outbox_pending = result.outbox_pending;
+    g_startup.status.sync_ms = elapsed_ms(t0);
+    g_startup.status.phase = STARTUP_ONLINE;
+    platform_cond_broadcast(&g_startup.cond);
+    platform_mutex_unlock(&g_startup.lock);
+}
+
+/* ==================== 生命周期 ==================== */
+
+bool startup_begin(StartupDetectFunc detect, StartupSyncFunc sync)
+{
+    if (!g_startup_lock_ready) {
+        platform_mutex_init(&g_startup.lock);
+        platform_cond_init(&g_startup.cond);
+        g_startup_lock_ready = true;
+    }
+    if (g_startup.running) {
+        return true;
+    }
+
+    memset(&g_startup.status, 0, sizeof(g_startup.status));
+    g_startup.status.phase = STARTUP_DETECTING;
+    g_startup.active_ops = 0;
+    g_startup.ops_released = false;
+    g_startup.menu_shown = false;
+    g_startup.started_ns = platform_monotonic_ns();
+    g_startup.detect = detect;
+    g_startup.sync = sync;
+
+    if (!platform_thread_create(&g_startup.thread, startup_thread, NULL)) {
+        fprintf(stderr, "错误：无法启动服务器检测线程\n");
+        g_startup.status.phase = STARTUP_IDLE;
+        return false;
+    }
+    g_startup.running = true;
+    return true;
+}
+
+bool init_startup(void)
+{
+    return startup_begin(detect_server_availability, startup_server_sync);
+}
+
+void cleanup_startup(void)
+{
+    if (!g_startup.running) {
+        return;
+    }
+    platform_thread_join(g_startup.thread);
+    g_startup.running = false;
+}
+
+bool startup_in_progress(void)
+{
+    if (!g_startup_lock_ready) {
+        return false;
+    }
+    platform_mutex_lock(&g_startup.lock);
+    StartupPhase phase = g_startup.status.phase;
+    platform_mutex_unlock(&g_startup.lock);
+    return phase == STARTUP_DETECTING || phase == STARTUP_SYNCING;
+}
+
+void startup_get_status(StartupStatus *status)
+{
+    if (!g_startup_lock_ready) {
+        memset(status, 0, sizeof(*status));
+        return;
+    }
+    platform_mutex_lock(&g_startup.lock);
+    *status = g_startup.status;
+    status->ops_blocked = ops_blocked();
+    platform_mutex_unlock(&g_startup.lock);
+    account_sync_get_progress(&status->progress);
+}
+
+void startup_mark_menu_shown(void)
+{
+    if (!g_startup_lock_ready) {
+        return;
+    }
+    platform_mutex_lock(&g_startup.lock);
+    if (!g_startup.menu_shown && g_startup.status.phase != STARTUP_IDLE) {
+        g_startup.menu_shown = true;
+        g_startup.status.menu_ms = elapsed_ms(g_startup.started_ns);
+    }
+    platform_mutex_unlock(&g_startup.lock);
+}
+
+/* ==================== 界面交易 ==================== */
+
+void startup_op_begin(void)
+{
+    if (!g_startup_lock_ready) {
+        return;
+    }
+    platform_mutex_lock(&g_startup.lock);
+    while (ops_blocked()) {
+        platform_cond_wait(&g_startup.cond, &g_startup.lock);
+    }
+    g_startup.active_ops++;
+    platform_mutex_unlock(&g_startup.lock);
+}
+
+bool startup_op_try_begin(unsigned int timeout_ms)
+{
+    if (!g_startup_lock_ready) {
+        return true;
+    }
+    uint64_t deadline = platform_monotonic_ns() + (uint64_t)timeout_ms * 1000000;
+    platform_mutex_lock(&g_startup.lock);
+    while (ops_blocked()) {
+        uint64_t now = platform_monotonic_ns();
+        if (now >= deadline) {
+            platform_mutex_unlock(&g_startup.lock);
+            return false;
+        }
+        platform_cond_timedwait(&g_startup.cond, &g_startup.lock,
+                                (unsigned int)((deadline - now + 999999) / 1000000));
+    }
+    g_startup.active_ops++;
+    platform_mutex_unlock(&g_startup.lock);
+    return true;
+}
+
+void startup_release_ops(void)
+{
+    if (!g_startup_lock_ready) {
+        return;
+    }
+    platform_mutex_lock(&g_startup.lock);
+    g_startup.ops_released = true;
+    platform_cond_broadcast(&g_startup.cond);
+    platform_mutex_unlock(&g_startup.lock);
+}
+
+void startup_op_end(void)
+{
+    if (!g_startup_lock_ready) {
+        return;
+    }
+    platform_mutex_lock(&g_startup.lock);
+    if (g_startup.active_ops > 0 && --g_startup.active_ops == 0) {
+        platform_cond_broadcast(&g_startup.cond);
+    }
+    platform_mutex_unlock(&g_startup.lock);
+}
@@ -0,0 +1,63 @@
+#ifndef MOCK_SERVER_H
+#define MOCK_SERVER_H
+
+/**
+ * @file mock_server.h
+ * @brief 网络测试与基准用的本地 HTTP/1.1 模拟服务器
+ *
+ * 监听 127.0.0.1 的随机端口，在一个后台线程中用 poll() 处理所有 keep-alive 连接：
+ *   GET  /api/check                 {"status":"Support","request_encodings":"gzip"}
+ *   POST /api/accounts/sync_batch   按请求中的账户数返回逐个成功的结果
+ *   GET  /api/accounts              mock_server_set_accounts() 设置的响应
+ *   其余                            {"success":true}
+ * gzip 请求体先解压再统计。MOCK_FAIL 时返回 503，MOCK_HANG 时不响应，直到客户端断开。
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    MOCK_OK,          /**< 正常响应 */
+    MOCK_FAIL,        /**< 返回 503 */
+    MOCK_HANG         /**< 收下请求但不响应（服务器卡死） */
+} MockMode;
+
+typedef struct {
+    uint64_t requests;          /**< 收到的请求数 */
+    uint64_t batch_requests;    /**< /api/accounts/sync_batch 请求数 */
+    uint64_t batch_accounts;    /**< 批量请求中的账户数（含重试） */
+    uint64_t gzip_bodies;       /**< 以 gzip 发送且解压成功的请求体数 */
+    uint64_t failed;            /**< 返回 503 的请求数 */
+    uint64_t hung;              /**< 未响应的请求数 */
+} MockStats;
+
+/**
+ * @brief 启动模拟服务器
+ * @param latency_ms 正常响应前的等待时间
+ */
+bool mock_server_start(int latency_ms);
+void mock_server_stop(void);
+int mock_server_port(void);
+
+void mock_server_set_mode(MockMode mode);
+
+/**
+ * @brief 之后的 n 个请求返回 503（不论模式）
+ */
+void mock_server_fail_next(int n);
+
+/**
+ * @brief 设置 GET /api/accounts 的响应体（复制），NULL 恢复为空列表
+ */
+void mock_server_set_accounts(const char *json);
+
+void mock_server_get_stats(MockStats *stats);
+void mock_server_reset_stats(void);
+
+/**
+ * @brief 写一份指向模拟服务器的 server.conf
+ * @param extra 追加在文件末尾的配置节，可为NULL
+ */
+bool mock_server_write_config(const char *path, const char *extra);
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <stdbool.h>
 
+#include <lib/account.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -22,6 +24,39 @@ void test_register(TestFunc func, const char *title, const char *detail);
 
 int test_run_all(void);
 
+/* 公共测试夹具 */
+
+/**
+ * @brief 创建并保存一个测试账户（随机 UUID，固定密码）
+ */
+bool test_create_account(ACCOUNT *acc, LLUINT balance);
+
+/**
+ * @brief Card/<uuid>.card 是否存在
+ */
+bool test_card_exists(const char *uuid);
+
+/* 各模块测试注册 */
+void register_amount_tests(void);
+void register_threadpool_tests(void);
+void register_engine_tests(void);
+void register_shard_tests(void);
+void register_flusher_tests(void);
+void register_shm_store_tests(void);
+void register_snapshot_tests(void);
+void register_async_ops_tests(void);
+void register_replication_tests(void);
+void register_tiering_tests(void);
+void register_compact_store_tests(void);
+void register_disk_index_tests(void);
+void register_outbox_tests(void);
+void register_wire_tests(void);
+void register_startup_tests(void);
+void register_breaker_tests(void);
+#ifdef ENABLE_NETWORK
+void register_server_api_tests(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,501 @@
+#include "include/mock_server.h"
+
+#include <lib/platform.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define MOCK_MAX_CONNS 128
+#define MOCK_MAX_REQUEST (8 * 1024 * 1024)
+
+typedef struct {
+    int fd;
+    char *buf;
+    size_t len;
+    size_t cap;
+    bool continued;           /* 已回复 100 Continue */
+    bool hung;                /* 当前请求不再响应，等待客户端断开 */
+    char *reply;              /* 等待 latency 后发送的响应 */
+    size_t reply_len;
+    uint64_t reply_at_ns;
+} MockConn;
+
+static struct {
+    int listen_fd;
+    int wake[2];
+    int port;
+    int latency_ms;
+    PlatformThread thread;
+    bool running;
+
+    PlatformMutex lock;       /* 保护以下字段 */
+    bool stopping;
+    MockMode mode;
+    int fail_next;
+    char *accounts_json;
+    MockStats stats;
+
+    MockConn conns[MOCK_MAX_CONNS];
+} g_mock;
+
+static void conn_close(MockConn *c)
+{
+    close(c->fd);
+    free(c->buf);
+    free(c->reply);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+/**
+ * @brief 解压 gzip 请求体，失败返回NULL
+ */
+static char* gunzip(const char *data, size_t len, size_t *out_len)
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) {
+        return NULL;
+    }
+    size_t cap = len * 8 + 1024;
+    char *out = malloc(cap + 1);
+    zs.next_in = (Bytef *)data;
+    zs.avail_in = (uInt)len;
+    int rc = Z_OK;
+    while (out != NULL && rc == Z_OK) {
+        zs.next_out = (Bytef *)out + zs.total_out;
+        zs.avail_out = (uInt)(cap - zs.total_out);
+        rc = inflate(&zs, Z_NO_FLUSH);
+        if (rc == Z_OK && zs.avail_out == 0) {
+            cap *= 2;
+            char *grown = realloc(out, cap + 1);
+            if (grown == NULL) {
+                free(out);
+                out = NULL;
+            }
+            out = grown;
+        }
+    }
+    *out_len = zs.total_out;
+    inflateEnd(&zs);
+    if (rc != Z_STREAM_END) {
+        free(out);
+        return NULL;
+    }
+    out[*out_len] = '\0';
+    return out;
+}
+
+static size_t count_occurrences(const char *s, const char *needle)
+{
+    size_t n = 0;
+    size_t step = strlen(needle);
+    for (const char *p = strstr(s, needle); p != NULL; p = strstr(p + step, needle)) {
+        n++;
+    }
+    return n;
+}
+
+static void set_reply(MockConn *c, int status, const char *body)
+{
+    const char *reason = status == 200 ? "OK" : "Service Unavailable";
+    size_t body_len = strlen(body);
+    c->reply = malloc(body_len + 160);
+    if (c->reply == NULL) {
+        return;
+    }
+    c->reply_len = (size_t)sprintf(c->reply,
+                                   "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\n"
+                                   "Content-Length: %zu\r\n\r\n",
+                                   status, reason, body_len);
+    memcpy(c->reply + c->reply_len, body, body_len);
+    c->reply_len += body_len;
+    c->reply_at_ns = platform_monotonic_ns() + (uint64_t)g_mock.latency_ms * 1000000ull;
+}
+
+/**
+ * @brief 按路径生成响应（须持 g_mock.lock）
+ */
+static void handle_request(MockConn *c, const char *method, const char *path, const char *body,
+                           size_t body_len, bool gzip)
+{
+    g_mock.stats.requests++;
+    if (g_mock.fail_next > 0 || g_mock.mode == MOCK_FAIL) {
+        if (g_mock.fail_next > 0) {
+            g_mock.fail_next--;
+        }
+        g_mock.stats.failed++;
+        set_reply(c, 503, "{\"success\":false,\"message\":\"unavailable\"}");
+        return;
+    }
+    if (g_mock.mode == MOCK_HANG) {
+        g_mock.stats.hung++;
+        c->hung = true;
+        return;
+    }
+
+    if (strcmp(path, "/api/check") == 0) {
+        set_reply(c, 200, "{\"status\":\"Support\",\"request_encodings\":\"gzip\"}");
+        return;
+    }
+    if (strncmp(path, "/api/accounts?", 14) == 0 || strcmp(path, "/api/accounts") == 0) {
+        set_reply(c, 200, g_mock.accounts_json != NULL ? g_mock.accounts_json
+                                                       : "{\"success\":true,\"accounts\":[]}");
+        return;
+    }
+    if (strcmp(method, "POST") == 0 && strcmp(path, "/api/accounts/sync_batch") == 0) {
+        char *plain = NULL;
+        size_t plain_len = 0;
+        if (gzip) {
+            plain = gunzip(body, body_len, &plain_len);
+            if (plain == NULL) {
+                set_reply(c, 200, "{\"success\":false,\"message\":\"bad gzip\"}");
+                return;
+            }
+            g_mock.stats.gzip_bodies++;
+        }
+        size_t n = count_occurrences(plain != NULL ? plain : body, "\"uuid\"");
+        free(plain);
+        g_mock.stats.batch_requests++;
+        g_mock.stats.batch_accounts += n;
+
+        char *reply = malloc(n * 17 + 64);
+        if (reply == NULL) {
+            return;
+        }
+        size_t len = (size_t)sprintf(reply, "{\"success\":true,\"results\":[");
+        for (size_t i = 0; i < n; i++) {
+            len += (size_t)sprintf(reply + len, "%s{\"success\":true}", i ? "," : "");
+        }
+        sprintf(reply + len, "]}");
+        set_reply(c, 200, reply);
+        free(reply);
+        return;
+    }
+    set_reply(c, 200, "{\"success\":true}");
+}
+
+/**
+ * @brief 缓冲区中有完整请求时处理并移出缓冲区
+ * @return 连接出错应关闭时返回false
+ */
+static bool try_parse(MockConn *c)
+{
+    if (c->reply != NULL || c->hung) {
+        return true;
+    }
+    c->buf[c->len] = '\0';
+    char *head_end = strstr(c->buf, "\r\n\r\n");
+    if (head_end == NULL) {
+        return true;
+    }
+    size_t head_len = (size_t)(head_end - c->buf) + 4;
+
+    char method[16];
+    char path[1024];
+    if (sscanf(c->buf, "%15s %1023s", method, path) != 2) {
+        return false;
+    }
+    size_t content_length = 0;
+    bool gzip = false;
+    bool expect = false;
+    for (char *line = strstr(c->buf, "\r\n") + 2; line < head_end; line = strstr(line, "\r\n") + 2) {
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_length = strtoul(line + 15, NULL, 10);
+        } else if (strncasecmp(line, "Content-Encoding:", 17) == 0) {
+            gzip = strstr(line, "gzip") != NULL && strstr(line, "gzip") < strstr(line, "\r\n");
+        } else if (strncasecmp(line, "Expect:", 7) == 0) {
+            expect = true;
+        }
+    }
+    if (content_length > MOCK_MAX_REQUEST) {
+        return false;
+    }
+    if (c->len < head_len + content_length) {
+        if (expect && !c->continued) {
+            static const char cont[] = "HTTP/1.1 100 Continue\r\n\r\n";
+            c->continued = send(c->fd, cont, sizeof(cont) - 1, MSG_NOSIGNAL) > 0;
+        }
+        return true;
+    }
+
+    platform_mutex_lock(&g_mock.lock);
+    handle_request(c, method, path, c->buf + head_len, content_length, gzip);
+    platform_mutex_unlock(&g_mock.lock);
+
+    size_t used = head_len + content_length;
+    memmove(c->buf, c->buf + used, c->len - used);
+    c->len -= used;
+    c->continued = false;
+    return true;
+}
+
+static bool conn_read(MockConn *c)
+{
+    if (c->cap - c->len < 4096) {
+        size_t cap = c->cap ? c->cap * 2 : 16384;
+        if (cap > MOCK_MAX_REQUEST * 2) {
+            return false;
+        }
+        char *grown = realloc(c->buf, cap + 1);
+        if (grown == NULL) {
+            return false;
+        }
+        c->buf = grown;
+        c->cap = cap;
+    }
+    ssize_t n = recv(c->fd, c->buf + c->len, c->cap - c->len, 0);
+    if (n <= 0) {
+        return false;
+    }
+    c->len += (size_t)n;
+    return try_parse(c);
+}
+
+static bool conn_flush(MockConn *c)
+{
+    size_t off = 0;
+    while (off < c->reply_len) {
+        ssize_t n = send(c->fd, c->reply + off, c->reply_len - off, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        off += (size_t)n;
+    }
+    free(c->reply);
+    c->reply = NULL;
+    /* 客户端可能已把下一个请求发过来 */
+    return try_parse(c);
+}
+
+static void mock_thread(void *arg)
+{
+    (void)arg;
+    struct pollfd fds[MOCK_MAX_CONNS + 2];
+    for (;;) {
+        platform_mutex_lock(&g_mock.lock);
+        bool stopping = g_mock.stopping;
+        platform_mutex_unlock(&g_mock.lock);
+        if (stopping) {
+            break;
+        }
+
+        /* 最早到期的响应决定 poll 的等待时间 */
+        uint64_t now = platform_monotonic_ns();
+        int timeout_ms = -1;
+        for (int i = 0; i < MOCK_MAX_CONNS; i++) {
+            MockConn *c = &g_mock.conns[i];
+            if (c->fd < 0 || c->reply == NULL) {
+                continue;
+            }
+            if (c->reply_at_ns <= now) {
+                if (!conn_flush(c)) {
+                    conn_close(c);
+                }
+                timeout_ms = 0;
+                continue;
+            }
+            int ms = (int)((c->reply_at_ns - now + 999999) / 1000000);
+            if (timeout_ms < 0 || ms < timeout_ms) {
+                timeout_ms = ms;
+            }
+        }
+
+        nfds_t n = 0;
+        int slot[MOCK_MAX_CONNS + 2];
+        fds[n].fd = g_mock.wake[0];
+        fds[n].events = POLLIN;
+        slot[n++] = -1;
+        fds[n].fd = g_mock.listen_fd;
+        fds[n].events = POLLIN;
+        slot[n++] = -1;
+        for (int i = 0; i < MOCK_MAX_CONNS; i++) {
+            if (g_mock.conns[i].fd >= 0) {
+                fds[n].fd = g_mock.conns[i].fd;
+                fds[n].events = POLLIN;
+                slot[n++] = i;
+            }
+        }
+        if (poll(fds, n, timeout_ms) <= 0) {
+            continue;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int fd = accept(g_mock.listen_fd, NULL, NULL);
+            int i = 0;
+            while (fd >= 0 && i < MOCK_MAX_CONNS && g_mock.conns[i].fd >= 0) {
+                i++;
+            }
+            if (fd >= 0 && i < MOCK_MAX_CONNS) {
+                g_mock.conns[i].fd = fd;
+            } else if (fd >= 0) {
+                close(fd);
+            }
+        }
+        for (nfds_t k = 2; k < n; k++) {
+            if (fds[k].revents & (POLLIN | POLLHUP | POLLERR)) {
+                MockConn *c = &g_mock.conns[slot[k]];
+                if (!conn_read(c)) {
+                    conn_close(c);
+                }
+            }
+        }
+    }
+}
+
+bool mock_server_start(int latency_ms)
+{
+    memset(&g_mock, 0, sizeof(g_mock));
+    for (int i = 0; i < MOCK_MAX_CONNS; i++) {
+        g_mock.conns[i].fd = -1;
+    }
+    g_mock.latency_ms = latency_ms;
+
+    g_mock.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (g_mock.listen_fd < 0) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(g_mock.listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (bind(g_mock.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(g_mock.listen_fd, 64) != 0 ||
+        getsockname(g_mock.listen_fd, (struct sockaddr *)&addr, &addr_len) != 0 ||
+        pipe(g_mock.wake) != 0) {
+        close(g_mock.listen_fd);
+        return false;
+    }
+    g_mock.port = ntohs(addr.sin_port);
+
+    platform_mutex_init(&g_mock.lock);
+    if (!platform_thread_create(&g_mock.thread, mock_thread, NULL)) {
+        platform_mutex_destroy(&g_mock.lock);
+        close(g_mock.listen_fd);
+        close(g_mock.wake[0]);
+        close(g_mock.wake[1]);
+        return false;
+    }
+    g_mock.running = true;
+    return true;
+}
+
+void mock_server_stop(void)
+{
+    if (!g_mock.running) {
+        return;
+    }
+    platform_mutex_lock(&g_mock.lock);
+    g_mock.stopping = true;
+    platform_mutex_unlock(&g_mock.lock);
+    if (write(g_mock.wake[1], "x", 1) != 1) {
+        /* poll 超时后同样会看到 stopping */
+    }
+    platform_thread_join(g_mock.thread);
+
+    for (int i = 0; i < MOCK_MAX_CONNS; i++) {
+        if (g_mock.conns[i].fd >= 0) {
+            conn_close(&g_mock.conns[i]);
+        }
+    }
+    close(g_mock.listen_fd);
+    close(g_mock.wake[0]);
+    close(g_mock.wake[1]);
+    free(g_mock.accounts_json);
+    platform_mutex_destroy(&g_mock.lock);
+    g_mock.running = false;
+}
+
+int mock_server_port(void)
+{
+    return g_mock.port;
+}
+
+void mock_server_set_mode(MockMode mode)
+{
+    platform_mutex_lock(&g_mock.lock);
+    g_mock.mode = mode;
+    platform_mutex_unlock(&g_mock.lock);
+}
+
+void mock_server_fail_next(int n)
+{
+    platform_mutex_lock(&g_mock.lock);
+    g_mock.fail_next = n;
+    platform_mutex_unlock(&g_mock.lock);
+}
+
+void mock_server_set_accounts(const char *json)
+{
+    char *copy = json != NULL ? strdup(json) : NULL;
+    platform_mutex_lock(&g_mock.lock);
+    free(g_mock.accounts_json);
+    g_mock.accounts_json = copy;
+    platform_mutex_unlock(&g_mock.lock);
+}
+
+void mock_server_get_stats(MockStats *stats)
+{
+    platform_mutex_lock(&g_mock.lock);
+    *stats = g_mock.stats;
+    platform_mutex_unlock(&g_mock.lock);
+}
+
+void mock_server_reset_stats(void)
+{
+    platform_mutex_lock(&g_mock.lock);
+    memset(&g_mock.stats, 0, sizeof(g_mock.stats));
+    platform_mutex_unlock(&g_mock.lock);
+}
+
+bool mock_server_write_config(const char *path, const char *extra)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return false;
+    }
+    fprintf(f,
+            "[server]\n"
+            "url=http://127.0.0.1:%d\n"
+            "timeout=2\n"
+            "connect_timeout=1\n"
+            "adaptive_timeout=true\n"
+            "\n"
+            "[client]\n"
+            "client_id=mock-client\n"
+            "\n"
+            "[security]\n"
+            "use_https=false\n"
+            "verify_cert=false\n"
+            "\n"
+            "[sync]\n"
+            "max_in_flight=4\n"
+            "max_retries=2\n"
+            "batch_size=100\n"
+            "pull_page_size=1000\n"
+            "compress=true\n"
+            "compress_min_bytes=1024\n"
+            "\n"
+            "[breaker]\n"
+            "enabled=true\n"
+            "window=10\n"
+            "min_requests=5\n"
+            "failure_percent=50\n"
+            "open_seconds=1\n"
+            "\n"
+            "%s",
+            g_mock.port, extra != NULL ? extra : "");
+    return fclose(f) == 0;
+}
@@ -0,0 +1,134 @@
+#include "include/test_framework.h"
+
+#include <lib/amount.h>
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+static bool expect_parse(const char *s, AmountParseResult want, LLUINT want_cents)
+{
+    LLUINT cents = 0;
+    AmountParseResult r = parse_amount_cents(s, strlen(s), &cents);
+    if (r != want) {
+        fprintf(stderr, "parse(\"%s\") = %d, want %d\n", s, (int)r, (int)want);
+        return false;
+    }
+    if (r == AMOUNT_OK && cents != want_cents) {
+        fprintf(stderr, "parse(\"%s\") = %llu cents, want %llu\n", s, cents, want_cents);
+        return false;
+    }
+    return true;
+}
+
+static bool test_amount_parse_cases(void)
+{
+    bool ok = true;
+
+    /* scanf("%lf") * 100 会把 0.29 截断为 28 分 */
+    ok &= expect_parse("0.29", AMOUNT_OK, 29);
+    ok &= expect_parse("1.15", AMOUNT_OK, 115);
+    ok &= expect_parse("12", AMOUNT_OK, 1200);
+    ok &= expect_parse("12.", AMOUNT_OK, 1200);
+    ok &= expect_parse(".5", AMOUNT_OK, 50);
+    ok &= expect_parse("0.5", AMOUNT_OK, 50);
+    ok &= expect_parse("+7.07", AMOUNT_OK, 707);
+    ok &= expect_parse("  3.10\n", AMOUNT_OK, 310);
+    ok &= expect_parse("1.500", AMOUNT_OK, 150);
+    ok &= expect_parse("0", AMOUNT_OK, 0);
+
+    ok &= expect_parse("", AMOUNT_ERR_EMPTY, 0);
+    ok &= expect_parse("   ", AMOUNT_ERR_EMPTY, 0);
+    ok &= expect_parse(".", AMOUNT_ERR_FORMAT, 0);
+    ok &= expect_parse("+", AMOUNT_ERR_FORMAT, 0);
+    ok &= expect_parse("-1", AMOUNT_ERR_FORMAT, 0);
+    ok &= expect_parse("1e5", AMOUNT_ERR_FORMAT, 0);
+    ok &= expect_parse("1.2.3", AMOUNT_ERR_FORMAT, 0);
+    ok &= expect_parse("1 2", AMOUNT_ERR_FORMAT, 0);
+    ok &= expect_parse("0x10", AMOUNT_ERR_FORMAT, 0);
+    ok &= expect_parse("1,5", AMOUNT_ERR_FORMAT, 0);
+    ok &= expect_parse("0.291", AMOUNT_ERR_PRECISION, 0);
+
+    /* ULLONG_MAX 分 = 184467440737095516.15 元 */
+    ok &= expect_parse("184467440737095516.15", AMOUNT_OK, ULLONG_MAX);
+    ok &= expect_parse("184467440737095516.16", AMOUNT_ERR_OVERFLOW, 0);
+    ok &= expect_parse("184467440737095517", AMOUNT_ERR_OVERFLOW, 0);
+    ok &= expect_parse("99999999999999999999999", AMOUNT_ERR_OVERFLOW, 0);
+    ok &= expect_parse("99999999999999999999999x", AMOUNT_ERR_FORMAT, 0);
+
+    /* 字节区间不要求'\0'结尾 */
+    LLUINT cents = 0;
+    ok &= (parse_amount_cents("42.42garbage", 5, &cents) == AMOUNT_OK && cents == 4242);
+
+    /* 以分为单位：不放大，小数部分只允许为0 */
+    ok &= parse_cents_value("1234", 4, &cents) == AMOUNT_OK && cents == 1234;
+    ok &= parse_cents_value(" 12.00 ", 7, &cents) == AMOUNT_OK && cents == 12;
+    ok &= parse_cents_value("18446744073709551615", 20, &cents) == AMOUNT_OK && cents == ULLONG_MAX;
+    ok &= parse_cents_value("18446744073709551616", 20, &cents) == AMOUNT_ERR_OVERFLOW;
+    ok &= parse_cents_value("12.5", 4, &cents) == AMOUNT_ERR_PRECISION;
+    ok &= parse_cents_value("-3", 2, &cents) == AMOUNT_ERR_FORMAT;
+    ok &= parse_cents_value("1e+20", 5, &cents) == AMOUNT_ERR_FORMAT;
+
+    return ok;
+}
+
+static bool roundtrip(LLUINT cents)
+{
+    char buf[AMOUNT_STR_MAX];
+    size_t n = format_amount_cents(cents, buf, sizeof(buf));
+    if (n == 0) {
+        return false;
+    }
+
+    LLUINT back = 0;
+    if (parse_amount_cents(buf, n, &back) != AMOUNT_OK || back != cents) {
+        fprintf(stderr, "roundtrip failed: %llu -> \"%s\" -> %llu\n", cents, buf, back);
+        return false;
+    }
+    return true;
+}
+
+static bool test_amount_roundtrip_exhaustive(void)
+{
+    /* 0.00 ~ 99999.99 元的每一个金额 */
+    for (LLUINT c = 0; c < 10000000ULL; c++) {
+        if (!roundtrip(c)) {
+            return false;
+        }
+    }
+
+    /* 上界附近 */
+    for (LLUINT c = ULLONG_MAX - 100000ULL; ; c++) {
+        if (!roundtrip(c)) {
+            return false;
+        }
+        if (c == ULLONG_MAX) {
+            break;
+        }
+    }
+
+    /* 每个数量级的边界 */
+    for (LLUINT p = 1; p <= ULLONG_MAX / 10ULL; p *= 10ULL) {
+        if (!roundtrip(p - 1) || !roundtrip(p) || !roundtrip(p + 1)) {
+            return false;
+        }
+    }
+
+    char small[4];
+    if (format_amount_cents(100, small, sizeof(small)) != 0) {
+        return false;  /* "1.00" 需要5字节 */
+    }
+
+    return true;
+}
+
+void register_amount_tests(void)
+{
+    test_register(test_amount_parse_cases,
+                  "amount: parse edge cases",
+                  "exact cents, rejected formats, precision and ULLONG_MAX overflow");
+
+    test_register(test_amount_roundtrip_exhaustive,
+                  "amount: exhaustive format/parse roundtrip",
+                  "every cent value below 100000 yuan plus the ULLONG_MAX neighbourhood");
+}
@@ -0,0 +1,170 @@
+#include "include/test_framework.h"
+
+#include <lib/async_ops.h>
+#include <lib/engine.h>
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ASYNC_TEST_PIPELINE_OPS 2000
+
+/* 记录同步顺序；第 fail_at 次同步返回失败 */
+static EngineOpType g_synced_types[16];
+static LLUINT g_synced_amounts[16];
+static atomic_int g_synced;
+static int g_fail_at;
+
+static bool record_sync(EngineOpType type, const char *uuid, const char *uuid_to, LLUINT amount)
+{
+    (void)uuid;
+    (void)uuid_to;
+    int n = atomic_fetch_add(&g_synced, 1);
+    if (n < 16) {
+        g_synced_types[n] = type;
+        g_synced_amounts[n] = amount;
+    }
+    return n != g_fail_at;
+}
+
+static bool test_async_ordered_sync(void)
+{
+    ACCOUNT a;
+    ACCOUNT b;
+    if (!test_create_account(&a, 0) || !test_create_account(&b, 0)) {
+        return false;
+    }
+
+    atomic_store(&g_synced, 0);
+    g_fail_at = 2;
+    if (!async_start(record_sync)) {
+        return false;
+    }
+
+    /* 第2笔取款余额不足：本地失败，不应同步 */
+    AsyncOp *ops[5];
+    ops[0] = async_deposit(a.UUID, 100, NULL, NULL);
+    ops[1] = async_withdraw(a.UUID, 30, NULL, NULL);
+    ops[2] = async_withdraw(a.UUID, 500, NULL, NULL);
+    ops[3] = async_transfer(a.UUID, b.UUID, 70, NULL, NULL);
+    ops[4] = async_withdraw(b.UUID, 70, NULL, NULL);
+
+    bool ok = true;
+    AsyncResult r[5];
+    for (int i = 0; i < 5; i++) {
+        ok &= ops[i] != NULL;
+        if (ops[i] == NULL) {
+            continue;
+        }
+        async_op_wait_synced(ops[i], &r[i]);
+        ok &= async_op_state(ops[i]) == ASYNC_OP_DONE;
+        async_op_release(ops[i]);
+    }
+    if (!ok) {
+        cleanup_async_ops();
+        return false;
+    }
+
+    ok &= r[0].status == ACCOUNT_OK && r[0].account.BALANCE == 100 && r[0].sync == ASYNC_SYNC_OK;
+    ok &= r[1].status == ACCOUNT_OK && r[1].account.BALANCE == 70 && r[1].sync == ASYNC_SYNC_OK;
+    ok &= r[2].status == ACCOUNT_ERR_INSUFFICIENT && r[2].sync == ASYNC_SYNC_NOT_REQUIRED;
+    ok &= r[3].status == ACCOUNT_OK && r[3].account_to.BALANCE == 70 && r[3].sync == ASYNC_SYNC_FAILED;
+    ok &= r[4].status == ACCOUNT_OK && r[4].account.BALANCE == 0 && r[4].sync == ASYNC_SYNC_OK;
+
+    /* 同步按本地生效顺序进行 */
+    ok &= atomic_load(&g_synced) == 4;
+    ok &= g_synced_types[0] == ENGINE_OP_DEPOSIT && g_synced_amounts[0] == 100;
+    ok &= g_synced_types[1] == ENGINE_OP_WITHDRAW && g_synced_amounts[1] == 30;
+    ok &= g_synced_types[2] == ENGINE_OP_TRANSFER && g_synced_amounts[2] == 70;
+    ok &= g_synced_types[3] == ENGINE_OP_WITHDRAW && g_synced_amounts[3] == 70;
+
+    AsyncOp *del = async_delete(a.UUID, NULL, NULL);
+    AsyncResult rd;
+    async_op_wait(del, &rd);
+    async_op_release(del);
+    ok &= rd.status == ACCOUNT_OK;
+
+    cleanup_async_ops();
+
+    AsyncStats st;
+    async_get_stats(&st);
+    ok &= st.submitted == 6 && st.completed == 6 && st.in_flight == 0;
+    ok &= st.pending_sync == 0 && st.sync_failed == 1;
+
+    /* 停止后不再接受提交 */
+    ok &= !async_ops_active() && async_deposit(b.UUID, 1, NULL, NULL) == NULL;
+
+    engine_delete(b.UUID);
+    return ok;
+}
+
+typedef struct {
+    atomic_int calls;
+    atomic_int failures;
+} AsyncCounter;
+
+static void count_callback(const AsyncResult *result, void *user)
+{
+    AsyncCounter *c = (AsyncCounter *)user;
+    if (result->status != ACCOUNT_OK || result->sync != ASYNC_SYNC_NOT_REQUIRED) {
+        atomic_fetch_add(&c->failures, 1);
+    }
+    atomic_fetch_add(&c->calls, 1);
+}
+
+static bool test_async_pipelined_single_writer(void)
+{
+    ACCOUNT acc;
+    if (!test_create_account(&acc, 0)) {
+        return false;
+    }
+
+    EngineConfig config;
+    config.mode = ENGINE_MODE_SINGLE_WRITER;
+    config.queue_capacity = 64;
+    config.max_batch = 64;
+    if (!engine_start(&config)) {
+        return false;
+    }
+    if (!init_async_ops()) {
+        cleanup_engine();
+        return false;
+    }
+
+    /* 只靠回调取结果，提交后立即释放句柄 */
+    AsyncCounter counter;
+    atomic_init(&counter.calls, 0);
+    atomic_init(&counter.failures, 0);
+    bool ok = true;
+    for (int i = 0; i < ASYNC_TEST_PIPELINE_OPS; i++) {
+        AsyncOp *op = async_deposit(acc.UUID, 1, count_callback, &counter);
+        ok &= op != NULL;
+        async_op_release(op);
+    }
+
+    /* 停止时执行完全部已提交的操作 */
+    cleanup_async_ops();
+    cleanup_engine();
+
+    ok &= atomic_load(&counter.calls) == ASYNC_TEST_PIPELINE_OPS;
+    ok &= atomic_load(&counter.failures) == 0;
+
+    ACCOUNT loaded;
+    ok &= load_account(acc.UUID, &loaded) && loaded.BALANCE == ASYNC_TEST_PIPELINE_OPS;
+
+    engine_withdraw(acc.UUID, ASYNC_TEST_PIPELINE_OPS, NULL);
+    engine_delete(acc.UUID);
+    return ok;
+}
+
+void register_async_ops_tests(void)
+{
+    test_register(test_async_ordered_sync,
+                  "async: ordered local apply and sync",
+                  "results via wait handles; only successful ops sync, in submit order");
+
+    test_register(test_async_pipelined_single_writer,
+                  "async: pipelined through single writer",
+                  "2000 fire-and-forget deposits with callbacks; cleanup drains all");
+}
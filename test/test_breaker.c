@@ -0,0 +1,183 @@
+#include "include/test_framework.h"
+
+#include <lib/breaker.h>
+
+#include <string.h>
+
+#define MS 1000000ull
+
+static void test_config(BreakerConfig *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->enabled = true;
+    c->adaptive = true;
+    c->window = 10;
+    c->min_requests = 4;
+    c->failure_percent = 50;
+    c->open_ms = 1000;
+    c->timeout_ms = 5000;
+    c->connect_timeout_ms = 3000;
+    c->min_timeout_ms = 100;
+}
+
+static bool test_breaker_states(void)
+{
+    BreakerConfig c;
+    test_config(&c);
+    CircuitBreaker cb;
+    breaker_init(&cb, &c);
+    uint64_t t = 10 * MS;
+    bool ok = true;
+    bool probe;
+    bool stale;
+
+    /* 请求数不足 min_requests 时不断开；达到后错误率 2/4 = 50% 断开 */
+    breaker_record(&cb, false, true, t);
+    breaker_record(&cb, false, true, t);
+    breaker_record(&cb, false, false, t);
+    ok &= breaker_allow(&cb, t, &stale) && !stale;
+    ok &= breaker_allow(&cb, t, &probe) && !probe;
+    breaker_record(&cb, false, false, t);
+    ok &= !breaker_allow(&cb, t, &probe) && !breaker_allow(&cb, t + 999 * MS, &probe);
+
+    /* 到时转为半开，只放行一个探测；断开前放行、此时才结束的请求不影响状态；
+     * 探测失败后断开时间加倍 */
+    ok &= breaker_allow(&cb, t + 1000 * MS, &probe) && probe;
+    ok &= !breaker_allow(&cb, t + 1000 * MS, &probe);
+    breaker_record(&cb, stale, true, t + 1000 * MS);
+    BreakerStats st;
+    breaker_get_stats(&cb, t + 1000 * MS, &st);
+    ok &= st.state == BREAKER_HALF_OPEN;
+    breaker_record(&cb, true, false, t + 1000 * MS);
+    ok &= !breaker_allow(&cb, t + 2999 * MS, &probe);
+    breaker_get_stats(&cb, t + 2000 * MS, &st);
+    ok &= st.state == BREAKER_OPEN && st.retry_in_ms == 1000 && st.opened == 2 && st.rejected == 4;
+
+    /* 探测未发出时让出名额；探测成功后闭合并重新计数 */
+    ok &= breaker_allow(&cb, t + 3000 * MS, &probe) && probe;
+    breaker_cancel(&cb, probe);
+    ok &= breaker_allow(&cb, t + 3000 * MS, &probe) && probe;
+    breaker_record(&cb, probe, true, t + 3000 * MS);
+    breaker_get_stats(&cb, t + 3000 * MS, &st);
+    ok &= st.state == BREAKER_CLOSED && st.window_requests == 0 && st.window_failures == 0;
+
+    /* 闭合后从头计数，再次达到阈值时断开 */
+    for (int i = 0; i < 4; i++) {
+        breaker_record(&cb, false, i % 2 == 0, t + 4000 * MS);
+    }
+    ok &= !breaker_allow(&cb, t + 4000 * MS, &probe);
+    breaker_destroy(&cb);
+
+    /* 窗口只保留最近 window 次：早先的失败滑出后不再计入 */
+    breaker_init(&cb, &c);
+    for (int i = 0; i < 5; i++) {
+        breaker_record(&cb, false, true, t);
+    }
+    breaker_record(&cb, false, false, t);
+    breaker_record(&cb, false, false, t);
+    for (int i = 0; i < 10; i++) {
+        breaker_record(&cb, false, true, t);
+    }
+    breaker_record(&cb, false, false, t);
+    breaker_get_stats(&cb, t, &st);
+    ok &= st.state == BREAKER_CLOSED && st.window_requests == 10 && st.window_failures == 1;
+    breaker_destroy(&cb);
+
+    /* min_requests 大于 window 时按 window 计，窗口满后仍能断开 */
+    c.window = 3;
+    c.min_requests = 8;
+    breaker_init(&cb, &c);
+    for (int i = 0; i < 3; i++) {
+        breaker_record(&cb, false, false, t);
+    }
+    ok &= !breaker_allow(&cb, t, &probe);
+    breaker_destroy(&cb);
+    test_config(&c);
+
+    /* 关闭熔断时总是放行 */
+    c.enabled = false;
+    breaker_init(&cb, &c);
+    for (int i = 0; i < 10; i++) {
+        breaker_record(&cb, false, false, t);
+    }
+    ok &= breaker_allow(&cb, t, &probe);
+    breaker_destroy(&cb);
+    return ok;
+}
+
+static bool test_breaker_timeouts(void)
+{
+    BreakerConfig c;
+    test_config(&c);
+    CircuitBreaker cb;
+    breaker_init(&cb, &c);
+    uint64_t timeout_ms;
+    uint64_t connect_ms;
+    bool ok = true;
+    bool probe;
+
+    /* 样本不足时使用上限 */
+    for (int i = 0; i < BREAKER_MIN_SAMPLES - 1; i++) {
+        breaker_observe(&cb, 2000, 500);
+    }
+    breaker_timeouts(&cb, &timeout_ms, &connect_ms);
+    ok &= timeout_ms == 5000 && connect_ms == 3000;
+
+    /* p99 * 4 低于下限时取下限；少数慢请求进入 p99 后超时随之上升 */
+    for (int i = 0; i < 80; i++) {
+        breaker_observe(&cb, 2000, 0);
+    }
+    breaker_observe(&cb, 0, 500);
+    breaker_timeouts(&cb, &timeout_ms, &connect_ms);
+    ok &= timeout_ms == 100 && connect_ms == 100;
+    breaker_observe(&cb, 60000, 40000);
+    breaker_observe(&cb, 60000, 0);
+    breaker_timeouts(&cb, &timeout_ms, &connect_ms);
+    ok &= timeout_ms == 240 && connect_ms == 160;
+
+    /* 服务器变慢后超时随之放宽，但不超过上限 */
+    for (int i = 0; i < 4; i++) {
+        breaker_observe(&cb, 2000000, 0);
+    }
+    breaker_timeouts(&cb, &timeout_ms, &connect_ms);
+    ok &= timeout_ms == 5000;
+
+    /* 半开的探测请求使用上限 */
+    breaker_destroy(&cb);
+    breaker_init(&cb, &c);
+    for (int i = 0; i < 30; i++) {
+        breaker_observe(&cb, 1000, 1000);
+    }
+    for (int i = 0; i < 4; i++) {
+        breaker_record(&cb, false, false, 0);
+    }
+    breaker_allow(&cb, 1000 * MS, &probe);
+    breaker_timeouts(&cb, &timeout_ms, &connect_ms);
+    ok &= timeout_ms == 5000 && connect_ms == 3000;
+    breaker_record(&cb, probe, true, 1000 * MS);
+    breaker_timeouts(&cb, &timeout_ms, &connect_ms);
+    ok &= timeout_ms == 100 && connect_ms == 100;
+
+    /* 关闭自适应时固定为上限 */
+    breaker_destroy(&cb);
+    c.adaptive = false;
+    breaker_init(&cb, &c);
+    for (int i = 0; i < 30; i++) {
+        breaker_observe(&cb, 1000, 1000);
+    }
+    breaker_timeouts(&cb, &timeout_ms, &connect_ms);
+    ok &= timeout_ms == 5000 && connect_ms == 3000;
+    breaker_destroy(&cb);
+    return ok;
+}
+
+void register_breaker_tests(void)
+{
+    test_register(test_breaker_states,
+                  "breaker: closed, open and half-open",
+                  "trips at the error-rate threshold, fails fast while open, one probe when half-open");
+
+    test_register(test_breaker_timeouts,
+                  "breaker: adaptive timeouts",
+                  "total and connect timeouts follow latency p99 within [min, configured]; probes use the limit");
+}
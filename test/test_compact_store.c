@@ -0,0 +1,157 @@
+#include "include/test_framework.h"
+
+#include <lib/compact_store.h>
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COMPACT_TEST_ACCOUNTS 200
+
+static bool test_compact_store_blocks(void)
+{
+    CompactStore *store = compact_store_create(4, 16);
+    if (store == NULL) {
+        return false;
+    }
+
+    ACCOUNT *accounts = malloc(COMPACT_TEST_ACCOUNTS * sizeof(ACCOUNT));
+    ACCOUNT *expected = malloc(COMPACT_TEST_ACCOUNTS * sizeof(ACCOUNT));
+    ACCOUNT *collected = malloc((COMPACT_TEST_ACCOUNTS + 8) * sizeof(ACCOUNT));
+    if (!accounts || !expected || !collected) {
+        free(accounts);
+        free(expected);
+        free(collected);
+        compact_store_destroy(store);
+        return false;
+    }
+    for (int i = 0; i < COMPACT_TEST_ACCOUNTS; i++) {
+        generate_uuid_string(accounts[i].UUID);
+        accounts[i].PASSWORD = 1000000 + (LLUINT)i;
+        accounts[i].BALANCE = (i % 7 == 0) ? 0 : (LLUINT)i * 1000003ull;
+    }
+    memcpy(expected, accounts, COMPACT_TEST_ACCOUNTS * sizeof(ACCOUNT));
+
+    bool ok = compact_store_build(store, accounts, COMPACT_TEST_ACCOUNTS);
+    CompactStoreStats st;
+    compact_store_get_stats(store, &st);
+    ok &= st.count == COMPACT_TEST_ACCOUNTS && st.blocks == COMPACT_TEST_ACCOUNTS / 4;
+    ok &= compact_store_memory_bytes(&st) < COMPACT_TEST_ACCOUNTS * sizeof(AccountNode) / 2;
+
+    for (int i = 0; i < COMPACT_TEST_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        ok &= compact_store_get(store, expected[i].UUID, &acc) &&
+              acc.PASSWORD == expected[i].PASSWORD && acc.BALANCE == expected[i].BALANCE;
+    }
+
+    /* 增量：更新、删除、新增、非规范 UUID，跨越归并阈值 */
+    for (int i = 0; i < 40; i++) {
+        expected[i].BALANCE += 1;
+        ok &= compact_store_put(store, &expected[i]);
+    }
+    for (int i = 40; i < 60; i++) {
+        ok &= compact_store_remove(store, expected[i].UUID);
+    }
+    ok &= !compact_store_remove(store, expected[40].UUID);
+    ACCOUNT extra;
+    generate_uuid_string(extra.UUID);
+    extra.PASSWORD = 7654321;
+    extra.BALANCE = 5;
+    ok &= compact_store_put(store, &extra);
+    ACCOUNT odd;
+    memset(&odd, 0, sizeof(odd));
+    snprintf(odd.UUID, sizeof(odd.UUID), "LEGACY-ACCOUNT");
+    odd.BALANCE = 9;
+    ok &= compact_store_put(store, &odd);
+
+    compact_store_get_stats(store, &st);
+    ok &= st.merges > 0 && st.count == COMPACT_TEST_ACCOUNTS - 20 + 2;
+
+    ACCOUNT acc;
+    for (int i = 0; i < COMPACT_TEST_ACCOUNTS; i++) {
+        bool found = compact_store_get(store, expected[i].UUID, &acc);
+        ok &= (i >= 40 && i < 60) ? !found : (found && acc.BALANCE == expected[i].BALANCE);
+    }
+    ok &= compact_store_get(store, extra.UUID, &acc) && acc.BALANCE == 5;
+    ok &= compact_store_get(store, "LEGACY-ACCOUNT", &acc) && acc.BALANCE == 9;
+
+    /* 全量复制按 UUID 有序，非规范 UUID 在最后 */
+    size_t n = compact_store_collect(store, collected, COMPACT_TEST_ACCOUNTS + 8);
+    ok &= n == COMPACT_TEST_ACCOUNTS - 20 + 2;
+    for (size_t i = 1; i + 1 < n; i++) {
+        ok &= strcmp(collected[i - 1].UUID, collected[i].UUID) < 0;
+    }
+    ok &= n > 0 && strcmp(collected[n - 1].UUID, "LEGACY-ACCOUNT") == 0;
+    compact_store_get_stats(store, &st);
+    ok &= st.deleted_count == 0 && st.delta_count == 1;
+
+    free(accounts);
+    free(expected);
+    free(collected);
+    compact_store_destroy(store);
+    return ok;
+}
+
+static bool test_compact_store_global(void)
+{
+    ACCOUNT a;
+    memset(&a, 0, sizeof(a));
+    generate_uuid_string(a.UUID);
+    a.PASSWORD = 1234567;
+    a.BALANCE = 100;
+    if (!save_account(&a)) {
+        return false;
+    }
+
+    CompactStoreConfig config;
+    load_compact_config("no-such-engine.conf", &config);
+    bool ok = !config.enabled && config.block_size == 32;
+    config.enabled = true;
+    config.merge_threshold = 2;
+    ok &= compact_store_enable(&config);
+    ok &= compact_store_active() && hash_find_account(a.UUID) == NULL;
+
+    ACCOUNT loaded;
+    ok &= load_account(a.UUID, &loaded) && loaded.BALANCE == 100;
+    ok &= engine_deposit(a.UUID, 23, NULL) == ACCOUNT_OK;
+
+    ACCOUNT b;
+    memset(&b, 0, sizeof(b));
+    generate_uuid_string(b.UUID);
+    b.PASSWORD = 7654321;
+    ok &= save_account(&b);
+
+    ACCOUNT all[256];
+    bool truncated = true;
+    size_t n = account_collect_all(all, 256, &truncated);
+    bool found_a = false;
+    bool found_b = false;
+    for (size_t i = 0; i < n; i++) {
+        found_a |= strcmp(all[i].UUID, a.UUID) == 0 && all[i].BALANCE == 123;
+        found_b |= strcmp(all[i].UUID, b.UUID) == 0;
+    }
+    ok &= found_a && found_b && !truncated;
+
+    ok &= engine_delete(b.UUID) == ACCOUNT_OK && !load_account(b.UUID, &loaded);
+
+    /* 关闭后从 .card 文件按需载入 */
+    cleanup_compact_store();
+    ok &= !compact_store_active();
+    ok &= load_account(a.UUID, &loaded) && loaded.BALANCE == 123;
+
+    engine_withdraw(a.UUID, 123, NULL);
+    engine_delete(a.UUID);
+    return ok;
+}
+
+void register_compact_store_tests(void)
+{
+    test_register(test_compact_store_blocks,
+                  "compact_store: blocks, delta and merge",
+                  "prefix-compressed blocks answer lookups; delta puts/deletes merge back in order");
+
+    test_register(test_compact_store_global,
+                  "compact_store: global account table",
+                  "hash_* and load_account() route to the compact table when enabled");
+}
@@ -0,0 +1,179 @@
+#include "include/test_framework.h"
+
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ENGINE_TEST_PRODUCERS 8
+#define ENGINE_TEST_OPS_PER_PRODUCER 500
+
+typedef struct {
+    const char *uuid;
+    int ops;
+} ProducerArg;
+
+/* 从文件重新读取，绕过 Hash 表，确认已落盘 */
+static bool load_account_from_disk(const char *uuid, ACCOUNT *out)
+{
+    hash_delete_account(uuid);
+    return load_account(uuid, out);
+}
+
+static void deposit_producer(void *arg)
+{
+    ProducerArg *p = (ProducerArg *)arg;
+    for (int i = 0; i < p->ops; i++) {
+        engine_deposit(p->uuid, 1, NULL);
+    }
+}
+
+static bool start_single_writer(size_t queue_capacity, size_t max_batch)
+{
+    EngineConfig config;
+    config.mode = ENGINE_MODE_SINGLE_WRITER;
+    config.queue_capacity = queue_capacity;
+    config.max_batch = max_batch;
+    return engine_start(&config);
+}
+
+static bool test_engine_concurrent_deposits(void)
+{
+    ACCOUNT acc;
+    if (!test_create_account(&acc, 0)) {
+        return false;
+    }
+
+    /* 小队列：迫使生产者走队列已满的重试路径 */
+    if (!start_single_writer(8, 16)) {
+        return false;
+    }
+
+    PlatformThread threads[ENGINE_TEST_PRODUCERS];
+    ProducerArg args[ENGINE_TEST_PRODUCERS];
+    for (int i = 0; i < ENGINE_TEST_PRODUCERS; i++) {
+        args[i].uuid = acc.UUID;
+        args[i].ops = ENGINE_TEST_OPS_PER_PRODUCER;
+        if (!platform_thread_create(&threads[i], deposit_producer, &args[i])) {
+            cleanup_engine();
+            return false;
+        }
+    }
+    for (int i = 0; i < ENGINE_TEST_PRODUCERS; i++) {
+        platform_thread_join(threads[i]);
+    }
+
+    EngineStats stats;
+    engine_get_stats(&stats);
+    cleanup_engine();
+
+    const LLUINT expected = (LLUINT)ENGINE_TEST_PRODUCERS * ENGINE_TEST_OPS_PER_PRODUCER;
+    bool ok = stats.applied == expected && stats.batches > 0 && stats.max_batch_seen <= 16;
+
+    ACCOUNT loaded;
+    ok = ok && load_account_from_disk(acc.UUID, &loaded) && loaded.BALANCE == expected;
+
+    ok = ok && engine_delete(acc.UUID) == ACCOUNT_ERR_HAS_BALANCE;
+    ok = ok && engine_withdraw(acc.UUID, expected, NULL) == ACCOUNT_OK;
+    ok = ok && engine_delete(acc.UUID) == ACCOUNT_OK;
+    return ok;
+}
+
+typedef struct {
+    atomic_int calls;
+    atomic_int failures;
+} CallbackCounter;
+
+static void count_callback(const EngineResult *result, void *user)
+{
+    CallbackCounter *c = (CallbackCounter *)user;
+    if (result->status != ACCOUNT_OK) {
+        atomic_fetch_add(&c->failures, 1);
+    }
+    atomic_fetch_add(&c->calls, 1);
+}
+
+static bool test_engine_status_and_callbacks(void)
+{
+    ACCOUNT a;
+    ACCOUNT b;
+    if (!test_create_account(&a, 100) || !test_create_account(&b, 0)) {
+        return false;
+    }
+    if (!start_single_writer(64, 64)) {
+        return false;
+    }
+
+    bool ok = true;
+    ACCOUNT out_a;
+    ACCOUNT out_b;
+    ok &= engine_withdraw(a.UUID, 101, NULL) == ACCOUNT_ERR_INSUFFICIENT;
+    ok &= engine_transfer(a.UUID, a.UUID, 1, NULL, NULL) == ACCOUNT_ERR_SAME_ACCOUNT;
+    ok &= engine_delete(a.UUID) == ACCOUNT_ERR_HAS_BALANCE;
+    ok &= engine_deposit("00000000-0000-0000-0000-000000000000", 1, NULL) == ACCOUNT_ERR_NOT_FOUND;
+    ok &= engine_transfer(a.UUID, b.UUID, 40, &out_a, &out_b) == ACCOUNT_OK;
+    ok &= out_a.BALANCE == 60 && out_b.BALANCE == 40;
+
+    /* 异步提交：回调按提交顺序执行，最后一次取款余额不足 */
+    CallbackCounter counter;
+    atomic_init(&counter.calls, 0);
+    atomic_init(&counter.failures, 0);
+    EngineFuture last;
+    engine_future_init(&last);
+
+    for (int i = 0; i < 7; i++) {
+        EngineOp op;
+        memset(&op, 0, sizeof(op));
+        op.type = ENGINE_OP_WITHDRAW;
+        memcpy(op.uuid, a.UUID, sizeof(op.uuid));
+        op.amount = 10;
+        op.callback = count_callback;
+        op.user = &counter;
+        op.future = (i == 6) ? &last : NULL;
+        while (!engine_submit(&op)) {
+            platform_sleep_ms(1);
+        }
+    }
+    const EngineResult *r = engine_future_wait(&last);
+    ok &= r->status == ACCOUNT_ERR_INSUFFICIENT;
+    engine_future_destroy(&last);
+    cleanup_engine();
+
+    ok &= atomic_load(&counter.calls) == 7 && atomic_load(&counter.failures) == 1;
+
+    /* 引擎停止后回到加锁路径 */
+    ok &= !engine_is_running();
+    ok &= engine_withdraw(a.UUID, 0, NULL) == ACCOUNT_ERR_INVALID;
+
+    ACCOUNT loaded;
+    ok &= load_account_from_disk(a.UUID, &loaded) && loaded.BALANCE == 0;
+
+    engine_withdraw(b.UUID, 40, NULL);
+    engine_delete(a.UUID);
+    engine_delete(b.UUID);
+    return ok;
+}
+
+static bool test_engine_config_defaults(void)
+{
+    EngineConfig config;
+    bool found = load_engine_config("no-such-engine.conf", &config);
+    return !found && config.mode == ENGINE_MODE_MUTEX &&
+           config.queue_capacity > 0 && config.max_batch > 0;
+}
+
+void register_engine_tests(void)
+{
+    test_register(test_engine_concurrent_deposits,
+                  "engine: concurrent deposits",
+                  "8 producers through a tiny MPSC queue; balance persisted exactly");
+
+    test_register(test_engine_status_and_callbacks,
+                  "engine: status codes and callbacks",
+                  "business errors surface through futures; callbacks run in submit order");
+
+    test_register(test_engine_config_defaults,
+                  "engine: config defaults",
+                  "missing engine.conf falls back to mutex mode");
+}
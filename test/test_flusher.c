@@ -0,0 +1,171 @@
+#include "include/test_framework.h"
+
+#include <lib/flusher.h>
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLUSHER_TEST_CONF "flusher_test.conf"
+
+static bool start_journal(unsigned int interval_ms, size_t threshold)
+{
+    FlusherConfig config;
+    config.durability = FLUSHER_DURABILITY_JOURNAL;
+    config.flush_interval_ms = interval_ms;
+    config.dirty_threshold = threshold;
+    config.journal_fsync = false;
+    return flusher_start(&config);
+}
+
+static long file_size(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fclose(f);
+    return n;
+}
+
+static bool test_flusher_deferred_writeback(void)
+{
+    ACCOUNT a;
+    ACCOUNT b;
+    if (!test_create_account(&a, 0) || !test_create_account(&b, 0)) {
+        return false;
+    }
+
+    /* 间隔和阈值都很大：只有 flusher_flush_now() 会触发写回 */
+    if (!start_journal(60000, 1000000)) {
+        return false;
+    }
+
+    bool ok = true;
+    ok &= engine_deposit(a.UUID, 500, NULL) == ACCOUNT_OK;
+    ok &= engine_transfer(a.UUID, b.UUID, 200, NULL, NULL) == ACCOUNT_OK;
+
+    /* 内存已更新，文件尚未写回 */
+    ACCOUNT mem;
+    ACCOUNT disk;
+    ok &= load_account(a.UUID, &mem) && mem.BALANCE == 300;
+    ok &= account_read_file(a.UUID, &disk) && disk.BALANCE == 0;
+    ok &= file_size(FLUSHER_JOURNAL_FILE) > 0;
+
+    FlusherStats st;
+    flusher_get_stats(&st);
+    ok &= st.dirty_backlog == 2 && st.journal_records == 3;
+
+    ok &= flusher_flush_now();
+    ok &= account_read_file(a.UUID, &disk) && disk.BALANCE == 300;
+    ok &= account_read_file(b.UUID, &disk) && disk.BALANCE == 200;
+    flusher_get_stats(&st);
+    ok &= st.dirty_backlog == 0 && st.flushes == 1 && st.accounts_flushed == 2;
+    ok &= file_size(FLUSHER_JOURNAL_FILE) == 0;
+
+    /* 脏账户销户后不会被写回复活 */
+    ACCOUNT c;
+    ok &= test_create_account(&c, 0);
+    ok &= engine_delete(c.UUID) == ACCOUNT_OK;
+    ok &= flusher_flush_now();
+    ok &= !test_card_exists(c.UUID);
+
+    ok &= engine_withdraw(a.UUID, 300, NULL) == ACCOUNT_OK;
+    ok &= engine_withdraw(b.UUID, 200, NULL) == ACCOUNT_OK;
+    cleanup_flusher();
+
+    ok &= !flusher_active();
+    ok &= account_read_file(a.UUID, &disk) && disk.BALANCE == 0;
+    ok &= file_size(FLUSHER_JOURNAL_FILE) < 0;
+
+    engine_delete(a.UUID);
+    engine_delete(b.UUID);
+    return ok;
+}
+
+static bool test_flusher_replay(void)
+{
+    ACCOUNT a;
+    ACCOUNT b;
+    if (!test_create_account(&a, 100) || !test_create_account(&b, 0)) {
+        return false;
+    }
+    if (!start_journal(60000, 1000000)) {
+        return false;
+    }
+
+    bool ok = true;
+    ok &= engine_deposit(a.UUID, 50, NULL) == ACCOUNT_OK;
+    ok &= engine_delete(b.UUID) == ACCOUNT_OK;
+
+    /* 保存“崩溃”时的日志内容 */
+    unsigned char saved[4096];
+    size_t saved_len = 0;
+    FILE *f = fopen(FLUSHER_JOURNAL_FILE, "rb");
+    if (f != NULL) {
+        saved_len = fread(saved, 1, sizeof(saved), f);
+        fclose(f);
+    }
+    ok &= saved_len == 128;
+    cleanup_flusher();
+
+    /* 模拟崩溃现场：文件仍为旧值，日志末尾有半条记录 */
+    ok &= account_write_file(&b) && account_write_file(&a);
+    f = fopen(FLUSHER_JOURNAL_FILE, "wb");
+    if (f == NULL) {
+        return false;
+    }
+    fwrite(saved, 1, saved_len, f);
+    fwrite(saved, 1, 20, f);
+    fclose(f);
+
+    ok &= flusher_replay_journal() == 2;
+
+    ACCOUNT disk;
+    ok &= account_read_file(a.UUID, &disk) && disk.BALANCE == 150;
+    ok &= !test_card_exists(b.UUID);
+    ok &= file_size(FLUSHER_JOURNAL_FILE) < 0;
+
+    engine_withdraw(a.UUID, 150, NULL);
+    engine_delete(a.UUID);
+    return ok;
+}
+
+static bool test_flusher_config(void)
+{
+    FILE *f = fopen(FLUSHER_TEST_CONF, "w");
+    if (f == NULL) {
+        return false;
+    }
+    fprintf(f, "[engine]\ndurability=journal\n\n[flusher]\n"
+               "durability = journal\nflush_interval_ms=250\ndirty_threshold=32\njournal_fsync=true\n");
+    fclose(f);
+
+    FlusherConfig config;
+    bool ok = load_flusher_config(FLUSHER_TEST_CONF, &config);
+    ok &= config.durability == FLUSHER_DURABILITY_JOURNAL;
+    ok &= config.flush_interval_ms == 250 && config.dirty_threshold == 32 && config.journal_fsync;
+    remove(FLUSHER_TEST_CONF);
+
+    ok &= !load_flusher_config("no-such-engine.conf", &config);
+    ok &= config.durability == FLUSHER_DURABILITY_SYNC;
+    return ok;
+}
+
+void register_flusher_tests(void)
+{
+    test_register(test_flusher_deferred_writeback,
+                  "flusher: deferred write-back",
+                  "journal mode updates memory + journal; flush writes sorted batch and truncates journal");
+
+    test_register(test_flusher_replay,
+                  "flusher: journal replay",
+                  "replay restores puts and deletes and stops at a torn trailing record");
+
+    test_register(test_flusher_config,
+                  "flusher: config parsing",
+                  "[flusher] section is read; missing file falls back to sync");
+}
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 
 static bool g_framework_initialized = false;
 
@@ -48,6 +49,23 @@ void test_register(TestFunc func, const char *title, const char *detail)
     g_test_count++;
 }
 
+bool test_create_account(ACCOUNT *acc, LLUINT balance)
+{
+    memset(acc, 0, sizeof(*acc));
+    generate_uuid_string(acc->UUID);
+    acc->PASSWORD = 1234567;
+    acc->BALANCE = balance;
+    return save_account(acc);
+}
+
+bool test_card_exists(const char *uuid)
+{
+    char filename[64];
+    snprintf(filename, sizeof(filename), "Card/%s.card", uuid);
+    struct stat st;
+    return stat(filename, &st) == 0;
+}
+
 static void print_banner(const char *title, const char *detail)
 {
     printf("\n====================\n");
@@ -188,6 +206,26 @@ bool test_framework_init(void)
                   "hash: insert/find/update/delete",
                   "basic CRUD on in-memory hash table");
 
+    register_amount_tests();
+    register_threadpool_tests();
+    register_engine_tests();
+    register_shard_tests();
+    register_flusher_tests();
+    register_shm_store_tests();
+    register_snapshot_tests();
+    register_async_ops_tests();
+    register_replication_tests();
+    register_tiering_tests();
+    register_compact_store_tests();
+    register_disk_index_tests();
+    register_outbox_tests();
+    register_wire_tests();
+    register_startup_tests();
+    register_breaker_tests();
+#ifdef ENABLE_NETWORK
+    register_server_api_tests();
+#endif
+
     g_framework_initialized = true;
     return true;
 }
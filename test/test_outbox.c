@@ -0,0 +1,392 @@
+#include "include/test_framework.h"
+
+#include <lib/outbox.h>
+#include <lib/platform.h>
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OUTBOX_TEST_FILE "Card/test_outbox.log"
+#define OUTBOX_TEST_MAX_CALLS 1024
+
+/* 记录发送顺序；前 g_retry_first 次返回 RETRY，之后 g_ok_limit 次以内正常，再之后一直 RETRY */
+static uint64_t g_sent_seq[OUTBOX_TEST_MAX_CALLS];
+static LLUINT g_sent_amount[OUTBOX_TEST_MAX_CALLS];
+static ApiOperation g_sent_type[OUTBOX_TEST_MAX_CALLS];
+static char g_first_op_id[OUTBOX_OP_ID_MAX + 1];
+static char g_last_op_id[OUTBOX_OP_ID_MAX + 1];
+static int g_calls;
+static atomic_int g_accepted;
+static int g_retry_first;
+static int g_ok_limit;
+
+static void reset_sender(int retry_first, int ok_limit)
+{
+    g_calls = 0;
+    atomic_store(&g_accepted, 0);
+    g_retry_first = retry_first;
+    g_ok_limit = ok_limit;
+    g_first_op_id[0] = '\0';
+}
+
+static ApiSendResult record_send(const OutboxEntry *entry, const char *op_id)
+{
+    int n = g_calls++;
+    if (n == 0) {
+        snprintf(g_first_op_id, sizeof(g_first_op_id), "%s", op_id);
+    }
+    snprintf(g_last_op_id, sizeof(g_last_op_id), "%s", op_id);
+    if (n < g_retry_first || atomic_load(&g_accepted) >= g_ok_limit) {
+        return API_SEND_RETRY;
+    }
+    int i = atomic_fetch_add(&g_accepted, 1);
+    if (i < OUTBOX_TEST_MAX_CALLS) {
+        g_sent_seq[i] = entry->seq;
+        g_sent_amount[i] = entry->amount;
+        g_sent_type[i] = entry->type;
+    }
+    /* 金额 13 模拟服务器拒绝（如余额不足） */
+    return entry->amount == 13 ? API_SEND_REJECTED : API_SEND_OK;
+}
+
+static void remove_outbox_files(void)
+{
+    remove(OUTBOX_TEST_FILE);
+    remove(OUTBOX_TEST_FILE ".ack");
+}
+
+static void test_outbox_config(OutboxConfig *config)
+{
+    load_outbox_config("/nonexistent/engine.conf", config);
+    snprintf(config->file, sizeof(config->file), "%s", OUTBOX_TEST_FILE);
+    config->fsync = false;
+    config->retry_base_ms = 1;
+    config->retry_max_ms = 4;
+    config->drain_timeout_ms = 5000;
+    config->coalesce_max = 1;
+}
+
+static bool test_outbox_ordered_retry(void)
+{
+    char a[37];
+    char b[37];
+    generate_uuid_string(a);
+    generate_uuid_string(b);
+
+    remove_outbox_files();
+    OutboxConfig config;
+    test_outbox_config(&config);
+    reset_sender(3, OUTBOX_TEST_MAX_CALLS);
+    if (!outbox_start(&config, record_send)) {
+        return false;
+    }
+
+    bool ok = true;
+    ok &= outbox_append(API_OP_CREATE, a, NULL, 0);
+    ok &= outbox_append(API_OP_DEPOSIT, a, NULL, 100);
+    ok &= outbox_append(API_OP_WITHDRAW, a, NULL, 13);
+    ok &= outbox_append(API_OP_TRANSFER, a, b, 50);
+    ok &= outbox_append(API_OP_DELETE, a, NULL, 0);
+    ok &= outbox_wait_drained(config.drain_timeout_ms);
+
+    OutboxStats st;
+    outbox_get_stats(&st);
+    ok &= st.pending == 0 && st.appended == 5 && st.sent == 4 && st.rejected == 1;
+    ok &= st.retries == 3 && st.resumed == 0;
+
+    /* 被拒绝的操作跳过，其余按追加顺序送达；重试时 op_id 不变 */
+    ok &= g_accepted == 5 && g_calls == 8;
+    for (int i = 0; i < 5 && ok; i++) {
+        ok &= g_sent_seq[i] == (uint64_t)(i + 1);
+    }
+    ok &= g_sent_type[0] == API_OP_CREATE && g_sent_type[1] == API_OP_DEPOSIT;
+    ok &= g_sent_type[2] == API_OP_WITHDRAW && g_sent_amount[2] == 13;
+    ok &= g_sent_type[3] == API_OP_TRANSFER && g_sent_amount[3] == 50;
+    ok &= g_sent_type[4] == API_OP_DELETE;
+    size_t len = strlen(g_first_op_id);
+    ok &= len == 38 && strcmp(g_first_op_id + 36, "-1") == 0;
+    ok &= strncmp(g_first_op_id, g_last_op_id, 37) == 0 && strcmp(g_last_op_id + 37, "5") == 0;
+
+    cleanup_outbox();
+    ok &= !outbox_active() && !outbox_append(API_OP_DEPOSIT, a, NULL, 1);
+
+    remove_outbox_files();
+    return ok;
+}
+
+static bool wait_accepted(int n)
+{
+    for (int i = 0; i < 5000 && atomic_load(&g_accepted) < n; i++) {
+        platform_sleep_ms(1);
+    }
+    return atomic_load(&g_accepted) >= n;
+}
+
+static bool test_outbox_paused(void)
+{
+    char a[37];
+    generate_uuid_string(a);
+
+    remove_outbox_files();
+    OutboxConfig config;
+    test_outbox_config(&config);
+    reset_sender(0, OUTBOX_TEST_MAX_CALLS);
+    if (!outbox_start(&config, record_send)) {
+        return false;
+    }
+
+    /* 暂停期间追加的操作留在队列中，恢复后按顺序送达 */
+    outbox_set_paused(true);
+    bool ok = outbox_append(API_OP_DEPOSIT, a, NULL, 100);
+    ok &= outbox_append(API_OP_WITHDRAW, a, NULL, 40);
+    platform_sleep_ms(30);
+    OutboxStats st;
+    outbox_get_stats(&st);
+    ok &= g_calls == 0 && st.pending == 2;
+
+    outbox_set_paused(false);
+    ok &= outbox_wait_drained(config.drain_timeout_ms);
+    ok &= g_accepted == 2 && g_sent_amount[0] == 100 && g_sent_amount[1] == 40;
+
+    /* 退出时暂停中的队列照常发完 */
+    outbox_set_paused(true);
+    ok &= outbox_append(API_OP_DEPOSIT, a, NULL, 7);
+    cleanup_outbox();
+    ok &= g_accepted == 3 && g_sent_amount[2] == 7;
+
+    remove_outbox_files();
+    return ok;
+}
+
+static bool test_outbox_resume(void)
+{
+    char a[37];
+    generate_uuid_string(a);
+
+    remove_outbox_files();
+    OutboxConfig config;
+    test_outbox_config(&config);
+
+    /* 第一次运行：送达3条后服务器不可用，退出时不等待，剩余7条留在文件中 */
+    OutboxConfig offline = config;
+    offline.drain_timeout_ms = 0;
+    reset_sender(0, 3);
+    if (!outbox_start(&offline, record_send)) {
+        return false;
+    }
+    bool ok = true;
+    for (int i = 1; i <= 10; i++) {
+        ok &= outbox_append(API_OP_DEPOSIT, a, NULL, (LLUINT)i);
+    }
+    ok &= wait_accepted(3);
+    platform_sleep_ms(10);
+    OutboxStats st;
+    outbox_get_stats(&st);
+    ok &= st.sent == 3 && st.pending == 7;
+    /* 操作ID为 <队列ID>-<序号>，只保留前36个字符的队列ID */
+    char queue_id[37];
+    ok &= strlen(g_first_op_id) > 36;
+    memcpy(queue_id, g_first_op_id, 36);
+    queue_id[36] = '\0';
+    cleanup_outbox();
+
+    /* 模拟崩溃时写了一半的记录 */
+    FILE *f = fopen(OUTBOX_TEST_FILE, "ab");
+    if (f == NULL) {
+        return false;
+    }
+    unsigned char torn[50];
+    memset(torn, 0xAB, sizeof(torn));
+    fwrite(torn, 1, sizeof(torn), f);
+    fclose(f);
+
+    /* 重启：同一队列标识下从第4条继续，半条记录被丢弃 */
+    reset_sender(0, OUTBOX_TEST_MAX_CALLS);
+    if (!outbox_start(&config, record_send)) {
+        return false;
+    }
+    ok &= outbox_wait_drained(config.drain_timeout_ms);
+    outbox_get_stats(&st);
+    ok &= st.resumed == 7 && st.sent == 7 && st.pending == 0;
+    ok &= g_accepted == 7 && strncmp(g_first_op_id, queue_id, 36) == 0;
+    for (int i = 0; i < 7 && ok; i++) {
+        ok &= g_sent_seq[i] == (uint64_t)(i + 4) && g_sent_amount[i] == (LLUINT)(i + 4);
+    }
+
+    /* 新追加的序号接着上次的继续；积压超过截断阈值后清空文件，序号不回退 */
+    int batch = 700;
+    for (int i = 0; i < batch; i++) {
+        ok &= outbox_append(API_OP_DEPOSIT, a, NULL, 1);
+    }
+    ok &= outbox_wait_drained(config.drain_timeout_ms);
+    outbox_get_stats(&st);
+    ok &= g_sent_seq[7] == 11 && g_sent_seq[7 + batch - 1] == (uint64_t)(10 + batch);
+    ok &= st.compactions >= 1 && st.pending == 0;
+    cleanup_outbox();
+
+    reset_sender(0, OUTBOX_TEST_MAX_CALLS);
+    if (!outbox_start(&config, record_send)) {
+        return false;
+    }
+    ok &= outbox_append(API_OP_DELETE, a, NULL, 0);
+    ok &= outbox_wait_drained(config.drain_timeout_ms);
+    outbox_get_stats(&st);
+    ok &= st.resumed == 0 && g_accepted == 1 && g_sent_seq[0] == (uint64_t)(11 + batch);
+    cleanup_outbox();
+
+    remove_outbox_files();
+    return ok;
+}
+
+/* 合并测试：第一次发送阻塞到放行，期间追加的记录积压成一批 */
+#define COALESCE_TEST_MAX 32
+
+static OutboxEntry g_gate_entries[COALESCE_TEST_MAX];
+static char g_gate_op_ids[COALESCE_TEST_MAX][OUTBOX_OP_ID_MAX + 1];
+static atomic_int g_gate_calls;
+static atomic_bool g_gate_open;
+static atomic_bool g_gate_offline;
+
+static void reset_gate(bool open, bool offline)
+{
+    atomic_store(&g_gate_calls, 0);
+    atomic_store(&g_gate_open, open);
+    atomic_store(&g_gate_offline, offline);
+}
+
+static ApiSendResult gated_send(const OutboxEntry *entry, const char *op_id)
+{
+    int n = atomic_fetch_add(&g_gate_calls, 1);
+    for (int i = 0; i < 5000 && !atomic_load(&g_gate_open); i++) {
+        platform_sleep_ms(1);
+    }
+    if (atomic_load(&g_gate_offline)) {
+        return API_SEND_RETRY;
+    }
+    if (n < COALESCE_TEST_MAX) {
+        g_gate_entries[n] = *entry;
+        snprintf(g_gate_op_ids[n], sizeof(g_gate_op_ids[n]), "%s", op_id);
+    }
+    return API_SEND_OK;
+}
+
+static bool gate_sent(int i, ApiOperation type, const char *uuid, LLUINT amount)
+{
+    return g_gate_entries[i].type == type && strcmp(g_gate_entries[i].uuid, uuid) == 0
+        && g_gate_entries[i].amount == amount;
+}
+
+static bool wait_gate_calls(int n)
+{
+    for (int i = 0; i < 5000 && atomic_load(&g_gate_calls) < n; i++) {
+        platform_sleep_ms(1);
+    }
+    return atomic_load(&g_gate_calls) >= n;
+}
+
+static bool test_outbox_coalesce(void)
+{
+    char a[37];
+    char b[37];
+    char c[37];
+    char d[37];
+    generate_uuid_string(a);
+    generate_uuid_string(b);
+    generate_uuid_string(c);
+    generate_uuid_string(d);
+
+    remove_outbox_files();
+    OutboxConfig config;
+    test_outbox_config(&config);
+    config.coalesce_max = 64;
+    reset_gate(false, false);
+    if (!outbox_start(&config, gated_send)) {
+        return false;
+    }
+
+    bool ok = outbox_append(API_OP_DEPOSIT, a, NULL, 5);
+    ok &= wait_gate_calls(1);
+    ok &= outbox_append(API_OP_DEPOSIT, a, NULL, 10);      /* 2 */
+    ok &= outbox_append(API_OP_DEPOSIT, b, NULL, 7);       /* 3 */
+    ok &= outbox_append(API_OP_WITHDRAW, a, NULL, 3);      /* 4 */
+    ok &= outbox_append(API_OP_DEPOSIT, a, NULL, 1);       /* 5 */
+    ok &= outbox_append(API_OP_TRANSFER, a, b, 4);         /* 6：a、b 的分界 */
+    ok &= outbox_append(API_OP_DEPOSIT, a, NULL, 2);       /* 7 */
+    ok &= outbox_append(API_OP_WITHDRAW, b, NULL, 7);      /* 8 */
+    ok &= outbox_append(API_OP_DEPOSIT, b, NULL, 7);       /* 9：与8抵消 */
+    ok &= outbox_append(API_OP_DEPOSIT, c, NULL, 9);       /* 10 */
+    ok &= outbox_append(API_OP_CREATE, d, NULL, 100);      /* 11 */
+    ok &= outbox_append(API_OP_DEPOSIT, d, NULL, 1);       /* 12 */
+    atomic_store(&g_gate_open, true);
+    ok &= outbox_wait_drained(config.drain_timeout_ms);
+
+    OutboxStats st;
+    outbox_get_stats(&st);
+    ok &= st.pending == 0 && st.sent == 12 && st.rejected == 0;
+    ok &= st.requests == 8 && st.coalesced == 4;
+
+    /* 同一账户的存取款按净额在该账户第一条的位置发送，不跨过转账与创建 */
+    ok &= atomic_load(&g_gate_calls) == 8;
+    ok &= gate_sent(0, API_OP_DEPOSIT, a, 5);
+    ok &= gate_sent(1, API_OP_DEPOSIT, a, 8) && g_gate_entries[1].seq == 2;
+    ok &= gate_sent(2, API_OP_DEPOSIT, b, 7);
+    ok &= gate_sent(3, API_OP_TRANSFER, a, 4) && strcmp(g_gate_entries[3].uuid_to, b) == 0;
+    ok &= gate_sent(4, API_OP_DEPOSIT, a, 2);
+    ok &= gate_sent(5, API_OP_DEPOSIT, c, 9);
+    ok &= gate_sent(6, API_OP_CREATE, d, 100);
+    ok &= gate_sent(7, API_OP_DEPOSIT, d, 1);
+    ok &= strcmp(g_gate_op_ids[0] + 36, "-1") == 0;
+    ok &= strcmp(g_gate_op_ids[1] + 36, "-12.0") == 0 && strcmp(g_gate_op_ids[7] + 36, "-12.6") == 0;
+    cleanup_outbox();
+
+    /* 已开始发送的批次范围写入状态文件：重启后第1条仍单独发送，op_id 不变 */
+    OutboxConfig offline = config;
+    offline.drain_timeout_ms = 0;
+    remove_outbox_files();
+    reset_gate(true, true);
+    if (!outbox_start(&offline, gated_send)) {
+        return false;
+    }
+    ok &= outbox_append(API_OP_DEPOSIT, a, NULL, 1);
+    ok &= wait_gate_calls(1);
+    for (int i = 2; i <= 5; i++) {
+        ok &= outbox_append(API_OP_WITHDRAW, a, NULL, (LLUINT)i);
+    }
+    cleanup_outbox();
+
+    reset_gate(true, false);
+    if (!outbox_start(&config, gated_send)) {
+        return false;
+    }
+    ok &= outbox_wait_drained(config.drain_timeout_ms);
+    outbox_get_stats(&st);
+    ok &= st.resumed == 5 && st.sent == 5 && st.requests == 2;
+    ok &= atomic_load(&g_gate_calls) == 2;
+    ok &= gate_sent(0, API_OP_DEPOSIT, a, 1) && strcmp(g_gate_op_ids[0] + 36, "-1") == 0;
+    ok &= gate_sent(1, API_OP_WITHDRAW, a, 14) && strcmp(g_gate_op_ids[1] + 36, "-5.0") == 0;
+    cleanup_outbox();
+
+    remove_outbox_files();
+    return ok;
+}
+
+void register_outbox_tests(void)
+{
+    test_register(test_outbox_ordered_retry,
+                  "outbox: ordered delivery with retries",
+                  "transient failures back off and retry the same op_id; rejected ops are skipped");
+
+    test_register(test_outbox_paused,
+                  "outbox: paused sender",
+                  "ops appended while paused stay queued and are delivered in order once resumed");
+
+    test_register(test_outbox_resume,
+                  "outbox: resume after restart",
+                  "unsent ops survive a restart and a torn tail; sequence numbers never repeat");
+
+    test_register(test_outbox_coalesce,
+                  "outbox: coalescing per account",
+                  "backlogged deposits/withdrawals merge into net amounts without crossing transfers");
+}
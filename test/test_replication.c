@@ -0,0 +1,244 @@
+#include "include/test_framework.h"
+
+#include <lib/replication.h>
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef struct {
+    char uuid[37];
+    LLUINT balance;
+    int exists;
+} ExpectedAccount;
+
+static void make_config(ReplicationConfig *config, ReplicationRole role, const char *address)
+{
+    memset(config, 0, sizeof(*config));
+    config->role = role;
+    snprintf(config->address, sizeof(config->address), "%s", address);
+    config->ack = REPLICATION_ACK_SYNC;
+    config->sync_timeout_ms = 5000;
+    config->backlog = 1024;
+}
+
+static void remove_dir_cards(void)
+{
+    ACCOUNT accounts[64];
+    size_t n = account_collect_all(accounts, 64, NULL);
+    for (size_t i = 0; i < n; i++) {
+        account_apply_remove(accounts[i].UUID);
+    }
+}
+
+/**
+ * @brief 备节点进程：在独立目录跟随主节点，核对父进程给出的期望状态后提升
+ */
+static int follower_child(const char *dir, const char *address, const char *promote_address,
+                          int expect_fd)
+{
+    cleanup_account_system();
+    if (mkdir(dir, 0700) != 0 || chdir(dir) != 0 || !init_account_system()) {
+        return 1;
+    }
+
+    ReplicationConfig config;
+    make_config(&config, REPLICATION_ROLE_FOLLOWER, address);
+    snprintf(config.promote_address, sizeof(config.promote_address), "%s", promote_address);
+    if (!replication_start(&config)) {
+        return 2;
+    }
+
+    ExpectedAccount expected[3];
+    size_t got = 0;
+    while (got < sizeof(expected)) {
+        ssize_t n = read(expect_fd, (char *)expected + got, sizeof(expected) - got);
+        if (n <= 0) {
+            return 3;
+        }
+        got += (size_t)n;
+    }
+
+    int rc = 0;
+    for (int i = 0; i < 3; i++) {
+        ACCOUNT acc;
+        bool exists = load_account(expected[i].uuid, &acc);
+        if (exists != (expected[i].exists != 0) || (exists && acc.BALANCE != expected[i].balance)) {
+            rc = 4;
+        }
+    }
+
+    /* 备节点只读，提升后可写并以主节点身份监听 */
+    if (engine_deposit(expected[0].uuid, 1, NULL) != ACCOUNT_ERR_READ_ONLY) {
+        rc = 5;
+    }
+    if (!replication_promote() || replication_role() != REPLICATION_ROLE_PRIMARY) {
+        rc = 6;
+    }
+    if (engine_deposit(expected[0].uuid, 1, NULL) != ACCOUNT_OK) {
+        rc = 7;
+    }
+
+    cleanup_replication();
+    remove_dir_cards();
+    cleanup_account_system();
+    unlink("system.key");
+    rmdir("Card");
+    if (chdir("..") != 0 || rmdir(dir) != 0) {
+        rc = rc ? rc : 8;
+    }
+    return rc;
+}
+
+static bool wait_caught_up(unsigned int timeout_ms)
+{
+    for (unsigned int waited = 0; waited < timeout_ms; waited += 10) {
+        ReplicationStats st;
+        replication_get_stats(&st);
+        if (st.connected && st.resyncs > 0 && st.acked_seq == st.last_seq) {
+            return true;
+        }
+        platform_sleep_ms(10);
+    }
+    return false;
+}
+
+/**
+ * @brief sync 模式的保证：操作返回时备节点已确认到最新序号
+ */
+static bool follower_acked(void)
+{
+    ReplicationStats st;
+    replication_get_stats(&st);
+    return st.acked_seq >= st.last_seq;
+}
+
+static bool test_replication_sync_follower(void)
+{
+    char dir[64];
+    char address[64];
+    char promote_address[64];
+    snprintf(dir, sizeof(dir), "repl-follower-%ld", (long)getpid());
+    snprintf(address, sizeof(address), "unix:/tmp/bamsystem-repl-test-%ld.sock", (long)getpid());
+    snprintf(promote_address, sizeof(promote_address), "unix:/tmp/bamsystem-repl-test-%ld-2.sock",
+             (long)getpid());
+
+    /* 已存在的账户通过全量同步到达备节点 */
+    ACCOUNT a;
+    if (!test_create_account(&a, 100)) {
+        return false;
+    }
+
+    int pipefd[2];
+    if (pipe(pipefd) != 0) {
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(pipefd[1]);
+        _exit(follower_child(dir, address, promote_address, pipefd[0]));
+    }
+    close(pipefd[0]);
+
+    ReplicationConfig config;
+    make_config(&config, REPLICATION_ROLE_PRIMARY, address);
+    bool ok = replication_start(&config);
+    ok &= wait_caught_up(5000);
+
+    /* sync 模式：每个操作返回时备节点已确认 */
+    ACCOUNT b;
+    ACCOUNT c;
+    ok &= engine_deposit(a.UUID, 50, NULL) == ACCOUNT_OK && follower_acked();
+    ok &= test_create_account(&b, 0);
+    ok &= engine_transfer(a.UUID, b.UUID, 30, NULL, NULL) == ACCOUNT_OK && follower_acked();
+    ok &= test_create_account(&c, 0);
+    ok &= engine_delete(c.UUID) == ACCOUNT_OK && follower_acked();
+
+    ReplicationStats st;
+    replication_get_stats(&st);
+    ok &= st.role == REPLICATION_ROLE_PRIMARY && st.lag_ops == 0 && st.acked_seq == st.last_seq;
+    /* 备节点确认可能先于 replication_wait_commit() 到达，sync_waits 可以为0，
+     * 等待是否生效由上面每个操作返回后的 follower_acked() 检查 */
+    ok &= st.sync_timeouts == 0 && st.resyncs == 1;
+
+    ExpectedAccount expected[3];
+    memset(expected, 0, sizeof(expected));
+    memcpy(expected[0].uuid, a.UUID, 37);
+    expected[0].balance = 120;
+    expected[0].exists = 1;
+    memcpy(expected[1].uuid, b.UUID, 37);
+    expected[1].balance = 30;
+    expected[1].exists = 1;
+    memcpy(expected[2].uuid, c.UUID, 37);
+    ok &= write(pipefd[1], expected, sizeof(expected)) == (ssize_t)sizeof(expected);
+    close(pipefd[1]);
+
+    int status = 0;
+    ok &= waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    /* 备节点断开后 sync 模式不再等待 */
+    platform_sleep_ms(300);
+    ok &= engine_withdraw(b.UUID, 30, NULL) == ACCOUNT_OK;
+    replication_get_stats(&st);
+    ok &= !st.connected && st.sync_timeouts == 1;
+
+    cleanup_replication();
+    ok &= replication_role() == REPLICATION_ROLE_NONE;
+
+    engine_withdraw(a.UUID, 120, NULL);
+    engine_delete(a.UUID);
+    engine_delete(b.UUID);
+    return ok;
+}
+
+static bool test_replication_follower_read_only(void)
+{
+    ReplicationConfig config;
+    bool found = load_replication_config("no-such-engine.conf", &config);
+    bool ok = !found && config.role == REPLICATION_ROLE_NONE && config.ack == REPLICATION_ACK_ASYNC;
+
+    ACCOUNT a;
+    if (!test_create_account(&a, 10)) {
+        return false;
+    }
+
+    /* 主节点不存在时备节点持续重连，期间保持只读 */
+    make_config(&config, REPLICATION_ROLE_FOLLOWER, "unix:/tmp/bamsystem-repl-test-none.sock");
+    ok &= replication_start(&config);
+    ok &= replication_is_follower();
+    ok &= engine_withdraw(a.UUID, 10, NULL) == ACCOUNT_ERR_READ_ONLY;
+    ok &= engine_delete(a.UUID) == ACCOUNT_ERR_READ_ONLY;
+
+    /* 未配置 promote_address：提升后独立运行 */
+    ok &= replication_promote();
+    ok &= replication_role() == REPLICATION_ROLE_NONE && !replication_is_follower();
+    ok &= engine_withdraw(a.UUID, 10, NULL) == ACCOUNT_OK;
+    ok &= engine_delete(a.UUID) == ACCOUNT_OK;
+    cleanup_replication();
+    return ok;
+}
+
+void register_replication_tests(void)
+{
+    test_register(test_replication_sync_follower,
+                  "replication: sync follower and promotion",
+                  "forked follower resyncs, applies acked ops, then is promoted to primary");
+
+    test_register(test_replication_follower_read_only,
+                  "replication: follower is read-only",
+                  "writes rejected while following; promotion without address accepts writes");
+}
+
+#else
+
+void register_replication_tests(void)
+{
+}
+
+#endif /* _WIN32 */
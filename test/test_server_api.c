@@ -0,0 +1,184 @@
+#include "include/test_framework.h"
+#include "include/mock_server.h"
+
+#include <lib/account.h>
+#include <lib/platform.h>
+#include <lib/server_api.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MOCK_CONFIG "server.conf"
+#define PUSH_COUNT 250
+
+/**
+ * @brief 启动模拟服务器并让本模块连上它
+ */
+static bool mock_setup(void)
+{
+    if (!mock_server_start(1)) {
+        return false;
+    }
+    if (!mock_server_write_config(MOCK_CONFIG, NULL) || !init_server_api() ||
+        check_server_availability() != MODE_SERVER) {
+        cleanup_server_api();
+        mock_server_stop();
+        remove(MOCK_CONFIG);
+        return false;
+    }
+    return true;
+}
+
+static void mock_teardown(void)
+{
+    set_run_mode(MODE_LOCAL);
+    cleanup_server_api();
+    mock_server_stop();
+    remove(MOCK_CONFIG);
+}
+
+static void make_uuid(char *uuid, unsigned n)
+{
+    snprintf(uuid, 37, "00000000-0000-4000-8000-%012u", n);
+}
+
+static bool test_server_api_push(void)
+{
+    if (!mock_setup()) {
+        return false;
+    }
+    ACCOUNT *accounts = calloc(PUSH_COUNT, sizeof(ACCOUNT));
+    bool *item_ok = calloc(PUSH_COUNT, sizeof(bool));
+    bool ok = accounts != NULL && item_ok != NULL;
+    for (unsigned i = 0; ok && i < PUSH_COUNT; i++) {
+        make_uuid(accounts[i].UUID, i);
+        accounts[i].BALANCE = (LLUINT)i * 100;
+    }
+
+    /* 第一个请求返回 503：重试后全部成功；100 个账户的请求体超过 compress_min_bytes，按 gzip 发送 */
+    MockStats ms;
+    SyncBatchStats st;
+    if (ok) {
+        mock_server_reset_stats();
+        mock_server_fail_next(1);
+        ok &= api_sync_accounts(accounts, PUSH_COUNT, item_ok, NULL, NULL, &st) == PUSH_COUNT;
+        for (unsigned i = 0; i < PUSH_COUNT; i++) {
+            ok &= item_ok[i];
+        }
+        mock_server_get_stats(&ms);
+        ok &= st.succeeded == PUSH_COUNT && st.failed == 0 && st.retries >= 1 && st.batch_size == 100;
+        ok &= ms.failed == 1 && ms.batch_accounts == PUSH_COUNT && ms.gzip_bodies > 0;
+        ok &= st.requests == ms.batch_requests + ms.failed;
+    }
+
+    free(item_ok);
+    free(accounts);
+    mock_teardown();
+    return ok;
+}
+
+typedef struct {
+    size_t count;
+    ACCOUNT accounts[8];
+} PulledAccounts;
+
+static bool collect_page(const ACCOUNT *accounts, size_t count, void *user)
+{
+    PulledAccounts *pulled = user;
+    for (size_t i = 0; i < count && pulled->count < 8; i++) {
+        pulled->accounts[pulled->count++] = accounts[i];
+    }
+    return true;
+}
+
+static bool test_server_api_pull(void)
+{
+    if (!mock_setup()) {
+        return false;
+    }
+
+    /* 余额超过 2^53 的以字符串给出；负数、小数与非数字的余额跳过，不影响其余账户 */
+    char uuid[5][37];
+    for (unsigned i = 0; i < 5; i++) {
+        make_uuid(uuid[i], i);
+    }
+    char json[1024];
+    snprintf(json, sizeof(json),
+             "{\"success\":true,\"watermark\":1700000000,\"accounts\":["
+             "{\"uuid\":\"%s\",\"balance\":12345},"
+             "{\"uuid\":\"%s\",\"balance\":\"90071992547409931\"},"
+             "{\"uuid\":\"%s\",\"balance\":-5},"
+             "{\"uuid\":\"%s\",\"balance\":1.5},"
+             "{\"uuid\":\"%s\",\"balance\":\"12x\"}]}",
+             uuid[0], uuid[1], uuid[2], uuid[3], uuid[4]);
+    mock_server_set_accounts(json);
+
+    PulledAccounts pulled;
+    memset(&pulled, 0, sizeof(pulled));
+    int64_t watermark = 0;
+    bool ok = api_pull_accounts(0, collect_page, &pulled, &watermark) == 2;
+    ok &= watermark == 1700000000 && pulled.count == 2;
+    ok &= strcmp(pulled.accounts[0].UUID, uuid[0]) == 0 && pulled.accounts[0].BALANCE == 12345;
+    ok &= strcmp(pulled.accounts[1].UUID, uuid[1]) == 0 &&
+          pulled.accounts[1].BALANCE == 90071992547409931ull;
+
+    mock_teardown();
+    return ok;
+}
+
+static bool test_server_api_breaker(void)
+{
+    if (!mock_setup()) {
+        return false;
+    }
+    char uuid[37];
+    make_uuid(uuid, 1);
+    bool ok = true;
+
+    /* 预热：样本足够后超时按延迟 p99 收紧到下限 */
+    for (int i = 0; i < 25; i++) {
+        ok &= api_send_operation(API_OP_DEPOSIT, "warm", uuid, NULL, 100) == API_SEND_OK;
+    }
+    ServerApiStats stats;
+    server_api_get_stats(&stats);
+    ok &= stats.breaker.state == BREAKER_CLOSED && stats.breaker.timeout_ms < 2000;
+
+    /* 服务器卡死：窗口内错误率达到 50% 后断开，其余请求直接失败，不再各等一个超时 */
+    mock_server_set_mode(MOCK_HANG);
+    uint64_t start = platform_monotonic_ns();
+    for (int i = 0; i < 20; i++) {
+        ok &= api_send_operation(API_OP_DEPOSIT, "hang", uuid, NULL, 100) == API_SEND_RETRY;
+    }
+    uint64_t elapsed_ms = (platform_monotonic_ns() - start) / 1000000;
+    server_api_get_stats(&stats);
+    ok &= elapsed_ms < 10 * 1000 && stats.breaker.state == BREAKER_OPEN && stats.breaker.rejected > 0;
+
+    /* 服务器恢复：到时放行探测，探测成功后闭合 */
+    mock_server_set_mode(MOCK_OK);
+    bool recovered = false;
+    for (int i = 0; i < 50 && !recovered; i++) {
+        platform_sleep_ms(100);
+        recovered = api_send_operation(API_OP_DEPOSIT, "probe", uuid, NULL, 100) == API_SEND_OK;
+    }
+    server_api_get_stats(&stats);
+    ok &= recovered && stats.breaker.state == BREAKER_CLOSED;
+
+    mock_teardown();
+    return ok;
+}
+
+void register_server_api_tests(void)
+{
+    test_register(test_server_api_push,
+                  "server_api: batched push against the mock server",
+                  "gzip batch bodies, a 503 is retried, every account acknowledged once");
+
+    test_register(test_server_api_pull,
+                  "server_api: paged pull against the mock server",
+                  "exact balances above 2^53, invalid balances skipped, watermark from the first page");
+
+    test_register(test_server_api_breaker,
+                  "server_api: breaker against a hung server",
+                  "trips after half the window times out, fails fast while open, a probe closes it");
+}
@@ -0,0 +1,254 @@
+#include "include/test_framework.h"
+
+#include <lib/shard.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SHARD_TEST_ACCOUNTS 16
+#define SHARD_TEST_THREADS 8
+#define SHARD_TEST_TRANSFERS 300
+#define SHARD_TEST_BALANCE 1000
+
+typedef struct {
+    char (*uuids)[37];
+    unsigned int seed;
+} TransferArg;
+
+static bool start_shards(size_t shards)
+{
+    EngineConfig config;
+    config.mode = ENGINE_MODE_SHARDED;
+    config.queue_capacity = 16;
+    config.max_batch = 8;
+    config.shards = shards;
+    config.pin_threads = true;
+    return engine_start(&config);
+}
+
+static void transfer_worker(void *arg)
+{
+    TransferArg *t = (TransferArg *)arg;
+    unsigned int rng = t->seed;
+    for (int i = 0; i < SHARD_TEST_TRANSFERS; i++) {
+        rng = rng * 1103515245u + 12345u;
+        int from = (int)((rng >> 8) % SHARD_TEST_ACCOUNTS);
+        rng = rng * 1103515245u + 12345u;
+        int to = (int)((rng >> 8) % SHARD_TEST_ACCOUNTS);
+        /* 金额可能超过余额，覆盖回滚路径 */
+        LLUINT amount = 1 + (rng >> 4) % 400;
+        engine_transfer(t->uuids[from], t->uuids[to], amount, NULL, NULL);
+    }
+}
+
+static LLUINT sum_balances(char (*uuids)[37])
+{
+    LLUINT total = 0;
+    for (int i = 0; i < SHARD_TEST_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (!load_account(uuids[i], &acc)) {
+            return 0;
+        }
+        total += acc.BALANCE;
+    }
+    return total;
+}
+
+static bool test_shard_transfers_conserve_money(void)
+{
+    char uuids[SHARD_TEST_ACCOUNTS][37];
+    for (int i = 0; i < SHARD_TEST_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        memset(&acc, 0, sizeof(acc));
+        generate_uuid_string(acc.UUID);
+        acc.PASSWORD = 1234567;
+        acc.BALANCE = SHARD_TEST_BALANCE;
+        if (!save_account(&acc)) {
+            return false;
+        }
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    if (!start_shards(4)) {
+        return false;
+    }
+
+    PlatformThread threads[SHARD_TEST_THREADS];
+    TransferArg args[SHARD_TEST_THREADS];
+    for (int i = 0; i < SHARD_TEST_THREADS; i++) {
+        args[i].uuids = uuids;
+        args[i].seed = 7919u * (unsigned int)(i + 1);
+        platform_thread_create(&threads[i], transfer_worker, &args[i]);
+    }
+    for (int i = 0; i < SHARD_TEST_THREADS; i++) {
+        platform_thread_join(threads[i]);
+    }
+
+    const LLUINT expected = (LLUINT)SHARD_TEST_ACCOUNTS * SHARD_TEST_BALANCE;
+    bool ok = sum_balances(uuids) == expected;
+
+    size_t committed = 0;
+    shard_get_transfer_stats(&committed, NULL);
+    ok &= committed > 0;
+
+    cleanup_engine();
+
+    /* 停止后全局缓存已清空，这里读到的是文件中的余额 */
+    ok &= !shard_engine_running();
+    ok &= sum_balances(uuids) == expected;
+
+    for (int i = 0; i < SHARD_TEST_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (load_account(uuids[i], &acc) && acc.BALANCE > 0) {
+            account_apply_withdraw(uuids[i], acc.BALANCE, NULL);
+        }
+        account_apply_delete(uuids[i]);
+    }
+    return ok;
+}
+
+static bool test_shard_routes_generic_access(void)
+{
+    if (!start_shards(3)) {
+        return false;
+    }
+
+    ACCOUNT a;
+    ACCOUNT b;
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    generate_uuid_string(a.UUID);
+    a.PASSWORD = 1111111;
+    a.BALANCE = 50;
+    generate_uuid_string(b.UUID);
+    b.PASSWORD = 2222222;
+
+    /* 运行期间 save/load/delete 都由所属分片处理 */
+    bool ok = save_account(&a) && save_account(&b);
+    ACCOUNT loaded;
+    ok &= load_account(a.UUID, &loaded) && loaded.BALANCE == 50 && loaded.PASSWORD == 1111111;
+    ok &= engine_delete(a.UUID) == ACCOUNT_ERR_HAS_BALANCE;
+
+    ACCOUNT out_a;
+    ACCOUNT out_b;
+    ok &= engine_transfer(a.UUID, b.UUID, 50, &out_a, &out_b) == ACCOUNT_OK;
+    ok &= out_a.BALANCE == 0 && out_b.BALANCE == 50;
+
+    /* 目标账户不存在且在其他分片：入账失败，源分片回滚 */
+    char missing[37];
+    do {
+        generate_uuid_string(missing);
+    } while (shard_index_of(missing) == shard_index_of(b.UUID));
+    size_t aborted = 0;
+    ok &= engine_transfer(b.UUID, missing, 20, NULL, NULL) == ACCOUNT_ERR_NOT_FOUND;
+    shard_get_transfer_stats(NULL, &aborted);
+    ok &= aborted == 1;
+    ok &= load_account(b.UUID, &loaded) && loaded.BALANCE == 50;
+    ok &= engine_withdraw(b.UUID, 50, NULL) == ACCOUNT_OK;
+    ok &= engine_transfer(a.UUID, b.UUID, 1, NULL, NULL) == ACCOUNT_ERR_INSUFFICIENT;
+    ok &= engine_delete(a.UUID) == ACCOUNT_OK;
+    ok &= !load_account(a.UUID, &loaded);
+    ok &= delete_account_file(b.UUID);
+
+    cleanup_engine();
+    ok &= !load_account(b.UUID, &loaded);
+    return ok;
+}
+
+#ifndef _WIN32
+static bool test_shard_transfer_write_failure(void)
+{
+    if (!start_shards(2)) {
+        return false;
+    }
+
+    ACCOUNT a;
+    ACCOUNT b;
+    bool ok = test_create_account(&a, 1000);
+    memset(&b, 0, sizeof(b));
+    do {
+        generate_uuid_string(b.UUID);
+    } while (shard_index_of(b.UUID) == shard_index_of(a.UUID));
+    b.PASSWORD = 1234567;
+    b.BALANCE = 1000;
+    ok &= save_account(&b);
+
+    /* 目标账户文件换成同名目录：入账写文件失败，两边都要撤销 */
+    char path[64];
+    snprintf(path, sizeof(path), "Card/%s.card", b.UUID);
+    ok &= remove(path) == 0 && mkdir(path, 0700) == 0;
+    ok &= engine_transfer(a.UUID, b.UUID, 300, NULL, NULL) == ACCOUNT_ERR_IO;
+
+    ACCOUNT la;
+    ACCOUNT lb;
+    ok &= load_account(a.UUID, &la) && la.BALANCE == 1000;
+    ok &= load_account(b.UUID, &lb) && lb.BALANCE == 1000;
+    cleanup_engine();
+
+    /* 目标账户文件没能重写，停止时保留日志；目录移走后重启回放出原余额 */
+    ok &= rmdir(path) == 0;
+    ok &= start_shards(2);
+    ok &= load_account(a.UUID, &la) && la.BALANCE == 1000;
+    ok &= load_account(b.UUID, &lb) && lb.BALANCE == 1000;
+    ok &= engine_transfer(a.UUID, b.UUID, 300, NULL, NULL) == ACCOUNT_OK;
+    cleanup_engine();
+
+    ok &= load_account(a.UUID, &la) && la.BALANCE == 700;
+    ok &= load_account(b.UUID, &lb) && lb.BALANCE == 1300;
+    struct stat st;
+    ok &= stat("Card/shard-0.log", &st) != 0 && stat("Card/shard-1.log", &st) != 0;
+    delete_account_file(a.UUID);
+    delete_account_file(b.UUID);
+    return ok;
+}
+#endif
+
+static bool test_shard_hash_distribution(void)
+{
+    if (!start_shards(4)) {
+        return false;
+    }
+
+    size_t counts[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4000; i++) {
+        char uuid[37];
+        generate_uuid_string(uuid);
+        counts[shard_index_of(uuid)]++;
+    }
+    cleanup_engine();
+
+    for (int i = 0; i < 4; i++) {
+        if (counts[i] < 800 || counts[i] > 1200) {
+            fprintf(stderr, "shard %d got %zu of 4000\n", i, counts[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void register_shard_tests(void)
+{
+    test_register(test_shard_transfers_conserve_money,
+                  "shard: concurrent transfers conserve money",
+                  "8 threads of random same/cross-shard transfers; totals match in memory and on disk");
+
+    test_register(test_shard_routes_generic_access,
+                  "shard: save/load/delete routing",
+                  "generic account access goes through the owning shard while running");
+
+#ifndef _WIN32
+    test_register(test_shard_transfer_write_failure,
+                  "shard: cross-shard transfer with a failing destination write",
+                  "both legs are undone, total balance unchanged in memory and after a restart replays the log");
+#endif
+
+    test_register(test_shard_hash_distribution,
+                  "shard: uuid distribution",
+                  "FNV-1a routing spreads random UUIDs evenly over 4 shards");
+}
@@ -0,0 +1,188 @@
+#include "include/test_framework.h"
+
+#include <lib/shm_store.h>
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define SHM_TEST_ACCOUNTS 8
+#define SHM_TEST_PROCS 4
+#define SHM_TEST_TRANSFERS 200
+#define SHM_TEST_BALANCE 1000
+
+static bool attach_test_segment(void)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/bamsystem-test-%ld", (long)getpid());
+
+    ShmStoreConfig config;
+    config.enabled = true;
+    config.capacity = 1024;
+    return shm_store_attach(&config, name);
+}
+
+static bool wait_children(pid_t *pids, int n)
+{
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        int status = 0;
+        if (waitpid(pids[i], &status, 0) != pids[i] || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static bool test_shm_store_basic(void)
+{
+    /* 挂接前已存在的 .card 文件在创建共享段时载入 */
+    ACCOUNT pre;
+    if (!test_create_account(&pre, 70)) {
+        return false;
+    }
+    if (!attach_test_segment()) {
+        return false;
+    }
+
+    bool ok = true;
+    ACCOUNT got;
+    ok &= shm_store_get(pre.UUID, &got) && got.BALANCE == 70;
+
+    ACCOUNT a;
+    ok &= test_create_account(&a, 0);
+    ok &= engine_deposit(a.UUID, 30, NULL) == ACCOUNT_OK;
+    ok &= engine_transfer(pre.UUID, a.UUID, 70, NULL, NULL) == ACCOUNT_OK;
+    ok &= shm_store_get(a.UUID, &got) && got.BALANCE == 100;
+    ok &= account_read_file(a.UUID, &got) && got.BALANCE == 100;
+
+    ok &= engine_delete(pre.UUID) == ACCOUNT_OK;
+    ok &= !shm_store_get(pre.UUID, &got);
+
+    ShmStoreStats st;
+    shm_store_get_stats(&st);
+    ok &= st.attached == 1 && st.capacity == 1024;
+
+    ok &= engine_withdraw(a.UUID, 100, NULL) == ACCOUNT_OK;
+    ok &= engine_delete(a.UUID) == ACCOUNT_OK;
+    shm_store_detach();
+    ok &= !shm_store_active();
+    return ok;
+}
+
+static bool test_shm_store_multi_process(void)
+{
+    if (!attach_test_segment()) {
+        return false;
+    }
+
+    char uuids[SHM_TEST_ACCOUNTS][37];
+    bool ok = true;
+    for (int i = 0; i < SHM_TEST_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        ok &= test_create_account(&acc, SHM_TEST_BALANCE);
+        memcpy(uuids[i], acc.UUID, 37);
+    }
+
+    pid_t pids[SHM_TEST_PROCS];
+    for (int p = 0; p < SHM_TEST_PROCS; p++) {
+        pids[p] = fork();
+        if (pids[p] == 0) {
+            unsigned int rng = 0x9E3779B9u * (unsigned int)(p + 1);
+            for (int i = 0; i < SHM_TEST_TRANSFERS; i++) {
+                rng = rng * 1103515245u + 12345u;
+                int from = (int)((rng >> 8) % SHM_TEST_ACCOUNTS);
+                rng = rng * 1103515245u + 12345u;
+                int to = (int)((rng >> 8) % SHM_TEST_ACCOUNTS);
+                engine_transfer(uuids[from], uuids[to], 1 + (rng >> 4) % 300, NULL, NULL);
+            }
+            _exit(0);
+        }
+    }
+    ok &= wait_children(pids, SHM_TEST_PROCS);
+
+    /* 各进程看到同一份状态，且与磁盘一致 */
+    LLUINT shm_total = 0;
+    LLUINT disk_total = 0;
+    for (int i = 0; i < SHM_TEST_ACCOUNTS; i++) {
+        ACCOUNT m;
+        ACCOUNT d;
+        ok &= shm_store_get(uuids[i], &m) && account_read_file(uuids[i], &d);
+        ok &= m.BALANCE == d.BALANCE;
+        shm_total += m.BALANCE;
+        disk_total += d.BALANCE;
+    }
+    ok &= shm_total == (LLUINT)SHM_TEST_ACCOUNTS * SHM_TEST_BALANCE && disk_total == shm_total;
+
+    for (int i = 0; i < SHM_TEST_ACCOUNTS; i++) {
+        ACCOUNT acc;
+        if (load_account(uuids[i], &acc) && acc.BALANCE > 0) {
+            engine_withdraw(uuids[i], acc.BALANCE, NULL);
+        }
+        engine_delete(uuids[i]);
+    }
+    shm_store_detach();
+    return ok;
+}
+
+static bool test_shm_store_owner_dead(void)
+{
+    if (!attach_test_segment()) {
+        return false;
+    }
+
+    ACCOUNT a;
+    bool ok = test_create_account(&a, 500);
+
+    /* 子进程持锁期间只改了共享表就退出（.card 仍为500） */
+    pid_t pid = fork();
+    if (pid == 0) {
+        shm_store_lock(a.UUID, NULL);
+        ACCOUNT bad = a;
+        bad.BALANCE = 1;
+        shm_store_put(&bad);
+        _exit(0);
+    }
+    ok &= wait_children(&pid, 1);
+
+    /* 接管锁并从文件重建该条带 */
+    ACCOUNT got;
+    ok &= shm_store_get(a.UUID, &got) && got.BALANCE == 500;
+
+    ShmStoreStats st;
+    shm_store_get_stats(&st);
+    ok &= st.recoveries == 1;
+
+    ok &= engine_withdraw(a.UUID, 500, NULL) == ACCOUNT_OK;
+    ok &= engine_delete(a.UUID) == ACCOUNT_OK;
+    shm_store_detach();
+    return ok;
+}
+
+void register_shm_store_tests(void)
+{
+    test_register(test_shm_store_basic,
+                  "shm_store: load, route and write through",
+                  "existing cards are loaded into the segment; ops update shm and .card together");
+
+    test_register(test_shm_store_multi_process,
+                  "shm_store: 4 processes",
+                  "forked processes transfer concurrently through stripe locks; money conserved");
+
+    test_register(test_shm_store_owner_dead,
+                  "shm_store: robust lock recovery",
+                  "a process dying while holding a stripe lock is recovered and the stripe resynced");
+}
+
+#else
+
+void register_shm_store_tests(void)
+{
+}
+
+#endif
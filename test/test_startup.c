@@ -0,0 +1,207 @@
+#include "include/test_framework.h"
+
+#include <lib/startup.h>
+#include <lib/platform.h>
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+/* 检测与同步各停在一个开关上，由测试放行 */
+static atomic_bool g_detect_release;
+static atomic_bool g_sync_release;
+static atomic_bool g_sync_entered;
+static atomic_int g_sync_calls;
+static RunMode g_sync_saw_mode;
+static RunMode g_detect_result;
+
+static RunMode gated_detect(void)
+{
+    while (!atomic_load(&g_detect_release)) {
+        platform_sleep_ms(1);
+    }
+    return g_detect_result;
+}
+
+static void gated_sync(StartupStatus *status)
+{
+    atomic_fetch_add(&g_sync_calls, 1);
+    g_sync_saw_mode = get_run_mode();
+    atomic_store(&g_sync_entered, true);
+    while (!atomic_load(&g_sync_release)) {
+        platform_sleep_ms(1);
+    }
+    status->pushed = 3;
+    status->pulled = 5;
+}
+
+static void reset_gates(RunMode detect_result)
+{
+    atomic_store(&g_detect_release, false);
+    atomic_store(&g_sync_release, false);
+    atomic_store(&g_sync_entered, false);
+    atomic_store(&g_sync_calls, 0);
+    g_sync_saw_mode = MODE_UNKNOWN;
+    g_detect_result = detect_result;
+}
+
+static StartupPhase wait_phase(StartupPhase phase)
+{
+    StartupStatus st;
+    for (int i = 0; i < 2000; i++) {
+        startup_get_status(&st);
+        if (st.phase == phase) {
+            break;
+        }
+        platform_sleep_ms(1);
+    }
+    return st.phase;
+}
+
+/* 同步开始后先放行交易，再停在开关上 */
+static void releasing_sync(StartupStatus *status)
+{
+    startup_release_ops();
+    gated_sync(status);
+}
+
+static atomic_bool g_op_started;
+
+static void blocked_op(void *arg)
+{
+    (void)arg;
+    startup_op_begin();
+    atomic_store(&g_op_started, true);
+    startup_op_end();
+}
+
+static bool test_startup_gates_transactions(void)
+{
+    RunMode saved = get_run_mode();
+    set_run_mode(MODE_LOCAL);
+    reset_gates(MODE_SERVER);
+    if (!startup_begin(gated_detect, gated_sync)) {
+        return false;
+    }
+
+    /* 检测期间交易不等待，按本地模式执行 */
+    bool ok = startup_in_progress();
+    startup_op_begin();
+    startup_mark_menu_shown();
+    atomic_store(&g_detect_release, true);
+
+    /* 检测已结束，但进行中的交易结束前不切换运行模式、不开始同步 */
+    ok &= wait_phase(STARTUP_SYNCING) == STARTUP_SYNCING;
+    platform_sleep_ms(20);
+    ok &= get_run_mode() == MODE_LOCAL;
+    ok &= !atomic_load(&g_sync_entered);
+    startup_op_end();
+
+    for (int i = 0; i < 2000 && !atomic_load(&g_sync_entered); i++) {
+        platform_sleep_ms(1);
+    }
+    ok &= atomic_load(&g_sync_entered);
+    ok &= g_sync_saw_mode == MODE_SERVER;
+
+    /* 同步期间新的交易等待 */
+    atomic_store(&g_op_started, false);
+    PlatformThread op_thread;
+    if (!platform_thread_create(&op_thread, blocked_op, NULL)) {
+        atomic_store(&g_sync_release, true);
+        cleanup_startup();
+        set_run_mode(saved);
+        return false;
+    }
+    platform_sleep_ms(30);
+    ok &= !atomic_load(&g_op_started);
+    ok &= !startup_op_try_begin(10);
+    StartupStatus st;
+    startup_get_status(&st);
+    ok &= st.ops_blocked;
+
+    atomic_store(&g_sync_release, true);
+    platform_thread_join(op_thread);
+    ok &= atomic_load(&g_op_started);
+    cleanup_startup();
+
+    startup_get_status(&st);
+    ok &= st.phase == STARTUP_ONLINE && !startup_in_progress() && !st.ops_blocked;
+    ok &= st.pushed == 3 && st.pulled == 5 && st.outbox_pending == 0;
+    ok &= st.sync_ms >= 30;
+    ok &= st.menu_ms <= st.detect_ms;
+    ok &= atomic_load(&g_sync_calls) == 1;
+
+    set_run_mode(saved);
+    return ok;
+}
+
+static bool test_startup_release_ops(void)
+{
+    RunMode saved = get_run_mode();
+    set_run_mode(MODE_LOCAL);
+    reset_gates(MODE_SERVER);
+    atomic_store(&g_detect_release, true);
+    if (!startup_begin(gated_detect, releasing_sync)) {
+        return false;
+    }
+    for (int i = 0; i < 2000 && !atomic_load(&g_sync_entered); i++) {
+        platform_sleep_ms(1);
+    }
+    bool ok = atomic_load(&g_sync_entered);
+
+    /* 同步函数放行后，同步尚未结束交易也不等待 */
+    StartupStatus st;
+    startup_get_status(&st);
+    ok &= st.phase == STARTUP_SYNCING && !st.ops_blocked;
+    ok &= startup_op_try_begin(0);
+    startup_op_end();
+    startup_op_begin();
+    startup_op_end();
+
+    atomic_store(&g_sync_release, true);
+    cleanup_startup();
+    startup_get_status(&st);
+    ok &= st.phase == STARTUP_ONLINE && st.pushed == 3;
+
+    set_run_mode(saved);
+    return ok;
+}
+
+static bool test_startup_offline(void)
+{
+    RunMode saved = get_run_mode();
+    reset_gates(MODE_LOCAL);
+    atomic_store(&g_detect_release, true);
+    if (!startup_begin(gated_detect, gated_sync)) {
+        return false;
+    }
+    cleanup_startup();
+
+    StartupStatus st;
+    startup_get_status(&st);
+    bool ok = st.phase == STARTUP_OFFLINE;
+    ok &= get_run_mode() == MODE_LOCAL;
+    ok &= atomic_load(&g_sync_calls) == 0;
+
+    /* 本地模式下交易不等待 */
+    startup_op_begin();
+    startup_op_end();
+
+    set_run_mode(saved);
+    return ok;
+}
+
+void register_startup_tests(void)
+{
+    test_register(test_startup_gates_transactions,
+                  "startup: background detect and sync gate",
+                  "ops run locally while detecting; mode flips after they finish; ops wait during sync");
+
+    test_register(test_startup_release_ops,
+                  "startup: sync releases transactions early",
+                  "after startup_release_ops() ops proceed while push and pull are still running");
+
+    test_register(test_startup_offline,
+                  "startup: unreachable server stays local",
+                  "detect failure ends in local mode without calling sync");
+}
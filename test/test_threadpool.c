@@ -0,0 +1,162 @@
+#include "include/test_framework.h"
+
+#include <lib/threadpool.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    unsigned long long *values;
+    atomic_ullong sum;
+} SumCtx;
+
+static void sum_range(size_t begin, size_t end, void *arg)
+{
+    SumCtx *ctx = (SumCtx *)arg;
+    unsigned long long local = 0;
+    for (size_t i = begin; i < end; i++) {
+        local += ctx->values[i];
+    }
+    atomic_fetch_add(&ctx->sum, local);
+}
+
+static bool test_threadpool_parallel_for_sum(void)
+{
+    const size_t n = 1000003;  /* 非整除，检查尾块 */
+    SumCtx ctx;
+    ctx.values = (unsigned long long *)malloc(n * sizeof(unsigned long long));
+    if (!ctx.values) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        ctx.values[i] = i;
+    }
+
+    ThreadPool *pool = threadpool_create(4);
+    if (!pool) {
+        free(ctx.values);
+        return false;
+    }
+
+    bool ok = true;
+    size_t grains[] = { 0, 7, 4096, n, n * 2 };
+    for (size_t g = 0; g < sizeof(grains) / sizeof(grains[0]); g++) {
+        size_t grain = grains[g];
+        atomic_init(&ctx.sum, 0);
+        threadpool_parallel_for(pool, 0, n, grain, sum_range, &ctx);
+        if (atomic_load(&ctx.sum) != (unsigned long long)n * (n - 1) / 2) {
+            fprintf(stderr, "grain=%zu sum mismatch\n", grain);
+            ok = false;
+        }
+    }
+
+    /* 空区间不调用回调 */
+    atomic_init(&ctx.sum, 0);
+    threadpool_parallel_for(pool, 10, 10, 0, sum_range, &ctx);
+    ok &= (atomic_load(&ctx.sum) == 0);
+
+    threadpool_destroy(pool);
+    free(ctx.values);
+    return ok;
+}
+
+typedef struct {
+    ThreadPool *pool;
+    TaskGroup *group;
+    atomic_int *counter;
+    int depth;
+} NestedCtx;
+
+static void nested_task(void *arg)
+{
+    NestedCtx *ctx = (NestedCtx *)arg;
+    atomic_fetch_add(ctx->counter, 1);
+    if (ctx->depth == 0) {
+        return;
+    }
+
+    /* 在工作线程内创建子任务组并等待：等待线程必须协助执行，否则会死锁 */
+    TaskGroup child;
+    task_group_init(&child);
+    NestedCtx kids[4];
+    for (int i = 0; i < 4; i++) {
+        kids[i].pool = ctx->pool;
+        kids[i].group = &child;
+        kids[i].counter = ctx->counter;
+        kids[i].depth = ctx->depth - 1;
+        task_group_run(&child, ctx->pool, nested_task, &kids[i]);
+    }
+    task_group_wait(&child, ctx->pool);
+    task_group_destroy(&child);
+}
+
+static bool test_threadpool_nested_groups(void)
+{
+    /* 线程数少于嵌套层数，检验协助等待不会死锁 */
+    ThreadPool *pool = threadpool_create(2);
+    if (!pool) {
+        return false;
+    }
+
+    atomic_int counter;
+    atomic_init(&counter, 0);
+
+    TaskGroup root;
+    task_group_init(&root);
+    NestedCtx ctx = { pool, &root, &counter, 4 };
+    task_group_run(&root, pool, nested_task, &ctx);
+    task_group_wait(&root, pool);
+    task_group_destroy(&root);
+
+    /* 1 + 4 + 16 + 64 + 256 */
+    bool ok = (atomic_load(&counter) == 341);
+
+    ThreadPoolStats stats;
+    threadpool_get_stats(pool, &stats);
+    ok &= (stats.executed >= 341);
+
+    threadpool_destroy(pool);
+    return ok;
+}
+
+static void increment_task(void *arg)
+{
+    atomic_fetch_add((atomic_int *)arg, 1);
+}
+
+static bool test_threadpool_destroy_drains(void)
+{
+    ThreadPool *pool = threadpool_create(3);
+    if (!pool) {
+        return false;
+    }
+
+    atomic_int counter;
+    atomic_init(&counter, 0);
+    for (int i = 0; i < 10000; i++) {
+        if (!threadpool_submit(pool, increment_task, &counter)) {
+            threadpool_destroy(pool);
+            return false;
+        }
+    }
+
+    /* destroy 必须先执行完已提交任务 */
+    threadpool_destroy(pool);
+    return atomic_load(&counter) == 10000;
+}
+
+void register_threadpool_tests(void)
+{
+    test_register(test_threadpool_parallel_for_sum,
+                  "threadpool: parallel_for sum",
+                  "parallel_for over 1M elements with several grain sizes");
+
+    test_register(test_threadpool_nested_groups,
+                  "threadpool: nested task groups",
+                  "tasks waiting on child groups from worker threads must not deadlock");
+
+    test_register(test_threadpool_destroy_drains,
+                  "threadpool: destroy drains queue",
+                  "all submitted tasks run before threadpool_destroy returns");
+}
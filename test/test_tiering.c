@@ -0,0 +1,161 @@
+#include "include/test_framework.h"
+
+#include <lib/tiering.h>
+#include <lib/engine.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static time_t card_mtime(const char *uuid)
+{
+    char filename[64];
+    snprintf(filename, sizeof(filename), "Card/%s.card", uuid);
+    struct stat st;
+    return (stat(filename, &st) == 0) ? st.st_mtime : 0;
+}
+
+static bool start_tiering(void)
+{
+    TieringConfig config;
+    load_tiering_config("no-such-engine.conf", &config);
+    config.enabled = true;
+    config.cold_after_seconds = 0;
+    config.scan_interval_seconds = 0;
+    return tiering_start(&config);
+}
+
+/**
+ * @brief 把冷段中的账户全部提升回热层后停止分层，避免影响其他测试
+ */
+static void stop_tiering(void)
+{
+    char uuids[64][37];
+    size_t n;
+    while ((n = tiering_cold_list(uuids, 64)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            ACCOUNT acc;
+            load_account(uuids[i], &acc);
+        }
+    }
+    cleanup_tiering();
+    remove("Card/cold.seg");
+}
+
+static bool uuid_listed(const char *uuid)
+{
+    char uuids[256][37];
+    int n = get_all_account_uuids(uuids, 256);
+    for (int i = 0; i < n; i++) {
+        if (strcmp(uuids[i], uuid) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool test_tiering_demote_promote(void)
+{
+    ACCOUNT a;
+    ACCOUNT b;
+    ACCOUNT c;
+    if (!test_create_account(&a, 100) || !test_create_account(&b, 200) ||
+        !test_create_account(&c, 0) || !start_tiering()) {
+        return false;
+    }
+
+    /* 刚访问过的账户不移入冷段 */
+    bool ok = tiering_demote_idle(3600) == 0;
+
+    time_t a_modified = card_mtime(a.UUID);
+    ok &= tiering_demote_idle(0) >= 3;
+    ok &= hash_find_account(a.UUID) == NULL && !test_card_exists(a.UUID);
+
+    /* 冷账户带有移入前 .card 的修改时间，只读取不提升 */
+    ACCOUNT peeked;
+    time_t modified = 0;
+    ok &= tiering_cold_peek(a.UUID, &peeked, &modified) && peeked.BALANCE == 100 &&
+          modified == a_modified;
+    ok &= hash_find_account(a.UUID) == NULL && !test_card_exists(a.UUID);
+    TieringStats st;
+    tiering_get_stats(&st);
+    ok &= st.cold_loaded && st.cold_count >= 3 && st.hot_count == 0;
+    ok &= st.cold_bytes < st.cold_count * sizeof(AccountNode) && st.segment_file_bytes > 0;
+
+    /* 冷账户仍出现在账户列表与全量复制中 */
+    ok &= uuid_listed(a.UUID) && uuid_listed(c.UUID);
+    ACCOUNT all[256];
+    size_t n = account_collect_all(all, 256, NULL);
+    bool found_b = false;
+    for (size_t i = 0; i < n; i++) {
+        found_b |= strcmp(all[i].UUID, b.UUID) == 0 && all[i].BALANCE == 200;
+    }
+    ok &= found_b;
+
+    /* load_account 透明提升 */
+    ACCOUNT loaded;
+    ok &= load_account(a.UUID, &loaded) && loaded.BALANCE == 100 && loaded.PASSWORD == 1234567;
+    ok &= hash_find_account(a.UUID) != NULL && test_card_exists(a.UUID);
+    ok &= engine_deposit(b.UUID, 5, NULL) == ACCOUNT_OK;
+    tiering_get_stats(&st);
+    ok &= st.promotions == 2;
+
+    /* 删除冷账户立即从冷段文件中去掉 */
+    ok &= engine_delete(c.UUID) == ACCOUNT_OK && !uuid_listed(c.UUID);
+
+    /* 重新载入冷段文件 */
+    time_t b_modified = card_mtime(b.UUID);
+    ok &= tiering_demote_idle(0) >= 2;
+    cleanup_tiering();
+    ok &= !load_account(a.UUID, &loaded);
+    ok &= start_tiering();
+    tiering_get_stats(&st);
+    ok &= !st.cold_loaded;
+    ok &= tiering_cold_peek(b.UUID, &peeked, &modified) && peeked.BALANCE == 205 &&
+          modified == b_modified;
+    ok &= load_account(a.UUID, &loaded) && loaded.BALANCE == 100;
+    ok &= load_account(b.UUID, &loaded) && loaded.BALANCE == 205;
+    ok &= !load_account(c.UUID, &loaded);
+
+    stop_tiering();
+    engine_withdraw(a.UUID, 100, NULL);
+    engine_withdraw(b.UUID, 205, NULL);
+    engine_delete(a.UUID);
+    engine_delete(b.UUID);
+    return ok;
+}
+
+static bool test_tiering_restore_when_disabled(void)
+{
+    ACCOUNT a;
+    if (!test_create_account(&a, 42) || !start_tiering()) {
+        return false;
+    }
+
+    bool ok = tiering_demote_idle(0) >= 1;
+    cleanup_tiering();
+
+    /* 未启用分层时启动：冷段中的账户恢复为 .card 文件 */
+    ACCOUNT loaded;
+    ok &= !load_account(a.UUID, &loaded);
+    ok &= init_tiering() && !tiering_active();
+    ok &= load_account(a.UUID, &loaded) && loaded.BALANCE == 42 && test_card_exists(a.UUID);
+    struct stat st;
+    ok &= stat("Card/cold.seg", &st) != 0;
+
+    engine_withdraw(a.UUID, 42, NULL);
+    engine_delete(a.UUID);
+    return ok;
+}
+
+void register_tiering_tests(void)
+{
+    test_register(test_tiering_demote_promote,
+                  "tiering: demote and transparent promotion",
+                  "idle accounts move to the cold segment and load_account() promotes them back");
+
+    test_register(test_tiering_restore_when_disabled,
+                  "tiering: restore when disabled",
+                  "starting without tiering rewrites cold accounts as .card files");
+}
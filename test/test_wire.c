@@ -0,0 +1,138 @@
+#include "include/test_framework.h"
+
+#include <lib/wire.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define WIRE_TEST_UUID "00112233-4455-6677-8899-aabbccddeeff"
+#define WIRE_TEST_UUID_TO "ffeeddcc-bbaa-9988-7766-554433221100"
+
+static bool bytes_equal(const uint8_t *p, const uint8_t *expected, size_t n)
+{
+    return memcmp(p, expected, n) == 0;
+}
+
+static bool test_wire_requests(void)
+{
+    static const uint8_t uuid_bytes[16] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+    };
+    static const uint8_t zero[16];
+    static const uint8_t amount_le[8] = { 0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01 };
+    uint8_t buf[WIRE_OP_MAX_BYTES];
+
+    /* 存款：uuid_to 全0，金额与时间戳为小端，op_id 带长度前缀 */
+    size_t len = wire_encode_op(buf, WIRE_TEST_UUID, NULL, 0x0102030405060708ull, 1700000000, "q-7");
+    bool ok = len == WIRE_OP_FIXED_BYTES + 3;
+    ok &= bytes_equal(buf, uuid_bytes, 16) && bytes_equal(buf + 16, zero, 16);
+    ok &= bytes_equal(buf + 32, amount_le, 8);
+    ok &= buf[40] == 0x00 && buf[41] == 0xf1 && buf[42] == 0x53 && buf[43] == 0x65 && buf[47] == 0;
+    ok &= buf[48] == 3 && memcmp(buf + 49, "q-7", 3) == 0;
+
+    /* 转账带 uuid_to；没有 op_id 时长度为0 */
+    len = wire_encode_op(buf, WIRE_TEST_UUID, WIRE_TEST_UUID_TO, 5, 0, NULL);
+    ok &= len == WIRE_OP_FIXED_BYTES && buf[16] == 0xff && buf[31] == 0x00 && buf[48] == 0;
+
+    /* 非规范格式的 UUID 与过长的 op_id 不编码，调用方改用 JSON */
+    char long_id[WIRE_OP_ID_MAX + 2];
+    memset(long_id, 'x', sizeof(long_id) - 1);
+    long_id[sizeof(long_id) - 1] = '\0';
+    ok &= wire_encode_op(buf, "00112233-4455-6677-8899-AABBCCDDEEFF", NULL, 1, 0, NULL) == 0;
+    ok &= wire_encode_op(buf, WIRE_TEST_UUID, "not-a-uuid", 1, 0, NULL) == 0;
+    ok &= wire_encode_op(buf, WIRE_TEST_UUID, NULL, 1, 0, long_id) == 0;
+
+    /* 批量同步：条数 + 定长记录 */
+    ACCOUNT accounts[3];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < 3; i++) {
+        generate_uuid_string(accounts[i].UUID);
+        accounts[i].BALANCE = (LLUINT)i * 1000 + 1;
+    }
+    uint8_t batch[4 + 3 * WIRE_SYNC_RECORD_BYTES];
+    ok &= wire_sync_batch_size(3) == sizeof(batch);
+    len = wire_encode_sync_batch(batch, accounts, 3, 42);
+    ok &= len == sizeof(batch) && batch[0] == 3 && batch[1] == 0 && batch[2] == 0 && batch[3] == 0;
+    for (int i = 0; i < 3; i++) {
+        const uint8_t *rec = batch + 4 + i * WIRE_SYNC_RECORD_BYTES;
+        char uuid[37];
+        uuid_from_bytes(rec, uuid);
+        ok &= strcmp(uuid, accounts[i].UUID) == 0;
+        ok &= rec[16] == (uint8_t)(accounts[i].BALANCE & 0xff) && rec[17] == (uint8_t)(accounts[i].BALANCE >> 8);
+        ok &= rec[24] == 42 && rec[25] == 0;
+    }
+    return ok;
+}
+
+static size_t put_account_frame(uint8_t *p, const char *uuid, uint8_t balance)
+{
+    memset(p, 0, WIRE_ACCOUNT_FRAME_BYTES);
+    p[0] = WIRE_FRAME_ACCOUNT;
+    uuid_to_bytes(uuid, p + 1);
+    p[17] = balance;
+    return WIRE_ACCOUNT_FRAME_BYTES;
+}
+
+static bool test_wire_responses(void)
+{
+    /* 状态响应：success balance text_len text */
+    uint8_t status[WIRE_STATUS_FIXED_BYTES + 2] = { 1, 0x10, 0x27, 0, 0, 0, 0, 0, 0, 2, 0, 'o', 'k' };
+    LLUINT balance = 0;
+    bool ok = wire_decode_status(status, sizeof(status), &balance) && balance == 10000;
+    ok &= !wire_decode_status(status, sizeof(status) - 1, NULL);
+    status[0] = 0;
+    ok &= !wire_decode_status(status, sizeof(status), NULL);
+
+    /* 批量同步响应：数量不一致时全部视为失败 */
+    uint8_t result[5 + 3] = { 1, 3, 0, 0, 0, 1, 0, 1 };
+    bool item_ok[3] = { false, false, false };
+    ok &= wire_decode_sync_batch(result, sizeof(result), 3, item_ok) == 2;
+    ok &= item_ok[0] && !item_ok[1] && item_ok[2];
+    bool none[4] = { false, false, false, false };
+    ok &= wire_decode_sync_batch(result, sizeof(result), 4, none) == 0 && !none[0];
+
+    /* 账户列表：两个账户帧 + 结束帧 */
+    uint8_t page[2 * WIRE_ACCOUNT_FRAME_BYTES + WIRE_END_FRAME_BYTES];
+    size_t n = put_account_frame(page, WIRE_TEST_UUID, 7);
+    n += put_account_frame(page + n, WIRE_TEST_UUID_TO, 9);
+    memset(page + n, 0, WIRE_END_FRAME_BYTES);
+    page[n] = WIRE_FRAME_END;
+    page[n + 1] = 1;
+    page[n + 2] = 0x2a;
+    uuid_to_bytes(WIRE_TEST_UUID_TO, page + n + 10);
+
+    WireReader r;
+    ACCOUNT acc;
+    WirePageEnd end;
+    wire_reader_init(&r, page, sizeof(page));
+    ok &= wire_read_frame(&r, &acc, &end) == WIRE_READ_ACCOUNT;
+    ok &= strcmp(acc.UUID, WIRE_TEST_UUID) == 0 && acc.BALANCE == 7 && acc.PASSWORD == 0;
+    ok &= wire_read_frame(&r, &acc, &end) == WIRE_READ_ACCOUNT;
+    ok &= strcmp(acc.UUID, WIRE_TEST_UUID_TO) == 0 && acc.BALANCE == 9;
+    ok &= wire_read_frame(&r, &acc, &end) == WIRE_READ_END;
+    ok &= end.success && end.watermark == 42 && strcmp(end.next_after, WIRE_TEST_UUID_TO) == 0;
+    ok &= wire_read_frame(&r, &acc, &end) == WIRE_READ_ERROR;
+
+    /* 最后一页 next_after 全0；截断或未知的帧报错 */
+    memset(page + n + 10, 0, WIRE_UUID_BYTES);
+    wire_reader_init(&r, page + n, WIRE_END_FRAME_BYTES);
+    ok &= wire_read_frame(&r, &acc, &end) == WIRE_READ_END && end.next_after[0] == '\0';
+    wire_reader_init(&r, page, WIRE_ACCOUNT_FRAME_BYTES - 1);
+    ok &= wire_read_frame(&r, &acc, &end) == WIRE_READ_ERROR;
+    page[0] = 'X';
+    wire_reader_init(&r, page, sizeof(page));
+    ok &= wire_read_frame(&r, &acc, &end) == WIRE_READ_ERROR;
+    return ok;
+}
+
+void register_wire_tests(void)
+{
+    test_register(test_wire_requests,
+                  "wire: binary request records",
+                  "fixed little-endian layout with 16-byte UUIDs; non-canonical input falls back to JSON");
+
+    test_register(test_wire_responses,
+                  "wire: binary response decoding",
+                  "status, batch results and account page frames; truncated or unknown frames are rejected");
+}
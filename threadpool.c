@@ -0,0 +1,549 @@
+/**
+ * @file threadpool.c
+ * @brief 工作窃取线程池模块实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/threadpool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ==================== 常量配置 ==================== */
+
+#define DEQUE_INITIAL_CAPACITY 64     /* 双端队列初始容量（2的幂） */
+#define PARALLEL_FOR_SPLIT 8          /* parallel_for 每个线程平均切分的块数 */
+#define GROUP_WAIT_POLL_MS 1          /* 任务组等待时无任务可帮的轮询间隔 */
+
+/* ==================== 内部结构 ==================== */
+
+/**
+ * @brief 任务描述
+ */
+typedef struct {
+    TaskFunc func;
+    void *arg;
+    TaskGroup *group;             /* 所属任务组，可为NULL */
+} Task;
+
+/**
+ * @brief 工作线程的双端队列（环形缓冲区）
+ * @note 所有者从 tail 端压入/弹出，窃取者从 head 端取走
+ */
+typedef struct {
+    PlatformMutex lock;
+    Task *items;
+    size_t capacity;              /* 2的幂 */
+    size_t head;                  /* 窃取端 */
+    size_t tail;                  /* 所有者端 */
+} WorkDeque;
+
+typedef struct {
+    ThreadPool *pool;
+    int index;
+    PlatformThread thread;
+    WorkDeque deque;
+    unsigned int rng;             /* 选择窃取目标的随机数状态 */
+} Worker;
+
+struct ThreadPool {
+    Worker *workers;
+    int num_workers;
+    atomic_long queued;           /* 所有队列中的任务总数（可能短暂为负） */
+    atomic_int sleepers;          /* 正在休眠的线程数 */
+    atomic_bool shutdown;
+    atomic_uint next_target;      /* 外部提交时轮询选择的队列 */
+    atomic_size_t executed;
+    atomic_size_t stolen;
+    PlatformMutex sleep_lock;
+    PlatformCond wake;
+};
+
+typedef struct {
+    size_t begin;
+    size_t end;
+    RangeFunc func;
+    void *arg;
+} RangeChunk;
+
+/** @brief 当前线程所属的工作线程（非池内线程为NULL） */
+static _Thread_local Worker *tls_worker = NULL;
+
+/** @brief 进程共享线程池 */
+static ThreadPool *_Atomic g_shared_pool = NULL;
+
+/* ==================== 双端队列 ==================== */
+
+static bool deque_init(WorkDeque *dq)
+{
+    dq->items = (Task *)malloc(DEQUE_INITIAL_CAPACITY * sizeof(Task));
+    if (dq->items == NULL) {
+        return false;
+    }
+    dq->capacity = DEQUE_INITIAL_CAPACITY;
+    dq->head = 0;
+    dq->tail = 0;
+    platform_mutex_init(&dq->lock);
+    return true;
+}
+
+static void deque_destroy(WorkDeque *dq)
+{
+    platform_mutex_destroy(&dq->lock);
+    free(dq->items);
+    dq->items = NULL;
+}
+
+static bool deque_push_bottom(WorkDeque *dq, const Task *task)
+{
+    platform_mutex_lock(&dq->lock);
+
+    if (dq->tail - dq->head == dq->capacity) {
+        /* 扩容：按逻辑顺序搬到新缓冲区 */
+        size_t new_cap = dq->capacity * 2;
+        Task *new_items = (Task *)malloc(new_cap * sizeof(Task));
+        if (new_items == NULL) {
+            platform_mutex_unlock(&dq->lock);
+            return false;
+        }
+        size_t count = dq->tail - dq->head;
+        for (size_t i = 0; i < count; i++) {
+            new_items[i] = dq->items[(dq->head + i) & (dq->capacity - 1)];
+        }
+        free(dq->items);
+        dq->items = new_items;
+        dq->capacity = new_cap;
+        dq->head = 0;
+        dq->tail = count;
+    }
+
+    dq->items[dq->tail & (dq->capacity - 1)] = *task;
+    dq->tail++;
+
+    platform_mutex_unlock(&dq->lock);
+    return true;
+}
+
+static bool deque_pop_bottom(WorkDeque *dq, Task *out)
+{
+    bool found = false;
+    platform_mutex_lock(&dq->lock);
+    if (dq->tail != dq->head) {
+        dq->tail--;
+        *out = dq->items[dq->tail & (dq->capacity - 1)];
+        found = true;
+    }
+    platform_mutex_unlock(&dq->lock);
+    return found;
+}
+
+static bool deque_steal_top(WorkDeque *dq, Task *out)
+{
+    bool found = false;
+    platform_mutex_lock(&dq->lock);
+    if (dq->tail != dq->head) {
+        *out = dq->items[dq->head & (dq->capacity - 1)];
+        dq->head++;
+        found = true;
+    }
+    platform_mutex_unlock(&dq->lock);
+    return found;
+}
+
+/* ==================== 调度核心 ==================== */
+
+/**
+ * @brief 将任务放入队列并在有休眠线程时唤醒一个
+ */
+static bool pool_push(ThreadPool *pool, const Task *task)
+{
+    WorkDeque *target;
+    if (tls_worker != NULL && tls_worker->pool == pool) {
+        target = &tls_worker->deque;
+    } else {
+        unsigned int idx = atomic_fetch_add(&pool->next_target, 1u) % (unsigned int)pool->num_workers;
+        target = &pool->workers[idx].deque;
+    }
+
+    if (!deque_push_bottom(target, task)) {
+        return false;
+    }
+
+    atomic_fetch_add(&pool->queued, 1);
+    if (atomic_load(&pool->sleepers) > 0) {
+        platform_mutex_lock(&pool->sleep_lock);
+        platform_cond_signal(&pool->wake);
+        platform_mutex_unlock(&pool->sleep_lock);
+    }
+    return true;
+}
+
+/**
+ * @brief 查找可执行任务：先取自己的队列，再随机顺序窃取其他队列
+ * @param self 当前工作线程，外部线程为NULL
+ */
+static bool pool_find_task(ThreadPool *pool, Worker *self, Task *out)
+{
+    if (self != NULL && deque_pop_bottom(&self->deque, out)) {
+        atomic_fetch_sub(&pool->queued, 1);
+        return true;
+    }
+
+    if (atomic_load(&pool->queued) <= 0) {
+        return false;
+    }
+
+    unsigned int start;
+    if (self != NULL) {
+        self->rng = self->rng * 1103515245u + 12345u;
+        start = (self->rng >> 16) % (unsigned int)pool->num_workers;
+    } else {
+        start = atomic_load(&pool->next_target) % (unsigned int)pool->num_workers;
+    }
+
+    for (int i = 0; i < pool->num_workers; i++) {
+        Worker *victim = &pool->workers[(start + (unsigned int)i) % (unsigned int)pool->num_workers];
+        if (victim == self) {
+            continue;
+        }
+        if (deque_steal_top(&victim->deque, out)) {
+            atomic_fetch_sub(&pool->queued, 1);
+            atomic_fetch_add(&pool->stolen, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void group_task_done(TaskGroup *group)
+{
+    /* 在锁内递减，保证等待者返回（并可能销毁任务组）时本线程已离开临界区 */
+    platform_mutex_lock(&group->lock);
+    if (atomic_fetch_sub(&group->pending, 1) == 1) {
+        platform_cond_broadcast(&group->done);
+    }
+    platform_mutex_unlock(&group->lock);
+}
+
+static void run_task(ThreadPool *pool, const Task *task)
+{
+    task->func(task->arg);
+    atomic_fetch_add(&pool->executed, 1);
+    if (task->group != NULL) {
+        group_task_done(task->group);
+    }
+}
+
+static void worker_main(void *arg)
+{
+    Worker *self = (Worker *)arg;
+    ThreadPool *pool = self->pool;
+    tls_worker = self;
+
+    while (1) {
+        Task task;
+        if (pool_find_task(pool, self, &task)) {
+            run_task(pool, &task);
+            continue;
+        }
+
+        platform_mutex_lock(&pool->sleep_lock);
+        atomic_fetch_add(&pool->sleepers, 1);
+        while (atomic_load(&pool->queued) <= 0 && !atomic_load(&pool->shutdown)) {
+            platform_cond_wait(&pool->wake, &pool->sleep_lock);
+        }
+        atomic_fetch_sub(&pool->sleepers, 1);
+        bool stop = atomic_load(&pool->shutdown) && atomic_load(&pool->queued) <= 0;
+        platform_mutex_unlock(&pool->sleep_lock);
+
+        if (stop) {
+            break;
+        }
+    }
+
+    tls_worker = NULL;
+}
+
+/* ==================== 线程池 ==================== */
+
+static void pool_teardown(ThreadPool *pool, int started);
+
+/**
+ * @brief 创建线程池
+ */
+ThreadPool* threadpool_create(int num_threads)
+{
+    if (num_threads <= 0) {
+        num_threads = platform_cpu_count();
+    }
+
+    ThreadPool *pool = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) {
+        fprintf(stderr, "错误：线程池内存分配失败\n");
+        return NULL;
+    }
+
+    pool->workers = (Worker *)calloc((size_t)num_threads, sizeof(Worker));
+    if (pool->workers == NULL) {
+        fprintf(stderr, "错误：线程池内存分配失败\n");
+        free(pool);
+        return NULL;
+    }
+
+    pool->num_workers = num_threads;
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->sleepers, 0);
+    atomic_init(&pool->shutdown, false);
+    atomic_init(&pool->next_target, 0u);
+    atomic_init(&pool->executed, 0);
+    atomic_init(&pool->stolen, 0);
+    platform_mutex_init(&pool->sleep_lock);
+    platform_cond_init(&pool->wake);
+
+    /* 先初始化全部队列，再启动线程（线程启动后即可能窃取任意队列） */
+    for (int i = 0; i < num_threads; i++) {
+        Worker *w = &pool->workers[i];
+        w->pool = pool;
+        w->index = i;
+        w->rng = 2654435761u * (unsigned int)(i + 1);
+        if (!deque_init(&w->deque)) {
+            for (int j = 0; j < i; j++) {
+                deque_destroy(&pool->workers[j].deque);
+            }
+            platform_cond_destroy(&pool->wake);
+            platform_mutex_destroy(&pool->sleep_lock);
+            free(pool->workers);
+            free(pool);
+            fprintf(stderr, "错误：线程池内存分配失败\n");
+            return NULL;
+        }
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        if (!platform_thread_create(&pool->workers[i].thread, worker_main, &pool->workers[i])) {
+            fprintf(stderr, "错误：无法创建工作线程\n");
+            pool_teardown(pool, i);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+/**
+ * @brief 停止并回收线程池
+ * @param started 已成功启动的线程数
+ */
+static void pool_teardown(ThreadPool *pool, int started)
+{
+    platform_mutex_lock(&pool->sleep_lock);
+    atomic_store(&pool->shutdown, true);
+    platform_cond_broadcast(&pool->wake);
+    platform_mutex_unlock(&pool->sleep_lock);
+
+    for (int i = 0; i < started; i++) {
+        platform_thread_join(pool->workers[i].thread);
+    }
+
+    for (int i = 0; i < pool->num_workers; i++) {
+        deque_destroy(&pool->workers[i].deque);
+    }
+
+    platform_cond_destroy(&pool->wake);
+    platform_mutex_destroy(&pool->sleep_lock);
+    free(pool->workers);
+    free(pool);
+}
+
+/**
+ * @brief 销毁线程池
+ */
+void threadpool_destroy(ThreadPool *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+
+    pool_teardown(pool, pool->num_workers);
+}
+
+/**
+ * @brief 获取工作线程数
+ */
+int threadpool_size(const ThreadPool *pool)
+{
+    return pool ? pool->num_workers : 0;
+}
+
+/**
+ * @brief 提交一个独立任务
+ */
+bool threadpool_submit(ThreadPool *pool, TaskFunc func, void *arg)
+{
+    if (pool == NULL || func == NULL) {
+        return false;
+    }
+
+    Task task = { func, arg, NULL };
+    return pool_push(pool, &task);
+}
+
+/**
+ * @brief 获取运行统计
+ */
+void threadpool_get_stats(ThreadPool *pool, ThreadPoolStats *stats)
+{
+    stats->executed = atomic_load(&pool->executed);
+    stats->stolen = atomic_load(&pool->stolen);
+}
+
+/**
+ * @brief 获取进程共享线程池
+ */
+ThreadPool* threadpool_shared(void)
+{
+    ThreadPool *pool = atomic_load(&g_shared_pool);
+    if (pool != NULL) {
+        return pool;
+    }
+
+    ThreadPool *created = threadpool_create(0);
+    if (created == NULL) {
+        return NULL;
+    }
+
+    ThreadPool *expected = NULL;
+    if (!atomic_compare_exchange_strong(&g_shared_pool, &expected, created)) {
+        threadpool_destroy(created);  /* 其他线程已抢先创建 */
+        return expected;
+    }
+    return created;
+}
+
+/**
+ * @brief 销毁进程共享线程池
+ */
+void threadpool_shared_cleanup(void)
+{
+    ThreadPool *pool = atomic_exchange(&g_shared_pool, NULL);
+    threadpool_destroy(pool);
+}
+
+/* ==================== 任务组 ==================== */
+
+void task_group_init(TaskGroup *group)
+{
+    atomic_init(&group->pending, 0);
+    platform_mutex_init(&group->lock);
+    platform_cond_init(&group->done);
+}
+
+void task_group_destroy(TaskGroup *group)
+{
+    platform_cond_destroy(&group->done);
+    platform_mutex_destroy(&group->lock);
+}
+
+/**
+ * @brief 在任务组中提交任务
+ */
+bool task_group_run(TaskGroup *group, ThreadPool *pool, TaskFunc func, void *arg)
+{
+    if (group == NULL || pool == NULL || func == NULL) {
+        return false;
+    }
+
+    atomic_fetch_add(&group->pending, 1);
+    Task task = { func, arg, group };
+    if (!pool_push(pool, &task)) {
+        atomic_fetch_sub(&group->pending, 1);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 等待任务组完成（期间协助执行任务）
+ */
+void task_group_wait(TaskGroup *group, ThreadPool *pool)
+{
+    Worker *self = (tls_worker != NULL && tls_worker->pool == pool) ? tls_worker : NULL;
+
+    while (atomic_load(&group->pending) > 0) {
+        Task task;
+        if (pool != NULL && pool_find_task(pool, self, &task)) {
+            run_task(pool, &task);
+            continue;
+        }
+
+        platform_mutex_lock(&group->lock);
+        if (atomic_load(&group->pending) > 0) {
+            platform_cond_timedwait(&group->done, &group->lock, GROUP_WAIT_POLL_MS);
+        }
+        platform_mutex_unlock(&group->lock);
+    }
+
+    /* 确保最后一个完成者已离开临界区 */
+    platform_mutex_lock(&group->lock);
+    platform_mutex_unlock(&group->lock);
+}
+
+/* ==================== 并行区间 ==================== */
+
+static void range_chunk_task(void *arg)
+{
+    RangeChunk *chunk = (RangeChunk *)arg;
+    chunk->func(chunk->begin, chunk->end, chunk->arg);
+}
+
+/**
+ * @brief 并行处理区间 [begin, end)
+ */
+void threadpool_parallel_for(ThreadPool *pool, size_t begin, size_t end, size_t grain,
+                             RangeFunc func, void *arg)
+{
+    if (end <= begin || func == NULL) {
+        return;
+    }
+
+    size_t n = end - begin;
+    int workers = threadpool_size(pool);
+    if (grain == 0) {
+        grain = n / ((size_t)(workers > 0 ? workers : 1) * PARALLEL_FOR_SPLIT);
+        if (grain == 0) {
+            grain = 1;
+        }
+    }
+
+    size_t chunks = (n + grain - 1) / grain;
+    if (pool == NULL || chunks <= 1) {
+        func(begin, end, arg);
+        return;
+    }
+
+    RangeChunk *items = (RangeChunk *)malloc(chunks * sizeof(RangeChunk));
+    if (items == NULL) {
+        func(begin, end, arg);  /* 内存不足时退化为串行 */
+        return;
+    }
+
+    TaskGroup group;
+    task_group_init(&group);
+
+    for (size_t i = 0; i < chunks; i++) {
+        items[i].begin = begin + i * grain;
+        items[i].end = (i == chunks - 1) ? end : items[i].begin + grain;
+        items[i].func = func;
+        items[i].arg = arg;
+        if (!task_group_run(&group, pool, range_chunk_task, &items[i])) {
+            range_chunk_task(&items[i]);
+        }
+    }
+
+    task_group_wait(&group, pool);
+    task_group_destroy(&group);
+    free(items);
+}
@@ -0,0 +1,849 @@
+/**
+ * @file tiering.c
+ * @brief 账户冷热分层存储实现
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/tiering.h>
+#include <lib/account.h>
+#include <lib/engine.h>
+#include <lib/flusher.h>
+#include <lib/shm_store.h>
+#include <lib/compact_store.h>
+#include <lib/disk_index.h>
+#include <lib/platform.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef _WIN32
+ #include <io.h>
+#else
+ #include <unistd.h>
+#endif
+
+/* ==================== 常量配置 ==================== */
+
+#define TIERING_DEFAULT_COLD_AFTER_SECONDS (30u * 24 * 3600)
+#define TIERING_DEFAULT_SCAN_INTERVAL_SECONDS 600
+#define TIERING_DEFAULT_SEGMENT_FILE "Card/cold.seg"
+#define TIERING_KEY_BYTES 16
+#define TIERING_RECORD_MAX 20         /* 两个 varint 的最大长度 */
+#define TIERING_MAX_COUNT (1u << 28)
+
+_Static_assert(sizeof(ColdSegmentHeader) == 24, "ColdSegmentHeader must be 24 bytes");
+
+/* ==================== 内部状态 ==================== */
+
+/**
+ * @brief 内存中的冷段（与文件布局相同，另加已提升标记）
+ */
+typedef struct {
+    size_t count;
+    uint8_t (*keys)[TIERING_KEY_BYTES];
+    uint32_t *offsets;            /* count + 1 项 */
+    int64_t *modified;            /* 每条记录的最后修改时间 */
+    uint8_t *values;
+    uint8_t *promoted;            /* 位图 */
+    size_t promoted_count;
+} ColdSegment;
+
+static struct {
+    TieringConfig config;
+    atomic_bool active;
+    bool lock_inited;
+    PlatformMutex lock;           /* 保护冷段与统计 */
+    bool loaded;                  /* 冷段已读入内存 */
+    bool load_failed;             /* 冷段文件损坏，不再写入以免覆盖 */
+    ColdSegment seg;
+
+    PlatformThread thread;
+    bool thread_started;
+    bool stopping;
+    PlatformCond wake;
+
+    size_t demotions;
+    size_t promotions;
+    size_t scans;
+    uint64_t last_scan_us;
+    uint64_t cold_lookups;
+    uint64_t cold_lookup_ns;
+} g_tier;
+
+/**
+ * @brief 去除字符串首尾空白
+ */
+static char* trim_string(char *str)
+{
+    while (*str == ' ' || *str == '\t') {
+        str++;
+    }
+    char *end = str + strlen(str);
+    while (end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+    return str;
+}
+
+/**
+ * @brief 读取分层配置
+ */
+bool load_tiering_config(const char *path, TieringConfig *config)
+{
+    config->enabled = false;
+    config->cold_after_seconds = TIERING_DEFAULT_COLD_AFTER_SECONDS;
+    config->scan_interval_seconds = TIERING_DEFAULT_SCAN_INTERVAL_SECONDS;
+    snprintf(config->segment_file, sizeof(config->segment_file), "%s", TIERING_DEFAULT_SEGMENT_FILE);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line[256];
+    char current_section[64] = "";
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = trim_string(line);
+        if (*p == '#' || *p == '\0') {
+            continue;
+        }
+
+        /* 检测配置节 */
+        if (*p == '[') {
+            char *end = strchr(p, ']');
+            if (end) {
+                *end = '\0';
+                snprintf(current_section, sizeof(current_section), "%s", p + 1);
+            }
+            continue;
+        }
+
+        char *eq = strchr(p, '=');
+        if (eq == NULL || strcmp(current_section, "tiering") != 0) {
+            continue;
+        }
+        *eq = '\0';
+        char *k = trim_string(p);
+        char *v = trim_string(eq + 1);
+
+        if (strcmp(k, "enabled") == 0) {
+            config->enabled = (strcmp(v, "true") == 0);
+        } else if (strcmp(k, "cold_after_seconds") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n >= 0) {
+                config->cold_after_seconds = (unsigned int)n;
+            }
+        } else if (strcmp(k, "scan_interval_seconds") == 0) {
+            long n = strtol(v, NULL, 10);
+            if (n >= 0) {
+                config->scan_interval_seconds = (unsigned int)n;
+            }
+        } else if (strcmp(k, "segment_file") == 0 && *v != '\0') {
+            snprintf(config->segment_file, sizeof(config->segment_file), "%s", v);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+/* ==================== 编码 ==================== */
+
+static size_t varint_put(uint8_t *out, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static size_t varint_get(const uint8_t *p, size_t len, uint64_t *v)
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i < len && i < 10; i++) {
+        result |= (uint64_t)(p[i] & 0x7F) << (7 * i);
+        if ((p[i] & 0x80) == 0) {
+            *v = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 编码一条记录的值（密码与余额），返回字节数
+ */
+static size_t record_encode(uint8_t *out, const ACCOUNT *acc)
+{
+    size_t n = varint_put(out, acc->PASSWORD);
+    n += varint_put(out + n, acc->BALANCE);
+    xor_encrypt_decrypt(out, n);
+    return n;
+}
+
+/* ==================== 冷段 ==================== */
+
+static void seg_free(ColdSegment *seg)
+{
+    free(seg->keys);
+    free(seg->offsets);
+    free(seg->modified);
+    free(seg->values);
+    free(seg->promoted);
+    memset(seg, 0, sizeof(*seg));
+}
+
+static bool seg_alloc(ColdSegment *seg, size_t count, size_t value_bytes)
+{
+    memset(seg, 0, sizeof(*seg));
+    seg->keys = malloc((count ? count : 1) * sizeof(*seg->keys));
+    seg->offsets = calloc(count + 1, sizeof(uint32_t));
+    seg->modified = malloc((count ? count : 1) * sizeof(int64_t));
+    seg->values = malloc(value_bytes ? value_bytes : 1);
+    seg->promoted = calloc((count + 7) / 8 + 1, 1);
+    if (seg->keys == NULL || seg->offsets == NULL || seg->modified == NULL ||
+        seg->values == NULL || seg->promoted == NULL) {
+        seg_free(seg);
+        return false;
+    }
+    seg->count = count;
+    return true;
+}
+
+static bool seg_is_promoted(const ColdSegment *seg, size_t i)
+{
+    return (seg->promoted[i / 8] >> (i % 8)) & 1;
+}
+
+static void seg_set_promoted(ColdSegment *seg, size_t i)
+{
+    if (!seg_is_promoted(seg, i)) {
+        seg->promoted[i / 8] |= (uint8_t)(1u << (i % 8));
+        seg->promoted_count++;
+    }
+}
+
+/**
+ * @brief 二分查找，未找到返回 seg->count
+ */
+static size_t seg_find(const ColdSegment *seg, const uint8_t key[TIERING_KEY_BYTES])
+{
+    size_t lo = 0;
+    size_t hi = seg->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int c = memcmp(seg->keys[mid], key, TIERING_KEY_BYTES);
+        if (c == 0) {
+            return mid;
+        }
+        if (c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return seg->count;
+}
+
+static bool seg_decode(const ColdSegment *seg, size_t i, ACCOUNT *acc)
+{
+    size_t len = seg->offsets[i + 1] - seg->offsets[i];
+    uint8_t buf[TIERING_RECORD_MAX];
+    if (len > sizeof(buf)) {
+        return false;
+    }
+    memcpy(buf, seg->values + seg->offsets[i], len);
+    xor_encrypt_decrypt(buf, len);
+
+    uint64_t password = 0;
+    uint64_t balance = 0;
+    size_t n = varint_get(buf, len, &password);
+    if (n == 0 || varint_get(buf + n, len - n, &balance) != len - n) {
+        return false;
+    }
+    uuid_from_bytes(seg->keys[i], acc->UUID);
+    acc->PASSWORD = (LLUINT)password;
+    acc->BALANCE = (LLUINT)balance;
+    return true;
+}
+
+static size_t seg_live_count(const ColdSegment *seg)
+{
+    return seg->count - seg->promoted_count;
+}
+
+static size_t seg_memory_bytes(const ColdSegment *seg)
+{
+    if (seg->offsets == NULL) {
+        return 0;
+    }
+    return seg->count * (TIERING_KEY_BYTES + sizeof(int64_t)) +
+           (seg->count + 1) * sizeof(uint32_t) + seg->offsets[seg->count] + (seg->count + 7) / 8 + 1;
+}
+
+/**
+ * @brief 先写临时文件再改名，进程退出或掉电时冷段文件保持旧版本或新版本之一
+ */
+static bool seg_write_file(const char *path, const ColdSegment *seg)
+{
+    char tmp[TIERING_PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE *file = fopen(tmp, "wb");
+    if (file == NULL) {
+        perror("错误：无法创建冷段文件");
+        return false;
+    }
+
+    ColdSegmentHeader header;
+    header.magic = COLD_SEGMENT_MAGIC;
+    header.version = COLD_SEGMENT_VERSION;
+    header.count = seg->count;
+    header.value_bytes = seg->offsets[seg->count];
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(seg->keys, TIERING_KEY_BYTES, seg->count, file) == seg->count;
+    ok = ok && fwrite(seg->offsets, sizeof(uint32_t), seg->count + 1, file) == seg->count + 1;
+    ok = ok && fwrite(seg->modified, sizeof(int64_t), seg->count, file) == seg->count;
+    ok = ok && fwrite(seg->values, 1, header.value_bytes, file) == header.value_bytes;
+    ok = ok && fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok) {
+#ifdef _WIN32
+        remove(path);
+#endif
+        ok = rename(tmp, path) == 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "错误：写入冷段文件 %s 失败\n", path);
+        remove(tmp);
+    }
+    return ok;
+}
+
+/**
+ * @brief 读取冷段文件
+ * @return 文件不存在返回true（空冷段），损坏返回false
+ */
+static bool seg_read_file(const char *path, ColdSegment *seg)
+{
+    memset(seg, 0, sizeof(*seg));
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return seg_alloc(seg, 0, 0);
+    }
+
+    ColdSegmentHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              header.magic == COLD_SEGMENT_MAGIC &&
+              (header.version == 1 || header.version == COLD_SEGMENT_VERSION) &&
+              header.count <= TIERING_MAX_COUNT &&
+              header.value_bytes <= header.count * TIERING_RECORD_MAX;
+    ok = ok && seg_alloc(seg, (size_t)header.count, (size_t)header.value_bytes);
+    if (ok) {
+        size_t count = seg->count;
+        ok = fread(seg->keys, TIERING_KEY_BYTES, count, file) == count &&
+             fread(seg->offsets, sizeof(uint32_t), count + 1, file) == count + 1;
+        if (header.version == 1) {
+            /* 版本 1 没有修改时间，以文件修改时间代替（不早于其中任何一条记录的修改） */
+            struct stat st;
+            int64_t stamp = (fstat(fileno(file), &st) == 0) ? (int64_t)st.st_mtime : (int64_t)time(NULL);
+            for (size_t i = 0; i < count; i++) {
+                seg->modified[i] = stamp;
+            }
+        } else {
+            ok = ok && fread(seg->modified, sizeof(int64_t), count, file) == count;
+        }
+        ok = ok && fread(seg->values, 1, (size_t)header.value_bytes, file) == header.value_bytes;
+        ok = ok && seg->offsets[0] == 0 && seg->offsets[count] == header.value_bytes;
+        for (size_t i = 0; ok && i < count; i++) {
+            ok = seg->offsets[i] < seg->offsets[i + 1] &&
+                 seg->offsets[i + 1] - seg->offsets[i] <= TIERING_RECORD_MAX &&
+                 (i == 0 || memcmp(seg->keys[i - 1], seg->keys[i], TIERING_KEY_BYTES) < 0);
+        }
+        if (!ok) {
+            seg_free(seg);
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+/**
+ * @brief 首次需要时读入冷段（须持 g_tier.lock）
+ *
+ * 冷段中已有 .card 文件的账户（提升后、重写冷段前进程退出）在启动时已载入
+ * Hash 表，标记为已提升。
+ */
+static void seg_ensure_loaded(void)
+{
+    if (g_tier.loaded) {
+        return;
+    }
+    g_tier.loaded = true;
+
+    if (!seg_read_file(g_tier.config.segment_file, &g_tier.seg)) {
+        fprintf(stderr, "错误：冷段文件 %s 损坏，冷段账户不可用，停止移入冷段\n",
+                g_tier.config.segment_file);
+        g_tier.load_failed = true;
+        seg_alloc(&g_tier.seg, 0, 0);
+        return;
+    }
+
+    for (size_t i = 0; i < g_tier.seg.count; i++) {
+        char uuid[37];
+        uuid_from_bytes(g_tier.seg.keys[i], uuid);
+        if (hash_find_account(uuid) != NULL) {
+            seg_set_promoted(&g_tier.seg, i);
+        }
+    }
+}
+
+/**
+ * @brief 移入冷段的账户的最后修改时间：.card 文件的修改时间，取不到时为当前时间
+ */
+static int64_t card_modified_time(const char *uuid)
+{
+    char filename[64];
+    snprintf(filename, sizeof(filename), "Card/%s.card", uuid);
+    struct stat st;
+    return (stat(filename, &st) == 0) ? (int64_t)st.st_mtime : (int64_t)time(NULL);
+}
+
+/**
+ * @brief 重建冷段：保留旧冷段中未提升、且不在 accounts 中的记录，合并 accounts
+ * @param accounts 按 UUID 升序，可为NULL
+ * @param skip 旧冷段中要删除的下标，不删除传 old->count
+ */
+static bool seg_rebuild(ColdSegment *out, const ColdSegment *old, const ACCOUNT *accounts,
+                        size_t count, size_t skip)
+{
+    size_t capacity = seg_live_count(old) + count;
+    if (!seg_alloc(out, capacity, capacity * TIERING_RECORD_MAX)) {
+        return false;
+    }
+
+    size_t n = 0;
+    uint32_t pos = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < old->count || j < count) {
+        uint8_t key[TIERING_KEY_BYTES];
+        if (j < count) {
+            uuid_to_bytes(accounts[j].UUID, key);
+        }
+        if (i < old->count && (i == skip || seg_is_promoted(old, i))) {
+            i++;
+            continue;
+        }
+
+        int c = (i >= old->count) ? 1 : (j >= count) ? -1 : memcmp(old->keys[i], key, TIERING_KEY_BYTES);
+        if (c < 0) {
+            size_t len = old->offsets[i + 1] - old->offsets[i];
+            memcpy(out->keys[n], old->keys[i], TIERING_KEY_BYTES);
+            out->modified[n] = old->modified[i];
+            memcpy(out->values + pos, old->values + old->offsets[i], len);
+            pos += (uint32_t)len;
+            i++;
+        } else {
+            /* 新移入的记录覆盖冷段中的旧版本 */
+            memcpy(out->keys[n], key, TIERING_KEY_BYTES);
+            out->modified[n] = card_modified_time(accounts[j].UUID);
+            pos += (uint32_t)record_encode(out->values + pos, &accounts[j]);
+            j++;
+            if (c == 0) {
+                i++;
+            }
+        }
+        n++;
+        out->offsets[n] = pos;
+    }
+    out->count = n;
+
+    uint8_t *shrunk = realloc(out->values, pos ? pos : 1);
+    if (shrunk != NULL) {
+        out->values = shrunk;
+    }
+    return true;
+}
+
+/**
+ * @brief 用新冷段替换当前冷段并写入文件（须持 g_tier.lock）
+ */
+static bool seg_replace(ColdSegment *next)
+{
+    if (!seg_write_file(g_tier.config.segment_file, next)) {
+        seg_free(next);
+        return false;
+    }
+    seg_free(&g_tier.seg);
+    g_tier.seg = *next;
+    return true;
+}
+
+static int cmp_account_uuid(const void *a, const void *b)
+{
+    return strcmp(((const ACCOUNT *)a)->UUID, ((const ACCOUNT *)b)->UUID);
+}
+
+/**
+ * @brief account_evict_idle() 的冷段写入回调（调用方持账户锁）
+ */
+static size_t persist_idle(ACCOUNT *accounts, size_t count, void *user)
+{
+    (void)user;
+
+    /* 非规范格式的 UUID 留在热层 */
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t key[TIERING_KEY_BYTES];
+        if (uuid_to_bytes(accounts[i].UUID, key)) {
+            accounts[n++] = accounts[i];
+        }
+    }
+    if (n == 0) {
+        return 0;
+    }
+    qsort(accounts, n, sizeof(ACCOUNT), cmp_account_uuid);
+
+    platform_mutex_lock(&g_tier.lock);
+    seg_ensure_loaded();
+    bool ok = false;
+    if (!g_tier.load_failed) {
+        ColdSegment next;
+        ok = seg_rebuild(&next, &g_tier.seg, accounts, n, g_tier.seg.count) && seg_replace(&next);
+    }
+    if (ok) {
+        g_tier.demotions += n;
+    }
+    platform_mutex_unlock(&g_tier.lock);
+
+    return ok ? n : 0;
+}
+
+/* ==================== 生命周期 ==================== */
+
+static void tiering_thread(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        platform_mutex_lock(&g_tier.lock);
+        if (!g_tier.stopping) {
+            platform_cond_timedwait(&g_tier.wake, &g_tier.lock,
+                                    g_tier.config.scan_interval_seconds * 1000u);
+        }
+        bool stop = g_tier.stopping;
+        platform_mutex_unlock(&g_tier.lock);
+
+        if (stop) {
+            break;
+        }
+        tiering_demote_idle(g_tier.config.cold_after_seconds);
+    }
+}
+
+bool tiering_start(const TieringConfig *config)
+{
+    if (atomic_load(&g_tier.active)) {
+        return false;
+    }
+
+    if (!g_tier.lock_inited) {
+        platform_mutex_init(&g_tier.lock);
+        platform_cond_init(&g_tier.wake);
+        g_tier.lock_inited = true;
+    }
+
+    g_tier.config = *config;
+    g_tier.loaded = false;
+    g_tier.load_failed = false;
+    g_tier.stopping = false;
+    g_tier.demotions = 0;
+    g_tier.promotions = 0;
+    g_tier.scans = 0;
+    g_tier.last_scan_us = 0;
+    g_tier.cold_lookups = 0;
+    g_tier.cold_lookup_ns = 0;
+    atomic_store(&g_tier.active, true);
+
+    if (config->scan_interval_seconds > 0) {
+        if (!platform_thread_create(&g_tier.thread, tiering_thread, NULL)) {
+            atomic_store(&g_tier.active, false);
+            return false;
+        }
+        g_tier.thread_started = true;
+    }
+    return true;
+}
+
+/**
+ * @brief 未启用分层时把冷段中的账户写回当前存储并删除冷段文件
+ */
+static size_t tiering_restore_all(const char *path)
+{
+    ColdSegment seg;
+    if (!seg_read_file(path, &seg)) {
+        fprintf(stderr, "错误：冷段文件 %s 损坏，未能恢复其中的账户\n", path);
+        return 0;
+    }
+
+    size_t restored = 0;
+    bool ok = true;
+    for (size_t i = 0; i < seg.count; i++) {
+        char uuid[37];
+        uuid_from_bytes(seg.keys[i], uuid);
+        ACCOUNT acc;
+        /* 已有 .card 文件的账户以文件为准 */
+        if (load_account(uuid, &acc)) {
+            continue;
+        }
+        if (seg_decode(&seg, i, &acc) && save_account(&acc)) {
+            restored++;
+        } else {
+            ok = false;
+        }
+    }
+    seg_free(&seg);
+
+    if (ok) {
+        remove(path);
+    } else {
+        fprintf(stderr, "警告：部分冷段账户未能恢复，冷段文件已保留\n");
+    }
+    return restored;
+}
+
+bool init_tiering(void)
+{
+    TieringConfig config;
+    load_tiering_config(ENGINE_CONFIG_FILE, &config);
+
+    bool supported = true;
+    if (config.enabled) {
+        EngineConfig engine_config;
+        load_engine_config(ENGINE_CONFIG_FILE, &engine_config);
+        if (engine_config.mode == ENGINE_MODE_SHARDED || shm_store_active() || flusher_active() ||
+            compact_store_active() || disk_index_active()) {
+            fprintf(stderr, "警告：分片、共享存储、journal 持久化、紧凑账户表与磁盘索引模式不支持冷热分层，已忽略 [tiering] enabled=true\n");
+            supported = false;
+        }
+    }
+
+    if (!config.enabled || !supported) {
+        struct stat st;
+        if (stat(config.segment_file, &st) == 0) {
+            size_t restored = tiering_restore_all(config.segment_file);
+            printf("✓ 冷热分层未启用，已从冷段恢复 %zu 个账户\n", restored);
+        }
+        return true;
+    }
+
+    if (!tiering_start(&config)) {
+        fprintf(stderr, "警告：冷热分层启动失败\n");
+        return false;
+    }
+    printf("✓ 冷热分层: 超过 %u 秒未访问的账户移入 %s\n",
+           config.cold_after_seconds, config.segment_file);
+    return true;
+}
+
+void cleanup_tiering(void)
+{
+    if (!atomic_load(&g_tier.active)) {
+        return;
+    }
+
+    if (g_tier.thread_started) {
+        platform_mutex_lock(&g_tier.lock);
+        g_tier.stopping = true;
+        platform_cond_signal(&g_tier.wake);
+        platform_mutex_unlock(&g_tier.lock);
+        platform_thread_join(g_tier.thread);
+        g_tier.thread_started = false;
+    }
+
+    atomic_store(&g_tier.active, false);
+    platform_mutex_lock(&g_tier.lock);
+    seg_free(&g_tier.seg);
+    g_tier.loaded = false;
+    platform_mutex_unlock(&g_tier.lock);
+}
+
+bool tiering_active(void)
+{
+    return atomic_load_explicit(&g_tier.active, memory_order_acquire);
+}
+
+size_t tiering_demote_idle(unsigned int idle_seconds)
+{
+    if (!tiering_active()) {
+        return 0;
+    }
+
+    uint64_t t0 = platform_monotonic_ns();
+    size_t n = account_evict_idle(time(NULL) - (time_t)idle_seconds, persist_idle, NULL);
+    uint64_t elapsed_us = (platform_monotonic_ns() - t0) / 1000;
+
+    platform_mutex_lock(&g_tier.lock);
+    g_tier.scans++;
+    g_tier.last_scan_us = elapsed_us;
+    platform_mutex_unlock(&g_tier.lock);
+    return n;
+}
+
+void tiering_get_stats(TieringStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    account_hot_usage(&stats->hot_count, &stats->hot_bytes);
+
+    struct stat st;
+    if (stat(g_tier.config.segment_file, &st) == 0) {
+        stats->segment_file_bytes = (size_t)st.st_size;
+    }
+
+    if (!g_tier.lock_inited) {
+        return;
+    }
+    platform_mutex_lock(&g_tier.lock);
+    stats->cold_loaded = g_tier.loaded;
+    stats->cold_count = seg_live_count(&g_tier.seg);
+    stats->cold_bytes = seg_memory_bytes(&g_tier.seg);
+    stats->demotions = g_tier.demotions;
+    stats->promotions = g_tier.promotions;
+    stats->scans = g_tier.scans;
+    stats->last_scan_us = g_tier.last_scan_us;
+    stats->cold_lookups = g_tier.cold_lookups;
+    stats->cold_lookup_ns = g_tier.cold_lookup_ns;
+    platform_mutex_unlock(&g_tier.lock);
+}
+
+/* ==================== 账户模块调用 ==================== */
+
+bool tiering_cold_get(const char *uuid, ACCOUNT *acc)
+{
+    uint8_t key[TIERING_KEY_BYTES];
+    if (!tiering_active() || !uuid_to_bytes(uuid, key)) {
+        return false;
+    }
+
+    uint64_t t0 = platform_monotonic_ns();
+    platform_mutex_lock(&g_tier.lock);
+    seg_ensure_loaded();
+    size_t i = seg_find(&g_tier.seg, key);
+    bool found = i < g_tier.seg.count && !seg_is_promoted(&g_tier.seg, i) &&
+                 seg_decode(&g_tier.seg, i, acc);
+    g_tier.cold_lookups++;
+    g_tier.cold_lookup_ns += platform_monotonic_ns() - t0;
+    platform_mutex_unlock(&g_tier.lock);
+    return found;
+}
+
+bool tiering_cold_peek(const char *uuid, ACCOUNT *acc, time_t *modified)
+{
+    uint8_t key[TIERING_KEY_BYTES];
+    if (!tiering_active() || !uuid_to_bytes(uuid, key)) {
+        return false;
+    }
+
+    platform_mutex_lock(&g_tier.lock);
+    seg_ensure_loaded();
+    size_t i = seg_find(&g_tier.seg, key);
+    bool found = i < g_tier.seg.count && !seg_is_promoted(&g_tier.seg, i) &&
+                 seg_decode(&g_tier.seg, i, acc);
+    if (found) {
+        *modified = (time_t)g_tier.seg.modified[i];
+    }
+    platform_mutex_unlock(&g_tier.lock);
+    return found;
+}
+
+void tiering_mark_promoted(const char *uuid)
+{
+    uint8_t key[TIERING_KEY_BYTES];
+    if (!tiering_active() || !uuid_to_bytes(uuid, key)) {
+        return;
+    }
+
+    platform_mutex_lock(&g_tier.lock);
+    size_t i = seg_find(&g_tier.seg, key);
+    if (i < g_tier.seg.count && !seg_is_promoted(&g_tier.seg, i)) {
+        seg_set_promoted(&g_tier.seg, i);
+        g_tier.promotions++;
+    }
+    platform_mutex_unlock(&g_tier.lock);
+}
+
+bool tiering_forget(const char *uuid)
+{
+    uint8_t key[TIERING_KEY_BYTES];
+    if (!tiering_active() || !uuid_to_bytes(uuid, key)) {
+        return true;
+    }
+
+    platform_mutex_lock(&g_tier.lock);
+    seg_ensure_loaded();
+    bool ok = true;
+    size_t i = seg_find(&g_tier.seg, key);
+    if (i < g_tier.seg.count) {
+        /* 删除不能等到下次扫描，否则进程重启后账户会从冷段复活 */
+        ColdSegment next;
+        ok = !g_tier.load_failed &&
+             seg_rebuild(&next, &g_tier.seg, NULL, 0, i) && seg_replace(&next);
+    }
+    platform_mutex_unlock(&g_tier.lock);
+    return ok;
+}
+
+size_t tiering_cold_list(char uuids[][37], size_t max_count)
+{
+    if (!tiering_active()) {
+        return 0;
+    }
+
+    size_t n = 0;
+    platform_mutex_lock(&g_tier.lock);
+    seg_ensure_loaded();
+    for (size_t i = 0; i < g_tier.seg.count && n < max_count; i++) {
+        if (!seg_is_promoted(&g_tier.seg, i)) {
+            uuid_from_bytes(g_tier.seg.keys[i], uuids[n++]);
+        }
+    }
+    platform_mutex_unlock(&g_tier.lock);
+    return n;
+}
+
+size_t tiering_cold_collect(ACCOUNT *out, size_t max_count)
+{
+    if (!tiering_active()) {
+        return 0;
+    }
+
+    size_t n = 0;
+    platform_mutex_lock(&g_tier.lock);
+    seg_ensure_loaded();
+    for (size_t i = 0; i < g_tier.seg.count && n < max_count; i++) {
+        if (!seg_is_promoted(&g_tier.seg, i) && seg_decode(&g_tier.seg, i, &out[n])) {
+            n++;
+        }
+    }
+    platform_mutex_unlock(&g_tier.lock);
+    return n;
+}
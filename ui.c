@@ -8,10 +8,24 @@
 
 #include <lib/ui.h>
 #include <lib/account.h>
+#include <lib/engine.h>
+#include <lib/flusher.h>
+#include <lib/shm_store.h>
+#include <lib/snapshot.h>
+#include <lib/async_ops.h>
+#include <lib/outbox.h>
+#include <lib/replication.h>
+#include <lib/tiering.h>
+#include <lib/compact_store.h>
+#include <lib/disk_index.h>
+#include <lib/server_api.h>
+#include <lib/startup.h>
+#include <lib/platform.h>
 
 #ifdef _WIN32
  #include <conio.h>
 #else
+ #include <poll.h>
  #include <termios.h>
  #include <unistd.h>
 #endif
@@ -27,12 +41,17 @@ static const char *BUSINESS_MENU[] = {
     "5.注销账户         \n",
     "6.生成测试账户   \n",
     "7.账户列表排序设置 \n",
+    "8.系统运行状态     \n",
+    "9.提升热备为主节点 \n",
     "0.退出系统         \n"
 };
 
 /** @brief 菜单项数量 */
 static const int MENU_COUNT = sizeof(BUSINESS_MENU) / sizeof(BUSINESS_MENU[0]);
 
+/** @brief 后台检测与同步进行中时刷新状态行的间隔（毫秒） */
+static const unsigned int UI_STATUS_REFRESH_MS = 500;
+
 /* ==================== 函数实现 ==================== */
 
 #ifndef _WIN32
@@ -93,6 +112,25 @@ UiKey ui_read_key(void)
 #endif
 }
 
+/**
+ * @brief 等待按键，超时返回false
+ */
+static bool ui_wait_input(unsigned int timeout_ms)
+{
+#ifdef _WIN32
+    for (unsigned int waited = 0; waited < timeout_ms; waited += 50) {
+        if (_kbhit()) {
+            return true;
+        }
+        platform_sleep_ms(50);
+    }
+    return _kbhit() != 0;
+#else
+    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+    return poll(&pfd, 1, (int)timeout_ms) != 0;
+#endif
+}
+
 /**
  * @brief 清除屏幕内容
  */
@@ -128,11 +166,228 @@ static void output_business_with_selection(int selected)
             PRINTF_G("%s", BUSINESS_MENU[i]);
         }
     }
+
+    /* 同步队列有积压时在菜单下提示 */
+    if (outbox_active()) {
+        OutboxStats os;
+        outbox_get_stats(&os);
+        if (os.pending > 0) {
+            PRINTF_G("[同步队列] 待发送 %zu%s\n", os.pending,
+                     os.backing_off ? "（服务器不可用，稍后重试）" : "");
+        }
+    }
+}
+
+/**
+ * @brief 输出后台服务器检测与启动同步的状态行
+ */
+static void output_startup_status(void)
+{
+    StartupStatus ss;
+    startup_get_status(&ss);
+    switch (ss.phase) {
+    case STARTUP_DETECTING:
+        PRINTF_G("[服务器] 正在检测...（交易暂在本地执行）\n");
+        break;
+    case STARTUP_SYNCING:
+        PRINTF_G("[服务器] 正在同步：推送 %zu/%zu  拉取 %zu%s\n",
+                 ss.progress.push_done, ss.progress.push_total, ss.progress.pulled,
+                 ss.ops_blocked ? "（交易稍后执行）" : "（交易在本地执行，同步结束后发送）");
+        break;
+    case STARTUP_ONLINE:
+        if (ss.outbox_pending > 0) {
+            PRINTF_G("[服务器] 已联网（同步队列仍有 %zu 条交易未送达，本次跳过推送与拉取）\n",
+                     ss.outbox_pending);
+        } else {
+            PRINTF_G("[服务器] 已联网  推送 %d 个  拉取 %d 个\n", ss.pushed, ss.pulled);
+        }
+        break;
+    case STARTUP_OFFLINE:
+        PRINTF_G("[服务器] 本地模式（服务器不可用）\n");
+        break;
+    default:
+        break;
+    }
+
+    if (get_run_mode() == MODE_SERVER) {
+        ServerApiStats api;
+        server_api_get_stats(&api);
+        if (api.breaker.state == BREAKER_OPEN) {
+            PRINTF_G("[服务器] 无响应，已熔断：请求直接失败不再等待超时（%llu 秒后探测）\n",
+                     (unsigned long long)(api.breaker.retry_in_ms + 999) / 1000);
+        } else if (api.breaker.state == BREAKER_HALF_OPEN) {
+            PRINTF_G("[服务器] 无响应，正在探测是否恢复\n");
+        }
+    }
+}
+
+/**
+ * @brief 交易前等待启动同步放行交易，按回车取消
+ * @return 可以开始交易返回true（须调用 ui_end_transaction()），取消返回false
+ * @note 取消时回车留在 stdin 中，与交易读完输入后一样由调用方消耗
+ */
+static bool ui_begin_transaction(void)
+{
+    if (startup_op_try_begin(0)) {
+        return true;
+    }
+    PRINTF_G("正在与服务器同步账户，完成后继续（按回车取消）...\n");
+    while (!startup_op_try_begin(UI_STATUS_REFRESH_MS)) {
+        StartupStatus ss;
+        startup_get_status(&ss);
+        PRINTF_G("\r推送 %zu/%zu  拉取 %zu", ss.progress.push_done, ss.progress.push_total,
+                 ss.progress.pulled);
+        fflush(stdout);
+        if (ui_wait_input(0)) {
+            PRINTF_G("\n已取消\n");
+            return false;
+        }
+    }
+    PRINTF_G("\n");
+    return true;
+}
+
+static void ui_end_transaction(void)
+{
+    startup_op_end();
 }
 
 /**
  * @brief 消耗stdin
  */
+void show_system_status(void)
+{
+    EngineStats es;
+    engine_get_stats(&es);
+    PRINTF_G("-----------------------系统运行状态-----------------------\n");
+    PRINTF_G("[引擎] 已提交 %zu  已执行 %zu  批次 %zu  最大批次 %zu  队列满拒绝 %zu\n",
+             es.submitted, es.applied, es.batches, es.max_batch_seen, es.rejected);
+
+    if (async_ops_active()) {
+        AsyncStats as;
+        async_get_stats(&as);
+        PRINTF_G("[异步] 已提交 %zu  进行中 %zu  待同步 %zu  已完成 %zu  同步失败 %zu\n",
+                 as.submitted, as.in_flight, as.pending_sync, as.completed, as.sync_failed);
+    }
+
+    if (outbox_active()) {
+        OutboxStats os;
+        outbox_get_stats(&os);
+        PRINTF_G("[同步队列] 待发送 %zu%s  启动恢复 %zu  已追加 %llu  已发送 %llu  被拒绝 %llu  重试 %llu  文件 %.1f KB\n",
+                 os.pending, os.backing_off ? "（退避中）" : "", os.resumed,
+                 (unsigned long long)os.appended, (unsigned long long)os.sent,
+                 (unsigned long long)os.rejected, (unsigned long long)os.retries,
+                 os.file_bytes / 1024.0);
+        PRINTF_G("  请求 %llu 次  合并 %llu 条\n",
+                 (unsigned long long)os.requests, (unsigned long long)os.coalesced);
+    }
+
+    StartupStatus st;
+    startup_get_status(&st);
+    if (st.phase != STARTUP_IDLE) {
+        PRINTF_G("[启动] 显示菜单 %llu ms  服务器检测 %llu ms  推送与拉取 %llu ms\n",
+                 (unsigned long long)st.menu_ms, (unsigned long long)st.detect_ms,
+                 (unsigned long long)st.sync_ms);
+    }
+
+    if (get_run_mode() == MODE_SERVER) {
+        ServerApiStats ss;
+        server_api_get_stats(&ss);
+        PRINTF_G("[服务器] 请求 %llu 次（HTTP/2 %llu 次）  新建连接 %llu  失败 %llu  平均 %.3f ms\n",
+                 (unsigned long long)ss.requests, (unsigned long long)ss.http2_requests,
+                 (unsigned long long)ss.new_connections, (unsigned long long)ss.failures,
+                 ss.requests ? ss.total_us / 1000.0 / (double)ss.requests : 0.0);
+        PRINTF_G("  发送 %.1f KB  接收 %.1f KB（解压后 %.1f KB）\n",
+                 ss.bytes_sent / 1024.0, ss.bytes_received / 1024.0,
+                 ss.body_bytes_received / 1024.0);
+        PRINTF_G("  堆分配 %llu 次（libcurl %llu 次），平均每次请求 %.1f 次\n",
+                 (unsigned long long)ss.allocations, (unsigned long long)ss.curl_allocations,
+                 ss.requests ? (double)(ss.allocations + ss.curl_allocations) / (double)ss.requests : 0.0);
+        PRINTF_G("  熔断 %s  最近 %zu 次失败 %zu 次  断开 %llu 次  直接失败 %llu 次\n",
+                 breaker_state_string(ss.breaker.state), ss.breaker.window_requests,
+                 ss.breaker.window_failures, (unsigned long long)ss.breaker.opened,
+                 (unsigned long long)ss.breaker.rejected);
+        PRINTF_G("  超时 %llu ms（连接 %llu ms）  延迟 p99 %.1f ms（建立连接 %.1f ms）\n",
+                 (unsigned long long)ss.breaker.timeout_ms,
+                 (unsigned long long)ss.breaker.connect_timeout_ms,
+                 ss.breaker.latency_p99_us / 1000.0, ss.breaker.connect_p99_us / 1000.0);
+    }
+
+    if (replication_role() != REPLICATION_ROLE_NONE) {
+        ReplicationStats rs;
+        replication_get_stats(&rs);
+        PRINTF_G("[复制] %s  %s  序号 %llu  已确认 %llu\n",
+                 replication_role_string(rs.role), rs.connected ? "已连接" : "未连接",
+                 (unsigned long long)rs.last_seq, (unsigned long long)rs.acked_seq);
+        PRINTF_G("  落后: %llu 条 / %.3f ms  记录 %zu  全量同步 %zu  sync 等待 %zu  放弃等待 %zu\n",
+                 (unsigned long long)rs.lag_ops, rs.lag_us / 1000.0, rs.records, rs.resyncs,
+                 rs.sync_waits, rs.sync_timeouts);
+    }
+
+    if (tiering_active()) {
+        TieringStats ts;
+        tiering_get_stats(&ts);
+        PRINTF_G("[分层] 热层 %zu 个账户 / %.1f KB  冷层 %zu 个账户 / %.1f KB%s  冷段文件 %.1f KB\n",
+                 ts.hot_count, ts.hot_bytes / 1024.0, ts.cold_count, ts.cold_bytes / 1024.0,
+                 ts.cold_loaded ? "" : "（未载入）", ts.segment_file_bytes / 1024.0);
+        PRINTF_G("  移入冷层 %zu  提升 %zu  扫描 %zu 次（最近 %.3f ms）  冷段查找平均 %.0f ns\n",
+                 ts.demotions, ts.promotions, ts.scans, ts.last_scan_us / 1000.0,
+                 ts.cold_lookups ? (double)ts.cold_lookup_ns / (double)ts.cold_lookups : 0.0);
+    }
+
+    if (compact_store_active()) {
+        CompactStoreStats cs;
+        compact_store_get_stats(compact_store_global(), &cs);
+        PRINTF_G("[紧凑表] 账户 %zu  块 %zu  %.1f 字节/账户  增量 %zu 写入 / %zu 删除  归并 %zu 次（最近 %.3f ms）\n",
+                 cs.count, cs.blocks,
+                 cs.count ? (double)compact_store_memory_bytes(&cs) / (double)cs.count : 0.0,
+                 cs.delta_count, cs.deleted_count, cs.merges, cs.last_merge_us / 1000.0);
+    }
+
+    if (disk_index_active()) {
+        DiskIndexStats ds;
+        disk_index_get_stats(&ds);
+        PRINTF_G("[磁盘索引] 账户 %zu  桶 %zu  溢出页 %zu  文件 %.1f KB  查找 %llu 次 / 读页 %llu  缓冲池 %zu 页命中 %llu\n",
+                 ds.count, ds.buckets, ds.overflow_pages, ds.file_bytes / 1024.0,
+                 (unsigned long long)ds.lookups, (unsigned long long)ds.page_reads,
+                 ds.pool_pages, (unsigned long long)ds.pool_hits);
+    }
+
+    if (shm_store_active()) {
+        ShmStoreStats ss;
+        shm_store_get_stats(&ss);
+        PRINTF_G("[共享存储] 账户 %zu / 容量 %zu  挂接进程 %zu  锁接管 %zu\n",
+                 ss.count, ss.capacity, ss.attached, ss.recoveries);
+    }
+
+    if (snapshot_active()) {
+        SnapshotStats ns;
+        snapshot_get_stats(&ns);
+        PRINTF_G("[快照] %s  generation %llu  账户 %zu\n",
+                 snapshot_segment_name(), (unsigned long long)ns.generation, ns.last_count);
+        PRINTF_G("  发布: 有变化 %zu 次  无变化 %zu 次  最近写入 %zu 页  累计 %zu 页\n",
+                 ns.publishes, ns.unchanged, ns.last_pages, ns.pages_written);
+        PRINTF_G("  发布耗时: 最近 %.3f ms  最长 %.3f ms\n",
+                 ns.last_publish_us / 1000.0, ns.max_publish_us / 1000.0);
+    }
+
+    if (!flusher_active()) {
+        PRINTF_G("[刷盘] 同步写入模式\n");
+        return;
+    }
+
+    FlusherStats fs;
+    flusher_get_stats(&fs);
+    PRINTF_G("[刷盘] journal 模式\n");
+    PRINTF_G("  脏账户积压: %zu\n", fs.dirty_backlog);
+    PRINTF_G("  日志记录数: %zu\n", fs.journal_records);
+    PRINTF_G("  刷盘批次: %zu  写回账户: %zu  失败: %zu\n",
+             fs.flushes, fs.accounts_flushed, fs.flush_errors);
+    PRINTF_G("  刷盘耗时: 最近 %.3f ms  最长 %.3f ms  平均 %.3f ms\n",
+             fs.last_flush_us / 1000.0, fs.max_flush_us / 1000.0,
+             fs.flushes ? fs.total_flush_us / 1000.0 / (double)fs.flushes : 0.0);
+}
+
 void consume_stdin(void)
 {
     char c;
@@ -153,10 +408,17 @@ int ui_loop(void)
     {
         clear_screen();
         PRINTF_G("--------------------BAMSYSTEM-银行账户管理系统--------------------\n");
+        output_startup_status();
         PRINTF_G("-请选择你的业务-\n");
 
         output_business_with_selection(selected);
+        fflush(stdout);
+        startup_mark_menu_shown();
 
+        /* 后台检测与同步进行中时定时刷新状态行 */
+        if (startup_in_progress() && !ui_wait_input(UI_STATUS_REFRESH_MS)) {
+            continue;
+        }
         UiKey key = ui_read_key();
         if (key == UI_KEY_UP) {
             selected = (selected - 1 + MENU_COUNT) % MENU_COUNT;
@@ -191,10 +453,13 @@ int ui_loop(void)
         case 1:
             /* 创建账户 */
             clear_screen();
-            PRINTF_G("请输入你的7位密码(数字组合): ");
-            LLUINT password = 0;
-            if (scanf("%llu", &password) == 1) {//stdin剩余'\n' 
-                create_account(password);
+            if (ui_begin_transaction()) {
+                PRINTF_G("请输入你的7位密码(数字组合): ");
+                LLUINT password = 0;
+                if (scanf("%llu", &password) == 1) {//stdin剩余'\n' 
+                    create_account(password);
+                }
+                ui_end_transaction();
             }
             PRINTF_G("\n按回车键继续...");
             consume_stdin();
@@ -204,7 +469,10 @@ int ui_loop(void)
         case 2:
             /* 存款 */
             clear_screen();
-            deposit();
+            if (ui_begin_transaction()) {
+                deposit();
+                ui_end_transaction();
+            }
             PRINTF_G("\n按回车键继续...");
             consume_stdin();
             getchar();
@@ -213,7 +481,10 @@ int ui_loop(void)
         case 3:
             /* 取款 */
             clear_screen();
-            withdraw();
+            if (ui_begin_transaction()) {
+                withdraw();
+                ui_end_transaction();
+            }
             PRINTF_G("\n按回车键继续...");
             consume_stdin();
             getchar();
@@ -222,7 +493,10 @@ int ui_loop(void)
         case 4:
             /* 转账 */
             clear_screen();
-            transfer();
+            if (ui_begin_transaction()) {
+                transfer();
+                ui_end_transaction();
+            }
             PRINTF_G("\n按回车键继续...");
             consume_stdin();
             getchar();
@@ -231,7 +505,10 @@ int ui_loop(void)
         case 5:
             /* 销户 */
             clear_screen();
-            delete_account();
+            if (ui_begin_transaction()) {
+                delete_account();
+                ui_end_transaction();
+            }
             PRINTF_G("\n按回车键继续...");
             consume_stdin();
             getchar();
@@ -239,7 +516,10 @@ int ui_loop(void)
 
         case 6:
             /* 生成测试账户 */
-            generate_test_account();
+            if (ui_begin_transaction()) {
+                generate_test_account();
+                ui_end_transaction();
+            }
             PRINTF_G("\n按回车键继续...");
             consume_stdin();
             getchar();
@@ -259,6 +539,28 @@ int ui_loop(void)
             getchar();
             break;
             
+        case 8:
+            clear_screen();
+            show_system_status();
+            PRINTF_G("\n按回车键继续...");
+            consume_stdin();
+            getchar();
+            break;
+
+        case 9:
+            clear_screen();
+            if (!replication_is_follower()) {
+                PRINTF_G("当前不是热备节点\n");
+            } else if (replication_promote()) {
+                PRINTF_G("已提升为主节点，开始接受写入\n");
+            } else {
+                PRINTF_G("已停止跟随并接受写入，但无法在 promote_address 监听\n");
+            }
+            PRINTF_G("\n按回车键继续...");
+            consume_stdin();
+            getchar();
+            break;
+            
         default:
             /* 无效选项 */
             PRINTF_G("无效的选项，请重新选择！\n");
@@ -0,0 +1,151 @@
+/**
+ * @file wire.c
+ * @brief 客户端与服务器同步的二进制编码实现（定长小端记录）
+ * @author BAMSYSTEM团队
+ * @date 2026-10-17
+ * @version 1.0
+ */
+
+#include <lib/wire.h>
+#include <string.h>
+
+/* ==================== 小端读写 ==================== */
+
+static uint8_t* put_u64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) {
+        *p++ = (uint8_t)(v >> (8 * i));
+    }
+    return p;
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+static uint8_t* put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) {
+        *p++ = (uint8_t)(v >> (8 * i));
+    }
+    return p;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* ==================== 编码 ==================== */
+
+size_t wire_encode_op(uint8_t *out, const char *uuid, const char *uuid_to, LLUINT amount,
+                      int64_t timestamp, const char *op_id)
+{
+    size_t id_len = op_id != NULL ? strlen(op_id) : 0;
+    if (id_len > WIRE_OP_ID_MAX || !uuid_to_bytes(uuid, out)) {
+        return 0;
+    }
+    uint8_t *p = out + WIRE_UUID_BYTES;
+    if (uuid_to != NULL) {
+        if (!uuid_to_bytes(uuid_to, p)) {
+            return 0;
+        }
+    } else {
+        memset(p, 0, WIRE_UUID_BYTES);
+    }
+    p += WIRE_UUID_BYTES;
+    p = put_u64(p, (uint64_t)amount);
+    p = put_u64(p, (uint64_t)timestamp);
+    *p++ = (uint8_t)id_len;
+    if (id_len > 0) {
+        memcpy(p, op_id, id_len);
+    }
+    return WIRE_OP_FIXED_BYTES + id_len;
+}
+
+size_t wire_sync_batch_size(size_t n)
+{
+    return 4 + n * WIRE_SYNC_RECORD_BYTES;
+}
+
+size_t wire_encode_sync_batch(uint8_t *out, const ACCOUNT *accounts, size_t n, int64_t timestamp)
+{
+    uint8_t *p = put_u32(out, (uint32_t)n);
+    for (size_t i = 0; i < n; i++) {
+        if (!uuid_to_bytes(accounts[i].UUID, p)) {
+            return 0;
+        }
+        p = put_u64(p + WIRE_UUID_BYTES, (uint64_t)accounts[i].BALANCE);
+        p = put_u64(p, (uint64_t)timestamp);
+    }
+    return (size_t)(p - out);
+}
+
+/* ==================== 解码 ==================== */
+
+bool wire_decode_status(const uint8_t *data, size_t len, LLUINT *balance)
+{
+    if (data == NULL || len < WIRE_STATUS_FIXED_BYTES) {
+        return false;
+    }
+    size_t text_len = (size_t)data[9] | (size_t)data[10] << 8;
+    if (len != WIRE_STATUS_FIXED_BYTES + text_len) {
+        return false;
+    }
+    if (balance != NULL) {
+        *balance = (LLUINT)get_u64(data + 1);
+    }
+    return data[0] == 1;
+}
+
+size_t wire_decode_sync_batch(const uint8_t *data, size_t len, size_t n, bool *item_ok)
+{
+    if (data == NULL || len != 5 + n || data[0] != 1 || get_u32(data + 1) != (uint32_t)n) {
+        return 0;
+    }
+    size_t synced = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (data[5 + i] == 1) {
+            item_ok[i] = true;
+            synced++;
+        }
+    }
+    return synced;
+}
+
+void wire_reader_init(WireReader *r, const uint8_t *data, size_t len)
+{
+    r->p = data;
+    r->end = data != NULL ? data + len : NULL;
+}
+
+WireReadResult wire_read_frame(WireReader *r, ACCOUNT *acc, WirePageEnd *end)
+{
+    size_t left = (size_t)(r->end - r->p);
+    if (left >= WIRE_ACCOUNT_FRAME_BYTES && r->p[0] == WIRE_FRAME_ACCOUNT) {
+        memset(acc, 0, sizeof(ACCOUNT));
+        uuid_from_bytes(r->p + 1, acc->UUID);
+        acc->BALANCE = (LLUINT)get_u64(r->p + 1 + WIRE_UUID_BYTES);
+        r->p += WIRE_ACCOUNT_FRAME_BYTES;
+        return WIRE_READ_ACCOUNT;
+    }
+    if (left >= WIRE_END_FRAME_BYTES && r->p[0] == WIRE_FRAME_END) {
+        static const uint8_t none[WIRE_UUID_BYTES];
+        const uint8_t *next = r->p + 10;
+        end->success = r->p[1] == 1;
+        end->watermark = (int64_t)get_u64(r->p + 2);
+        if (memcmp(next, none, WIRE_UUID_BYTES) == 0) {
+            end->next_after[0] = '\0';
+        } else {
+            uuid_from_bytes(next, end->next_after);
+        }
+        r->p += WIRE_END_FRAME_BYTES;
+        return WIRE_READ_END;
+    }
+    return WIRE_READ_ERROR;
+}